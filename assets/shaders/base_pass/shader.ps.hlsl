@@ -9,6 +9,8 @@ struct PSInput
     float3 Bitangent : BITANGENT4;
     float4 Color : COLOR5;
     float3 WorldPos : TEXCOORD0;
+    nointerpolation uint MaterialIndex : MATERIAL6;
+    nointerpolation uint2 DitherRange : DITHER7; // LOD fade, see ClipLodFade
 };
 
 struct ViewUniformBuffer
@@ -67,23 +69,76 @@ StructuredBuffer<DirectionalLightData> directionalLights : register(t1, space2);
 StructuredBuffer<PointLightData> pointLights : register(t2, space2);
 StructuredBuffer<SpotLightData> spotLights : register(t3, space2);
 
-struct MaterialParams
+
+// must match MaterialTable::s_maxTextureCount
+#define MAX_MATERIAL_TEXTURES 1024
+
+struct MaterialData
 {
     float4 baseColor;
     float metallic;
     float roughness;
     float opacity;
-    float padding;
+    uint albedoIndex;
+    uint normalIndex;
+    uint metallicRoughnessIndex;
+    uint2 padding;
+};
+StructuredBuffer<MaterialData> Materials : register(t0, space3);
+Texture2D<float4> MaterialTextures[MAX_MATERIAL_TEXTURES] : register(t1, space3);
+
+SamplerState DefaultSampler : register(s0, space4);
+
+// must match LightClusterGrid::ClusterConstants
+struct ClusterConstants
+{
+    float4 ViewRows[4];
+    float4 ViewDepthPlane; // dot with the world position gives the view depth
+    float2 ScreenSize;
+    float2 ProjectionScale;
+    uint3 ClusterCount;
+    uint MaxLightsPerCluster;
+    float ZNear;
+    float ZFar;
+    float SliceScale;
+    float SliceBias;
+    uint PointLightCount;
+    uint SpotLightCount;
+    float2 ProjectionOffset;
 };
-cbuffer MaterialBuffer : register(b0, space3)
+
+cbuffer ClusterParam : register(b0, space5)
 {
-    MaterialParams material;
+    ClusterConstants ClusterParam;
 }
 
-Texture2D<float4> DiffuseTexture : register(t1, space3);
-Texture2D<float4> NormalTexture : register(t2, space3);
-Texture2D<float4> MetallicRoughnessTexture : register(t3, space3);
-SamplerState DefaultSampler : register(s0, space4);
+// x - first index in LightIndices, y - point light count, z - spot light count (spot indices follow the point ones)
+StructuredBuffer<uint4> Clusters : register(t1, space5);
+StructuredBuffer<uint> LightIndices : register(t2, space5);
+
+// 4x4 ordered dither, one value per LOD_FADE_STEPS
+static const uint BayerMatrix[16] = { 0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5 };
+
+// a draw keeps the pixels whose dither value is in [ditherRange.x, ditherRange.y), the levels of a cross-fading
+// instance are drawn with complementary ranges, so every pixel is covered once
+void ClipLodFade(float2 screenPos, uint2 ditherRange)
+{
+    uint2 cell = uint2(screenPos) & 3;
+    uint dither = BayerMatrix[cell.y * 4 + cell.x];
+    clip((dither >= ditherRange.x && dither < ditherRange.y) ? 1.0 : -1.0);
+}
+
+uint GetClusterIndex(float2 screenPos, float3 worldPos)
+{
+    uint3 count = ClusterParam.ClusterCount;
+
+    float viewDepth = max(dot(float4(worldPos, 1.0), ClusterParam.ViewDepthPlane), ClusterParam.ZNear);
+    uint slice = (uint)clamp(floor(log(viewDepth) * ClusterParam.SliceScale + ClusterParam.SliceBias), 0.0, count.z - 1.0);
+
+    uint2 tile = (uint2)clamp(floor(screenPos / ClusterParam.ScreenSize * float2(count.xy)), 0.0, float2(count.xy) - 1.0);
+
+    return (slice * count.y + tile.y) * count.x + tile.x;
+}
 
 float D_GGX(float3 N, float3 H, float roughness)
 {
@@ -205,17 +260,22 @@ float3 CalcSpot(SpotLightData light, float3 N, float3 V, float3 worldPos,
 // PBR
 float4 main(PSInput input) : SV_TARGET
 {
-    float4 diffuseSample = DiffuseTexture.Sample(DefaultSampler, input.TexCoord);
+    ClipLodFade(input.Position.xy, input.DitherRange);
+
+    // the index is the same for the whole draw, but the draws of one multi-draw may share a wave
+    MaterialData material = Materials[input.MaterialIndex];
+
+    float4 diffuseSample = MaterialTextures[NonUniformResourceIndex(material.albedoIndex)].Sample(DefaultSampler, input.TexCoord);
     float3 albedo = diffuseSample.rgb * material.baseColor.rgb;
     float alpha = diffuseSample.a * material.opacity;
     
     clip(alpha - 0.1);
     
-    float2 mr = MetallicRoughnessTexture.Sample(DefaultSampler, input.TexCoord).gb;
+    float2 mr = MaterialTextures[NonUniformResourceIndex(material.metallicRoughnessIndex)].Sample(DefaultSampler, input.TexCoord).gb;
     float roughness = saturate(mr.x * material.roughness);
     float metallic = saturate(mr.y * material.metallic);
 
-    float3 Nmap = NormalTexture.Sample(DefaultSampler, input.TexCoord).rgb * 2.0 - 1.0;
+    float3 Nmap = MaterialTextures[NonUniformResourceIndex(material.normalIndex)].Sample(DefaultSampler, input.TexCoord).rgb * 2.0 - 1.0;
     float3 T = normalize(input.Tangent);
     float3 B = normalize(input.Bitangent);
     float3 N = normalize(input.Normal);
@@ -230,13 +290,14 @@ float4 main(PSInput input) : SV_TARGET
     for (uint i = 0; i < directionalLightCount; ++i)
         color += CalcDirectional(directionalLights[i], N, V, albedo, metallic, roughness);
 
-    // Point
-    for (uint k = 0; k < pointLightCount; ++k)
-        color += CalcPoint(pointLights[k], N, V, input.WorldPos, albedo, metallic, roughness);
+    // Point and spot lights of the pixel's cluster
+    uint4 cluster = Clusters[GetClusterIndex(input.Position.xy, input.WorldPos)];
+
+    for (uint k = 0; k < cluster.y; ++k)
+        color += CalcPoint(pointLights[LightIndices[cluster.x + k]], N, V, input.WorldPos, albedo, metallic, roughness);
 
-    // Spot
-    for (uint j = 0; j < spotLightCount; ++j)
-        color += CalcSpot(spotLights[j], N, V, input.WorldPos, albedo, metallic, roughness);
+    for (uint j = 0; j < cluster.z; ++j)
+        color += CalcSpot(spotLights[LightIndices[cluster.x + cluster.y + j]], N, V, input.WorldPos, albedo, metallic, roughness);
 
     color += albedo * 0.03;
 
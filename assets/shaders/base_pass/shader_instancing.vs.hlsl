@@ -3,22 +3,42 @@ struct VSInput
 #ifdef __spirv__
     [[vk::location(0)]] float3   Position  : POSITION0;
     [[vk::location(1)]] float2   TexCoord  : TEXCOORD1;
-    [[vk::location(2)]] float3   Normal    : NORMAL2;
-    [[vk::location(3)]] float3   Tangent   : TANGENT3;
-    [[vk::location(4)]] float3   Bitangent : BITANGENT4;
-    [[vk::location(5)]] float4   Color     : COLOR5;
-    [[vk::location(6)]] float4x4 Instance  : INSTANCE6;
+    [[vk::location(2)]] float2   Normal    : NORMAL2;
+    [[vk::location(3)]] float2   Tangent   : TANGENT3;
+    [[vk::location(4)]] float4x4 Instance  : INSTANCE4;
+    [[vk::location(8)]] uint     DrawInfo  : DRAWINFO8;
 #else
     float3 Position : POSITION0;
     float2 TexCoord : TEXCOORD1;
-    float3 Normal : NORMAL2;
-    float3 Tangent : TANGENT3;
-    float3 Bitangent : BITANGENT4;
-    float4 Color : COLOR5;
-    float4x4 Instance : INSTANCE6;
+    float2 Normal : NORMAL2;   // octahedral
+    float2 Tangent : TANGENT3; // octahedral, y carries the bitangent sign
+    float4x4 Instance : INSTANCE4;
+    uint DrawInfo : DRAWINFO8;
 #endif
 };
 
+// must match the packing in base_pass.cpp (packDrawInfo)
+#define DRAW_INFO_MATERIAL_BITS 22
+#define DRAW_INFO_DITHER_BITS 5
+
+// see VertexLayout (utils/buffer/vertex_layout.h)
+float3 DecodeOctahedral(float2 e)
+{
+    float3 v = float3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+    {
+        v.xy = (1.0 - abs(v.yx)) * (step(0.0, v.xy) * 2.0 - 1.0);
+    }
+    return normalize(v);
+}
+
+float3 DecodeTangent(float2 e, out float bitangentSign)
+{
+    bitangentSign = e.y < 0.0 ? -1.0 : 1.0;
+    float y = (abs(e.y) * 32767.0 - 1.0) / 32766.0 * 2.0 - 1.0;
+    return DecodeOctahedral(float2(e.x, y));
+}
+
 struct ViewUniformBuffer
 {
     float4x4 V;
@@ -54,6 +74,8 @@ struct VSOutput
     float3 Bitangent : BITANGENT4;
     float4 Color : COLOR5;
     float3 WorldPos : TEXCOORD0; 
+    nointerpolation uint MaterialIndex : MATERIAL6;
+    nointerpolation uint2 DitherRange : DITHER7;
 };
 
 VSOutput main(VSInput input)
@@ -72,6 +94,11 @@ VSOutput main(VSInput input)
 
     output.Position = mul(ViewParam.VP, worldPos);
 
+    float bitangentSign;
+    float3 normal    = DecodeOctahedral(input.Normal);
+    float3 tangent   = DecodeTangent(input.Tangent, bitangentSign);
+    float3 bitangent = cross(normal, tangent) * bitangentSign;
+
     float3x3 normalMat =
     {
         normalize(worldMatrix[0].xyz),
@@ -79,16 +106,21 @@ VSOutput main(VSInput input)
         normalize(worldMatrix[2].xyz)
     };
 #ifdef __spirv__
-    output.Normal    = normalize(mul(input.Normal,    normalMat));
-    output.Tangent   = normalize(mul(input.Tangent,   normalMat));
-    output.Bitangent = normalize(mul(input.Bitangent, normalMat));
+    output.Normal    = normalize(mul(normal,    normalMat));
+    output.Tangent   = normalize(mul(tangent,   normalMat));
+    output.Bitangent = normalize(mul(bitangent, normalMat));
 #else
-    output.Normal = normalize(mul(normalMat, input.Normal));
-    output.Tangent = normalize(mul(normalMat, input.Tangent));
-    output.Bitangent = normalize(mul(normalMat, input.Bitangent));
+    output.Normal = normalize(mul(normalMat, normal));
+    output.Tangent = normalize(mul(normalMat, tangent));
+    output.Bitangent = normalize(mul(normalMat, bitangent));
 #endif
 
     output.TexCoord = input.TexCoord;
-    output.Color = input.Color;
+    output.Color = float4(1.0, 1.0, 1.0, 1.0);
+
+    uint ditherMask = (1u << DRAW_INFO_DITHER_BITS) - 1;
+    output.MaterialIndex = input.DrawInfo & ((1u << DRAW_INFO_MATERIAL_BITS) - 1);
+    output.DitherRange = uint2((input.DrawInfo >> DRAW_INFO_MATERIAL_BITS) & ditherMask,
+                               (input.DrawInfo >> (DRAW_INFO_MATERIAL_BITS + DRAW_INFO_DITHER_BITS)) & ditherMask);
     return output;
 }
@@ -29,19 +29,35 @@ struct VSInput
 {
 #ifdef __spirv__
     [[vk::location(0)]] float3   Position  : POSITION0;
-    [[vk::location(1)]] float3   Normal    : NORMAL1;  
-    [[vk::location(2)]] float3   Tangent   : TANGENT2;  
-    [[vk::location(3)]] float3   Bitangent : BITANGENT3;  
-    [[vk::location(4)]] float4x4 Instance  : INSTANCE4;  
+    [[vk::location(1)]] float2   Normal    : NORMAL1;  
+    [[vk::location(2)]] float2   Tangent   : TANGENT2;  
+    [[vk::location(3)]] float4x4 Instance  : INSTANCE3;  
 #else
     float3   Position  : POSITION0;
-    float3   Normal    : NORMAL1;
-    float3   Tangent   : TANGENT2;
-    float3   Bitangent : BITANGENT3;
-    float4x4 Instance  : INSTANCE4;
+    float2   Normal    : NORMAL1;   // octahedral
+    float2   Tangent   : TANGENT2;  // octahedral, y carries the bitangent sign
+    float4x4 Instance  : INSTANCE3;
 #endif
 };
 
+// see VertexLayout (utils/buffer/vertex_layout.h)
+float3 DecodeOctahedral(float2 e)
+{
+    float3 v = float3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+    {
+        v.xy = (1.0 - abs(v.yx)) * (step(0.0, v.xy) * 2.0 - 1.0);
+    }
+    return normalize(v);
+}
+
+float3 DecodeTangent(float2 e, out float bitangentSign)
+{
+    bitangentSign = e.y < 0.0 ? -1.0 : 1.0;
+    float y = (abs(e.y) * 32767.0 - 1.0) / 32766.0 * 2.0 - 1.0;
+    return DecodeOctahedral(float2(e.x, y));
+}
+
 
 struct VSOutput
 {
@@ -55,22 +71,27 @@ VSOutput main(VSInput input)
 {
     VSOutput output = (VSOutput) 0;
 
+    float bitangentSign;
+    float3 normal    = DecodeOctahedral(input.Normal);
+    float3 tangent   = DecodeTangent(input.Tangent, bitangentSign);
+    float3 bitangent = cross(normal, tangent) * bitangentSign;
+
 #ifdef __spirv__
     float4x4 worldMatrix = mul(ModelParam.ModelMatrix, input.Instance);
     
     output.Position = mul(float4(input.Position, 1.0), worldMatrix);
     
-    output.Normal = normalize(mul(input.Normal, (float3x3) worldMatrix));
-    output.Tangent = normalize(mul(input.Tangent, (float3x3) worldMatrix));
-    output.Bitangent = normalize(mul(input.Bitangent, (float3x3) worldMatrix));
+    output.Normal = normalize(mul(normal, (float3x3) worldMatrix));
+    output.Tangent = normalize(mul(tangent, (float3x3) worldMatrix));
+    output.Bitangent = normalize(mul(bitangent, (float3x3) worldMatrix));
 #else
     float4x4 worldMatrix = mul(input.Instance, ModelParam.ModelMatrix);
     
     output.Position = mul(worldMatrix, float4(input.Position, 1.0));
     
-    output.Normal = normalize(mul((float3x3) worldMatrix, input.Normal));
-    output.Tangent = normalize(mul((float3x3) worldMatrix, input.Tangent));
-    output.Bitangent = normalize(mul((float3x3) worldMatrix, input.Bitangent));
+    output.Normal = normalize(mul((float3x3) worldMatrix, normal));
+    output.Tangent = normalize(mul((float3x3) worldMatrix, tangent));
+    output.Bitangent = normalize(mul((float3x3) worldMatrix, bitangent));
 #endif
     
     return output;
@@ -3,20 +3,36 @@ struct VSInput
 #ifdef __spirv__
     [[vk::location(0)]] float3   Position  : POSITION0;
     [[vk::location(1)]] float2   TexCoord  : TEXCOORD1;
-    [[vk::location(2)]] float3   Normal    : NORMAL2;
-    [[vk::location(3)]] float3   Tangent   : TANGENT3;
-    [[vk::location(4)]] float3   Bitangent : BITANGENT4;
-    [[vk::location(5)]] float4x4 Instance  : INSTANCE5;
+    [[vk::location(2)]] float2   Normal    : NORMAL2;
+    [[vk::location(3)]] float2   Tangent   : TANGENT3;
+    [[vk::location(4)]] float4x4 Instance  : INSTANCE4;
 #else
     float3 Position : POSITION0;
     float2 TexCoord : TEXCOORD1;
-    float3 Normal : NORMAL2;
-    float3 Tangent : TANGENT3;
-    float3 Bitangent : BITANGENT4;
-    float4x4 Instance : INSTANCE5;
+    float2 Normal : NORMAL2;   // octahedral
+    float2 Tangent : TANGENT3; // octahedral, y carries the bitangent sign
+    float4x4 Instance : INSTANCE4;
 #endif
 };
 
+// see VertexLayout (utils/buffer/vertex_layout.h)
+float3 DecodeOctahedral(float2 e)
+{
+    float3 v = float3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+    {
+        v.xy = (1.0 - abs(v.yx)) * (step(0.0, v.xy) * 2.0 - 1.0);
+    }
+    return normalize(v);
+}
+
+float3 DecodeTangent(float2 e, out float bitangentSign)
+{
+    bitangentSign = e.y < 0.0 ? -1.0 : 1.0;
+    float y = (abs(e.y) * 32767.0 - 1.0) / 32766.0 * 2.0 - 1.0;
+    return DecodeOctahedral(float2(e.x, y));
+}
+
 struct ViewUniformBuffer
 {
     float4x4 V;
@@ -75,6 +91,11 @@ VSOutput main(VSInput input)
     //    normalize(worldMatrix[2].xyz)
     //};
 
+    float bitangentSign;
+    float3 normal    = DecodeOctahedral(input.Normal);
+    float3 tangent   = DecodeTangent(input.Tangent, bitangentSign);
+    float3 bitangent = cross(normal, tangent) * bitangentSign;
+
     float3x3 normalMat =
     {
         worldMatrix[0].xyz,
@@ -83,13 +104,13 @@ VSOutput main(VSInput input)
     };
     
 #ifdef __spirv__
-    output.Normal    = normalize(mul(input.Normal,    normalMat));
-    output.Tangent   = normalize(mul(input.Tangent,   normalMat));
-    output.Bitangent = normalize(mul(input.Bitangent, normalMat));
+    output.Normal    = normalize(mul(normal,    normalMat));
+    output.Tangent   = normalize(mul(tangent,   normalMat));
+    output.Bitangent = normalize(mul(bitangent, normalMat));
 #else
-    output.Normal = normalize(mul(normalMat, input.Normal));
-    output.Tangent = normalize(mul(normalMat, input.Tangent));
-    output.Bitangent = normalize(mul(normalMat, input.Bitangent));
+    output.Normal = normalize(mul(normalMat, normal));
+    output.Tangent = normalize(mul(normalMat, tangent));
+    output.Bitangent = normalize(mul(normalMat, bitangent));
 #endif
 
     output.TexCoord = input.TexCoord;
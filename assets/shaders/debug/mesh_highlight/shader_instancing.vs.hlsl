@@ -2,15 +2,26 @@ struct VSInput
 {
 #ifdef __spirv__
     [[vk::location(0)]] float3 Position   : POSITION0;
-    [[vk::location(1)]] float3 Normal     : NORMAL1;  
+    [[vk::location(1)]] float2 Normal     : NORMAL1;  
     [[vk::location(2)]] float4x4 Instance : INSTANCE2;  
 #else
     float3 Position : POSITION0;
-    float3 Normal : NORMAL1;
+    float2 Normal : NORMAL1; // octahedral
     float4x4 Instance : INSTANCE2;
 #endif
 };
 
+// see VertexLayout (utils/buffer/vertex_layout.h)
+float3 DecodeOctahedral(float2 e)
+{
+    float3 v = float3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+    {
+        v.xy = (1.0 - abs(v.yx)) * (step(0.0, v.xy) * 2.0 - 1.0);
+    }
+    return normalize(v);
+}
+
 struct ViewUniformBuffer
 {
     float4x4 V;
@@ -75,9 +86,9 @@ VSOutput main(VSInput input)
     };
 
 #ifdef __spirv__
-    float3 worldNormal = normalize(mul(input.Normal,    normalMat));
+    float3 worldNormal = normalize(mul(DecodeOctahedral(input.Normal),    normalMat));
 #else
-    float3 worldNormal = normalize(mul(normalMat, input.Normal));
+    float3 worldNormal = normalize(mul(normalMat, DecodeOctahedral(input.Normal)));
 #endif
 
     worldPos.xyz += worldNormal * HighlightParams.Thickness;
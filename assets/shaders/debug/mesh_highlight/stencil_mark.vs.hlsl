@@ -3,11 +3,11 @@ struct VSInput
 {
 #ifdef __spirv__
     [[vk::location(0)]] float3 Position   : POSITION0;
-    [[vk::location(1)]] float3 Normal     : NORMAL1;  
+    [[vk::location(1)]] float2 Normal     : NORMAL1;  
     [[vk::location(2)]] float4x4 Instance : INSTANCE2;  
 #else
     float3 Position : POSITION0;
-    float3 Normal : NORMAL1;
+    float2 Normal : NORMAL1; // octahedral
     float4x4 Instance : INSTANCE2;
 #endif
 };
@@ -0,0 +1,161 @@
+#define THREAD_COUNT 64
+#define PLANE_COUNT 6
+
+struct CullConstants
+{
+    float4 Planes[PLANE_COUNT]; // xyz - inward normal, w - distance
+    uint DrawGroupCount;
+    uint GroupsPerRow;
+    uint2 padding0;
+};
+
+cbuffer CullParam : register(b0, space0)
+{
+    CullConstants CullParam;
+}
+
+// instance matrix as stored on the CPU (row vectors, translation in the last row)
+struct InstanceData
+{
+    float4 Row0;
+    float4 Row1;
+    float4 Row2;
+    float4 Row3;
+};
+
+// must match GpuCuller::DrawGroupData
+struct DrawGroup
+{
+    float3 BoundsMin;
+    uint BoundsValid;
+    float3 BoundsMax;
+    uint IndexCount;
+    uint FirstIndex;
+    int VertexOffset;
+    uint FirstInstance;
+    uint InstanceCount;
+    uint FirstVisibleOffset;
+    uint DrawInfo;
+    uint2 padding0;
+    InstanceData MeshMatrix;
+};
+
+struct DrawIndexedIndirectCommand
+{
+    uint IndexCount;
+    uint InstanceCount;
+    uint FirstIndex;
+    int VertexOffset;
+    uint FirstInstance;
+};
+
+StructuredBuffer<DrawGroup> drawGroups : register(t1, space0);
+StructuredBuffer<InstanceData> instances : register(t2, space0);
+RWStructuredBuffer<InstanceData> visibleInstances : register(u3, space0);
+RWStructuredBuffer<DrawIndexedIndirectCommand> drawCommands : register(u4, space0);
+RWStructuredBuffer<uint> drawCounts : register(u5, space0); // [0] - visible groups, [1] - empty groups
+RWStructuredBuffer<uint> visibleDrawInfos : register(u6, space0);
+
+groupshared uint visibleCount;
+
+bool IsVisible(DrawGroup group, InstanceData instance)
+{
+    if (group.BoundsValid == 0)
+    {
+        return true;
+    }
+
+    float3 center = (group.BoundsMin + group.BoundsMax) * 0.5;
+    float3 extent = (group.BoundsMax - group.BoundsMin) * 0.5;
+
+    // world space AABB of the transformed box (same as bounds::transformAABB on the CPU)
+    float3 worldCenter = center.x * instance.Row0.xyz + center.y * instance.Row1.xyz + center.z * instance.Row2.xyz
+                       + instance.Row3.xyz;
+    float3 worldExtent = extent.x * abs(instance.Row0.xyz) + extent.y * abs(instance.Row1.xyz)
+                       + extent.z * abs(instance.Row2.xyz);
+
+    [unroll]
+    for (uint i = 0; i < PLANE_COUNT; ++i)
+    {
+        float4 plane = CullParam.Planes[i];
+        float distance = dot(plane.xyz, worldCenter) + plane.w;
+        float radius = dot(abs(plane.xyz), worldExtent);
+        if (distance + radius < 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+float4 TransformRow(float4 row, InstanceData m)
+{
+    return row.x * m.Row0 + row.y * m.Row1 + row.z * m.Row2 + row.w * m.Row3;
+}
+
+// the mesh transform followed by the instance transform, so the draws need no per mesh matrix
+InstanceData ApplyMeshMatrix(InstanceData mesh, InstanceData instance)
+{
+    InstanceData result;
+    result.Row0 = TransformRow(mesh.Row0, instance);
+    result.Row1 = TransformRow(mesh.Row1, instance);
+    result.Row2 = TransformRow(mesh.Row2, instance);
+    result.Row3 = TransformRow(mesh.Row3, instance);
+    return result;
+}
+
+// one thread group per draw group, the threads walk the instances of the group
+[numthreads(THREAD_COUNT, 1, 1)]
+void main(uint3 groupId : SV_GroupID, uint threadIndex : SV_GroupIndex)
+{
+    uint drawGroupIndex = groupId.y * CullParam.GroupsPerRow + groupId.x;
+    if (drawGroupIndex >= CullParam.DrawGroupCount)
+    {
+        return;
+    }
+
+    if (threadIndex == 0)
+    {
+        visibleCount = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    DrawGroup group = drawGroups[drawGroupIndex];
+
+    for (uint i = threadIndex; i < group.InstanceCount; i += THREAD_COUNT)
+    {
+        InstanceData instance = instances[group.FirstInstance + i];
+        if (IsVisible(group, instance))
+        {
+            uint visibleIndex;
+            InterlockedAdd(visibleCount, 1, visibleIndex);
+            visibleInstances[group.FirstVisibleOffset + visibleIndex] = ApplyMeshMatrix(group.MeshMatrix, instance);
+            visibleDrawInfos[group.FirstVisibleOffset + visibleIndex] = group.DrawInfo;
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (threadIndex == 0)
+    {
+        DrawIndexedIndirectCommand command;
+        command.IndexCount = group.IndexCount;
+        command.InstanceCount = visibleCount;
+        command.FirstIndex = group.FirstIndex;
+        command.VertexOffset = group.VertexOffset;
+        command.FirstInstance = group.FirstVisibleOffset;
+
+        // visible groups are packed to the front (drawn up to drawCounts[0]), empty ones fill the back, so all
+        // DrawGroupCount commands are valid for draws without the count
+        uint commandIndex;
+        if (visibleCount > 0)
+        {
+            InterlockedAdd(drawCounts[0], 1, commandIndex);
+        }
+        else
+        {
+            InterlockedAdd(drawCounts[1], 1, commandIndex);
+            commandIndex = CullParam.DrawGroupCount - 1 - commandIndex;
+        }
+        drawCommands[commandIndex] = command;
+    }
+}
@@ -0,0 +1,138 @@
+#define THREAD_COUNT 64
+
+// must match LightClusterGrid::ClusterConstants
+struct ClusterConstants
+{
+    float4 ViewRows[4]; // view matrix as stored on the CPU (row vectors, translation in the last row)
+    float4 ViewDepthPlane;
+    float2 ScreenSize;
+    float2 ProjectionScale;
+    uint3 ClusterCount;
+    uint MaxLightsPerCluster;
+    float ZNear;
+    float ZFar;
+    float SliceScale;
+    float SliceBias;
+    uint PointLightCount;
+    uint SpotLightCount;
+    float2 ProjectionOffset;
+};
+
+cbuffer ClusterParam : register(b0, space0)
+{
+    ClusterConstants ClusterParam;
+}
+
+struct PointLightData
+{
+    float3 color;
+    float intensity;
+    float range;
+    float3 position;
+};
+
+struct SpotLightData
+{
+    float3 color;
+    float intensity;
+    float range;
+    float innerConeAngle;
+    float outerConeAngle;
+    float padding1;
+    float3 position;
+    float padding2;
+    float3 direction;
+    float padding3;
+};
+
+StructuredBuffer<PointLightData> pointLights : register(t1, space0);
+StructuredBuffer<SpotLightData> spotLights : register(t2, space0);
+
+// x - first index in lightIndices, y - point light count, z - spot light count
+RWStructuredBuffer<uint4> clusters : register(u3, space0);
+// MaxLightsPerCluster slots per cluster
+RWStructuredBuffer<uint> lightIndices : register(u4, space0);
+
+float3 ToView(float3 worldPos)
+{
+    return worldPos.x * ClusterParam.ViewRows[0].xyz + worldPos.y * ClusterParam.ViewRows[1].xyz
+         + worldPos.z * ClusterParam.ViewRows[2].xyz + ClusterParam.ViewRows[3].xyz;
+}
+
+// view space coordinates of an NDC coordinate at the depth
+float2 ToView(float2 ndc, float depth)
+{
+    return (ndc - ClusterParam.ProjectionOffset) * depth / ClusterParam.ProjectionScale;
+}
+
+bool SphereIntersectsBox(float3 center, float radius, float3 boxMin, float3 boxMax)
+{
+    float3 distance = max(max(boxMin - center, center - boxMax), 0.0);
+    return dot(distance, distance) <= radius * radius;
+}
+
+// one thread per cluster, same bounds as LightClusterGrid::updateClusterBounds_ on the CPU
+[numthreads(THREAD_COUNT, 1, 1)]
+void main(uint3 dispatchId : SV_DispatchThreadID)
+{
+    uint3 count = ClusterParam.ClusterCount;
+    uint clusterIndex = dispatchId.x;
+    if (clusterIndex >= count.x * count.y * count.z)
+    {
+        return;
+    }
+
+    uint x = clusterIndex % count.x;
+    uint y = (clusterIndex / count.x) % count.y;
+    uint z = clusterIndex / (count.x * count.y);
+
+    float depthRatio = ClusterParam.ZFar / ClusterParam.ZNear;
+    float nearDepth = ClusterParam.ZNear * pow(depthRatio, float(z) / count.z);
+    float farDepth = ClusterParam.ZNear * pow(depthRatio, float(z + 1) / count.z);
+
+    // rows go from the top of the screen, NDC y points up
+    float2 ndcMin = float2(-1.0 + 2.0 * x / count.x, 1.0 - 2.0 * (y + 1) / count.y);
+    float2 ndcMax = float2(-1.0 + 2.0 * (x + 1) / count.x, 1.0 - 2.0 * y / count.y);
+
+    float3 boxMin = float3(min(ToView(ndcMin, nearDepth), ToView(ndcMin, farDepth)), nearDepth);
+    float3 boxMax = float3(max(ToView(ndcMax, nearDepth), ToView(ndcMax, farDepth)), farDepth);
+
+    uint offset = clusterIndex * ClusterParam.MaxLightsPerCluster;
+    uint lightCount = 0;
+
+    for (uint i = 0; i < ClusterParam.PointLightCount && lightCount < ClusterParam.MaxLightsPerCluster; ++i)
+    {
+        PointLightData light = pointLights[i];
+        if (SphereIntersectsBox(ToView(light.position), light.range, boxMin, boxMax))
+        {
+            lightIndices[offset + lightCount++] = i;
+        }
+    }
+    uint pointLightCount = lightCount;
+
+    for (uint j = 0; j < ClusterParam.SpotLightCount && lightCount < ClusterParam.MaxLightsPerCluster; ++j)
+    {
+        SpotLightData light = spotLights[j];
+
+        // bounding sphere of the cone, the whole range sphere for wide or degenerate cones
+        float3 center = light.position;
+        float radius = light.range;
+        float angle = radians(light.outerConeAngle);
+        float cosAngle = cos(angle);
+        float sinAngle = sin(angle);
+        float dirLength = length(light.direction);
+        if (dirLength > 0.0 && cosAngle > 0.0)
+        {
+            float centerDistance = sinAngle > cosAngle ? cosAngle * light.range : light.range / (2.0 * cosAngle);
+            radius = sinAngle > cosAngle ? sinAngle * light.range : centerDistance;
+            center += light.direction / dirLength * centerDistance;
+        }
+
+        if (SphereIntersectsBox(ToView(center), radius, boxMin, boxMax))
+        {
+            lightIndices[offset + lightCount++] = j;
+        }
+    }
+
+    clusters[clusterIndex] = uint4(offset, pointLightCount, lightCount - pointLightCount, 0);
+}
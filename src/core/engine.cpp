@@ -9,9 +9,11 @@
 #include "ecs/systems/bounding_volume_system.h"
 #include "ecs/systems/camera_system.h"
 #include "ecs/systems/light_system.h"
+#include "ecs/systems/lod_system.h"
 #include "ecs/systems/movement_system.h"
 #include "ecs/systems/render_system.h"
 #include "ecs/systems/system_manager.h"
+#include "ecs/systems/transform_system.h"
 #include "event/application_event_manager.h"
 #include "event/window_event_manager.h"
 #include "gfx/renderer/render_resource_manager.h"
@@ -25,13 +27,18 @@
 #include "resources/cgltf/cgltf_material_loader.h"
 #include "resources/cgltf/cgltf_model_loader.h"
 #include "resources/cgltf/cgltf_render_model_loader.h"
+#include "resources/cooked/cooked_model_loader.h"
+#include "resources/cooked/cooked_render_model_loader.h"
 #include "scene/scene_loader.h"
 #include "scene/scene_manager.h"
 #include "utils/asset/asset_loader.h"
+#include "utils/asset/derived_data_cache.h"
 #include "utils/buffer/buffer_manager.h"
+#include "utils/buffer/geometry_arena.h"
 #include "utils/hot_reload/hot_reload_manager.h"
 #include "utils/image/image_loader_manager.h"
 #include "utils/image/image_manager.h"
+#include "utils/job/job_system.h"
 #include "utils/logger/console_logger.h"
 #include "utils/logger/file_logger.h"
 #include "utils/logger/global_logger.h"
@@ -39,6 +46,7 @@
 #include "utils/material/material_manager.h"
 #include "utils/math/math_util.h"
 #include "utils/model/mesh_manager.h"
+#include "utils/model/mesh_optimizer.h"
 #include "utils/model/model_manager.h"
 #include "utils/model/render_geometry_mesh_manager.h"
 #include "utils/model/render_mesh_manager.h"
@@ -76,12 +84,15 @@ Engine::~Engine() {
   ServiceLocator::s_remove<SystemManager>();
   ServiceLocator::s_remove<TimingManager>();
   ServiceLocator::s_remove<AssetLoader>();
+  ServiceLocator::s_remove<JobSystem>();
   ServiceLocator::s_remove<RenderModelManager>();
   ServiceLocator::s_remove<RenderModelLoaderManager>();
   ServiceLocator::s_remove<ImageManager>();
   ServiceLocator::s_remove<ImageLoaderManager>();
+  ServiceLocator::s_remove<DerivedDataCache>();
   ServiceLocator::s_remove<ResourceDeletionManager>();
   ServiceLocator::s_remove<TextureManager>();
+  ServiceLocator::s_remove<GeometryArena>();
   ServiceLocator::s_remove<BufferManager>();
   ServiceLocator::s_remove<gpu::GpuProfiler>();
 
@@ -179,6 +190,13 @@ auto Engine::initialize() -> bool {
   configManager->addConfig(configPath);
   auto config = configManager->getConfig(configPath);
 
+  // job system
+  // ------------------------------------------------------------------------
+  // 0 - use hardware concurrency
+  auto jobSystem = std::make_unique<JobSystem>();
+  jobSystem->initialize(config->get<std::uint32_t>("workerThreadCount"));
+  ServiceLocator::s_provide<JobSystem>(std::move(jobSystem));
+
   // rendering API
   // ------------------------------------------------------------------------
   gfx::rhi::RenderingApi renderingApi;
@@ -243,7 +261,15 @@ auto Engine::initialize() -> bool {
   auto systemManager = ServiceLocator::s_get<SystemManager>();
   systemManager->addSystem(std::make_unique<CameraSystem>());
   systemManager->addSystem(std::make_unique<MovementSystem>());
+  systemManager->addSystem(std::make_unique<TransformSystem>());
   systemManager->addSystem(std::make_unique<BoundingVolumeSystem>());
+
+  // a cross-fade duration of 0 switches the levels at once
+  LodSettings lodSettings;
+  lodSettings.maxScreenError    = config->get<float>("lodMaxScreenError");
+  lodSettings.crossFadeDuration = config->get<float>("lodCrossFadeDuration");
+  systemManager->addSystem(std::make_unique<LodSystem>(lodSettings));
+
   systemManager->addSystem(std::make_unique<RenderSystem>());
 
   // renderer
@@ -255,9 +281,16 @@ auto Engine::initialize() -> bool {
   auto device = m_renderer_->getDevice();
   ServiceLocator::s_provide<TextureManager>(device);
   ServiceLocator::s_provide<BufferManager>(device);
+  // vertex colors are only read by the wireframe view, meshes are stored without them unless enabled
+  ServiceLocator::s_provide<GeometryArena>(device, config->get<bool>("vertexColors"));
 
   systemManager->addSystem(std::make_unique<LightSystem>(device, m_renderer_->getResourceManager()));
 
+  // derived data cache
+  // ------------------------------------------------------------------------
+  // imported models, materials and decoded images, shared by the loaders below
+  ServiceLocator::s_provide<DerivedDataCache>(PathManager::s_getCachePath() / "derived_data");
+
   // image loader
   // ------------------------------------------------------------------------
   auto imageLoaderManager = std::make_unique<ImageLoaderManager>();
@@ -287,15 +320,22 @@ auto Engine::initialize() -> bool {
 
   // CPU
   ServiceLocator::s_provide<MeshManager>();
+
+  // 0 LODs - only the full meshes are imported
+  MeshOptimizerSettings meshOptimizerSettings;
+  meshOptimizerSettings.optimize = config->get<bool>("optimizeMeshes");
+  meshOptimizerSettings.lodCount = config->get<std::uint32_t>("meshLodCount");
+
   auto modelLoaderManager = std::make_unique<ModelLoaderManager>();
 #ifdef ARISE_USE_ASSIMP
-  auto assimpCpuModelLoader = std::make_shared<AssimpModelLoader>();
+  auto assimpCpuModelLoader = std::make_shared<AssimpModelLoader>(meshOptimizerSettings);
   modelLoaderManager->registerLoader(ModelType::OBJ, assimpCpuModelLoader);
   modelLoaderManager->registerLoader(ModelType::FBX, assimpCpuModelLoader);
 #endif  // ARISE_USE_ASSIMP
-  auto cgltfCpuModelLoader = std::make_shared<CgltfModelLoader>();
+  auto cgltfCpuModelLoader = std::make_shared<CgltfModelLoader>(meshOptimizerSettings);
   modelLoaderManager->registerLoader(ModelType::GLTF, cgltfCpuModelLoader);
   modelLoaderManager->registerLoader(ModelType::GLB, cgltfCpuModelLoader);
+  modelLoaderManager->registerLoader(ModelType::AMESH, std::make_shared<CookedModelLoader>());
   ServiceLocator::s_provide<ModelLoaderManager>(std::move(modelLoaderManager));
   ServiceLocator::s_provide<ModelManager>();
 
@@ -311,6 +351,7 @@ auto Engine::initialize() -> bool {
   auto cgltfModelLoader = std::make_shared<CgltfRenderModelLoader>();
   renderModelLoaderManager->registerLoader(ModelType::GLTF, cgltfModelLoader);
   renderModelLoaderManager->registerLoader(ModelType::GLB, cgltfModelLoader);
+  renderModelLoaderManager->registerLoader(ModelType::AMESH, std::make_shared<CookedRenderModelLoader>());
   ServiceLocator::s_provide<RenderModelLoaderManager>(std::move(renderModelLoaderManager));
   auto renderModelManager = std::make_unique<RenderModelManager>();
   ServiceLocator::s_provide<RenderModelManager>(std::move(renderModelManager));
@@ -429,6 +470,16 @@ void Engine::processEvents_() {
 }
 
 void Engine::update_(float deltaTime) {
+  // components of finished loads are added before the systems run
+  if (auto assetLoader = ServiceLocator::s_get<AssetLoader>()) {
+    assetLoader->dispatchCompletedLoads();
+  }
+
+  // meshes that didn't fit the geometry buffers are placed before anything draws them
+  if (auto geometryArena = ServiceLocator::s_get<GeometryArena>()) {
+    geometryArena->update();
+  }
+
   auto systemManager = ServiceLocator::s_get<SystemManager>();
   auto scene         = ServiceLocator::s_get<SceneManager>()->getCurrentScene();
   systemManager->updateSystems(scene, deltaTime);
@@ -2,6 +2,9 @@
 
 #include <core/engine.h>
 #include <core/application.h>
+#include <utils/model/mesh_cooker.h>
+
+#include <string_view>
 
 using namespace arise;
 
@@ -14,6 +17,13 @@ int WINAPI wWinMain(_In_ HINSTANCE     hInstance,
 #else
 auto main(int argc, char* argv[]) -> int {
 
+#endif
+
+#if !((defined(_WIN32) || defined(_WIN64)) && defined(ARISE_WINDOWS_SUBSYSTEM))
+  // offline mesh cooking doesn't need a window or a renderer
+  if (argc > 1 && std::string_view(argv[1]) == "--cook-meshes") {
+    return MeshCooker::s_runCommandLine(argc - 2, argv + 2);
+  }
 #endif
 
   // Inform SDL that the program will handle its own initialization
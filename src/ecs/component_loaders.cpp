@@ -1,6 +1,7 @@
 #include "ecs/component_loaders.h"
 
 #include "config/config_manager.h"
+#include "ecs/components/bounding_volume.h"
 #include "ecs/components/camera.h"
 #include "ecs/components/light.h"
 #include "ecs/components/movement.h"
@@ -231,6 +232,7 @@ void g_processEntityComponents(Registry& registry, Entity entity, const ConfigVa
                 if (renderModel && model) {
                   registryPtr->emplace<Model*>(entity, model);
                   registryPtr->emplace<RenderModel*>(entity, renderModel);
+                  registryPtr->emplace_or_replace<WorldBounds>(entity);
                   GlobalLogger::Log(LogLevel::Info, "Async model loaded and added to entity: " + modelPath);
                 }
               }
@@ -248,6 +250,7 @@ void g_processEntityComponents(Registry& registry, Entity entity, const ConfigVa
             if (renderModel && model) {
               registry.emplace<Model*>(entity, model);
               registry.emplace<RenderModel*>(entity, renderModel);
+              registry.emplace_or_replace<WorldBounds>(entity);
             } else {
               GlobalLogger::Log(LogLevel::Error, "Failed to load model: " + modelPath);
             }
@@ -5,8 +5,14 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <limits>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARISE_BOUNDS_USE_SSE
+#endif
+
 namespace arise {
 namespace bounds {
 
@@ -39,6 +45,109 @@ BoundingBox calculateAABBFromRange(Iterator begin, Iterator end) {
   box.max = maxVec;
   return box;
 }
+
+// Transforms the box as center / half extent instead of transforming all 8 corners (J. Arvo, "Transforming Axis-Aligned
+// Bounding Boxes"). The matrix is row-major and applied to row vectors, so row 3 holds the translation.
+#ifdef ARISE_BOUNDS_USE_SSE
+inline void transformAABBCenterExtent(const BoundingBox& box, const float* matrix, BoundingBox& outBox) {
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+  const __m128 row0 = _mm_loadu_ps(matrix + 0);
+  const __m128 row1 = _mm_loadu_ps(matrix + 4);
+  const __m128 row2 = _mm_loadu_ps(matrix + 8);
+  const __m128 row3 = _mm_loadu_ps(matrix + 12);
+
+  const math::Vector3f center = getCenter(box);
+  const math::Vector3f extent = (box.max - box.min) * 0.5f;
+
+  __m128 newCenter = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(center.x()), row0), row3);
+  newCenter        = _mm_add_ps(newCenter, _mm_mul_ps(_mm_set1_ps(center.y()), row1));
+  newCenter        = _mm_add_ps(newCenter, _mm_mul_ps(_mm_set1_ps(center.z()), row2));
+
+  __m128 newExtent = _mm_mul_ps(_mm_set1_ps(extent.x()), _mm_and_ps(row0, absMask));
+  newExtent        = _mm_add_ps(newExtent, _mm_mul_ps(_mm_set1_ps(extent.y()), _mm_and_ps(row1, absMask)));
+  newExtent        = _mm_add_ps(newExtent, _mm_mul_ps(_mm_set1_ps(extent.z()), _mm_and_ps(row2, absMask)));
+
+  alignas(16) float minValues[4];
+  alignas(16) float maxValues[4];
+  _mm_store_ps(minValues, _mm_sub_ps(newCenter, newExtent));
+  _mm_store_ps(maxValues, _mm_add_ps(newCenter, newExtent));
+
+  outBox.min = math::Vector3f(minValues[0], minValues[1], minValues[2]);
+  outBox.max = math::Vector3f(maxValues[0], maxValues[1], maxValues[2]);
+}
+#else
+inline void transformAABBCenterExtent(const BoundingBox& box, const float* matrix, BoundingBox& outBox) {
+  const math::Vector3f center = getCenter(box);
+  const math::Vector3f extent = (box.max - box.min) * 0.5f;
+
+  float newCenter[3];
+  float newExtent[3];
+  for (int column = 0; column < 3; ++column) {
+    newCenter[column] = center.x() * matrix[0 + column] + center.y() * matrix[4 + column]
+                      + center.z() * matrix[8 + column] + matrix[12 + column];
+    newExtent[column] = extent.x() * std::abs(matrix[0 + column]) + extent.y() * std::abs(matrix[4 + column])
+                      + extent.z() * std::abs(matrix[8 + column]);
+  }
+
+  outBox.min = math::Vector3f(newCenter[0] - newExtent[0], newCenter[1] - newExtent[1], newCenter[2] - newExtent[2]);
+  outBox.max = math::Vector3f(newCenter[0] + newExtent[0], newCenter[1] + newExtent[1], newCenter[2] + newExtent[2]);
+}
+#endif
+
+#ifdef ARISE_BOUNDS_USE_SSE
+inline bool intersectsFrustum(const Frustum& frustum, const BoundingBox& box) {
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+  const math::Vector3f center = getCenter(box);
+  const math::Vector3f extent = (box.max - box.min) * 0.5f;
+
+  const __m128 centerX = _mm_set1_ps(center.x());
+  const __m128 centerY = _mm_set1_ps(center.y());
+  const __m128 centerZ = _mm_set1_ps(center.z());
+  const __m128 extentX = _mm_set1_ps(extent.x());
+  const __m128 extentY = _mm_set1_ps(extent.y());
+  const __m128 extentZ = _mm_set1_ps(extent.z());
+
+  for (std::size_t plane = 0; plane < Frustum::s_paddedPlaneCount; plane += 4) {
+    const __m128 normalX = _mm_load_ps(frustum.normalX + plane);
+    const __m128 normalY = _mm_load_ps(frustum.normalY + plane);
+    const __m128 normalZ = _mm_load_ps(frustum.normalZ + plane);
+
+    // signed distance of the box center and projected radius of the box onto the plane normals
+    __m128 distance = _mm_add_ps(_mm_mul_ps(normalX, centerX), _mm_load_ps(frustum.distance + plane));
+    distance        = _mm_add_ps(distance, _mm_mul_ps(normalY, centerY));
+    distance        = _mm_add_ps(distance, _mm_mul_ps(normalZ, centerZ));
+
+    __m128 radius = _mm_mul_ps(_mm_and_ps(normalX, absMask), extentX);
+    radius        = _mm_add_ps(radius, _mm_mul_ps(_mm_and_ps(normalY, absMask), extentY));
+    radius        = _mm_add_ps(radius, _mm_mul_ps(_mm_and_ps(normalZ, absMask), extentZ));
+
+    if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps())) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+#else
+inline bool intersectsFrustum(const Frustum& frustum, const BoundingBox& box) {
+  const math::Vector3f center = getCenter(box);
+  const math::Vector3f extent = (box.max - box.min) * 0.5f;
+
+  for (std::size_t plane = 0; plane < Frustum::s_planeCount; ++plane) {
+    float distance = frustum.normalX[plane] * center.x() + frustum.normalY[plane] * center.y()
+                   + frustum.normalZ[plane] * center.z() + frustum.distance[plane];
+    float radius   = std::abs(frustum.normalX[plane]) * extent.x() + std::abs(frustum.normalY[plane]) * extent.y()
+                 + std::abs(frustum.normalZ[plane]) * extent.z();
+    if (distance + radius < 0.0f) {
+      return false;
+    }
+  }
+
+  return true;
+}
+#endif
 }  // anonymous namespace
 
 BoundingBox calculateAABB(const std::vector<math::Vector3f>& positions) {
@@ -67,32 +176,22 @@ BoundingBox calculateAABB(const std::vector<Vertex>& vertices) {
 }
 
 BoundingBox transformAABB(const BoundingBox& aabb, const math::Matrix4f<>& transform) {
-  if (!isValid(aabb)) {
-    return aabb;
-  }
-
-  std::vector<math::Vector3f> transformedCorners;
-  transformedCorners.reserve(8);
-
-  std::array<math::Vector3f, 8> corners = {
-    {math::Vector3f(aabb.min.x(), aabb.min.y(), aabb.min.z()),
-     math::Vector3f(aabb.max.x(), aabb.min.y(), aabb.min.z()),
-     math::Vector3f(aabb.min.x(), aabb.max.y(), aabb.min.z()),
-     math::Vector3f(aabb.max.x(), aabb.max.y(), aabb.min.z()),
-     math::Vector3f(aabb.min.x(), aabb.min.y(), aabb.max.z()),
-     math::Vector3f(aabb.max.x(), aabb.min.y(), aabb.max.z()),
-     math::Vector3f(aabb.min.x(), aabb.max.y(), aabb.max.z()),
-     math::Vector3f(aabb.max.x(), aabb.max.y(), aabb.max.z())}
-  };
+  BoundingBox result;
+  transformAABBs(&aabb, &transform, &result, 1);
+  return result;
+}
 
-  for (const auto& corner : corners) {
-    math::Vector4f homogeneous(corner.x(), corner.y(), corner.z(), 1.0f);
-    math::Vector4f transformed = homogeneous;
-    transformed                *= transform;
-    transformedCorners.emplace_back(transformed.x(), transformed.y(), transformed.z());
+void transformAABBs(const BoundingBox*      boxes,
+                    const math::Matrix4f<>* transforms,
+                    BoundingBox*            outBoxes,
+                    std::size_t             count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!isValid(boxes[i])) {
+      outBoxes[i] = boxes[i];
+      continue;
+    }
+    transformAABBCenterExtent(boxes[i], transforms[i].data(), outBoxes[i]);
   }
-
-  return calculateAABBFromRange(transformedCorners.begin(), transformedCorners.end());
 }
 
 BoundingBox combineAABBs(const std::vector<BoundingBox>& boxes) {
@@ -119,5 +218,115 @@ BoundingBox combineAABBs(const std::vector<BoundingBox>& boxes) {
   return calculateAABBFromRange(allPoints.begin(), allPoints.end());
 }
 
+Frustum extractFrustum(const math::Matrix4f<>& viewProjection) {
+  // with row vectors clip = p * M, so the clip coordinates are dot products with the matrix columns
+  const float* m      = viewProjection.data();
+  auto         column = [m](int index) {
+    return std::array<float, 4>{m[0 + index], m[4 + index], m[8 + index], m[12 + index]};
+  };
+
+  const auto x = column(0);
+  const auto y = column(1);
+  const auto z = column(2);
+  const auto w = column(3);
+
+  std::array<float, 4> planes[Frustum::s_planeCount];
+  for (int i = 0; i < 4; ++i) {
+    planes[0][i] = w[i] + x[i];  // left
+    planes[1][i] = w[i] - x[i];  // right
+    planes[2][i] = w[i] + y[i];  // bottom
+    planes[3][i] = w[i] - y[i];  // top
+    planes[4][i] = z[i];         // near (0..1 depth)
+    planes[5][i] = w[i] - z[i];  // far
+  }
+
+  Frustum frustum;
+  for (std::size_t i = 0; i < Frustum::s_planeCount; ++i) {
+    float length = std::sqrt(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+    float scale  = length > 0.0f ? 1.0f / length : 0.0f;
+
+    frustum.normalX[i]  = planes[i][0] * scale;
+    frustum.normalY[i]  = planes[i][1] * scale;
+    frustum.normalZ[i]  = planes[i][2] * scale;
+    frustum.distance[i] = planes[i][3] * scale;
+  }
+
+  return frustum;
+}
+
+bool intersects(const Frustum& frustum, const BoundingBox& box) {
+  if (!isValid(box)) {
+    return false;
+  }
+  return intersectsFrustum(frustum, box);
+}
+
+void testFrustum(const Frustum& frustum, const BoundingBox* boxes, uint8_t* outVisible, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    outVisible[i] = isValid(boxes[i]) && intersectsFrustum(frustum, boxes[i]) ? 1 : 0;
+  }
+}
+
+FrustumTestResult classify(const Frustum& frustum, const BoundingBox& box) {
+  if (!isValid(box)) {
+    return FrustumTestResult::Outside;
+  }
+
+  const math::Vector3f center = getCenter(box);
+  const math::Vector3f extent = (box.max - box.min) * 0.5f;
+
+  FrustumTestResult result = FrustumTestResult::Inside;
+  for (std::size_t plane = 0; plane < Frustum::s_planeCount; ++plane) {
+    float distance = frustum.normalX[plane] * center.x() + frustum.normalY[plane] * center.y()
+                   + frustum.normalZ[plane] * center.z() + frustum.distance[plane];
+    float radius   = std::abs(frustum.normalX[plane]) * extent.x() + std::abs(frustum.normalY[plane]) * extent.y()
+                 + std::abs(frustum.normalZ[plane]) * extent.z();
+    if (distance + radius < 0.0f) {
+      return FrustumTestResult::Outside;
+    }
+    if (distance - radius < 0.0f) {
+      result = FrustumTestResult::Intersecting;
+    }
+  }
+
+  return result;
+}
+
+bool intersects(const BoundingBox& box, const Ray& ray, float maxDistance, float& outDistance) {
+  float entry = 0.0f;
+  float exit  = maxDistance;
+
+  for (int axis = 0; axis < 3; ++axis) {
+    float origin    = axis == 0 ? ray.origin.x() : (axis == 1 ? ray.origin.y() : ray.origin.z());
+    float direction = axis == 0 ? ray.direction.x() : (axis == 1 ? ray.direction.y() : ray.direction.z());
+    float boxMin    = axis == 0 ? box.min.x() : (axis == 1 ? box.min.y() : box.min.z());
+    float boxMax    = axis == 0 ? box.max.x() : (axis == 1 ? box.max.y() : box.max.z());
+
+    if (std::abs(direction) < std::numeric_limits<float>::epsilon()) {
+      // parallel to the slab
+      if (origin < boxMin || origin > boxMax) {
+        return false;
+      }
+      continue;
+    }
+
+    float inverseDirection = 1.0f / direction;
+    float t0               = (boxMin - origin) * inverseDirection;
+    float t1               = (boxMax - origin) * inverseDirection;
+    if (t0 > t1) {
+      std::swap(t0, t1);
+    }
+
+    entry = std::max(entry, t0);
+    exit  = std::min(exit, t1);
+    if (entry > exit) {
+      return false;
+    }
+  }
+
+  outDistance = entry;
+  return true;
+}
+
 }  // namespace bounds
 }  // namespace arise
\ No newline at end of file
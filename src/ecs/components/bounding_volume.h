@@ -3,6 +3,10 @@
 
 #include <math_library/vector.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace arise {
@@ -19,6 +23,34 @@ struct WorldBounds {
   bool        isDirty = true;
 };
 
+/**
+ * Six view frustum planes (left, right, bottom, top, near, far) pointing inwards - a point p is inside the plane when
+ * dot(normal, p) + distance >= 0.
+ *
+ * Stored as structure of arrays and padded to 8 planes, so the SIMD path tests 4 planes at once. Padding planes
+ * accept everything.
+ */
+struct Frustum {
+  static constexpr std::size_t s_planeCount       = 6;
+  static constexpr std::size_t s_paddedPlaneCount = 8;
+
+  alignas(16) float normalX[s_paddedPlaneCount]  = {};
+  alignas(16) float normalY[s_paddedPlaneCount]  = {};
+  alignas(16) float normalZ[s_paddedPlaneCount]  = {};
+  alignas(16) float distance[s_paddedPlaneCount] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+};
+
+struct Ray {
+  math::Vector3f origin;
+  math::Vector3f direction;  // doesn't have to be normalized, distances are measured in direction lengths
+};
+
+enum class FrustumTestResult : uint8_t {
+  Outside,
+  Intersecting,
+  Inside,
+};
+
 namespace bounds {
 
 inline math::Vector3f getSize(const BoundingBox& box) {
@@ -66,14 +98,69 @@ inline bool intersects(const BoundingBox& a, const BoundingBox& b) {
       && (a.min.z() <= b.max.z() && a.max.z() >= b.min.z());
 }
 
+inline BoundingBox combine(const BoundingBox& a, const BoundingBox& b) {
+  BoundingBox box;
+  box.min = math::Vector3f(
+      std::min(a.min.x(), b.min.x()), std::min(a.min.y(), b.min.y()), std::min(a.min.z(), b.min.z()));
+  box.max = math::Vector3f(
+      std::max(a.max.x(), b.max.x()), std::max(a.max.y(), b.max.y()), std::max(a.max.z(), b.max.z()));
+  return box;
+}
+
+inline bool contains(const BoundingBox& outer, const BoundingBox& inner) {
+  return outer.min.x() <= inner.min.x() && outer.min.y() <= inner.min.y() && outer.min.z() <= inner.min.z()
+      && outer.max.x() >= inner.max.x() && outer.max.y() >= inner.max.y() && outer.max.z() >= inner.max.z();
+}
+
+inline BoundingBox expand(const BoundingBox& box, float margin) {
+  BoundingBox result;
+  result.min = box.min - math::Vector3f(margin);
+  result.max = box.max + math::Vector3f(margin);
+  return result;
+}
+
+inline float getSurfaceArea(const BoundingBox& box) {
+  math::Vector3f size = getSize(box);
+  return 2.0f * (size.x() * size.y() + size.y() * size.z() + size.z() * size.x());
+}
+
+// Squared distance from the point to the closest point of the box, 0 if the point is inside
+inline float distanceSquared(const BoundingBox& box, const math::Vector3f& point) {
+  float dx = std::max({box.min.x() - point.x(), 0.0f, point.x() - box.max.x()});
+  float dy = std::max({box.min.y() - point.y(), 0.0f, point.y() - box.max.y()});
+  float dz = std::max({box.min.z() - point.z(), 0.0f, point.z() - box.max.z()});
+  return dx * dx + dy * dy + dz * dz;
+}
+
 BoundingBox calculateAABB(const std::vector<Vertex>& vertices);
 
 BoundingBox calculateAABB(const std::vector<math::Vector3f>& positions);
 
 BoundingBox transformAABB(const BoundingBox& aabb, const math::Matrix4f<>& transform);
 
+// Batch version of transformAABB: outBoxes[i] = transformAABB(boxes[i], transforms[i]). Uses SSE when available.
+void transformAABBs(const BoundingBox*      boxes,
+                    const math::Matrix4f<>* transforms,
+                    BoundingBox*            outBoxes,
+                    std::size_t             count);
+
 BoundingBox combineAABBs(const std::vector<BoundingBox>& boxes);
 
+// Extracts normalized frustum planes from a (row-major, row vector) view * projection matrix with 0..1 depth range
+Frustum extractFrustum(const math::Matrix4f<>& viewProjection);
+
+// Returns false only if the box is completely outside of the frustum (conservative test)
+bool intersects(const Frustum& frustum, const BoundingBox& box);
+
+// Unlike intersects() also tells whether the box is completely inside, used to skip tests of whole subtrees
+FrustumTestResult classify(const Frustum& frustum, const BoundingBox& box);
+
+// Slab test. On hit outDistance is the entry distance along the ray (0 if the origin is inside the box).
+bool intersects(const BoundingBox& box, const Ray& ray, float maxDistance, float& outDistance);
+
+// Batch version of the frustum test: outVisible[i] = intersects(frustum, boxes[i]). Uses SSE when available.
+void testFrustum(const Frustum& frustum, const BoundingBox* boxes, uint8_t* outVisible, std::size_t count);
+
 }  // namespace bounds
 
 }  // namespace arise
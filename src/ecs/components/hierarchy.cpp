@@ -0,0 +1,121 @@
+#include "ecs/components/hierarchy.h"
+
+#include "ecs/components/transform.h"
+#include "utils/logger/global_logger.h"
+
+#include <vector>
+
+namespace arise {
+namespace hierarchy {
+
+namespace {
+
+// Updates depth of the whole subtree and marks it dirty, so TransformSystem recalculates the world matrices
+void updateSubtreeDepth(Registry& registry, entt::entity root, uint32_t depth) {
+  std::vector<std::pair<entt::entity, uint32_t>> stack;
+  stack.emplace_back(root, depth);
+
+  while (!stack.empty()) {
+    auto [entity, entityDepth] = stack.back();
+    stack.pop_back();
+
+    auto& node = registry.get<Hierarchy>(entity);
+    node.depth = entityDepth;
+
+    if (auto* transform = registry.try_get<Transform>(entity)) {
+      transform->isDirty = true;
+    }
+
+    for (auto child = node.firstChild; child != entt::null; child = registry.get<Hierarchy>(child).nextSibling) {
+      stack.emplace_back(child, entityDepth + 1);
+    }
+  }
+}
+
+}  // anonymous namespace
+
+bool setParent(Registry& registry, entt::entity child, entt::entity parent) {
+  if (!registry.valid(child) || (parent != entt::null && !registry.valid(parent))) {
+    GlobalLogger::Log(LogLevel::Warning, "Hierarchy: invalid entity passed to setParent");
+    return false;
+  }
+
+  if (child == parent || (parent != entt::null && isDescendantOf(registry, parent, child))) {
+    GlobalLogger::Log(LogLevel::Warning, "Hierarchy: setParent would create a cycle");
+    return false;
+  }
+
+  detach(registry, child);
+
+  if (parent == entt::null) {
+    return true;
+  }
+
+  // emplace both first - adding a component may move the others in the storage
+  registry.get_or_emplace<Hierarchy>(parent);
+  registry.get_or_emplace<Hierarchy>(child);
+
+  auto& parentNode = registry.get<Hierarchy>(parent);
+  auto& childNode  = registry.get<Hierarchy>(child);
+
+  childNode.parent      = parent;
+  childNode.prevSibling = entt::null;
+  childNode.nextSibling = parentNode.firstChild;
+  if (parentNode.firstChild != entt::null) {
+    registry.get<Hierarchy>(parentNode.firstChild).prevSibling = child;
+  }
+  parentNode.firstChild = child;
+
+  updateSubtreeDepth(registry, child, parentNode.depth + 1);
+  return true;
+}
+
+void detach(Registry& registry, entt::entity entity) {
+  auto* node = registry.try_get<Hierarchy>(entity);
+  if (!node || node->parent == entt::null) {
+    return;
+  }
+
+  if (node->prevSibling != entt::null) {
+    registry.get<Hierarchy>(node->prevSibling).nextSibling = node->nextSibling;
+  } else if (auto* parentNode = registry.try_get<Hierarchy>(node->parent)) {
+    parentNode->firstChild = node->nextSibling;
+  }
+
+  if (node->nextSibling != entt::null) {
+    registry.get<Hierarchy>(node->nextSibling).prevSibling = node->prevSibling;
+  }
+
+  node->parent      = entt::null;
+  node->prevSibling = entt::null;
+  node->nextSibling = entt::null;
+
+  updateSubtreeDepth(registry, entity, 0);
+}
+
+void release(Registry& registry, entt::entity entity) {
+  auto* node = registry.try_get<Hierarchy>(entity);
+  if (!node) {
+    return;
+  }
+
+  while (node->firstChild != entt::null) {
+    detach(registry, node->firstChild);
+  }
+
+  detach(registry, entity);
+}
+
+bool isDescendantOf(const Registry& registry, entt::entity entity, entt::entity ancestor) {
+  const auto* node = registry.try_get<Hierarchy>(entity);
+  while (node && node->parent != entt::null) {
+    if (node->parent == ancestor) {
+      return true;
+    }
+    node = registry.try_get<Hierarchy>(node->parent);
+  }
+  return false;
+}
+
+}  // namespace hierarchy
+}  // namespace arise
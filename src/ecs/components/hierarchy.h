@@ -0,0 +1,43 @@
+#ifndef ARISE_HIERARCHY_H
+#define ARISE_HIERARCHY_H
+
+#include "scene/scene.h"
+
+#include <cstdint>
+
+namespace arise {
+
+/**
+ * Parent / child relation between entities. Children are stored as an intrusive linked list, so the component has a
+ * fixed size. The world matrix of a child is its local Transform relative to the parent's WorldMatrix.
+ *
+ * Do not modify the links directly, use hierarchy::setParent / hierarchy::detach.
+ */
+struct Hierarchy {
+  entt::entity parent      = entt::null;
+  entt::entity firstChild  = entt::null;
+  entt::entity nextSibling = entt::null;
+  entt::entity prevSibling = entt::null;
+
+  // distance to the root, TransformSystem processes entities in depth order
+  uint32_t depth = 0;
+};
+
+namespace hierarchy {
+
+// Attaches child to parent (entt::null makes the child a root). Returns false if it would create a cycle.
+bool setParent(Registry& registry, entt::entity child, entt::entity parent);
+
+// Makes the entity a root, its own children stay attached to it.
+void detach(Registry& registry, entt::entity entity);
+
+// Detaches the entity from its parent and turns its children into roots. Call before destroying the entity.
+void release(Registry& registry, entt::entity entity);
+
+bool isDescendantOf(const Registry& registry, entt::entity entity, entt::entity ancestor);
+
+}  // namespace hierarchy
+
+}  // namespace arise
+
+#endif  // ARISE_HIERARCHY_H
@@ -6,21 +6,20 @@
 namespace arise {
 
 // TODO: consider adding a base class inside all light types(Directional, Point, Spot) for better cache locality
+// LightSystem tracks the components through registry signals: modify them with registry.patch (or patch after the
+// change), otherwise the GPU copy isn't updated
 struct Light {
   math::Vector3f color;
   float           intensity;
-  bool            isDirty = true;
   bool            enabled = true;
 };
 
 struct DirectionalLight {
   math::Vector3f direction;
-  bool            isDirty = true;
 };
 
 struct PointLight {
   float range;
-  bool  isDirty = true;
 };
 
 struct SpotLight {
@@ -29,7 +28,6 @@ struct SpotLight {
   float range;
   float innerConeAngle;
   float outerConeAngle;
-  bool  isDirty = true;
 };
 
 }  // namespace arise
@@ -0,0 +1,36 @@
+#ifndef ARISE_LOD_H
+#define ARISE_LOD_H
+
+#include <cstdint>
+
+namespace arise {
+
+// Cross-fades are drawn with this many dither thresholds, the renderer batches instances by the quantized fade. The
+// dither range of a draw reaches the shaders in its per instance draw info, not in constants bound per draw
+constexpr uint32_t LOD_FADE_STEPS = 16;
+
+/**
+ * Mesh level of detail an entity is drawn with, selected by LodSystem (0 is the full mesh, see MeshLod). Every mesh of
+ * the model is drawn with the same level, meshes with fewer levels draw their coarsest one.
+ *
+ * While the level changes, both levels are drawn with complementary dither patterns until the fade completes.
+ */
+struct Lod {
+  uint8_t level         = 0;
+  uint8_t previousLevel = 0;     // faded out while fade < 1
+  float   fade          = 1.0f;  // 0 - previous level only, 1 - the cross-fade is done
+
+  bool isFading() const { return fade < 1.0f && previousLevel != level; }
+
+  // 0 when the previous level is fully visible, LOD_FADE_STEPS when the cross-fade is done
+  uint32_t getFadeStep() const {
+    if (!isFading()) {
+      return LOD_FADE_STEPS;
+    }
+    return static_cast<uint32_t>(fade * static_cast<float>(LOD_FADE_STEPS));
+  }
+};
+
+}  // namespace arise
+
+#endif  // ARISE_LOD_H
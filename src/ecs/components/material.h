@@ -5,12 +5,54 @@
 
 #include <math_library/vector.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <string>
-#include <unordered_map>
 
 namespace arise {
 
+// texture slots of a material, the order is the order of the slots in the GPU material table
+enum class MaterialTexture : uint8_t {
+  Albedo,
+  NormalMap,
+  MetallicRoughness,
+  Count
+};
+
+constexpr size_t MATERIAL_TEXTURE_COUNT = static_cast<size_t>(MaterialTexture::Count);
+
+inline const char* g_getMaterialTextureName(MaterialTexture slot) {
+  switch (slot) {
+    case MaterialTexture::Albedo:
+      return "albedo";
+    case MaterialTexture::NormalMap:
+      return "normal_map";
+    case MaterialTexture::MetallicRoughness:
+      return "metallic_roughness";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * Parameters and textures of a material in fixed slots - read every frame by the renderer without any lookups.
+ * Missing textures are null, the renderer substitutes the default texture of the slot.
+ */
+struct MaterialData {
+  math::Vector4f baseColor = math::Vector4f(1.0f, 1.0f, 1.0f, 1.0f);
+  float          metallic  = 0.0f;
+  float          roughness = 1.0f;
+  float          opacity   = 1.0f;
+
+  std::array<gfx::rhi::Texture*, MATERIAL_TEXTURE_COUNT> textures = {};
+
+  gfx::rhi::Texture* getTexture(MaterialTexture slot) const { return textures[static_cast<size_t>(slot)]; }
+
+  void setTexture(MaterialTexture slot, gfx::rhi::Texture* texture) { textures[static_cast<size_t>(slot)] = texture; }
+};
+
 struct Material {
   std::string materialName;
 
@@ -20,16 +62,19 @@ struct Material {
   // characteristics of material (e.g. "PBR", "transparent", etc.)
   // std::set<std::string> tags;
 
-  // roughness, metallic
-  std::unordered_map<std::string, float> scalarParameters;
+  MaterialData data;
+
+  // source image of each texture slot, empty if the slot has no texture or the image is embedded in the source - lets
+  // the derived data cache recreate the textures without parsing the source
+  std::array<std::filesystem::path, MATERIAL_TEXTURE_COUNT> texturePaths;
 
-  // base color
-  std::unordered_map<std::string, math::Vector4f> vectorParameters;
+  const std::filesystem::path& getTexturePath(MaterialTexture slot) const {
+    return texturePaths[static_cast<size_t>(slot)];
+  }
 
-  // Textures associated with the material
-  // Keyed by texture name (e.g., "albedo", "normal")
-  // TODO: consider create enum class and use it as key
-  std::unordered_map<std::string, gfx::rhi::Texture*> textures;
+  void setTexturePath(MaterialTexture slot, std::filesystem::path path) {
+    texturePaths[static_cast<size_t>(slot)] = std::move(path);
+  }
 };
 
 }  // namespace arise
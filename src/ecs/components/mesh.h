@@ -4,11 +4,22 @@
 #include "ecs/components/bounding_volume.h"
 #include "ecs/components/vertex.h"
 
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace arise {
 
+class MappedFile;
+
+// Simplified version of a mesh, indexes the vertices of the full mesh (see MeshOptimizer)
+struct MeshLod {
+  uint32_t firstIndex = 0;     // into Mesh::getLodIndices()
+  uint32_t indexCount = 0;
+  float    error      = 0.0f;  // largest deviation from the full mesh, in mesh local units
+};
+
 // This is the geometry data on CPU side (imported from assimp / cgltf)
 struct Mesh {
   std::string           meshName;
@@ -16,6 +27,34 @@ struct Mesh {
   std::vector<uint32_t> indices;
   math::Matrix4f<>      transformMatrix = math::Matrix4f<>::Identity();
   BoundingBox           boundingBox; // in mesh local space
+  int32_t               nodeIndex = -1;  // index into Model::nodes, -1 if the mesh isn't attached to a node
+  int32_t               materialIndex = -1;  // index into the materials of the source file, -1 if the mesh has none
+
+  // LOD 1 and coarser, ordered by increasing error (the full mesh is LOD 0)
+  std::vector<MeshLod>  lods;
+  std::vector<uint32_t> lodIndices;
+
+  // cooked meshes point into the mapped file instead of owning the geometry (the vertex and index vectors stay empty),
+  // their vertices are only stored packed, as the GPU reads them
+  std::shared_ptr<const MappedFile> mappedFile;
+  PackedVertexStreams               mappedVertexStreams;
+  std::span<const uint32_t>         mappedIndices;
+  std::span<const uint32_t>         mappedLodIndices;
+
+  // Empty for cooked meshes, see mappedVertexStreams
+  std::span<const Vertex> getVertices() const { return std::span<const Vertex>(vertices); }
+
+  uint32_t getVertexCount() const {
+    return static_cast<uint32_t>(mappedFile ? mappedVertexStreams.positions.size() : vertices.size());
+  }
+
+  std::span<const uint32_t> getIndices() const {
+    return mappedFile ? mappedIndices : std::span<const uint32_t>(indices);
+  }
+
+  std::span<const uint32_t> getLodIndices() const {
+    return mappedFile ? mappedLodIndices : std::span<const uint32_t>(lodIndices);
+  }
 };
 
 }  // namespace arise
@@ -6,17 +6,36 @@
 
 #include <filesystem>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace arise {
 
+// Node of the source scene graph. Nodes are stored parents first, so world matrices can be computed in one pass.
+struct ModelNode {
+  std::string      name;
+  int32_t          parentIndex = -1;
+  math::Matrix4f<> localMatrix = math::Matrix4f<>::Identity();
+  math::Matrix4f<> worldMatrix = math::Matrix4f<>::Identity();  // relative to the model root
+};
+
 // This is the geometry data on CPU side (imported from assimp / cgltf)
 struct Model {
   // TODO: no modelNames (consider adding it, maybe filename is already okay)
-  std::filesystem::path filePath;
-  std::vector<Mesh*>    meshes;
-  BoundingBox           boundingBox; // in model space
+  std::filesystem::path  filePath;
+  std::vector<Mesh*>     meshes;
+  std::vector<ModelNode> nodes;        // empty if the source format has no node hierarchy
+  BoundingBox            boundingBox;  // in model space
 };
 
+// Recalculates ModelNode::worldMatrix after local matrices changed (e.g. by animation)
+inline void updateNodeWorldMatrices(std::vector<ModelNode>& nodes) {
+  for (auto& node : nodes) {
+    node.worldMatrix = node.parentIndex >= 0 ? node.localMatrix * nodes[node.parentIndex].worldMatrix
+                                             : node.localMatrix;
+  }
+}
+
 }  // namespace arise
 
 #endif  // ARISE_MODEL_H
@@ -3,23 +3,72 @@
 
 #include "gfx/rhi/interface/buffer.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <vector>
 
 namespace arise {
 
+/**
+ * Vertex data of all meshes is kept in one buffer per stream (see GeometryArena), so a pass only fetches the streams
+ * its shaders read - a depth-only pass binds just the positions. The layouts are in utils/buffer/vertex_layout.h.
+ */
+enum class VertexStream : uint8_t {
+  Position,    // math::Vector3f
+  Attributes,  // PackedVertexAttributes
+  Color,       // rgba8 unorm, only stored when the arena keeps vertex colors
+  Count
+};
+
+constexpr size_t VERTEX_STREAM_COUNT = static_cast<size_t>(VertexStream::Count);
+
+// Index range of a simplified level (see MeshLod), it draws the vertices of the full mesh
+struct RenderGeometryMeshLod {
+  uint32_t indexOffset = 0;  // from RenderGeometryMesh::firstIndex
+  uint32_t indexCount  = 0;
+};
+
 // GPU-Side Mesh Geometry data
-// TODO: can we somehow manage vertex and index buffers? so we can have 1 big
-// vertex buffer for model and each mesh will reffer to the part of it
+// The buffers are shared by all meshes (see GeometryArena), the mesh is the range of them selected by the draw
+// arguments: firstIndex and vertexOffset (indices are relative to the first vertex of the mesh)
 struct RenderGeometryMesh {
-  gfx::rhi::Buffer* vertexBuffer;
-  gfx::rhi::Buffer* indexBuffer;
-
-  // TODO
-  //for convenience
-  // uint32_t vertexCount = 0;
-  // uint32_t indexCount  = 0;
-  // for vertex binding
-  // uint32_t vertexStride = 0;
+  std::array<gfx::rhi::Buffer*, VERTEX_STREAM_COUNT> vertexBuffers{};
+  gfx::rhi::Buffer*                                  indexBuffer = nullptr;
+
+  uint32_t vertexOffset = 0;
+  uint32_t vertexCount  = 0;
+  uint32_t firstIndex   = 0;
+  uint32_t indexCount   = 0;  // of the full mesh (LOD 0)
+
+  // LOD 1 and coarser, their indices follow the indices of the full mesh in the arena
+  std::vector<RenderGeometryMeshLod> lods;
+
+  uint32_t getLodCount() const { return static_cast<uint32_t>(lods.size()) + 1; }
+
+  // Levels past the coarsest one draw the coarsest one, so all meshes of a model can be drawn with the model's level
+  uint32_t getFirstIndex(uint32_t level) const {
+    if (level == 0 || lods.empty()) {
+      return firstIndex;
+    }
+    return firstIndex + lods[std::min<size_t>(level, lods.size()) - 1].indexOffset;
+  }
+
+  uint32_t getIndexCount(uint32_t level) const {
+    if (level == 0 || lods.empty()) {
+      return indexCount;
+    }
+    return lods[std::min<size_t>(level, lods.size()) - 1].indexCount;
+  }
+
+  // Indices of all levels, the size of the mesh's index range in the arena
+  uint32_t getTotalIndexCount() const {
+    uint32_t totalIndexCount = indexCount;
+    for (const auto& lod : lods) {
+      totalIndexCount = std::max(totalIndexCount, lod.indexOffset + lod.indexCount);
+    }
+    return totalIndexCount;
+  }
 };
 
 }  // namespace arise
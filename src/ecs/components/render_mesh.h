@@ -1,9 +1,12 @@
 #ifndef ARISE_RENDER_MESH_H
 #define ARISE_RENDER_MESH_H
 
+#include "ecs/components/bounding_volume.h"
 #include "ecs/components/material.h"
 #include "ecs/components/render_geometry_mesh.h"
 
+#include <math_library/matrix.h>
+
 #include <memory>
 
 namespace arise {
@@ -12,6 +15,8 @@ struct RenderMesh {
   RenderGeometryMesh* gpuMesh;
   Material*           material;
   gfx::rhi::Buffer*   transformMatrixBuffer = nullptr;
+  math::Matrix4f<>    transformMatrix       = math::Matrix4f<>::Identity();  // content of transformMatrixBuffer
+  BoundingBox         boundingBox;  // in model space (mesh transform already applied), used for culling
 };
 
 }  // namespace arise
@@ -3,6 +3,9 @@
 
 #include <math_library/vector.h>
 
+#include <cstdint>
+#include <span>
+
 namespace arise {
 
 struct Vertex {
@@ -14,6 +17,27 @@ struct Vertex {
   math::Vector4f color;
 };
 
+/**
+ * Normal and tangent as octahedral snorm16, texture coordinates as half. The bitangent is derived in the shader:
+ * cross(normal, tangent) * sign, the sign is folded into the second tangent component:
+ *   stored = sign * (1 + round((y * 0.5 + 0.5) * 32766))
+ * so the magnitude is never zero and the sign survives the snorm conversion.
+ */
+struct PackedVertexAttributes {
+  uint16_t texCoords[2];
+  int16_t  normal[2];
+  int16_t  tangent[2];
+};
+
+static_assert(sizeof(PackedVertexAttributes) == 12, "PackedVertexAttributes is read by the vertex input as it is");
+
+// Vertices split into the streams the GPU reads (see VertexStream), packed by g_packVertices()
+struct PackedVertexStreams {
+  std::span<const math::Vector3f>         positions;
+  std::span<const PackedVertexAttributes> attributes;
+  std::span<const uint32_t>               colors;  // rgba8
+};
+
 }  // namespace arise
 
 #endif  // ARISE_VERTEX_H
@@ -0,0 +1,21 @@
+#ifndef ARISE_WORLD_MATRIX_H
+#define ARISE_WORLD_MATRIX_H
+
+#include <math_library/matrix.h>
+
+namespace arise {
+
+/**
+ * Cached local-to-world matrix of an entity, maintained by TransformSystem from Transform (and the parent's
+ * WorldMatrix, see Hierarchy). Consumers should use it instead of calling calculateTransformMatrix.
+ */
+struct WorldMatrix {
+  math::Matrix4f<> matrix = math::Matrix4f<>::Identity();
+
+  // set when the matrix changed during the current frame, reset by the renderer at the end of the frame
+  bool isDirty = true;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_WORLD_MATRIX_H
@@ -2,64 +2,157 @@
 
 #include "ecs/components/bounding_volume.h"
 #include "ecs/components/model.h"
-#include "ecs/components/transform.h"
+#include "ecs/components/world_matrix.h"
+#include "profiler/profiler.h"
+#include "utils/job/job_system.h"
 #include "utils/logger/global_logger.h"
 
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
 namespace arise {
 
-void BoundingVolumeSystem::update(Scene* scene, float deltaTime) {
-  if (!scene) {
-    return;
+namespace {
+
+// entities processed by one job, small enough to keep the per-batch data on the stack
+constexpr uint32_t CHUNK_SIZE = 256;
+
+template <typename View>
+void updateWorldBoundsBatch(const View&                       view,
+                            const std::vector<entt::entity>& entities,
+                            uint32_t                          begin,
+                            uint32_t                          end,
+                            std::vector<uint8_t>&             updatedFlags,
+                            std::atomic<uint32_t>&            missingModelCount) {
+  // gather dirty entities first, so their boxes can be transformed in one batch
+  BoundingBox      localBounds[CHUNK_SIZE];
+  math::Matrix4f<> transforms[CHUNK_SIZE];
+  WorldBounds*     targets[CHUNK_SIZE];
+  uint32_t         targetIndices[CHUNK_SIZE];
+  uint32_t         batchSize = 0;
+
+  for (uint32_t i = begin; i < end; ++i) {
+    auto [worldMatrix, model, worldBounds] = view.template get<WorldMatrix, Model*, WorldBounds>(entities[i]);
+
+    bool needsUpdate = worldBounds.isDirty || worldMatrix.isDirty;
+    if (!needsUpdate) {
+      continue;
+    }
+
+    if (!model) {
+      worldBounds.boundingBox = bounds::createInvalid();
+      worldBounds.isDirty     = false;
+      updatedFlags[i]         = 1;
+      missingModelCount.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+
+    if (!bounds::isValid(model->boundingBox)) {
+      worldBounds.boundingBox = bounds::createInvalid();
+      worldBounds.isDirty     = false;
+      updatedFlags[i]         = 1;
+      continue;
+    }
+
+    localBounds[batchSize]   = model->boundingBox;
+    transforms[batchSize]    = worldMatrix.matrix;
+    targets[batchSize]       = &worldBounds;
+    targetIndices[batchSize] = i;
+    ++batchSize;
   }
 
-  auto& registry = scene->getEntityRegistry();
+  BoundingBox worldBoxes[CHUNK_SIZE];
+  bounds::transformAABBs(localBounds, transforms, worldBoxes, batchSize);
 
-  auto view = registry.view<Transform, Model*, WorldBounds>();
+  for (uint32_t i = 0; i < batchSize; ++i) {
+    targets[i]->boundingBox        = worldBoxes[i];
+    targets[i]->isDirty            = false;
+    updatedFlags[targetIndices[i]] = 1;
+  }
+}
 
-  for (auto entity : view) {
-    updateEntityWorldBounds_(entity, scene);
+template <typename View>
+void updateWorldBoundsRange(const View&                       view,
+                            const std::vector<entt::entity>& entities,
+                            uint32_t                          begin,
+                            uint32_t                          end,
+                            std::vector<uint8_t>&             updatedFlags,
+                            std::atomic<uint32_t>&            missingModelCount) {
+  // the range may be larger than one chunk when the job system runs it inline
+  for (uint32_t batchBegin = begin; batchBegin < end; batchBegin += CHUNK_SIZE) {
+    uint32_t batchEnd = std::min(batchBegin + CHUNK_SIZE, end);
+    updateWorldBoundsBatch(view, entities, batchBegin, batchEnd, updatedFlags, missingModelCount);
   }
 }
 
-void BoundingVolumeSystem::updateEntityWorldBounds_(entt::entity entity, Scene* scene) {
-  auto& registry = scene->getEntityRegistry();
+}  // namespace
 
-  const auto& transform   = registry.get<Transform>(entity);
-  const auto* model       = registry.get<Model*>(entity);
-  auto&       worldBounds = registry.get<WorldBounds>(entity);
+SystemAccess BoundingVolumeSystem::getAccess() const {
+  return SystemAccess().read<WorldMatrix, Model*>().write<WorldBounds>();
+}
 
-  bool needsUpdate = worldBounds.isDirty || transform.isDirty;
-  if (!needsUpdate) {
+void BoundingVolumeSystem::update(Scene* scene, float deltaTime) {
+  if (!scene) {
     return;
   }
 
-  if (!model) {
-    worldBounds.boundingBox = bounds::createInvalid();
-    worldBounds.isDirty     = false;
-    GlobalLogger::Log(
-        LogLevel::Warning,
-        "BoundingVolumeSystem: Model* is null for entity " + std::to_string(static_cast<uint32_t>(entity)));
+  CPU_ZONE_NC("BoundingVolumeSystem::update", color::YELLOW);
+
+  auto& registry = scene->getEntityRegistry();
+
+  auto view = registry.view<WorldMatrix, Model*, WorldBounds>();
+
+  m_entities_.clear();
+  for (auto entity : view) {
+    m_entities_.push_back(entity);
+  }
+
+  if (m_entities_.empty()) {
     return;
   }
 
-  const BoundingBox& localBounds = model->boundingBox;
+  std::atomic<uint32_t> missingModelCount{0};
 
-  if (!bounds::isValid(localBounds)) {
-    worldBounds.boundingBox = bounds::createInvalid();
-    worldBounds.isDirty     = false;
-    GlobalLogger::Log(
-        LogLevel::Debug,
-        "BoundingVolumeSystem: Invalid model bounds for entity " + std::to_string(static_cast<uint32_t>(entity)));
-    return;
+  // each entity has its own flag, so the workers don't need to synchronize
+  m_updatedFlags_.assign(m_entities_.size(), 0);
+
+  auto processRange = [this, &view, &missingModelCount](uint32_t begin, uint32_t end) {
+    updateWorldBoundsRange(view, m_entities_, begin, end, m_updatedFlags_, missingModelCount);
+  };
+
+  const auto entityCount = static_cast<uint32_t>(m_entities_.size());
+  g_parallelFor(entityCount, CHUNK_SIZE, processRange);
+
+  updateSpatialIndex_(scene);
+
+  // logging is not thread safe, so problems found by the workers are reported once here
+  if (missingModelCount > 0) {
+    GlobalLogger::Log(LogLevel::Warning,
+                      "BoundingVolumeSystem: Model* is null for " + std::to_string(missingModelCount.load())
+                          + " entity(ies)");
   }
+}
+
+void BoundingVolumeSystem::updateSpatialIndex_(Scene* scene) {
+  CPU_ZONE_NC("BoundingVolumeSystem::updateSpatialIndex", color::YELLOW);
 
-  math::Matrix4f<> transformMatrix = calculateTransformMatrix(transform);
-  worldBounds.boundingBox          = bounds::transformAABB(localBounds, transformMatrix);
-  worldBounds.isDirty              = false;
+  auto& registry     = scene->getEntityRegistry();
+  auto& spatialIndex = scene->getSpatialIndex();
 
-  GlobalLogger::Log(LogLevel::Debug,
-                    "BoundingVolumeSystem: Updated world bounds for entity "
-                        + std::to_string(static_cast<uint32_t>(entity)) + " using model: " + model->filePath.string());
+  for (std::size_t i = 0; i < m_entities_.size(); ++i) {
+    if (!m_updatedFlags_[i]) {
+      continue;
+    }
+
+    const auto& worldBounds = registry.get<WorldBounds>(m_entities_[i]);
+    if (bounds::isValid(worldBounds.boundingBox)) {
+      spatialIndex.update(m_entities_[i], worldBounds.boundingBox);
+    } else {
+      spatialIndex.remove(m_entities_[i]);
+    }
+  }
 }
 
-}  // namespace arise
\ No newline at end of file
+}  // namespace arise
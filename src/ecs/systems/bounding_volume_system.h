@@ -3,11 +3,15 @@
 
 #include "ecs/systems/i_updatable_system.h"
 
+#include <cstdint>
+#include <vector>
+
 namespace arise {
 
 /**
  * System for managing and updating bounding volumes of entities
  * Works only with CPU-side Model* data, follows SoC principle
+ * Also keeps the scene's SpatialIndex in sync with the updated WorldBounds
  */
 class BoundingVolumeSystem : public IUpdatableSystem {
   public:
@@ -16,8 +20,17 @@ class BoundingVolumeSystem : public IUpdatableSystem {
 
   void update(Scene* scene, float deltaTime) override;
 
+  SystemPhase  getPhase() const override { return SystemPhase::PostUpdate; }
+  SystemAccess getAccess() const override;
+
   private:
-  void updateEntityWorldBounds_(entt::entity entity, Scene* scene);
+  // Reinserts entities whose bounds changed this frame, runs on the calling thread (the tree isn't thread safe)
+  void updateSpatialIndex_(Scene* scene);
+
+  // entities of the current frame, reused to avoid reallocation
+  std::vector<entt::entity> m_entities_;
+  // 1 if WorldBounds of m_entities_[i] were recalculated this frame
+  std::vector<uint8_t>      m_updatedFlags_;
 };
 
 }  // namespace arise
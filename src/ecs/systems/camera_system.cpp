@@ -9,6 +9,10 @@
 
 namespace arise {
 
+SystemAccess CameraSystem::getAccess() const {
+  return SystemAccess().read<Transform, Camera>().write<CameraMatrices>();
+}
+
 void CameraSystem::update(Scene* scene, float deltaTime) {
   Registry&              registry        = scene->getEntityRegistry();
   auto&                  runtimeSettings = RuntimeSettings::s_get();
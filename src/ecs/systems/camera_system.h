@@ -8,6 +8,9 @@ namespace arise {
 class CameraSystem : public IUpdatableSystem {
   public:
   void update(Scene* scene, float deltaTime) override;
+
+  SystemPhase  getPhase() const override { return SystemPhase::PostUpdate; }
+  SystemAccess getAccess() const override;
 };
 
 }  // namespace arise
@@ -1,6 +1,7 @@
 #ifndef ARISE_I_UPDATABLE_SYSTEM_H
 #define ARISE_I_UPDATABLE_SYSTEM_H
 
+#include "ecs/systems/system_access.h"
 #include "scene/scene.h"
 
 namespace arise {
@@ -17,6 +18,13 @@ class IUpdatableSystem {
   virtual ~IUpdatableSystem() = default;
 
   virtual void update(Scene* scene, float deltaTime) = 0;
+
+  virtual SystemPhase getPhase() const { return SystemPhase::Update; }
+
+  /**
+   * By default a system is exclusive - it runs alone on the main thread. Override to allow concurrent execution.
+   */
+  virtual SystemAccess getAccess() const { return SystemAccess().exclusive(); }
 };
 
 }  // namespace arise
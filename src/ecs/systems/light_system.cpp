@@ -5,6 +5,8 @@
 #include "utils/logger/global_logger.h"
 #include "utils/memory/align.h"
 
+#include <algorithm>
+
 namespace arise {
 
 LightSystem::LightSystem(gfx::rhi::Device* device, gfx::renderer::RenderResourceManager* resourceManager)
@@ -27,229 +29,234 @@ void LightSystem::initialize() {
   GlobalLogger::Log(LogLevel::Info, "LightSystem initialized");
 }
 
+SystemAccess LightSystem::getAccess() const {
+  return SystemAccess().read<Light, DirectionalLight, PointLight, SpotLight, WorldMatrix>().exclusive();
+}
+
 void LightSystem::update(Scene* scene, float deltaTime) {
   if (!m_initialized) {
     initialize();
   }
 
-  collectDirectionalLights_(scene);
-  collectPointLights_(scene);
-  collectSpotLights_(scene);
-
-  updateLightBuffers_();
-
-  createOrUpdateDescriptorSet_();
-}
-
-void LightSystem::collectDirectionalLights_(Scene* scene) {
   auto& registry = scene->getEntityRegistry();
-  auto  view     = registry.view<Light, DirectionalLight>();
-
-  m_dirLightData.clear();
 
-  bool                             anyLightChanged = false;
-  std::unordered_set<entt::entity> currentEntities;
+  // consumed before a possible rebuild as well, so the recorded changes don't pile up
+  scene->getChangeTracker().consumeLights(m_changedEntities);
 
-  for (auto entity : view) {
-    auto& light = view.get<Light>(entity);
+  if (scene != m_trackedScene) {
+    m_trackedScene = scene;
+    rebuild_(registry);
+  } else {
+    // an entity is reported once per changed component
+    std::sort(m_changedEntities.begin(), m_changedEntities.end());
+    m_changedEntities.erase(std::unique(m_changedEntities.begin(), m_changedEntities.end()), m_changedEntities.end());
 
-    if (!light.enabled) {
-      continue;
+    for (auto entity : m_changedEntities) {
+      refreshLight_(registry, entity);
     }
-
-    auto& dirLight = view.get<DirectionalLight>(entity);
-
-    bool componentChanged = light.isDirty || dirLight.isDirty;
-
-    if (componentChanged) {
-      anyLightChanged = true;
-    }
-
-    DirectionalLightData data;
-    data.color     = light.color;
-    data.intensity = light.intensity;
-    data.direction = dirLight.direction;
-    data.padding   = 0.0f;
-
-    m_dirLightData.push_back(data);
-    currentEntities.insert(entity);
-
-    light.isDirty    = false;
-    dirLight.isDirty = false;
   }
 
-  bool setChanged        = (m_prevDirLightEntities != currentEntities);
-  m_prevDirLightEntities = std::move(currentEntities);
-
-  m_dirLightsChanged = anyLightChanged || setChanged;
+  bool buffersReplaced = uploadSlots_(m_directionalLights, "directional_light_buffer");
+  buffersReplaced |= uploadSlots_(m_pointLights, "point_light_buffer");
+  buffersReplaced |= uploadSlots_(m_spotLights, "spot_light_buffer");
+  buffersReplaced |= updateLightCounts_();
 
-  m_lightCountsChanged = m_lightCountsChanged || m_dirLightsChanged;
+  if (buffersReplaced || !m_lightDescriptorSet) {
+    createOrUpdateDescriptorSet_();
+  }
 }
 
-void LightSystem::collectPointLights_(Scene* scene) {
-  auto& registry = scene->getEntityRegistry();
-  auto  view     = registry.view<Light, PointLight, Transform>();
-
-  m_pointLightData.clear();
-
-  bool                             anyLightChanged = false;
-  std::unordered_set<entt::entity> currentEntities;
-
-  for (auto entity : view) {
-    auto& light = view.get<Light>(entity);
-
-    if (!light.enabled) {
-      continue;
-    }
-
-    auto& pointLight = view.get<PointLight>(entity);
-    auto& transform  = view.get<Transform>(entity);
-
-    bool componentChanged = light.isDirty || pointLight.isDirty || transform.isDirty;
-
-    if (componentChanged) {
-      anyLightChanged = true;
-    }
-
-    PointLightData data;
-    data.color     = light.color;
-    data.intensity = light.intensity;
-    data.range     = pointLight.range;
-    data.position  = transform.translation;
-
-    m_pointLightData.push_back(data);
-    currentEntities.insert(entity);
-
-    light.isDirty      = false;
-    pointLight.isDirty = false;
+template <typename T>
+void LightSystem::LightSlots<T>::set(entt::entity entity, const T& value) {
+  auto [it, inserted] = slotIndices.try_emplace(entity, static_cast<uint32_t>(data.size()));
+  if (inserted) {
+    data.push_back(value);
+    entities.push_back(entity);
+  } else {
+    data[it->second] = value;
   }
+  dirtySlots.push_back(it->second);
+}
 
-  bool setChanged          = (m_prevPointLightEntities != currentEntities);
-  m_prevPointLightEntities = std::move(currentEntities);
+template <typename T>
+bool LightSystem::LightSlots<T>::remove(entt::entity entity) {
+  auto it = slotIndices.find(entity);
+  if (it == slotIndices.end()) {
+    return false;
+  }
 
-  m_pointLightsChanged = anyLightChanged || setChanged;
+  // the last light fills the hole, only its new slot has to be uploaded
+  const uint32_t slot     = it->second;
+  const uint32_t lastSlot = static_cast<uint32_t>(data.size() - 1);
+  if (slot != lastSlot) {
+    data[slot]                      = data[lastSlot];
+    entities[slot]                  = entities[lastSlot];
+    slotIndices[entities[lastSlot]] = slot;
+    dirtySlots.push_back(slot);
+  }
 
-  m_lightCountsChanged = m_lightCountsChanged || m_pointLightsChanged;
+  data.pop_back();
+  entities.pop_back();
+  slotIndices.erase(it);
+  return true;
 }
 
-void LightSystem::collectSpotLights_(Scene* scene) {
-  auto& registry = scene->getEntityRegistry();
-  auto  view     = registry.view<Light, SpotLight, Transform>();
+template <typename T>
+void LightSystem::LightSlots<T>::clear() {
+  data.clear();
+  entities.clear();
+  slotIndices.clear();
+  dirtySlots.clear();
+}
 
-  m_spotLightData.clear();
+void LightSystem::rebuild_(Registry& registry) {
+  m_directionalLights.clear();
+  m_pointLights.clear();
+  m_spotLights.clear();
+  m_lightCountsChanged = true;
 
-  bool                             anyLightChanged = false;
-  std::unordered_set<entt::entity> currentEntities;
+  for (auto entity : registry.view<Light>()) {
+    refreshLight_(registry, entity);
+  }
+}
 
-  for (auto entity : view) {
-    auto& light = view.get<Light>(entity);
+void LightSystem::refreshLight_(Registry& registry, entt::entity entity) {
+  const Light* light = registry.valid(entity) ? registry.try_get<Light>(entity) : nullptr;
+  if (light && !light->enabled) {
+    light = nullptr;
+  }
 
-    if (!light.enabled) {
-      continue;
-    }
+  const size_t directionalCount = m_directionalLights.data.size();
+  const size_t pointCount       = m_pointLights.data.size();
+  const size_t spotCount        = m_spotLights.data.size();
 
-    auto& spotLight = view.get<SpotLight>(entity);
-    auto& transform = view.get<Transform>(entity);
+  const auto* dirLight = light ? registry.try_get<DirectionalLight>(entity) : nullptr;
+  if (dirLight) {
+    DirectionalLightData data;
+    data.color     = light->color;
+    data.intensity = light->intensity;
+    data.direction = dirLight->direction;
+    data.padding   = 0.0f;
+    m_directionalLights.set(entity, data);
+  } else {
+    m_directionalLights.remove(entity);
+  }
 
-    bool componentChanged = light.isDirty || spotLight.isDirty || transform.isDirty;
+  // row vector convention: the rows of the world matrix are the world space axes, the last one the translation
+  const auto* worldMatrix = light ? registry.try_get<WorldMatrix>(entity) : nullptr;
+  math::Vector3f position;
+  math::Vector3f forward;
+  if (worldMatrix) {
+    const auto& matrix = worldMatrix->matrix;
+    position           = math::Vector3f(matrix(3, 0), matrix(3, 1), matrix(3, 2));
+    forward            = math::Vector3f(matrix(2, 0), matrix(2, 1), matrix(2, 2)).normalized();
+  }
 
-    if (componentChanged) {
-      anyLightChanged = true;
-    }
+  const auto* pointLight = worldMatrix ? registry.try_get<PointLight>(entity) : nullptr;
+  if (pointLight) {
+    PointLightData data;
+    data.color     = light->color;
+    data.intensity = light->intensity;
+    data.range     = pointLight->range;
+    data.position  = position;
+    m_pointLights.set(entity, data);
+  } else {
+    m_pointLights.remove(entity);
+  }
 
+  const auto* spotLight = worldMatrix ? registry.try_get<SpotLight>(entity) : nullptr;
+  if (spotLight) {
     SpotLightData data;
-    data.color          = light.color;
-    data.intensity      = light.intensity;
-    data.range          = spotLight.range;
-    data.innerConeAngle = spotLight.innerConeAngle;
-    data.outerConeAngle = spotLight.outerConeAngle;
-    data.position       = transform.translation;
-
-    math::Quaternionf rotation = math::Quaternionf::fromEulerAngles(math::g_degreeToRadian(transform.rotation.x()),
-                                                                    math::g_degreeToRadian(transform.rotation.y()),
-                                                                    math::g_degreeToRadian(transform.rotation.z()),
-                                                                    math::EulerRotationOrder::XYZ);
-
-    math::Vector3f forwardVec(0.0f, 0.0f, 1.0f);
-    data.direction = rotation.rotateVector(forwardVec);
+    data.color          = light->color;
+    data.intensity      = light->intensity;
+    data.range          = spotLight->range;
+    data.innerConeAngle = spotLight->innerConeAngle;
+    data.outerConeAngle = spotLight->outerConeAngle;
+    data.position       = position;
+    data.direction      = forward;
 
     data.padding1 = 0.0f;
     data.padding2 = 0.0f;
     data.padding3 = 0.0f;
 
-    m_spotLightData.push_back(data);
-    currentEntities.insert(entity);
-
-    light.isDirty     = false;
-    spotLight.isDirty = false;
+    m_spotLights.set(entity, data);
+  } else {
+    m_spotLights.remove(entity);
   }
 
-  bool setChanged         = (m_prevSpotLightEntities != currentEntities);
-  m_prevSpotLightEntities = std::move(currentEntities);
-
-  m_spotLightsChanged = anyLightChanged || setChanged;
-
-  m_lightCountsChanged = m_lightCountsChanged || m_spotLightsChanged;
+  m_lightCountsChanged = m_lightCountsChanged || directionalCount != m_directionalLights.data.size()
+                      || pointCount != m_pointLights.data.size() || spotCount != m_spotLights.data.size();
 }
 
-void LightSystem::updateLightBuffers_() {
-  if (m_dirLightsChanged && !m_dirLightData.empty()) {
-    size_t dataSize = m_dirLightData.size() * sizeof(DirectionalLightData);
-
-    if (!m_dirLightBuffer || m_dirLightData.size() > m_dirLightCapacity) {
-      createOrResizeBuffer_(
-          dataSize, m_dirLightBuffer, "directional_light_buffer", m_dirLightCapacity, sizeof(DirectionalLightData));
-    }
+template <typename T>
+bool LightSystem::uploadSlots_(LightSlots<T>& slots, const std::string& debugName) {
+  auto& dirtySlots = slots.dirtySlots;
 
-    m_device->updateBuffer(m_dirLightBuffer, m_dirLightData.data(), dataSize);
-    m_dirLightsChanged = false;
+  if (slots.data.empty()) {
+    dirtySlots.clear();
+    return false;
   }
 
-  if (m_pointLightsChanged && !m_pointLightData.empty()) {
-    size_t dataSize = m_pointLightData.size() * sizeof(PointLightData);
-
-    if (!m_pointLightBuffer || m_pointLightData.size() > m_pointLightCapacity) {
-      createOrResizeBuffer_(
-          dataSize, m_pointLightBuffer, "point_light_buffer", m_pointLightCapacity, sizeof(PointLightData));
-    }
+  if (!slots.buffer || slots.data.size() > slots.capacity) {
+    createOrResizeBuffer_(slots.data.size() * sizeof(T), slots.buffer, debugName, slots.capacity, sizeof(T));
+    m_device->updateBuffer(slots.buffer, slots.data.data(), slots.data.size() * sizeof(T));
+    dirtySlots.clear();
+    return true;
+  }
 
-    m_device->updateBuffer(m_pointLightBuffer, m_pointLightData.data(), dataSize);
-    m_pointLightsChanged = false;
+  if (dirtySlots.empty()) {
+    return false;
   }
 
-  if (m_spotLightsChanged && !m_spotLightData.empty()) {
-    size_t dataSize = m_spotLightData.size() * sizeof(SpotLightData);
+  std::sort(dirtySlots.begin(), dirtySlots.end());
+  dirtySlots.erase(std::unique(dirtySlots.begin(), dirtySlots.end()), dirtySlots.end());
+
+  // slots past the end were freed after they were marked
+  const auto slotCount = static_cast<uint32_t>(slots.data.size());
+  dirtySlots.erase(std::lower_bound(dirtySlots.begin(), dirtySlots.end(), slotCount), dirtySlots.end());
 
-    if (!m_spotLightBuffer || m_spotLightData.size() > m_spotLightCapacity) {
-      createOrResizeBuffer_(
-          dataSize, m_spotLightBuffer, "spot_light_buffer", m_spotLightCapacity, sizeof(SpotLightData));
+  for (size_t i = 0; i < dirtySlots.size();) {
+    const uint32_t first = dirtySlots[i];
+    uint32_t       last  = first;
+    while (++i < dirtySlots.size() && dirtySlots[i] == last + 1) {
+      ++last;
     }
 
-    m_device->updateBuffer(m_spotLightBuffer, m_spotLightData.data(), dataSize);
-    m_spotLightsChanged = false;
+    m_device->updateBuffer(
+        slots.buffer, &slots.data[first], (last - first + 1) * sizeof(T), static_cast<size_t>(first) * sizeof(T));
   }
 
-  if (m_lightCountsChanged) {
-    LightCounts counts;
-    counts.directionalLightCount = static_cast<uint32_t>(m_dirLightData.size());
-    counts.pointLightCount       = static_cast<uint32_t>(m_pointLightData.size());
-    counts.spotLightCount        = static_cast<uint32_t>(m_spotLightData.size());
-    counts.padding               = 0;
-
-    if (!m_lightCountBuffer) {
-      gfx::rhi::BufferDesc countDesc;
-      countDesc.size        = alignConstantBufferSize(sizeof(LightCounts));
-      countDesc.type        = gfx::rhi::BufferType::Dynamic;
-      countDesc.createFlags = gfx::rhi::BufferCreateFlag::CpuAccess | gfx::rhi::BufferCreateFlag::ConstantBuffer;
-      countDesc.debugName   = "light_count_buffer";
-
-      auto buffer        = m_device->createBuffer(countDesc);
-      m_lightCountBuffer = m_resourceManager->addBuffer(std::move(buffer), "light_count_buffer");
-    }
+  dirtySlots.clear();
+  return false;
+}
 
-    m_device->updateBuffer(m_lightCountBuffer, &counts, sizeof(counts));
-    m_lightCountsChanged = false;
+bool LightSystem::updateLightCounts_() {
+  if (!m_lightCountsChanged) {
+    return false;
   }
+  m_lightCountsChanged = false;
+
+  LightCounts counts;
+  counts.directionalLightCount = getDirectionalLightCount();
+  counts.pointLightCount       = getPointLightCount();
+  counts.spotLightCount        = getSpotLightCount();
+  counts.padding               = 0;
+
+  bool bufferCreated = false;
+  if (!m_lightCountBuffer) {
+    gfx::rhi::BufferDesc countDesc;
+    countDesc.size        = alignConstantBufferSize(sizeof(LightCounts));
+    countDesc.type        = gfx::rhi::BufferType::Dynamic;
+    countDesc.createFlags = gfx::rhi::BufferCreateFlag::CpuAccess | gfx::rhi::BufferCreateFlag::ConstantBuffer;
+    countDesc.debugName   = "light_count_buffer";
+
+    auto buffer        = m_device->createBuffer(countDesc);
+    m_lightCountBuffer = m_resourceManager->addBuffer(std::move(buffer), "light_count_buffer");
+    bufferCreated      = true;
+  }
+
+  m_device->updateBuffer(m_lightCountBuffer, &counts, sizeof(counts));
+  return bufferCreated;
 }
 
 void LightSystem::createOrUpdateDescriptorSet_() {
@@ -263,16 +270,16 @@ void LightSystem::createOrUpdateDescriptorSet_() {
     m_lightDescriptorSet->setUniformBuffer(0, m_lightCountBuffer);
   }
 
-  if (m_dirLightBuffer) {
-    m_lightDescriptorSet->setStorageBuffer(1, m_dirLightBuffer);
+  if (m_directionalLights.buffer) {
+    m_lightDescriptorSet->setStorageBuffer(1, m_directionalLights.buffer);
   }
 
-  if (m_pointLightBuffer) {
-    m_lightDescriptorSet->setStorageBuffer(2, m_pointLightBuffer);
+  if (m_pointLights.buffer) {
+    m_lightDescriptorSet->setStorageBuffer(2, m_pointLights.buffer);
   }
 
-  if (m_spotLightBuffer) {
-    m_lightDescriptorSet->setStorageBuffer(3, m_spotLightBuffer);
+  if (m_spotLights.buffer) {
+    m_lightDescriptorSet->setStorageBuffer(3, m_spotLights.buffer);
   }
 }
 
@@ -2,12 +2,13 @@
 #define ARISE_LIGHT_SYSTEM_H
 
 #include "ecs/components/light.h"
-#include "ecs/components/transform.h"
+#include "ecs/components/world_matrix.h"
 #include "ecs/systems/i_updatable_system.h"
 #include "gfx/rhi/interface/buffer.h"
 #include "gfx/rhi/interface/descriptor.h"
 
-#include <unordered_set>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace arise::gfx {
@@ -21,22 +22,16 @@ class RenderResourceManager;
 
 namespace arise {
 
+/**
+ * Keeps the enabled lights of the scene in GPU buffers, one dense buffer per light type.
+ *
+ * Changes arrive through registry signals recorded by the scene's SceneChangeTracker (light components and the world
+ * matrices of lights), so only the changed lights are repacked and uploaded - a frame without light changes does no
+ * work. Position and spot direction come from the WorldMatrix, so lights attached to a parent follow it.
+ */
 class LightSystem : public IUpdatableSystem {
   public:
-  LightSystem(gfx::rhi::Device* device, gfx::renderer::RenderResourceManager* resourceManager);
-  ~LightSystem();
-
-  void initialize();
-  void update(Scene* scene, float deltaTime) override;
-
-  gfx::rhi::DescriptorSet*       getLightDescriptorSet() const { return m_lightDescriptorSet; }
-  gfx::rhi::DescriptorSetLayout* getLightDescriptorSetLayout() const { return m_lightLayout; }
-
-  uint32_t getDirectionalLightCount() const { return static_cast<uint32_t>(m_dirLightData.size()); }
-  uint32_t getPointLightCount() const { return static_cast<uint32_t>(m_pointLightData.size()); }
-  uint32_t getSpotLightCount() const { return static_cast<uint32_t>(m_spotLightData.size()); }
-
-  private:
+  // layouts match the light structures in the shaders
   struct DirectionalLightData {
     math::Vector3f color;
     float          intensity;
@@ -64,6 +59,32 @@ class LightSystem : public IUpdatableSystem {
     float          padding3;
   };
 
+  LightSystem(gfx::rhi::Device* device, gfx::renderer::RenderResourceManager* resourceManager);
+  ~LightSystem();
+
+  void initialize();
+  void update(Scene* scene, float deltaTime) override;
+
+  SystemPhase  getPhase() const override { return SystemPhase::PostUpdate; }
+  // uploads light data to the GPU, so it runs exclusively on the main thread
+  SystemAccess getAccess() const override;
+
+  gfx::rhi::DescriptorSet*       getLightDescriptorSet() const { return m_lightDescriptorSet; }
+  gfx::rhi::DescriptorSetLayout* getLightDescriptorSetLayout() const { return m_lightLayout; }
+
+  uint32_t getDirectionalLightCount() const { return static_cast<uint32_t>(m_directionalLights.data.size()); }
+  uint32_t getPointLightCount() const { return static_cast<uint32_t>(m_pointLights.data.size()); }
+  uint32_t getSpotLightCount() const { return static_cast<uint32_t>(m_spotLights.data.size()); }
+
+  // lights uploaded by the last update(), in the order of the GPU buffers (used to build the light clusters)
+  const std::vector<PointLightData>& getPointLights() const { return m_pointLights.data; }
+  const std::vector<SpotLightData>&  getSpotLights() const { return m_spotLights.data; }
+
+  // null until the first light of the type was added
+  gfx::rhi::Buffer* getPointLightBuffer() const { return m_pointLights.buffer; }
+  gfx::rhi::Buffer* getSpotLightBuffer() const { return m_spotLights.buffer; }
+
+  private:
   struct LightCounts {
     uint32_t directionalLightCount;
     uint32_t pointLightCount;
@@ -71,11 +92,43 @@ class LightSystem : public IUpdatableSystem {
     uint32_t padding;
   };
 
-  void collectDirectionalLights_(Scene* scene);
-  void collectPointLights_(Scene* scene);
-  void collectSpotLights_(Scene* scene);
+  /**
+   * Dense storage of one light type in the order of its GPU buffer. A light keeps its slot while it exists, a removed
+   * light is replaced by the last one so the shader loops stay dense. Only the slots marked dirty are uploaded.
+   */
+  template <typename T>
+  struct LightSlots {
+    std::vector<T>                             data;
+    std::vector<entt::entity>                  entities;  // owner of each slot
+    std::unordered_map<entt::entity, uint32_t> slotIndices;
+    std::vector<uint32_t>                      dirtySlots;
+
+    gfx::rhi::Buffer* buffer   = nullptr;
+    uint32_t          capacity = 0;
+
+    void set(entt::entity entity, const T& value);
+
+    // Returns true if the entity had a slot
+    bool remove(entt::entity entity);
+
+    void clear();
+  };
+
+  void rebuild_(Registry& registry);
+
+  // Moves the entity into or out of the slots of each light type, according to its current components
+  void refreshLight_(Registry& registry, entt::entity entity);
+
+  /**
+   * Uploads the dirty slots as contiguous sub-ranges, everything when the buffer had to grow.
+   * Returns true if the buffer was replaced.
+   */
+  template <typename T>
+  bool uploadSlots_(LightSlots<T>& slots, const std::string& debugName);
+
+  // Returns true if the count buffer was created
+  bool updateLightCounts_();
 
-  void updateLightBuffers_();
   void createOrUpdateDescriptorSet_();
 
   void createDescriptorSetLayout_();
@@ -88,29 +141,21 @@ class LightSystem : public IUpdatableSystem {
   gfx::rhi::Device*                     m_device;
   gfx::renderer::RenderResourceManager* m_resourceManager;
 
-  std::vector<DirectionalLightData> m_dirLightData;
-  std::vector<PointLightData>       m_pointLightData;
-  std::vector<SpotLightData>        m_spotLightData;
+  LightSlots<DirectionalLightData> m_directionalLights;
+  LightSlots<PointLightData>       m_pointLights;
+  LightSlots<SpotLightData>        m_spotLights;
 
-  std::unordered_set<entt::entity> m_prevDirLightEntities;
-  std::unordered_set<entt::entity> m_prevPointLightEntities;
-  std::unordered_set<entt::entity> m_prevSpotLightEntities;
+  // scene the slots were built from, a different scene triggers a full rebuild
+  Scene* m_trackedScene = nullptr;
+
+  // light changes consumed from the scene's SceneChangeTracker this frame
+  std::vector<entt::entity> m_changedEntities;
 
-  gfx::rhi::Buffer* m_dirLightBuffer   = nullptr;
-  gfx::rhi::Buffer* m_pointLightBuffer = nullptr;
-  gfx::rhi::Buffer* m_spotLightBuffer  = nullptr;
   gfx::rhi::Buffer* m_lightCountBuffer = nullptr;
 
   gfx::rhi::DescriptorSetLayout* m_lightLayout        = nullptr;
   gfx::rhi::DescriptorSet*       m_lightDescriptorSet = nullptr;
 
-  uint32_t m_dirLightCapacity   = 0;
-  uint32_t m_pointLightCapacity = 0;
-  uint32_t m_spotLightCapacity  = 0;
-
-  bool m_dirLightsChanged   = true;
-  bool m_pointLightsChanged = true;
-  bool m_spotLightsChanged  = true;
   bool m_lightCountsChanged = true;
   bool m_initialized        = false;
 };
@@ -0,0 +1,207 @@
+#include "ecs/systems/lod_system.h"
+
+#include "ecs/components/bounding_volume.h"
+#include "ecs/components/camera.h"
+#include "ecs/components/lod.h"
+#include "ecs/components/model.h"
+#include "ecs/components/transform.h"
+#include "profiler/profiler.h"
+#include "utils/job/job_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace arise {
+
+namespace {
+
+constexpr uint32_t CHUNK_SIZE = 256;
+
+// levels are stored in uint8_t, the optimizer generates far fewer
+constexpr size_t MAX_LOD_LEVELS = std::numeric_limits<uint8_t>::max() + 1;
+
+struct LodView {
+  math::Vector3f eye;
+  float          projectionScale = 1.0f;  // [1][1] of the projection, viewport height per view height at distance 1
+  bool           isPerspective   = true;
+};
+
+// Part of the viewport height the bounds diagonal covers, infinite when the eye is inside the bounds
+float getScreenSize(const BoundingBox& box, const LodView& lodView) {
+  const math::Vector3f size         = bounds::getSize(box);
+  const float          diagonal     = std::sqrt(size.dot(size));
+  const float          halfDiagonal = diagonal * 0.5f;
+
+  if (!lodView.isPerspective) {
+    return halfDiagonal * lodView.projectionScale;
+  }
+
+  const math::Vector3f toCenter = bounds::getCenter(box) - lodView.eye;
+  const float          distance = std::sqrt(toCenter.dot(toCenter));
+  if (distance <= halfDiagonal) {
+    return std::numeric_limits<float>::infinity();
+  }
+  return halfDiagonal * lodView.projectionScale / distance;
+}
+
+uint32_t selectLevel(const std::vector<float>& relativeErrors,
+                     uint32_t                  currentLevel,
+                     float                     screenSize,
+                     const LodSettings&        settings) {
+  const uint32_t coarsestLevel = static_cast<uint32_t>(relativeErrors.size()) - 1;
+
+  uint32_t level = std::min(currentLevel, coarsestLevel);
+
+  // finer while the current level shows too much error
+  while (level > 0 && relativeErrors[level] * screenSize > settings.maxScreenError) {
+    --level;
+  }
+
+  // coarser only once the next level is clearly below the limit
+  const float switchError = settings.maxScreenError * (1.0f - settings.hysteresis);
+  while (level < coarsestLevel && relativeErrors[level + 1] * screenSize <= switchError) {
+    ++level;
+  }
+
+  return level;
+}
+
+void updateFade(Lod& lod, uint32_t level, float deltaTime, const LodSettings& settings) {
+  if (level != lod.level) {
+    // a switch during a cross-fade starts from the level that was being faded in
+    lod.previousLevel = lod.level;
+    lod.level         = static_cast<uint8_t>(level);
+    lod.fade          = 0.0f;
+  }
+
+  if (settings.crossFadeDuration <= 0.0f) {
+    lod.fade = 1.0f;
+  } else if (lod.fade < 1.0f) {
+    lod.fade = std::min(lod.fade + deltaTime / settings.crossFadeDuration, 1.0f);
+  }
+}
+
+}  // namespace
+
+SystemAccess LodSystem::getAccess() const {
+  return SystemAccess().read<WorldBounds, Model*, Transform, Camera, CameraMatrices>().write<Lod>();
+}
+
+void LodSystem::update(Scene* scene, float deltaTime) {
+  if (!scene) {
+    return;
+  }
+
+  CPU_ZONE_NC("LodSystem::update", color::YELLOW);
+
+  auto& registry = scene->getEntityRegistry();
+
+  // same camera as the renderer (FrameResources)
+  auto cameraView = registry.view<Transform, Camera, CameraMatrices>();
+  if (cameraView.begin() == cameraView.end()) {
+    return;
+  }
+
+  auto  cameraEntity = *cameraView.begin();
+  auto& transform    = cameraView.get<Transform>(cameraEntity);
+  auto& camera       = cameraView.get<Camera>(cameraEntity);
+  auto& matrices     = cameraView.get<CameraMatrices>(cameraEntity);
+
+  LodView lodView;
+  lodView.eye             = transform.translation;
+  lodView.projectionScale = matrices.projection.data()[5];
+  lodView.isPerspective   = camera.type == CameraType::Perspective;
+
+  addMissingLods_(registry);
+
+  auto view = registry.view<WorldBounds, Model*, Lod>();
+
+  m_entities_.clear();
+  m_entityErrors_.clear();
+  m_relativeErrors_.clear();
+  for (auto entity : view) {
+    const Model* model = view.get<Model*>(entity);
+    if (!model) {
+      continue;
+    }
+    m_entities_.push_back(entity);
+    m_entityErrors_.push_back(&getRelativeErrors_(model));
+  }
+
+  if (m_entities_.empty()) {
+    return;
+  }
+
+  auto processRange = [this, &view, &lodView, deltaTime](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      auto& worldBounds = view.get<WorldBounds>(m_entities_[i]);
+      auto& lod         = view.get<Lod>(m_entities_[i]);
+
+      uint32_t level = lod.level;
+      if (bounds::isValid(worldBounds.boundingBox)) {
+        const float screenSize = getScreenSize(worldBounds.boundingBox, lodView);
+        level                  = selectLevel(*m_entityErrors_[i], lod.level, screenSize, m_settings_);
+      }
+      updateFade(lod, level, deltaTime, m_settings_);
+    }
+  };
+
+  const auto entityCount = static_cast<uint32_t>(m_entities_.size());
+  g_parallelFor(entityCount, CHUNK_SIZE, processRange);
+}
+
+void LodSystem::addMissingLods_(Registry& registry) {
+  m_entities_.clear();
+  for (auto entity : registry.view<WorldBounds, Model*>(entt::exclude<Lod>)) {
+    m_entities_.push_back(entity);
+  }
+
+  for (auto entity : m_entities_) {
+    registry.emplace<Lod>(entity);
+  }
+}
+
+const std::vector<float>& LodSystem::getRelativeErrors_(const Model* model) {
+  auto [it, inserted] = m_relativeErrors_.try_emplace(model);
+  if (!inserted) {
+    return it->second;
+  }
+
+  size_t levelCount = 1;
+  for (const Mesh* mesh : model->meshes) {
+    if (mesh) {
+      levelCount = std::max(levelCount, mesh->lods.size() + 1);
+    }
+  }
+  levelCount = std::min(levelCount, MAX_LOD_LEVELS);
+
+  const math::Vector3f size     = bounds::getSize(model->boundingBox);
+  const float          diagonal = std::sqrt(size.dot(size));
+
+  // a level of the model draws the same level of every mesh (or their coarsest one), its error is the largest of them
+  auto& relativeErrors = it->second;
+  relativeErrors.assign(levelCount, 0.0f);
+  for (const Mesh* mesh : model->meshes) {
+    if (!mesh || mesh->lods.empty()) {
+      continue;
+    }
+    for (size_t level = 1; level < levelCount; ++level) {
+      const auto& lod       = mesh->lods[std::min(level, mesh->lods.size()) - 1];
+      relativeErrors[level] = std::max(relativeErrors[level], lod.error);
+    }
+  }
+
+  // degenerate bounds give no scale, such models keep the full mesh
+  if (!bounds::isValid(model->boundingBox) || diagonal <= 0.0f) {
+    relativeErrors.resize(1);
+    return relativeErrors;
+  }
+
+  for (auto& error : relativeErrors) {
+    error /= diagonal;
+  }
+  return relativeErrors;
+}
+
+}  // namespace arise
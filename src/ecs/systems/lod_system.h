@@ -0,0 +1,64 @@
+#ifndef ARISE_LOD_SYSTEM_H
+#define ARISE_LOD_SYSTEM_H
+
+#include "ecs/systems/i_updatable_system.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace arise {
+
+struct Model;
+
+struct LodSettings {
+  // largest simplification error a level may show, relative to the viewport height
+  float maxScreenError = 0.001f;
+
+  // a coarser level is only selected when its error is this much below the limit, so levels don't flicker at the
+  // switching distance
+  float hysteresis = 0.2f;
+
+  // seconds both levels are dithered over each other after a switch, 0 switches at once
+  float crossFadeDuration = 0.25f;
+};
+
+/**
+ * Selects the mesh level (Lod) of every entity with a model from the projected size of its WorldBounds in the active
+ * camera. The error of a level (MeshLod::error) is taken relative to the model's bounds, so it scales with the
+ * instance, and the coarsest level whose error stays below LodSettings::maxScreenError on screen is used.
+ *
+ * Adds Lod to entities that don't have it yet.
+ */
+class LodSystem : public IUpdatableSystem {
+  public:
+  explicit LodSystem(const LodSettings& settings = {})
+      : m_settings_(settings) {}
+
+  ~LodSystem() = default;
+
+  void update(Scene* scene, float deltaTime) override;
+
+  SystemPhase  getPhase() const override { return SystemPhase::PostUpdate; }
+  SystemAccess getAccess() const override;
+
+  private:
+  // Emplaced before the selection runs in parallel, the workers only write existing components
+  void addMissingLods_(Registry& registry);
+
+  // Error of every level of the model relative to its bounds, cached for the frame
+  const std::vector<float>& getRelativeErrors_(const Model* model);
+
+  LodSettings m_settings_;
+
+  // entities of the current frame, reused to avoid reallocation
+  std::vector<entt::entity> m_entities_;
+  // relative errors of the model of m_entities_[i], resolved before the parallel selection
+  std::vector<const std::vector<float>*> m_entityErrors_;
+
+  std::unordered_map<const Model*, std::vector<float>> m_relativeErrors_;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_LOD_SYSTEM_H
@@ -2,21 +2,47 @@
 
 #include "ecs/components/movement.h"
 #include "ecs/components/transform.h"
+#include "profiler/profiler.h"
+#include "utils/job/job_system.h"
 
 namespace arise {
 
+namespace {
+
+constexpr uint32_t CHUNK_SIZE = 1024;
+
+}  // namespace
+
+SystemAccess MovementSystem::getAccess() const {
+  return SystemAccess().write<Transform, Movement>();
+}
+
 void MovementSystem::update(Scene* scene, float deltaTime) {
+  CPU_ZONE_NC("MovementSystem::update", color::YELLOW);
+
   Registry& registry = scene->getEntityRegistry();
   auto      view     = registry.view<Transform, Movement>();
 
+  m_entities_.clear();
   for (auto entity : view) {
-    auto& transform = view.get<Transform>(entity);
-    auto& movement  = view.get<Movement>(entity);
+    m_entities_.push_back(entity);
+  }
 
-    transform.translation += movement.direction * movement.strength * deltaTime;
+  auto processRange = [this, &view, deltaTime](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      auto [transform, movement] = view.get<Transform, Movement>(m_entities_[i]);
 
-    movement = Movement{};  // Reset movement
-  }
+      if (movement.strength != 0.0f) {
+        transform.translation += movement.direction * movement.strength * deltaTime;
+        transform.isDirty     = true;
+      }
+
+      movement = Movement{};  // Reset movement
+    }
+  };
+
+  const auto entityCount = static_cast<uint32_t>(m_entities_.size());
+  g_parallelFor(entityCount, CHUNK_SIZE, processRange);
 }
 
-}  // namespace arise
\ No newline at end of file
+}  // namespace arise
@@ -3,6 +3,8 @@
 
 #include "ecs/systems/i_updatable_system.h"
 
+#include <vector>
+
 namespace arise {
 
 // MovementSystem: Updates the Transform component based on the Movement
@@ -10,6 +12,13 @@ namespace arise {
 class MovementSystem : public IUpdatableSystem {
   public:
   void update(Scene* scene, float deltaTime) override;
+
+  SystemPhase  getPhase() const override { return SystemPhase::Update; }
+  SystemAccess getAccess() const override;
+
+  private:
+  // entities of the current frame, reused to avoid reallocation
+  std::vector<entt::entity> m_entities_;
 };
 
 }  // namespace arise
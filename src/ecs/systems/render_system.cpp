@@ -7,9 +7,13 @@
 
 namespace arise {
 
+SystemAccess RenderSystem::getAccess() const {
+  return SystemAccess().read<Transform, RenderModel, RenderMesh>();
+}
+
 // TODO: currently not implemented and not used (it's responsible for organizing
-// and preparing entity data for rendering (different render passes), applying
-// culling and LOD selection
+// and preparing entity data for rendering (different render passes). Culling is
+// done by FrustumCuller, LOD selection by LodSystem
 void RenderSystem::update(Scene* scene, float deltaTime) {
   Registry& registry = scene->getEntityRegistry();
 
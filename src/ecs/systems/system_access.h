@@ -0,0 +1,101 @@
+#ifndef ARISE_SYSTEM_ACCESS_H
+#define ARISE_SYSTEM_ACCESS_H
+
+#include "scene/scene.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace arise {
+
+/**
+ * Phases are executed one after another. Systems inside one phase may run concurrently if their component access
+ * doesn't conflict; otherwise they run in registration order.
+ */
+enum class SystemPhase : uint8_t {
+  PreUpdate,   // input driven state (e.g. camera controllers)
+  Update,      // gameplay, movement
+  PostUpdate,  // derived data (bounds, camera matrices, GPU side scene data)
+  Count,
+};
+
+/**
+ * Declares which components a system reads and writes.
+ *
+ * Two systems conflict when one of them writes a component the other one reads or writes. Exclusive systems (GPU
+ * uploads, entity creation / destruction) conflict with everything and always run on the main thread.
+ */
+class SystemAccess {
+  public:
+  template <typename... Components>
+  SystemAccess& read() {
+    (addComponent_<Components>(m_reads_), ...);
+    return *this;
+  }
+
+  template <typename... Components>
+  SystemAccess& write() {
+    (addComponent_<Components>(m_writes_), ...);
+    return *this;
+  }
+
+  SystemAccess& exclusive() {
+    m_exclusive_ = true;
+    return *this;
+  }
+
+  bool isExclusive() const { return m_exclusive_; }
+
+  bool conflictsWith(const SystemAccess& other) const {
+    if (m_exclusive_ || other.m_exclusive_) {
+      return true;
+    }
+    return intersects_(m_writes_, other.m_writes_) || intersects_(m_writes_, other.m_reads_)
+        || intersects_(m_reads_, other.m_writes_);
+  }
+
+  /**
+   * Creates the storages of all declared components up front. EnTT creates pools lazily, which modifies the registry
+   * and therefore must not happen while systems are running concurrently.
+   */
+  void prepareStorages(Registry& registry) const {
+    for (const auto& component : m_reads_) {
+      component.assureStorage(registry);
+    }
+    for (const auto& component : m_writes_) {
+      component.assureStorage(registry);
+    }
+  }
+
+  private:
+  struct ComponentAccess {
+    entt::id_type id;
+    void (*assureStorage)(Registry&);
+  };
+
+  template <typename Component>
+  static void addComponent_(std::vector<ComponentAccess>& components) {
+    components.push_back({entt::type_hash<Component>::value(), [](Registry& registry) {
+                            registry.storage<Component>();
+                          }});
+  }
+
+  static bool intersects_(const std::vector<ComponentAccess>& lhs, const std::vector<ComponentAccess>& rhs) {
+    for (const auto& left : lhs) {
+      for (const auto& right : rhs) {
+        if (left.id == right.id) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  std::vector<ComponentAccess> m_reads_;
+  std::vector<ComponentAccess> m_writes_;
+  bool                         m_exclusive_ = false;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_SYSTEM_ACCESS_H
@@ -1,15 +1,97 @@
 #include "ecs/systems/system_manager.h"
 
+#include "profiler/profiler.h"
+#include "utils/job/job_system.h"
+#include "utils/service/service_locator.h"
+
 namespace arise {
 
 void SystemManager::addSystem(std::unique_ptr<IUpdatableSystem> system) {
+  m_systemLookup_.emplace(std::type_index(typeid(*system)), system.get());
   m_systems_.push_back(std::move(system));
+  m_scheduleDirty_ = true;
 }
 
 void SystemManager::updateSystems(Scene* scene, float deltaTime) {
+  CPU_ZONE_NC("SystemManager::updateSystems", color::YELLOW);
+
+  if (m_scheduleDirty_) {
+    buildSchedule_();
+  }
+
+  if (scene) {
+    // pools must exist before systems start touching the registry from multiple threads
+    auto& registry = scene->getEntityRegistry();
+    for (const auto& phase : m_phases_) {
+      for (const auto& scheduled : phase) {
+        scheduled.access.prepareStorages(registry);
+      }
+    }
+  }
+
+  for (auto& phase : m_phases_) {
+    updatePhase_(phase, scene, deltaTime);
+  }
+}
+
+void SystemManager::buildSchedule_() {
+  for (auto& phase : m_phases_) {
+    phase.clear();
+  }
+
   for (const auto& system : m_systems_) {
-    system->update(scene, deltaTime);
+    auto& phase = m_phases_[static_cast<size_t>(system->getPhase())];
+
+    ScheduledSystem scheduled;
+    scheduled.system = system.get();
+    scheduled.access = system->getAccess();
+
+    for (uint32_t i = 0; i < phase.size(); ++i) {
+      if (scheduled.access.conflictsWith(phase[i].access)) {
+        scheduled.dependencies.push_back(i);
+      }
+    }
+
+    phase.push_back(std::move(scheduled));
   }
+
+  m_scheduleDirty_ = false;
+}
+
+void SystemManager::updatePhase_(std::vector<ScheduledSystem>& phase, Scene* scene, float deltaTime) {
+  auto jobSystem = ServiceLocator::s_get<JobSystem>();
+
+  if (!jobSystem || phase.size() < 2) {
+    for (auto& scheduled : phase) {
+      scheduled.system->update(scene, deltaTime);
+    }
+    return;
+  }
+
+  std::vector<JobHandle> handles(phase.size());
+
+  for (uint32_t i = 0; i < phase.size(); ++i) {
+    auto& scheduled = phase[i];
+
+    std::vector<JobHandle> dependencies;
+    dependencies.reserve(scheduled.dependencies.size());
+    for (auto dependency : scheduled.dependencies) {
+      dependencies.push_back(handles[dependency]);
+    }
+
+    if (scheduled.access.isExclusive()) {
+      // exclusive systems conflict with all previous ones, so waiting for the dependencies is a full barrier
+      jobSystem->waitAll(dependencies);
+      scheduled.system->update(scene, deltaTime);
+      continue;
+    }
+
+    auto* system = scheduled.system;
+    handles[i]   = jobSystem->submit(
+        [system, scene, deltaTime]() { system->update(scene, deltaTime); }, JobPriority::High, dependencies);
+  }
+
+  jobSystem->waitAll(handles);
 }
 
 }  // namespace arise
@@ -3,6 +3,11 @@
 
 #include "ecs/systems/i_updatable_system.h"
 
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
 namespace arise {
 
 // TODO: In future, when other than UpdatableSystems will be introduced,
@@ -16,6 +21,8 @@ namespace arise {
  * @details
  * - User should avoid adding duplicate systems.
  * - Systems should not overlap in functionality to prevent unintended behavior.
+ * - Systems are grouped by SystemPhase. Inside a phase, systems whose SystemAccess doesn't conflict run concurrently
+ *   on the JobSystem, conflicting ones keep the registration order. Exclusive systems run on the calling thread.
  */
 class SystemManager {
   public:
@@ -25,6 +32,12 @@ class SystemManager {
 
   template <typename T>
   T* getSystem() const {
+    auto it = m_systemLookup_.find(std::type_index(typeid(T)));
+    if (it != m_systemLookup_.end()) {
+      return static_cast<T*>(it->second);
+    }
+
+    // lookup by base class
     for (const auto& system : m_systems_) {
       T* typedSystem = dynamic_cast<T*>(system.get());
       if (typedSystem) {
@@ -37,7 +50,21 @@ class SystemManager {
   void updateSystems(Scene* scene, float deltaTime);
 
   private:
-  std::vector<std::unique_ptr<IUpdatableSystem>> m_systems_;
+  struct ScheduledSystem {
+    IUpdatableSystem*     system = nullptr;
+    SystemAccess          access;
+    // indices (inside the phase) of earlier systems this one has to wait for
+    std::vector<uint32_t> dependencies;
+  };
+
+  void buildSchedule_();
+
+  void updatePhase_(std::vector<ScheduledSystem>& phase, Scene* scene, float deltaTime);
+
+  std::vector<std::unique_ptr<IUpdatableSystem>>         m_systems_;
+  std::unordered_map<std::type_index, IUpdatableSystem*> m_systemLookup_;
+  std::vector<ScheduledSystem>                           m_phases_[static_cast<size_t>(SystemPhase::Count)];
+  bool                                                   m_scheduleDirty_ = true;
 };
 
 }  // namespace arise
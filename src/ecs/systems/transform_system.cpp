@@ -0,0 +1,152 @@
+#include "ecs/systems/transform_system.h"
+
+#include "ecs/components/hierarchy.h"
+#include "ecs/components/transform.h"
+#include "ecs/components/world_matrix.h"
+#include "profiler/profiler.h"
+#include "utils/job/job_system.h"
+
+namespace arise {
+
+namespace {
+
+constexpr uint32_t CHUNK_SIZE = 512;
+
+}  // namespace
+
+SystemAccess TransformSystem::getAccess() const {
+  // adds WorldMatrix components and sorts the Hierarchy storage, so it can't run concurrently with other systems
+  return SystemAccess().write<Transform, WorldMatrix, Hierarchy>().exclusive();
+}
+
+void TransformSystem::update(Scene* scene, float deltaTime) {
+  if (!scene) {
+    return;
+  }
+
+  CPU_ZONE_NC("TransformSystem::update", color::YELLOW);
+
+  auto& registry = scene->getEntityRegistry();
+
+  addMissingWorldMatrices_(registry);
+  updateRoots_(registry);
+  updateHierarchy_(registry);
+}
+
+void TransformSystem::addMissingWorldMatrices_(Registry& registry) {
+  m_entities_.clear();
+  for (auto entity : registry.view<Transform>(entt::exclude<WorldMatrix>)) {
+    m_entities_.push_back(entity);
+  }
+
+  for (auto entity : m_entities_) {
+    registry.emplace<WorldMatrix>(entity);
+  }
+}
+
+void TransformSystem::updateRoots_(Registry& registry) {
+  auto view = registry.view<Transform, WorldMatrix>(entt::exclude<Hierarchy>);
+
+  m_entities_.clear();
+  for (auto entity : view) {
+    m_entities_.push_back(entity);
+  }
+
+  m_updatedFlags_.assign(m_entities_.size(), 0);
+
+  g_parallelFor(static_cast<uint32_t>(m_entities_.size()), CHUNK_SIZE, [this, &view](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      auto [transform, worldMatrix] = view.get<Transform, WorldMatrix>(m_entities_[i]);
+      if (transform.isDirty || worldMatrix.isDirty) {
+        worldMatrix.matrix  = calculateTransformMatrix(transform);
+        worldMatrix.isDirty = true;
+        m_updatedFlags_[i]  = 1;
+      }
+    }
+  });
+
+  notifyUpdated_(registry);
+}
+
+void TransformSystem::updateHierarchy_(Registry& registry) {
+  auto hierarchyView = registry.view<Hierarchy>();
+
+  // hierarchy changes are rare, so the storage is re-sorted only when the depth order was broken
+  bool     isSorted      = true;
+  uint32_t previousDepth = 0;
+  for (auto [entity, node] : hierarchyView.each()) {
+    if (node.depth < previousDepth) {
+      isSorted = false;
+      break;
+    }
+    previousDepth = node.depth;
+  }
+
+  if (!isSorted) {
+    registry.sort<Hierarchy>([](const Hierarchy& lhs, const Hierarchy& rhs) { return lhs.depth < rhs.depth; });
+  }
+
+  m_entities_.clear();
+  m_levelOffsets_.clear();
+  for (auto [entity, node] : hierarchyView.each()) {
+    while (m_levelOffsets_.size() <= node.depth) {
+      m_levelOffsets_.push_back(static_cast<uint32_t>(m_entities_.size()));
+    }
+    m_entities_.push_back(entity);
+  }
+  m_levelOffsets_.push_back(static_cast<uint32_t>(m_entities_.size()));
+
+  auto view       = registry.view<Transform, WorldMatrix, Hierarchy>();
+  auto parentView = registry.view<WorldMatrix>();
+
+  m_updatedFlags_.assign(m_entities_.size(), 0);
+
+  // levels are processed one after another, entities inside one level only read the (finished) previous level
+  for (size_t level = 0; level + 1 < m_levelOffsets_.size(); ++level) {
+    const uint32_t levelBegin = m_levelOffsets_[level];
+    const uint32_t levelEnd   = m_levelOffsets_[level + 1];
+
+    auto processRange = [this, &view, &parentView, levelBegin](uint32_t begin, uint32_t end) {
+      for (uint32_t i = levelBegin + begin; i < levelBegin + end; ++i) {
+        auto entity = m_entities_[i];
+        if (!view.contains(entity)) {
+          continue;
+        }
+
+        auto [transform, worldMatrix, node] = view.get<Transform, WorldMatrix, Hierarchy>(entity);
+
+        // a destroyed parent (without hierarchy::release) is treated as if the entity was a root
+        const WorldMatrix* parentMatrix
+            = (node.parent != entt::null && parentView.contains(node.parent)) ? &parentView.get<WorldMatrix>(node.parent)
+                                                                              : nullptr;
+
+        bool needsUpdate = transform.isDirty || worldMatrix.isDirty || (parentMatrix && parentMatrix->isDirty);
+        if (!needsUpdate) {
+          continue;
+        }
+
+        worldMatrix.matrix = calculateTransformMatrix(transform);
+        if (parentMatrix) {
+          worldMatrix.matrix = worldMatrix.matrix * parentMatrix->matrix;
+        }
+        worldMatrix.isDirty = true;
+        m_updatedFlags_[i]  = 1;
+      }
+    };
+
+    g_parallelFor(levelEnd - levelBegin, CHUNK_SIZE, processRange);
+  }
+
+  notifyUpdated_(registry);
+}
+
+void TransformSystem::notifyUpdated_(Registry& registry) {
+  // signals are not thread safe, so on_update listeners are notified here and not from the jobs
+  for (size_t i = 0; i < m_entities_.size(); ++i) {
+    if (m_updatedFlags_[i]) {
+      registry.patch<WorldMatrix>(m_entities_[i]);
+    }
+  }
+}
+
+}  // namespace arise
@@ -0,0 +1,43 @@
+#ifndef ARISE_TRANSFORM_SYSTEM_H
+#define ARISE_TRANSFORM_SYSTEM_H
+
+#include "ecs/systems/i_updatable_system.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace arise {
+
+/**
+ * Keeps WorldMatrix in sync with Transform. Matrices are recalculated only for dirty transforms and for children of
+ * entities whose world matrix changed. Entities with a Hierarchy component are processed level by level (in depth
+ * order), so a parent is always up to date before its children; entities of one level are processed in parallel.
+ *
+ * Runs first in PostUpdate - everything that derives data from transforms (bounds, renderer) reads WorldMatrix.
+ * Every recalculated WorldMatrix is patched, so on_update<WorldMatrix> listeners learn about it without scanning.
+ */
+class TransformSystem : public IUpdatableSystem {
+  public:
+  void update(Scene* scene, float deltaTime) override;
+
+  SystemPhase  getPhase() const override { return SystemPhase::PostUpdate; }
+  SystemAccess getAccess() const override;
+
+  private:
+  void addMissingWorldMatrices_(Registry& registry);
+  void updateRoots_(Registry& registry);
+  void updateHierarchy_(Registry& registry);
+
+  // Emits on_update<WorldMatrix> for the entities flagged in m_updatedFlags_
+  void notifyUpdated_(Registry& registry);
+
+  // reused between frames to avoid reallocation
+  std::vector<entt::entity> m_entities_;
+  std::vector<uint32_t>     m_levelOffsets_;
+  // 1 if the world matrix of m_entities_[i] was recalculated
+  std::vector<uint8_t>      m_updatedFlags_;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_TRANSFORM_SYSTEM_H
@@ -1,7 +1,9 @@
 #include "editor/editor.h"
 
 #include "config/config_manager.h"
+#include "ecs/components/bounding_volume.h"
 #include "ecs/components/camera.h"
+#include "ecs/components/hierarchy.h"
 #include "ecs/components/light.h"
 #include "ecs/components/movement.h"
 #include "ecs/components/render_model.h"
@@ -352,6 +354,11 @@ void Editor::renderModeSelectionWindow() {
   //   m_renderParams.renderMode = gfx::renderer::RenderMode::WorldGrid;
   // }
 
+  ImGui::Separator();
+  ImGui::Checkbox("GPU-Driven Rendering", &m_renderParams.gpuDrivenRendering);
+  ImGui::Checkbox("GPU Light Clustering", &m_renderParams.gpuLightClustering);
+  ImGui::Checkbox("Parallel Command Recording", &m_renderParams.parallelCommandRecording);
+
   ImGui::End();
 }
 
@@ -563,7 +570,7 @@ void Editor::renderInspectorWindow() {
       bool isEnabled = light.enabled;
       if (ImGui::Checkbox("Enabled", &isEnabled)) {
         light.enabled = isEnabled;
-        light.isDirty = true;
+        registry.patch<Light>(m_selectedEntity);
 
         // Log the state change
         std::string lightType = "Light";
@@ -585,13 +592,13 @@ void Editor::renderInspectorWindow() {
         light.color.x() = color[0];
         light.color.y() = color[1];
         light.color.z() = color[2];
-        light.isDirty   = true;
+        registry.patch<Light>(m_selectedEntity);
       }
 
       float intensity = light.intensity;
       if (ImGui::DragFloat("Intensity", &intensity, 0.1f, 0.0f, 100.0f)) {
         light.intensity = intensity;
-        light.isDirty   = true;
+        registry.patch<Light>(m_selectedEntity);
       }
 
       if (registry.all_of<DirectionalLight>(m_selectedEntity)) {
@@ -605,35 +612,35 @@ void Editor::renderInspectorWindow() {
 
           dirLight.direction.normalize();
 
-          dirLight.isDirty = true;
+          registry.patch<DirectionalLight>(m_selectedEntity);
         }
       } else if (registry.all_of<PointLight>(m_selectedEntity)) {
         auto& pointLight = registry.get<PointLight>(m_selectedEntity);
 
         float range = pointLight.range;
         if (ImGui::DragFloat("Range", &range, 0.1f, 0.0f, 1000.0f)) {
-          pointLight.range   = range;
-          pointLight.isDirty = true;
+          pointLight.range = range;
+          registry.patch<PointLight>(m_selectedEntity);
         }
       } else if (registry.all_of<SpotLight>(m_selectedEntity)) {
         auto& spotLight = registry.get<SpotLight>(m_selectedEntity);
 
         float range = spotLight.range;
         if (ImGui::DragFloat("Range", &range, 0.1f, 0.0f, 1000.0f)) {
-          spotLight.range   = range;
-          spotLight.isDirty = true;
+          spotLight.range = range;
+          registry.patch<SpotLight>(m_selectedEntity);
         }
 
         float innerAngle = spotLight.innerConeAngle;
         if (ImGui::DragFloat("Inner Cone Angle", &innerAngle, 0.1f, 0.0f, spotLight.outerConeAngle)) {
           spotLight.innerConeAngle = innerAngle;
-          spotLight.isDirty        = true;
+          registry.patch<SpotLight>(m_selectedEntity);
         }
 
         float outerAngle = spotLight.outerConeAngle;
         if (ImGui::DragFloat("Outer Cone Angle", &outerAngle, 0.1f, spotLight.innerConeAngle, 90.0f)) {
           spotLight.outerConeAngle = outerAngle;
-          spotLight.isDirty        = true;
+          registry.patch<SpotLight>(m_selectedEntity);
         }
       }
     }
@@ -655,31 +662,29 @@ void Editor::renderInspectorWindow() {
             if (renderMesh && renderMesh->material) {
               ImGui::Text("Material: %s", renderMesh->material->materialName.c_str());
 
-              if (!renderMesh->material->textures.empty() && ImGui::TreeNode("Textures")) {
-                for (const auto& [name, texture] : renderMesh->material->textures) {
-                  ImGui::Text("%s: %p", name.c_str(), texture);
-                }
-                ImGui::TreePop();
-              }
+              auto& materialData = renderMesh->material->data;
 
-              if (!renderMesh->material->scalarParameters.empty() && ImGui::TreeNode("Scalar Parameters")) {
-                for (auto& [name, value] : renderMesh->material->scalarParameters) {
-                  if (ImGui::DragFloat(name.c_str(), &value, 0.01f)) {
-                  }
+              if (ImGui::TreeNode("Textures")) {
+                for (size_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; ++slot) {
+                  ImGui::Text("%s: %p",
+                              g_getMaterialTextureName(static_cast<MaterialTexture>(slot)),
+                              materialData.textures[slot]);
                 }
                 ImGui::TreePop();
               }
 
-              if (!renderMesh->material->vectorParameters.empty() && ImGui::TreeNode("Vector Parameters")) {
-                for (auto& [name, value] : renderMesh->material->vectorParameters) {
-                  float values[4] = {value.x(), value.y(), value.z(), value.w()};
-                  if (ImGui::DragFloat4(name.c_str(), values, 0.01f)) {
-                    value.x() = values[0];
-                    value.y() = values[1];
-                    value.z() = values[2];
-                    value.w() = values[3];
-                  }
+              // read by the renderer every frame, edits show up immediately
+              if (ImGui::TreeNode("Parameters")) {
+                float baseColor[4] = {materialData.baseColor.x(),
+                                      materialData.baseColor.y(),
+                                      materialData.baseColor.z(),
+                                      materialData.baseColor.w()};
+                if (ImGui::DragFloat4("base_color", baseColor, 0.01f)) {
+                  materialData.baseColor = math::Vector4f(baseColor[0], baseColor[1], baseColor[2], baseColor[3]);
                 }
+                ImGui::DragFloat("metallic", &materialData.metallic, 0.01f);
+                ImGui::DragFloat("roughness", &materialData.roughness, 0.01f);
+                ImGui::DragFloat("opacity", &materialData.opacity, 0.01f);
                 ImGui::TreePop();
               }
             } else {
@@ -1065,7 +1070,7 @@ void Editor::handleGizmoManipulation(const math::Matrix4f<>& modelMatrix) {
 
     math::Vector3f forward(0.0f, 0.0f, 1.0f);
     dirLight.direction = quat.rotateVector(forward);
-    dirLight.isDirty   = true;
+    registry.patch<DirectionalLight>(m_selectedEntity);
 
     GlobalLogger::Log(
         LogLevel::Info,
@@ -1478,6 +1483,7 @@ void Editor::removeSelectedEntity() {
     entityType = "Model";
   }
 
+  hierarchy::release(registry, m_selectedEntity);
   registry.destroy(m_selectedEntity);
   GlobalLogger::Log(LogLevel::Info, entityType + " removed");
 
@@ -1763,6 +1769,7 @@ void Editor::createModelEntity(const std::filesystem::path& modelPath, const Tra
           if (renderModel && model) {
             registry.emplace<Model*>(entity, model);
             registry.emplace<RenderModel*>(entity, renderModel);
+            registry.emplace_or_replace<WorldBounds>(entity);
 
             handleEntitySelection(entity);
             GlobalLogger::Log(LogLevel::Info, "Model loaded successfully: " + modelPath.string());
@@ -1786,6 +1793,7 @@ void Editor::createModelEntity(const std::filesystem::path& modelPath, const Tra
       if (renderModel && model) {
         registry.emplace<Model*>(entity, model);
         registry.emplace<RenderModel*>(entity, renderModel);
+        registry.emplace_or_replace<WorldBounds>(entity);
 
         handleEntitySelection(entity);
         GlobalLogger::Log(LogLevel::Info, "Model loaded successfully: " + modelPath.string());
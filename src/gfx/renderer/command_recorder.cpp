@@ -0,0 +1,105 @@
+#include "gfx/renderer/command_recorder.h"
+
+#include "gfx/rhi/interface/command_buffer.h"
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+void CommandRecorder::setPipeline(rhi::Pipeline* pipeline) {
+  if (pipeline == m_pipeline) {
+    ++m_statistics.skippedBinds;
+    return;
+  }
+
+  m_commandBuffer->setPipeline(pipeline);
+  m_pipeline = pipeline;
+  m_descriptorSets.fill({});
+  ++m_statistics.pipelineBinds;
+}
+
+void CommandRecorder::bindDescriptorSet(uint32_t                  setIndex,
+                                        rhi::DescriptorSet*       set,
+                                        std::span<const uint32_t> dynamicOffsets) {
+  if (!set) {
+    return;
+  }
+
+  if (setIndex < s_maxDescriptorSets) {
+    DescriptorSetBinding binding;
+    binding.set                = set;
+    binding.dynamicOffsetCount = static_cast<uint32_t>(dynamicOffsets.size());
+    binding.dynamicOffset      = dynamicOffsets.empty() ? 0 : dynamicOffsets.front();
+
+    auto& bound = m_descriptorSets[setIndex];
+    if (bound.set == binding.set && bound.dynamicOffsetCount == binding.dynamicOffsetCount
+        && bound.dynamicOffset == binding.dynamicOffset && binding.dynamicOffsetCount <= 1) {
+      ++m_statistics.skippedBinds;
+      return;
+    }
+    bound = binding;
+  }
+
+  m_commandBuffer->bindDescriptorSet(setIndex, set, dynamicOffsets);
+  ++m_statistics.descriptorBinds;
+}
+
+void CommandRecorder::bindVertexBuffer(uint32_t binding, rhi::Buffer* buffer, uint64_t offset) {
+  if (binding < s_maxVertexBuffers) {
+    auto& bound = m_vertexBuffers[binding];
+    if (bound.buffer == buffer && bound.offset == offset) {
+      ++m_statistics.skippedBinds;
+      return;
+    }
+    bound = {buffer, offset};
+  }
+
+  m_commandBuffer->bindVertexBuffer(binding, buffer, offset);
+  ++m_statistics.bufferBinds;
+}
+
+void CommandRecorder::bindIndexBuffer(rhi::Buffer* buffer, uint64_t offset, bool use32BitIndices) {
+  if (m_indexBuffer == buffer && m_indexBufferOffset == offset && m_use32BitIndices == use32BitIndices) {
+    ++m_statistics.skippedBinds;
+    return;
+  }
+
+  m_commandBuffer->bindIndexBuffer(buffer, offset, use32BitIndices);
+  m_indexBuffer       = buffer;
+  m_indexBufferOffset = offset;
+  m_use32BitIndices   = use32BitIndices;
+  ++m_statistics.bufferBinds;
+}
+
+void CommandRecorder::drawIndexedInstanced(
+    uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+  m_commandBuffer->drawIndexedInstanced(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+  ++m_statistics.drawCalls;
+}
+
+void CommandRecorder::drawIndexedIndirect(rhi::Buffer* argBuffer, uint64_t argOffset, uint32_t drawCount) {
+  m_commandBuffer->drawIndexedIndirect(argBuffer, argOffset, drawCount);
+  ++m_statistics.drawCalls;
+}
+
+void CommandRecorder::drawIndexedIndirectCount(rhi::Buffer* argBuffer,
+                                               uint64_t     argOffset,
+                                               rhi::Buffer* countBuffer,
+                                               uint64_t     countOffset,
+                                               uint32_t     maxDrawCount) {
+  m_commandBuffer->drawIndexedIndirectCount(argBuffer, argOffset, countBuffer, countOffset, maxDrawCount);
+  ++m_statistics.drawCalls;
+}
+
+void CommandRecorder::reset() {
+  m_pipeline = nullptr;
+  m_descriptorSets.fill({});
+  m_vertexBuffers.fill({});
+  m_indexBuffer       = nullptr;
+  m_indexBufferOffset = 0;
+  m_use32BitIndices   = false;
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
@@ -0,0 +1,96 @@
+#ifndef ARISE_COMMAND_RECORDER_H
+#define ARISE_COMMAND_RECORDER_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace arise::gfx::rhi {
+class Buffer;
+class CommandBuffer;
+class DescriptorSet;
+class Pipeline;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+/**
+ * Thin wrapper over rhi::CommandBuffer that remembers the bound state and skips binds of what is already bound.
+ *
+ * Changing the pipeline forgets the bound descriptor sets: DX12 resets root arguments when the root signature
+ * changes (every pipeline owns one), so the sets are bound again for the new pipeline.
+ *
+ * Only valid while nothing else records to the same command buffer, call reset() after recording around it.
+ */
+class CommandRecorder {
+  public:
+  struct Statistics {
+    uint32_t drawCalls       = 0;
+    uint32_t pipelineBinds   = 0;
+    uint32_t descriptorBinds = 0;
+    uint32_t bufferBinds     = 0;
+    uint32_t skippedBinds    = 0;
+  };
+
+  explicit CommandRecorder(rhi::CommandBuffer* commandBuffer)
+      : m_commandBuffer(commandBuffer) {}
+
+  void setPipeline(rhi::Pipeline* pipeline);
+
+  // null sets are ignored, like the per-call checks the passes used to do
+  void bindDescriptorSet(uint32_t setIndex, rhi::DescriptorSet* set, std::span<const uint32_t> dynamicOffsets = {});
+
+  void bindVertexBuffer(uint32_t binding, rhi::Buffer* buffer, uint64_t offset = 0);
+  void bindIndexBuffer(rhi::Buffer* buffer, uint64_t offset = 0, bool use32BitIndices = false);
+
+  void drawIndexedInstanced(
+      uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
+
+  // tightly packed rhi::DrawIndexedIndirectCommand arguments
+  void drawIndexedIndirect(rhi::Buffer* argBuffer, uint64_t argOffset, uint32_t drawCount);
+  void drawIndexedIndirectCount(rhi::Buffer* argBuffer,
+                                uint64_t     argOffset,
+                                rhi::Buffer* countBuffer,
+                                uint64_t     countOffset,
+                                uint32_t     maxDrawCount);
+
+  // Forgets all the bound state, the next binds always reach the command buffer
+  void reset();
+
+  const Statistics& getStatistics() const { return m_statistics; }
+
+  private:
+  static constexpr uint32_t s_maxDescriptorSets = 8;
+  static constexpr uint32_t s_maxVertexBuffers  = 4;
+
+  // sets with more than one dynamic offset are always bound again
+  struct DescriptorSetBinding {
+    rhi::DescriptorSet* set                = nullptr;
+    uint32_t            dynamicOffsetCount = 0;
+    uint32_t            dynamicOffset      = 0;
+  };
+
+  struct VertexBufferBinding {
+    rhi::Buffer* buffer = nullptr;
+    uint64_t     offset = 0;
+  };
+
+  rhi::CommandBuffer* m_commandBuffer = nullptr;
+
+  rhi::Pipeline*                                         m_pipeline = nullptr;
+  std::array<DescriptorSetBinding, s_maxDescriptorSets> m_descriptorSets{};
+  std::array<VertexBufferBinding, s_maxVertexBuffers>   m_vertexBuffers{};
+  rhi::Buffer*                                           m_indexBuffer       = nullptr;
+  uint64_t                                               m_indexBufferOffset = 0;
+  bool                                                   m_use32BitIndices   = false;
+
+  Statistics m_statistics;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_COMMAND_RECORDER_H
@@ -3,12 +3,12 @@
 
 #include "gfx/renderer/debug_strategies/debug_draw_strategy.h"
 #include "gfx/rhi/interface/render_pass.h"
+#include "utils/buffer/vertex_layout.h"
 
 #include <unordered_map>
 #include <vector>
 
 namespace arise {
-struct RenderModel;
 struct Material;
 }  // namespace arise
 
@@ -45,33 +45,25 @@ class LightVisualizationStrategy : public DebugDrawStrategy {
   bool isExclusive() const override { return true; }
 
   private:
-  struct ModelBufferCache {
-    rhi::Buffer* instanceBuffer = nullptr;
-    uint32_t     capacity       = 0;
-    uint32_t     count          = 0;
-  };
-
   struct DrawData {
-    rhi::GraphicsPipeline* pipeline                 = nullptr;
-    rhi::DescriptorSet*    modelMatrixDescriptorSet = nullptr;
-    rhi::DescriptorSet*    materialDescriptorSet    = nullptr;
-    rhi::Buffer*           vertexBuffer             = nullptr;
-    rhi::Buffer*           indexBuffer              = nullptr;
-    rhi::Buffer*           instanceBuffer           = nullptr;
-    uint32_t               indexCount               = 0;
-    uint32_t               instanceCount            = 0;
+    rhi::GraphicsPipeline*    pipeline                 = nullptr;
+    rhi::DescriptorSet*       modelMatrixDescriptorSet = nullptr;
+    rhi::DescriptorSet*       materialDescriptorSet    = nullptr;
+    const RenderGeometryMesh* geometryMesh             = nullptr;
+    rhi::Buffer*              indexBuffer              = nullptr;
+    rhi::Buffer*              instanceBuffer           = nullptr;
+    uint32_t                  indexCount               = 0;
+    uint32_t                  firstIndex               = 0;
+    int32_t                   vertexOffset             = 0;
+    uint32_t                  firstInstance            = 0;
+    uint32_t                  instanceCount            = 0;
   };
 
   rhi::DescriptorSet* getOrCreateMaterialDescriptorSet_(Material* material);
 
   void setupRenderPass_();
-  void createFramebuffers_(const math::Dimension2i& dimension);
   void prepareDrawCalls_(const RenderContext& context);
-  void updateInstanceBuffer_(RenderModel*                         model,
-                             const std::vector<math::Matrix4f<>>& matrices,
-                             ModelBufferCache&                    cache);
-  void cleanupUnusedBuffers_(
-      const std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>& currentFrameInstances);
+  void cleanupUnusedMaterials_();
 
   const std::string m_vertexShaderPath_ = "assets/shaders/debug/light_visualization/shader_instancing.vs.hlsl";
   const std::string m_pixelShaderPath_  = "assets/shaders/debug/light_visualization/shader.ps.hlsl";
@@ -84,14 +76,16 @@ class LightVisualizationStrategy : public DebugDrawStrategy {
   rhi::Shader* m_vertexShader = nullptr;
   rhi::Shader* m_pixelShader  = nullptr;
 
+  const VertexLayout m_vertexLayout{VertexAttribute::Position | VertexAttribute::TexCoords | VertexAttribute::Normal
+                                    | VertexAttribute::Tangent};
+
   rhi::Viewport    m_viewport;
   rhi::ScissorRect m_scissor;
 
-  rhi::RenderPass*               m_renderPass = nullptr;
-  std::vector<rhi::Framebuffer*> m_framebuffers;
+  rhi::RenderPass*       m_renderPass = nullptr;
+  rhi::GraphicsPipeline* m_pipeline   = nullptr;
 
-  std::unordered_map<RenderModel*, ModelBufferCache> m_instanceBufferCache;
-  std::vector<DrawData>                              m_drawData;
+  std::vector<DrawData> m_drawData;
 
   struct MaterialCache {
     rhi::DescriptorSet* descriptorSet = nullptr;
@@ -2,8 +2,8 @@
 
 #include "ecs/components/render_model.h"
 #include "ecs/components/selected.h"
-#include "ecs/components/vertex.h"
 #include "gfx/renderer/frame_resources.h"
+#include "gfx/renderer/frustum_culler.h"
 #include "gfx/renderer/render_resource_manager.h"
 #include "gfx/rhi/interface/buffer.h"
 #include "gfx/rhi/interface/descriptor.h"
@@ -56,68 +56,26 @@ void MeshHighlightStrategy::resize(const math::Dimension2i& newDimension) {
   m_scissor.y      = 0;
   m_scissor.width  = newDimension.width();
   m_scissor.height = newDimension.height();
-
-  createFramebuffers_(newDimension);
 }
 
 void MeshHighlightStrategy::prepareFrame(const RenderContext& context) {
-  std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>     currentFrameInstances;
-  std::unordered_map<RenderModel*, std::pair<math::Vector4f, float>> highlightParams;
-  std::unordered_map<RenderModel*, bool>                              modelDirtyFlags;
-
-  auto& registry = context.scene->getEntityRegistry();
-  auto  view     = registry.view<Selected, RenderModel*>();
-
-  for (auto entity : view) {
-    auto& selectedComp = view.get<Selected>(entity);
-    auto* renderModel  = view.get<RenderModel*>(entity);
-
-    if (registry.all_of<Transform>(entity)) {
-      auto& transform   = registry.get<Transform>(entity);
-      auto  modelMatrix = calculateTransformMatrix(transform);
-
-      currentFrameInstances[renderModel].push_back(modelMatrix);
-      highlightParams[renderModel] = {selectedComp.highlightColor, selectedComp.outlineThickness};
-
-      auto frameModels = m_frameResources->getModels();
-      for (const auto& instance : frameModels) {
-        if (instance->model == renderModel && instance->isDirty) {
-          modelDirtyFlags[renderModel] = true;
-          break;
-        }
-      }
-    }
-  }
-
-  for (auto& [model, matrices] : currentFrameInstances) {
-    auto& cache = m_instanceBufferCache[model];
-
-    bool needsUpdate = cache.instanceBuffer == nullptr || matrices.size() > cache.capacity
-                    || matrices.size() != cache.count || modelDirtyFlags[model];
-
-    if (needsUpdate) {
-      updateInstanceBuffer_(model, matrices, cache);
-    }
-  }
-
-  cleanupUnusedBuffers_(currentFrameInstances);
+  // instance matrices are uploaded by FrameResources (InstanceDataStore), only the draw list is built here
   prepareDrawCalls_(context);
 }
 
 void MeshHighlightStrategy::render(const RenderContext& context) {
   auto commandBuffer = context.commandBuffer.get();
-  if (!commandBuffer || !m_renderPass || m_framebuffers.empty() || m_drawData.empty()) {
+  if (!commandBuffer || !m_renderPass || !context.renderGraph || m_drawData.empty()) {
     return;
   }
 
-  uint32_t currentIndex = context.currentImageIndex;
-  if (currentIndex >= m_framebuffers.size()) {
-    GlobalLogger::Log(LogLevel::Error, "Invalid framebuffer index");
+  rhi::Framebuffer* currentFramebuffer
+      = context.renderGraph->getFramebuffer(m_renderPass, context.colorTarget, context.depthTarget);
+  if (!currentFramebuffer) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to get the render graph framebuffer");
     return;
   }
 
-  rhi::Framebuffer* currentFramebuffer = m_framebuffers[currentIndex];
-
   std::vector<rhi::ClearValue> clearValues;
 
   rhi::ClearValue colorClear = {};
@@ -136,22 +94,28 @@ void MeshHighlightStrategy::render(const RenderContext& context) {
   commandBuffer->setViewport(m_viewport);
   commandBuffer->setScissor(m_scissor);
 
+  const uint32_t viewConstantsOffset = m_frameResources->getViewConstantsOffset();
+
   // Pass 1: Stencil Mark
   for (const auto& drawData : m_drawData) {
     commandBuffer->setPipeline(drawData.stencilMarkPipeline);
 
     if (m_frameResources->getViewDescriptorSet()) {
-      commandBuffer->bindDescriptorSet(0, m_frameResources->getViewDescriptorSet());
+      commandBuffer->bindDescriptorSet(0, m_frameResources->getViewDescriptorSet(), {&viewConstantsOffset, 1});
     }
     if (drawData.modelMatrixDescriptorSet) {
       commandBuffer->bindDescriptorSet(1, drawData.modelMatrixDescriptorSet);
     }
 
-    commandBuffer->bindVertexBuffer(0, drawData.vertexBuffer);
-    commandBuffer->bindVertexBuffer(1, drawData.instanceBuffer);
+    m_vertexLayout.bindVertexBuffers(*commandBuffer, *drawData.geometryMesh);
+    commandBuffer->bindVertexBuffer(m_vertexLayout.getInstanceBinding(), drawData.instanceBuffer);
     commandBuffer->bindIndexBuffer(drawData.indexBuffer, 0, true);
 
-    commandBuffer->drawIndexedInstanced(drawData.indexCount, drawData.instanceCount, 0, 0, 0);
+    commandBuffer->drawIndexedInstanced(drawData.indexCount,
+                                        drawData.instanceCount,
+                                        drawData.firstIndex,
+                                        drawData.vertexOffset,
+                                        drawData.firstInstance);
   }
 
   // Pass 2: Outline Draw - draw outline only where stencil != 1
@@ -159,7 +123,7 @@ void MeshHighlightStrategy::render(const RenderContext& context) {
     commandBuffer->setPipeline(drawData.outlinePipeline);
 
     if (m_frameResources->getViewDescriptorSet()) {
-      commandBuffer->bindDescriptorSet(0, m_frameResources->getViewDescriptorSet());
+      commandBuffer->bindDescriptorSet(0, m_frameResources->getViewDescriptorSet(), {&viewConstantsOffset, 1});
     }
     if (drawData.modelMatrixDescriptorSet) {
       commandBuffer->bindDescriptorSet(1, drawData.modelMatrixDescriptorSet);
@@ -168,18 +132,21 @@ void MeshHighlightStrategy::render(const RenderContext& context) {
       commandBuffer->bindDescriptorSet(2, drawData.highlightParamsDescriptorSet);
     }
 
-    commandBuffer->bindVertexBuffer(0, drawData.vertexBuffer);
-    commandBuffer->bindVertexBuffer(1, drawData.instanceBuffer);
+    m_vertexLayout.bindVertexBuffers(*commandBuffer, *drawData.geometryMesh);
+    commandBuffer->bindVertexBuffer(m_vertexLayout.getInstanceBinding(), drawData.instanceBuffer);
     commandBuffer->bindIndexBuffer(drawData.indexBuffer, 0, true);
 
-    commandBuffer->drawIndexedInstanced(drawData.indexCount, drawData.instanceCount, 0, 0, 0);
+    commandBuffer->drawIndexedInstanced(drawData.indexCount,
+                                        drawData.instanceCount,
+                                        drawData.firstIndex,
+                                        drawData.vertexOffset,
+                                        drawData.firstInstance);
   }
 
   commandBuffer->endRenderPass();
 }
 
 void MeshHighlightStrategy::clearSceneResources() {
-  m_instanceBufferCache.clear();
   m_drawData.clear();
   m_pipelineCache.clear();
   m_highlightParamsCache.clear();
@@ -187,11 +154,9 @@ void MeshHighlightStrategy::clearSceneResources() {
 }
 
 void MeshHighlightStrategy::cleanup() {
-  m_instanceBufferCache.clear();
   m_drawData.clear();
   m_pipelineCache.clear();
-  m_renderPass = nullptr;
-  m_framebuffers.clear();
+  m_renderPass              = nullptr;
   m_stencilMarkVertexShader = nullptr;
   m_outlineVertexShader     = nullptr;
   m_pixelShader             = nullptr;
@@ -225,107 +190,6 @@ void MeshHighlightStrategy::setupRenderPass_() {
   m_renderPass    = m_resourceManager->addRenderPass(std::move(renderPass), "highlight_render_pass");
 }
 
-void MeshHighlightStrategy::setupVertexInput_(rhi::GraphicsPipelineDesc& pipelineDesc) {
-  rhi::VertexInputBindingDesc vertexBinding;
-  vertexBinding.binding   = 0;
-  vertexBinding.stride    = sizeof(Vertex);
-  vertexBinding.inputRate = rhi::VertexInputRate::Vertex;
-  pipelineDesc.vertexBindings.push_back(vertexBinding);
-
-  rhi::VertexInputBindingDesc instanceBinding;
-  instanceBinding.binding   = 1;
-  instanceBinding.stride    = sizeof(math::Matrix4f<>);
-  instanceBinding.inputRate = rhi::VertexInputRate::Instance;
-  pipelineDesc.vertexBindings.push_back(instanceBinding);
-
-  rhi::VertexInputAttributeDesc positionAttr;
-  positionAttr.location     = 0;
-  positionAttr.binding      = 0;
-  positionAttr.format       = rhi::TextureFormat::Rgb32f;
-  positionAttr.offset       = offsetof(Vertex, position);
-  positionAttr.semanticName = "POSITION";
-  pipelineDesc.vertexAttributes.push_back(positionAttr);
-
-  rhi::VertexInputAttributeDesc normalAttr;
-  normalAttr.location     = 1;
-  normalAttr.binding      = 0;
-  normalAttr.format       = rhi::TextureFormat::Rgb32f;
-  normalAttr.offset       = offsetof(Vertex, normal);
-  normalAttr.semanticName = "NORMAL";
-  pipelineDesc.vertexAttributes.push_back(normalAttr);
-
-  for (uint32_t i = 0; i < 4; i++) {
-    rhi::VertexInputAttributeDesc matrixCol;
-    matrixCol.location     = 2 + i;
-    matrixCol.binding      = 1;
-    matrixCol.format       = rhi::TextureFormat::Rgba32f;
-    matrixCol.offset       = i * 16;
-    matrixCol.semanticName = "INSTANCE";
-    pipelineDesc.vertexAttributes.push_back(matrixCol);
-  }
-}
-
-void MeshHighlightStrategy::createFramebuffers_(const math::Dimension2i& dimension) {
-  if (!m_renderPass) {
-    GlobalLogger::Log(LogLevel::Error, "Render pass must be created before framebuffer");
-    return;
-  }
-
-  m_framebuffers.clear();
-
-  uint32_t framesCount = m_frameResources->getFramesCount();
-  for (uint32_t i = 0; i < framesCount; i++) {
-    std::string framebufferKey = "highlight_framebuffer_" + std::to_string(i);
-
-    rhi::Framebuffer* existingFramebuffer = m_resourceManager->getFramebuffer(framebufferKey);
-    if (existingFramebuffer) {
-      m_resourceManager->removeFramebuffer(framebufferKey);
-    }
-
-    auto& renderTargets = m_frameResources->getRenderTargets(i);
-
-    rhi::FramebufferDesc framebufferDesc;
-    framebufferDesc.width  = dimension.width();
-    framebufferDesc.height = dimension.height();
-    framebufferDesc.colorAttachments.push_back(renderTargets.colorBuffer.get());
-    framebufferDesc.depthStencilAttachment = renderTargets.depthBuffer.get();
-    framebufferDesc.hasDepthStencil        = true;
-    framebufferDesc.renderPass             = m_renderPass;
-
-    auto framebuffer    = m_device->createFramebuffer(framebufferDesc);
-    auto framebufferPtr = m_resourceManager->addFramebuffer(std::move(framebuffer), framebufferKey);
-
-    m_framebuffers.push_back(framebufferPtr);
-  }
-}
-
-void MeshHighlightStrategy::updateInstanceBuffer_(RenderModel*                         model,
-                                                  const std::vector<math::Matrix4f<>>& matrices,
-                                                  ModelBufferCache&                    cache) {
-  if (!cache.instanceBuffer || matrices.size() > cache.capacity) {
-    uint32_t newCapacity = std::max(static_cast<uint32_t>(matrices.size() * 1.5), 8u);
-
-    std::string bufferKey = "highlight_instance_buffer_" + std::to_string(reinterpret_cast<uintptr_t>(model));
-
-    rhi::BufferDesc bufferDesc;
-    bufferDesc.size        = newCapacity * sizeof(math::Matrix4f<>);
-    bufferDesc.createFlags = rhi::BufferCreateFlag::InstanceBuffer;
-    bufferDesc.type        = rhi::BufferType::Dynamic;
-    bufferDesc.stride      = sizeof(math::Matrix4f<>);
-    bufferDesc.debugName   = bufferKey;
-
-    auto buffer          = m_device->createBuffer(bufferDesc);
-    cache.instanceBuffer = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
-    cache.capacity       = newCapacity;
-  }
-
-  if (cache.instanceBuffer && !matrices.empty()) {
-    m_device->updateBuffer(cache.instanceBuffer, matrices.data(), matrices.size() * sizeof(math::Matrix4f<>));
-  }
-
-  cache.count = static_cast<uint32_t>(matrices.size());
-}
-
 rhi::DescriptorSet* MeshHighlightStrategy::getOrCreateHighlightParamsDescriptorSet_(const math::Vector4f& color,
                                                                                     float                  thickness,
                                                                                     bool                   xRay) {
@@ -373,8 +237,6 @@ rhi::GraphicsPipeline* MeshHighlightStrategy::getOrCreateStencilMarkPipeline_(co
     return cache.stencilMarkPipeline;
   }
 
-  std::string stencilPipelineKey = pipelineKey + "_stencil_mark";
-
   rhi::GraphicsPipelineDesc pipelineDesc;
 
   // Shaders
@@ -382,7 +244,7 @@ rhi::GraphicsPipeline* MeshHighlightStrategy::getOrCreateStencilMarkPipeline_(co
   pipelineDesc.shaders.push_back(m_pixelShader);
 
   // Vertex input
-  setupVertexInput_(pipelineDesc);
+  m_vertexLayout.fillPipelineDesc(pipelineDesc);
 
   pipelineDesc.inputAssembly.topology               = rhi::PrimitiveType::Triangles;
   pipelineDesc.inputAssembly.primitiveRestartEnable = false;
@@ -427,11 +289,13 @@ rhi::GraphicsPipeline* MeshHighlightStrategy::getOrCreateStencilMarkPipeline_(co
 
   pipelineDesc.renderPass = m_renderPass;
 
-  auto pipelineObj          = m_device->createGraphicsPipeline(pipelineDesc);
-  cache.stencilMarkPipeline = m_resourceManager->addPipeline(std::move(pipelineObj), stencilPipelineKey);
+  bool created               = false;
+  cache.stencilMarkPipeline = m_resourceManager->getOrCreatePipeline(m_device, pipelineDesc, &created);
 
-  m_shaderManager->registerPipelineForShader(cache.stencilMarkPipeline, m_stencilMarkVertexShaderPath_);
-  m_shaderManager->registerPipelineForShader(cache.stencilMarkPipeline, m_pixelShaderPath_);
+  if (created) {
+    m_shaderManager->registerPipelineForShader(cache.stencilMarkPipeline, m_stencilMarkVertexShaderPath_);
+    m_shaderManager->registerPipelineForShader(cache.stencilMarkPipeline, m_pixelShaderPath_);
+  }
 
   return cache.stencilMarkPipeline;
 }
@@ -449,7 +313,7 @@ rhi::GraphicsPipeline* MeshHighlightStrategy::getOrCreateOutlinePipeline_(const
   pipelineDesc.shaders.push_back(m_outlineVertexShader);
   pipelineDesc.shaders.push_back(m_pixelShader);
 
-  setupVertexInput_(pipelineDesc);
+  m_vertexLayout.fillPipelineDesc(pipelineDesc);
 
   pipelineDesc.inputAssembly.topology               = rhi::PrimitiveType::Triangles;
   pipelineDesc.inputAssembly.primitiveRestartEnable = false;
@@ -504,11 +368,13 @@ rhi::GraphicsPipeline* MeshHighlightStrategy::getOrCreateOutlinePipeline_(const
 
   pipelineDesc.renderPass = m_renderPass;
 
-  auto pipelineObj      = m_device->createGraphicsPipeline(pipelineDesc);
-  cache.outlinePipeline = m_resourceManager->addPipeline(std::move(pipelineObj), fullPipelineKey);
+  bool created           = false;
+  cache.outlinePipeline = m_resourceManager->getOrCreatePipeline(m_device, pipelineDesc, &created);
 
-  m_shaderManager->registerPipelineForShader(cache.outlinePipeline, m_outlineVertexShaderPath_);
-  m_shaderManager->registerPipelineForShader(cache.outlinePipeline, m_pixelShaderPath_);
+  if (created) {
+    m_shaderManager->registerPipelineForShader(cache.outlinePipeline, m_outlineVertexShaderPath_);
+    m_shaderManager->registerPipelineForShader(cache.outlinePipeline, m_pixelShaderPath_);
+  }
 
   return cache.outlinePipeline;
 }
@@ -517,63 +383,71 @@ void MeshHighlightStrategy::prepareDrawCalls_(const RenderContext& context) {
   m_drawData.clear();
 
   auto& registry = context.scene->getEntityRegistry();
-  auto  view     = registry.view<Selected, RenderModel*>();
+  if (registry.view<Selected>().empty()) {
+    return;
+  }
 
-  for (auto entity : view) {
-    auto& selectedComp = view.get<Selected>(entity);
-    auto* renderModel  = view.get<RenderModel*>(entity);
+  const auto& instanceDataStore = m_frameResources->getInstanceDataStore();
 
-    auto it = m_instanceBufferCache.find(renderModel);
-    if (it == m_instanceBufferCache.end() || it->second.count == 0) {
-      continue;
-    }
+  // the pipeline state doesn't depend on the mesh, all meshes share the same pipelines
+  const std::string pipelineKey = "highlight_pipeline";
 
-    auto& cache = it->second;
+  for (const auto& visibleModel : m_frameResources->getFrustumCuller()->getVisibleModels()) {
+    rhi::Buffer* instanceBuffer = nullptr;
+
+    for (size_t instanceIndex = 0; instanceIndex < visibleModel.entities.size(); ++instanceIndex) {
+      auto* selectedComp = registry.try_get<Selected>(visibleModel.entities[instanceIndex]);
+      if (!selectedComp) {
+        continue;
+      }
 
-    auto* highlightParamsDescriptorSet = getOrCreateHighlightParamsDescriptorSet_(
-        selectedComp.highlightColor, selectedComp.outlineThickness, selectedComp.xRay);
+      if (!instanceBuffer) {
+        instanceBuffer = instanceDataStore.getBuffer(visibleModel.model, context.frameIndex);
+        if (!instanceBuffer) {
+          break;
+        }
+      }
 
-    for (const auto& renderMesh : renderModel->renderMeshes) {
-      std::string pipelineKey
-          = "highlight_pipeline_" + std::to_string(reinterpret_cast<uintptr_t>(renderMesh->gpuMesh->vertexBuffer));
+      auto* highlightParamsDescriptorSet = getOrCreateHighlightParamsDescriptorSet_(
+          selectedComp->highlightColor, selectedComp->outlineThickness, selectedComp->xRay);
 
       rhi::GraphicsPipeline* stencilMarkPipeline = getOrCreateStencilMarkPipeline_(pipelineKey);
-      rhi::GraphicsPipeline* outlinePipeline     = getOrCreateOutlinePipeline_(pipelineKey, selectedComp.xRay);
+      rhi::GraphicsPipeline* outlinePipeline     = getOrCreateOutlinePipeline_(pipelineKey, selectedComp->xRay);
 
       if (!stencilMarkPipeline || !outlinePipeline) {
         GlobalLogger::Log(LogLevel::Error, "Failed to create highlight pipelines");
         continue;
       }
 
-      DrawData drawData;
-      drawData.stencilMarkPipeline          = stencilMarkPipeline;
-      drawData.outlinePipeline              = outlinePipeline;
-      drawData.modelMatrixDescriptorSet     = m_frameResources->getOrCreateModelMatrixDescriptorSet(renderMesh);
-      drawData.highlightParamsDescriptorSet = highlightParamsDescriptorSet;
-      drawData.vertexBuffer                 = renderMesh->gpuMesh->vertexBuffer;
-      drawData.indexBuffer                  = renderMesh->gpuMesh->indexBuffer;
-      drawData.instanceBuffer               = cache.instanceBuffer;
-      drawData.indexCount                   = renderMesh->gpuMesh->indexBuffer->getDesc().size / sizeof(uint32_t);
-      drawData.instanceCount                = cache.count;
-
-      m_drawData.push_back(drawData);
-    }
-  }
-}
-
-void MeshHighlightStrategy::cleanupUnusedBuffers_(
-    const std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>& currentFrameInstances) {
-  std::vector<RenderModel*> modelsToRemove;
+      // a selected instance is drawn alone from its slot in the shared instance buffer, with the level the base pass
+      // draws it with, so the stencil matches its silhouette
+      const uint32_t lodLevel     = visibleModel.lodLevels[instanceIndex];
+      const auto&    renderMeshes = visibleModel.model->renderMeshes;
+      for (size_t meshIndex = 0; meshIndex < renderMeshes.size(); ++meshIndex) {
+        if (!visibleModel.meshVisibility[meshIndex]) {
+          continue;
+        }
 
-  for (const auto& [model, cache] : m_instanceBufferCache) {
-    if (!currentFrameInstances.contains(model)) {
-      modelsToRemove.push_back(model);
+        const auto& renderMesh = renderMeshes[meshIndex];
+
+        DrawData drawData;
+        drawData.stencilMarkPipeline          = stencilMarkPipeline;
+        drawData.outlinePipeline              = outlinePipeline;
+        drawData.modelMatrixDescriptorSet     = m_frameResources->getOrCreateModelMatrixDescriptorSet(renderMesh);
+        drawData.highlightParamsDescriptorSet = highlightParamsDescriptorSet;
+        drawData.geometryMesh                 = renderMesh->gpuMesh;
+        drawData.indexBuffer                  = renderMesh->gpuMesh->indexBuffer;
+        drawData.instanceBuffer               = instanceBuffer;
+        drawData.indexCount                   = renderMesh->gpuMesh->getIndexCount(lodLevel);
+        drawData.firstIndex                   = renderMesh->gpuMesh->getFirstIndex(lodLevel);
+        drawData.vertexOffset                 = static_cast<int32_t>(renderMesh->gpuMesh->vertexOffset);
+        drawData.firstInstance                = visibleModel.instanceSlots[instanceIndex];
+        drawData.instanceCount                = 1;
+
+        m_drawData.push_back(drawData);
+      }
     }
   }
-
-  for (auto model : modelsToRemove) {
-    m_instanceBufferCache.erase(model);
-  }
 }
 
 }  // namespace renderer
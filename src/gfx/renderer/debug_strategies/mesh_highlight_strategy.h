@@ -2,14 +2,11 @@
 #define ARISE_MESH_HIGHLIGHT_STRATEGY_H
 
 #include "gfx/renderer/debug_strategies/debug_draw_strategy.h"
+#include "utils/buffer/vertex_layout.h"
 
 #include <unordered_map>
 #include <vector>
 
-namespace arise {
-struct RenderModel;
-}  // namespace arise
-
 namespace arise::gfx::rhi {
 class Buffer;
 class DescriptorSet;
@@ -43,12 +40,6 @@ class MeshHighlightStrategy : public DebugDrawStrategy {
   bool isExclusive() const override { return false; }
 
   private:
-  struct ModelBufferCache {
-    rhi::Buffer* instanceBuffer = nullptr;
-    uint32_t     capacity       = 0;
-    uint32_t     count          = 0;
-  };
-
   struct HighlightParams {
     math::Vector4f color;
     float           thickness;
@@ -57,26 +48,22 @@ class MeshHighlightStrategy : public DebugDrawStrategy {
   };
 
   struct DrawData {
-    rhi::GraphicsPipeline* stencilMarkPipeline          = nullptr;
-    rhi::GraphicsPipeline* outlinePipeline              = nullptr;
-    rhi::DescriptorSet*    modelMatrixDescriptorSet     = nullptr;
-    rhi::DescriptorSet*    highlightParamsDescriptorSet = nullptr;
-    rhi::Buffer*           vertexBuffer                 = nullptr;
-    rhi::Buffer*           indexBuffer                  = nullptr;
-    rhi::Buffer*           instanceBuffer               = nullptr;
-    uint32_t               indexCount                   = 0;
-    uint32_t               instanceCount                = 0;
+    rhi::GraphicsPipeline*    stencilMarkPipeline          = nullptr;
+    rhi::GraphicsPipeline*    outlinePipeline              = nullptr;
+    rhi::DescriptorSet*       modelMatrixDescriptorSet     = nullptr;
+    rhi::DescriptorSet*       highlightParamsDescriptorSet = nullptr;
+    const RenderGeometryMesh* geometryMesh                 = nullptr;
+    rhi::Buffer*              indexBuffer                  = nullptr;
+    rhi::Buffer*              instanceBuffer               = nullptr;
+    uint32_t                  indexCount                   = 0;
+    uint32_t                  firstIndex                   = 0;
+    int32_t                   vertexOffset                 = 0;
+    uint32_t                  firstInstance                = 0;
+    uint32_t                  instanceCount                = 0;
   };
 
   void setupRenderPass_();
-  void setupVertexInput_(rhi::GraphicsPipelineDesc& pipelineDesc);
-  void createFramebuffers_(const math::Dimension2i& dimension);
   void prepareDrawCalls_(const RenderContext& context);
-  void updateInstanceBuffer_(RenderModel*                         model,
-                             const std::vector<math::Matrix4f<>>& matrices,
-                             ModelBufferCache&                    cache);
-  void cleanupUnusedBuffers_(
-      const std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>& currentFrameInstances);
   rhi::DescriptorSet*    getOrCreateHighlightParamsDescriptorSet_(const math::Vector4f& color,
                                                                   float                  thickness,
                                                                   bool                   xRay);
@@ -96,14 +83,14 @@ class MeshHighlightStrategy : public DebugDrawStrategy {
   rhi::Shader* m_outlineVertexShader     = nullptr;
   rhi::Shader* m_pixelShader             = nullptr;
 
+  const VertexLayout m_vertexLayout{VertexAttribute::Position | VertexAttribute::Normal};
+
   rhi::Viewport    m_viewport;
   rhi::ScissorRect m_scissor;
 
-  rhi::RenderPass*               m_renderPass = nullptr;
-  std::vector<rhi::Framebuffer*> m_framebuffers;
+  rhi::RenderPass* m_renderPass = nullptr;
 
-  std::unordered_map<RenderModel*, ModelBufferCache> m_instanceBufferCache;
-  std::vector<DrawData>                              m_drawData;
+  std::vector<DrawData> m_drawData;
 
   rhi::DescriptorSetLayout*                                                  m_highlightParamsLayout = nullptr;
   std::unordered_map<uint64_t, std::pair<rhi::Buffer*, rhi::DescriptorSet*>> m_highlightParamsCache;
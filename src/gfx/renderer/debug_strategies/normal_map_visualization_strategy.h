@@ -2,12 +2,12 @@
 #define ARISE_NORMAL_MAP_VISUALIZATION_STRATEGY_H
 
 #include "gfx/renderer/debug_strategies/debug_draw_strategy.h"
+#include "utils/buffer/vertex_layout.h"
 
 #include <unordered_map>
 #include <vector>
 
 namespace arise {
-struct RenderModel;
 struct Material;
 }  // namespace arise
 
@@ -43,31 +43,23 @@ class NormalMapVisualizationStrategy : public DebugDrawStrategy {
   bool isExclusive() const override { return true; }
 
   private:
-  struct ModelBufferCache {
-    rhi::Buffer* instanceBuffer = nullptr;
-    uint32_t     capacity       = 0;
-    uint32_t     count          = 0;
-  };
-
   struct DrawData {
-    rhi::GraphicsPipeline* pipeline                 = nullptr;
-    rhi::DescriptorSet*    modelMatrixDescriptorSet = nullptr;
-    rhi::DescriptorSet*    materialDescriptorSet    = nullptr;
-    rhi::Buffer*           vertexBuffer             = nullptr;
-    rhi::Buffer*           indexBuffer              = nullptr;
-    rhi::Buffer*           instanceBuffer           = nullptr;
-    uint32_t               indexCount               = 0;
-    uint32_t               instanceCount            = 0;
+    rhi::GraphicsPipeline*    pipeline                 = nullptr;
+    rhi::DescriptorSet*       modelMatrixDescriptorSet = nullptr;
+    rhi::DescriptorSet*       materialDescriptorSet    = nullptr;
+    const RenderGeometryMesh* geometryMesh             = nullptr;
+    rhi::Buffer*              indexBuffer              = nullptr;
+    rhi::Buffer*              instanceBuffer           = nullptr;
+    uint32_t                  indexCount               = 0;
+    uint32_t                  firstIndex               = 0;
+    int32_t                   vertexOffset             = 0;
+    uint32_t                  firstInstance            = 0;
+    uint32_t                  instanceCount            = 0;
   };
 
   void setupRenderPass_();
-  void createFramebuffers_(const math::Dimension2i& dimension);
   void prepareDrawCalls_(const RenderContext& context);
-  void updateInstanceBuffer_(RenderModel*                         model,
-                             const std::vector<math::Matrix4f<>>& matrices,
-                             ModelBufferCache&                    cache);
-  void cleanupUnusedBuffers_(
-      const std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>& currentFrameInstances);
+  void cleanupUnusedMaterials_();
   rhi::DescriptorSet* getOrCreateMaterialDescriptorSet_(Material* material);
 
   const std::string m_vertexShaderPath_ = "assets/shaders/debug/normal_map_visualization/shader_instancing.vs.hlsl";
@@ -81,12 +73,15 @@ class NormalMapVisualizationStrategy : public DebugDrawStrategy {
   rhi::Shader* m_vertexShader = nullptr;
   rhi::Shader* m_pixelShader  = nullptr;
 
+  const VertexLayout m_vertexLayout{VertexAttribute::Position | VertexAttribute::TexCoords | VertexAttribute::Normal
+                                    | VertexAttribute::Tangent};
+
   rhi::Viewport    m_viewport;
   rhi::ScissorRect m_scissor;
 
-  rhi::RenderPass*               m_renderPass = nullptr;
-  std::vector<rhi::Framebuffer*> m_framebuffers;
-  rhi::DescriptorSetLayout*      m_materialDescriptorSetLayout = nullptr;
+  rhi::RenderPass*          m_renderPass                  = nullptr;
+  rhi::GraphicsPipeline*    m_pipeline                    = nullptr;
+  rhi::DescriptorSetLayout* m_materialDescriptorSetLayout = nullptr;
 
   struct MaterialCache {
     rhi::DescriptorSet* descriptorSet = nullptr;
@@ -94,8 +89,7 @@ class NormalMapVisualizationStrategy : public DebugDrawStrategy {
 
   std::unordered_map<Material*, MaterialCache> m_materialCache;
 
-  std::unordered_map<RenderModel*, ModelBufferCache> m_instanceBufferCache;
-  std::vector<DrawData>                              m_drawData;
+  std::vector<DrawData> m_drawData;
 };
 }  // namespace renderer
 }  // namespace gfx
@@ -1,8 +1,8 @@
 #include "gfx/renderer/debug_strategies/wireframe_strategy.h"
 
 #include "ecs/components/render_model.h"
-#include "ecs/components/vertex.h"
 #include "gfx/renderer/frame_resources.h"
+#include "gfx/renderer/frustum_culler.h"
 #include "gfx/renderer/render_resource_manager.h"
 #include "gfx/rhi/interface/buffer.h"
 #include "gfx/rhi/interface/descriptor.h"
@@ -10,6 +10,8 @@
 #include "gfx/rhi/interface/render_pass.h"
 #include "gfx/rhi/shader_manager.h"
 #include "profiler/profiler.h"
+#include "utils/buffer/geometry_arena.h"
+#include "utils/service/service_locator.h"
 
 namespace arise {
 namespace gfx {
@@ -24,6 +26,10 @@ void WireframeStrategy::initialize(rhi::Device*           device,
   m_frameResources  = frameResources;
   m_shaderManager   = shaderManager;
 
+  auto geometryArena = ServiceLocator::s_get<GeometryArena>();
+  m_vertexLayout     = VertexLayout(VertexAttribute::Position | VertexAttribute::Color,
+                                    geometryArena && geometryArena->hasVertexColors());
+
   m_vertexShader = m_shaderManager->getShader(m_vertexShaderPath_);
   m_pixelShader  = m_shaderManager->getShader(m_pixelShaderPath_);
 
@@ -42,36 +48,10 @@ void WireframeStrategy::resize(const math::Dimension2i& newDimension) {
   m_scissor.y      = 0;
   m_scissor.width  = newDimension.width();
   m_scissor.height = newDimension.height();
-
-  createFramebuffers_(newDimension);
 }
 
 void WireframeStrategy::prepareFrame(const RenderContext& context) {
-  std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>> currentFrameInstances;
-  std::unordered_map<RenderModel*, bool>                          modelDirtyFlags;
-
-  for (const auto& instance : m_frameResources->getModels()) {
-    currentFrameInstances[instance->model].push_back(instance->modelMatrix);
-
-    if (instance->isDirty && !modelDirtyFlags[instance->model]) {
-      modelDirtyFlags[instance->model] = true;
-    }
-  }
-
-  for (auto& [model, matrices] : currentFrameInstances) {
-    auto& cache = m_instanceBufferCache[model];
-
-    bool needsUpdate = cache.instanceBuffer == nullptr ||   // Buffer not created yet
-                       matrices.size() > cache.capacity ||  // Need more space
-                       matrices.size() != cache.count ||    // Count changed
-                       modelDirtyFlags[model];              // Model was modified
-
-    if (needsUpdate) {
-      updateInstanceBuffer_(model, matrices, cache);
-    }
-  }
-
-  cleanupUnusedBuffers_(currentFrameInstances);
+  // instance matrices are uploaded by FrameResources (InstanceDataStore), only the draw list is built here
   prepareDrawCalls_(context);
 }
 
@@ -79,18 +59,17 @@ void WireframeStrategy::render(const RenderContext& context) {
   CPU_ZONE_NC("Wireframe Strategy", color::ORANGE);
 
   auto commandBuffer = context.commandBuffer.get();
-  if (!commandBuffer || !m_renderPass || m_framebuffers.empty()) {
+  if (!commandBuffer || !m_renderPass || !context.renderGraph) {
     return;
   }
 
-  uint32_t currentIndex = context.currentImageIndex;
-  if (currentIndex >= m_framebuffers.size()) {
-    GlobalLogger::Log(LogLevel::Error, "Invalid framebuffer index");
+  rhi::Framebuffer* currentFramebuffer
+      = context.renderGraph->getFramebuffer(m_renderPass, context.colorTarget, context.depthTarget);
+  if (!currentFramebuffer) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to get the render graph framebuffer");
     return;
   }
 
-  rhi::Framebuffer* currentFramebuffer = m_framebuffers[currentIndex];
-
   std::vector<rhi::ClearValue> clearValues;
 
   rhi::ClearValue colorClear;
@@ -110,24 +89,30 @@ void WireframeStrategy::render(const RenderContext& context) {
   commandBuffer->setViewport(m_viewport);
   commandBuffer->setScissor(m_scissor);
 
+  const uint32_t viewConstantsOffset = m_frameResources->getViewConstantsOffset();
+
   {
     CPU_ZONE_NC("Draw Wireframe", color::GREEN);
     for (const auto& drawData : m_drawData) {
       commandBuffer->setPipeline(drawData.pipeline);
 
       if (m_frameResources->getViewDescriptorSet()) {
-        commandBuffer->bindDescriptorSet(0, m_frameResources->getViewDescriptorSet());
+        commandBuffer->bindDescriptorSet(0, m_frameResources->getViewDescriptorSet(), {&viewConstantsOffset, 1});
       }
 
       if (drawData.modelMatrixDescriptorSet) {
         commandBuffer->bindDescriptorSet(1, drawData.modelMatrixDescriptorSet);
       }
 
-      commandBuffer->bindVertexBuffer(0, drawData.vertexBuffer);
-      commandBuffer->bindVertexBuffer(1, drawData.instanceBuffer);
+      m_vertexLayout.bindVertexBuffers(*commandBuffer, *drawData.geometryMesh);
+      commandBuffer->bindVertexBuffer(m_vertexLayout.getInstanceBinding(), drawData.instanceBuffer);
       commandBuffer->bindIndexBuffer(drawData.indexBuffer, 0, true);
 
-      commandBuffer->drawIndexedInstanced(drawData.indexCount, drawData.instanceCount, 0, 0, 0);
+      commandBuffer->drawIndexedInstanced(drawData.indexCount,
+                                          drawData.instanceCount,
+                                          drawData.firstIndex,
+                                          drawData.vertexOffset,
+                                          drawData.firstInstance);
     }
   }
 
@@ -135,16 +120,14 @@ void WireframeStrategy::render(const RenderContext& context) {
 }
 
 void WireframeStrategy::clearSceneResources() {
-  m_instanceBufferCache.clear();
   m_drawData.clear();
   GlobalLogger::Log(LogLevel::Info, "Wireframe strategy resources cleared for scene switch");
 }
 
 void WireframeStrategy::cleanup() {
-  m_instanceBufferCache.clear();
   m_drawData.clear();
-  m_renderPass = nullptr;
-  m_framebuffers.clear();
+  m_pipeline     = nullptr;
+  m_renderPass   = nullptr;
   m_vertexShader = nullptr;
   m_pixelShader  = nullptr;
 }
@@ -174,86 +157,34 @@ void WireframeStrategy::setupRenderPass_() {
   m_renderPass    = m_resourceManager->addRenderPass(std::move(renderPass), "wireframe_render_pass");
 }
 
-void WireframeStrategy::createFramebuffers_(const math::Dimension2i& dimension) {
-  if (!m_renderPass) {
-    GlobalLogger::Log(LogLevel::Error, "Render pass must be created before framebuffer");
-    return;
-  }
-
-  m_framebuffers.clear();
-
-  uint32_t framesCount = m_frameResources->getFramesCount();
-  for (uint32_t i = 0; i < framesCount; i++) {
-    std::string framebufferKey = "wireframe_framebuffer_" + std::to_string(i);
-
-    rhi::Framebuffer* existingFramebuffer = m_resourceManager->getFramebuffer(framebufferKey);
-    if (existingFramebuffer) {
-      m_resourceManager->removeFramebuffer(framebufferKey);
-    }
-
-    auto& renderTargets = m_frameResources->getRenderTargets(i);
-
-    rhi::FramebufferDesc framebufferDesc;
-    framebufferDesc.width  = dimension.width();
-    framebufferDesc.height = dimension.height();
-    framebufferDesc.colorAttachments.push_back(renderTargets.colorBuffer.get());
-    framebufferDesc.depthStencilAttachment = renderTargets.depthBuffer.get();
-    framebufferDesc.hasDepthStencil        = true;
-    framebufferDesc.renderPass             = m_renderPass;
-
-    auto framebuffer    = m_device->createFramebuffer(framebufferDesc);
-    auto framebufferPtr = m_resourceManager->addFramebuffer(std::move(framebuffer), framebufferKey);
-
-    m_framebuffers.push_back(framebufferPtr);
-  }
-}
-
-void WireframeStrategy::updateInstanceBuffer_(RenderModel*                         model,
-                                              const std::vector<math::Matrix4f<>>& matrices,
-                                              ModelBufferCache&                    cache) {
-  if (!cache.instanceBuffer || matrices.size() > cache.capacity) {
-    // If we already have a buffer, we'll let the resource manager handle freeing it
-
-    // Create a new buffer with some growth room
-    uint32_t newCapacity = std::max(static_cast<uint32_t>(matrices.size() * 1.5), 8u);
-
-    std::string bufferKey = "wireframe_instance_buffer_" + std::to_string(reinterpret_cast<uintptr_t>(model));
-
-    rhi::BufferDesc bufferDesc;
-    bufferDesc.size        = newCapacity * sizeof(math::Matrix4f<>);
-    bufferDesc.createFlags = rhi::BufferCreateFlag::InstanceBuffer;
-    bufferDesc.type        = rhi::BufferType::Dynamic;
-    bufferDesc.stride      = sizeof(math::Matrix4f<>);
-    bufferDesc.debugName   = bufferKey;
-
-    auto buffer          = m_device->createBuffer(bufferDesc);
-    cache.instanceBuffer = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
-    cache.capacity       = newCapacity;
-  }
-
-  if (cache.instanceBuffer && !matrices.empty()) {
-    m_device->updateBuffer(cache.instanceBuffer, matrices.data(), matrices.size() * sizeof(math::Matrix4f<>));
-  }
-
-  cache.count = static_cast<uint32_t>(matrices.size());
-}
-
 void WireframeStrategy::prepareDrawCalls_(const RenderContext& context) {
   m_drawData.clear();
 
   auto viewDescriptorSetLayout = m_frameResources->getViewDescriptorSetLayout();
   auto modelMatrixLayout       = m_frameResources->getModelMatrixDescriptorSetLayout();
 
-  for (const auto& [model, cache] : m_instanceBufferCache) {
-    if (cache.count == 0) {
+  const auto& instanceDataStore = m_frameResources->getInstanceDataStore();
+
+  for (const auto& visibleModel : m_frameResources->getFrustumCuller()->getVisibleModels()) {
+    if (visibleModel.instanceSlots.empty()) {
+      continue;
+    }
+
+    rhi::Buffer* instanceBuffer = instanceDataStore.getBuffer(visibleModel.model, context.frameIndex);
+    if (!instanceBuffer) {
       continue;
     }
 
-    for (const auto& renderMesh : model->renderMeshes) {
-      std::string pipelineKey
-          = "wireframe_pipeline_" + std::to_string(reinterpret_cast<uintptr_t>(renderMesh->gpuMesh->vertexBuffer));
+    const auto& renderMeshes = visibleModel.model->renderMeshes;
+    for (size_t meshIndex = 0; meshIndex < renderMeshes.size(); ++meshIndex) {
+      if (!visibleModel.meshVisibility[meshIndex]) {
+        continue;
+      }
+
+      const auto& renderMesh = renderMeshes[meshIndex];
 
-      rhi::GraphicsPipeline* pipeline = m_resourceManager->getPipeline(pipelineKey);
+      // the pipeline state doesn't depend on the mesh, all meshes share one pipeline
+      rhi::GraphicsPipeline* pipeline = m_pipeline;
 
       if (!pipeline) {
         rhi::GraphicsPipelineDesc pipelineDesc;
@@ -261,43 +192,7 @@ void WireframeStrategy::prepareDrawCalls_(const RenderContext& context) {
         pipelineDesc.shaders.push_back(m_vertexShader);
         pipelineDesc.shaders.push_back(m_pixelShader);
 
-        rhi::VertexInputBindingDesc vertexBinding;
-        vertexBinding.binding   = 0;
-        vertexBinding.stride    = sizeof(Vertex);
-        vertexBinding.inputRate = rhi::VertexInputRate::Vertex;
-        pipelineDesc.vertexBindings.push_back(vertexBinding);
-
-        rhi::VertexInputBindingDesc instanceBinding;
-        instanceBinding.binding   = 1;
-        instanceBinding.stride    = sizeof(math::Matrix4f<>);
-        instanceBinding.inputRate = rhi::VertexInputRate::Instance;
-        pipelineDesc.vertexBindings.push_back(instanceBinding);
-
-        rhi::VertexInputAttributeDesc positionAttr;
-        positionAttr.location     = 0;
-        positionAttr.binding      = 0;
-        positionAttr.format       = rhi::TextureFormat::Rgb32f;
-        positionAttr.offset       = offsetof(Vertex, position);
-        positionAttr.semanticName = "POSITION";
-        pipelineDesc.vertexAttributes.push_back(positionAttr);
-
-        rhi::VertexInputAttributeDesc colorAttr;
-        colorAttr.location     = 1;
-        colorAttr.binding      = 0;
-        colorAttr.format       = rhi::TextureFormat::Rgba32f;
-        colorAttr.offset       = offsetof(Vertex, color);
-        colorAttr.semanticName = "COLOR";
-        pipelineDesc.vertexAttributes.push_back(colorAttr);
-
-        for (uint32_t i = 0; i < 4; i++) {
-          rhi::VertexInputAttributeDesc matrixCol;
-          matrixCol.location     = 2 + i;
-          matrixCol.binding      = 1;
-          matrixCol.format       = rhi::TextureFormat::Rgba32f;
-          matrixCol.offset       = i * 16;
-          matrixCol.semanticName = "INSTANCE";
-          pipelineDesc.vertexAttributes.push_back(matrixCol);
-        }
+        m_vertexLayout.fillPipelineDesc(pipelineDesc);
 
         pipelineDesc.inputAssembly.topology               = rhi::PrimitiveType::Triangles;
         pipelineDesc.inputAssembly.primitiveRestartEnable = false;
@@ -324,40 +219,40 @@ void WireframeStrategy::prepareDrawCalls_(const RenderContext& context) {
 
         pipelineDesc.renderPass = m_renderPass;
 
-        auto pipelineObj = m_device->createGraphicsPipeline(pipelineDesc);
-        pipeline         = m_resourceManager->addPipeline(std::move(pipelineObj), pipelineKey);
+        bool created = false;
+        pipeline     = m_resourceManager->getOrCreatePipeline(m_device, pipelineDesc, &created);
+        m_pipeline   = pipeline;
 
-        m_shaderManager->registerPipelineForShader(pipeline, m_vertexShaderPath_);
-        m_shaderManager->registerPipelineForShader(pipeline, m_pixelShaderPath_);
+        if (created) {
+          m_shaderManager->registerPipelineForShader(pipeline, m_vertexShaderPath_);
+          m_shaderManager->registerPipelineForShader(pipeline, m_pixelShaderPath_);
+        }
       }
 
       DrawData drawData;
       drawData.pipeline                 = pipeline;
       drawData.modelMatrixDescriptorSet = m_frameResources->getOrCreateModelMatrixDescriptorSet(renderMesh);
-      drawData.vertexBuffer             = renderMesh->gpuMesh->vertexBuffer;
+      drawData.geometryMesh             = renderMesh->gpuMesh;
       drawData.indexBuffer              = renderMesh->gpuMesh->indexBuffer;
-      drawData.instanceBuffer           = cache.instanceBuffer;
-      drawData.indexCount               = renderMesh->gpuMesh->indexBuffer->getDesc().size / sizeof(uint32_t);
-      drawData.instanceCount            = cache.count;
+      drawData.instanceBuffer           = instanceBuffer;
+      drawData.vertexOffset             = static_cast<int32_t>(renderMesh->gpuMesh->vertexOffset);
 
-      m_drawData.push_back(drawData);
-    }
-  }
-}
+      for (const auto& lodGroup : visibleModel.lodGroups) {
+        if (lodGroup.isFadingOut()) {
+          continue;
+        }
 
-void WireframeStrategy::cleanupUnusedBuffers_(
-    const std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>& currentFrameInstances) {
-  std::vector<RenderModel*> modelsToRemove;
+        drawData.indexCount = renderMesh->gpuMesh->getIndexCount(lodGroup.level);
+        drawData.firstIndex = renderMesh->gpuMesh->getFirstIndex(lodGroup.level);
 
-  for (const auto& [model, cache] : m_instanceBufferCache) {
-    if (!currentFrameInstances.contains(model)) {
-      modelsToRemove.push_back(model);
+        for (const auto& range : lodGroup.instanceRanges) {
+          drawData.firstInstance = range.firstInstance;
+          drawData.instanceCount = range.instanceCount;
+          m_drawData.push_back(drawData);
+        }
+      }
     }
   }
-
-  for (auto model : modelsToRemove) {
-    m_instanceBufferCache.erase(model);
-  }
 }
 
 }  // namespace renderer
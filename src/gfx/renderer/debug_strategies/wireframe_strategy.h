@@ -2,14 +2,10 @@
 #define ARISE_WIREFRAME_STRATEGY_H
 
 #include "gfx/renderer/debug_strategies/debug_draw_strategy.h"
+#include "utils/buffer/vertex_layout.h"
 
-#include <unordered_map>
 #include <vector>
 
-namespace arise {
-struct RenderModel;
-}  // namespace arise
-
 namespace arise::gfx::rhi {
 class Buffer;
 class DescriptorSet;
@@ -44,30 +40,21 @@ class WireframeStrategy : public DebugDrawStrategy {
   bool isExclusive() const override { return true; }
 
   private:
-  struct ModelBufferCache {
-    rhi::Buffer* instanceBuffer = nullptr;
-    uint32_t     capacity       = 0;
-    uint32_t     count          = 0;
-  };
-
   struct DrawData {
-    rhi::GraphicsPipeline* pipeline                 = nullptr;
-    rhi::DescriptorSet*    modelMatrixDescriptorSet = nullptr;
-    rhi::Buffer*           vertexBuffer             = nullptr;
-    rhi::Buffer*           indexBuffer              = nullptr;
-    rhi::Buffer*           instanceBuffer           = nullptr;
-    uint32_t               indexCount               = 0;
-    uint32_t               instanceCount            = 0;
+    rhi::GraphicsPipeline*    pipeline                 = nullptr;
+    rhi::DescriptorSet*       modelMatrixDescriptorSet = nullptr;
+    const RenderGeometryMesh* geometryMesh             = nullptr;
+    rhi::Buffer*              indexBuffer              = nullptr;
+    rhi::Buffer*              instanceBuffer           = nullptr;
+    uint32_t                  indexCount               = 0;
+    uint32_t                  firstIndex               = 0;
+    int32_t                   vertexOffset             = 0;
+    uint32_t                  firstInstance            = 0;
+    uint32_t                  instanceCount            = 0;
   };
 
   void setupRenderPass_();
-  void createFramebuffers_(const math::Dimension2i& dimension);
   void prepareDrawCalls_(const RenderContext& context);
-  void updateInstanceBuffer_(RenderModel*                         model,
-                             const std::vector<math::Matrix4f<>>& matrices,
-                             ModelBufferCache&                    cache);
-  void cleanupUnusedBuffers_(
-      const std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>& currentFrameInstances);
 
   const std::string m_vertexShaderPath_ = "assets/shaders/debug/wireframe/shader_instancing.vs.hlsl";
   const std::string m_pixelShaderPath_  = "assets/shaders/debug/wireframe/shader.ps.hlsl";
@@ -80,14 +67,16 @@ class WireframeStrategy : public DebugDrawStrategy {
   rhi::Shader* m_vertexShader = nullptr;
   rhi::Shader* m_pixelShader  = nullptr;
 
+  // the color stream is replaced by a white default color when the arena doesn't keep vertex colors
+  VertexLayout m_vertexLayout{VertexAttribute::Position | VertexAttribute::Color};
+
   rhi::Viewport    m_viewport;
   rhi::ScissorRect m_scissor;
 
-  rhi::RenderPass*               m_renderPass = nullptr;
-  std::vector<rhi::Framebuffer*> m_framebuffers;
+  rhi::RenderPass*       m_renderPass = nullptr;
+  rhi::GraphicsPipeline* m_pipeline   = nullptr;
 
-  std::unordered_map<RenderModel*, ModelBufferCache> m_instanceBufferCache;
-  std::vector<DrawData>                              m_drawData;
+  std::vector<DrawData> m_drawData;
 };
 
 }  // namespace renderer
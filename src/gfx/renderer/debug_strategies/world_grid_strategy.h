@@ -43,7 +43,6 @@ class WorldGridStrategy : public DebugDrawStrategy {
   //};
 
   void setupRenderPass_();
-  void createFramebuffers_(const math::Dimension2i& dimension);
   void createPipeline_();
   //void updateGridParameters_(const RenderContext& context);
 
@@ -62,8 +61,7 @@ class WorldGridStrategy : public DebugDrawStrategy {
   rhi::Viewport    m_viewport;
   rhi::ScissorRect m_scissor;
 
-  rhi::RenderPass*               m_renderPass = nullptr;
-  std::vector<rhi::Framebuffer*> m_framebuffers;
+  rhi::RenderPass* m_renderPass = nullptr;
 
   //rhi::Buffer*              m_gridParametersBuffer = nullptr;
   //rhi::DescriptorSetLayout* m_gridLayout           = nullptr;
@@ -0,0 +1,82 @@
+#include "gfx/renderer/draw_packet.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+namespace {
+
+constexpr uint32_t RADIX_BITS    = 8;
+constexpr uint32_t RADIX_BUCKETS = 1u << RADIX_BITS;
+constexpr uint32_t RADIX_PASSES  = 64 / RADIX_BITS;
+
+// below this the histogram passes cost more than a comparison sort
+constexpr size_t RADIX_SORT_THRESHOLD = 64;
+
+}  // namespace
+
+uint32_t DrawSortKey::s_quantizeDepth(float distance) {
+  if (!(distance > 0.0f)) {
+    return 0;
+  }
+
+  uint32_t bits;
+  std::memcpy(&bits, &distance, sizeof(bits));
+  return bits >> (32 - s_depthBits);
+}
+
+void g_radixSortDrawPackets(std::vector<DrawPacket>& packets, std::vector<DrawPacket>& scratch) {
+  if (packets.size() < RADIX_SORT_THRESHOLD) {
+    std::stable_sort(packets.begin(), packets.end(), [](const DrawPacket& a, const DrawPacket& b) {
+      return a.sortKey < b.sortKey;
+    });
+    return;
+  }
+
+  // all histograms in one pass over the keys
+  std::array<std::array<uint32_t, RADIX_BUCKETS>, RADIX_PASSES> histograms{};
+  for (const auto& packet : packets) {
+    for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass) {
+      ++histograms[pass][(packet.sortKey >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
+    }
+  }
+
+  scratch.resize(packets.size());
+  auto* src = &packets;
+  auto* dst = &scratch;
+
+  for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass) {
+    auto& histogram = histograms[pass];
+
+    // every key has the same digit (e.g. unused high bits of the pass field), nothing to reorder
+    const uint32_t firstDigit = (src->front().sortKey >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+    if (histogram[firstDigit] == packets.size()) {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (auto& count : histogram) {
+      uint32_t bucketSize = count;
+      count               = offset;
+      offset             += bucketSize;
+    }
+
+    for (const auto& packet : *src) {
+      (*dst)[histogram[(packet.sortKey >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++] = packet;
+    }
+
+    std::swap(src, dst);
+  }
+
+  if (src != &packets) {
+    packets.swap(scratch);
+  }
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
@@ -0,0 +1,80 @@
+#ifndef ARISE_DRAW_PACKET_H
+#define ARISE_DRAW_PACKET_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+/**
+ * 64-bit key a draw is sorted by, from the most significant bits:
+ *
+ *   | pass (4) | pipeline (12) | material (16) | mesh (16) | depth (16) |
+ *
+ * Draws sharing the expensive state (pipeline, then material) end up next to each other, so the recorder can skip
+ * the redundant binds. Ids wider than their field wrap around - that only makes the grouping less perfect, the order
+ * never affects correctness.
+ */
+struct DrawSortKey {
+  static constexpr uint32_t s_passBits     = 4;
+  static constexpr uint32_t s_pipelineBits = 12;
+  static constexpr uint32_t s_materialBits = 16;
+  static constexpr uint32_t s_meshBits     = 16;
+  static constexpr uint32_t s_depthBits    = 16;
+
+  static uint64_t s_make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth) {
+    uint64_t key = pass & ((1u << s_passBits) - 1);
+    key          = (key << s_pipelineBits) | (pipeline & ((1u << s_pipelineBits) - 1));
+    key          = (key << s_materialBits) | (material & ((1u << s_materialBits) - 1));
+    key          = (key << s_meshBits) | (mesh & ((1u << s_meshBits) - 1));
+    key          = (key << s_depthBits) | (depth & ((1u << s_depthBits) - 1));
+    return key;
+  }
+
+  /**
+   * Quantizes a non-negative distance (squared distance works too) to the depth field. The upper bits of a positive
+   * float grow monotonically with its value, so no near / far range is needed.
+   */
+  static uint32_t s_quantizeDepth(float distance);
+};
+
+struct DrawPacket {
+  uint64_t sortKey   = 0;
+  uint32_t drawIndex = 0;  // index into the pass' own draw data
+};
+
+// Sorts packets by sortKey (stable), scratch is reused between frames to avoid allocations
+void g_radixSortDrawPackets(std::vector<DrawPacket>& packets, std::vector<DrawPacket>& scratch);
+
+/**
+ * Hands out small sequential ids for render objects (pipelines, materials, meshes) to be used in sort keys.
+ * Ids are stable while the object is alive, clear() on a scene switch.
+ */
+class DrawKeyIds {
+  public:
+  uint32_t getId(const void* object) {
+    auto [it, inserted] = m_ids.try_emplace(object, m_nextId);
+    if (inserted) {
+      ++m_nextId;
+    }
+    return it->second;
+  }
+
+  void clear() {
+    m_ids.clear();
+    m_nextId = 0;
+  }
+
+  private:
+  std::unordered_map<const void*, uint32_t> m_ids;
+  uint32_t                                  m_nextId = 0;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_DRAW_PACKET_H
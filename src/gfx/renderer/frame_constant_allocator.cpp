@@ -0,0 +1,89 @@
+#include "gfx/renderer/frame_constant_allocator.h"
+
+#include "gfx/renderer/render_resource_manager.h"
+#include "gfx/rhi/interface/buffer.h"
+#include "gfx/rhi/interface/device.h"
+#include "utils/logger/global_logger.h"
+#include "utils/memory/align.h"
+
+#include <algorithm>
+#include <string>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+namespace {
+
+constexpr const char* FRAME_CONSTANT_BUFFER_NAME = "frame_constant_buffer";
+
+}  // namespace
+
+void FrameConstantAllocator::initialize(rhi::Device*           device,
+                                        RenderResourceManager* resourceManager,
+                                        uint32_t               framesCount,
+                                        uint32_t               bytesPerFrame) {
+  m_device          = device;
+  m_resourceManager = resourceManager;
+  m_framesCount     = std::max(framesCount, 1u);
+
+  // every frame region starts at an offset valid for constant buffer views / dynamic offsets
+  m_bytesPerFrame = static_cast<uint32_t>(alignConstantBufferSize(bytesPerFrame));
+
+  rhi::BufferDesc bufferDesc;
+  bufferDesc.size        = static_cast<uint64_t>(m_bytesPerFrame) * m_framesCount;
+  bufferDesc.createFlags = rhi::BufferCreateFlag::CpuAccess | rhi::BufferCreateFlag::ConstantBuffer;
+  bufferDesc.type        = rhi::BufferType::Dynamic;
+  bufferDesc.debugName   = FRAME_CONSTANT_BUFFER_NAME;
+
+  auto buffer  = m_device->createBuffer(bufferDesc);
+  m_buffer     = m_resourceManager->addBuffer(std::move(buffer), FRAME_CONSTANT_BUFFER_NAME);
+  m_mappedData = m_buffer ? static_cast<uint8_t*>(m_buffer->getMappedData()) : nullptr;
+
+  if (!m_mappedData) {
+    GlobalLogger::Log(LogLevel::Error, "Frame constant buffer is not persistently mapped");
+  }
+
+  beginFrame(0);
+}
+
+void FrameConstantAllocator::beginFrame(uint32_t frameIndex) {
+  m_frameBegin       = (frameIndex % m_framesCount) * m_bytesPerFrame;
+  m_frameOffset      = m_frameBegin;
+  m_frameEnd         = m_frameBegin + m_bytesPerFrame;
+  m_overflowReported = false;
+}
+
+FrameConstantAllocator::Allocation FrameConstantAllocator::allocate(uint32_t size) {
+  const uint32_t alignedSize = static_cast<uint32_t>(alignConstantBufferSize(size));
+
+  if (!m_mappedData || m_frameOffset + alignedSize > m_frameEnd) {
+    if (m_mappedData && !m_overflowReported) {
+      GlobalLogger::Log(LogLevel::Error,
+                        "Frame constant buffer is exhausted (" + std::to_string(m_bytesPerFrame) + " bytes per frame)");
+      m_overflowReported = true;
+    }
+    return {};
+  }
+
+  Allocation allocation;
+  allocation.offset = m_frameOffset;
+  allocation.data   = m_mappedData + m_frameOffset;
+
+  m_frameOffset += alignedSize;
+  return allocation;
+}
+
+// the buffer itself is owned by the resource manager
+void FrameConstantAllocator::clear() {
+  m_buffer        = nullptr;
+  m_mappedData    = nullptr;
+  m_bytesPerFrame = 0;
+  m_frameBegin    = 0;
+  m_frameOffset   = 0;
+  m_frameEnd      = 0;
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
@@ -0,0 +1,82 @@
+#ifndef ARISE_FRAME_CONSTANT_ALLOCATOR_H
+#define ARISE_FRAME_CONSTANT_ALLOCATOR_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace arise::gfx::rhi {
+class Buffer;
+class Device;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+class RenderResourceManager;
+
+/**
+ * Linear allocator of transient shader constants (view, material parameters, ...).
+ *
+ * One persistently mapped buffer split into a region per frame in flight. The region of a frame is rewritten only after
+ * the frame's fence was waited (beginFrame), so the CPU never writes constants the GPU may still read. Allocations are
+ * bound through UniformbufferDynamic bindings: the descriptor set points to the buffer once and the allocation offset
+ * is passed as the dynamic offset when the set is bound.
+ */
+class FrameConstantAllocator {
+  public:
+  struct Allocation {
+    uint32_t offset = 0;  // dynamic offset of the constants
+    void*    data   = nullptr;
+
+    bool isValid() const { return data != nullptr; }
+  };
+
+  void initialize(rhi::Device*           device,
+                  RenderResourceManager* resourceManager,
+                  uint32_t               framesCount,
+                  uint32_t               bytesPerFrame);
+
+  // Starts allocating from the region of the frame, the previous content of the region is discarded
+  void beginFrame(uint32_t frameIndex);
+
+  // Returns an invalid allocation when the frame's region is exhausted
+  Allocation allocate(uint32_t size);
+
+  template <typename T>
+  Allocation push(const T& constants) {
+    auto allocation = allocate(sizeof(T));
+    if (allocation.isValid()) {
+      std::memcpy(allocation.data, &constants, sizeof(T));
+    }
+    return allocation;
+  }
+
+  void clear();
+
+  rhi::Buffer* getBuffer() const { return m_buffer; }
+
+  // Bytes allocated in the current frame (statistics)
+  uint32_t getUsedBytes() const { return m_frameOffset - m_frameBegin; }
+
+  private:
+  rhi::Device*           m_device          = nullptr;
+  RenderResourceManager* m_resourceManager = nullptr;
+
+  rhi::Buffer* m_buffer     = nullptr;
+  uint8_t*     m_mappedData = nullptr;
+
+  uint32_t m_framesCount   = 1;
+  uint32_t m_bytesPerFrame = 0;
+  uint32_t m_frameBegin    = 0;
+  uint32_t m_frameOffset   = 0;
+  uint32_t m_frameEnd      = 0;
+
+  bool m_overflowReported = false;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_FRAME_CONSTANT_ALLOCATOR_H
@@ -2,21 +2,36 @@
 
 #include "ecs/components/camera.h"
 #include "ecs/components/light.h"
+#include "ecs/components/world_matrix.h"
 #include "ecs/systems/light_system.h"
 #include "ecs/systems/system_manager.h"
+#include "gfx/renderer/frustum_culler.h"
 #include "gfx/renderer/render_resource_manager.h"
 #include "utils/memory/align.h"
 #include "utils/service/service_locator.h"
 #include "profiler/profiler.h"
 
+#include <unordered_set>
 
 namespace arise {
 namespace gfx {
 namespace renderer {
 
+namespace {
+
+// view and per-pass constants, 256 bytes each
+constexpr uint32_t FRAME_CONSTANT_BYTES_PER_FRAME = 1024 * 1024;
+
+}  // namespace
+
 FrameResources::FrameResources(rhi::Device* device, RenderResourceManager* resourceManager)
     : m_device(device)
-    , m_resourceManager(resourceManager) {
+    , m_resourceManager(resourceManager)
+    , m_frustumCuller(std::make_unique<FrustumCuller>()) {
+}
+
+FrameResources::~FrameResources() {
+  cleanup();
 }
 
 void FrameResources::initialize(uint32_t framesCount) {
@@ -26,14 +41,24 @@ void FrameResources::initialize(uint32_t framesCount) {
 
   createViewDescriptorSetLayout_();
   createModelMatrixDescriptorSetLayout_();
-  createMaterialDescriptorSetLayout_();
   createDefaultTextures_();
 
+  // in the order of MaterialTexture
+  m_materialTable.initialize(m_device,
+                             m_resourceManager,
+                             framesCount,
+                             {m_defaultWhiteTexture, m_defaultNormalTexture, m_defaultBlackTexture});
+
   createDefaultSampler_();
   createSamplerDescriptorSet_();
 
   m_renderTargetsPerFrame.resize(framesCount);
 
+  m_instanceDataStore.initialize(m_device, m_resourceManager, framesCount);
+
+  m_constantAllocator.initialize(m_device, m_resourceManager, framesCount, FRAME_CONSTANT_BYTES_PER_FRAME);
+  createViewDescriptorSet_();
+
   m_initialized = true;
 }
 
@@ -68,17 +93,28 @@ void FrameResources::updatePerFrameResources(const RenderContext& context) {
 
   clearInternalDirtyFlags_();
 
+  // the frame's fence was waited, constants of the frame that used this region before are no longer read
+  m_constantAllocator.beginFrame(context.frameIndex);
+
   updateViewResources_(context);
   updateModelList_(context);
+  m_instanceDataStore.upload(context.frameIndex);
+  m_materialTable.upload(context.frameIndex);
+  cullModels_(context);
 
   clearEntityDirtyFlags_(context);
 }
 
 void FrameResources::clearSceneResources() {
-  m_modelsMap.clear();
+  m_instanceDataStore.clear();
+  m_modelInstances.clear();
+  m_modelInstanceIndices.clear();
+  m_dirtyInstances.clear();
   m_sortedModels.clear();
+  m_trackedScene = nullptr;
+  m_frustumCuller->clear();
   m_modelMatrixCache.clear();
-  m_materialParamCache.clear();
+  m_materialTable.clear();
   GlobalLogger::Log(LogLevel::Info, "Frame resources cleared for scene switch");
 }
 
@@ -87,16 +123,22 @@ void FrameResources::cleanup() {
 
   m_viewDescriptorSet       = nullptr;
   m_viewDescriptorSetLayout = nullptr;
-  m_viewUniformBuffer       = nullptr;
+  m_viewConstantsOffset     = 0;
 
   m_defaultSamplerDescriptorSet = nullptr;
   m_defaultSampler              = nullptr;
 
   m_modelMatrixCache.clear();
-  m_materialParamCache.clear();
+  m_materialTable.clear();
+  m_constantAllocator.clear();
 
   m_sortedModels.clear();
-  m_modelsMap.clear();
+  m_instanceDataStore.clear();
+  m_modelInstances.clear();
+  m_modelInstanceIndices.clear();
+  m_dirtyInstances.clear();
+  m_trackedScene = nullptr;
+  m_frustumCuller->clear();
 
   m_initialized = false;
 }
@@ -130,70 +172,11 @@ rhi::DescriptorSetLayout* FrameResources::getLightDescriptorSetLayout() const {
   return m_lightSystem->getLightDescriptorSetLayout();
 }
 
-rhi::Buffer* FrameResources::getOrCreateMaterialParamBuffer(Material* material) {
-  if (!material) {
-    GlobalLogger::Log(LogLevel::Warning, "Material is null");
-    return nullptr;
-  }
-
-  auto it = m_materialParamCache.find(material);
-  if (it != m_materialParamCache.end() && it->second.paramBuffer) {
-    return it->second.paramBuffer;
-  }
-
-  std::string bufferKey = "material_params_" + std::to_string(reinterpret_cast<uintptr_t>(material));
-
-  rhi::BufferDesc bufferDesc;
-  bufferDesc.size        = alignConstantBufferSize(sizeof(MaterialParametersData));
-  bufferDesc.createFlags = rhi::BufferCreateFlag::CpuAccess | rhi::BufferCreateFlag::ConstantBuffer;
-  bufferDesc.type        = rhi::BufferType::Dynamic;
-  bufferDesc.debugName   = bufferKey;
-
-  auto buffer    = m_device->createBuffer(bufferDesc);
-  auto bufferPtr = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
-
-  MaterialParametersData paramData = {};
-
-  auto colorIt = material->vectorParameters.find("base_color");
-  if (colorIt != material->vectorParameters.end()) {
-    paramData.baseColor = colorIt->second;
-  } else {
-    paramData.baseColor = math::Vector4f(1.0f, 1.0f, 1.0f, 1.0f);
-  }
-
-  auto metallicIt = material->scalarParameters.find("metallic");
-  if (metallicIt != material->scalarParameters.end()) {
-    paramData.metallic = metallicIt->second;
-  } else {
-    paramData.metallic = 0.0f;
-  }
-
-  auto roughnessIt = material->scalarParameters.find("roughness");
-  if (roughnessIt != material->scalarParameters.end()) {
-    paramData.roughness = roughnessIt->second;
-  } else {
-    paramData.roughness = 1.0f;
-  }
-
-  auto opacityIt = material->scalarParameters.find("opacity");
-  if (opacityIt != material->scalarParameters.end()) {
-    paramData.opacity = opacityIt->second;
-  } else {
-    paramData.opacity = 1.0f;
-  }
-
-  m_device->updateBuffer(bufferPtr, &paramData, sizeof(paramData));
-
-  m_materialParamCache[material].paramBuffer = bufferPtr;
-
-  return bufferPtr;
-}
-
 void FrameResources::createViewDescriptorSetLayout_() {
   rhi::DescriptorSetLayoutDesc        viewLayoutDesc;
   rhi::DescriptorSetLayoutBindingDesc viewBindingDesc;
   viewBindingDesc.binding    = 0;
-  viewBindingDesc.type       = rhi::ShaderBindingType::Uniformbuffer;
+  viewBindingDesc.type       = rhi::ShaderBindingType::UniformbufferDynamic;
   viewBindingDesc.stageFlags = rhi::ShaderStageFlag::Vertex | rhi::ShaderStageFlag::Fragment;
   viewLayoutDesc.bindings.push_back(viewBindingDesc);
 
@@ -201,6 +184,12 @@ void FrameResources::createViewDescriptorSetLayout_() {
   m_viewDescriptorSetLayout = m_resourceManager->addDescriptorSetLayout(std::move(viewSetLayout), "view_set_layout");
 }
 
+void FrameResources::createViewDescriptorSet_() {
+  auto viewDescriptorSet = m_device->createDescriptorSet(m_viewDescriptorSetLayout);
+  viewDescriptorSet->setUniformBuffer(0, m_constantAllocator.getBuffer(), 0, sizeof(ViewData));
+  m_viewDescriptorSet = m_resourceManager->addDescriptorSet(std::move(viewDescriptorSet), "view_descriptor_set");
+}
+
 void FrameResources::createModelMatrixDescriptorSetLayout_() {
   rhi::DescriptorSetLayoutDesc        layoutDesc;
   rhi::DescriptorSetLayoutBindingDesc bindingDesc;
@@ -214,31 +203,6 @@ void FrameResources::createModelMatrixDescriptorSetLayout_() {
       = m_resourceManager->addDescriptorSetLayout(std::move(layout), "model_matrix_layout");
 }
 
-void FrameResources::createMaterialDescriptorSetLayout_() {
-  rhi::DescriptorSetLayoutDesc materialLayoutDesc;
-
-  rhi::DescriptorSetLayoutBindingDesc paramsBindingDesc;
-  paramsBindingDesc.binding    = 0;
-  paramsBindingDesc.type       = rhi::ShaderBindingType::Uniformbuffer;
-  paramsBindingDesc.stageFlags = rhi::ShaderStageFlag::Fragment;
-  materialLayoutDesc.bindings.push_back(paramsBindingDesc);
-
-  std::vector<std::string> textureNames = {"albedo", "normal_map", "metallic_roughness"};
-  uint32_t                 binding      = 1;
-
-  for (const auto& textureName : textureNames) {
-    rhi::DescriptorSetLayoutBindingDesc textureBindingDesc;
-    textureBindingDesc.binding    = binding++;
-    textureBindingDesc.type       = rhi::ShaderBindingType::TextureSrv;
-    textureBindingDesc.stageFlags = rhi::ShaderStageFlag::Fragment;
-    materialLayoutDesc.bindings.push_back(textureBindingDesc);
-  }
-
-  auto materialSetLayout = m_device->createDescriptorSetLayout(materialLayoutDesc);
-  m_materialDescriptorSetLayout
-      = m_resourceManager->addDescriptorSetLayout(std::move(materialSetLayout), "material_layout");
-}
-
 void FrameResources::createDefaultTextures_() {
   // 1x1 white texture (for albedo when missing)
   {
@@ -340,17 +304,8 @@ void FrameResources::createRenderTargets_(RenderTargets& targets, const math::Di
   colorDesc.initialLayout = rhi::ResourceLayout::ColorAttachment;
   colorDesc.debugName     = "color_buffer";
 
+  // the depth buffer isn't needed after the frame, it's a transient of the render graph (see Renderer)
   targets.colorBuffer = m_device->createTexture(colorDesc);
-
-  rhi::TextureDesc depthDesc;
-  depthDesc.width         = width;
-  depthDesc.height        = height;
-  depthDesc.format        = rhi::TextureFormat::D24S8;
-  depthDesc.createFlags   = rhi::TextureCreateFlag::Dsv;
-  depthDesc.initialLayout = rhi::ResourceLayout::DepthStencilAttachment;
-  depthDesc.debugName     = "depth_buffer";
-
-  targets.depthBuffer = m_device->createTexture(depthDesc);
 }
 
 void FrameResources::updateViewResources_(const RenderContext& context) {
@@ -358,6 +313,8 @@ void FrameResources::updateViewResources_(const RenderContext& context) {
   auto& registry = context.scene->getEntityRegistry();
   auto  view     = registry.view<Transform, Camera, CameraMatrices>();
 
+  m_hasCamera = false;
+
   if (view.begin() == view.end()) {
     GlobalLogger::Log(LogLevel::Warning, "No main Camera exists!");
     return;
@@ -367,33 +324,7 @@ void FrameResources::updateViewResources_(const RenderContext& context) {
   auto& transform    = view.get<Transform>(entity);
   auto& cameraMatrix = view.get<CameraMatrices>(entity);
 
-  if (!m_viewUniformBuffer) {
-    rhi::BufferDesc viewUboDesc;
-    viewUboDesc.size = alignConstantBufferSize(sizeof(math::Matrix4f<>) * 6 + sizeof(math::Vector3f) + sizeof(float));
-    viewUboDesc.createFlags = rhi::BufferCreateFlag::CpuAccess | rhi::BufferCreateFlag::ConstantBuffer;
-    viewUboDesc.type        = rhi::BufferType::Dynamic;
-    viewUboDesc.debugName   = "view_buffer";
-
-    auto viewBuffer     = m_device->createBuffer(viewUboDesc);
-    m_viewUniformBuffer = m_resourceManager->addBuffer(std::move(viewBuffer), "view_buffer");
-
-    // Create descriptor set as well
-    auto viewDescriptorSet = m_device->createDescriptorSet(m_viewDescriptorSetLayout);
-    viewDescriptorSet->setUniformBuffer(0, m_viewUniformBuffer);
-    m_viewDescriptorSet = m_resourceManager->addDescriptorSet(std::move(viewDescriptorSet), "view_descriptor_set");
-  }
-
-  struct ViewData {
-    math::Matrix4f<> view;
-    math::Matrix4f<> projection;
-    math::Matrix4f<> viewProjection;
-    math::Matrix4f<> invView;
-    math::Matrix4f<> invProjection;
-    math::Matrix4f<> invViewProjection;
-    math::Vector3f  eyePosition;
-    float            padding;
-  } viewData;
-
+  ViewData viewData;
   viewData.view              = cameraMatrix.view;
   viewData.projection        = cameraMatrix.projection;
   viewData.viewProjection    = cameraMatrix.view * cameraMatrix.projection;
@@ -403,84 +334,189 @@ void FrameResources::updateViewResources_(const RenderContext& context) {
   viewData.eyePosition       = transform.translation;
   viewData.padding           = 0.0f;
 
-  m_device->updateBuffer(m_viewUniformBuffer, &viewData, sizeof(viewData));
+  // the first allocation of the frame, it can't run out of space
+  m_viewConstantsOffset = m_constantAllocator.push(viewData).offset;
+
+  m_view           = viewData.view;
+  m_projection     = viewData.projection;
+  m_viewProjection = viewData.viewProjection;
+  m_cameraPosition = viewData.eyePosition;
+  m_hasCamera      = true;
 }
 
 void FrameResources::updateModelList_(const RenderContext& context) {
-  bool                             needRebuildRenderArray = false;
-  std::unordered_set<entt::entity> currentEntityIds;
-  std::unordered_set<Material*>    activeMaterials;
-
   auto& registry = context.scene->getEntityRegistry();
-  auto  view     = registry.view<Transform, RenderModel*>();
 
-  for (auto entity : view) {
-    currentEntityIds.insert(entity);
-    auto& transform   = view.get<Transform>(entity);
-    auto& renderModel = view.get<RenderModel*>(entity);
+  // consumed before a possible rebuild as well, so the recorded changes don't pile up
+  context.scene->getChangeTracker().consume(m_changedEntities, m_movedEntities);
 
-    for (const auto& renderMesh : renderModel->renderMeshes) {
-      if (renderMesh->material) {
-        activeMaterials.insert(renderMesh->material);
-      }
-    }
+  if (context.scene != m_trackedScene) {
+    m_trackedScene = context.scene;
+    rebuildModelList_(registry);
+    return;
+  }
 
-    auto it = m_modelsMap.find(entity);
-    if (it != m_modelsMap.end()) {
-      if (transform.isDirty) {
-        it->second.transform   = transform;
-        it->second.modelMatrix = calculateTransformMatrix(transform);
-        it->second.isDirty     = true;
-      }
-    } else {
-      ModelInstance instance;
-      instance.model       = renderModel;
-      instance.transform   = transform;
-      instance.modelMatrix = calculateTransformMatrix(transform);
-      instance.entityId    = entity;
-      instance.isDirty     = true;
-
-      if (!renderModel->renderMeshes.empty() && renderModel->renderMeshes[0]->material) {
-        instance.materialId = reinterpret_cast<uintptr_t>(renderModel->renderMeshes[0]->material);
-      }
+  bool needRebuildRenderArray = false;
+  for (auto entity : m_changedEntities) {
+    needRebuildRenderArray |= syncModelInstance_(registry, entity);
+  }
 
-      m_modelsMap[entity]    = instance;
-      needRebuildRenderArray = true;
+  for (auto entity : m_movedEntities) {
+    auto instance = findModelInstance_(entity);
+    if (!instance || !registry.valid(entity)) {
+      continue;
     }
-  }
 
-  for (auto it = m_modelsMap.begin(); it != m_modelsMap.end();) {
-    if (!currentEntityIds.contains(it->first)) {
-      it                     = m_modelsMap.erase(it);
-      needRebuildRenderArray = true;
-    } else {
-      ++it;
+    if (auto worldMatrix = registry.try_get<WorldMatrix>(entity)) {
+      instance->modelMatrix = worldMatrix->matrix;
+      m_instanceDataStore.updateInstance(instance->model, instance->instanceSlot, instance->modelMatrix);
+      markModelInstanceDirty_(*instance);
     }
   }
 
-  std::vector<Material*> materialsToRemove;
-  for (const auto& [material, cache] : m_materialParamCache) {
-    if (!activeMaterials.contains(material)) {
-      materialsToRemove.push_back(material);
+  if (needRebuildRenderArray) {
+    rebuildSortedModels_();
+  }
+}
+
+void FrameResources::rebuildModelList_(Registry& registry) {
+  m_instanceDataStore.clear();
+  m_modelInstances.clear();
+  m_modelInstanceIndices.clear();
+  m_dirtyInstances.clear();
+
+  auto view = registry.view<WorldMatrix, RenderModel*>();
+  for (auto entity : view) {
+    syncModelInstance_(registry, entity);
+  }
+
+  rebuildSortedModels_();
+}
+
+bool FrameResources::syncModelInstance_(Registry& registry, entt::entity entity) {
+  const bool isRenderable = registry.valid(entity) && registry.all_of<WorldMatrix, RenderModel*>(entity);
+
+  RenderModel* renderModel = isRenderable ? registry.get<RenderModel*>(entity) : nullptr;
+  if (!renderModel) {
+    return removeModelInstance_(entity);
+  }
+
+  const auto& worldMatrix = registry.get<WorldMatrix>(entity);
+
+  auto instance = findModelInstance_(entity);
+  if (instance && instance->model == renderModel) {
+    instance->modelMatrix = worldMatrix.matrix;
+    m_instanceDataStore.updateInstance(instance->model, instance->instanceSlot, instance->modelMatrix);
+    markModelInstanceDirty_(*instance);
+    return false;
+  }
+
+  if (instance) {
+    // the model was replaced, slots are per model
+    m_instanceDataStore.removeInstance(instance->model, instance->instanceSlot);
+  }
+
+  if (!instance) {
+    const auto entityIndex = static_cast<size_t>(entt::to_entity(entity));
+    if (entityIndex >= m_modelInstanceIndices.size()) {
+      m_modelInstanceIndices.resize(entityIndex + 1, s_invalidInstanceIndex);
+    }
+
+    // a recycled entity index may still point to the instance of a destroyed entity
+    if (m_modelInstanceIndices[entityIndex] != s_invalidInstanceIndex) {
+      removeModelInstance_(m_modelInstances[m_modelInstanceIndices[entityIndex]].entityId);
     }
+
+    m_modelInstanceIndices[entityIndex] = static_cast<uint32_t>(m_modelInstances.size());
+    instance                            = &m_modelInstances.emplace_back();
+    instance->entityId                  = entity;
   }
 
-  for (auto material : materialsToRemove) {
-    GlobalLogger::Log(LogLevel::Debug,
-                      "Removing cached material parameters for deleted material at address: "
-                          + std::to_string(reinterpret_cast<uintptr_t>(material)));
-    m_materialParamCache.erase(material);
+  instance->model        = renderModel;
+  instance->modelMatrix  = worldMatrix.matrix;
+  instance->instanceSlot = m_instanceDataStore.addInstance(renderModel, worldMatrix.matrix);
+  instance->materialId   = 0;
+  if (!renderModel->renderMeshes.empty() && renderModel->renderMeshes[0]->material) {
+    instance->materialId = reinterpret_cast<uintptr_t>(renderModel->renderMeshes[0]->material);
   }
 
-  if (needRebuildRenderArray) {
-    m_sortedModels.clear();
-    m_sortedModels.reserve(m_modelsMap.size());
+  markModelInstanceDirty_(*instance);
+  return true;
+}
+
+bool FrameResources::removeModelInstance_(entt::entity entity) {
+  if (!findModelInstance_(entity)) {
+    return false;
+  }
+
+  const auto entityIndex = static_cast<size_t>(entt::to_entity(entity));
+  const auto index       = m_modelInstanceIndices[entityIndex];
 
-    for (auto& pair : m_modelsMap) {
-      m_sortedModels.push_back(&pair.second);
+  m_instanceDataStore.removeInstance(m_modelInstances[index].model, m_modelInstances[index].instanceSlot);
+
+  // swap with the last instance to keep the storage dense
+  if (index + 1 != m_modelInstances.size()) {
+    m_modelInstances[index] = m_modelInstances.back();
+    m_modelInstanceIndices[static_cast<size_t>(entt::to_entity(m_modelInstances[index].entityId))] = index;
+  }
+
+  m_modelInstances.pop_back();
+  m_modelInstanceIndices[entityIndex] = s_invalidInstanceIndex;
+  return true;
+}
+
+FrameResources::ModelInstance* FrameResources::findModelInstance_(entt::entity entity) {
+  const auto entityIndex = static_cast<size_t>(entt::to_entity(entity));
+  if (entityIndex >= m_modelInstanceIndices.size() || m_modelInstanceIndices[entityIndex] == s_invalidInstanceIndex) {
+    return nullptr;
+  }
+
+  auto& instance = m_modelInstances[m_modelInstanceIndices[entityIndex]];
+  return instance.entityId == entity ? &instance : nullptr;
+}
+
+void FrameResources::markModelInstanceDirty_(ModelInstance& instance) {
+  if (!instance.isDirty) {
+    instance.isDirty = true;
+    m_dirtyInstances.push_back(instance.entityId);
+  }
+}
+
+void FrameResources::rebuildSortedModels_() {
+  // the instance storage may have been reallocated or reordered, so the pointers are always collected again
+  m_sortedModels.clear();
+  m_sortedModels.reserve(m_modelInstances.size());
+
+  for (auto& instance : m_modelInstances) {
+    m_sortedModels.push_back(&instance);
+  }
+
+  sortModelsByMaterial_();
+
+  syncMaterials_();
+}
+
+void FrameResources::syncMaterials_() {
+  std::unordered_set<Material*> activeMaterials;
+  for (const auto* instance : m_sortedModels) {
+    for (const auto& renderMesh : instance->model->renderMeshes) {
+      if (renderMesh->material && activeMaterials.insert(renderMesh->material).second) {
+        m_materialTable.addMaterial(renderMesh->material);
+      }
     }
+  }
 
-    sortModelsByMaterial_();
+  m_materialTable.retainMaterials(activeMaterials);
+}
+
+void FrameResources::cullModels_(const RenderContext& context) {
+  m_gpuCulling = m_hasCamera && context.renderSettings.gpuDrivenRendering && m_device->supportsMultiDrawIndirect();
+
+  // in the GPU-driven mode the instances are culled by a compute shader, here they are only grouped by model
+  if (m_hasCamera && !m_gpuCulling) {
+    m_frustumCuller->cull(context, m_sortedModels, m_viewProjection);
+  } else {
+    m_frustumCuller->acceptAll(context, m_sortedModels);
   }
 }
 
@@ -491,20 +527,28 @@ void FrameResources::sortModelsByMaterial_() {
 }
 
 void FrameResources::clearInternalDirtyFlags_() {
-  for (auto& instance : m_sortedModels) {
-    instance->isDirty = false;
+  for (auto entity : m_dirtyInstances) {
+    if (auto instance = findModelInstance_(entity)) {
+      instance->isDirty = false;
+    }
   }
+  m_dirtyInstances.clear();
 }
 
 void FrameResources::clearEntityDirtyFlags_(const RenderContext& context) {
   if (context.scene) {
+    // every recalculated world matrix (and therefore every dirty transform) was reported as moved
     auto& registry = context.scene->getEntityRegistry();
-    auto  view     = registry.view<Transform>();
+    for (auto entity : m_movedEntities) {
+      if (!registry.valid(entity)) {
+        continue;
+      }
 
-    for (auto entity : view) {
-      auto& transform = view.get<Transform>(entity);
-      if (transform.isDirty) {
-        transform.isDirty = false;
+      if (auto transform = registry.try_get<Transform>(entity)) {
+        transform->isDirty = false;
+      }
+      if (auto worldMatrix = registry.try_get<WorldMatrix>(entity)) {
+        worldMatrix->isDirty = false;
       }
     }
   }
@@ -3,6 +3,9 @@
 
 #include "ecs/components/render_model.h"
 #include "ecs/components/transform.h"
+#include "gfx/renderer/frame_constant_allocator.h"
+#include "gfx/renderer/instance_data_store.h"
+#include "gfx/renderer/material_table.h"
 #include "gfx/renderer/render_context.h"
 #include "gfx/rhi/interface/buffer.h"
 #include "gfx/rhi/interface/descriptor.h"
@@ -11,6 +14,8 @@
 #include "gfx/rhi/interface/texture.h"
 #include "utils/math/math_util.h"
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -23,6 +28,7 @@ namespace arise {
 namespace gfx {
 namespace renderer {
 
+class FrustumCuller;
 class RenderResourceManager;
 
 /**
@@ -32,7 +38,7 @@ class FrameResources {
   public:
   FrameResources(rhi::Device* device, RenderResourceManager* resourceManager);
 
-  ~FrameResources() { cleanup(); }
+  ~FrameResources();
 
   void initialize(uint32_t framesCount);
 
@@ -48,7 +54,6 @@ class FrameResources {
 
   struct RenderTargets {
     std::unique_ptr<rhi::Texture> colorBuffer;
-    std::unique_ptr<rhi::Texture> depthBuffer;
     rhi::Texture*                 backBuffer = nullptr;
   };
 
@@ -61,21 +66,44 @@ class FrameResources {
   const rhi::Viewport&    getViewport() const { return m_viewport; }
   const rhi::ScissorRect& getScissor() const { return m_scissor; }
 
+  bool                    hasCamera() const { return m_hasCamera; }
+  const math::Vector3f&   getCameraPosition() const { return m_cameraPosition; }
+  const math::Matrix4f<>& getViewProjection() const { return m_viewProjection; }
+  const math::Matrix4f<>& getView() const { return m_view; }
+  const math::Matrix4f<>& getProjection() const { return m_projection; }
+
+  /**
+   * True when the instances of this frame are culled on the GPU (RenderSettings::gpuDrivenRendering, a camera and
+   * device support) - the frustum culler then returns every instance as visible.
+   */
+  bool isGpuCulling() const { return m_gpuCulling; }
+
+  /**
+   * The view set has a dynamic uniform buffer, bind it with getViewConstantsOffset() as the dynamic offset.
+   */
   rhi::DescriptorSet* getViewDescriptorSet() const { return m_viewDescriptorSet; }
+  uint32_t            getViewConstantsOffset() const { return m_viewConstantsOffset; }
   rhi::DescriptorSet* getDefaultSamplerDescriptorSet() const { return m_defaultSamplerDescriptorSet; }
   rhi::DescriptorSet* getLightDescriptorSet() const;
+
+  // lights of the scene, the light clusters are built from them
+  const LightSystem* getLightSystem() const { return m_lightSystem; }
+
+  // Per-mesh set, binding 0 is the mesh transform
   rhi::DescriptorSet* getOrCreateModelMatrixDescriptorSet(RenderMesh* renderMesh);
 
   rhi::Sampler* getDefaultSampler() const { return m_defaultSampler; }
 
   struct ModelInstance {
     RenderModel*     model;
-    Transform        transform;
     math::Matrix4f<> modelMatrix;
     entt::entity     entityId;
 
     uint32_t materialId = 0;  // for sorting
 
+    // stable slot of the instance in InstanceDataStore (per model)
+    uint32_t instanceSlot = InstanceDataStore::s_invalidSlot;
+
     bool isDirty = false;
   };
 
@@ -85,21 +113,50 @@ class FrameResources {
    */
   const std::vector<ModelInstance*>& getModels() const { return m_sortedModels; }
 
+  /**
+   * Result of frustum culling of getModels() against the main camera, updated in updatePerFrameResources().
+   */
+  const FrustumCuller* getFrustumCuller() const { return m_frustumCuller.get(); }
+
+  /**
+   * GPU instance matrices of getModels() in stable per-model slots, uploaded in updatePerFrameResources().
+   */
+  const InstanceDataStore& getInstanceDataStore() const { return m_instanceDataStore; }
+
   rhi::DescriptorSetLayout* getViewDescriptorSetLayout() const { return m_viewDescriptorSetLayout; }
   rhi::DescriptorSetLayout* getModelMatrixDescriptorSetLayout() const { return m_modelMatrixDescriptorSetLayout; }
   rhi::DescriptorSetLayout* getLightDescriptorSetLayout() const;
-  rhi::DescriptorSetLayout* getMaterialDescriptorSetLayout() const { return m_materialDescriptorSetLayout; }
 
-  rhi::Buffer* getOrCreateMaterialParamBuffer(Material* material);
+  /**
+   * Materials of getModels() (parameters and textures), uploaded in updatePerFrameResources(). Its set is the same for
+   * every draw of the frame.
+   */
+  const MaterialTable& getMaterialTable() const { return m_materialTable; }
+
+  /**
+   * Transient shader constants of the current frame, valid until the frame's slot comes around again.
+   */
+  FrameConstantAllocator& getConstantAllocator() { return m_constantAllocator; }
 
   rhi::Texture* getDefaultWhiteTexture() const { return m_defaultWhiteTexture; }
   rhi::Texture* getDefaultNormalTexture() const { return m_defaultNormalTexture; }
   rhi::Texture* getDefaultBlackTexture() const { return m_defaultBlackTexture; }
 
   private:
+  struct ViewData {
+    math::Matrix4f<> view;
+    math::Matrix4f<> projection;
+    math::Matrix4f<> viewProjection;
+    math::Matrix4f<> invView;
+    math::Matrix4f<> invProjection;
+    math::Matrix4f<> invViewProjection;
+    math::Vector3f   eyePosition;
+    float            padding;
+  };
+
   void createViewDescriptorSetLayout_();
+  void createViewDescriptorSet_();
   void createModelMatrixDescriptorSetLayout_();
-  void createMaterialDescriptorSetLayout_();
   void createDefaultTextures_();
   void createDefaultSampler_();
   void createSamplerDescriptorSet_();
@@ -107,7 +164,23 @@ class FrameResources {
 
   void updateViewResources_(const RenderContext& context);
   void updateModelList_(const RenderContext& context);
+  void cullModels_(const RenderContext& context);
+
+  // Full synchronization with the registry, used when the rendered scene changes
+  void rebuildModelList_(Registry& registry);
+
+  // Adds, updates or removes the instance of the entity according to its current components. Returns true if the set
+  // of instances (or their models) changed.
+  bool syncModelInstance_(Registry& registry, entt::entity entity);
+  bool removeModelInstance_(entt::entity entity);
+
+  ModelInstance* findModelInstance_(entt::entity entity);
+  void           markModelInstanceDirty_(ModelInstance& instance);
+
+  void rebuildSortedModels_();
 
+  // Adds the materials of the current models to the material table and removes the unused ones
+  void syncMaterials_();
   void sortModelsByMaterial_();
 
   void clearInternalDirtyFlags_();
@@ -129,9 +202,19 @@ class FrameResources {
 
   rhi::DescriptorSetLayout* m_viewDescriptorSetLayout        = nullptr;
   rhi::DescriptorSetLayout* m_modelMatrixDescriptorSetLayout = nullptr;
-  rhi::DescriptorSetLayout* m_materialDescriptorSetLayout    = nullptr;
 
-  rhi::Buffer* m_viewUniformBuffer = nullptr;
+  FrameConstantAllocator m_constantAllocator;
+
+  // dynamic offset of the view constants in the current frame
+  uint32_t m_viewConstantsOffset = 0;
+
+  // main camera of the current frame, used for culling and draw sorting
+  math::Matrix4f<> m_view;
+  math::Matrix4f<> m_projection;
+  math::Matrix4f<> m_viewProjection;
+  math::Vector3f   m_cameraPosition;
+  bool             m_hasCamera  = false;
+  bool             m_gpuCulling = false;
 
   rhi::Texture* m_defaultWhiteTexture  = nullptr;
   rhi::Texture* m_defaultNormalTexture = nullptr;
@@ -145,22 +228,28 @@ class FrameResources {
 
   std::unordered_map<RenderMesh*, ModelMatrixCache> m_modelMatrixCache;
 
-  struct MaterialParametersData {
-    math::Vector4f baseColor;
-    float           metallic;
-    float           roughness;
-    float           opacity;
-    float           padding;
-  };
+  MaterialTable m_materialTable;
 
-  struct MaterialParamCache {
-    rhi::Buffer* paramBuffer = nullptr;
-  };
+  static constexpr uint32_t s_invalidInstanceIndex = std::numeric_limits<uint32_t>::max();
+
+  // dense instance storage, m_modelInstanceIndices maps an entity index (entt::to_entity) to its position
+  std::vector<ModelInstance>  m_modelInstances;
+  std::vector<uint32_t>       m_modelInstanceIndices;
+  std::vector<ModelInstance*> m_sortedModels;
+
+  // scene the instances were built from, a different scene triggers a full rebuild
+  Scene* m_trackedScene = nullptr;
+
+  // changes consumed from the scene's SceneChangeTracker this frame
+  std::vector<entt::entity> m_changedEntities;
+  std::vector<entt::entity> m_movedEntities;
+
+  // instances marked dirty this frame, their flags are reset at the beginning of the next frame
+  std::vector<entt::entity> m_dirtyInstances;
 
-  std::unordered_map<Material*, MaterialParamCache> m_materialParamCache;
+  std::unique_ptr<FrustumCuller> m_frustumCuller;
 
-  std::unordered_map<entt::entity, ModelInstance> m_modelsMap;
-  std::vector<ModelInstance*>                     m_sortedModels;
+  InstanceDataStore m_instanceDataStore;
 
   LightSystem* m_lightSystem = nullptr;
 };
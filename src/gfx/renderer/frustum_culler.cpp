@@ -0,0 +1,283 @@
+#include "gfx/renderer/frustum_culler.h"
+
+#include "ecs/components/render_model.h"
+#include "profiler/profiler.h"
+#include "utils/job/job_system.h"
+
+#include <algorithm>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+namespace {
+
+// instances tested by one job, small enough to keep the per-batch data on the stack
+constexpr uint32_t INSTANCE_CHUNK_SIZE = 256;
+constexpr uint32_t MODEL_CHUNK_SIZE    = 16;
+
+// visible slots closer than this are drawn by one instanced draw, the instances in between are rasterized anyway
+constexpr uint32_t INSTANCE_RANGE_MERGE_GAP = 8;
+
+constexpr uint32_t NO_LOD_GROUP = ~0u;
+
+}  // namespace
+
+void FrustumCuller::cull(const RenderContext&                                  context,
+                         const std::vector<FrameResources::ModelInstance*>& instances,
+                         const math::Matrix4f<>&                               viewProjection) {
+  CPU_ZONE_NC("FrustumCuller::cull", color::YELLOW);
+
+  m_frustum = bounds::extractFrustum(viewProjection);
+
+  testInstances_(context, instances);
+  groupByModel_(context, instances);
+  testMeshes_();
+}
+
+void FrustumCuller::acceptAll(const RenderContext&                                  context,
+                              const std::vector<FrameResources::ModelInstance*>& instances) {
+  m_instanceVisibility.assign(instances.size(), 1);
+
+  groupByModel_(context, instances);
+
+  for (auto& visibleModel : m_visibleModels) {
+    visibleModel.meshVisibility.assign(visibleModel.model->renderMeshes.size(), 1);
+  }
+}
+
+void FrustumCuller::clear() {
+  m_instanceVisibility.clear();
+  m_visibleModels.clear();
+  m_modelIndices.clear();
+  m_previousEntities.clear();
+  m_sortedSlots.clear();
+  m_slotGroups.clear();
+  m_totalInstanceCount   = 0;
+  m_visibleInstanceCount = 0;
+}
+
+void FrustumCuller::testInstances_(const RenderContext&                                  context,
+                                   const std::vector<FrameResources::ModelInstance*>& instances) {
+  // instances without (valid) world bounds are never culled
+  m_instanceVisibility.assign(instances.size(), 1);
+
+  auto& registry   = context.scene->getEntityRegistry();
+  auto  boundsView = registry.view<WorldBounds>();
+
+  auto testRange = [this, &instances, &boundsView](uint32_t begin, uint32_t end) {
+    BoundingBox boxes[INSTANCE_CHUNK_SIZE];
+    uint32_t    instanceIndices[INSTANCE_CHUNK_SIZE];
+    uint8_t     results[INSTANCE_CHUNK_SIZE];
+
+    // the range may be larger than one chunk when the job system runs it inline
+    for (uint32_t batchBegin = begin; batchBegin < end; batchBegin += INSTANCE_CHUNK_SIZE) {
+      uint32_t batchEnd  = std::min(batchBegin + INSTANCE_CHUNK_SIZE, end);
+      uint32_t batchSize = 0;
+
+      for (uint32_t i = batchBegin; i < batchEnd; ++i) {
+        auto entity = instances[i]->entityId;
+        if (!boundsView.contains(entity)) {
+          continue;
+        }
+
+        const auto& worldBounds = boundsView.get<WorldBounds>(entity);
+        if (!bounds::isValid(worldBounds.boundingBox)) {
+          continue;
+        }
+
+        boxes[batchSize]           = worldBounds.boundingBox;
+        instanceIndices[batchSize] = i;
+        ++batchSize;
+      }
+
+      bounds::testFrustum(m_frustum, boxes, results, batchSize);
+
+      for (uint32_t i = 0; i < batchSize; ++i) {
+        m_instanceVisibility[instanceIndices[i]] = results[i];
+      }
+    }
+  };
+
+  g_parallelFor(static_cast<uint32_t>(instances.size()), INSTANCE_CHUNK_SIZE, testRange);
+}
+
+void FrustumCuller::groupByModel_(const RenderContext&                                  context,
+                                  const std::vector<FrameResources::ModelInstance*>& instances) {
+  m_visibleModels.clear();
+  m_modelIndices.clear();
+
+  m_totalInstanceCount   = static_cast<uint32_t>(instances.size());
+  m_visibleInstanceCount = 0;
+
+  for (size_t i = 0; i < instances.size(); ++i) {
+    const auto* instance = instances[i];
+
+    auto [it, inserted] = m_modelIndices.try_emplace(instance->model, m_visibleModels.size());
+    if (inserted) {
+      m_visibleModels.emplace_back().model = instance->model;
+    }
+
+    if (!m_instanceVisibility[i]) {
+      continue;
+    }
+
+    auto& visibleModel = m_visibleModels[it->second];
+    visibleModel.instanceMatrices.push_back(instance->modelMatrix);
+    visibleModel.entities.push_back(instance->entityId);
+    visibleModel.instanceSlots.push_back(instance->instanceSlot);
+    visibleModel.isDirty = visibleModel.isDirty || instance->isDirty;
+    ++m_visibleInstanceCount;
+  }
+
+  // instances entering or leaving the frustum change the compacted list even if nothing moved
+  std::unordered_map<RenderModel*, std::vector<entt::entity>> currentEntities;
+  currentEntities.reserve(m_visibleModels.size());
+
+  auto& registry = context.scene->getEntityRegistry();
+  for (auto& visibleModel : m_visibleModels) {
+    groupByLod_(visibleModel, registry);
+
+    auto previousIt = m_previousEntities.find(visibleModel.model);
+    if (previousIt == m_previousEntities.end() || previousIt->second != visibleModel.entities) {
+      visibleModel.isDirty = true;
+    }
+    currentEntities.emplace(visibleModel.model, visibleModel.entities);
+  }
+
+  m_previousEntities = std::move(currentEntities);
+}
+
+void FrustumCuller::testMeshes_() {
+  auto testRange = [this](uint32_t begin, uint32_t end) {
+    for (uint32_t modelIndex = begin; modelIndex < end; ++modelIndex) {
+      auto&       visibleModel = m_visibleModels[modelIndex];
+      const auto& renderMeshes = visibleModel.model->renderMeshes;
+
+      if (visibleModel.instanceMatrices.empty()) {
+        visibleModel.meshVisibility.assign(renderMeshes.size(), 0);
+        continue;
+      }
+
+      // the instance test already covers a single mesh
+      visibleModel.meshVisibility.assign(renderMeshes.size(), 1);
+      if (renderMeshes.size() == 1) {
+        continue;
+      }
+
+      for (size_t meshIndex = 0; meshIndex < renderMeshes.size(); ++meshIndex) {
+        const BoundingBox& meshBounds = renderMeshes[meshIndex]->boundingBox;
+        if (!bounds::isValid(meshBounds)) {
+          continue;
+        }
+
+        bool isVisible = false;
+        for (const auto& instanceMatrix : visibleModel.instanceMatrices) {
+          if (bounds::intersects(m_frustum, bounds::transformAABB(meshBounds, instanceMatrix))) {
+            isVisible = true;
+            break;
+          }
+        }
+
+        visibleModel.meshVisibility[meshIndex] = isVisible ? 1 : 0;
+      }
+    }
+  };
+
+  g_parallelFor(static_cast<uint32_t>(m_visibleModels.size()), MODEL_CHUNK_SIZE, testRange);
+}
+
+void FrustumCuller::groupByLod_(VisibleModel& visibleModel, Registry& registry) {
+  // entities without Lod (e.g. before LodSystem ran) draw the full mesh
+  auto findGroup = [&visibleModel](uint32_t level, uint32_t ditherBegin, uint32_t ditherEnd) -> LodGroup& {
+    for (auto& lodGroup : visibleModel.lodGroups) {
+      if (lodGroup.level == level && lodGroup.ditherBegin == ditherBegin && lodGroup.ditherEnd == ditherEnd) {
+        return lodGroup;
+      }
+    }
+    auto& lodGroup       = visibleModel.lodGroups.emplace_back();
+    lodGroup.level       = level;
+    lodGroup.ditherBegin = static_cast<uint8_t>(ditherBegin);
+    lodGroup.ditherEnd   = static_cast<uint8_t>(ditherEnd);
+    return lodGroup;
+  };
+
+  const auto instanceCount = static_cast<uint32_t>(visibleModel.entities.size());
+  visibleModel.lodLevels.resize(instanceCount);
+
+  for (uint32_t i = 0; i < instanceCount; ++i) {
+    const Lod* lod   = registry.try_get<Lod>(visibleModel.entities[i]);
+    const auto level = lod ? static_cast<uint32_t>(lod->level) : 0u;
+
+    visibleModel.lodLevels[i] = level;
+
+    // the incoming level takes the first fadeStep dither values, the outgoing one the rest
+    const uint32_t fadeStep = lod ? lod->getFadeStep() : LOD_FADE_STEPS;
+    if (fadeStep > 0) {
+      findGroup(level, 0, fadeStep).instances.push_back(i);
+    }
+    if (fadeStep < LOD_FADE_STEPS) {
+      findGroup(lod->previousLevel, fadeStep, LOD_FADE_STEPS).instances.push_back(i);
+    }
+  }
+
+  // instances of other groups in the gap of a merged range would be drawn twice, only unused slots may be merged
+  m_slotGroups.clear();
+  for (uint32_t groupIndex = 0; groupIndex < visibleModel.lodGroups.size(); ++groupIndex) {
+    for (uint32_t instance : visibleModel.lodGroups[groupIndex].instances) {
+      const uint32_t slot = visibleModel.instanceSlots[instance];
+      if (slot >= m_slotGroups.size()) {
+        m_slotGroups.resize(slot + 1, NO_LOD_GROUP);
+      }
+      m_slotGroups[slot] = groupIndex;
+    }
+  }
+
+  for (auto& lodGroup : visibleModel.lodGroups) {
+    buildInstanceRanges_(visibleModel, lodGroup);
+  }
+}
+
+void FrustumCuller::buildInstanceRanges_(const VisibleModel& visibleModel, LodGroup& lodGroup) {
+  if (lodGroup.instances.empty()) {
+    return;
+  }
+
+  m_sortedSlots.clear();
+  for (uint32_t instance : lodGroup.instances) {
+    m_sortedSlots.push_back(visibleModel.instanceSlots[instance]);
+  }
+  std::sort(m_sortedSlots.begin(), m_sortedSlots.end());
+
+  // a single group can merge freely, every visible instance is drawn with its level
+  const bool isOnlyGroup = visibleModel.lodGroups.size() == 1;
+
+  auto isGapUnused = [this](uint32_t begin, uint32_t end) {
+    for (uint32_t slot = begin; slot < end && slot < m_slotGroups.size(); ++slot) {
+      if (m_slotGroups[slot] != NO_LOD_GROUP) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  InstanceRange range{m_sortedSlots[0], 1};
+  for (size_t i = 1; i < m_sortedSlots.size(); ++i) {
+    uint32_t slot     = m_sortedSlots[i];
+    uint32_t rangeEnd = range.firstInstance + range.instanceCount;
+
+    // drawing a few culled instances (or empty slots) is cheaper than an extra draw call
+    if (slot <= rangeEnd + INSTANCE_RANGE_MERGE_GAP && (isOnlyGroup || isGapUnused(rangeEnd, slot))) {
+      range.instanceCount = slot + 1 - range.firstInstance;
+      continue;
+    }
+
+    lodGroup.instanceRanges.push_back(range);
+    range = {slot, 1};
+  }
+  lodGroup.instanceRanges.push_back(range);
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
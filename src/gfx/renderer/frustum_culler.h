@@ -0,0 +1,122 @@
+#ifndef ARISE_FRUSTUM_CULLER_H
+#define ARISE_FRUSTUM_CULLER_H
+
+#include "ecs/components/bounding_volume.h"
+#include "ecs/components/lod.h"
+#include "gfx/renderer/frame_resources.h"
+
+#include <math_library/matrix.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace arise {
+struct RenderModel;
+}  // namespace arise
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+/**
+ * Culls model instances against the camera frustum.
+ *
+ * Instances are tested with their WorldBounds, then every mesh of a model with visible instances is tested with its
+ * own bounds, so large multi-mesh models only draw the meshes that can be seen. Both tests are split into chunks
+ * processed by the JobSystem. The result is a compacted list of visible instance matrices per model.
+ *
+ * The visible models are the per-frame instance list shared by the base pass and all debug strategies: they draw the
+ * instance ranges from the InstanceDataStore buffers instead of building their own instance data.
+ *
+ * The visible instances of a model are split into LOD groups by the level selected by LodSystem. An instance that
+ * cross-fades between two levels is in two groups, which draw complementary parts of the dither pattern.
+ */
+class FrustumCuller {
+  public:
+  struct LodGroup {
+    uint32_t level = 0;
+
+    // dither values [ditherBegin, ditherEnd) the group draws, the full range unless its instances cross-fade
+    uint8_t ditherBegin = 0;
+    uint8_t ditherEnd   = LOD_FADE_STEPS;
+
+    std::vector<uint32_t>      instances;       // indices into VisibleModel::instanceMatrices
+    std::vector<InstanceRange> instanceRanges;  // slots of the instances merged into ranges of the instance buffer
+
+    // the level the instances fade out of, views without dithering (debug strategies) skip it
+    bool isFadingOut() const { return ditherBegin > 0; }
+  };
+
+  struct VisibleModel {
+    RenderModel*                  model = nullptr;
+    std::vector<math::Matrix4f<>> instanceMatrices;  // visible instances only
+    std::vector<entt::entity>     entities;          // same order as instanceMatrices
+    std::vector<uint32_t>         instanceSlots;     // InstanceDataStore slots, same order as instanceMatrices
+    std::vector<uint32_t>         lodLevels;         // level the instances fade to, same order as instanceMatrices
+    std::vector<LodGroup>         lodGroups;         // every visible instance is in at least one group
+    std::vector<uint8_t>          meshVisibility;    // per RenderModel::renderMeshes, 1 if visible in any instance
+
+    // the visible instances (or their matrices) changed since the previous frame
+    bool isDirty = false;
+  };
+
+  /**
+   * @param instances models collected by FrameResources for this frame
+   * @param viewProjection camera view * projection matrix
+   */
+  void cull(const RenderContext&                                  context,
+            const std::vector<FrameResources::ModelInstance*>& instances,
+            const math::Matrix4f<>&                               viewProjection);
+
+  // Produces the same output as cull(), but with every instance and mesh visible (e.g. no camera in the scene)
+  void acceptAll(const RenderContext& context, const std::vector<FrameResources::ModelInstance*>& instances);
+
+  void clear();
+
+  /**
+   * One entry per model that has instances in the scene, including models whose instances are all culled this frame
+   * (with an empty instance list), so passes can keep their per-model resources alive.
+   */
+  const std::vector<VisibleModel>& getVisibleModels() const { return m_visibleModels; }
+
+  uint32_t getTotalInstanceCount() const { return m_totalInstanceCount; }
+
+  uint32_t getVisibleInstanceCount() const { return m_visibleInstanceCount; }
+
+  private:
+  void testInstances_(const RenderContext& context, const std::vector<FrameResources::ModelInstance*>& instances);
+  void groupByModel_(const RenderContext& context, const std::vector<FrameResources::ModelInstance*>& instances);
+  void testMeshes_();
+
+  // Splits the visible instances of the model by the level they are drawn with
+  void groupByLod_(VisibleModel& visibleModel, Registry& registry);
+
+  // Sorts the visible slots of the group and merges them into draw ranges
+  void buildInstanceRanges_(const VisibleModel& visibleModel, LodGroup& lodGroup);
+
+  Frustum m_frustum;
+
+  // per input instance, 1 if it passed the instance test
+  std::vector<uint8_t> m_instanceVisibility;
+
+  std::vector<VisibleModel>                m_visibleModels;
+  std::unordered_map<RenderModel*, size_t> m_modelIndices;
+
+  std::vector<uint32_t> m_sortedSlots;
+
+  // per slot of the model being grouped, the LOD group drawing it, to keep other groups out of merged ranges
+  std::vector<uint32_t> m_slotGroups;
+
+  // visible entities of the previous frame, to detect changes of the visible set
+  std::unordered_map<RenderModel*, std::vector<entt::entity>> m_previousEntities;
+
+  uint32_t m_totalInstanceCount   = 0;
+  uint32_t m_visibleInstanceCount = 0;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_FRUSTUM_CULLER_H
@@ -0,0 +1,347 @@
+#include "gfx/renderer/gpu_culler.h"
+
+#include "gfx/renderer/frame_constant_allocator.h"
+#include "gfx/renderer/render_resource_manager.h"
+#include "gfx/rhi/interface/buffer.h"
+#include "gfx/rhi/interface/command_buffer.h"
+#include "gfx/rhi/interface/descriptor.h"
+#include "gfx/rhi/interface/device.h"
+#include "gfx/rhi/interface/pipeline.h"
+#include "gfx/rhi/shader_manager.h"
+#include "profiler/profiler.h"
+#include "utils/logger/global_logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+namespace {
+
+// limit of one dispatch dimension, more groups are dispatched as rows
+constexpr uint32_t MAX_DISPATCH_GROUPS_PER_ROW = 65535;
+
+constexpr uint32_t MIN_CAPACITY = 64;
+
+// bindings of the culling set, the register numbers in cull.cs.hlsl
+constexpr uint32_t CONSTANTS_BINDING          = 0;
+constexpr uint32_t DRAW_GROUPS_BINDING        = 1;
+constexpr uint32_t INSTANCES_BINDING          = 2;
+constexpr uint32_t VISIBLE_INSTANCES_BINDING  = 3;
+constexpr uint32_t DRAW_COMMANDS_BINDING      = 4;
+constexpr uint32_t DRAW_COUNTS_BINDING        = 5;
+constexpr uint32_t VISIBLE_DRAW_INFOS_BINDING = 6;
+
+}  // namespace
+
+void GpuCuller::initialize(rhi::Device*            device,
+                           RenderResourceManager*  resourceManager,
+                           rhi::ShaderManager*     shaderManager,
+                           FrameConstantAllocator* constantAllocator,
+                           uint32_t                framesCount) {
+  m_device            = device;
+  m_resourceManager   = resourceManager;
+  m_shaderManager     = shaderManager;
+  m_constantAllocator = constantAllocator;
+
+  m_frames.clear();
+  m_frames.resize(std::max(framesCount, 1u));
+  m_frameIndex = 0;
+
+  createDescriptorSetLayout_();
+  createPipeline_();
+  createZeroCounters_();
+}
+
+void GpuCuller::beginFrame(uint32_t frameIndex) {
+  m_frameIndex = frameIndex % m_frames.size();
+
+  m_drawGroups.clear();
+  m_instances.clear();
+  m_visibleInstanceCount = 0;
+}
+
+uint32_t GpuCuller::addInstances(const std::vector<math::Matrix4f<>>& matrices) {
+  const auto firstInstance = static_cast<uint32_t>(m_instances.size());
+  m_instances.insert(m_instances.end(), matrices.begin(), matrices.end());
+  return firstInstance;
+}
+
+uint32_t GpuCuller::addInstances(const std::vector<math::Matrix4f<>>& matrices,
+                                 const std::vector<uint32_t>&         indices) {
+  const auto firstInstance = static_cast<uint32_t>(m_instances.size());
+  for (uint32_t index : indices) {
+    m_instances.push_back(matrices[index]);
+  }
+  return firstInstance;
+}
+
+uint32_t GpuCuller::addDrawGroup(const BoundingBox&        bounds,
+                                 const RenderGeometryMesh& mesh,
+                                 uint32_t                  lodLevel,
+                                 uint32_t                  firstInstance,
+                                 uint32_t                  instanceCount,
+                                 const math::Matrix4f<>&   meshMatrix,
+                                 uint32_t                  drawInfo) {
+  DrawGroupData group;
+  group.boundsMin[0]       = bounds.min.x();
+  group.boundsMin[1]       = bounds.min.y();
+  group.boundsMin[2]       = bounds.min.z();
+  group.boundsValid        = bounds::isValid(bounds) ? 1 : 0;
+  group.boundsMax[0]       = bounds.max.x();
+  group.boundsMax[1]       = bounds.max.y();
+  group.boundsMax[2]       = bounds.max.z();
+  group.indexCount         = mesh.getIndexCount(lodLevel);
+  group.firstIndex         = mesh.getFirstIndex(lodLevel);
+  group.vertexOffset       = static_cast<int32_t>(mesh.vertexOffset);
+  group.firstInstance      = firstInstance;
+  group.instanceCount      = instanceCount;
+  group.firstVisibleOffset = m_visibleInstanceCount;
+  group.drawInfo           = drawInfo;
+  std::memcpy(group.meshMatrix, meshMatrix.data(), sizeof(group.meshMatrix));
+
+  // every instance of the group may be visible, so the compacted range is as big as the input range
+  m_visibleInstanceCount += instanceCount;
+
+  m_drawGroups.push_back(group);
+  return static_cast<uint32_t>(m_drawGroups.size() - 1);
+}
+
+void GpuCuller::upload() {
+  CPU_ZONE_NC("GpuCuller::upload", color::YELLOW);
+
+  if (m_drawGroups.empty()) {
+    return;
+  }
+
+  auto& frame = m_frames[m_frameIndex];
+
+  const auto groupCount    = static_cast<uint32_t>(m_drawGroups.size());
+  const auto instanceCount = static_cast<uint32_t>(m_instances.size());
+
+  using rhi::BufferCreateFlag;
+
+  bool buffersReplaced = !frame.descriptorSet;
+
+  buffersReplaced |= ensureCapacity_(frame.drawGroups,
+                                     groupCount,
+                                     sizeof(DrawGroupData),
+                                     BufferCreateFlag::ShaderResource,
+                                     rhi::BufferType::Dynamic,
+                                     "gpu_culling_draw_groups");
+  buffersReplaced |= ensureCapacity_(frame.instances,
+                                     instanceCount,
+                                     sizeof(math::Matrix4f<>),
+                                     BufferCreateFlag::ShaderResource,
+                                     rhi::BufferType::Dynamic,
+                                     "gpu_culling_instances");
+  buffersReplaced |= ensureCapacity_(frame.visibleInstances,
+                                     m_visibleInstanceCount,
+                                     sizeof(math::Matrix4f<>),
+                                     BufferCreateFlag::Uav | BufferCreateFlag::InstanceBuffer,
+                                     rhi::BufferType::Static,
+                                     "gpu_culling_visible_instances");
+  buffersReplaced |= ensureCapacity_(frame.visibleDrawInfos,
+                                     m_visibleInstanceCount,
+                                     sizeof(uint32_t),
+                                     BufferCreateFlag::Uav | BufferCreateFlag::InstanceBuffer,
+                                     rhi::BufferType::Static,
+                                     "gpu_culling_visible_draw_infos");
+  buffersReplaced |= ensureCapacity_(frame.drawCommands,
+                                     groupCount,
+                                     s_drawCommandStride,
+                                     BufferCreateFlag::Uav | BufferCreateFlag::IndirectCommand,
+                                     rhi::BufferType::Static,
+                                     "gpu_culling_draw_commands");
+  buffersReplaced |= ensureCapacity_(frame.drawCounts,
+                                     s_drawCounterCount,
+                                     sizeof(uint32_t),
+                                     BufferCreateFlag::Uav | BufferCreateFlag::IndirectCommand,
+                                     rhi::BufferType::Static,
+                                     "gpu_culling_draw_counts");
+
+  m_device->updateBuffer(frame.drawGroups.buffer, m_drawGroups.data(), groupCount * sizeof(DrawGroupData));
+  if (instanceCount > 0) {
+    m_device->updateBuffer(frame.instances.buffer, m_instances.data(), instanceCount * sizeof(math::Matrix4f<>));
+  }
+
+  if (buffersReplaced) {
+    updateDescriptorSet_(frame);
+  }
+}
+
+void GpuCuller::cull(rhi::CommandBuffer* commandBuffer, const Frustum& frustum) {
+  if (!commandBuffer || !m_pipeline || m_drawGroups.empty()) {
+    return;
+  }
+
+  auto& frame = m_frames[m_frameIndex];
+  if (!frame.descriptorSet) {
+    return;
+  }
+
+  GPU_ZONE_NC(commandBuffer, "GPU Culling", color::YELLOW);
+
+  const auto groupCount   = static_cast<uint32_t>(m_drawGroups.size());
+  const auto groupsPerRow = std::min(groupCount, MAX_DISPATCH_GROUPS_PER_ROW);
+  const auto rowCount     = (groupCount + groupsPerRow - 1) / groupsPerRow;
+
+  CullConstants constants = {};
+  for (std::size_t i = 0; i < Frustum::s_planeCount; ++i) {
+    constants.planes[i][0] = frustum.normalX[i];
+    constants.planes[i][1] = frustum.normalY[i];
+    constants.planes[i][2] = frustum.normalZ[i];
+    constants.planes[i][3] = frustum.distance[i];
+  }
+  constants.drawGroupCount = groupCount;
+  constants.groupsPerRow   = groupsPerRow;
+
+  auto allocation = m_constantAllocator->push(constants);
+  if (!allocation.isValid()) {
+    GlobalLogger::Log(LogLevel::Error, "Frame constants exhausted, GPU culling skipped");
+    return;
+  }
+
+  // the previous use of the buffers (by the draws of this frame slot) must finish before the shader overwrites them
+  commandBuffer->bufferBarrier(
+      {frame.visibleInstances.buffer, rhi::BufferState::VertexBuffer, rhi::BufferState::UnorderedAccess});
+  commandBuffer->bufferBarrier(
+      {frame.visibleDrawInfos.buffer, rhi::BufferState::VertexBuffer, rhi::BufferState::UnorderedAccess});
+  commandBuffer->bufferBarrier(
+      {frame.drawCommands.buffer, rhi::BufferState::IndirectArgument, rhi::BufferState::UnorderedAccess});
+
+  // the shader allocates the command indices by incrementing the counters
+  commandBuffer->bufferBarrier(
+      {frame.drawCounts.buffer, rhi::BufferState::IndirectArgument, rhi::BufferState::CopyDestination});
+  commandBuffer->copyBuffer(m_zeroCounters, frame.drawCounts.buffer, 0, 0, s_drawCounterCount * sizeof(uint32_t));
+  commandBuffer->bufferBarrier(
+      {frame.drawCounts.buffer, rhi::BufferState::CopyDestination, rhi::BufferState::UnorderedAccess});
+
+  commandBuffer->setPipeline(m_pipeline);
+  commandBuffer->bindDescriptorSet(0, frame.descriptorSet, {&allocation.offset, 1});
+  commandBuffer->dispatch(groupsPerRow, rowCount);
+
+  commandBuffer->bufferBarrier(
+      {frame.visibleInstances.buffer, rhi::BufferState::UnorderedAccess, rhi::BufferState::VertexBuffer});
+  commandBuffer->bufferBarrier(
+      {frame.visibleDrawInfos.buffer, rhi::BufferState::UnorderedAccess, rhi::BufferState::VertexBuffer});
+  commandBuffer->bufferBarrier(
+      {frame.drawCommands.buffer, rhi::BufferState::UnorderedAccess, rhi::BufferState::IndirectArgument});
+  commandBuffer->bufferBarrier(
+      {frame.drawCounts.buffer, rhi::BufferState::UnorderedAccess, rhi::BufferState::IndirectArgument});
+}
+
+void GpuCuller::clear() {
+  m_drawGroups.clear();
+  m_instances.clear();
+  m_visibleInstanceCount = 0;
+}
+
+void GpuCuller::createDescriptorSetLayout_() {
+  rhi::DescriptorSetLayoutDesc layoutDesc;
+
+  auto addBinding = [&layoutDesc](uint32_t binding, rhi::ShaderBindingType type) {
+    rhi::DescriptorSetLayoutBindingDesc bindingDesc;
+    bindingDesc.binding    = binding;
+    bindingDesc.type       = type;
+    bindingDesc.stageFlags = rhi::ShaderStageFlag::Compute;
+    layoutDesc.bindings.push_back(bindingDesc);
+  };
+
+  addBinding(CONSTANTS_BINDING, rhi::ShaderBindingType::UniformbufferDynamic);
+  addBinding(DRAW_GROUPS_BINDING, rhi::ShaderBindingType::BufferSrv);
+  addBinding(INSTANCES_BINDING, rhi::ShaderBindingType::BufferSrv);
+  addBinding(VISIBLE_INSTANCES_BINDING, rhi::ShaderBindingType::BufferUav);
+  addBinding(DRAW_COMMANDS_BINDING, rhi::ShaderBindingType::BufferUav);
+  addBinding(DRAW_COUNTS_BINDING, rhi::ShaderBindingType::BufferUav);
+  addBinding(VISIBLE_DRAW_INFOS_BINDING, rhi::ShaderBindingType::BufferUav);
+
+  auto layout           = m_device->createDescriptorSetLayout(layoutDesc);
+  m_descriptorSetLayout = m_resourceManager->addDescriptorSetLayout(std::move(layout), "gpu_culling_set_layout");
+}
+
+void GpuCuller::createPipeline_() {
+  if (!m_shaderManager) {
+    GlobalLogger::Log(LogLevel::Error, "ShaderManager not found, GPU culling is disabled");
+    return;
+  }
+
+  rhi::ComputePipelineDesc pipelineDesc;
+  pipelineDesc.shader = m_shaderManager->getShader(m_computeShaderPath_);
+  pipelineDesc.setLayouts.push_back(m_descriptorSetLayout);
+
+  if (!pipelineDesc.shader) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to load GPU culling shader: " + m_computeShaderPath_);
+    return;
+  }
+
+  auto pipeline = m_device->createComputePipeline(pipelineDesc);
+  m_pipeline    = m_resourceManager->addComputePipeline(std::move(pipeline), "gpu_culling_pipeline");
+  m_shaderManager->registerPipelineForShader(m_pipeline, m_computeShaderPath_);
+}
+
+void GpuCuller::createZeroCounters_() {
+  const uint32_t zeros[s_drawCounterCount] = {};
+
+  rhi::BufferDesc bufferDesc;
+  bufferDesc.size        = sizeof(zeros);
+  bufferDesc.type        = rhi::BufferType::Dynamic;
+  bufferDesc.createFlags = rhi::BufferCreateFlag::CpuAccess;
+  bufferDesc.debugName   = "gpu_culling_zero_counters";
+
+  auto buffer    = m_device->createBuffer(bufferDesc);
+  m_zeroCounters = m_resourceManager->addBuffer(std::move(buffer), bufferDesc.debugName);
+  m_device->updateBuffer(m_zeroCounters, zeros, sizeof(zeros));
+}
+
+bool GpuCuller::ensureCapacity_(FrameBuffer&          frameBuffer,
+                                uint32_t              elementCount,
+                                uint32_t              stride,
+                                rhi::BufferCreateFlag createFlags,
+                                rhi::BufferType       type,
+                                const std::string&    name) {
+  if (frameBuffer.buffer && elementCount <= frameBuffer.capacity) {
+    return false;
+  }
+
+  uint32_t newCapacity = std::max(static_cast<uint32_t>(elementCount * 1.5), MIN_CAPACITY);
+
+  // the buffer of this frame isn't used by the GPU anymore, so it can be replaced under the same key
+  std::string bufferKey = name + "_" + std::to_string(m_frameIndex);
+
+  rhi::BufferDesc bufferDesc;
+  bufferDesc.size        = static_cast<uint64_t>(newCapacity) * stride;
+  bufferDesc.createFlags = createFlags;
+  bufferDesc.type        = type;
+  bufferDesc.stride      = stride;
+  bufferDesc.debugName   = bufferKey;
+
+  auto buffer          = m_device->createBuffer(bufferDesc);
+  frameBuffer.buffer   = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
+  frameBuffer.capacity = newCapacity;
+  return true;
+}
+
+void GpuCuller::updateDescriptorSet_(FrameData& frame) {
+  if (!frame.descriptorSet) {
+    std::string setKey  = "gpu_culling_descriptor_set_" + std::to_string(m_frameIndex);
+    auto descriptorSet  = m_device->createDescriptorSet(m_descriptorSetLayout);
+    frame.descriptorSet = m_resourceManager->addDescriptorSet(std::move(descriptorSet), setKey);
+  }
+
+  // the constants are allocated per dispatch, the set is bound with their offset
+  frame.descriptorSet->setUniformBuffer(CONSTANTS_BINDING, m_constantAllocator->getBuffer(), 0, sizeof(CullConstants));
+
+  frame.descriptorSet->setStorageBuffer(DRAW_GROUPS_BINDING, frame.drawGroups.buffer);
+  frame.descriptorSet->setStorageBuffer(INSTANCES_BINDING, frame.instances.buffer);
+  frame.descriptorSet->setStorageBuffer(VISIBLE_INSTANCES_BINDING, frame.visibleInstances.buffer);
+  frame.descriptorSet->setStorageBuffer(DRAW_COMMANDS_BINDING, frame.drawCommands.buffer);
+  frame.descriptorSet->setStorageBuffer(DRAW_COUNTS_BINDING, frame.drawCounts.buffer);
+  frame.descriptorSet->setStorageBuffer(VISIBLE_DRAW_INFOS_BINDING, frame.visibleDrawInfos.buffer);
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
@@ -0,0 +1,187 @@
+#ifndef ARISE_GPU_CULLER_H
+#define ARISE_GPU_CULLER_H
+
+#include "ecs/components/bounding_volume.h"
+#include "ecs/components/render_geometry_mesh.h"
+#include "gfx/rhi/common/rhi_types.h"
+
+#include <math_library/matrix.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace arise::gfx::rhi {
+class Buffer;
+class CommandBuffer;
+class ComputePipeline;
+class DescriptorSet;
+class DescriptorSetLayout;
+class Device;
+class ShaderManager;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+class FrameConstantAllocator;
+class RenderResourceManager;
+
+/**
+ * Frustum culling of mesh instances in a compute shader, producing the arguments of one multi-draw indirect call.
+ *
+ * The CPU adds the instance matrices of every model and one draw group per mesh (its bounds, index range, transform,
+ * draw info and the model's instances). The compute shader tests every instance of a group with the mesh bounds and
+ * writes the visible ones to a compacted instance buffer - the mesh transform applied to the instance matrix, and the
+ * group's draw info next to it - so no per mesh state is left to bind between the draws. Every group gets one
+ * DrawIndexedIndirectCommand: groups with visible instances are packed to the front of the command buffer and counted
+ * in the first element of the draw count buffer, the empty ones (zero instances) fill the back. All groups are drawn by
+ * one drawIndexedIndirectCount, or by one drawIndexedIndirect of getDrawGroupCount() commands without count support.
+ *
+ * All buffers are per frame in flight, they are written (by the CPU or the compute shader) only after the frame's
+ * fence was waited.
+ */
+class GpuCuller {
+  public:
+  static constexpr uint32_t s_drawCommandStride = sizeof(rhi::DrawIndexedIndirectCommand);
+
+  void initialize(rhi::Device*            device,
+                  RenderResourceManager*  resourceManager,
+                  rhi::ShaderManager*     shaderManager,
+                  FrameConstantAllocator* constantAllocator,
+                  uint32_t                framesCount);
+
+  // Drops the groups and instances of the previous frame
+  void beginFrame(uint32_t frameIndex);
+
+  /**
+   * @return Index of the first added instance, draw groups reference the instances with it
+   */
+  uint32_t addInstances(const std::vector<math::Matrix4f<>>& matrices);
+
+  // Adds matrices[indices[i]], e.g. the instances of one LOD group
+  uint32_t addInstances(const std::vector<math::Matrix4f<>>& matrices, const std::vector<uint32_t>& indices);
+
+  /**
+   * @param bounds model space bounds of the mesh, invalid bounds are never culled
+   * @param lodLevel level of the mesh the instances are drawn with (RenderGeometryMesh::getIndexCount)
+   * @param meshMatrix transform of the mesh in the model, applied before the instance matrix
+   * @param drawInfo written for every visible instance of the group (DrawInfoInput::PerInstance)
+   * @return Index of the group
+   */
+  uint32_t addDrawGroup(const BoundingBox&        bounds,
+                        const RenderGeometryMesh& mesh,
+                        uint32_t                  lodLevel,
+                        uint32_t                  firstInstance,
+                        uint32_t                  instanceCount,
+                        const math::Matrix4f<>&   meshMatrix,
+                        uint32_t                  drawInfo);
+
+  // Writes the groups and instances to the buffers of the frame, call once after the last add
+  void upload();
+
+  /**
+   * Records the culling dispatch. Must be called outside of a render pass, before the draws that read the output.
+   */
+  void cull(rhi::CommandBuffer* commandBuffer, const Frustum& frustum);
+
+  void clear();
+
+  uint32_t getDrawGroupCount() const { return static_cast<uint32_t>(m_drawGroups.size()); }
+
+  // Vertex buffer of the per-instance matrices, the draw commands index it with firstInstance
+  rhi::Buffer* getVisibleInstanceBuffer() const { return m_frames[m_frameIndex].visibleInstances.buffer; }
+
+  // Vertex buffer of the per-instance draw infos, indexed like the matrices
+  rhi::Buffer* getVisibleDrawInfoBuffer() const { return m_frames[m_frameIndex].visibleDrawInfos.buffer; }
+
+  rhi::Buffer* getDrawCommandBuffer() const { return m_frames[m_frameIndex].drawCommands.buffer; }
+
+  rhi::Buffer* getDrawCountBuffer() const { return m_frames[m_frameIndex].drawCounts.buffer; }
+
+  private:
+  // layout matches DrawGroup in cull.cs.hlsl
+  struct DrawGroupData {
+    float    boundsMin[3]       = {};
+    uint32_t boundsValid        = 0;
+    float    boundsMax[3]       = {};
+    uint32_t indexCount         = 0;
+    uint32_t firstIndex         = 0;
+    int32_t  vertexOffset       = 0;
+    uint32_t firstInstance      = 0;  // in the input instances
+    uint32_t instanceCount      = 0;
+    uint32_t firstVisibleOffset = 0;  // in the compacted visible instances
+    uint32_t drawInfo           = 0;
+    uint32_t padding[2]         = {};
+    float    meshMatrix[16]     = {};  // row-major like the instance matrices
+  };
+
+  // visible and empty groups, the command indices are allocated from both ends of the command buffer
+  static constexpr uint32_t s_drawCounterCount = 2;
+
+  // layout matches CullConstants in cull.cs.hlsl
+  struct CullConstants {
+    float    planes[Frustum::s_planeCount][4];
+    uint32_t drawGroupCount;
+    uint32_t groupsPerRow;
+    uint32_t padding[2];
+  };
+
+  struct FrameBuffer {
+    rhi::Buffer* buffer   = nullptr;
+    uint32_t     capacity = 0;
+  };
+
+  struct FrameData {
+    FrameBuffer         drawGroups;
+    FrameBuffer         instances;
+    FrameBuffer         visibleInstances;
+    FrameBuffer         visibleDrawInfos;
+    FrameBuffer         drawCommands;
+    FrameBuffer         drawCounts;
+    rhi::DescriptorSet* descriptorSet = nullptr;
+  };
+
+  void createDescriptorSetLayout_();
+  void createPipeline_();
+  void createZeroCounters_();
+
+  /**
+   * Replaces the buffer when it's smaller than elementCount. Returns true if the buffer was replaced.
+   */
+  bool ensureCapacity_(FrameBuffer&          frameBuffer,
+                       uint32_t              elementCount,
+                       uint32_t              stride,
+                       rhi::BufferCreateFlag createFlags,
+                       rhi::BufferType       type,
+                       const std::string&    name);
+
+  void updateDescriptorSet_(FrameData& frame);
+
+  const std::string m_computeShaderPath_ = "assets/shaders/gpu_culling/cull.cs.hlsl";
+
+  rhi::Device*            m_device            = nullptr;
+  RenderResourceManager*  m_resourceManager   = nullptr;
+  rhi::ShaderManager*     m_shaderManager     = nullptr;
+  FrameConstantAllocator* m_constantAllocator = nullptr;
+
+  rhi::DescriptorSetLayout* m_descriptorSetLayout = nullptr;
+  rhi::ComputePipeline*     m_pipeline            = nullptr;
+
+  // copied over the draw counters before every dispatch
+  rhi::Buffer* m_zeroCounters = nullptr;
+
+  std::vector<FrameData> m_frames;
+  uint32_t               m_frameIndex = 0;
+
+  std::vector<DrawGroupData>    m_drawGroups;
+  std::vector<math::Matrix4f<>> m_instances;
+  uint32_t                      m_visibleInstanceCount = 0;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_GPU_CULLER_H
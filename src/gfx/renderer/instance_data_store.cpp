@@ -0,0 +1,241 @@
+#include "gfx/renderer/instance_data_store.h"
+
+#include "gfx/renderer/render_resource_manager.h"
+#include "gfx/rhi/interface/buffer.h"
+#include "gfx/rhi/interface/device.h"
+#include "profiler/profiler.h"
+#include "utils/resource/resource_deletion_manager.h"
+#include "utils/service/service_locator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+namespace {
+
+// dirty slots closer than this are uploaded as one range, a few unchanged matrices are cheaper than another copy
+constexpr uint32_t RANGE_MERGE_GAP = 4;
+
+constexpr uint32_t MIN_CAPACITY = 8;
+
+std::string getBufferKey(RenderModel* model, uint32_t frameIndex) {
+  return "instance_buffer_" + std::to_string(reinterpret_cast<uintptr_t>(model)) + "_" + std::to_string(frameIndex);
+}
+
+}  // namespace
+
+void InstanceDataStore::initialize(rhi::Device* device, RenderResourceManager* resourceManager, uint32_t framesCount) {
+  m_device          = device;
+  m_resourceManager = resourceManager;
+  m_framesCount     = std::max(framesCount, 1u);
+}
+
+uint32_t InstanceDataStore::addInstance(RenderModel* model, const math::Matrix4f<>& matrix) {
+  auto& data = m_models[model];
+  if (data.frameBuffers.empty()) {
+    data.frameBuffers.resize(m_framesCount);
+  }
+
+  // the lowest free slot is reused first, which keeps the used slots compact
+  uint32_t slot;
+  if (!data.freeSlots.empty()) {
+    slot = *data.freeSlots.begin();
+    data.freeSlots.erase(data.freeSlots.begin());
+    data.matrices[slot] = matrix;
+  } else {
+    slot = static_cast<uint32_t>(data.matrices.size());
+    data.matrices.push_back(matrix);
+  }
+
+  ++data.instanceCount;
+  markDirty_(data, slot);
+  return slot;
+}
+
+void InstanceDataStore::updateInstance(RenderModel* model, uint32_t slot, const math::Matrix4f<>& matrix) {
+  auto it = m_models.find(model);
+  if (it == m_models.end() || slot >= it->second.matrices.size()) {
+    return;
+  }
+
+  it->second.matrices[slot] = matrix;
+  markDirty_(it->second, slot);
+}
+
+void InstanceDataStore::removeInstance(RenderModel* model, uint32_t slot) {
+  auto it = m_models.find(model);
+  if (it == m_models.end() || slot >= it->second.matrices.size()) {
+    return;
+  }
+
+  auto& data = it->second;
+  if (--data.instanceCount == 0) {
+    // a model created later at the same address must not find these buffers under its keys
+    retireBuffers_(model, data);
+    m_models.erase(it);
+    return;
+  }
+
+  // zero matrix collapses all vertices, so the hole can be drawn as a part of a bigger range
+  std::memset(&data.matrices[slot], 0, sizeof(math::Matrix4f<>));
+  markDirty_(data, slot);
+
+  data.freeSlots.insert(slot);
+
+  // trailing free slots are trimmed, so the drawn range doesn't grow with removed instances
+  while (!data.freeSlots.empty() && *data.freeSlots.rbegin() + 1 == data.matrices.size()) {
+    data.freeSlots.erase(std::prev(data.freeSlots.end()));
+    data.matrices.pop_back();
+  }
+}
+
+void InstanceDataStore::upload(uint32_t frameIndex) {
+  CPU_ZONE_NC("InstanceDataStore::upload", color::YELLOW);
+
+  m_uploadedInstanceCount = 0;
+  frameIndex %= m_framesCount;
+
+  for (auto& [model, data] : m_models) {
+    uploadModel_(model, data, frameIndex);
+  }
+}
+
+void InstanceDataStore::clear() {
+  for (auto& [model, data] : m_models) {
+    retireBuffers_(model, data);
+  }
+  m_models.clear();
+  m_uploadedInstanceCount = 0;
+}
+
+rhi::Buffer* InstanceDataStore::getBuffer(RenderModel* model, uint32_t frameIndex) const {
+  auto it = m_models.find(model);
+  if (it == m_models.end()) {
+    return nullptr;
+  }
+  return it->second.frameBuffers[frameIndex % m_framesCount].buffer;
+}
+
+uint32_t InstanceDataStore::getSlotCount(RenderModel* model) const {
+  auto it = m_models.find(model);
+  return it != m_models.end() ? static_cast<uint32_t>(it->second.matrices.size()) : 0;
+}
+
+void InstanceDataStore::markDirty_(ModelData& data, uint32_t slot) {
+  for (auto& frameBuffer : data.frameBuffers) {
+    if (!frameBuffer.needsFullUpload) {
+      frameBuffer.dirtySlots.push_back(slot);
+    }
+  }
+}
+
+void InstanceDataStore::uploadModel_(RenderModel* model, ModelData& data, uint32_t frameIndex) {
+  auto& frameBuffer = data.frameBuffers[frameIndex];
+
+  if (data.matrices.empty()) {
+    frameBuffer.dirtySlots.clear();
+    return;
+  }
+
+  if (ensureCapacity_(model, data, frameIndex) || frameBuffer.needsFullUpload) {
+    m_device->updateBuffer(frameBuffer.buffer, data.matrices.data(), data.matrices.size() * sizeof(math::Matrix4f<>));
+    m_uploadedInstanceCount     += static_cast<uint32_t>(data.matrices.size());
+    frameBuffer.needsFullUpload  = false;
+    frameBuffer.dirtySlots.clear();
+    return;
+  }
+
+  if (frameBuffer.dirtySlots.empty()) {
+    return;
+  }
+
+  auto& slots = frameBuffer.dirtySlots;
+  std::sort(slots.begin(), slots.end());
+  slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+
+  const auto slotCount = static_cast<uint32_t>(data.matrices.size());
+
+  size_t i = 0;
+  while (i < slots.size()) {
+    uint32_t rangeBegin = slots[i];
+    uint32_t rangeEnd   = rangeBegin + 1;
+    for (++i; i < slots.size() && slots[i] <= rangeEnd + RANGE_MERGE_GAP; ++i) {
+      rangeEnd = slots[i] + 1;
+    }
+
+    // slots above the current count were trimmed after they were marked
+    rangeEnd = std::min(rangeEnd, slotCount);
+    if (rangeBegin >= rangeEnd) {
+      continue;
+    }
+
+    m_device->updateBuffer(frameBuffer.buffer,
+                           &data.matrices[rangeBegin],
+                           (rangeEnd - rangeBegin) * sizeof(math::Matrix4f<>),
+                           rangeBegin * sizeof(math::Matrix4f<>));
+    m_uploadedInstanceCount += rangeEnd - rangeBegin;
+  }
+
+  slots.clear();
+}
+
+bool InstanceDataStore::ensureCapacity_(RenderModel* model, ModelData& data, uint32_t frameIndex) {
+  auto&      frameBuffer = data.frameBuffers[frameIndex];
+  const auto slotCount   = static_cast<uint32_t>(data.matrices.size());
+  if (frameBuffer.buffer && slotCount <= frameBuffer.capacity) {
+    return false;
+  }
+
+  uint32_t newCapacity = std::max(static_cast<uint32_t>(slotCount * 1.5), MIN_CAPACITY);
+
+  // the buffer of this frame isn't used by the GPU anymore, so it can be replaced under the same key
+  std::string bufferKey = getBufferKey(model, frameIndex);
+
+  rhi::BufferDesc bufferDesc;
+  bufferDesc.size        = newCapacity * sizeof(math::Matrix4f<>);
+  bufferDesc.createFlags = rhi::BufferCreateFlag::InstanceBuffer;
+  bufferDesc.type        = rhi::BufferType::Dynamic;
+  bufferDesc.stride      = sizeof(math::Matrix4f<>);
+  bufferDesc.debugName   = bufferKey;
+
+  auto buffer          = m_device->createBuffer(bufferDesc);
+  frameBuffer.buffer   = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
+  frameBuffer.capacity = newCapacity;
+  return true;
+}
+
+void InstanceDataStore::retireBuffers_(RenderModel* model, ModelData& data) {
+  auto deletionManager = ServiceLocator::s_get<ResourceDeletionManager>();
+
+  for (uint32_t frameIndex = 0; frameIndex < data.frameBuffers.size(); ++frameIndex) {
+    auto& frameBuffer = data.frameBuffers[frameIndex];
+    if (!frameBuffer.buffer) {
+      continue;
+    }
+    frameBuffer.buffer = nullptr;
+
+    std::shared_ptr<rhi::Buffer> buffer = m_resourceManager->releaseBuffer(getBufferKey(model, frameIndex));
+    if (!buffer) {
+      continue;
+    }
+
+    if (!deletionManager) {
+      m_device->waitIdle();
+      continue;
+    }
+
+    // the frames in flight can still read the buffer, the callback owns it until they are done
+    const std::string bufferName = buffer->getDesc().debugName;
+    deletionManager->enqueueForDeletion<rhi::Buffer>(buffer.get(), [buffer](rhi::Buffer*) {}, bufferName, "Buffer");
+  }
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
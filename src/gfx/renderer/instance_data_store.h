@@ -0,0 +1,105 @@
+#ifndef ARISE_INSTANCE_DATA_STORE_H
+#define ARISE_INSTANCE_DATA_STORE_H
+
+#include <math_library/matrix.h>
+
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace arise {
+struct RenderModel;
+}  // namespace arise
+
+namespace arise::gfx::rhi {
+class Buffer;
+class Device;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+class RenderResourceManager;
+
+// consecutive slots of a model's instance buffer, drawn by one instanced draw (firstInstance = first slot)
+struct InstanceRange {
+  uint32_t firstInstance = 0;
+  uint32_t instanceCount = 0;
+};
+
+/**
+ * Persistent per-model instance matrices on the GPU.
+ *
+ * Every instance gets a stable slot in its model's instance buffer for its whole lifetime, so moving one instance
+ * touches one slot. There is one buffer per frame in flight (the CPU never writes a buffer the GPU may still read) and
+ * every buffer tracks its own dirty slots - a change is written to each buffer the next time that buffer's frame comes
+ * around. Dirty slots are merged into ranges, so only the changed parts are uploaded.
+ *
+ * Freed slots are filled with a zero matrix (degenerate triangles), which makes it safe to draw a range of slots that
+ * contains holes.
+ */
+class InstanceDataStore {
+  public:
+  static constexpr uint32_t s_invalidSlot = std::numeric_limits<uint32_t>::max();
+
+  void initialize(rhi::Device* device, RenderResourceManager* resourceManager, uint32_t framesCount);
+
+  uint32_t addInstance(RenderModel* model, const math::Matrix4f<>& matrix);
+  void     updateInstance(RenderModel* model, uint32_t slot, const math::Matrix4f<>& matrix);
+  void     removeInstance(RenderModel* model, uint32_t slot);
+
+  // Writes the slots changed since the buffers of this frame were used last time
+  void upload(uint32_t frameIndex);
+
+  // Retires the buffers of all models
+  void clear();
+
+  rhi::Buffer* getBuffer(RenderModel* model, uint32_t frameIndex) const;
+
+  // Number of slots in use including holes, i.e. the highest valid slot + 1
+  uint32_t getSlotCount(RenderModel* model) const;
+
+  // Instances written to the GPU by the last upload() (statistics)
+  uint32_t getUploadedInstanceCount() const { return m_uploadedInstanceCount; }
+
+  private:
+  struct FrameBuffer {
+    rhi::Buffer*          buffer   = nullptr;
+    uint32_t              capacity = 0;
+    std::vector<uint32_t> dirtySlots;
+    bool                  needsFullUpload = true;
+  };
+
+  struct ModelData {
+    std::vector<math::Matrix4f<>> matrices;
+    std::set<uint32_t>            freeSlots;
+    uint32_t                      instanceCount = 0;
+    std::vector<FrameBuffer>      frameBuffers;
+  };
+
+  void markDirty_(ModelData& data, uint32_t slot);
+
+  void uploadModel_(RenderModel* model, ModelData& data, uint32_t frameIndex);
+
+  bool ensureCapacity_(RenderModel* model, ModelData& data, uint32_t frameIndex);
+
+  // takes the buffers of the model from the resource manager and deletes them after the frames in flight
+  void retireBuffers_(RenderModel* model, ModelData& data);
+
+  rhi::Device*           m_device          = nullptr;
+  RenderResourceManager* m_resourceManager = nullptr;
+  uint32_t               m_framesCount     = 1;
+
+  std::unordered_map<RenderModel*, ModelData> m_models;
+
+  uint32_t m_uploadedInstanceCount = 0;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_INSTANCE_DATA_STORE_H
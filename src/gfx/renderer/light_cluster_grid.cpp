@@ -0,0 +1,720 @@
+#include "gfx/renderer/light_cluster_grid.h"
+
+#include "ecs/systems/light_system.h"
+#include "gfx/renderer/frame_constant_allocator.h"
+#include "gfx/renderer/render_resource_manager.h"
+#include "gfx/rhi/interface/buffer.h"
+#include "gfx/rhi/interface/command_buffer.h"
+#include "gfx/rhi/interface/descriptor.h"
+#include "gfx/rhi/interface/device.h"
+#include "gfx/rhi/interface/pipeline.h"
+#include "gfx/rhi/shader_manager.h"
+#include "profiler/profiler.h"
+#include "utils/job/job_system.h"
+#include "utils/logger/global_logger.h"
+
+#include <math_library/graphics.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARISE_CLUSTERS_USE_SSE
+#endif
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+namespace {
+
+constexpr uint32_t MIN_CAPACITY = 64;
+
+// THREAD_COUNT in build_clusters.cs.hlsl, one thread per cluster
+constexpr uint32_t CLUSTERS_PER_GROUP = 64;
+
+// clusters tested by one call of testSphere4
+constexpr uint32_t CLUSTER_BATCH = 4;
+
+static_assert(LightClusterGrid::s_clusterCountX % CLUSTER_BATCH == 0, "cluster rows are tested in whole batches");
+
+// bindings of the fragment set, the register numbers of space5 in base_pass/shader.ps.hlsl
+constexpr uint32_t CONSTANTS_BINDING     = 0;
+constexpr uint32_t CLUSTERS_BINDING      = 1;
+constexpr uint32_t LIGHT_INDICES_BINDING = 2;
+
+// bindings of the compute set, the register numbers in build_clusters.cs.hlsl
+constexpr uint32_t COMPUTE_CONSTANTS_BINDING     = 0;
+constexpr uint32_t COMPUTE_POINT_LIGHTS_BINDING  = 1;
+constexpr uint32_t COMPUTE_SPOT_LIGHTS_BINDING   = 2;
+constexpr uint32_t COMPUTE_CLUSTERS_BINDING      = 3;
+constexpr uint32_t COMPUTE_LIGHT_INDICES_BINDING = 4;
+
+uint32_t toCell(float value, uint32_t count) {
+  if (!(value > 0.0f)) {
+    return 0;
+  }
+  return std::min(static_cast<uint32_t>(value), count - 1);
+}
+
+/**
+ * Sphere against the view space boxes of 4 consecutive clusters.
+ *
+ * @return Bit i is set when the sphere touches the cluster first + i
+ */
+int testSphere4(const float* minX,
+                const float* minY,
+                const float* minZ,
+                const float* maxX,
+                const float* maxY,
+                const float* maxZ,
+                const float  center[3],
+                float        radius) {
+#ifdef ARISE_CLUSTERS_USE_SSE
+  const __m128 zero = _mm_setzero_ps();
+
+  // distance from the center to the box along each axis, zero inside
+  auto axisDistance = [zero](const float* boxMin, const float* boxMax, float value) {
+    const __m128 c = _mm_set1_ps(value);
+    return _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(boxMin), c), _mm_sub_ps(c, _mm_loadu_ps(boxMax))), zero);
+  };
+
+  const __m128 dx = axisDistance(minX, maxX, center[0]);
+  const __m128 dy = axisDistance(minY, maxY, center[1]);
+  const __m128 dz = axisDistance(minZ, maxZ, center[2]);
+
+  const __m128 distanceSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+  return _mm_movemask_ps(_mm_cmple_ps(distanceSqr, _mm_set1_ps(radius * radius)));
+#else
+  int mask = 0;
+  for (uint32_t i = 0; i < CLUSTER_BATCH; ++i) {
+    const float dx          = std::max({minX[i] - center[0], center[0] - maxX[i], 0.0f});
+    const float dy          = std::max({minY[i] - center[1], center[1] - maxY[i], 0.0f});
+    const float dz          = std::max({minZ[i] - center[2], center[2] - maxZ[i], 0.0f});
+    const float distanceSqr = dx * dx + dy * dy + dz * dz;
+    if (distanceSqr <= radius * radius) {
+      mask |= 1 << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+}  // namespace
+
+void LightClusterGrid::initialize(rhi::Device*            device,
+                                  RenderResourceManager*  resourceManager,
+                                  rhi::ShaderManager*     shaderManager,
+                                  FrameConstantAllocator* constantAllocator,
+                                  uint32_t                framesCount) {
+  m_device            = device;
+  m_resourceManager   = resourceManager;
+  m_shaderManager     = shaderManager;
+  m_constantAllocator = constantAllocator;
+
+  m_frames.clear();
+  m_frames.resize(std::max(framesCount, 1u));
+  m_frameIndex = 0;
+
+  m_clusterMinX.assign(s_clusterCount, 0.0f);
+  m_clusterMinY.assign(s_clusterCount, 0.0f);
+  m_clusterMinZ.assign(s_clusterCount, 0.0f);
+  m_clusterMaxX.assign(s_clusterCount, 0.0f);
+  m_clusterMaxY.assign(s_clusterCount, 0.0f);
+  m_clusterMaxZ.assign(s_clusterCount, 0.0f);
+  std::fill(std::begin(m_boundsKey), std::end(m_boundsKey), 0.0f);
+
+  m_clusterLights.assign(s_clusterCount, {});
+  m_clusterPointCounts.assign(s_clusterCount, 0);
+
+  createDescriptorSetLayouts_();
+  createPipeline_();
+}
+
+void LightClusterGrid::build(uint32_t                frameIndex,
+                             const math::Matrix4f<>& view,
+                             const math::Matrix4f<>& projection,
+                             bool                    hasCamera,
+                             float                   screenWidth,
+                             float                   screenHeight,
+                             const LightSystem*      lightSystem,
+                             bool                    useCompute) {
+  CPU_ZONE_NC("LightClusterGrid::build", color::YELLOW);
+
+  m_frameIndex      = frameIndex % m_frames.size();
+  m_dispatchPending = false;
+
+  auto& frame = m_frames[m_frameIndex];
+
+  const bool gridValid = setupGrid_(view, projection, hasCamera, screenWidth, screenHeight);
+
+  m_constants.pointLightCount = lightSystem ? lightSystem->getPointLightCount() : 0;
+  m_constants.spotLightCount  = lightSystem ? lightSystem->getSpotLightCount() : 0;
+
+  if (gridValid && useCompute && lightSystem && prepareCompute_(frame, *lightSystem)) {
+    m_clusters.clear();
+    m_lightIndices.clear();
+    m_dispatchPending = true;
+  } else {
+    if (gridValid && lightSystem) {
+      updateClusterBounds_();
+      assignLights_(*lightSystem);
+      packLists_();
+    } else {
+      fillSingleCluster_(lightSystem);
+    }
+    uploadLists_(frame);
+  }
+
+  auto allocation = m_constantAllocator->push(m_constants);
+  if (!allocation.isValid()) {
+    GlobalLogger::Log(LogLevel::Error, "Frame constants exhausted, light cluster constants are not updated");
+  }
+  m_constantsOffset = allocation.offset;
+}
+
+void LightClusterGrid::dispatch(rhi::CommandBuffer* commandBuffer) {
+  if (!m_dispatchPending || !commandBuffer || !m_pipeline) {
+    return;
+  }
+  m_dispatchPending = false;
+
+  auto& frame = m_frames[m_frameIndex];
+
+  GPU_ZONE_NC(commandBuffer, "Light Clustering", color::YELLOW);
+
+  // the previous use of the buffers (by the pixel shader of this frame slot) must finish before they are overwritten
+  commandBuffer->bufferBarrier(
+      {frame.computeClusters.buffer, rhi::BufferState::ShaderRead, rhi::BufferState::UnorderedAccess});
+  commandBuffer->bufferBarrier(
+      {frame.computeLightIndices.buffer, rhi::BufferState::ShaderRead, rhi::BufferState::UnorderedAccess});
+
+  commandBuffer->setPipeline(m_pipeline);
+  commandBuffer->bindDescriptorSet(0, frame.computeDescriptorSet, {&m_constantsOffset, 1});
+  commandBuffer->dispatch((s_clusterCount + CLUSTERS_PER_GROUP - 1) / CLUSTERS_PER_GROUP, 1);
+
+  commandBuffer->bufferBarrier(
+      {frame.computeClusters.buffer, rhi::BufferState::UnorderedAccess, rhi::BufferState::ShaderRead});
+  commandBuffer->bufferBarrier(
+      {frame.computeLightIndices.buffer, rhi::BufferState::UnorderedAccess, rhi::BufferState::ShaderRead});
+}
+
+void LightClusterGrid::clear() {
+  m_dispatchPending = false;
+  m_lightBounds.clear();
+  m_clusters.clear();
+  m_lightIndices.clear();
+}
+
+void LightClusterGrid::createDescriptorSetLayouts_() {
+  auto addBinding = [](rhi::DescriptorSetLayoutDesc& layoutDesc,
+                       uint32_t                      binding,
+                       rhi::ShaderBindingType        type,
+                       rhi::ShaderStageFlag          stage) {
+    rhi::DescriptorSetLayoutBindingDesc bindingDesc;
+    bindingDesc.binding    = binding;
+    bindingDesc.type       = type;
+    bindingDesc.stageFlags = stage;
+    layoutDesc.bindings.push_back(bindingDesc);
+  };
+
+  rhi::DescriptorSetLayoutDesc layoutDesc;
+  addBinding(layoutDesc,
+             CONSTANTS_BINDING,
+             rhi::ShaderBindingType::UniformbufferDynamic,
+             rhi::ShaderStageFlag::Fragment);
+  addBinding(layoutDesc, CLUSTERS_BINDING, rhi::ShaderBindingType::BufferSrv, rhi::ShaderStageFlag::Fragment);
+  addBinding(layoutDesc, LIGHT_INDICES_BINDING, rhi::ShaderBindingType::BufferSrv, rhi::ShaderStageFlag::Fragment);
+
+  auto layout           = m_device->createDescriptorSetLayout(layoutDesc);
+  m_descriptorSetLayout = m_resourceManager->addDescriptorSetLayout(std::move(layout), "light_cluster_layout");
+
+  rhi::DescriptorSetLayoutDesc computeLayoutDesc;
+  addBinding(computeLayoutDesc,
+             COMPUTE_CONSTANTS_BINDING,
+             rhi::ShaderBindingType::UniformbufferDynamic,
+             rhi::ShaderStageFlag::Compute);
+  addBinding(computeLayoutDesc,
+             COMPUTE_POINT_LIGHTS_BINDING,
+             rhi::ShaderBindingType::BufferSrv,
+             rhi::ShaderStageFlag::Compute);
+  addBinding(computeLayoutDesc,
+             COMPUTE_SPOT_LIGHTS_BINDING,
+             rhi::ShaderBindingType::BufferSrv,
+             rhi::ShaderStageFlag::Compute);
+  addBinding(computeLayoutDesc,
+             COMPUTE_CLUSTERS_BINDING,
+             rhi::ShaderBindingType::BufferUav,
+             rhi::ShaderStageFlag::Compute);
+  addBinding(computeLayoutDesc,
+             COMPUTE_LIGHT_INDICES_BINDING,
+             rhi::ShaderBindingType::BufferUav,
+             rhi::ShaderStageFlag::Compute);
+
+  auto computeLayout           = m_device->createDescriptorSetLayout(computeLayoutDesc);
+  m_computeDescriptorSetLayout = m_resourceManager->addDescriptorSetLayout(std::move(computeLayout),
+                                                                           "light_cluster_compute_layout");
+}
+
+void LightClusterGrid::createPipeline_() {
+  if (!m_shaderManager) {
+    GlobalLogger::Log(LogLevel::Error, "ShaderManager not found, GPU light clustering is disabled");
+    return;
+  }
+
+  rhi::ComputePipelineDesc pipelineDesc;
+  pipelineDesc.shader = m_shaderManager->getShader(m_computeShaderPath_);
+  pipelineDesc.setLayouts.push_back(m_computeDescriptorSetLayout);
+
+  if (!pipelineDesc.shader) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to load light clustering shader: " + m_computeShaderPath_);
+    return;
+  }
+
+  auto pipeline = m_device->createComputePipeline(pipelineDesc);
+  m_pipeline    = m_resourceManager->addComputePipeline(std::move(pipeline), "light_cluster_pipeline");
+  m_shaderManager->registerPipelineForShader(m_pipeline, m_computeShaderPath_);
+}
+
+bool LightClusterGrid::setupGrid_(const math::Matrix4f<>& view,
+                                  const math::Matrix4f<>& projection,
+                                  bool                    hasCamera,
+                                  float                   screenWidth,
+                                  float                   screenHeight) {
+  const float* v = view.data();
+  const float* p = projection.data();
+
+  m_constants = {};
+
+  // row-major with row vectors, the view depth is the third column
+  for (uint32_t row = 0; row < 4; ++row) {
+    for (uint32_t column = 0; column < 4; ++column) {
+      m_constants.viewRows[row][column] = v[row * 4 + column];
+    }
+  }
+  m_constants.viewDepthPlane[0] = v[2];
+  m_constants.viewDepthPlane[1] = v[6];
+  m_constants.viewDepthPlane[2] = v[10];
+  m_constants.viewDepthPlane[3] = v[14];
+
+  m_constants.screenSize[0]       = std::max(screenWidth, 1.0f);
+  m_constants.screenSize[1]       = std::max(screenHeight, 1.0f);
+  m_constants.maxLightsPerCluster = s_maxLightsPerCluster;
+
+  // single cluster, the depth is clamped to 1 so the slice math stays finite
+  auto setupSingleCluster = [this]() {
+    m_constants.clusterCount[0]    = 1;
+    m_constants.clusterCount[1]    = 1;
+    m_constants.clusterCount[2]    = 1;
+    m_constants.projectionScale[0] = 1.0f;
+    m_constants.projectionScale[1] = 1.0f;
+    m_constants.zNear              = 1.0f;
+    m_constants.zFar               = 1.0f;
+    return false;
+  };
+
+  // an orthographic projection has no w = z, its depth isn't sliced exponentially
+  if (!hasCamera || p[11] == 0.0f || p[10] == 0.0f || p[10] == 1.0f) {
+    return setupSingleCluster();
+  }
+
+  // left-handed zero-to-one projection: z' = z * p[10] + p[14], w = z
+  const float zNear = -p[14] / p[10];
+  const float zFar  = p[14] / (1.0f - p[10]);
+  if (!(zNear > 0.0f) || !(zFar > zNear) || !std::isfinite(zFar)) {
+    return setupSingleCluster();
+  }
+
+  const float logDepthRatio = std::log(zFar / zNear);
+
+  m_constants.clusterCount[0]     = s_clusterCountX;
+  m_constants.clusterCount[1]     = s_clusterCountY;
+  m_constants.clusterCount[2]     = s_clusterCountZ;
+  m_constants.projectionScale[0]  = p[0];
+  m_constants.projectionScale[1]  = p[5];
+  m_constants.projectionOffset[0] = p[8];
+  m_constants.projectionOffset[1] = p[9];
+  m_constants.zNear               = zNear;
+  m_constants.zFar                = zFar;
+  m_constants.sliceScale          = static_cast<float>(s_clusterCountZ) / logDepthRatio;
+  m_constants.sliceBias           = -static_cast<float>(s_clusterCountZ) * std::log(zNear) / logDepthRatio;
+  return true;
+}
+
+void LightClusterGrid::updateClusterBounds_() {
+  const float key[6] = {m_constants.projectionScale[0],
+                        m_constants.projectionScale[1],
+                        m_constants.projectionOffset[0],
+                        m_constants.projectionOffset[1],
+                        m_constants.zNear,
+                        m_constants.zFar};
+  if (std::equal(std::begin(key), std::end(key), std::begin(m_boundsKey))) {
+    return;
+  }
+  std::copy(std::begin(key), std::end(key), std::begin(m_boundsKey));
+
+  CPU_ZONE_NC("Update Cluster Bounds", color::YELLOW);
+
+  const float depthRatio = m_constants.zFar / m_constants.zNear;
+
+  // view space coordinate of an NDC coordinate at the depth: (ndc - offset) * depth / scale
+  auto toViewX = [this](float ndc, float depth) {
+    return (ndc - m_constants.projectionOffset[0]) * depth / m_constants.projectionScale[0];
+  };
+  auto toViewY = [this](float ndc, float depth) {
+    return (ndc - m_constants.projectionOffset[1]) * depth / m_constants.projectionScale[1];
+  };
+
+  for (uint32_t z = 0; z < s_clusterCountZ; ++z) {
+    const float nearDepth = m_constants.zNear * std::pow(depthRatio, static_cast<float>(z) / s_clusterCountZ);
+    const float farDepth  = m_constants.zNear * std::pow(depthRatio, static_cast<float>(z + 1) / s_clusterCountZ);
+
+    for (uint32_t y = 0; y < s_clusterCountY; ++y) {
+      // rows go from the top of the screen, NDC y points up
+      const float ndcTop    = 1.0f - 2.0f * static_cast<float>(y) / s_clusterCountY;
+      const float ndcBottom = 1.0f - 2.0f * static_cast<float>(y + 1) / s_clusterCountY;
+
+      for (uint32_t x = 0; x < s_clusterCountX; ++x) {
+        const float ndcLeft  = -1.0f + 2.0f * static_cast<float>(x) / s_clusterCountX;
+        const float ndcRight = -1.0f + 2.0f * static_cast<float>(x + 1) / s_clusterCountX;
+
+        // the tile's edges spread with the depth, the box covers them at both depths of the slice
+        const uint32_t index = (z * s_clusterCountY + y) * s_clusterCountX + x;
+        m_clusterMinX[index] = std::min(toViewX(ndcLeft, nearDepth), toViewX(ndcLeft, farDepth));
+        m_clusterMaxX[index] = std::max(toViewX(ndcRight, nearDepth), toViewX(ndcRight, farDepth));
+        m_clusterMinY[index] = std::min(toViewY(ndcBottom, nearDepth), toViewY(ndcBottom, farDepth));
+        m_clusterMaxY[index] = std::max(toViewY(ndcTop, nearDepth), toViewY(ndcTop, farDepth));
+        m_clusterMinZ[index] = nearDepth;
+        m_clusterMaxZ[index] = farDepth;
+      }
+    }
+  }
+}
+
+bool LightClusterGrid::computeLightBounds_(const float worldCenter[3], float radius, LightBounds& bounds) const {
+  const auto& rows = m_constants.viewRows;
+  for (uint32_t i = 0; i < 3; ++i) {
+    bounds.center[i] = worldCenter[0] * rows[0][i] + worldCenter[1] * rows[1][i] + worldCenter[2] * rows[2][i]
+                     + rows[3][i];
+  }
+  bounds.radius = radius;
+
+  const float centerZ  = bounds.center[2];
+  const float minDepth = centerZ - radius;
+  const float maxDepth = centerZ + radius;
+  if (maxDepth < m_constants.zNear || minDepth > m_constants.zFar) {
+    return false;
+  }
+
+  auto toSlice = [this](float depth) {
+    return toCell(std::log(depth) * m_constants.sliceScale + m_constants.sliceBias, s_clusterCountZ);
+  };
+  bounds.minZ = toSlice(std::max(minDepth, m_constants.zNear));
+  bounds.maxZ = toSlice(std::min(maxDepth, m_constants.zFar));
+
+  bounds.minX = 0;
+  bounds.maxX = s_clusterCountX - 1;
+  bounds.minY = 0;
+  bounds.maxY = s_clusterCountY - 1;
+
+  // a sphere crossing the near plane may cover any tile
+  if (minDepth <= m_constants.zNear) {
+    return true;
+  }
+
+  // screen extent of the sphere's view space box, x / z is extreme at one of the box's depths
+  const float minX = bounds.center[0] - radius;
+  const float maxX = bounds.center[0] + radius;
+  const float minY = bounds.center[1] - radius;
+  const float maxY = bounds.center[1] + radius;
+
+  const float ndcMinX = std::min(minX / minDepth, minX / maxDepth) * m_constants.projectionScale[0]
+                      + m_constants.projectionOffset[0];
+  const float ndcMaxX = std::max(maxX / minDepth, maxX / maxDepth) * m_constants.projectionScale[0]
+                      + m_constants.projectionOffset[0];
+  const float ndcMinY = std::min(minY / minDepth, minY / maxDepth) * m_constants.projectionScale[1]
+                      + m_constants.projectionOffset[1];
+  const float ndcMaxY = std::max(maxY / minDepth, maxY / maxDepth) * m_constants.projectionScale[1]
+                      + m_constants.projectionOffset[1];
+
+  if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f) {
+    return false;
+  }
+
+  bounds.minX = toCell((ndcMinX + 1.0f) * 0.5f * s_clusterCountX, s_clusterCountX);
+  bounds.maxX = toCell((ndcMaxX + 1.0f) * 0.5f * s_clusterCountX, s_clusterCountX);
+  bounds.minY = toCell((1.0f - ndcMaxY) * 0.5f * s_clusterCountY, s_clusterCountY);
+  bounds.maxY = toCell((1.0f - ndcMinY) * 0.5f * s_clusterCountY, s_clusterCountY);
+  return true;
+}
+
+void LightClusterGrid::assignLights_(const LightSystem& lightSystem) {
+  CPU_ZONE_NC("Assign Lights", color::YELLOW);
+
+  m_lightBounds.clear();
+
+  const auto& pointLights = lightSystem.getPointLights();
+  for (uint32_t i = 0; i < pointLights.size(); ++i) {
+    const auto& light     = pointLights[i];
+    const float center[3] = {light.position.x(), light.position.y(), light.position.z()};
+
+    LightBounds bounds;
+    if (computeLightBounds_(center, light.range, bounds)) {
+      bounds.lightIndex = i;
+      m_lightBounds.push_back(bounds);
+    }
+  }
+  m_pointLightBoundsCount = static_cast<uint32_t>(m_lightBounds.size());
+
+  const auto& spotLights = lightSystem.getSpotLights();
+  for (uint32_t i = 0; i < spotLights.size(); ++i) {
+    const auto& light = spotLights[i];
+
+    float center[3] = {light.position.x(), light.position.y(), light.position.z()};
+    float radius    = light.range;
+
+    // bounding sphere of the cone, the whole range sphere for wide or degenerate cones
+    const float angle        = math::g_degreeToRadian(light.outerConeAngle);
+    const float cosAngle     = std::cos(angle);
+    const float sinAngle     = std::sin(angle);
+    const float direction[3] = {light.direction.x(), light.direction.y(), light.direction.z()};
+    const float dirLength
+        = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (dirLength > 0.0f && cosAngle > 0.0f) {
+      // a wide cone is bounded by its cap circle, a narrow one by the sphere through the apex and the cap
+      const float centerDistance = sinAngle > cosAngle ? cosAngle * light.range : light.range / (2.0f * cosAngle);
+      radius                     = sinAngle > cosAngle ? sinAngle * light.range : centerDistance;
+      for (uint32_t axis = 0; axis < 3; ++axis) {
+        center[axis] += direction[axis] / dirLength * centerDistance;
+      }
+    }
+
+    LightBounds bounds;
+    if (computeLightBounds_(center, radius, bounds)) {
+      bounds.lightIndex = i;
+      m_lightBounds.push_back(bounds);
+    }
+  }
+
+  // a slice is written only by its own job, so the lists need no synchronization
+  g_parallelFor(s_clusterCountZ, 1, [this](uint32_t begin, uint32_t end) {
+    for (uint32_t slice = begin; slice < end; ++slice) {
+      assignSlice_(slice);
+    }
+  });
+}
+
+void LightClusterGrid::assignSlice_(uint32_t slice) {
+  const uint32_t sliceBegin = slice * s_clusterCountX * s_clusterCountY;
+  const uint32_t sliceEnd   = sliceBegin + s_clusterCountX * s_clusterCountY;
+
+  for (uint32_t cluster = sliceBegin; cluster < sliceEnd; ++cluster) {
+    m_clusterLights[cluster].clear();
+  }
+
+  auto assignRange = [this, slice](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      const auto& light = m_lightBounds[i];
+      if (slice < light.minZ || slice > light.maxZ) {
+        continue;
+      }
+
+      for (uint32_t y = light.minY; y <= light.maxY; ++y) {
+        const uint32_t rowBegin = (slice * s_clusterCountY + y) * s_clusterCountX;
+
+        // whole batches from the batch of minX, the test is exact so the extra clusters don't add false positives
+        for (uint32_t x = light.minX - light.minX % CLUSTER_BATCH; x <= light.maxX; x += CLUSTER_BATCH) {
+          const uint32_t first = rowBegin + x;
+
+          int mask = testSphere4(&m_clusterMinX[first],
+                                 &m_clusterMinY[first],
+                                 &m_clusterMinZ[first],
+                                 &m_clusterMaxX[first],
+                                 &m_clusterMaxY[first],
+                                 &m_clusterMaxZ[first],
+                                 light.center,
+                                 light.radius);
+          for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) {
+              m_clusterLights[first + lane].push_back(light.lightIndex);
+            }
+          }
+        }
+      }
+    }
+  };
+
+  assignRange(0, m_pointLightBoundsCount);
+  for (uint32_t cluster = sliceBegin; cluster < sliceEnd; ++cluster) {
+    m_clusterPointCounts[cluster] = static_cast<uint32_t>(m_clusterLights[cluster].size());
+  }
+  assignRange(m_pointLightBoundsCount, static_cast<uint32_t>(m_lightBounds.size()));
+}
+
+void LightClusterGrid::packLists_() {
+  m_clusters.resize(s_clusterCount);
+  m_lightIndices.clear();
+
+  for (uint32_t cluster = 0; cluster < s_clusterCount; ++cluster) {
+    const auto& lights = m_clusterLights[cluster];
+
+    auto& data           = m_clusters[cluster];
+    data.offset          = static_cast<uint32_t>(m_lightIndices.size());
+    data.pointLightCount = m_clusterPointCounts[cluster];
+    data.spotLightCount  = static_cast<uint32_t>(lights.size()) - m_clusterPointCounts[cluster];
+
+    m_lightIndices.insert(m_lightIndices.end(), lights.begin(), lights.end());
+  }
+}
+
+void LightClusterGrid::fillSingleCluster_(const LightSystem* lightSystem) {
+  m_clusters.assign(s_clusterCount, ClusterData{});
+  m_lightIndices.clear();
+
+  const uint32_t pointLightCount = lightSystem ? lightSystem->getPointLightCount() : 0;
+  const uint32_t spotLightCount  = lightSystem ? lightSystem->getSpotLightCount() : 0;
+
+  for (uint32_t i = 0; i < pointLightCount; ++i) {
+    m_lightIndices.push_back(i);
+  }
+  for (uint32_t i = 0; i < spotLightCount; ++i) {
+    m_lightIndices.push_back(i);
+  }
+
+  m_clusters[0].pointLightCount = pointLightCount;
+  m_clusters[0].spotLightCount  = spotLightCount;
+}
+
+void LightClusterGrid::uploadLists_(FrameData& frame) {
+  using rhi::BufferCreateFlag;
+
+  ensureCapacity_(frame.clusters,
+                  s_clusterCount,
+                  sizeof(ClusterData),
+                  BufferCreateFlag::ShaderResource,
+                  rhi::BufferType::Dynamic,
+                  "light_clusters");
+  ensureCapacity_(frame.lightIndices,
+                  static_cast<uint32_t>(m_lightIndices.size()),
+                  sizeof(uint32_t),
+                  BufferCreateFlag::ShaderResource,
+                  rhi::BufferType::Dynamic,
+                  "light_cluster_indices");
+
+  m_device->updateBuffer(frame.clusters.buffer, m_clusters.data(), m_clusters.size() * sizeof(ClusterData));
+  if (!m_lightIndices.empty()) {
+    m_device->updateBuffer(frame.lightIndices.buffer, m_lightIndices.data(), m_lightIndices.size() * sizeof(uint32_t));
+  }
+
+  updateDescriptorSet_(frame, frame.clusters.buffer, frame.lightIndices.buffer);
+}
+
+bool LightClusterGrid::prepareCompute_(FrameData& frame, const LightSystem& lightSystem) {
+  if (!m_pipeline) {
+    return false;
+  }
+
+  // a light type without lights has no buffer yet, the shader never reads it (its count is 0)
+  rhi::Buffer* pointLights = lightSystem.getPointLightBuffer();
+  rhi::Buffer* spotLights  = lightSystem.getSpotLightBuffer();
+  if (!pointLights && !spotLights) {
+    return false;
+  }
+  pointLights = pointLights ? pointLights : spotLights;
+  spotLights  = spotLights ? spotLights : pointLights;
+
+  using rhi::BufferCreateFlag;
+
+  bool buffersReplaced = !frame.computeDescriptorSet;
+
+  buffersReplaced |= ensureCapacity_(frame.computeClusters,
+                                     s_clusterCount,
+                                     sizeof(ClusterData),
+                                     BufferCreateFlag::Uav | BufferCreateFlag::ShaderResource,
+                                     rhi::BufferType::Static,
+                                     "light_clusters_compute");
+  buffersReplaced |= ensureCapacity_(frame.computeLightIndices,
+                                     s_clusterCount * s_maxLightsPerCluster,
+                                     sizeof(uint32_t),
+                                     BufferCreateFlag::Uav | BufferCreateFlag::ShaderResource,
+                                     rhi::BufferType::Static,
+                                     "light_cluster_indices_compute");
+  buffersReplaced |= pointLights != frame.boundPointLights || spotLights != frame.boundSpotLights;
+
+  if (buffersReplaced) {
+    if (!frame.computeDescriptorSet) {
+      std::string setKey         = "light_cluster_compute_descriptor_set_" + std::to_string(m_frameIndex);
+      auto descriptorSet         = m_device->createDescriptorSet(m_computeDescriptorSetLayout);
+      frame.computeDescriptorSet = m_resourceManager->addDescriptorSet(std::move(descriptorSet), setKey);
+
+      // the constants are allocated per frame, the set is bound with their offset
+      frame.computeDescriptorSet->setUniformBuffer(
+          COMPUTE_CONSTANTS_BINDING, m_constantAllocator->getBuffer(), 0, sizeof(ClusterConstants));
+    }
+
+    frame.computeDescriptorSet->setStorageBuffer(COMPUTE_POINT_LIGHTS_BINDING, pointLights);
+    frame.computeDescriptorSet->setStorageBuffer(COMPUTE_SPOT_LIGHTS_BINDING, spotLights);
+    frame.computeDescriptorSet->setStorageBuffer(COMPUTE_CLUSTERS_BINDING, frame.computeClusters.buffer);
+    frame.computeDescriptorSet->setStorageBuffer(COMPUTE_LIGHT_INDICES_BINDING, frame.computeLightIndices.buffer);
+
+    frame.boundPointLights = pointLights;
+    frame.boundSpotLights  = spotLights;
+  }
+
+  updateDescriptorSet_(frame, frame.computeClusters.buffer, frame.computeLightIndices.buffer);
+  return true;
+}
+
+void LightClusterGrid::updateDescriptorSet_(FrameData& frame, rhi::Buffer* clusters, rhi::Buffer* lightIndices) {
+  if (!frame.descriptorSet) {
+    std::string setKey  = "light_cluster_descriptor_set_" + std::to_string(m_frameIndex);
+    auto descriptorSet  = m_device->createDescriptorSet(m_descriptorSetLayout);
+    frame.descriptorSet = m_resourceManager->addDescriptorSet(std::move(descriptorSet), setKey);
+
+    frame.descriptorSet->setUniformBuffer(
+        CONSTANTS_BINDING, m_constantAllocator->getBuffer(), 0, sizeof(ClusterConstants));
+  }
+
+  // switching between the CPU and the compute lists rebinds the buffers
+  if (clusters != frame.boundClusters) {
+    frame.descriptorSet->setStorageBuffer(CLUSTERS_BINDING, clusters);
+    frame.boundClusters = clusters;
+  }
+  if (lightIndices != frame.boundLightIndices) {
+    frame.descriptorSet->setStorageBuffer(LIGHT_INDICES_BINDING, lightIndices);
+    frame.boundLightIndices = lightIndices;
+  }
+}
+
+bool LightClusterGrid::ensureCapacity_(FrameBuffer&          frameBuffer,
+                                       uint32_t              elementCount,
+                                       uint32_t              stride,
+                                       rhi::BufferCreateFlag createFlags,
+                                       rhi::BufferType       type,
+                                       const std::string&    name) {
+  if (frameBuffer.buffer && elementCount <= frameBuffer.capacity) {
+    return false;
+  }
+
+  uint32_t newCapacity = std::max(static_cast<uint32_t>(elementCount * 1.5), MIN_CAPACITY);
+
+  // the buffer of this frame isn't used by the GPU anymore, so it can be replaced under the same key
+  std::string bufferKey = name + "_" + std::to_string(m_frameIndex);
+
+  rhi::BufferDesc bufferDesc;
+  bufferDesc.size        = static_cast<uint64_t>(newCapacity) * stride;
+  bufferDesc.createFlags = createFlags;
+  bufferDesc.type        = type;
+  bufferDesc.stride      = stride;
+  bufferDesc.debugName   = bufferKey;
+
+  auto buffer          = m_device->createBuffer(bufferDesc);
+  frameBuffer.buffer   = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
+  frameBuffer.capacity = newCapacity;
+  return true;
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
@@ -0,0 +1,231 @@
+#ifndef ARISE_LIGHT_CLUSTER_GRID_H
+#define ARISE_LIGHT_CLUSTER_GRID_H
+
+#include "gfx/rhi/common/rhi_types.h"
+
+#include <math_library/matrix.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace arise {
+class LightSystem;
+}  // namespace arise
+
+namespace arise::gfx::rhi {
+class Buffer;
+class CommandBuffer;
+class ComputePipeline;
+class DescriptorSet;
+class DescriptorSetLayout;
+class Device;
+class ShaderManager;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+class FrameConstantAllocator;
+class RenderResourceManager;
+
+/**
+ * Clustered forward light culling: the view frustum is split into a grid of clusters (screen tiles times exponential
+ * depth slices) and every cluster gets the list of point and spot lights whose bounding sphere touches it. The pixel
+ * shader finds its cluster from the screen position and view depth and shades only the lights of that list, instead of
+ * every light of the scene.
+ *
+ * The lists are built on the CPU (depth slices in parallel, clusters tested four at a time with SSE) and packed into
+ * one index buffer, or by a compute shader into fixed-size lists (s_maxLightsPerCluster, the rest is dropped).
+ * Directional lights affect every pixel and aren't clustered.
+ *
+ * Without a perspective camera the grid degenerates to a single cluster holding all lights.
+ *
+ * The buffers and the sets are per frame in flight.
+ */
+class LightClusterGrid {
+  public:
+  static constexpr uint32_t s_clusterCountX = 16;
+  static constexpr uint32_t s_clusterCountY = 9;
+  static constexpr uint32_t s_clusterCountZ = 24;
+  static constexpr uint32_t s_clusterCount  = s_clusterCountX * s_clusterCountY * s_clusterCountZ;
+
+  // capacity of a cluster list built by the compute shader
+  static constexpr uint32_t s_maxLightsPerCluster = 128;
+
+  void initialize(rhi::Device*            device,
+                  RenderResourceManager*  resourceManager,
+                  rhi::ShaderManager*     shaderManager,
+                  FrameConstantAllocator* constantAllocator,
+                  uint32_t                framesCount);
+
+  /**
+   * Builds the lists of the frame (on the CPU, or prepares the compute dispatch when useCompute is set and the compute
+   * pipeline is available).
+   *
+   * @param hasCamera false when view and projection aren't valid, the lights then go to a single cluster
+   */
+  void build(uint32_t                frameIndex,
+             const math::Matrix4f<>& view,
+             const math::Matrix4f<>& projection,
+             bool                    hasCamera,
+             float                   screenWidth,
+             float                   screenHeight,
+             const LightSystem*      lightSystem,
+             bool                    useCompute);
+
+  /**
+   * Records the compute variant of the build, does nothing when the lists were built on the CPU. Must be called outside
+   * of a render pass, before the draws that read the clusters.
+   */
+  void dispatch(rhi::CommandBuffer* commandBuffer);
+
+  void clear();
+
+  // Fragment stage set: cluster constants (dynamic uniform buffer), clusters and light indices
+  rhi::DescriptorSetLayout* getDescriptorSetLayout() const { return m_descriptorSetLayout; }
+
+  // set of the frame passed to the last build(), bind it with getConstantsOffset() as the dynamic offset
+  rhi::DescriptorSet* getDescriptorSet() const { return m_frames[m_frameIndex].descriptorSet; }
+  uint32_t            getConstantsOffset() const { return m_constantsOffset; }
+
+  // Lights assigned to the clusters by the last CPU build (a light is counted once per cluster it touches)
+  uint32_t getLightIndexCount() const { return static_cast<uint32_t>(m_lightIndices.size()); }
+
+  private:
+  // layout matches ClusterConstants in base_pass/shader.ps.hlsl and light_culling/build_clusters.cs.hlsl
+  struct ClusterConstants {
+    float    viewRows[4][4];
+    float    viewDepthPlane[4];  // dot with the world position gives the view depth
+    float    screenSize[2];
+    float    projectionScale[2];
+    uint32_t clusterCount[3];
+    uint32_t maxLightsPerCluster;
+    float    zNear;
+    float    zFar;
+    float    sliceScale;
+    float    sliceBias;
+    uint32_t pointLightCount;
+    uint32_t spotLightCount;
+    float    projectionOffset[2];
+  };
+
+  // layout matches the uint4 of the clusters buffer: first light index, point light count, spot light count
+  struct ClusterData {
+    uint32_t offset          = 0;
+    uint32_t pointLightCount = 0;
+    uint32_t spotLightCount  = 0;
+    uint32_t padding         = 0;
+  };
+
+  // view space bounding sphere of a light and the range of clusters it may touch
+  struct LightBounds {
+    float    center[3];
+    float    radius;
+    uint32_t lightIndex;  // in the point or spot light buffer
+    uint32_t minX, maxX;
+    uint32_t minY, maxY;
+    uint32_t minZ, maxZ;
+  };
+
+  struct FrameBuffer {
+    rhi::Buffer* buffer   = nullptr;
+    uint32_t     capacity = 0;
+  };
+
+  struct FrameData {
+    FrameBuffer clusters;  // CPU built lists
+    FrameBuffer lightIndices;
+    FrameBuffer computeClusters;  // written by the compute shader
+    FrameBuffer computeLightIndices;
+
+    rhi::DescriptorSet* descriptorSet        = nullptr;
+    rhi::DescriptorSet* computeDescriptorSet = nullptr;
+
+    // buffers currently written to the sets, a set is updated only when they change
+    rhi::Buffer* boundClusters     = nullptr;
+    rhi::Buffer* boundLightIndices = nullptr;
+    rhi::Buffer* boundPointLights  = nullptr;
+    rhi::Buffer* boundSpotLights   = nullptr;
+  };
+
+  void createDescriptorSetLayouts_();
+  void createPipeline_();
+
+  // Fills the constants from the camera, false when the projection can't be clustered (the single cluster is used)
+  bool setupGrid_(const math::Matrix4f<>& view,
+                  const math::Matrix4f<>& projection,
+                  bool                    hasCamera,
+                  float                   screenWidth,
+                  float                   screenHeight);
+
+  // View space bounds of the clusters, recomputed only when the projection changes
+  void updateClusterBounds_();
+
+  bool computeLightBounds_(const float worldCenter[3], float radius, LightBounds& bounds) const;
+
+  void assignLights_(const LightSystem& lightSystem);
+  void assignSlice_(uint32_t slice);
+  void packLists_();
+
+  // All lights in the first cluster, for the grid of a single cluster
+  void fillSingleCluster_(const LightSystem* lightSystem);
+
+  void uploadLists_(FrameData& frame);
+  bool prepareCompute_(FrameData& frame, const LightSystem& lightSystem);
+
+  void updateDescriptorSet_(FrameData& frame, rhi::Buffer* clusters, rhi::Buffer* lightIndices);
+
+  /**
+   * Replaces the buffer when it's smaller than elementCount. Returns true if the buffer was replaced.
+   */
+  bool ensureCapacity_(FrameBuffer&          frameBuffer,
+                       uint32_t              elementCount,
+                       uint32_t              stride,
+                       rhi::BufferCreateFlag createFlags,
+                       rhi::BufferType       type,
+                       const std::string&    name);
+
+  const std::string m_computeShaderPath_ = "assets/shaders/light_culling/build_clusters.cs.hlsl";
+
+  rhi::Device*            m_device            = nullptr;
+  RenderResourceManager*  m_resourceManager   = nullptr;
+  rhi::ShaderManager*     m_shaderManager     = nullptr;
+  FrameConstantAllocator* m_constantAllocator = nullptr;
+
+  rhi::DescriptorSetLayout* m_descriptorSetLayout        = nullptr;
+  rhi::DescriptorSetLayout* m_computeDescriptorSetLayout = nullptr;
+  rhi::ComputePipeline*     m_pipeline                   = nullptr;
+
+  std::vector<FrameData> m_frames;
+  uint32_t               m_frameIndex = 0;
+
+  ClusterConstants m_constants       = {};
+  uint32_t         m_constantsOffset = 0;
+  bool             m_dispatchPending = false;
+
+  // the projection the cluster bounds were computed for
+  float m_boundsKey[6] = {};
+
+  // view space bounds of the clusters, structure of arrays indexed by (z * countY + y) * countX + x
+  std::vector<float> m_clusterMinX, m_clusterMinY, m_clusterMinZ;
+  std::vector<float> m_clusterMaxX, m_clusterMaxY, m_clusterMaxZ;
+
+  // lights inside of the grid, point lights first
+  std::vector<LightBounds> m_lightBounds;
+  uint32_t                 m_pointLightBoundsCount = 0;
+
+  // per cluster lists, written by the job of the cluster's slice
+  std::vector<std::vector<uint32_t>> m_clusterLights;
+  std::vector<uint32_t>              m_clusterPointCounts;
+
+  std::vector<ClusterData> m_clusters;
+  std::vector<uint32_t>    m_lightIndices;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_LIGHT_CLUSTER_GRID_H
@@ -0,0 +1,326 @@
+#include "gfx/renderer/material_table.h"
+
+#include "gfx/renderer/render_resource_manager.h"
+#include "gfx/rhi/interface/buffer.h"
+#include "gfx/rhi/interface/descriptor.h"
+#include "gfx/rhi/interface/device.h"
+#include "profiler/profiler.h"
+#include "utils/logger/global_logger.h"
+
+#include <algorithm>
+#include <string>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+namespace {
+
+constexpr uint32_t MIN_CAPACITY = 64;
+
+// bindings of the material set, the register numbers in base_pass/shader.ps.hlsl
+constexpr uint32_t MATERIALS_BINDING = 0;
+constexpr uint32_t TEXTURES_BINDING  = 1;
+
+}  // namespace
+
+void MaterialTable::initialize(rhi::Device*           device,
+                               RenderResourceManager* resourceManager,
+                               uint32_t               framesCount,
+                               const DefaultTextures& defaultTextures) {
+  m_device          = device;
+  m_resourceManager = resourceManager;
+  m_defaultTextures = defaultTextures;
+
+  m_frames.clear();
+  m_frames.resize(std::max(framesCount, 1u));
+  m_frameIndex = 0;
+
+  clear();
+
+  createDescriptorSetLayout_();
+}
+
+uint32_t MaterialTable::addMaterial(Material* material) {
+  if (!material) {
+    return s_invalidIndex;
+  }
+
+  auto it = m_materialIndices.find(material);
+  if (it != m_materialIndices.end()) {
+    return it->second;
+  }
+
+  uint32_t index;
+  if (!m_freeMaterialIndices.empty()) {
+    index = m_freeMaterialIndices.back();
+    m_freeMaterialIndices.pop_back();
+  } else {
+    index = static_cast<uint32_t>(m_materials.size());
+    resetEntry_(m_materials.emplace_back());
+  }
+
+  auto& entry    = m_materials[index];
+  entry.material = material;
+  resolveTextures_(entry);
+
+  m_materialIndices[material] = index;
+  return index;
+}
+
+void MaterialTable::retainMaterials(const std::unordered_set<Material*>& activeMaterials) {
+  for (auto it = m_materialIndices.begin(); it != m_materialIndices.end();) {
+    if (activeMaterials.contains(it->first)) {
+      ++it;
+      continue;
+    }
+
+    // the buffers of the frames in flight keep their copy of the parameters, the index can be reused right away
+    auto& entry = m_materials[it->second];
+    releaseTextures_(entry);
+    resetEntry_(entry);
+
+    m_freeMaterialIndices.push_back(it->second);
+    it = m_materialIndices.erase(it);
+  }
+}
+
+uint32_t MaterialTable::getMaterialIndex(Material* material) const {
+  auto it = m_materialIndices.find(material);
+  return it != m_materialIndices.end() ? it->second : s_invalidIndex;
+}
+
+void MaterialTable::upload(uint32_t frameIndex) {
+  CPU_ZONE_NC("MaterialTable::upload", color::YELLOW);
+
+  m_frameIndex = frameIndex % m_frames.size();
+  auto& frame  = m_frames[m_frameIndex];
+
+  m_gpuData.resize(m_materials.size());
+  for (size_t i = 0; i < m_materials.size(); ++i) {
+    auto& entry = m_materials[i];
+    auto& data  = m_gpuData[i];
+
+    if (!entry.material) {
+      data = MaterialGpuData{};
+      for (size_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; ++slot) {
+        data.textureIndices[slot] = static_cast<uint32_t>(slot);
+      }
+      continue;
+    }
+
+    const auto& materialData = entry.material->data;
+    if (entry.textures != materialData.textures) {
+      resolveTextures_(entry);
+    }
+
+    data.baseColor[0] = materialData.baseColor.x();
+    data.baseColor[1] = materialData.baseColor.y();
+    data.baseColor[2] = materialData.baseColor.z();
+    data.baseColor[3] = materialData.baseColor.w();
+    data.metallic     = materialData.metallic;
+    data.roughness    = materialData.roughness;
+    data.opacity      = materialData.opacity;
+    std::copy(entry.textureSlots.begin(), entry.textureSlots.end(), data.textureIndices);
+  }
+
+  const bool bufferReplaced = ensureCapacity_(frame, static_cast<uint32_t>(m_gpuData.size()));
+  updateDescriptorSet_(frame, bufferReplaced);
+
+  if (!m_gpuData.empty()) {
+    m_device->updateBuffer(frame.buffer, m_gpuData.data(), m_gpuData.size() * sizeof(MaterialGpuData));
+  }
+}
+
+void MaterialTable::clear() {
+  // the sets keep pointing to the textures of the removed materials, they are reset to the defaults on the next use
+  for (uint32_t slot = MATERIAL_TEXTURE_COUNT; slot < m_textureSlots.size(); ++slot) {
+    if (m_textureSlots[slot].texture) {
+      markTextureSlotDirty_(slot);
+    }
+  }
+
+  m_materials.clear();
+  m_freeMaterialIndices.clear();
+  m_materialIndices.clear();
+  m_gpuData.clear();
+
+  m_textureSlots.assign(MATERIAL_TEXTURE_COUNT, TextureSlot{});
+  for (size_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; ++slot) {
+    m_textureSlots[slot].texture = m_defaultTextures[slot];
+  }
+  m_freeTextureSlots.clear();
+  m_textureSlotIndices.clear();
+}
+
+void MaterialTable::createDescriptorSetLayout_() {
+  rhi::DescriptorSetLayoutDesc layoutDesc;
+
+  rhi::DescriptorSetLayoutBindingDesc materialsBindingDesc;
+  materialsBindingDesc.binding    = MATERIALS_BINDING;
+  materialsBindingDesc.type       = rhi::ShaderBindingType::BufferSrv;
+  materialsBindingDesc.stageFlags = rhi::ShaderStageFlag::Fragment;
+  layoutDesc.bindings.push_back(materialsBindingDesc);
+
+  rhi::DescriptorSetLayoutBindingDesc texturesBindingDesc;
+  texturesBindingDesc.binding         = TEXTURES_BINDING;
+  texturesBindingDesc.type            = rhi::ShaderBindingType::TextureSrv;
+  texturesBindingDesc.descriptorCount = s_maxTextureCount;
+  texturesBindingDesc.stageFlags      = rhi::ShaderStageFlag::Fragment;
+  layoutDesc.bindings.push_back(texturesBindingDesc);
+
+  auto layout           = m_device->createDescriptorSetLayout(layoutDesc);
+  m_descriptorSetLayout = m_resourceManager->addDescriptorSetLayout(std::move(layout), "material_table_layout");
+}
+
+void MaterialTable::resetEntry_(MaterialEntry& entry) {
+  entry.material = nullptr;
+  entry.textures = {};
+  for (size_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; ++slot) {
+    entry.textureSlots[slot] = static_cast<uint32_t>(slot);
+  }
+}
+
+void MaterialTable::resolveTextures_(MaterialEntry& entry) {
+  for (size_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; ++slot) {
+    auto texture = entry.material->data.textures[slot];
+    if (texture == entry.textures[slot]) {
+      continue;
+    }
+
+    releaseTextureSlot_(entry.textureSlots[slot]);
+    entry.textureSlots[slot] = acquireTextureSlot_(texture, static_cast<MaterialTexture>(slot));
+    entry.textures[slot]     = texture;
+  }
+}
+
+void MaterialTable::releaseTextures_(MaterialEntry& entry) {
+  for (auto slot : entry.textureSlots) {
+    releaseTextureSlot_(slot);
+  }
+}
+
+uint32_t MaterialTable::acquireTextureSlot_(rhi::Texture* texture, MaterialTexture materialTexture) {
+  const auto defaultSlot = static_cast<uint32_t>(materialTexture);
+  if (!texture) {
+    return defaultSlot;
+  }
+
+  auto it = m_textureSlotIndices.find(texture);
+  if (it != m_textureSlotIndices.end()) {
+    ++m_textureSlots[it->second].refCount;
+    return it->second;
+  }
+
+  uint32_t slot;
+  if (!m_freeTextureSlots.empty()) {
+    slot = m_freeTextureSlots.back();
+    m_freeTextureSlots.pop_back();
+  } else if (m_textureSlots.size() < s_maxTextureCount) {
+    slot = static_cast<uint32_t>(m_textureSlots.size());
+    m_textureSlots.emplace_back();
+  } else {
+    GlobalLogger::Log(LogLevel::Warning,
+                      "Material texture table is full (" + std::to_string(s_maxTextureCount)
+                          + " textures), using the default " + g_getMaterialTextureName(materialTexture) + " texture");
+    return defaultSlot;
+  }
+
+  m_textureSlots[slot]          = {texture, 1};
+  m_textureSlotIndices[texture] = slot;
+  markTextureSlotDirty_(slot);
+  return slot;
+}
+
+void MaterialTable::releaseTextureSlot_(uint32_t slot) {
+  // default textures are shared by all materials and never released
+  if (slot < MATERIAL_TEXTURE_COUNT || slot >= m_textureSlots.size()) {
+    return;
+  }
+
+  auto& textureSlot = m_textureSlots[slot];
+  if (textureSlot.refCount == 0 || --textureSlot.refCount > 0) {
+    return;
+  }
+
+  // the texture may be destroyed with its material, the slot is pointed to a default texture in every set
+  m_textureSlotIndices.erase(textureSlot.texture);
+  textureSlot.texture = nullptr;
+  m_freeTextureSlots.push_back(slot);
+  markTextureSlotDirty_(slot);
+}
+
+void MaterialTable::markTextureSlotDirty_(uint32_t slot) {
+  for (auto& frame : m_frames) {
+    // a set that doesn't exist yet gets all slots when it's created
+    if (frame.descriptorSet) {
+      frame.dirtyTextureSlots.push_back(slot);
+    }
+  }
+}
+
+void MaterialTable::updateDescriptorSet_(FrameData& frame, bool bufferReplaced) {
+  // every element of the array must be valid, empty slots show the default albedo texture
+  auto getSlotTexture = [this](uint32_t slot) {
+    if (slot < m_textureSlots.size() && m_textureSlots[slot].texture) {
+      return m_textureSlots[slot].texture;
+    }
+    return m_defaultTextures[static_cast<size_t>(MaterialTexture::Albedo)];
+  };
+
+  if (!frame.descriptorSet) {
+    std::string setKey  = "material_table_descriptor_set_" + std::to_string(m_frameIndex);
+    auto descriptorSet  = m_device->createDescriptorSet(m_descriptorSetLayout);
+    frame.descriptorSet = m_resourceManager->addDescriptorSet(std::move(descriptorSet), setKey);
+
+    for (uint32_t slot = 0; slot < s_maxTextureCount; ++slot) {
+      frame.descriptorSet->setTextureArrayElement(TEXTURES_BINDING, slot, getSlotTexture(slot));
+    }
+    frame.dirtyTextureSlots.clear();
+    bufferReplaced = true;
+  }
+
+  if (bufferReplaced) {
+    frame.descriptorSet->setStorageBuffer(MATERIALS_BINDING, frame.buffer);
+  }
+
+  if (frame.dirtyTextureSlots.empty()) {
+    return;
+  }
+
+  auto& slots = frame.dirtyTextureSlots;
+  std::sort(slots.begin(), slots.end());
+  slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+
+  for (auto slot : slots) {
+    frame.descriptorSet->setTextureArrayElement(TEXTURES_BINDING, slot, getSlotTexture(slot));
+  }
+  slots.clear();
+}
+
+bool MaterialTable::ensureCapacity_(FrameData& frame, uint32_t materialCount) {
+  if (frame.buffer && materialCount <= frame.capacity) {
+    return false;
+  }
+
+  uint32_t newCapacity = std::max(static_cast<uint32_t>(materialCount * 1.5), MIN_CAPACITY);
+
+  // the buffer of this frame isn't used by the GPU anymore, so it can be replaced under the same key
+  std::string bufferKey = "material_table_buffer_" + std::to_string(m_frameIndex);
+
+  rhi::BufferDesc bufferDesc;
+  bufferDesc.size        = static_cast<uint64_t>(newCapacity) * sizeof(MaterialGpuData);
+  bufferDesc.createFlags = rhi::BufferCreateFlag::ShaderResource;
+  bufferDesc.type        = rhi::BufferType::Dynamic;
+  bufferDesc.stride      = sizeof(MaterialGpuData);
+  bufferDesc.debugName   = bufferKey;
+
+  auto buffer    = m_device->createBuffer(bufferDesc);
+  frame.buffer   = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
+  frame.capacity = newCapacity;
+  return true;
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
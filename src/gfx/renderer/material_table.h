@@ -0,0 +1,149 @@
+#ifndef ARISE_MATERIAL_TABLE_H
+#define ARISE_MATERIAL_TABLE_H
+
+#include "ecs/components/material.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace arise::gfx::rhi {
+class Buffer;
+class DescriptorSet;
+class DescriptorSetLayout;
+class Device;
+class Texture;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+class RenderResourceManager;
+
+/**
+ * Bindless material storage: the parameters of every material in one structured buffer and the textures of all
+ * materials in one texture array, both in a single descriptor set that is bound once per pass. A draw selects its
+ * material with an index, so there are no per-material descriptor sets.
+ *
+ * Materials get a stable index for their lifetime, textures get a slot in the array (shared by the materials that use
+ * the same texture). Missing textures point to the default texture of their MaterialTexture slot.
+ *
+ * The buffer and the set are per frame in flight. Parameters are repacked every frame (editor changes show up
+ * immediately), texture slot changes are written to each frame's set the next time that frame comes around - a set is
+ * never written while the GPU may still read it.
+ */
+class MaterialTable {
+  public:
+  // size of the texture array, must match MAX_MATERIAL_TEXTURES in the shaders
+  static constexpr uint32_t s_maxTextureCount = 1024;
+  static constexpr uint32_t s_invalidIndex    = std::numeric_limits<uint32_t>::max();
+
+  using DefaultTextures = std::array<rhi::Texture*, MATERIAL_TEXTURE_COUNT>;
+
+  void initialize(rhi::Device*           device,
+                  RenderResourceManager* resourceManager,
+                  uint32_t               framesCount,
+                  const DefaultTextures& defaultTextures);
+
+  uint32_t addMaterial(Material* material);
+
+  // Materials of the current models, the other ones are removed (their indices and texture slots are reused)
+  void retainMaterials(const std::unordered_set<Material*>& activeMaterials);
+
+  /**
+   * @return Index of the material in the GPU table, s_invalidIndex if the material wasn't added
+   */
+  uint32_t getMaterialIndex(Material* material) const;
+
+  // Packs the parameters and writes the buffer and the changed texture slots of the frame
+  void upload(uint32_t frameIndex);
+
+  void clear();
+
+  rhi::DescriptorSetLayout* getDescriptorSetLayout() const { return m_descriptorSetLayout; }
+
+  // set of the frame passed to the last upload()
+  rhi::DescriptorSet* getDescriptorSet() const { return m_frames[m_frameIndex].descriptorSet; }
+
+  uint32_t getMaterialCount() const { return static_cast<uint32_t>(m_materialIndices.size()); }
+
+  // Textures referenced by the materials, without the defaults
+  uint32_t getTextureCount() const { return static_cast<uint32_t>(m_textureSlotIndices.size()); }
+
+  private:
+  // layout matches MaterialData in base_pass/shader.ps.hlsl
+  struct MaterialGpuData {
+    float    baseColor[4]                           = {1.0f, 1.0f, 1.0f, 1.0f};
+    float    metallic                               = 0.0f;
+    float    roughness                              = 1.0f;
+    float    opacity                                = 1.0f;
+    uint32_t textureIndices[MATERIAL_TEXTURE_COUNT] = {};
+    uint32_t padding[2]                             = {};
+  };
+
+  struct MaterialEntry {
+    Material*                                         material     = nullptr;
+    std::array<rhi::Texture*, MATERIAL_TEXTURE_COUNT> textures     = {};  // the textures the slots were resolved for
+    std::array<uint32_t, MATERIAL_TEXTURE_COUNT>      textureSlots = {};
+  };
+
+  struct TextureSlot {
+    rhi::Texture* texture  = nullptr;
+    uint32_t      refCount = 0;
+  };
+
+  struct FrameData {
+    rhi::Buffer*          buffer        = nullptr;
+    uint32_t              capacity      = 0;
+    rhi::DescriptorSet*   descriptorSet = nullptr;
+    std::vector<uint32_t> dirtyTextureSlots;
+  };
+
+  void createDescriptorSetLayout_();
+
+  void resetEntry_(MaterialEntry& entry);
+
+  // Points the texture slots of the entry to the current textures of its material
+  void resolveTextures_(MaterialEntry& entry);
+  void releaseTextures_(MaterialEntry& entry);
+
+  uint32_t acquireTextureSlot_(rhi::Texture* texture, MaterialTexture materialTexture);
+  void     releaseTextureSlot_(uint32_t slot);
+  void     markTextureSlotDirty_(uint32_t slot);
+
+  // Creates the set of the frame (all slots are written) or writes the slots changed since its last use
+  void updateDescriptorSet_(FrameData& frame, bool bufferReplaced);
+
+  bool ensureCapacity_(FrameData& frame, uint32_t materialCount);
+
+  rhi::Device*           m_device          = nullptr;
+  RenderResourceManager* m_resourceManager = nullptr;
+
+  rhi::DescriptorSetLayout* m_descriptorSetLayout = nullptr;
+
+  DefaultTextures m_defaultTextures = {};
+
+  std::vector<MaterialEntry>              m_materials;  // by material index, freed entries have no material
+  std::vector<uint32_t>                   m_freeMaterialIndices;
+  std::unordered_map<Material*, uint32_t> m_materialIndices;
+
+  // the first MATERIAL_TEXTURE_COUNT slots hold the default textures and are never released
+  std::vector<TextureSlot>                    m_textureSlots;
+  std::vector<uint32_t>                       m_freeTextureSlots;
+  std::unordered_map<rhi::Texture*, uint32_t> m_textureSlotIndices;
+
+  std::vector<MaterialGpuData> m_gpuData;
+
+  std::vector<FrameData> m_frames;
+  uint32_t               m_frameIndex = 0;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_MATERIAL_TABLE_H
@@ -0,0 +1,132 @@
+#include "gfx/renderer/parallel_command_recorder.h"
+
+#include "gfx/rhi/interface/command_buffer.h"
+#include "gfx/rhi/interface/device.h"
+#include "profiler/profiler.h"
+#include "utils/job/job_system.h"
+#include "utils/logger/global_logger.h"
+#include "utils/service/service_locator.h"
+
+#include <algorithm>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+void ParallelCommandRecorder::initialize(rhi::Device* device, uint32_t framesCount) {
+  clear();
+
+  m_device      = device;
+  m_framesCount = std::max(framesCount, 1u);
+  m_frameIndex  = 0;
+}
+
+void ParallelCommandRecorder::beginFrame(uint32_t frameIndex) {
+  m_frameIndex = frameIndex % m_framesCount;
+
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  for (auto& [threadId, thread] : m_threads) {
+    thread->usedCounts[m_frameIndex] = 0;
+  }
+}
+
+uint32_t ParallelCommandRecorder::getRangeCount(uint32_t drawCount) const {
+  // the calling thread records too while it waits for the workers
+  uint32_t threadCount = 1;
+  if (auto jobSystem = ServiceLocator::s_get<JobSystem>()) {
+    threadCount += jobSystem->getWorkerCount();
+  }
+
+  return std::clamp(drawCount / s_minDrawsPerRange, 1u, threadCount);
+}
+
+void ParallelCommandRecorder::record(rhi::CommandBuffer*   primary,
+                                     rhi::RenderPass*      renderPass,
+                                     rhi::Framebuffer*     framebuffer,
+                                     uint32_t              drawCount,
+                                     const RecordFunction& function) {
+  CPU_ZONE_NC("ParallelCommandRecorder::record", color::GREEN);
+
+  if (!primary || !m_device || drawCount == 0) {
+    return;
+  }
+
+  const uint32_t rangeCount = getRangeCount(drawCount);
+  const uint32_t rangeSize  = (drawCount + rangeCount - 1) / rangeCount;
+
+  m_rangeCommandBuffers.assign(rangeCount, nullptr);
+
+  auto recordRanges = [&](uint32_t begin, uint32_t end) {
+    for (uint32_t range = begin; range < end; ++range) {
+      CPU_ZONE_NC("Record Draw Range", color::GREEN);
+
+      const uint32_t firstDraw = std::min(range * rangeSize, drawCount);
+      const uint32_t lastDraw  = std::min(firstDraw + rangeSize, drawCount);
+      if (firstDraw == lastDraw) {
+        continue;
+      }
+
+      auto commandBuffer = acquireCommandBuffer_();
+      if (!commandBuffer) {
+        continue;
+      }
+
+      commandBuffer->beginSecondary(renderPass, framebuffer);
+      function(commandBuffer, firstDraw, lastDraw);
+      commandBuffer->end();
+
+      // every range writes only its own element
+      m_rangeCommandBuffers[range] = commandBuffer;
+    }
+  };
+
+  g_parallelFor(rangeCount, 1, recordRanges);
+
+  std::erase(m_rangeCommandBuffers, nullptr);
+  primary->executeCommands(m_rangeCommandBuffers);
+}
+
+void ParallelCommandRecorder::clear() {
+  std::lock_guard<std::mutex> lock(m_threadsMutex);
+  m_threads.clear();
+  m_rangeCommandBuffers.clear();
+}
+
+rhi::CommandBuffer* ParallelCommandRecorder::acquireCommandBuffer_() {
+  ThreadCommandBuffers* thread = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    auto&                       entry = m_threads[std::this_thread::get_id()];
+    if (!entry) {
+      entry = std::make_unique<ThreadCommandBuffers>();
+      entry->frames.resize(m_framesCount);
+      entry->usedCounts.assign(m_framesCount, 0);
+    }
+    thread = entry.get();
+  }
+
+  // only this thread touches its entry while the ranges are recorded
+  auto& commandBuffers = thread->frames[m_frameIndex];
+  auto& usedCount      = thread->usedCounts[m_frameIndex];
+
+  if (usedCount == commandBuffers.size()) {
+    // allocated from the command pool of the calling thread
+    rhi::CommandBufferDesc commandBufferDesc;
+    commandBufferDesc.primary = false;
+
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDesc);
+    if (!commandBuffer) {
+      GlobalLogger::Log(LogLevel::Error, "Failed to create secondary command buffer");
+      return nullptr;
+    }
+    commandBuffers.push_back(std::move(commandBuffer));
+  }
+
+  auto commandBuffer = commandBuffers[usedCount++].get();
+  commandBuffer->reset();
+  return commandBuffer;
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
@@ -0,0 +1,87 @@
+#ifndef ARISE_PARALLEL_COMMAND_RECORDER_H
+#define ARISE_PARALLEL_COMMAND_RECORDER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace arise::gfx::rhi {
+class CommandBuffer;
+class Device;
+class Framebuffer;
+class RenderPass;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+/**
+ * Records the draws of a render pass on the job system: the draws are split into ranges, every range is recorded into
+ * its own secondary command buffer (a bundle in DX12) and the primary executes them in the order of the ranges.
+ *
+ * Secondaries are allocated and recorded by the thread that uses them - Vulkan command pools are per thread (see
+ * CommandPoolManager) and a pool can't be used by two threads at once, so every thread keeps its own secondaries. They
+ * are kept per frame in flight and reused once the frame comes around again.
+ */
+class ParallelCommandRecorder {
+  public:
+  // Records the draws [begin, end) into a secondary that is already inside of the render pass
+  using RecordFunction = std::function<void(rhi::CommandBuffer* commandBuffer, uint32_t begin, uint32_t end)>;
+
+  // smaller ranges cost more to begin, execute and bind the state for than they save
+  static constexpr uint32_t s_minDrawsPerRange = 64;
+
+  void initialize(rhi::Device* device, uint32_t framesCount);
+
+  // The secondaries of the frame can be reused, its previous use finished on the GPU
+  void beginFrame(uint32_t frameIndex);
+
+  /**
+   * Number of ranges the draws are split into (at most one per thread of the job system), 1 means recording the draws
+   * directly into the primary is cheaper.
+   */
+  uint32_t getRangeCount(uint32_t drawCount) const;
+
+  /**
+   * Records the ranges in parallel and executes them from the primary. The primary must be inside of renderPass, begun
+   * with rhi::RenderPassContents::SecondaryCommandBuffers.
+   */
+  void record(rhi::CommandBuffer*   primary,
+              rhi::RenderPass*      renderPass,
+              rhi::Framebuffer*     framebuffer,
+              uint32_t              drawCount,
+              const RecordFunction& function);
+
+  // Destroys the secondaries, the GPU must not use them anymore
+  void clear();
+
+  private:
+  struct ThreadCommandBuffers {
+    std::vector<std::vector<std::unique_ptr<rhi::CommandBuffer>>> frames;
+    std::vector<uint32_t>                                          usedCounts;  // per frame
+  };
+
+  // A reset secondary of the calling thread for the current frame
+  rhi::CommandBuffer* acquireCommandBuffer_();
+
+  rhi::Device* m_device      = nullptr;
+  uint32_t     m_framesCount = 1;
+  uint32_t     m_frameIndex  = 0;
+
+  std::mutex                                                                 m_threadsMutex;
+  std::unordered_map<std::thread::id, std::unique_ptr<ThreadCommandBuffers>> m_threads;
+
+  // by range, null when the range failed to record
+  std::vector<rhi::CommandBuffer*> m_rangeCommandBuffers;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_PARALLEL_COMMAND_RECORDER_H
@@ -1,19 +1,49 @@
 #include "gfx/renderer/passes/base_pass.h"
 
+#include "ecs/components/lod.h"
 #include "ecs/components/material.h"
 #include "ecs/components/render_model.h"
-#include "ecs/components/vertex.h"
+#include "gfx/renderer/command_recorder.h"
 #include "gfx/renderer/frame_resources.h"
+#include "gfx/renderer/frustum_culler.h"
 #include "gfx/renderer/render_resource_manager.h"
 #include "gfx/rhi/interface/buffer.h"
 #include "gfx/rhi/interface/descriptor.h"
 #include "gfx/rhi/interface/pipeline.h"
 #include "gfx/rhi/shader_manager.h"
 #include "profiler/profiler.h"
+#include "utils/buffer/geometry_arena.h"
+#include "utils/memory/align.h"
+#include "utils/service/service_locator.h"
+
+#include <algorithm>
+#include <limits>
 
 namespace arise {
 namespace gfx {
 namespace renderer {
+
+namespace {
+
+// opaque geometry, the only sort bucket of this pass for now
+constexpr uint32_t OPAQUE_SORT_PASS = 0;
+
+constexpr uint32_t MIN_DRAW_INFO_CAPACITY = 256;
+
+// DrawInfo of shader_instancing.vs.hlsl: the material index in the low bits, then the LOD fade dither range
+constexpr uint32_t DRAW_INFO_MATERIAL_BITS = 22;
+constexpr uint32_t DRAW_INFO_DITHER_BITS   = 5;
+constexpr uint32_t MAX_DRAW_INFO_MATERIALS = 1u << DRAW_INFO_MATERIAL_BITS;
+
+static_assert(LOD_FADE_STEPS < (1u << DRAW_INFO_DITHER_BITS), "the dither range doesn't fit the draw info");
+
+uint32_t packDrawInfo(uint32_t materialIndex, uint32_t ditherBegin, uint32_t ditherEnd) {
+  return materialIndex | (ditherBegin << DRAW_INFO_MATERIAL_BITS)
+       | (ditherEnd << (DRAW_INFO_MATERIAL_BITS + DRAW_INFO_DITHER_BITS));
+}
+
+}  // namespace
+
 void BasePass::initialize(rhi::Device*           device,
                           RenderResourceManager* resourceManager,
                           FrameResources*        frameResources,
@@ -31,6 +61,16 @@ void BasePass::initialize(rhi::Device*           device,
   }
 
   setupRenderPass_();
+  createIdentityModelMatrixDescriptorSet_();
+
+  m_drawInfoBuffers.clear();
+  m_drawInfoBuffers.resize(frameResources->getFramesCount());
+
+  m_gpuCuller.initialize(
+      device, resourceManager, shaderManager, &frameResources->getConstantAllocator(), frameResources->getFramesCount());
+  m_lightClusterGrid.initialize(
+      device, resourceManager, shaderManager, &frameResources->getConstantAllocator(), frameResources->getFramesCount());
+  m_parallelRecorder.initialize(device, frameResources->getFramesCount());
 }
 
 void BasePass::resize(const math::Dimension2i& newDimension) {
@@ -45,40 +85,25 @@ void BasePass::resize(const math::Dimension2i& newDimension) {
   m_scissor.y      = 0;
   m_scissor.width  = newDimension.width();
   m_scissor.height = newDimension.height();
-
-  createFramebuffer_(newDimension);
 }
 
 void BasePass::prepareFrame(const RenderContext& context) {
   CPU_ZONE_NC("BasePass::prepareFrame", color::YELLOW);
 
-  std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>> currentFrameInstances;
-  std::unordered_map<RenderModel*, bool>                          modelDirtyFlags;
-
-  for (const auto& instance : m_frameResources->getModels()) {
-    currentFrameInstances[instance->model].push_back(instance->modelMatrix);
-
-    if (instance->isDirty) {
-      modelDirtyFlags[instance->model] = true;
-    }
-  }
+  m_gpuDriven = m_frameResources->isGpuCulling();
 
-  for (auto& [model, matrices] : currentFrameInstances) {
-    auto& cache = m_instanceBufferCache[model];
+  m_parallelRecorder.beginFrame(context.frameIndex);
 
-    bool needsUpdate = cache.instanceBuffer == nullptr ||   // Buffer not created yet
-                       matrices.size() > cache.capacity ||  // Need more space
-                       matrices.size() != cache.count ||    // Count changed
-                       modelDirtyFlags[model];              // Model was modified
-
-    if (needsUpdate) {
-      CPU_ZONE_NC("Update Instance Buffers", color::YELLOW);
-      updateInstanceBuffer_(model, matrices, cache);
-    }
-  }
-
-  cleanupUnusedBuffers_(currentFrameInstances);
+  m_lightClusterGrid.build(context.frameIndex,
+                           m_frameResources->getView(),
+                           m_frameResources->getProjection(),
+                           m_frameResources->hasCamera(),
+                           m_viewport.width,
+                           m_viewport.height,
+                           m_frameResources->getLightSystem(),
+                           context.renderSettings.gpuLightClustering);
 
+  // instance matrices are uploaded by FrameResources (InstanceDataStore), only the draw ranges are built here
   prepareDrawCalls_(context);
 }
 
@@ -86,7 +111,7 @@ void BasePass::render(const RenderContext& context) {
   CPU_ZONE_NC("BasePass::render", color::ORANGE);
 
   auto commandBuffer = context.commandBuffer.get();
-  if (!commandBuffer || !m_renderPass || m_framebuffers.empty()) {
+  if (!commandBuffer || !m_renderPass || !context.renderGraph) {
     return;
   }
 
@@ -106,69 +131,166 @@ void BasePass::render(const RenderContext& context) {
   depthClear.depthStencil.stencil = 0;
   clearValues.push_back(depthClear);
 
-  uint32_t currentIndex = context.currentImageIndex;
-  if (currentIndex >= m_framebuffers.size()) {
-    GlobalLogger::Log(LogLevel::Error, "Invalid framebuffer index");
+  rhi::Framebuffer* currentFramebuffer
+      = context.renderGraph->getFramebuffer(m_renderPass, context.colorTarget, context.depthTarget);
+  if (!currentFramebuffer) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to get the render graph framebuffer");
     return;
   }
 
-  rhi::Framebuffer* currentFramebuffer = m_framebuffers[currentIndex];
+  // the dispatches can't be recorded inside of the render pass
+  if (m_gpuDriven) {
+    m_gpuCuller.cull(commandBuffer, bounds::extractFrustum(m_frameResources->getViewProjection()));
+  }
+  m_lightClusterGrid.dispatch(commandBuffer);
 
-  commandBuffer->beginRenderPass(m_renderPass, currentFramebuffer, clearValues);
+  const uint32_t drawCount = static_cast<uint32_t>(m_drawPackets.size());
 
-  commandBuffer->setViewport(m_viewport);
-  commandBuffer->setScissor(m_scissor);
+  // the GPU-driven mode records a single draw, there is nothing to split
+  if (!m_gpuDriven && context.renderSettings.parallelCommandRecording
+      && m_parallelRecorder.getRangeCount(drawCount) > 1) {
+    // DX12 bundles use the viewport of the primary, Vulkan secondaries set their own
+    commandBuffer->setViewport(m_viewport);
+    commandBuffer->setScissor(m_scissor);
+
+    commandBuffer->beginRenderPass(
+        m_renderPass, currentFramebuffer, clearValues, rhi::RenderPassContents::SecondaryCommandBuffers);
 
-  {
     CPU_ZONE_NC("Draw Models", color::GREEN);
-    for (const auto& drawData : m_drawData) {
-      commandBuffer->setPipeline(drawData.pipeline);
 
-      if (m_frameResources->getViewDescriptorSet()) {
-        commandBuffer->bindDescriptorSet(0, m_frameResources->getViewDescriptorSet());
-      }
+    m_parallelRecorder.record(commandBuffer,
+                              m_renderPass,
+                              currentFramebuffer,
+                              drawCount,
+                              [this](rhi::CommandBuffer* secondary, uint32_t begin, uint32_t end) {
+                                secondary->setViewport(m_viewport);
+                                secondary->setScissor(m_scissor);
+                                recordDraws_(secondary, begin, end);
+                              });
+  } else {
+    commandBuffer->beginRenderPass(m_renderPass, currentFramebuffer, clearValues);
 
-      if (drawData.modelMatrixDescriptorSet) {
-        commandBuffer->bindDescriptorSet(1, drawData.modelMatrixDescriptorSet);
-      }
+    commandBuffer->setViewport(m_viewport);
+    commandBuffer->setScissor(m_scissor);
 
-      if (m_frameResources->getLightDescriptorSet()) {
-        commandBuffer->bindDescriptorSet(2, m_frameResources->getLightDescriptorSet());
-      }
+    CPU_ZONE_NC("Draw Models", color::GREEN);
 
-      if (drawData.materialDescriptorSet) {
-        commandBuffer->bindDescriptorSet(3, drawData.materialDescriptorSet);
-      }
+    if (m_gpuDriven) {
+      recordGpuDrivenDraws_(commandBuffer);
+    } else {
+      recordDraws_(commandBuffer, 0, drawCount);
+    }
+  }
 
-      if (m_frameResources->getDefaultSamplerDescriptorSet()) {
-        commandBuffer->bindDescriptorSet(4, m_frameResources->getDefaultSamplerDescriptorSet());
-      }
+  commandBuffer->endRenderPass();
+}
 
-      commandBuffer->bindVertexBuffer(0, drawData.vertexBuffer);
-      commandBuffer->bindVertexBuffer(1, drawData.instanceBuffer);
-      commandBuffer->bindIndexBuffer(drawData.indexBuffer, 0, true);
+void BasePass::recordDraws_(rhi::CommandBuffer* commandBuffer, uint32_t begin, uint32_t end) const {
+  // only the mesh set changes between draws, the recorder binds the shared sets once per pipeline
+  auto viewDescriptorSet     = m_frameResources->getViewDescriptorSet();
+  auto viewConstantsOffset   = m_frameResources->getViewConstantsOffset();
+  auto lightDescriptorSet    = m_frameResources->getLightDescriptorSet();
+  auto materialDescriptorSet = m_frameResources->getMaterialTable().getDescriptorSet();
+  auto samplerDescriptorSet  = m_frameResources->getDefaultSamplerDescriptorSet();
+  auto clusterDescriptorSet  = m_lightClusterGrid.getDescriptorSet();
+  auto clusterOffset         = m_lightClusterGrid.getConstantsOffset();
+
+  CommandRecorder recorder(commandBuffer);
+
+  for (uint32_t i = begin; i < end; ++i) {
+    const auto& drawData = m_drawData[m_drawPackets[i].drawIndex];
+
+    recorder.setPipeline(drawData.pipeline);
+
+    recorder.bindDescriptorSet(0, viewDescriptorSet, {&viewConstantsOffset, 1});
+    recorder.bindDescriptorSet(1, drawData.modelMatrixDescriptorSet);
+    recorder.bindDescriptorSet(2, lightDescriptorSet);
+    recorder.bindDescriptorSet(3, materialDescriptorSet);
+    recorder.bindDescriptorSet(4, samplerDescriptorSet);
+    recorder.bindDescriptorSet(5, clusterDescriptorSet, {&clusterOffset, 1});
+
+    m_vertexLayout.bindVertexBuffers(recorder, *drawData.geometryMesh);
+    recorder.bindVertexBuffer(m_vertexLayout.getInstanceBinding(), drawData.instanceBuffer);
+    // the material index and dither range of the draw, recorded per draw so parallel recorders don't share any state
+    recorder.bindVertexBuffer(m_vertexLayout.getDrawInfoBinding(), m_drawInfoBuffer, drawData.drawInfoOffset);
+    recorder.bindIndexBuffer(drawData.indexBuffer, 0, true);
+
+    recorder.drawIndexedInstanced(drawData.indexCount,
+                                  drawData.instanceCount,
+                                  drawData.firstIndex,
+                                  drawData.vertexOffset,
+                                  drawData.firstInstance);
+  }
+}
 
-      commandBuffer->drawIndexedInstanced(drawData.indexCount, drawData.instanceCount, 0, 0, 0);
-    }
+void BasePass::recordGpuDrivenDraws_(rhi::CommandBuffer* commandBuffer) const {
+  const uint32_t drawGroupCount = m_gpuCuller.getDrawGroupCount();
+  if (drawGroupCount == 0 || !m_gpuDrivenPipeline || !m_identityModelMatrixDescriptorSet) {
+    return;
+  }
+
+  // all meshes live in the arena's buffers, the draw commands select them with their offsets
+  auto geometryArena = ServiceLocator::s_get<GeometryArena>();
+  if (!geometryArena || !geometryArena->getIndexBuffer()) {
+    return;
+  }
+
+  auto viewConstantsOffset = m_frameResources->getViewConstantsOffset();
+  auto clusterOffset       = m_lightClusterGrid.getConstantsOffset();
+
+  // the culling shader wrote the mesh transforms and the draw infos next to the visible instances, so one set of
+  // bindings serves the draws of all meshes
+  commandBuffer->setPipeline(m_gpuDrivenPipeline);
+
+  commandBuffer->bindDescriptorSet(0, m_frameResources->getViewDescriptorSet(), {&viewConstantsOffset, 1});
+  commandBuffer->bindDescriptorSet(1, m_identityModelMatrixDescriptorSet);
+  commandBuffer->bindDescriptorSet(2, m_frameResources->getLightDescriptorSet());
+  commandBuffer->bindDescriptorSet(3, m_frameResources->getMaterialTable().getDescriptorSet());
+  commandBuffer->bindDescriptorSet(4, m_frameResources->getDefaultSamplerDescriptorSet());
+  commandBuffer->bindDescriptorSet(5, m_lightClusterGrid.getDescriptorSet(), {&clusterOffset, 1});
+
+  m_vertexLayout.bindVertexBuffers(*commandBuffer, *geometryArena);
+  commandBuffer->bindVertexBuffer(m_vertexLayout.getInstanceBinding(), m_gpuCuller.getVisibleInstanceBuffer());
+  commandBuffer->bindVertexBuffer(m_vertexLayout.getDrawInfoBinding(), m_gpuCuller.getVisibleDrawInfoBuffer());
+  commandBuffer->bindIndexBuffer(geometryArena->getIndexBuffer(), 0, true);
+
+  if (m_device->supportsDrawIndirectCount()) {
+    // groups without visible instances are skipped by the count, not drawn with zero instances
+    commandBuffer->drawIndexedIndirectCount(
+        m_gpuCuller.getDrawCommandBuffer(), 0, m_gpuCuller.getDrawCountBuffer(), 0, drawGroupCount);
+  } else {
+    commandBuffer->drawIndexedIndirect(m_gpuCuller.getDrawCommandBuffer(), 0, drawGroupCount);
   }
-  commandBuffer->endRenderPass();
 }
 
 void BasePass::clearSceneResources() {
-  m_instanceBufferCache.clear();
-  m_materialCache.clear();
+  m_gpuCuller.clear();
+  m_lightClusterGrid.clear();
   m_drawData.clear();
+  m_drawPackets.clear();
+  m_pipelineIds.clear();
+  m_materialIds.clear();
+  m_meshIds.clear();
+  m_drawInfos.clear();
   GlobalLogger::Log(LogLevel::Info, "Base pass resources cleared for scene switch");
 }
 
 void BasePass::cleanup() {
-  m_instanceBufferCache.clear();
-  m_materialCache.clear();
+  m_gpuCuller.clear();
+  m_lightClusterGrid.clear();
   m_drawData.clear();
-  m_renderPass = nullptr;
-  m_framebuffers.clear();
-  m_vertexShader = nullptr;
-  m_pixelShader  = nullptr;
+  m_drawPackets.clear();
+  m_pipelineIds.clear();
+  m_materialIds.clear();
+  m_meshIds.clear();
+  m_drawInfos.clear();
+  m_drawInfoBuffers.clear();
+  m_drawInfoBuffer    = nullptr;
+  m_pipeline          = nullptr;
+  m_gpuDrivenPipeline = nullptr;
+  m_renderPass        = nullptr;
+  m_vertexShader      = nullptr;
+  m_pixelShader       = nullptr;
 }
 
 void BasePass::setupRenderPass_() {
@@ -198,352 +320,265 @@ void BasePass::setupRenderPass_() {
   m_renderPass    = m_resourceManager->addRenderPass(std::move(renderPass), "base_pass_render_pass");
 }
 
-void BasePass::createFramebuffer_(const math::Dimension2i& dimension) {
-  if (!m_renderPass) {
-    GlobalLogger::Log(LogLevel::Error, "Render pass must be created before framebuffer");
-    return;
+void BasePass::createIdentityModelMatrixDescriptorSet_() {
+  const math::Matrix4f<> identity = math::Matrix4f<>::Identity();
+
+  rhi::BufferDesc bufferDesc;
+  bufferDesc.size        = alignConstantBufferSize(sizeof(identity));
+  bufferDesc.type        = rhi::BufferType::Dynamic;
+  bufferDesc.createFlags = rhi::BufferCreateFlag::CpuAccess | rhi::BufferCreateFlag::ConstantBuffer;
+  bufferDesc.debugName   = "base_pass_identity_model_matrix";
+
+  m_identityModelMatrixBuffer
+      = m_resourceManager->addBuffer(m_device->createBuffer(bufferDesc), bufferDesc.debugName);
+  m_device->updateBuffer(m_identityModelMatrixBuffer, &identity, sizeof(identity));
+
+  auto descriptorSet = m_device->createDescriptorSet(m_frameResources->getModelMatrixDescriptorSetLayout());
+  descriptorSet->setUniformBuffer(0, m_identityModelMatrixBuffer);
+  m_identityModelMatrixDescriptorSet
+      = m_resourceManager->addDescriptorSet(std::move(descriptorSet), "base_pass_identity_model_matrix_set");
+}
+
+rhi::GraphicsPipeline* BasePass::getOrCreatePipeline_(bool gpuDriven) {
+  rhi::GraphicsPipeline*& pipeline = gpuDriven ? m_gpuDrivenPipeline : m_pipeline;
+  if (pipeline) {
+    return pipeline;
   }
 
-  m_framebuffers.clear();
+  rhi::GraphicsPipelineDesc pipelineDesc;
 
-  uint32_t framesCount = m_frameResources->getFramesCount();
+  pipelineDesc.shaders.push_back(m_vertexShader);
+  pipelineDesc.shaders.push_back(m_pixelShader);
 
-  for (uint32_t i = 0; i < framesCount; i++) {
-    std::string framebufferKey = "base_pass_framebuffer_" + std::to_string(i);
+  m_vertexLayout.fillPipelineDesc(pipelineDesc, gpuDriven ? DrawInfoInput::PerInstance : DrawInfoInput::PerDraw);
 
-    rhi::Framebuffer* existingFramebuffer = m_resourceManager->getFramebuffer(framebufferKey);
-    if (existingFramebuffer) {
-      m_resourceManager->removeFramebuffer(framebufferKey);
-    }
+  pipelineDesc.inputAssembly.topology               = rhi::PrimitiveType::Triangles;
+  pipelineDesc.inputAssembly.primitiveRestartEnable = false;
+
+  pipelineDesc.rasterization.polygonMode     = rhi::PolygonMode::Fill;
+  pipelineDesc.rasterization.cullMode        = rhi::CullMode::Back;
+  pipelineDesc.rasterization.frontFace       = rhi::FrontFace::Ccw;
+  pipelineDesc.rasterization.depthBiasEnable = false;
+  pipelineDesc.rasterization.lineWidth       = 1.0f;
+
+  pipelineDesc.depthStencil.depthTestEnable  = true;
+  pipelineDesc.depthStencil.depthWriteEnable = true;
+  pipelineDesc.depthStencil.depthCompareOp   = rhi::CompareOp::Less;
+
+  pipelineDesc.depthStencil.stencilTestEnable = false;
+
+  rhi::ColorBlendAttachmentDesc blendAttachment;
+  blendAttachment.blendEnable         = true;
+  blendAttachment.srcColorBlendFactor = rhi::BlendFactor::SrcAlpha;
+  blendAttachment.dstColorBlendFactor = rhi::BlendFactor::OneMinusSrcAlpha;
+  blendAttachment.colorBlendOp        = rhi::BlendOp::Add;
+  blendAttachment.srcAlphaBlendFactor = rhi::BlendFactor::One;
+  blendAttachment.dstAlphaBlendFactor = rhi::BlendFactor::OneMinusSrcAlpha;
+  blendAttachment.alphaBlendOp        = rhi::BlendOp::Add;
+  blendAttachment.colorWriteMask      = rhi::ColorMask::All;
+  pipelineDesc.colorBlend.attachments.push_back(blendAttachment);
 
-    auto& renderTargets = m_frameResources->getRenderTargets(i);
+  pipelineDesc.multisample.rasterizationSamples = rhi::MSAASamples::Count1;
 
-    rhi::FramebufferDesc framebufferDesc;
-    framebufferDesc.width  = dimension.width();
-    framebufferDesc.height = dimension.height();
-    framebufferDesc.colorAttachments.push_back(renderTargets.colorBuffer.get());
-    framebufferDesc.depthStencilAttachment = renderTargets.depthBuffer.get();
-    framebufferDesc.hasDepthStencil        = true;
-    framebufferDesc.renderPass             = m_renderPass;
+  pipelineDesc.setLayouts.push_back(m_frameResources->getViewDescriptorSetLayout());
+  pipelineDesc.setLayouts.push_back(m_frameResources->getModelMatrixDescriptorSetLayout());
+  pipelineDesc.setLayouts.push_back(m_frameResources->getLightDescriptorSetLayout());
+  pipelineDesc.setLayouts.push_back(m_frameResources->getMaterialTable().getDescriptorSetLayout());
+  pipelineDesc.setLayouts.push_back(m_frameResources->getDefaultSamplerDescriptorSet()->getLayout());
+  pipelineDesc.setLayouts.push_back(m_lightClusterGrid.getDescriptorSetLayout());
 
-    auto framebuffer    = m_device->createFramebuffer(framebufferDesc);
-    auto framebufferPtr = m_resourceManager->addFramebuffer(std::move(framebuffer), framebufferKey);
+  pipelineDesc.renderPass = m_renderPass;
 
-    m_framebuffers.push_back(framebufferPtr);
+  bool created = false;
+  pipeline     = m_resourceManager->getOrCreatePipeline(m_device, pipelineDesc, &created);
+
+  if (created) {
+    m_shaderManager->registerPipelineForShader(pipeline, m_vertexShaderPath_);
+    m_shaderManager->registerPipelineForShader(pipeline, m_pixelShaderPath_);
   }
+  return pipeline;
 }
 
-void BasePass::updateInstanceBuffer_(RenderModel*                         model,
-                                     const std::vector<math::Matrix4f<>>& matrices,
-                                     ModelBufferCache&                    cache) {
-  if (!cache.instanceBuffer || matrices.size() > cache.capacity) {
-    // If we already have a buffer, we'll let the resource manager handle freeing it
+void BasePass::uploadDrawInfos_(uint32_t frameIndex) {
+  m_drawInfoBuffer = nullptr;
+  if (m_drawInfos.empty() || m_drawInfoBuffers.empty()) {
+    return;
+  }
+
+  auto&      drawInfoBuffer = m_drawInfoBuffers[frameIndex % m_drawInfoBuffers.size()];
+  const auto drawInfoCount  = static_cast<uint32_t>(m_drawInfos.size());
 
-    // Create a new buffer with some growth room
-    uint32_t newCapacity = std::max(static_cast<uint32_t>(matrices.size() * 1.5), 8u);
+  if (!drawInfoBuffer.buffer || drawInfoCount > drawInfoBuffer.capacity) {
+    uint32_t newCapacity = std::max(static_cast<uint32_t>(drawInfoCount * 1.5), MIN_DRAW_INFO_CAPACITY);
 
-    std::string bufferKey = "instance_buffer_" + std::to_string(reinterpret_cast<uintptr_t>(model));
+    // the buffer of this frame isn't used by the GPU anymore, so it can be replaced under the same key
+    std::string bufferKey = "base_pass_draw_infos_" + std::to_string(frameIndex);
 
     rhi::BufferDesc bufferDesc;
-    bufferDesc.size        = newCapacity * sizeof(math::Matrix4f<>);
+    bufferDesc.size        = newCapacity * sizeof(uint32_t);
     bufferDesc.createFlags = rhi::BufferCreateFlag::InstanceBuffer;
     bufferDesc.type        = rhi::BufferType::Dynamic;
-    bufferDesc.stride      = sizeof(math::Matrix4f<>);
+    bufferDesc.stride      = 0;  // every instance of a draw reads the value at the draw's offset
     bufferDesc.debugName   = bufferKey;
 
-    auto buffer          = m_device->createBuffer(bufferDesc);
-    cache.instanceBuffer = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
-    cache.capacity       = newCapacity;
+    auto buffer             = m_device->createBuffer(bufferDesc);
+    drawInfoBuffer.buffer   = m_resourceManager->addBuffer(std::move(buffer), bufferKey);
+    drawInfoBuffer.capacity = newCapacity;
   }
 
-  if (cache.instanceBuffer && !matrices.empty()) {
-    m_device->updateBuffer(cache.instanceBuffer, matrices.data(), matrices.size() * sizeof(math::Matrix4f<>));
-  }
-
-  cache.count = static_cast<uint32_t>(matrices.size());
+  m_device->updateBuffer(drawInfoBuffer.buffer, m_drawInfos.data(), drawInfoCount * sizeof(uint32_t));
+  m_drawInfoBuffer = drawInfoBuffer.buffer;
 }
 
 void BasePass::prepareDrawCalls_(const RenderContext& context) {
   m_drawData.clear();
+  m_drawPackets.clear();
+  m_drawInfos.clear();
 
-  auto viewLayout        = m_frameResources->getViewDescriptorSetLayout();
-  auto lightLayout       = m_frameResources->getLightDescriptorSetLayout();
-  auto modelMatrixLayout = m_frameResources->getModelMatrixDescriptorSetLayout();
-  auto materialLayout    = m_frameResources->getMaterialDescriptorSetLayout();
-  auto samplerLayout     = m_frameResources->getDefaultSamplerDescriptorSet()->getLayout();
+  const auto& instanceDataStore = m_frameResources->getInstanceDataStore();
+  const auto& materialTable     = m_frameResources->getMaterialTable();
+
+  if (m_gpuDriven) {
+    m_gpuCuller.beginFrame(context.frameIndex);
+  }
 
-  for (const auto& [model, cache] : m_instanceBufferCache) {
-    if (cache.count == 0) {
+  // the state doesn't depend on the mesh, all meshes share one pipeline
+  rhi::GraphicsPipeline* pipeline = getOrCreatePipeline_(m_gpuDriven);
+  if (!pipeline) {
+    return;
+  }
+
+  for (const auto& visibleModel : m_frameResources->getFrustumCuller()->getVisibleModels()) {
+    if (visibleModel.instanceSlots.empty()) {
       continue;
     }
 
-    for (const auto& renderMesh : model->renderMeshes) {
-      if (!renderMesh->material) {
-        GlobalLogger::Log(LogLevel::Debug, "RenderMesh has null material, skipping");
+    // in the GPU-driven mode the instances of each LOD group are compacted to the culler's buffer, bound in render()
+    rhi::Buffer* instanceBuffer = nullptr;
+    if (m_gpuDriven) {
+      m_lodGroupFirstInstances.clear();
+      for (const auto& lodGroup : visibleModel.lodGroups) {
+        m_lodGroupFirstInstances.push_back(
+            m_gpuCuller.addInstances(visibleModel.instanceMatrices, lodGroup.instances));
+      }
+    } else {
+      instanceBuffer = instanceDataStore.getBuffer(visibleModel.model, context.frameIndex);
+      if (!instanceBuffer) {
         continue;
       }
+    }
 
-      rhi::DescriptorSet* materialDescriptorSet = getOrCreateMaterialDescriptorSet_(renderMesh->material);
+    const uint32_t sortDepth = calculateSortDepth_(visibleModel);
 
-      if (!materialDescriptorSet) {
-        GlobalLogger::Log(LogLevel::Debug, "Could not create valid material descriptor set, skipping");
+    const auto& renderMeshes = visibleModel.model->renderMeshes;
+    for (size_t meshIndex = 0; meshIndex < renderMeshes.size(); ++meshIndex) {
+      if (!visibleModel.meshVisibility[meshIndex]) {
         continue;
       }
 
-      std::string pipelineKey
-          = "base_pipeline_" + std::to_string(reinterpret_cast<uintptr_t>(renderMesh->gpuMesh->vertexBuffer));
-
-      rhi::GraphicsPipeline* pipeline = m_resourceManager->getPipeline(pipelineKey);
-
-      if (!pipeline) {
-        rhi::GraphicsPipelineDesc pipelineDesc;
-
-        pipelineDesc.shaders.push_back(m_vertexShader);
-        pipelineDesc.shaders.push_back(m_pixelShader);
-
-        rhi::VertexInputBindingDesc vertexBinding;
-        vertexBinding.binding   = 0;
-        vertexBinding.stride    = sizeof(Vertex);
-        vertexBinding.inputRate = rhi::VertexInputRate::Vertex;
-        pipelineDesc.vertexBindings.push_back(vertexBinding);
-
-        rhi::VertexInputBindingDesc instanceBinding;
-        instanceBinding.binding   = 1;
-        instanceBinding.stride    = sizeof(math::Matrix4f<>);
-        instanceBinding.inputRate = rhi::VertexInputRate::Instance;
-        pipelineDesc.vertexBindings.push_back(instanceBinding);
-
-        rhi::VertexInputAttributeDesc positionAttr;
-        positionAttr.location     = 0;
-        positionAttr.binding      = 0;
-        positionAttr.format       = rhi::TextureFormat::Rgb32f;
-        positionAttr.offset       = offsetof(Vertex, position);
-        positionAttr.semanticName = "POSITION";
-        pipelineDesc.vertexAttributes.push_back(positionAttr);
-
-        rhi::VertexInputAttributeDesc uvAttr;
-        uvAttr.location     = 1;
-        uvAttr.binding      = 0;
-        uvAttr.format       = rhi::TextureFormat::Rg32f;
-        uvAttr.offset       = offsetof(Vertex, texCoords);
-        uvAttr.semanticName = "TEXCOORD";
-        pipelineDesc.vertexAttributes.push_back(uvAttr);
-
-        rhi::VertexInputAttributeDesc normalAttr;
-        normalAttr.location     = 2;
-        normalAttr.binding      = 0;
-        normalAttr.format       = rhi::TextureFormat::Rgb32f;
-        normalAttr.offset       = offsetof(Vertex, normal);
-        normalAttr.semanticName = "NORMAL";
-        pipelineDesc.vertexAttributes.push_back(normalAttr);
-
-        rhi::VertexInputAttributeDesc tangentAttr;
-        tangentAttr.location     = 3;
-        tangentAttr.binding      = 0;
-        tangentAttr.format       = rhi::TextureFormat::Rgb32f;
-        tangentAttr.offset       = offsetof(Vertex, tangent);
-        tangentAttr.semanticName = "TANGENT";
-        pipelineDesc.vertexAttributes.push_back(tangentAttr);
-
-        rhi::VertexInputAttributeDesc bitangentAttr;
-        bitangentAttr.location     = 4;
-        bitangentAttr.binding      = 0;
-        bitangentAttr.format       = rhi::TextureFormat::Rgb32f;
-        bitangentAttr.offset       = offsetof(Vertex, bitangent);
-        bitangentAttr.semanticName = "BITANGENT";
-        pipelineDesc.vertexAttributes.push_back(bitangentAttr);
-
-        rhi::VertexInputAttributeDesc colorAttr;
-        colorAttr.location     = 5;
-        colorAttr.binding      = 0;
-        colorAttr.format       = rhi::TextureFormat::Rgba32f;
-        colorAttr.offset       = offsetof(Vertex, color);
-        colorAttr.semanticName = "COLOR";
-        pipelineDesc.vertexAttributes.push_back(colorAttr);
-
-        for (uint32_t i = 0; i < 4; i++) {
-          rhi::VertexInputAttributeDesc matrixCol;
-          matrixCol.location     = 6 + i;
-          matrixCol.binding      = 1;
-          matrixCol.format       = rhi::TextureFormat::Rgba32f;
-          matrixCol.offset       = i * 16;
-          matrixCol.semanticName = "INSTANCE";
-          pipelineDesc.vertexAttributes.push_back(matrixCol);
-        }
-
-        pipelineDesc.inputAssembly.topology               = rhi::PrimitiveType::Triangles;
-        pipelineDesc.inputAssembly.primitiveRestartEnable = false;
-
-        pipelineDesc.rasterization.polygonMode     = rhi::PolygonMode::Fill;
-        pipelineDesc.rasterization.cullMode        = rhi::CullMode::Back;
-        pipelineDesc.rasterization.frontFace       = rhi::FrontFace::Ccw;
-        pipelineDesc.rasterization.depthBiasEnable = false;
-        pipelineDesc.rasterization.lineWidth       = 1.0f;
-
-        pipelineDesc.depthStencil.depthTestEnable  = true;
-        pipelineDesc.depthStencil.depthWriteEnable = true;
-        pipelineDesc.depthStencil.depthCompareOp   = rhi::CompareOp::Less;
-
-        pipelineDesc.depthStencil.stencilTestEnable = false;
-
-        rhi::ColorBlendAttachmentDesc blendAttachment;
-        blendAttachment.blendEnable         = true;
-        blendAttachment.srcColorBlendFactor = rhi::BlendFactor::SrcAlpha;
-        blendAttachment.dstColorBlendFactor = rhi::BlendFactor::OneMinusSrcAlpha;
-        blendAttachment.colorBlendOp        = rhi::BlendOp::Add;
-        blendAttachment.srcAlphaBlendFactor = rhi::BlendFactor::One;
-        blendAttachment.dstAlphaBlendFactor = rhi::BlendFactor::OneMinusSrcAlpha;
-        blendAttachment.alphaBlendOp        = rhi::BlendOp::Add;
-        blendAttachment.colorWriteMask      = rhi::ColorMask::All;
-        pipelineDesc.colorBlend.attachments.push_back(blendAttachment);
-
-        pipelineDesc.multisample.rasterizationSamples = rhi::MSAASamples::Count1;
+      const auto& renderMesh = renderMeshes[meshIndex];
+      if (!renderMesh->material) {
+        GlobalLogger::Log(LogLevel::Debug, "RenderMesh has null material, skipping");
+        continue;
+      }
 
-        pipelineDesc.setLayouts.push_back(viewLayout);
-        pipelineDesc.setLayouts.push_back(modelMatrixLayout);
-        pipelineDesc.setLayouts.push_back(lightLayout);
-        pipelineDesc.setLayouts.push_back(materialLayout);
-        pipelineDesc.setLayouts.push_back(samplerLayout);
+      // the material table set is shared by all draws, the draw info selects the material in it
+      const uint32_t materialIndex = materialTable.getMaterialIndex(renderMesh->material);
+      if (materialIndex >= MAX_DRAW_INFO_MATERIALS) {
+        GlobalLogger::Log(LogLevel::Debug, "Material of the RenderMesh isn't in the material table, skipping");
+        continue;
+      }
 
-        pipelineDesc.renderPass = m_renderPass;
+      // meshes the arena hasn't placed yet (see GeometryArena::update) have no buffers and no valid offsets
+      const auto* gpuMesh = renderMesh->gpuMesh;
+      if (!gpuMesh || !gpuMesh->indexBuffer) {
+        continue;
+      }
 
-        auto pipelineObj = m_device->createGraphicsPipeline(pipelineDesc);
-        pipeline         = m_resourceManager->addPipeline(std::move(pipelineObj), pipelineKey);
+      if (m_gpuDriven) {
+        for (size_t groupIndex = 0; groupIndex < visibleModel.lodGroups.size(); ++groupIndex) {
+          const auto& lodGroup = visibleModel.lodGroups[groupIndex];
+
+          // all instances of the group, the culling shader selects the visible ones for the mesh
+          m_gpuCuller.addDrawGroup(renderMesh->boundingBox,
+                                   *gpuMesh,
+                                   lodGroup.level,
+                                   m_lodGroupFirstInstances[groupIndex],
+                                   static_cast<uint32_t>(lodGroup.instances.size()),
+                                   renderMesh->transformMatrix,
+                                   packDrawInfo(materialIndex, lodGroup.ditherBegin, lodGroup.ditherEnd));
+        }
+        continue;
+      }
 
-        m_shaderManager->registerPipelineForShader(pipeline, m_vertexShaderPath_);
-        m_shaderManager->registerPipelineForShader(pipeline, m_pixelShaderPath_);
+      rhi::DescriptorSet* modelMatrixDescriptorSet = m_frameResources->getOrCreateModelMatrixDescriptorSet(renderMesh);
+      if (!modelMatrixDescriptorSet) {
+        continue;
       }
 
       DrawData drawData;
       drawData.pipeline                 = pipeline;
-      drawData.modelMatrixDescriptorSet = m_frameResources->getOrCreateModelMatrixDescriptorSet(renderMesh);
-      drawData.materialDescriptorSet    = materialDescriptorSet;
-      drawData.vertexBuffer             = renderMesh->gpuMesh->vertexBuffer;
-      drawData.indexBuffer              = renderMesh->gpuMesh->indexBuffer;
-      drawData.instanceBuffer           = cache.instanceBuffer;
-      drawData.indexCount               = renderMesh->gpuMesh->indexBuffer->getDesc().size / sizeof(uint32_t);
-      drawData.instanceCount            = cache.count;
-
-      m_drawData.push_back(drawData);
-    }
-  }
-}
-
-void BasePass::cleanupUnusedBuffers_(
-    const std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>& currentFrameInstances) {
-  std::vector<RenderModel*> modelsToRemove;
-  for (const auto& [model, cache] : m_instanceBufferCache) {
-    if (!currentFrameInstances.contains(model)) {
-      modelsToRemove.push_back(model);
-    }
-  }
-
-  for (auto model : modelsToRemove) {
-    m_instanceBufferCache.erase(model);
-  }
-
-  std::unordered_set<Material*> activeMaterials;
-
-  for (const auto& [model, matrices] : currentFrameInstances) {
-    for (const auto& renderMesh : model->renderMeshes) {
-      if (renderMesh->material) {
-        activeMaterials.insert(renderMesh->material);
+      drawData.modelMatrixDescriptorSet = modelMatrixDescriptorSet;
+      drawData.geometryMesh             = gpuMesh;
+      drawData.indexBuffer              = gpuMesh->indexBuffer;
+      drawData.instanceBuffer           = instanceBuffer;
+      drawData.vertexOffset             = static_cast<int32_t>(gpuMesh->vertexOffset);
+
+      const uint64_t sortKey = DrawSortKey::s_make(OPAQUE_SORT_PASS,
+                                                   m_pipelineIds.getId(pipeline),
+                                                   m_materialIds.getId(renderMesh->material),
+                                                   m_meshIds.getId(gpuMesh),
+                                                   sortDepth);
+
+      for (const auto& lodGroup : visibleModel.lodGroups) {
+        drawData.indexCount     = gpuMesh->getIndexCount(lodGroup.level);
+        drawData.firstIndex     = gpuMesh->getFirstIndex(lodGroup.level);
+        drawData.drawInfoOffset = static_cast<uint32_t>(m_drawInfos.size() * sizeof(uint32_t));
+        m_drawInfos.push_back(packDrawInfo(materialIndex, lodGroup.ditherBegin, lodGroup.ditherEnd));
+
+        for (const auto& range : lodGroup.instanceRanges) {
+          drawData.firstInstance = range.firstInstance;
+          drawData.instanceCount = range.instanceCount;
+          m_drawPackets.push_back({sortKey, static_cast<uint32_t>(m_drawData.size())});
+          m_drawData.push_back(drawData);
+        }
       }
     }
   }
 
-  std::vector<Material*> materialsToRemove;
-  for (const auto& [material, cache] : m_materialCache) {
-    if (!activeMaterials.contains(material)) {
-      materialsToRemove.push_back(material);
-    }
-  }
-
-  for (auto material : materialsToRemove) {
-    GlobalLogger::Log(LogLevel::Debug,
-                      "Removing cached material parameters for deleted material at address: "
-                          + std::to_string(reinterpret_cast<uintptr_t>(material)));
-    m_materialCache.erase(material);
-  }
-}
-
-rhi::DescriptorSet* BasePass::getOrCreateMaterialDescriptorSet_(Material* material) {
-  if (!material) {
-    GlobalLogger::Log(LogLevel::Error, "Material is null");
-    return nullptr;
-  }
-
-  auto it = m_materialCache.find(material);
-  if (it != m_materialCache.end() && it->second.descriptorSet) {
-    return it->second.descriptorSet;
-  }
-
-  auto materialLayout = m_resourceManager->getDescriptorSetLayout("material_layout");
-  if (!materialLayout) {
-    GlobalLogger::Log(LogLevel::Error, "Material descriptor set layout not found");
-    return nullptr;
+  if (m_gpuDriven) {
+    m_gpuCuller.upload();
+    return;
   }
 
-  std::string materialKey = "material_" + std::to_string(reinterpret_cast<uintptr_t>(material));
+  uploadDrawInfos_(context.frameIndex);
 
-  auto descriptorSetPtr = m_resourceManager->getDescriptorSet(materialKey);
-  if (!descriptorSetPtr) {
-    auto descriptorSet = m_device->createDescriptorSet(materialLayout);
-    descriptorSetPtr   = m_resourceManager->addDescriptorSet(std::move(descriptorSet), materialKey);
+  {
+    CPU_ZONE_NC("Sort Draw Calls", color::YELLOW);
+    g_radixSortDrawPackets(m_drawPackets, m_sortScratch);
   }
+}
 
-  rhi::Buffer* paramBuffer = m_frameResources->getOrCreateMaterialParamBuffer(material);
-  if (paramBuffer) {
-    descriptorSetPtr->setUniformBuffer(0, paramBuffer);
+uint32_t BasePass::calculateSortDepth_(const FrustumCuller::VisibleModel& visibleModel) const {
+  if (!m_frameResources->hasCamera()) {
+    return 0;
   }
 
-  std::vector<std::string> textureNames = {"albedo", "normal_map", "metallic_roughness"};
-  uint32_t                 binding      = 1;
-
-  bool allTexturesValid = true;
-
-  for (const auto& textureName : textureNames) {
-    rhi::Texture* texture = nullptr;
-
-    auto textureIt = material->textures.find(textureName);
-    if (textureIt != material->textures.end() && textureIt->second) {
-      texture = textureIt->second;
-    }
-
-    if (!texture) {
-      if (textureName == "albedo") {
-        texture = m_frameResources->getDefaultWhiteTexture();
-      } else if (textureName == "normal_map") {
-        texture = m_frameResources->getDefaultNormalTexture();
-      } else if (textureName == "metallic_roughness") {
-        texture = m_frameResources->getDefaultBlackTexture();
-      }
-
-      GlobalLogger::Log(LogLevel::Debug,
-                        "Using fallback texture for '" + textureName + "' in material: " + material->materialName);
-    }
-
-    if (!texture) {
-      GlobalLogger::Log(
-          LogLevel::Error,
-          "No texture available (including fallback) for '" + textureName + "' in material: " + material->materialName);
-      allTexturesValid = false;
-      break;
-    }
-
-    descriptorSetPtr->setTexture(binding, texture);
-    binding++;
+  // front to back, so the depth test rejects more of the later draws
+  const auto& cameraPosition = m_frameResources->getCameraPosition();
+  float       minDistanceSqr = std::numeric_limits<float>::max();
+  for (const auto& matrix : visibleModel.instanceMatrices) {
+    // row-major with row vectors, the translation is in the last row
+    const float* m  = matrix.data();
+    float        dx = m[12] - cameraPosition.x();
+    float        dy = m[13] - cameraPosition.y();
+    float        dz = m[14] - cameraPosition.z();
+    minDistanceSqr  = std::min(minDistanceSqr, dx * dx + dy * dy + dz * dz);
   }
 
-  if (allTexturesValid) {
-    m_materialCache[material].descriptorSet = descriptorSetPtr;
-    return descriptorSetPtr;
-  } else {
-    GlobalLogger::Log(LogLevel::Warning,
-                      "Material descriptor set creation failed due to invalid textures: " + material->materialName);
-    return nullptr;
-  }
+  return DrawSortKey::s_quantizeDepth(minDistanceSqr);
 }
+
 }  // namespace renderer
 }  // namespace gfx
 }  // namespace arise
@@ -1,20 +1,26 @@
 #ifndef ARISE_BASE_PASS_H
 #define ARISE_BASE_PASS_H
 
+#include "gfx/renderer/draw_packet.h"
+#include "gfx/renderer/frustum_culler.h"
+#include "gfx/renderer/gpu_culler.h"
+#include "gfx/renderer/light_cluster_grid.h"
+#include "gfx/renderer/parallel_command_recorder.h"
 #include "gfx/renderer/render_pass.h"
 #include "gfx/rhi/interface/render_pass.h"
+#include "utils/buffer/vertex_layout.h"
 
-#include <unordered_map>
 #include <vector>
 
 namespace arise {
 struct RenderModel;
-struct Material;
 }  // namespace arise
 
 namespace arise::gfx::rhi {
 class Buffer;
+class CommandBuffer;
 class DescriptorSet;
+class DescriptorSetLayout;
 class GraphicsPipeline;
 }  // namespace arise::gfx::rhi
 
@@ -24,6 +30,11 @@ namespace renderer {
 
 /**
  * Handles the main rendering of scene objects
+ *
+ * Every LOD group of a model (FrustumCuller::LodGroup) is drawn with its level's index range. Groups of cross-fading
+ * instances draw only their part of the dither pattern. The dither range and the material index reach the shaders as
+ * the draw info vertex attribute (see packDrawInfo in base_pass.cpp): bound per draw from a buffer with a stride of 0,
+ * or written per instance by GpuCuller, so the GPU-driven mode draws all meshes with one indirect call.
  */
 class BasePass : public RenderPass {
   public:
@@ -42,67 +53,105 @@ class BasePass : public RenderPass {
 
   void render(const RenderContext& context) override;
 
-  void endFrame() override { m_drawData.clear(); }
+  void endFrame() override {
+    m_drawData.clear();
+    m_drawPackets.clear();
+    m_drawInfos.clear();
+  }
 
   void clearSceneResources();
   void cleanup() override;
 
   private:
-  struct ModelBufferCache {
-    rhi::Buffer* instanceBuffer = nullptr;
-    uint32_t     capacity       = 0;
-    uint32_t     count          = 0;
+  struct DrawData {
+    rhi::GraphicsPipeline*    pipeline                 = nullptr;
+    rhi::DescriptorSet*       modelMatrixDescriptorSet = nullptr;
+    const RenderGeometryMesh* geometryMesh             = nullptr;  // vertex streams
+    rhi::Buffer*              indexBuffer              = nullptr;
+    rhi::Buffer*              instanceBuffer           = nullptr;
+    uint32_t                  indexCount               = 0;
+    uint32_t                  firstIndex               = 0;
+    int32_t                   vertexOffset             = 0;
+    uint32_t                  instanceCount            = 0;
+    uint32_t                  firstInstance            = 0;
+    uint32_t                  drawInfoOffset           = 0;  // in m_drawInfoBuffer
   };
 
-  struct DrawData {
-    rhi::GraphicsPipeline* pipeline                 = nullptr;
-    rhi::DescriptorSet*    modelMatrixDescriptorSet = nullptr;
-    rhi::DescriptorSet*    materialDescriptorSet    = nullptr;
-    rhi::Buffer*           vertexBuffer             = nullptr;
-    rhi::Buffer*           indexBuffer              = nullptr;
-    rhi::Buffer*           instanceBuffer           = nullptr;
-    uint32_t               indexCount               = 0;
-    uint32_t               instanceCount            = 0;
+  struct DrawInfoBuffer {
+    rhi::Buffer* buffer   = nullptr;
+    uint32_t     capacity = 0;
   };
 
   void setupRenderPass_();
 
-  void createFramebuffer_(const math::Dimension2i& dimension);
+  // The mesh set of the GPU-driven draws, the culling shader already applied the mesh transforms
+  void createIdentityModelMatrixDescriptorSet_();
+
+  // Pipelines differ only in how the draw info is fetched, per draw or per instance (GPU-driven)
+  rhi::GraphicsPipeline* getOrCreatePipeline_(bool gpuDriven);
+
+  // Writes m_drawInfos to the buffer of the frame
+  void uploadDrawInfos_(uint32_t frameIndex);
 
-  void updateInstanceBuffer_(RenderModel*                         model,
-                             const std::vector<math::Matrix4f<>>& matrices,
-                             ModelBufferCache&                    cache);
+  // Distance to the nearest visible instance of the model, quantized for the sort key
+  uint32_t calculateSortDepth_(const FrustumCuller::VisibleModel& visibleModel) const;
 
   void prepareDrawCalls_(const RenderContext& context);
 
-  void cleanupUnusedBuffers_(
-      const std::unordered_map<RenderModel*, std::vector<math::Matrix4f<>>>& currentFrameInstances);
+  // Records the sorted draws [begin, end), the command buffer must be inside of the render pass
+  void recordDraws_(rhi::CommandBuffer* commandBuffer, uint32_t begin, uint32_t end) const;
+
+  // Records the one indirect draw of all GpuCuller groups, the command buffer must be inside of the render pass
+  void recordGpuDrivenDraws_(rhi::CommandBuffer* commandBuffer) const;
 
   const std::string m_vertexShaderPath_ = "assets/shaders/base_pass/shader_instancing.vs.hlsl";
   const std::string m_pixelShaderPath_  = "assets/shaders/base_pass/shader.ps.hlsl";
 
-  rhi::DescriptorSet* getOrCreateMaterialDescriptorSet_(Material* material);
-
   rhi::Device*           m_device          = nullptr;
   RenderResourceManager* m_resourceManager = nullptr;
   FrameResources*        m_frameResources  = nullptr;
 
-  rhi::RenderPass*               m_renderPass = nullptr;
-  std::vector<rhi::Framebuffer*> m_framebuffers;
-  rhi::Shader*                   m_vertexShader = nullptr;
-  rhi::Shader*                   m_pixelShader  = nullptr;
+  rhi::RenderPass*       m_renderPass        = nullptr;
+  rhi::GraphicsPipeline* m_pipeline          = nullptr;
+  rhi::GraphicsPipeline* m_gpuDrivenPipeline = nullptr;
+  rhi::Shader*           m_vertexShader      = nullptr;
+  rhi::Shader*           m_pixelShader       = nullptr;
+
+  // the vertex color isn't used by the shading, so the color stream isn't fetched
+  const VertexLayout m_vertexLayout{VertexAttribute::Position | VertexAttribute::TexCoords | VertexAttribute::Normal
+                                    | VertexAttribute::Tangent};
 
   rhi::Viewport    m_viewport;
   rhi::ScissorRect m_scissor;
 
-  std::unordered_map<RenderModel*, ModelBufferCache> m_instanceBufferCache;
-  std::vector<DrawData>                              m_drawData;
+  std::vector<DrawData>   m_drawData;
+  std::vector<DrawPacket> m_drawPackets;  // sorted, render() walks m_drawData in this order
+  std::vector<DrawPacket> m_sortScratch;
 
-  struct MaterialCache {
-    rhi::DescriptorSet* descriptorSet = nullptr;
-  };
+  // packed draw info of every draw in m_drawData (not GPU-driven), uploaded to the frame's buffer
+  std::vector<uint32_t>       m_drawInfos;
+  std::vector<DrawInfoBuffer> m_drawInfoBuffers;  // per frame in flight
+  rhi::Buffer*                m_drawInfoBuffer = nullptr;
+
+  // GPU-driven mode, first instance of each LOD group of the model being prepared
+  std::vector<uint32_t> m_lodGroupFirstInstances;
+
+  rhi::Buffer*        m_identityModelMatrixBuffer        = nullptr;
+  rhi::DescriptorSet* m_identityModelMatrixDescriptorSet = nullptr;
+
+  DrawKeyIds m_pipelineIds;
+  DrawKeyIds m_materialIds;
+  DrawKeyIds m_meshIds;
+
+  // culls the instances and writes the draw arguments when FrameResources::isGpuCulling() is set
+  GpuCuller m_gpuCuller;
+  bool      m_gpuDriven = false;
+
+  // point and spot lights per cluster of the view, the pixel shader shades only the lights of its cluster
+  LightClusterGrid m_lightClusterGrid;
 
-  std::unordered_map<Material*, MaterialCache> m_materialCache;
+  // records large draw lists into secondary command buffers on the job system
+  ParallelCommandRecorder m_parallelRecorder;
 
   rhi::ShaderManager* m_shaderManager = nullptr;
 };
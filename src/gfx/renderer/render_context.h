@@ -1,6 +1,7 @@
 #ifndef ARISE_RENDER_CONTEXT_H
 #define ARISE_RENDER_CONTEXT_H
 
+#include "gfx/renderer/render_graph.h"
 #include "gfx/renderer/render_settings.h"
 #include "gfx/rhi/interface/command_buffer.h"
 #include "gfx/rhi/interface/synchronization.h"
@@ -21,6 +22,13 @@ struct RenderContext {
   math::Dimension2i                  viewportDimension;
   RenderSettings                      renderSettings;
   uint32_t                            currentImageIndex = 0;
+  // index of the frame in flight, CPU-written per-frame resources are selected by it
+  uint32_t                            frameIndex        = 0;
+
+  // graph of the frame, the passes render to its targets through RenderGraph::getFramebuffer()
+  RenderGraph*       renderGraph = nullptr;
+  RenderGraphTexture colorTarget;
+  RenderGraphTexture depthTarget;
 };
 
 }  // namespace renderer
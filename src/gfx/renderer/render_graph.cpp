@@ -0,0 +1,369 @@
+#include "gfx/renderer/render_graph.h"
+
+#include "gfx/rhi/interface/command_buffer.h"
+#include "gfx/rhi/interface/device.h"
+#include "gfx/rhi/interface/framebuffer.h"
+#include "gfx/rhi/interface/texture.h"
+#include "profiler/profiler.h"
+#include "utils/logger/global_logger.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+void RenderGraphBuilder::read(RenderGraphTexture texture, rhi::ResourceLayout layout) {
+  addAccess_(texture, layout, true, false);
+}
+
+void RenderGraphBuilder::write(RenderGraphTexture texture, rhi::ResourceLayout layout) {
+  addAccess_(texture, layout, false, true);
+}
+
+void RenderGraphBuilder::modify(RenderGraphTexture texture, rhi::ResourceLayout layout) {
+  addAccess_(texture, layout, true, true);
+}
+
+void RenderGraphBuilder::addAccess_(RenderGraphTexture texture, rhi::ResourceLayout layout, bool read, bool write) {
+  auto& pass = m_graph.m_passes[m_passIndex];
+
+  if (!texture.isValid() || texture.index >= m_graph.m_textures.size()) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid render graph texture used by pass '" + pass.name + "'");
+    return;
+  }
+
+  // a texture is transitioned once per pass, so all accesses of a pass must agree on the layout
+  for (auto& access : pass.accesses) {
+    if (access.texture != texture.index) {
+      continue;
+    }
+
+    if (access.layout != layout) {
+      GlobalLogger::Log(LogLevel::Warning,
+                        "Pass '" + pass.name + "' uses texture '" + m_graph.m_textures[texture.index].name
+                            + "' in different layouts, the first one is used");
+    }
+    access.read  |= read;
+    access.write |= write;
+    return;
+  }
+
+  pass.accesses.push_back({texture.index, layout, read, write});
+}
+
+RenderGraph::RenderGraph() = default;
+
+RenderGraph::~RenderGraph() = default;
+
+void RenderGraph::initialize(rhi::Device* device, uint32_t framesCount) {
+  clear();
+
+  m_device = device;
+  m_slots.resize(std::max(framesCount, 1u));
+  m_frameIndex = 0;
+}
+
+void RenderGraph::beginFrame(uint32_t frameIndex) {
+  m_frameIndex = frameIndex % m_slots.size();
+
+  m_passes.clear();
+  m_textures.clear();
+  m_culledPassCount = 0;
+
+  // the previous frame of the slot is finished on the GPU, the framebuffers it didn't use can go
+  auto& framebuffers = m_slots[m_frameIndex].framebuffers;
+  std::erase_if(framebuffers, [](const CachedFramebuffer& cached) { return !cached.used; });
+  for (auto& cached : framebuffers) {
+    cached.used = false;
+  }
+}
+
+RenderGraphTexture RenderGraph::importTexture(const std::string& name, rhi::Texture* texture) {
+  auto& node   = m_textures.emplace_back();
+  node.name    = name;
+  node.texture = texture;
+
+  return {static_cast<uint32_t>(m_textures.size() - 1)};
+}
+
+RenderGraphTexture RenderGraph::createTexture(const std::string& name, const rhi::TextureDesc& desc) {
+  auto& node     = m_textures.emplace_back();
+  node.name      = name;
+  node.transient = true;
+  node.desc      = desc;
+
+  // the first pass transitions the texture, creating it in a layout would cost a submission (see DeviceVk)
+  node.desc.initialLayout = rhi::ResourceLayout::Undefined;
+  if (node.desc.debugName.empty()) {
+    node.desc.debugName = name;
+  }
+
+  return {static_cast<uint32_t>(m_textures.size() - 1)};
+}
+
+void RenderGraph::markOutput(RenderGraphTexture texture, rhi::ResourceLayout finalLayout) {
+  if (!texture.isValid() || texture.index >= m_textures.size()) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid render graph texture marked as output");
+    return;
+  }
+
+  auto& node       = m_textures[texture.index];
+  node.output      = true;
+  node.finalLayout = finalLayout;
+}
+
+void RenderGraph::addPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute) {
+  auto& pass   = m_passes.emplace_back();
+  pass.name    = name;
+  pass.execute = std::move(execute);
+
+  RenderGraphBuilder builder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+  if (setup) {
+    setup(builder);
+  }
+}
+
+void RenderGraph::compile() {
+  CPU_ZONE_NC("RenderGraph::compile", color::CYAN);
+
+  cullPasses_();
+  computeLifetimes_();
+  allocateTransients_();
+}
+
+void RenderGraph::execute(rhi::CommandBuffer* commandBuffer) {
+  CPU_ZONE_NC("RenderGraph::execute", color::CYAN);
+
+  if (!commandBuffer) {
+    return;
+  }
+
+  for (auto& pass : m_passes) {
+    if (pass.culled) {
+      continue;
+    }
+
+    // a pass that changes a layout on its own (a render pass with a different final layout) is caught by the next
+    // transition, the layout is always taken from the texture
+    for (const auto& access : pass.accesses) {
+      transitionTexture_(commandBuffer, m_textures[access.texture].texture, access.layout);
+    }
+
+    if (pass.execute) {
+      pass.execute(commandBuffer);
+    }
+  }
+
+  for (const auto& node : m_textures) {
+    if (node.output && node.finalLayout != rhi::ResourceLayout::Undefined) {
+      transitionTexture_(commandBuffer, node.texture, node.finalLayout);
+    }
+  }
+}
+
+rhi::Texture* RenderGraph::getTexture(RenderGraphTexture texture) const {
+  if (!texture.isValid() || texture.index >= m_textures.size()) {
+    return nullptr;
+  }
+  return m_textures[texture.index].texture;
+}
+
+rhi::Framebuffer* RenderGraph::getFramebuffer(rhi::RenderPass*   renderPass,
+                                              RenderGraphTexture color,
+                                              RenderGraphTexture depth) {
+  auto colorTexture = getTexture(color);
+  auto depthTexture = getTexture(depth);
+  if (!renderPass || !colorTexture || !m_device || m_slots.empty()) {
+    return nullptr;
+  }
+
+  auto& framebuffers = m_slots[m_frameIndex].framebuffers;
+  for (auto& cached : framebuffers) {
+    if (cached.renderPass == renderPass && cached.color == colorTexture && cached.depth == depthTexture) {
+      cached.used = true;
+      return cached.framebuffer.get();
+    }
+  }
+
+  rhi::FramebufferDesc framebufferDesc;
+  framebufferDesc.width  = colorTexture->getWidth();
+  framebufferDesc.height = colorTexture->getHeight();
+  framebufferDesc.colorAttachments.push_back(colorTexture);
+  framebufferDesc.depthStencilAttachment = depthTexture;
+  framebufferDesc.hasDepthStencil        = depthTexture != nullptr;
+  framebufferDesc.renderPass             = renderPass;
+
+  auto framebuffer = m_device->createFramebuffer(framebufferDesc);
+  if (!framebuffer) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create render graph framebuffer");
+    return nullptr;
+  }
+
+  auto& cached       = framebuffers.emplace_back();
+  cached.framebuffer = std::move(framebuffer);
+  cached.renderPass  = renderPass;
+  cached.color       = colorTexture;
+  cached.depth       = depthTexture;
+  cached.used        = true;
+  return cached.framebuffer.get();
+}
+
+uint32_t RenderGraph::getTransientTextureCount() const {
+  return std::accumulate(m_slots.begin(), m_slots.end(), 0u, [](uint32_t count, const FrameSlot& slot) {
+    return count + static_cast<uint32_t>(slot.textures.size());
+  });
+}
+
+void RenderGraph::clear() {
+  m_passes.clear();
+  m_textures.clear();
+  m_culledPassCount = 0;
+
+  // the framebuffers reference the textures, so they go first
+  for (auto& slot : m_slots) {
+    slot.framebuffers.clear();
+    slot.textures.clear();
+  }
+}
+
+void RenderGraph::cullPasses_() {
+  // walks the passes backwards, tracking which textures still have a reader (or are outputs) at that point. A pass is
+  // kept when it writes such a texture; its reads are then needed, and what it overwrites isn't needed before it
+  std::vector<bool> needed(m_textures.size(), false);
+  for (size_t i = 0; i < m_textures.size(); ++i) {
+    needed[i] = m_textures[i].output;
+  }
+
+  m_culledPassCount = 0;
+
+  for (auto pass = m_passes.rbegin(); pass != m_passes.rend(); ++pass) {
+    pass->culled = std::none_of(pass->accesses.begin(), pass->accesses.end(), [&needed](const TextureAccess& access) {
+      return access.write && needed[access.texture];
+    });
+
+    if (pass->culled) {
+      ++m_culledPassCount;
+      continue;
+    }
+
+    for (const auto& access : pass->accesses) {
+      if (access.write && !access.read) {
+        needed[access.texture] = false;
+      }
+    }
+
+    for (const auto& access : pass->accesses) {
+      if (access.read) {
+        needed[access.texture] = true;
+      }
+    }
+  }
+}
+
+void RenderGraph::computeLifetimes_() {
+  for (uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex) {
+    const auto& pass = m_passes[passIndex];
+    if (pass.culled) {
+      continue;
+    }
+
+    for (const auto& access : pass.accesses) {
+      auto& node     = m_textures[access.texture];
+      node.firstPass = std::min(node.firstPass, passIndex);
+      node.lastPass  = std::max(node.lastPass, passIndex);
+    }
+  }
+}
+
+void RenderGraph::allocateTransients_() {
+  auto& slot = m_slots[m_frameIndex];
+  for (auto& pooled : slot.textures) {
+    pooled.used          = false;
+    pooled.availableFrom = 0;
+  }
+
+  // in the order the transients are first used, so a texture is handed over as soon as its last user is done
+  std::vector<uint32_t> transients;
+  for (uint32_t i = 0; i < m_textures.size(); ++i) {
+    const auto& node = m_textures[i];
+    if (node.transient && node.firstPass <= node.lastPass) {
+      transients.push_back(i);
+    }
+  }
+
+  std::sort(transients.begin(), transients.end(), [this](uint32_t lhs, uint32_t rhs) {
+    return m_textures[lhs].firstPass < m_textures[rhs].firstPass;
+  });
+
+  for (auto index : transients) {
+    auto& node   = m_textures[index];
+    auto  pooled = acquirePooledTexture_(node.desc, node.firstPass);
+    if (!pooled) {
+      continue;
+    }
+
+    pooled->used          = true;
+    pooled->availableFrom = node.lastPass + 1;
+    node.texture          = pooled->texture.get();
+  }
+
+  // the previous use of this slot is finished on the GPU, so the textures the frame didn't need can go, together
+  // with the framebuffers built over them
+  for (const auto& pooled : slot.textures) {
+    if (pooled.used) {
+      continue;
+    }
+
+    std::erase_if(slot.framebuffers, [texture = pooled.texture.get()](const CachedFramebuffer& cached) {
+      return cached.color == texture || cached.depth == texture;
+    });
+  }
+  std::erase_if(slot.textures, [](const PooledTexture& pooled) { return !pooled.used; });
+}
+
+RenderGraph::PooledTexture* RenderGraph::acquirePooledTexture_(const rhi::TextureDesc& desc, uint32_t firstPass) {
+  auto& pool = m_slots[m_frameIndex].textures;
+
+  for (auto& pooled : pool) {
+    if (pooled.availableFrom <= firstPass && isCompatible_(pooled.desc, desc)) {
+      return &pooled;
+    }
+  }
+
+  auto texture = m_device ? m_device->createTexture(desc) : nullptr;
+  if (!texture) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create render graph texture '" + desc.debugName + "'");
+    return nullptr;
+  }
+
+  auto& pooled   = pool.emplace_back();
+  pooled.texture = std::move(texture);
+  pooled.desc    = desc;
+  return &pooled;
+}
+
+bool RenderGraph::isCompatible_(const rhi::TextureDesc& lhs, const rhi::TextureDesc& rhs) {
+  return lhs.type == rhs.type && lhs.format == rhs.format && lhs.createFlags == rhs.createFlags
+      && lhs.width == rhs.width && lhs.height == rhs.height && lhs.depth == rhs.depth
+      && lhs.arraySize == rhs.arraySize && lhs.mipLevels == rhs.mipLevels && lhs.sampleCount == rhs.sampleCount;
+}
+
+void RenderGraph::transitionTexture_(rhi::CommandBuffer* commandBuffer,
+                                     rhi::Texture*       texture,
+                                     rhi::ResourceLayout layout) {
+  if (!texture || texture->getCurrentLayoutType() == layout) {
+    return;
+  }
+
+  rhi::ResourceBarrierDesc barrier;
+  barrier.texture   = texture;
+  barrier.oldLayout = texture->getCurrentLayoutType();
+  barrier.newLayout = layout;
+  commandBuffer->resourceBarrier(barrier);
+}
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
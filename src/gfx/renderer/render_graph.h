@@ -0,0 +1,219 @@
+#ifndef ARISE_RENDER_GRAPH_H
+#define ARISE_RENDER_GRAPH_H
+
+#include "gfx/rhi/common/rhi_enums.h"
+#include "gfx/rhi/common/rhi_types.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace arise::gfx::rhi {
+class CommandBuffer;
+class Device;
+class Framebuffer;
+class RenderPass;
+class Texture;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+namespace gfx {
+namespace renderer {
+
+class RenderGraph;
+
+/**
+ * Handle of a texture declared in the graph of the current frame
+ */
+struct RenderGraphTexture {
+  static constexpr uint32_t s_invalidIndex = std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = s_invalidIndex;
+
+  bool isValid() const { return index != s_invalidIndex; }
+};
+
+/**
+ * Declares how a pass uses the textures of the graph, every access names the layout the pass needs the texture in.
+ */
+class RenderGraphBuilder {
+  public:
+  // The pass reads the texture (samples it, copies from it)
+  void read(RenderGraphTexture texture, rhi::ResourceLayout layout);
+
+  // The pass overwrites the whole texture (clears it), the previous content isn't needed
+  void write(RenderGraphTexture texture, rhi::ResourceLayout layout);
+
+  // The pass reads and writes the texture (an attachment that is loaded and drawn over)
+  void modify(RenderGraphTexture texture, rhi::ResourceLayout layout);
+
+  private:
+  friend class RenderGraph;
+
+  RenderGraphBuilder(RenderGraph& graph, uint32_t passIndex)
+      : m_graph(graph)
+      , m_passIndex(passIndex) {}
+
+  void addAccess_(RenderGraphTexture texture, rhi::ResourceLayout layout, bool read, bool write);
+
+  RenderGraph& m_graph;
+  uint32_t     m_passIndex;
+};
+
+/**
+ * Frame graph: the frame is declared as passes that read and write textures, the graph then
+ * - culls the passes whose results don't reach an output (a texture marked with markOutput()) - e.g. a pass whose
+ *   targets are cleared by a later pass, or a copy to the back buffer nobody presents
+ * - transitions every texture to the layout the pass declared right before the pass, and the outputs to their final
+ *   layout at the end of the frame (a transition is skipped when the texture is already in the layout)
+ * - creates the transient textures (createTexture()) only for the passes that survived the culling. Transients with
+ *   the same description whose lifetimes (first to last pass using them) don't overlap share one texture
+ *
+ * Transient textures are pooled per frame in flight, so a texture is reused only after the GPU finished the previous
+ * frame that used it. A pooled texture the frame didn't need is released. The passes render to the graph textures
+ * through getFramebuffer(), the framebuffers are cached in the same slots and released together with their textures.
+ *
+ * The graph is rebuilt every frame: beginFrame(), declarations, compile(), execute().
+ */
+class RenderGraph {
+  public:
+  using SetupFunction   = std::function<void(RenderGraphBuilder& builder)>;
+  using ExecuteFunction = std::function<void(rhi::CommandBuffer* commandBuffer)>;
+
+  RenderGraph();
+  ~RenderGraph();
+
+  void initialize(rhi::Device* device, uint32_t framesCount);
+
+  // Drops the declarations of the previous frame, the transients of frameIndex's slot are free again
+  void beginFrame(uint32_t frameIndex);
+
+  // Texture owned outside of the graph (back buffer, targets that outlive the frame)
+  RenderGraphTexture importTexture(const std::string& name, rhi::Texture* texture);
+
+  // Texture that lives only inside of the frame, created on demand in compile()
+  RenderGraphTexture createTexture(const std::string& name, const rhi::TextureDesc& desc);
+
+  /**
+   * The content of the texture is used after the frame (presented, shown in the editor), so the passes that write it
+   * are never culled.
+   *
+   * @param finalLayout layout the texture is left in, Undefined keeps the layout of the last pass
+   */
+  void markOutput(RenderGraphTexture texture, rhi::ResourceLayout finalLayout = rhi::ResourceLayout::Undefined);
+
+  // setup runs immediately and declares the accesses, execute runs from execute() if the pass isn't culled
+  void addPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+
+  // Culls the passes and assigns the transient textures
+  void compile();
+
+  // Records the surviving passes in the declaration order
+  void execute(rhi::CommandBuffer* commandBuffer);
+
+  // Texture behind the handle, transients are valid from compile() until the next beginFrame()
+  rhi::Texture* getTexture(RenderGraphTexture texture) const;
+
+  /**
+   * Framebuffer of the render pass over the graph textures, sized to the color texture. Valid from compile() until
+   * the frame's slot is used again.
+   *
+   * @param depth invalid handle for a render pass without a depth attachment
+   */
+  rhi::Framebuffer* getFramebuffer(rhi::RenderPass*   renderPass,
+                                   RenderGraphTexture color,
+                                   RenderGraphTexture depth = {});
+
+  uint32_t getPassCount() const { return static_cast<uint32_t>(m_passes.size()); }
+  uint32_t getCulledPassCount() const { return m_culledPassCount; }
+
+  // Transient textures currently created in all slots
+  uint32_t getTransientTextureCount() const;
+
+  // Releases the transient textures and the framebuffers, the GPU must not use them anymore
+  void clear();
+
+  private:
+  friend class RenderGraphBuilder;
+
+  struct TextureAccess {
+    uint32_t            texture;
+    rhi::ResourceLayout layout;
+    bool                read;
+    bool                write;
+  };
+
+  struct Pass {
+    std::string                name;
+    std::vector<TextureAccess> accesses;
+    ExecuteFunction            execute;
+    bool                       culled = false;
+  };
+
+  struct TextureNode {
+    std::string name;
+
+    // imported, or the pooled texture assigned in compile()
+    rhi::Texture* texture = nullptr;
+
+    bool             transient = false;
+    rhi::TextureDesc desc;
+
+    bool                output      = false;
+    rhi::ResourceLayout finalLayout = rhi::ResourceLayout::Undefined;
+
+    // first and last surviving pass that accesses the texture
+    uint32_t firstPass = std::numeric_limits<uint32_t>::max();
+    uint32_t lastPass  = 0;
+  };
+
+  struct PooledTexture {
+    std::unique_ptr<rhi::Texture> texture;
+    rhi::TextureDesc              desc;
+    bool                          used          = false;  // in the current frame
+    uint32_t                      availableFrom = 0;      // first pass that may alias it
+  };
+
+  struct CachedFramebuffer {
+    std::unique_ptr<rhi::Framebuffer> framebuffer;
+    rhi::RenderPass*                  renderPass = nullptr;
+    rhi::Texture*                     color      = nullptr;
+    rhi::Texture*                     depth      = nullptr;
+    bool                              used       = false;  // in the current frame
+  };
+
+  struct FrameSlot {
+    std::vector<PooledTexture>     textures;
+    std::vector<CachedFramebuffer> framebuffers;
+  };
+
+  void cullPasses_();
+  void computeLifetimes_();
+  void allocateTransients_();
+
+  // A texture of the pool that is free from firstPass on, a new one if none matches the description
+  PooledTexture* acquirePooledTexture_(const rhi::TextureDesc& desc, uint32_t firstPass);
+
+  static bool isCompatible_(const rhi::TextureDesc& lhs, const rhi::TextureDesc& rhs);
+
+  void transitionTexture_(rhi::CommandBuffer* commandBuffer, rhi::Texture* texture, rhi::ResourceLayout layout);
+
+  rhi::Device* m_device = nullptr;
+
+  std::vector<Pass>        m_passes;
+  std::vector<TextureNode> m_textures;
+  uint32_t                 m_culledPassCount = 0;
+
+  // per frame in flight
+  std::vector<FrameSlot> m_slots;
+  uint32_t               m_frameIndex = 0;
+};
+
+}  // namespace renderer
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_RENDER_GRAPH_H
@@ -1,6 +1,7 @@
 #ifndef ARISE_RENDER_RESOURCE_MANAGER_H
 #define ARISE_RENDER_RESOURCE_MANAGER_H
 
+#include "gfx/rhi/common/rhi_hash.h"
 #include "gfx/rhi/interface/buffer.h"
 #include "gfx/rhi/interface/descriptor.h"
 #include "gfx/rhi/interface/device.h"
@@ -54,6 +55,17 @@ class RenderResourceManager {
     return nullptr;
   }
 
+  // Hands the buffer over to the caller, e.g. to delete it once the frames in flight are done with it
+  std::unique_ptr<rhi::Buffer> releaseBuffer(const std::string& cacheKey) {
+    auto it = m_cachedBuffers.find(cacheKey);
+    if (it == m_cachedBuffers.end()) {
+      return nullptr;
+    }
+    auto buffer = std::move(it->second);
+    m_cachedBuffers.erase(it);
+    return buffer;
+  }
+
   //--------------------------------------------------------------------------
   // Texture management
   //--------------------------------------------------------------------------
@@ -171,6 +183,33 @@ class RenderResourceManager {
     return nullptr;
   }
 
+  /**
+   * Returns the pipeline created from an identical description (by any pass) or creates a new one. outCreated tells
+   * the caller whether the pipeline is new, e.g. to register it for shader hot reload only once.
+   */
+  rhi::GraphicsPipeline* getOrCreatePipeline(rhi::Device*                     device,
+                                             const rhi::GraphicsPipelineDesc& desc,
+                                             bool*                            outCreated = nullptr) {
+    const uint64_t descHash = rhi::g_hashGraphicsPipelineDesc(desc);
+
+    auto it = m_hashedPipelines.find(descHash);
+    if (it != m_hashedPipelines.end()) {
+      if (outCreated) {
+        *outCreated = false;
+      }
+      return it->second.get();
+    }
+
+    auto pipeline = device->createGraphicsPipeline(desc);
+    auto ptr      = pipeline.get();
+    m_hashedPipelines.emplace(descHash, std::move(pipeline));
+
+    if (outCreated) {
+      *outCreated = true;
+    }
+    return ptr;
+  }
+
   void updateScheduledPipelines() {
     for (auto& pipeline : m_pipelines) {
       pipeline->decrementUpdateCounter();
@@ -185,6 +224,34 @@ class RenderResourceManager {
         pipeline->rebuild();
       }
     }
+
+    for (auto& [hash, pipeline] : m_hashedPipelines) {
+      pipeline->decrementUpdateCounter();
+      if (pipeline->needsUpdate()) {
+        pipeline->rebuild();
+      }
+    }
+
+    for (auto& [key, pipeline] : m_cachedComputePipelines) {
+      pipeline->decrementUpdateCounter();
+      if (pipeline->needsUpdate()) {
+        pipeline->rebuild();
+      }
+    }
+  }
+
+  rhi::ComputePipeline* addComputePipeline(std::unique_ptr<rhi::ComputePipeline> pipeline, const std::string& cacheKey) {
+    rhi::ComputePipeline* ptr          = pipeline.get();
+    m_cachedComputePipelines[cacheKey] = std::move(pipeline);
+    return ptr;
+  }
+
+  rhi::ComputePipeline* getComputePipeline(const std::string& cacheKey) {
+    auto it = m_cachedComputePipelines.find(cacheKey);
+    if (it != m_cachedComputePipelines.end()) {
+      return it->second.get();
+    }
+    return nullptr;
   }
 
   //--------------------------------------------------------------------------
@@ -257,6 +324,8 @@ class RenderResourceManager {
     m_cachedDescriptorSetLayouts.clear();
     m_cachedDescriptorSets.clear();
     m_cachedPipelines.clear();
+    m_hashedPipelines.clear();
+    m_cachedComputePipelines.clear();
     m_cachedRenderPasses.clear();
     m_cachedFramebuffers.clear();
   }
@@ -279,8 +348,12 @@ class RenderResourceManager {
   std::unordered_map<std::string, std::unique_ptr<rhi::DescriptorSetLayout>> m_cachedDescriptorSetLayouts;
   std::unordered_map<std::string, std::unique_ptr<rhi::DescriptorSet>>       m_cachedDescriptorSets;
   std::unordered_map<std::string, std::unique_ptr<rhi::GraphicsPipeline>>    m_cachedPipelines;
+  std::unordered_map<std::string, std::unique_ptr<rhi::ComputePipeline>>     m_cachedComputePipelines;
   std::unordered_map<std::string, std::unique_ptr<rhi::RenderPass>>          m_cachedRenderPasses;
   std::unordered_map<std::string, std::unique_ptr<rhi::Framebuffer>>         m_cachedFramebuffers;
+
+  // pipelines keyed by g_hashGraphicsPipelineDesc, shared by all passes
+  std::unordered_map<uint64_t, std::unique_ptr<rhi::GraphicsPipeline>> m_hashedPipelines;
 };
 
 }  // namespace renderer
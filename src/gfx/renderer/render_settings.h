@@ -30,10 +30,16 @@ enum class PostProcessMode {
 };
 
 struct RenderSettings {
-  RenderMode            renderMode              = RenderMode::Solid;
-  PostProcessMode       postProcessMode         = PostProcessMode::None;
-  math::Dimension2i    renderViewportDimension = math::Dimension2i(1, 1);
-  ApplicationRenderMode appMode                 = ApplicationRenderMode::Game;
+  RenderMode            renderMode               = RenderMode::Solid;
+  PostProcessMode       postProcessMode          = PostProcessMode::None;
+  math::Dimension2i    renderViewportDimension  = math::Dimension2i(1, 1);
+  ApplicationRenderMode appMode                  = ApplicationRenderMode::Game;
+  // cull in a compute shader and draw the base pass with indirect draws
+  bool                  gpuDrivenRendering       = false;
+  // build the light clusters in a compute shader instead of on the CPU
+  bool                  gpuLightClustering       = false;
+  // record large draw lists into secondary command buffers on the job system
+  bool                  parallelCommandRecording = true;
 };
 
 }  // namespace renderer
@@ -147,6 +147,7 @@ RenderContext Renderer::beginFrame(Scene* scene, const RenderSettings& renderSet
   context.viewportDimension = viewportDimension;
   context.renderSettings    = renderSettings;
   context.currentImageIndex = m_swapChain->getCurrentImageIndex();
+  context.frameIndex        = m_currentFrame;
 
   m_frameResources->updatePerFrameResources(context);
 
@@ -163,8 +164,6 @@ void Renderer::renderFrame(RenderContext& context) {
 
   GPU_ZONE_NC(context.commandBuffer.get(), "Frame Render", color::CYAN);
 
-  // TODO: divide this into separate functions
-
   if (m_basePass) {
     m_basePass->prepareFrame(context);
   }
@@ -177,28 +176,10 @@ void Renderer::renderFrame(RenderContext& context) {
     m_finalPass->prepareFrame(context);
   }
 
-  bool exclusiveMode
-      = m_debugPass && context.renderSettings.renderMode != RenderMode::Solid && m_debugPass->isExclusive();
-
-  if (!exclusiveMode && m_basePass) {
-    m_basePass->render(context);
-  }
+  buildRenderGraph_(context);
 
-  auto isDebugPass = context.renderSettings.renderMode == RenderMode::Wireframe
-                  || context.renderSettings.renderMode == RenderMode::ShaderOverdraw
-                  || context.renderSettings.renderMode == RenderMode::VertexNormalVisualization
-                  || context.renderSettings.renderMode == RenderMode::NormalMapVisualization
-                  || context.renderSettings.renderMode == RenderMode::LightVisualization
-                  || context.renderSettings.renderMode == RenderMode::WorldGrid
-                  || context.renderSettings.renderMode == RenderMode::MeshHighlight;
-
-  if (m_debugPass && isDebugPass) {
-    m_debugPass->render(context);
-  }
-
-  if (m_finalPass && context.renderSettings.appMode == ApplicationRenderMode::Game) {
-    m_finalPass->render(context);
-  }
+  m_renderGraph.compile();
+  m_renderGraph.execute(context.commandBuffer.get());
 
   if (m_basePass) {
     m_basePass->endFrame();
@@ -241,6 +222,9 @@ void Renderer::endFrame(RenderContext& context) {
     signalSemaphores.push_back(renderFinishedSemaphore.get());
   }
 
+  // uploads queued while the frame was recorded are executed before it
+  m_device->flushUploads();
+
   m_device->submitCommandBuffer(
       context.commandBuffer.get(), m_frameFences[m_currentFrame].get(), waitSemaphores, signalSemaphores);
 
@@ -259,6 +243,9 @@ bool Renderer::onWindowResize(uint32_t width, uint32_t height) {
     return false;
   }
 
+  // the framebuffers of the graph reference the render targets that are recreated
+  m_renderGraph.clear();
+
   m_frameResources->resize(math::Dimension2i(width, height));
 
   if (m_basePass) {
@@ -305,6 +292,8 @@ bool Renderer::onViewportResize(const math::Dimension2i& newDimension) {
     }
   }
 
+  m_renderGraph.clear();
+
   m_frameResources->resize(math::Dimension2i(width, height));
 
   if (m_basePass) {
@@ -379,6 +368,83 @@ void Renderer::waitForAllFrames_() {
   }
 }
 
+void Renderer::buildRenderGraph_(RenderContext& context) {
+  auto& renderTargets = m_frameResources->getRenderTargets(context.currentImageIndex);
+
+  // the transients are reused once the fence of the frame in flight was waited in beginFrame()
+  m_renderGraph.beginFrame(context.frameIndex);
+
+  auto colorBuffer = m_renderGraph.importTexture("color_buffer", renderTargets.colorBuffer.get());
+  auto backBuffer  = m_renderGraph.importTexture("back_buffer", renderTargets.backBuffer);
+
+  // the depth buffer isn't used after the frame, so it's a transient of the graph
+  rhi::TextureDesc depthDesc;
+  depthDesc.width       = renderTargets.colorBuffer->getWidth();
+  depthDesc.height      = renderTargets.colorBuffer->getHeight();
+  depthDesc.format      = rhi::TextureFormat::D24S8;
+  depthDesc.createFlags = rhi::TextureCreateFlag::Dsv;
+
+  auto depthBuffer = m_renderGraph.createTexture("depth_buffer", depthDesc);
+
+  context.renderGraph = &m_renderGraph;
+  context.colorTarget = colorBuffer;
+  context.depthTarget = depthBuffer;
+
+  // the passes that don't reach the output are culled - the copy to the back buffer in the editor (the UI draws the
+  // back buffer), the base pass under an exclusive debug strategy
+  if (context.renderSettings.appMode == ApplicationRenderMode::Game) {
+    m_renderGraph.markOutput(backBuffer, rhi::ResourceLayout::PresentSrc);
+  } else {
+    m_renderGraph.markOutput(colorBuffer, rhi::ResourceLayout::ShaderReadOnly);
+  }
+
+  if (m_basePass) {
+    m_renderGraph.addPass(
+        "Base Pass",
+        [&](RenderGraphBuilder& builder) {
+          builder.write(colorBuffer, rhi::ResourceLayout::ColorAttachment);
+          builder.write(depthBuffer, rhi::ResourceLayout::DepthStencilAttachment);
+        },
+        [this, &context](rhi::CommandBuffer* /*commandBuffer*/) { m_basePass->render(context); });
+  }
+
+  auto isDebugPass = context.renderSettings.renderMode == RenderMode::Wireframe
+                  || context.renderSettings.renderMode == RenderMode::ShaderOverdraw
+                  || context.renderSettings.renderMode == RenderMode::VertexNormalVisualization
+                  || context.renderSettings.renderMode == RenderMode::NormalMapVisualization
+                  || context.renderSettings.renderMode == RenderMode::LightVisualization
+                  || context.renderSettings.renderMode == RenderMode::WorldGrid
+                  || context.renderSettings.renderMode == RenderMode::MeshHighlight;
+
+  if (m_debugPass && isDebugPass) {
+    // exclusive strategies clear the targets, the others draw over the base pass
+    const bool exclusive = m_debugPass->isExclusive();
+
+    m_renderGraph.addPass(
+        "Debug Pass",
+        [&](RenderGraphBuilder& builder) {
+          if (exclusive) {
+            builder.write(colorBuffer, rhi::ResourceLayout::ColorAttachment);
+            builder.write(depthBuffer, rhi::ResourceLayout::DepthStencilAttachment);
+          } else {
+            builder.modify(colorBuffer, rhi::ResourceLayout::ColorAttachment);
+            builder.modify(depthBuffer, rhi::ResourceLayout::DepthStencilAttachment);
+          }
+        },
+        [this, &context](rhi::CommandBuffer* /*commandBuffer*/) { m_debugPass->render(context); });
+  }
+
+  if (m_finalPass) {
+    m_renderGraph.addPass(
+        "Final Pass",
+        [&](RenderGraphBuilder& builder) {
+          builder.read(colorBuffer, rhi::ResourceLayout::TransferSrc);
+          builder.write(backBuffer, rhi::ResourceLayout::TransferDst);
+        },
+        [this, &context](rhi::CommandBuffer* /*commandBuffer*/) { m_finalPass->render(context); });
+  }
+}
+
 void Renderer::setupRenderPasses_() {
   m_basePass = std::make_unique<BasePass>();
   m_basePass->initialize(m_device.get(), getResourceManager(), m_frameResources.get(), m_shaderManager.get());
@@ -388,6 +454,8 @@ void Renderer::setupRenderPasses_() {
 
   m_finalPass = std::make_unique<FinalPass>();
   m_finalPass->initialize(m_device.get(), getResourceManager(), m_frameResources.get(), m_shaderManager.get());
+
+  m_renderGraph.initialize(m_device.get(), MAX_FRAMES_IN_FLIGHT);
 }
 }  // namespace renderer
 }  // namespace gfx
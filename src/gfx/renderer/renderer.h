@@ -5,6 +5,7 @@
 #include "gfx/renderer/passes/base_pass.h"
 #include "gfx/renderer/passes/debug_pass.h"
 #include "gfx/renderer/passes/final_pass.h"
+#include "gfx/renderer/render_graph.h"
 #include "gfx/renderer/render_resource_manager.h"
 #include "gfx/rhi/common/rhi_enums.h"
 #include "gfx/rhi/interface/command_buffer.h"
@@ -59,6 +60,9 @@ class Renderer {
 
   void setupRenderPasses_();
 
+  // Declares the passes of the frame and the render targets they use
+  void buildRenderGraph_(RenderContext& context);
+
   static constexpr uint32_t MAX_FRAMES_IN_FLIGHT      = 2;
   static constexpr uint32_t COMMAND_BUFFERS_PER_FRAME = 8;
   static constexpr uint32_t INITIAL_COMMAND_BUFFERS   = 2;
@@ -74,6 +78,10 @@ class Renderer {
   std::unique_ptr<FinalPass> m_finalPass;
   std::unique_ptr<DebugPass> m_debugPass;
 
+  // rebuilt every frame, owns the transient targets and their framebuffers - destroyed before the frame resources and
+  // the device
+  RenderGraph m_renderGraph;
+
   // one pool per frame in flight
   std::array<std::vector<std::unique_ptr<rhi::CommandBuffer>>, MAX_FRAMES_IN_FLIGHT> m_commandBufferPools;
 
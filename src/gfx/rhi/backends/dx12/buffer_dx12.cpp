@@ -347,9 +347,15 @@ void DescriptorBufferDx12::createUnorderedAccessView() {
   uavDesc.Format                           = DXGI_FORMAT_UNKNOWN;
   uavDesc.ViewDimension                    = D3D12_UAV_DIMENSION_BUFFER;
   uavDesc.Buffer.FirstElement              = 0;
-  // Size in bytes / 4 bytes per element (estimate)
-  uavDesc.Buffer.NumElements          = static_cast<UINT>(m_desc_.size / 4);
-  uavDesc.Buffer.StructureByteStride  = 0;
+  if (m_desc_.stride > 0) {
+    // Structured Buffer (RWStructuredBuffer)
+    uavDesc.Buffer.StructureByteStride = m_desc_.stride;
+    uavDesc.Buffer.NumElements         = static_cast<UINT>(m_desc_.size / m_desc_.stride);
+  } else {
+    // Size in bytes / 4 bytes per element (estimate)
+    uavDesc.Buffer.StructureByteStride = 0;
+    uavDesc.Buffer.NumElements         = static_cast<UINT>(m_desc_.size / 4);
+  }
   uavDesc.Buffer.CounterOffsetInBytes = 0;
   uavDesc.Buffer.Flags                = D3D12_BUFFER_UAV_FLAG_NONE;
 
@@ -36,7 +36,7 @@ class BufferDx12 : public Buffer {
 
   bool isMapped() const { return m_isMapped_; }
 
-  void* getMappedData() const { return m_mappedData_; }
+  void* getMappedData() const override { return m_mappedData_; }
 
   D3D12MA::Allocation* getAllocation() const { return m_allocation_.Get(); }
 
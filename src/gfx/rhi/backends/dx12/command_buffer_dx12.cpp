@@ -58,7 +58,10 @@ void CommandBufferDx12::end() {
     return;
   }
 
-  if (m_isRenderPassActive_) {
+  // a bundle runs inside of the render pass of its primary, the primary ends it
+  if (m_isSecondary_) {
+    m_isRenderPassActive_ = false;
+  } else if (m_isRenderPassActive_) {
     endRenderPass();
   }
 
@@ -69,6 +72,7 @@ void CommandBufferDx12::end() {
   }
 
   m_isRecording_ = false;
+  m_isSecondary_ = false;
 }
 
 void CommandBufferDx12::reset() {
@@ -93,6 +97,26 @@ void CommandBufferDx12::reset() {
   m_currentRenderPass_  = nullptr;
   m_currentFramebuffer_ = nullptr;
   m_isRenderPassActive_ = false;
+  m_isSecondary_        = false;
+}
+
+void CommandBufferDx12::beginSecondary(RenderPass* /*renderPass*/, Framebuffer* /*framebuffer*/) {
+  if (m_isRecording_) {
+    GlobalLogger::Log(LogLevel::Warning, "Command buffer is already recording");
+    return;
+  }
+
+  if (!isBundle()) {
+    GlobalLogger::Log(LogLevel::Error, "Only bundles can be recorded as secondary command buffers");
+    return;
+  }
+
+  // bundles inherit the render targets of the executing list, the render pass and the framebuffer aren't needed
+  m_isRecording_        = true;
+  m_isSecondary_        = true;
+  m_isRenderPassActive_ = true;
+
+  bindDescriptorHeaps();
 }
 
 void CommandBufferDx12::setPipeline(Pipeline* pipeline) {
@@ -101,17 +125,21 @@ void CommandBufferDx12::setPipeline(Pipeline* pipeline) {
     return;
   }
 
-  auto pipelineDx12 = dynamic_cast<GraphicsPipelineDx12*>(pipeline);
-  if (!pipelineDx12) {
+  if (!pipeline) {
     GlobalLogger::Log(LogLevel::Error, "Invalid pipeline type");
     return;
   }
 
-  m_commandList_->SetPipelineState(pipelineDx12->getPipelineState());  // PSO
-
   // root signature (graphics / compute)
-  auto pipelineType = pipelineDx12->getType();
+  auto pipelineType = pipeline->getType();
   if (pipelineType == PipelineType::Graphics) {
+    auto pipelineDx12 = dynamic_cast<GraphicsPipelineDx12*>(pipeline);
+    if (!pipelineDx12) {
+      GlobalLogger::Log(LogLevel::Error, "Invalid pipeline type");
+      return;
+    }
+
+    m_commandList_->SetPipelineState(pipelineDx12->getPipelineState());  // PSO
     m_commandList_->SetGraphicsRootSignature(pipelineDx12->getRootSignature());
 
     m_commandList_->OMSetBlendFactor(pipelineDx12->getBlendFactors().data());
@@ -134,10 +162,17 @@ void CommandBufferDx12::setPipeline(Pipeline* pipeline) {
     m_commandList_->IASetPrimitiveTopology(topology);
 
   } else if (pipelineType == PipelineType::Compute) {
+    auto pipelineDx12 = dynamic_cast<ComputePipelineDx12*>(pipeline);
+    if (!pipelineDx12) {
+      GlobalLogger::Log(LogLevel::Error, "Invalid pipeline type");
+      return;
+    }
+
+    m_commandList_->SetPipelineState(pipelineDx12->getPipelineState());  // PSO
     m_commandList_->SetComputeRootSignature(pipelineDx12->getRootSignature());
   }
 
-  m_currentPipeline_ = pipelineDx12;
+  m_currentPipeline_ = pipeline;
 }
 
 void CommandBufferDx12::setViewport(const Viewport& viewport) {
@@ -146,6 +181,11 @@ void CommandBufferDx12::setViewport(const Viewport& viewport) {
     return;
   }
 
+  // not allowed in a bundle, the viewport of the executing list is used
+  if (isBundle()) {
+    return;
+  }
+
   D3D12_VIEWPORT viewportDx12;
   viewportDx12.TopLeftX = viewport.x;
   viewportDx12.TopLeftY = viewport.y;
@@ -163,6 +203,10 @@ void CommandBufferDx12::setScissor(const ScissorRect& scissor) {
     return;
   }
 
+  if (isBundle()) {
+    return;
+  }
+
   D3D12_RECT scissorDx12;
   scissorDx12.left   = scissor.x;
   scissorDx12.top    = scissor.y;
@@ -178,20 +222,22 @@ void CommandBufferDx12::bindVertexBuffer(uint32_t binding, Buffer* buffer, uint6
     return;
   }
 
-  DirectBufferDx12* directBuffer = dynamic_cast<DirectBufferDx12*>(buffer);
-  if (!directBuffer) {
-    GlobalLogger::Log(LogLevel::Error, "Buffer must be a DirectBufferDx12 type");
+  // descriptor buffers are accepted too - e.g. instance data written by a compute shader through a UAV
+  BufferDx12* bufferDx12 = dynamic_cast<BufferDx12*>(buffer);
+  if (!bufferDx12) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
     return;
   }
 
-  if (!directBuffer->isVertexBuffer() && !directBuffer->isInstanceBuffer()) {
+  const auto vertexFlags = BufferCreateFlag::VertexBuffer | BufferCreateFlag::InstanceBuffer;
+  if ((bufferDx12->getDesc().createFlags & vertexFlags) == BufferCreateFlag::None) {
     GlobalLogger::Log(LogLevel::Warning, "Buffer is not marked as vertex or instance buffer");
   }
 
   D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
-  vertexBufferView.BufferLocation = directBuffer->getGPUVirtualAddress() + offset;
-  vertexBufferView.SizeInBytes    = static_cast<UINT>(directBuffer->getSize() - offset);
-  vertexBufferView.StrideInBytes  = directBuffer->getStride();
+  vertexBufferView.BufferLocation = bufferDx12->getGPUVirtualAddress() + offset;
+  vertexBufferView.SizeInBytes    = static_cast<UINT>(bufferDx12->getSize() - offset);
+  vertexBufferView.StrideInBytes  = bufferDx12->getDesc().stride;
 
   m_commandList_->IASetVertexBuffers(binding, 1, &vertexBufferView);
 }
@@ -221,7 +267,9 @@ void CommandBufferDx12::bindIndexBuffer(Buffer* buffer, uint64_t offset, bool us
   m_commandList_->IASetIndexBuffer(&indexBufferView);
 }
 
-void CommandBufferDx12::bindDescriptorSet(uint32_t rootParameterIndex, DescriptorSet* set) {
+void CommandBufferDx12::bindDescriptorSet(uint32_t                  setIndex,
+                                          DescriptorSet*            set,
+                                          std::span<const uint32_t> dynamicOffsets) {
   if (!m_isRecording_) {
     GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
     return;
@@ -244,6 +292,48 @@ void CommandBufferDx12::bindDescriptorSet(uint32_t rootParameterIndex, Descripto
     return;
   }
 
+  const std::vector<DescriptorSetRootParametersDx12>* setRootParameters = nullptr;
+  switch (m_currentPipeline_->getType()) {
+    case PipelineType::Graphics:
+      setRootParameters = &static_cast<GraphicsPipelineDx12*>(m_currentPipeline_)->getSetRootParameters();
+      break;
+    case PipelineType::Compute:
+      setRootParameters = &static_cast<ComputePipelineDx12*>(m_currentPipeline_)->getSetRootParameters();
+      break;
+  }
+
+  if (!setRootParameters || setIndex >= setRootParameters->size()) {
+    GlobalLogger::Log(LogLevel::Error, "Descriptor set " + std::to_string(setIndex) + " is not in the pipeline layout");
+    return;
+  }
+
+  const auto& rootParameters = (*setRootParameters)[setIndex];
+  const bool  isGraphics     = m_currentPipeline_->getType() == PipelineType::Graphics;
+
+  // the address is recorded into the command list, so every bind can use its own offset
+  const uint32_t dynamicBufferCount = descriptorSetDx12->getDynamicUniformBufferCount();
+  if (dynamicBufferCount > 0 && rootParameters.firstDynamicBufferIndex != UINT32_MAX) {
+    for (uint32_t i = 0; i < dynamicBufferCount; ++i) {
+      uint32_t                  dynamicOffset = i < dynamicOffsets.size() ? dynamicOffsets[i] : 0;
+      D3D12_GPU_VIRTUAL_ADDRESS address       = descriptorSetDx12->getDynamicUniformBufferAddress(i, dynamicOffset);
+      if (address == 0) {
+        GlobalLogger::Log(LogLevel::Error, "Dynamic uniform buffer is not set");
+        continue;
+      }
+
+      uint32_t rootParameterIndex = rootParameters.firstDynamicBufferIndex + i;
+      if (isGraphics) {
+        m_commandList_->SetGraphicsRootConstantBufferView(rootParameterIndex, address);
+      } else {
+        m_commandList_->SetComputeRootConstantBufferView(rootParameterIndex, address);
+      }
+    }
+  }
+
+  if (!descriptorSetDx12->hasDescriptorTable() || rootParameters.tableIndex == UINT32_MAX) {
+    return;
+  }
+
   // true - sampler, false - srv/cbv/uav
   auto isSampler = descriptorSetLayoutDx12->isSamplerLayout();
 
@@ -255,15 +345,11 @@ void CommandBufferDx12::bindDescriptorSet(uint32_t rootParameterIndex, Descripto
   } else {
     gpuHandle = descriptorSetDx12->getGpuSrvUavCbvHandle(currentFrameIndex);
   }
-  m_commandList_->SetGraphicsRootDescriptorTable(rootParameterIndex, gpuHandle);
 
-  switch (m_currentPipeline_->getType()) {
-    case PipelineType::Graphics:
-      m_commandList_->SetGraphicsRootDescriptorTable(rootParameterIndex, gpuHandle);
-      break;
-    case PipelineType::Compute:
-      m_commandList_->SetComputeRootDescriptorTable(rootParameterIndex, gpuHandle);
-      break;
+  if (isGraphics) {
+    m_commandList_->SetGraphicsRootDescriptorTable(rootParameters.tableIndex, gpuHandle);
+  } else {
+    m_commandList_->SetComputeRootDescriptorTable(rootParameters.tableIndex, gpuHandle);
   }
 }
 
@@ -306,6 +392,72 @@ void CommandBufferDx12::drawIndexedInstanced(
   m_commandList_->DrawIndexedInstanced(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
+void CommandBufferDx12::drawIndexedIndirect(Buffer* argBuffer, uint64_t argOffset, uint32_t drawCount, uint32_t stride) {
+  if (!m_isRecording_ || !m_isRenderPassActive_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording or render pass is not active");
+    return;
+  }
+
+  BufferDx12* argBufferDx12 = dynamic_cast<BufferDx12*>(argBuffer);
+  if (!argBufferDx12) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
+    return;
+  }
+
+  ID3D12CommandSignature* commandSignature = m_device_->getDrawIndexedCommandSignature(stride);
+  if (!commandSignature) {
+    return;
+  }
+
+  m_commandList_->ExecuteIndirect(commandSignature, drawCount, argBufferDx12->getResource(), argOffset, nullptr, 0);
+}
+
+void CommandBufferDx12::drawIndexedIndirectCount(Buffer*  argBuffer,
+                                                 uint64_t argOffset,
+                                                 Buffer*  countBuffer,
+                                                 uint64_t countOffset,
+                                                 uint32_t maxDrawCount,
+                                                 uint32_t stride) {
+  if (!m_isRecording_ || !m_isRenderPassActive_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording or render pass is not active");
+    return;
+  }
+
+  BufferDx12* argBufferDx12   = dynamic_cast<BufferDx12*>(argBuffer);
+  BufferDx12* countBufferDx12 = dynamic_cast<BufferDx12*>(countBuffer);
+  if (!argBufferDx12 || !countBufferDx12) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
+    return;
+  }
+
+  ID3D12CommandSignature* commandSignature = m_device_->getDrawIndexedCommandSignature(stride);
+  if (!commandSignature) {
+    return;
+  }
+
+  // the GPU takes min(maxDrawCount, count buffer value)
+  m_commandList_->ExecuteIndirect(commandSignature,
+                                  maxDrawCount,
+                                  argBufferDx12->getResource(),
+                                  argOffset,
+                                  countBufferDx12->getResource(),
+                                  countOffset);
+}
+
+void CommandBufferDx12::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+  if (!m_isRecording_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
+    return;
+  }
+
+  if (m_isRenderPassActive_) {
+    GlobalLogger::Log(LogLevel::Error, "Cannot dispatch inside a render pass");
+    return;
+  }
+
+  m_commandList_->Dispatch(groupCountX, groupCountY, groupCountZ);
+}
+
 void CommandBufferDx12::resourceBarrier(const ResourceBarrierDesc& barrier) {
   if (!m_isRecording_) {
     GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
@@ -345,9 +497,50 @@ void CommandBufferDx12::resourceBarrier(const ResourceBarrierDesc& barrier) {
   textureDx12->updateCurrentState_(barrier.newLayout);
 }
 
+void CommandBufferDx12::bufferBarrier(const BufferBarrierDesc& barrier) {
+  if (!m_isRecording_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
+    return;
+  }
+
+  BufferDx12* bufferDx12 = dynamic_cast<BufferDx12*>(barrier.buffer);
+  if (!bufferDx12) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
+    return;
+  }
+
+  D3D12_RESOURCE_BARRIER barrierDx12 = {};
+  barrierDx12.Flags                  = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+
+  // the tracked state wins over barrier.oldState, the buffer may have been transitioned elsewhere (e.g. on creation)
+  auto oldState = bufferDx12->getCurrentState();
+  auto newState = g_getBufferStateDx12(barrier.newState);
+
+  if (oldState == newState) {
+    if (newState != D3D12_RESOURCE_STATE_UNORDERED_ACCESS) {
+      return;
+    }
+
+    // UAV -> UAV, only the writes have to finish
+    barrierDx12.Type          = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    barrierDx12.UAV.pResource = bufferDx12->getResource();
+  } else {
+    barrierDx12.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrierDx12.Transition.pResource   = bufferDx12->getResource();
+    barrierDx12.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrierDx12.Transition.StateBefore = oldState;
+    barrierDx12.Transition.StateAfter  = newState;
+  }
+
+  m_commandList_->ResourceBarrier(1, &barrierDx12);
+
+  bufferDx12->updateCurrentState(newState);
+}
+
 void CommandBufferDx12::beginRenderPass(RenderPass*                    renderPass,
                                         Framebuffer*                   framebuffer,
-                                        const std::vector<ClearValue>& clearValues) {
+                                        const std::vector<ClearValue>& clearValues,
+                                        RenderPassContents /*contents*/) {
   if (!m_isRecording_) {
     GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
     return;
@@ -424,6 +617,26 @@ void CommandBufferDx12::endRenderPass() {
   m_currentFramebuffer_ = nullptr;
 }
 
+void CommandBufferDx12::executeCommands(std::span<CommandBuffer* const> commandBuffers) {
+  if (!m_isRecording_ || !m_isRenderPassActive_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording or render pass is not active");
+    return;
+  }
+
+  for (auto commandBuffer : commandBuffers) {
+    CommandBufferDx12* commandBufferDx12 = dynamic_cast<CommandBufferDx12*>(commandBuffer);
+    if (!commandBufferDx12 || !commandBufferDx12->isBundle()) {
+      GlobalLogger::Log(LogLevel::Error, "Invalid command buffer type, only bundles can be executed");
+      continue;
+    }
+
+    m_commandList_->ExecuteBundle(commandBufferDx12->getCommandList());
+  }
+
+  // the state set by the bundles stays in the list, the pipeline has to be set again before the next binds
+  m_currentPipeline_ = nullptr;
+}
+
 void CommandBufferDx12::copyBuffer(
     Buffer* srcBuffer, Buffer* dstBuffer, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) {
   if (!m_isRecording_) {
@@ -858,38 +1071,43 @@ bool CommandAllocatorManager::initialize(ID3D12Device* device, uint32_t allocato
 }
 
 void CommandAllocatorManager::release() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_availableAllocators.clear();
+  m_availableBundleAllocators.clear();
   m_usedAllocators.clear();
   m_device = nullptr;
 }
 
-ID3D12CommandAllocator* CommandAllocatorManager::getCommandAllocator() {
+ID3D12CommandAllocator* CommandAllocatorManager::getCommandAllocator(D3D12_COMMAND_LIST_TYPE type) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
   if (!m_device) {
     GlobalLogger::Log(LogLevel::Error, "Manager not initialized");
     return nullptr;
   }
 
   // Try to reuse an existing allocator
-  if (!m_availableAllocators.empty()) {
-    ComPtr<ID3D12CommandAllocator> allocator = m_availableAllocators.back();
-    m_availableAllocators.pop_back();
+  auto& availableAllocators = getAvailableAllocators_(type);
+  if (!availableAllocators.empty()) {
+    ComPtr<ID3D12CommandAllocator> allocator = availableAllocators.back();
+    availableAllocators.pop_back();
 
     allocator->Reset();
 
-    m_usedAllocators.push_back(allocator);
+    m_usedAllocators.push_back({allocator, type});
 
     return allocator.Get();
   }
 
   ComPtr<ID3D12CommandAllocator> allocator;
-  HRESULT hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator));
+  HRESULT hr = m_device->CreateCommandAllocator(type, IID_PPV_ARGS(&allocator));
 
   if (FAILED(hr)) {
     GlobalLogger::Log(LogLevel::Error, "Failed to create command allocator");
     return nullptr;
   }
 
-  m_usedAllocators.push_back(allocator);
+  m_usedAllocators.push_back({allocator, type});
 
   return allocator.Get();
 }
@@ -899,9 +1117,11 @@ void CommandAllocatorManager::returnCommandAllocator(ID3D12CommandAllocator* all
     return;
   }
 
+  std::lock_guard<std::mutex> lock(m_mutex);
+
   for (auto it = m_usedAllocators.begin(); it != m_usedAllocators.end(); ++it) {
-    if (it->Get() == allocator) {
-      m_availableAllocators.push_back(*it);
+    if (it->allocator.Get() == allocator) {
+      getAvailableAllocators_(it->type).push_back(it->allocator);
       m_usedAllocators.erase(it);
       return;
     }
@@ -910,6 +1130,11 @@ void CommandAllocatorManager::returnCommandAllocator(ID3D12CommandAllocator* all
   GlobalLogger::Log(LogLevel::Warning, "Allocator not found in used list");
 }
 
+std::vector<ComPtr<ID3D12CommandAllocator>>& CommandAllocatorManager::getAvailableAllocators_(
+    D3D12_COMMAND_LIST_TYPE type) {
+  return type == D3D12_COMMAND_LIST_TYPE_BUNDLE ? m_availableBundleAllocators : m_availableAllocators;
+}
+
 }  // namespace rhi
 }  // namespace gfx
 }  // namespace arise
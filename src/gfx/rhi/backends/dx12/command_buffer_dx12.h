@@ -4,6 +4,9 @@
 #include "gfx/rhi/interface/command_buffer.h"
 #include "platform/windows/windows_platform_setup.h"
 
+#include <mutex>
+#include <vector>
+
 #ifdef ARISE_RHI_DX12
 
 namespace arise {
@@ -14,7 +17,6 @@ class DeviceDx12;
 class BufferDx12;
 class TextureDx12;
 class DescriptorSetDx12;
-class GraphicsPipelineDx12;
 class RenderPassDx12;
 class FramebufferDx12;
 
@@ -38,6 +40,8 @@ class CommandBufferDx12 : public CommandBuffer {
   void begin() override;
   void end() override;
   void reset() override;
+  // @note a bundle sets the descriptor heaps of the current frame, they must match the heaps of the executing list
+  void beginSecondary(RenderPass* renderPass, Framebuffer* framebuffer) override;
 
   // Pipeline state
   void setPipeline(Pipeline* pipeline) override;
@@ -47,27 +51,37 @@ class CommandBufferDx12 : public CommandBuffer {
   // Resource binding
   void bindVertexBuffer(uint32_t binding, Buffer* buffer, uint64_t offset = 0) override;
   void bindIndexBuffer(Buffer* buffer, uint64_t offset = 0, bool use32BitIndices = false) override;
-  // @param rootParameterIndex: Root parameter index as defined in the root signature. 
+  // @param setIndex: index of the set in the pipeline layout, mapped to its root parameters (descriptor table and root
+  //                  CBVs of dynamic uniform buffers)
   // @note  descriptor set should be compatible with the pipeline's root signature.
-  void bindDescriptorSet(uint32_t rootParameterIndex, DescriptorSet* set) override;
+  void bindDescriptorSet(uint32_t setIndex, DescriptorSet* set, std::span<const uint32_t> dynamicOffsets = {}) override;
 
   // Draw commands
   void draw(uint32_t vertexCount, uint32_t firstVertex = 0) override;
   void drawIndexed(uint32_t indexCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0) override;
   void drawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override;
   void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
-  
+  void drawIndexedIndirect(Buffer* argBuffer, uint64_t argOffset, uint32_t drawCount, uint32_t stride = sizeof(DrawIndexedIndirectCommand)) override;
+  void drawIndexedIndirectCount(Buffer* argBuffer, uint64_t argOffset, Buffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride = sizeof(DrawIndexedIndirectCommand)) override;
+
+  // Compute dispatch
+  void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) override;
+
   // Resource barriers
   void resourceBarrier(const ResourceBarrierDesc& barrier) override;
+  void bufferBarrier(const BufferBarrierDesc& barrier) override;
 
   // Render pass operations
   /**
    * @note DirectX 12 doesn't have the concept of render passes like Vulkan. These methods emulate Vulkan's render pass 
    *       behavior by managing render target binding, clearing, and resource state transitions to provide a unified 
    *       API across backends.
+   *
+   * @note contents is ignored, bundles and inline commands can be mixed in a DX12 command list.
    */
-  void beginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const std::vector<ClearValue>& clearValues) override;
+  void beginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const std::vector<ClearValue>& clearValues, RenderPassContents contents = RenderPassContents::Inline) override;
   void endRenderPass() override;
+  void executeCommands(std::span<CommandBuffer* const> commandBuffers) override;
 
   // Copy operations
   void copyBuffer(Buffer* srcBuffer, Buffer* dstBuffer, uint64_t srcOffset = 0, uint64_t dstOffset = 0, uint64_t size = 0) override;
@@ -89,6 +103,8 @@ class CommandBufferDx12 : public CommandBuffer {
 
   ID3D12CommandAllocator* getCommandAllocator() const { return m_commandAllocator_; }
 
+  bool isBundle() const { return m_commandList_->GetType() == D3D12_COMMAND_LIST_TYPE_BUNDLE; }
+
   /**
    * Binds the GPU descriptor heaps (CBV/SRV/UAV heap and Sampler heap)
    * 
@@ -103,11 +119,12 @@ class CommandBufferDx12 : public CommandBuffer {
   ComPtr<ID3D12GraphicsCommandList> m_commandList_;
   ID3D12CommandAllocator*    m_commandAllocator_;
 
-  GraphicsPipelineDx12*    m_currentPipeline_    = nullptr;
+  Pipeline*                m_currentPipeline_    = nullptr;
   RenderPassDx12*          m_currentRenderPass_  = nullptr;
   FramebufferDx12*         m_currentFramebuffer_ = nullptr;
   bool                     m_isRenderPassActive_ = false;
   bool                     m_isRecording_        = false;
+  bool                     m_isSecondary_        = false;  // recording inside of the render pass of a primary
 };
 
 // clang-format on
@@ -120,14 +137,24 @@ class CommandAllocatorManager {
   bool initialize(ID3D12Device* device, uint32_t allocatorCount = 8);
   void release();
 
-  ID3D12CommandAllocator* getCommandAllocator();
+  // thread safe - bundles are created by the recording threads, they need allocators of the bundle type
+  ID3D12CommandAllocator* getCommandAllocator(D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
 
   void returnCommandAllocator(ID3D12CommandAllocator* allocator);
 
   private:
+  struct UsedAllocator {
+    ComPtr<ID3D12CommandAllocator> allocator;
+    D3D12_COMMAND_LIST_TYPE        type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+  };
+
+  std::vector<ComPtr<ID3D12CommandAllocator>>& getAvailableAllocators_(D3D12_COMMAND_LIST_TYPE type);
+
   ID3D12Device*                               m_device = nullptr;
   std::vector<ComPtr<ID3D12CommandAllocator>> m_availableAllocators;
-  std::vector<ComPtr<ID3D12CommandAllocator>> m_usedAllocators;
+  std::vector<ComPtr<ID3D12CommandAllocator>> m_availableBundleAllocators;
+  std::vector<UsedAllocator>                  m_usedAllocators;
+  std::mutex                                  m_mutex;
 };
 
 }  // namespace rhi
@@ -46,10 +46,20 @@ DescriptorSetLayoutDx12::DescriptorSetLayoutDx12(const DescriptorSetLayoutDesc&
   }
 
   for (const auto& binding : desc.bindings) {
+    if (binding.type == ShaderBindingType::UniformbufferDynamic) {
+      m_dynamicUniformBufferBindings_.push_back(binding);
+      continue;
+    }
     D3D12_DESCRIPTOR_RANGE_TYPE type = g_getShaderBindingTypeDx12(binding.type);
     m_bindingsByType[type].push_back(binding);
   }
 
+  std::sort(m_dynamicUniformBufferBindings_.begin(),
+            m_dynamicUniformBufferBindings_.end(),
+            [](const DescriptorSetLayoutBindingDesc& a, const DescriptorSetLayoutBindingDesc& b) {
+              return a.binding < b.binding;
+            });
+
   for (auto& [type, bindings] : m_bindingsByType) {
     std::sort(bindings.begin(),
               bindings.end(),
@@ -109,6 +119,10 @@ DescriptorSetDx12::DescriptorSetDx12(DeviceDx12* device, const DescriptorSetLayo
   } else {
     m_srvUavCbvIndices_.assign(frameCount, UINT32_MAX);
   }
+
+  for (const auto& binding : layout->getDynamicUniformBufferBindings()) {
+    m_dynamicUniformBuffers_.push_back(DynamicUniformBuffer{binding.binding});
+  }
 }
 
 DescriptorSetDx12::~DescriptorSetDx12() {
@@ -133,6 +147,21 @@ void DescriptorSetDx12::setUniformBuffer(uint32_t binding, Buffer* buffer, uint6
     return;
   }
 
+  // dynamic uniform buffers are root CBVs, only the address is stored
+  auto dynamicIt = std::find_if(m_dynamicUniformBuffers_.begin(),
+                                m_dynamicUniformBuffers_.end(),
+                                [binding](const DynamicUniformBuffer& dynamicBuffer) {
+                                  return dynamicBuffer.binding == binding;
+                                });
+  if (dynamicIt != m_dynamicUniformBuffers_.end()) {
+    dynamicIt->buffer = dynamic_cast<BufferDx12*>(buffer);
+    dynamicIt->offset = offset;
+    if (!dynamicIt->buffer) {
+      GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
+    }
+    return;
+  }
+
   DescriptorBufferDx12* bufferDx12 = dynamic_cast<DescriptorBufferDx12*>(buffer);
   if (!bufferDx12) {
     GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
@@ -175,42 +204,7 @@ void DescriptorSetDx12::setTextureSampler(uint32_t binding, Texture* texture, Sa
 }
 
 void DescriptorSetDx12::setTexture(uint32_t binding, Texture* texture, ResourceLayout layout) {
-  if (!texture) {
-    GlobalLogger::Log(LogLevel::Error, "Null texture");
-    return;
-  }
-
-  if (m_layout_->isSamplerLayout()) {
-    GlobalLogger::Log(LogLevel::Error, "Cannot set texture on a sampler descriptor set");
-    return;
-  }
-
-  TextureDx12* textureDx12 = dynamic_cast<TextureDx12*>(texture);
-  if (!textureDx12) {
-    GlobalLogger::Log(LogLevel::Error, "Invalid texture type");
-    return;
-  }
-
-  auto*    frameResMgr  = m_device_->getFrameResourcesManager();
-  uint32_t currentFrame = frameResMgr->getCurrentFrameIndex();
-  if (m_srvUavCbvIndices_[currentFrame] == UINT32_MAX) {
-    uint32_t totalDesc                = m_layout_->getTotalDescriptors();
-    m_srvUavCbvIndices_[currentFrame] = frameResMgr->getCbvSrvUavHeap(currentFrame)->allocate(totalDesc);
-  }
-
-  DescriptorHeapDx12* cpuHeap = m_device_->getCpuCbvSrvUavHeap();
-  DescriptorHeapDx12* gpuHeap = frameResMgr->getCurrentCbvSrvUavHeap();
-  if (!cpuHeap || !gpuHeap) {
-    GlobalLogger::Log(LogLevel::Error, "Descriptor heaps not available");
-    return;
-  }
-
-  uint32_t srcIndex = textureDx12->getSrvDescriptorIndex();
-
-  uint32_t bindingOffset = findBindingOffset_(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, binding);
-  uint32_t dstIndex      = m_srvUavCbvIndices_[currentFrame] + bindingOffset;
-
-  gpuHeap->copyDescriptors(cpuHeap, srcIndex, dstIndex, 1);
+  setTextureArrayElement(binding, 0, texture, layout);
 }
 
 void DescriptorSetDx12::setSampler(uint32_t binding, Sampler* sampler) {
@@ -302,6 +296,52 @@ void DescriptorSetDx12::setStorageBuffer(uint32_t binding, Buffer* buffer, uint6
 
   gpuHeap->copyDescriptors(cpuHeap, srcIndex, dstIndex, 1);
 }
+void DescriptorSetDx12::setTextureArrayElement(uint32_t       binding,
+                                               uint32_t       arrayElement,
+                                               Texture*       texture,
+                                               ResourceLayout layout) {
+  if (!texture) {
+    GlobalLogger::Log(LogLevel::Error, "Null texture");
+    return;
+  }
+
+  if (m_layout_->isSamplerLayout()) {
+    GlobalLogger::Log(LogLevel::Error, "Cannot set texture on a sampler descriptor set");
+    return;
+  }
+
+  TextureDx12* textureDx12 = dynamic_cast<TextureDx12*>(texture);
+  if (!textureDx12) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid texture type");
+    return;
+  }
+
+  auto*    frameResMgr  = m_device_->getFrameResourcesManager();
+  uint32_t currentFrame = frameResMgr->getCurrentFrameIndex();
+  if (m_srvUavCbvIndices_[currentFrame] == UINT32_MAX) {
+    uint32_t totalDesc                = m_layout_->getTotalDescriptors();
+    m_srvUavCbvIndices_[currentFrame] = frameResMgr->getCbvSrvUavHeap(currentFrame)->allocate(totalDesc);
+  }
+
+  DescriptorHeapDx12* cpuHeap = m_device_->getCpuCbvSrvUavHeap();
+  DescriptorHeapDx12* gpuHeap = frameResMgr->getCurrentCbvSrvUavHeap();
+  if (!cpuHeap || !gpuHeap) {
+    GlobalLogger::Log(LogLevel::Error, "Descriptor heaps not available");
+    return;
+  }
+
+  uint32_t srcIndex = textureDx12->getSrvDescriptorIndex();
+
+  // array elements occupy consecutive registers (binding + element) of the range
+  uint32_t bindingOffset = findBindingOffset_(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, binding + arrayElement);
+  if (bindingOffset == UINT32_MAX) {
+    return;
+  }
+  uint32_t dstIndex = m_srvUavCbvIndices_[currentFrame] + bindingOffset;
+
+  gpuHeap->copyDescriptors(cpuHeap, srcIndex, dstIndex, 1);
+}
+
 [[nodiscard]] D3D12_GPU_DESCRIPTOR_HANDLE DescriptorSetDx12::getGpuSrvUavCbvHandle(uint32_t frame) const {
   auto* frameResMgr = m_device_->getFrameResourcesManager();
   auto* heap        = frameResMgr->getCbvSrvUavHeap(frame);
@@ -334,6 +374,16 @@ void DescriptorSetDx12::setStorageBuffer(uint32_t binding, Buffer* buffer, uint6
   return heap->getGpuHandle(m_samplerIndices_[frame]);
 }
 
+[[nodiscard]] D3D12_GPU_VIRTUAL_ADDRESS DescriptorSetDx12::getDynamicUniformBufferAddress(uint32_t index,
+                                                                                    uint32_t dynamicOffset) const {
+  if (index >= m_dynamicUniformBuffers_.size() || !m_dynamicUniformBuffers_[index].buffer) {
+    return 0;
+  }
+
+  const auto& dynamicBuffer = m_dynamicUniformBuffers_[index];
+  return dynamicBuffer.buffer->getGPUVirtualAddress() + dynamicBuffer.offset + dynamicOffset;
+}
+
 uint32_t DescriptorSetDx12::findBindingOffset_(D3D12_DESCRIPTOR_RANGE_TYPE rangeType, uint32_t binding) const {
   const auto& bindingsByType = m_layout_->getBindingsByType();
 
@@ -524,7 +574,8 @@ void DescriptorHeapDx12::copyDescriptors(const DescriptorHeapDx12* srcHeap,
 // -------------------------------------------------------------------------
 
 // TODO: Make these sizes configurable
-constexpr uint32_t FRAME_CBV_SRV_UAV_HEAP_SIZE = 2048;
+// the bindless material texture table takes a large block of it
+constexpr uint32_t FRAME_CBV_SRV_UAV_HEAP_SIZE = 4096;
 constexpr uint32_t FRAME_SAMPLER_HEAP_SIZE     = 128;
 
 FrameResourcesManager::~FrameResourcesManager() {
@@ -22,6 +22,9 @@ class SamplerDx12;
  * In DirectX 12, this corresponds to a portion of the root signature.
  * We map Vulkan's descriptor set concept to a segment of descriptors in a DX12 descriptor table.
  * So basically DescriptorSetLayout is a single descriptor table in root parameter.
+ *
+ * Descriptor tables have no dynamic offsets, so UniformbufferDynamic bindings are not part of the table - each of them
+ * becomes a root CBV whose address (including the dynamic offset) is set when the set is bound.
  */
 class DescriptorSetLayoutDx12 : public DescriptorSetLayout {
   public:
@@ -44,6 +47,11 @@ class DescriptorSetLayoutDx12 : public DescriptorSetLayout {
 
   uint32_t getTotalDescriptors() const { return m_totalDescriptors_; }
 
+  // sorted by binding - the order of the dynamic offsets and of the root CBVs
+  const std::vector<DescriptorSetLayoutBindingDesc>& getDynamicUniformBufferBindings() const {
+    return m_dynamicUniformBufferBindings_;
+  }
+
   private:
   DeviceDx12* m_device_{};
 
@@ -51,6 +59,8 @@ class DescriptorSetLayoutDx12 : public DescriptorSetLayout {
 
   std::vector<D3D12_DESCRIPTOR_RANGE> m_descriptorRanges;
 
+  std::vector<DescriptorSetLayoutBindingDesc> m_dynamicUniformBufferBindings_;
+
   bool     m_isSamplerLayout   = false;
   uint32_t m_totalDescriptors_ = 0;
 };
@@ -73,6 +83,10 @@ class DescriptorSetDx12 : public DescriptorSet {
   void setTexture(uint32_t binding, Texture* texture, ResourceLayout layout = ResourceLayout::ShaderReadOnly) override;
   void setSampler(uint32_t binding, Sampler* sampler) override;
   void setStorageBuffer(uint32_t binding, Buffer* buffer, uint64_t offset = 0, uint64_t range = 0) override;
+  void setTextureArrayElement(uint32_t       binding,
+                              uint32_t       arrayElement,
+                              Texture*       texture,
+                              ResourceLayout layout = ResourceLayout::ShaderReadOnly) override;
 
   const DescriptorSetLayout* getLayout() const { return m_layout_; }
 
@@ -82,15 +96,32 @@ class DescriptorSetDx12 : public DescriptorSet {
 
   [[nodiscard]] D3D12_GPU_DESCRIPTOR_HANDLE getGpuSamplerHandle(uint32_t frame) const;
 
+  // false for sets that only consist of dynamic uniform buffers
+  bool hasDescriptorTable() const { return m_layout_->getTotalDescriptors() > 0; }
+
+  uint32_t getDynamicUniformBufferCount() const { return static_cast<uint32_t>(m_dynamicUniformBuffers_.size()); }
+
+  // Address of the root CBV of the index-th dynamic uniform buffer, 0 if no buffer was set
+  [[nodiscard]] D3D12_GPU_VIRTUAL_ADDRESS getDynamicUniformBufferAddress(uint32_t index, uint32_t dynamicOffset) const;
+
   private:
   uint32_t findBindingOffset_(D3D12_DESCRIPTOR_RANGE_TYPE rangeType, uint32_t binding) const;
 
+  struct DynamicUniformBuffer {
+    uint32_t    binding = 0;
+    BufferDx12* buffer  = nullptr;
+    uint64_t    offset  = 0;
+  };
+
   DeviceDx12*                    m_device_ = nullptr;
   const DescriptorSetLayoutDx12* m_layout_ = nullptr;
 
   // Resource references
   std::vector<uint32_t> m_srvUavCbvIndices_{};
   std::vector<uint32_t> m_samplerIndices_{};
+
+  // sorted by binding - the order of the dynamic offsets
+  std::vector<DynamicUniformBuffer> m_dynamicUniformBuffers_;
 };
 
 /**
@@ -276,6 +276,10 @@ std::unique_ptr<GraphicsPipeline> DeviceDx12::createGraphicsPipeline(const Graph
   return std::make_unique<GraphicsPipelineDx12>(desc, this);
 }
 
+std::unique_ptr<ComputePipeline> DeviceDx12::createComputePipeline(const ComputePipelineDesc& desc) {
+  return std::make_unique<ComputePipelineDx12>(desc, this);
+}
+
 std::unique_ptr<DescriptorSetLayout> DeviceDx12::createDescriptorSetLayout(const DescriptorSetLayoutDesc& desc) {
   return std::make_unique<DescriptorSetLayoutDx12>(desc, this);
 }
@@ -298,22 +302,16 @@ std::unique_ptr<Framebuffer> DeviceDx12::createFramebuffer(const FramebufferDesc
 }
 
 std::unique_ptr<CommandBuffer> DeviceDx12::createCommandBuffer(const CommandBufferDesc& desc) {
-  // NOTE: This implementation is not thread-safe.
-  // In a production multi-threaded engine, you would need to protect
-  // the command allocator pool with a mutex.
+  // every command buffer owns its allocator, so command buffers can be recorded on different threads
+  const D3D12_COMMAND_LIST_TYPE type = desc.primary ? D3D12_COMMAND_LIST_TYPE_DIRECT : D3D12_COMMAND_LIST_TYPE_BUNDLE;
 
-  ID3D12CommandAllocator* commandAllocator = m_commandAllocatorManager_.getCommandAllocator();
+  ID3D12CommandAllocator* commandAllocator = m_commandAllocatorManager_.getCommandAllocator(type);
   if (!commandAllocator) {
     return nullptr;
   }
 
   ComPtr<ID3D12GraphicsCommandList> commandList;
-  HRESULT                           hr
-      = m_device_->CreateCommandList(0,
-                                     desc.primary ? D3D12_COMMAND_LIST_TYPE_DIRECT : D3D12_COMMAND_LIST_TYPE_BUNDLE,
-                                     commandAllocator,
-                                     nullptr,
-                                     IID_PPV_ARGS(&commandList));
+  HRESULT hr = m_device_->CreateCommandList(0, type, commandAllocator, nullptr, IID_PPV_ARGS(&commandList));
 
   if (FAILED(hr)) {
     GlobalLogger::Log(LogLevel::Error, "Failed to create command list");
@@ -439,6 +437,36 @@ void DeviceDx12::submitCommandBuffer(CommandBuffer*                 cmdBuffer,
   }
 }
 
+ID3D12CommandSignature* DeviceDx12::getDrawIndexedCommandSignature(uint32_t stride) {
+  std::lock_guard<std::mutex> lock(m_commandSignatureMutex_);
+
+  auto it = m_drawIndexedCommandSignatures_.find(stride);
+  if (it != m_drawIndexedCommandSignatures_.end()) {
+    return it->second.Get();
+  }
+
+  D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+  argumentDesc.Type                         = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+  D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+  signatureDesc.ByteStride                   = stride;
+  signatureDesc.NumArgumentDescs             = 1;
+  signatureDesc.pArgumentDescs               = &argumentDesc;
+  signatureDesc.NodeMask                     = 0;
+
+  // no root signature needed, the signature only changes draw arguments
+  ComPtr<ID3D12CommandSignature> commandSignature;
+  HRESULT hr = m_device_->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&commandSignature));
+  if (FAILED(hr)) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create indirect draw command signature");
+    return nullptr;
+  }
+
+  auto* result = commandSignature.Get();
+  m_drawIndexedCommandSignatures_.emplace(stride, std::move(commandSignature));
+  return result;
+}
+
 void DeviceDx12::waitIdle() {
   ComPtr<ID3D12Fence> fence;
   HRESULT             hr = m_device_->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence));
@@ -8,6 +8,7 @@
 
 #include <D3D12MemAlloc.h>
 #include <mutex>
+#include <unordered_map>
 
 #ifdef ARISE_RHI_DX12
 
@@ -27,6 +28,7 @@ class DeviceDx12 : public Device {
   std::unique_ptr<Sampler>             createSampler(const SamplerDesc& desc) override;
   std::unique_ptr<Shader>              createShader(const ShaderDesc& desc) override;
   std::unique_ptr<GraphicsPipeline>    createGraphicsPipeline(const GraphicsPipelineDesc& desc) override;
+  std::unique_ptr<ComputePipeline>     createComputePipeline(const ComputePipelineDesc& desc) override;
   std::unique_ptr<DescriptorSetLayout> createDescriptorSetLayout(const DescriptorSetLayoutDesc& desc) override;
   std::unique_ptr<DescriptorSet>       createDescriptorSet(const DescriptorSetLayout* layout) override;
   std::unique_ptr<RenderPass>          createRenderPass(const RenderPassDesc& desc) override;
@@ -72,6 +74,11 @@ class DeviceDx12 : public Device {
     m_commandAllocatorManager_.returnCommandAllocator(allocator);
   }
 
+  /**
+   * Command signature of ExecuteIndirect for DrawIndexedIndirectCommand records, created on first use per stride
+   */
+  ID3D12CommandSignature* getDrawIndexedCommandSignature(uint32_t stride);
+
   private:
   bool createFactory_();
   bool createDevice_();
@@ -101,6 +108,9 @@ class DeviceDx12 : public Device {
   FrameResourcesManager m_frameResourcesManager;
 
   CommandAllocatorManager m_commandAllocatorManager_;
+
+  std::unordered_map<uint32_t, ComPtr<ID3D12CommandSignature>> m_drawIndexedCommandSignatures_;
+  std::mutex                                                   m_commandSignatureMutex_;
 };
 
 }  // namespace rhi
@@ -15,52 +15,44 @@ namespace arise {
 namespace gfx {
 namespace rhi {
 
-GraphicsPipelineDx12::GraphicsPipelineDx12(const GraphicsPipelineDesc& desc, DeviceDx12* device)
-    : GraphicsPipeline(desc)
-    , m_device_(device) {
-  if (!initialize_()) {
-    GlobalLogger::Log(LogLevel::Error, "Failed to initialize DirectX 12 graphics pipeline");
-  }
-}
+namespace {
 
-bool GraphicsPipelineDx12::rebuild() {
-  m_pipelineState_.Reset();
-  if (createPipelineState_()) {
-    GlobalLogger::Log(LogLevel::Info, "Successfully rebuilt DirectX 12 graphics pipeline");
-    m_updateFrame = -1;
-    return true;
-  } else {
-    GlobalLogger::Log(LogLevel::Error, "Failed to rebuild DirectX 12 graphics pipeline");
-    return false;
-  }
-}
-
-bool GraphicsPipelineDx12::initialize_() {
-  if (!createRootSignature_()) {
-    GlobalLogger::Log(LogLevel::Error, "Failed to create root signature for DX12 pipeline");
-    return false;
+D3D12_SHADER_VISIBILITY determineShaderVisibility(const std::vector<DescriptorSetLayoutBindingDesc>& bindings) {
+  if (bindings.empty()) {
+    return D3D12_SHADER_VISIBILITY_ALL;
   }
 
-  if (!createPipelineState_()) {
-    GlobalLogger::Log(LogLevel::Error, "Failed to create pipeline state object for DX12 pipeline");
-    return false;
+  ShaderStageFlag commonFlag = bindings[0].stageFlags;
+  for (size_t i = 1; i < bindings.size(); i++) {
+    if (bindings[i].stageFlags != commonFlag) {
+      return D3D12_SHADER_VISIBILITY_ALL;
+    }
   }
 
-  return true;
+  return g_getShaderVisibilityDx12(commonFlag);
 }
 
-bool GraphicsPipelineDx12::createRootSignature_() {
+// shared by graphics and compute pipelines, compute root signatures have no input assembler and are visible to all
+// stages
+bool createRootSignature(DeviceDx12*                                    device,
+                         const std::vector<const DescriptorSetLayout*>& setLayouts,
+                         bool                                           isCompute,
+                         ComPtr<ID3D12RootSignature>&                   rootSignature,
+                         std::vector<DescriptorSetRootParametersDx12>&  setRootParameters) {
   // Create root signature based on descriptor set layouts
-  // Each descriptor set layout becomes a descriptor table in a specific space
+  // Each descriptor set layout becomes a descriptor table in a specific space, its dynamic uniform buffers become root
+  // CBVs in the same space
 
   // Create root parameters - one for each descriptor set layout
   std::vector<D3D12_ROOT_PARAMETER> rootParameters;
 
   std::vector<std::vector<D3D12_DESCRIPTOR_RANGE>> allRanges;
-  allRanges.reserve(m_desc_.setLayouts.size());
+  allRanges.reserve(setLayouts.size());
+
+  setRootParameters.assign(setLayouts.size(), DescriptorSetRootParametersDx12{});
 
-  for (size_t i = 0; i < m_desc_.setLayouts.size(); ++i) {
-    const auto* layoutBase = m_desc_.setLayouts[i];
+  for (size_t i = 0; i < setLayouts.size(); ++i) {
+    const auto* layoutBase = setLayouts[i];
     if (!layoutBase) {
       GlobalLogger::Log(LogLevel::Error, "Null descriptor set layout provided");
       continue;
@@ -72,6 +64,20 @@ bool GraphicsPipelineDx12::createRootSignature_() {
       return false;
     }
 
+    const auto& dynamicBuffers = layout->getDynamicUniformBufferBindings();
+    if (!dynamicBuffers.empty()) {
+      setRootParameters[i].firstDynamicBufferIndex = static_cast<uint32_t>(rootParameters.size());
+    }
+    for (const auto& dynamicBuffer : dynamicBuffers) {
+      D3D12_ROOT_PARAMETER rootParam      = {};
+      rootParam.ParameterType             = D3D12_ROOT_PARAMETER_TYPE_CBV;
+      rootParam.ShaderVisibility          = isCompute ? D3D12_SHADER_VISIBILITY_ALL
+                                                      : g_getShaderVisibilityDx12(dynamicBuffer.stageFlags);
+      rootParam.Descriptor.ShaderRegister = dynamicBuffer.binding;
+      rootParam.Descriptor.RegisterSpace  = static_cast<UINT>(i);
+      rootParameters.push_back(rootParam);
+    }
+
     const auto& originalRanges = layout->getDescriptorRanges();
     if (originalRanges.empty()) {
       continue;
@@ -90,12 +96,14 @@ bool GraphicsPipelineDx12::createRootSignature_() {
 
     D3D12_ROOT_PARAMETER rootParam = {};
     rootParam.ParameterType        = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
-    rootParam.ShaderVisibility     = determineShaderVisibility_(layout->getDesc().bindings);
+    rootParam.ShaderVisibility
+        = isCompute ? D3D12_SHADER_VISIBILITY_ALL : determineShaderVisibility(layout->getDesc().bindings);
 
     // Set descriptor table parameters with the new ranges
     rootParam.DescriptorTable.NumDescriptorRanges = static_cast<UINT>(allRanges.back().size());
     rootParam.DescriptorTable.pDescriptorRanges   = allRanges.back().data();
 
+    setRootParameters[i].tableIndex = static_cast<uint32_t>(rootParameters.size());
     rootParameters.push_back(rootParam);
   }
 
@@ -107,7 +115,8 @@ bool GraphicsPipelineDx12::createRootSignature_() {
   rootSignatureDesc.pParameters               = rootParameters.empty() ? nullptr : rootParameters.data();
   rootSignatureDesc.NumStaticSamplers         = static_cast<UINT>(staticSamplers.size());
   rootSignatureDesc.pStaticSamplers           = staticSamplers.empty() ? nullptr : staticSamplers.data();
-  rootSignatureDesc.Flags                     = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+  rootSignatureDesc.Flags                     = isCompute ? D3D12_ROOT_SIGNATURE_FLAG_NONE
+                                                          : D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
 
   ID3DBlob* signature = nullptr;
   ID3DBlob* error     = nullptr;
@@ -128,10 +137,10 @@ bool GraphicsPipelineDx12::createRootSignature_() {
     return false;
   }
 
-  hr = m_device_->getDevice()->CreateRootSignature(0,  // Node mask (single GPU)
-                                                   signature->GetBufferPointer(),
-                                                   signature->GetBufferSize(),
-                                                   IID_PPV_ARGS(&m_rootSignature_));
+  hr = device->getDevice()->CreateRootSignature(0,  // Node mask (single GPU)
+                                                signature->GetBufferPointer(),
+                                                signature->GetBufferSize(),
+                                                IID_PPV_ARGS(&rootSignature));
 
   signature->Release();
   if (error) {
@@ -146,6 +155,46 @@ bool GraphicsPipelineDx12::createRootSignature_() {
   return true;
 }
 
+}  // namespace
+
+GraphicsPipelineDx12::GraphicsPipelineDx12(const GraphicsPipelineDesc& desc, DeviceDx12* device)
+    : GraphicsPipeline(desc)
+    , m_device_(device) {
+  if (!initialize_()) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to initialize DirectX 12 graphics pipeline");
+  }
+}
+
+bool GraphicsPipelineDx12::rebuild() {
+  m_pipelineState_.Reset();
+  if (createPipelineState_()) {
+    GlobalLogger::Log(LogLevel::Info, "Successfully rebuilt DirectX 12 graphics pipeline");
+    m_updateFrame = -1;
+    return true;
+  } else {
+    GlobalLogger::Log(LogLevel::Error, "Failed to rebuild DirectX 12 graphics pipeline");
+    return false;
+  }
+}
+
+bool GraphicsPipelineDx12::initialize_() {
+  if (!createRootSignature_()) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create root signature for DX12 pipeline");
+    return false;
+  }
+
+  if (!createPipelineState_()) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create pipeline state object for DX12 pipeline");
+    return false;
+  }
+
+  return true;
+}
+
+bool GraphicsPipelineDx12::createRootSignature_() {
+  return createRootSignature(m_device_, m_desc_.setLayouts, false, m_rootSignature_, m_setRootParameters_);
+}
+
 bool GraphicsPipelineDx12::createPipelineState_() {
   ComPtr<ID3DBlob> vertexShader;
   ComPtr<ID3DBlob> pixelShader;
@@ -374,20 +423,53 @@ bool GraphicsPipelineDx12::collectShaders_(ComPtr<ID3DBlob>& vertexShader,
   return true;
 }
 
-D3D12_SHADER_VISIBILITY GraphicsPipelineDx12::determineShaderVisibility_(
-    const std::vector<DescriptorSetLayoutBindingDesc>& bindings) {
-  if (bindings.empty()) {
-    return D3D12_SHADER_VISIBILITY_ALL;
+//-------------------------------------------------------------------------
+// ComputePipelineDx12 implementation
+//-------------------------------------------------------------------------
+
+ComputePipelineDx12::ComputePipelineDx12(const ComputePipelineDesc& desc, DeviceDx12* device)
+    : ComputePipeline(desc)
+    , m_device_(device) {
+  if (!createRootSignature(m_device_, m_desc_.setLayouts, true, m_rootSignature_, m_setRootParameters_)
+      || !createPipelineState_()) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to initialize DirectX 12 compute pipeline");
   }
+}
 
-  ShaderStageFlag commonFlag = bindings[0].stageFlags;
-  for (size_t i = 1; i < bindings.size(); i++) {
-    if (bindings[i].stageFlags != commonFlag) {
-      return D3D12_SHADER_VISIBILITY_ALL;
-    }
+bool ComputePipelineDx12::rebuild() {
+  m_pipelineState_.Reset();
+  if (createPipelineState_()) {
+    GlobalLogger::Log(LogLevel::Info, "Successfully rebuilt DirectX 12 compute pipeline");
+    m_updateFrame = -1;
+    return true;
+  } else {
+    GlobalLogger::Log(LogLevel::Error, "Failed to rebuild DirectX 12 compute pipeline");
+    return false;
   }
+}
 
-  return g_getShaderVisibilityDx12(commonFlag);
+bool ComputePipelineDx12::createPipelineState_() {
+  ShaderDx12* shaderDx12 = dynamic_cast<ShaderDx12*>(m_desc_.shader);
+  if (!shaderDx12 || !shaderDx12->getShaderBlob()) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid shader type for DX12 compute pipeline");
+    return false;
+  }
+
+  D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+  psoDesc.pRootSignature                    = m_rootSignature_.Get();
+  psoDesc.CS.pShaderBytecode                = shaderDx12->getShaderBlob()->GetBufferPointer();
+  psoDesc.CS.BytecodeLength                 = shaderDx12->getShaderBlob()->GetBufferSize();
+  psoDesc.NodeMask                          = 0;
+  psoDesc.Flags                             = D3D12_PIPELINE_STATE_FLAG_NONE;
+
+  HRESULT hr = m_device_->getDevice()->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState_));
+
+  if (FAILED(hr)) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create compute pipeline state object");
+    return false;
+  }
+
+  return true;
 }
 
 }  // namespace rhi
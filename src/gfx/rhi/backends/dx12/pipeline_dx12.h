@@ -20,6 +20,15 @@ class ShaderDx12;
 class RenderPassDx12;
 class DescriptorSetLayoutDx12;
 
+/**
+ * Root parameters of one descriptor set: its descriptor table and one root CBV per dynamic uniform buffer (in binding
+ * order, consecutive indices). UINT32_MAX if the set has no table / no dynamic uniform buffers.
+ */
+struct DescriptorSetRootParametersDx12 {
+  uint32_t tableIndex              = UINT32_MAX;
+  uint32_t firstDynamicBufferIndex = UINT32_MAX;
+};
+
 class GraphicsPipelineDx12 : public GraphicsPipeline {
   public:
   GraphicsPipelineDx12(const GraphicsPipelineDesc& desc, DeviceDx12* device);
@@ -37,6 +46,8 @@ class GraphicsPipelineDx12 : public GraphicsPipeline {
 
   ID3D12RootSignature* getRootSignature() const { return m_rootSignature_.Get(); }
 
+  const std::vector<DescriptorSetRootParametersDx12>& getSetRootParameters() const { return m_setRootParameters_; }
+
   private:
   bool initialize_();
 
@@ -49,17 +60,47 @@ class GraphicsPipelineDx12 : public GraphicsPipeline {
                        ComPtr<ID3DBlob>& hullShader,
                        ComPtr<ID3DBlob>& geometryShader);
 
-  D3D12_SHADER_VISIBILITY determineShaderVisibility_(const std::vector<DescriptorSetLayoutBindingDesc>& bindings);
-
   DeviceDx12* m_device_;
 
   ComPtr<ID3D12PipelineState> m_pipelineState_;
   ComPtr<ID3D12RootSignature> m_rootSignature_;
 
+  // indexed by set
+  std::vector<DescriptorSetRootParametersDx12> m_setRootParameters_;
+
   // Store blend factors separately since D3D12 doesn't include them in the blend state
   std::array<float, 4> m_blendFactors_;
 };
 
+class ComputePipelineDx12 : public ComputePipeline {
+  public:
+  ComputePipelineDx12(const ComputePipelineDesc& desc, DeviceDx12* device);
+  ~ComputePipelineDx12() = default;
+
+  ComputePipelineDx12(const ComputePipelineDx12&)            = delete;
+  ComputePipelineDx12& operator=(const ComputePipelineDx12&) = delete;
+
+  bool rebuild() override;
+
+  // DirectX 12-specific methods
+  ID3D12PipelineState* getPipelineState() const { return m_pipelineState_.Get(); }
+
+  ID3D12RootSignature* getRootSignature() const { return m_rootSignature_.Get(); }
+
+  const std::vector<DescriptorSetRootParametersDx12>& getSetRootParameters() const { return m_setRootParameters_; }
+
+  private:
+  bool createPipelineState_();
+
+  DeviceDx12* m_device_;
+
+  ComPtr<ID3D12PipelineState> m_pipelineState_;
+  ComPtr<ID3D12RootSignature> m_rootSignature_;
+
+  // indexed by set
+  std::vector<DescriptorSetRootParametersDx12> m_setRootParameters_;
+};
+
 }  // namespace rhi
 }  // namespace gfx
 }  // namespace arise
@@ -28,6 +28,7 @@ static const std::unordered_map<TextureFormat, DXGI_FORMAT> textureFormatMapping
   { TextureFormat::Rg8,        DXGI_FORMAT_R8G8_UNORM         },
   { TextureFormat::Rg16f,      DXGI_FORMAT_R16G16_FLOAT       },
   { TextureFormat::Rg32f,      DXGI_FORMAT_R32G32_FLOAT       },
+  { TextureFormat::Rg16Snorm,  DXGI_FORMAT_R16G16_SNORM       },
   { TextureFormat::D16,        DXGI_FORMAT_D16_UNORM          },
   { TextureFormat::D16S8,      DXGI_FORMAT_D24_UNORM_S8_UINT  }, // not support d16_s8 -> d24_s8
   { TextureFormat::D24,        DXGI_FORMAT_D24_UNORM_S8_UINT  }, // not support d24    -> d24_s8
@@ -202,6 +203,16 @@ static const std::unordered_map<ResourceLayout, D3D12_RESOURCE_STATES> resourceL
   { ResourceLayout::AccelerationStructure,          D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE                                                                        }
 };
 
+static const std::unordered_map<BufferState, D3D12_RESOURCE_STATES> bufferStateMapping = {
+  { BufferState::Common,           D3D12_RESOURCE_STATE_COMMON                                                                 },
+  { BufferState::ShaderRead,       D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE },
+  { BufferState::VertexBuffer,     D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER                                             },
+  { BufferState::UnorderedAccess,  D3D12_RESOURCE_STATE_UNORDERED_ACCESS                                                       },
+  { BufferState::IndirectArgument, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT                                                      },
+  { BufferState::CopySource,       D3D12_RESOURCE_STATE_COPY_SOURCE                                                            },
+  { BufferState::CopyDestination,  D3D12_RESOURCE_STATE_COPY_DEST                                                              }
+};
+
 // clang-format on
 
 int g_getTextureComponentCountDx12(TextureFormat type) {
@@ -229,6 +240,7 @@ int g_getTextureComponentCountDx12(TextureFormat type) {
     { TextureFormat::Rg8,        2 },
     { TextureFormat::Rg16f,      2 },
     { TextureFormat::Rg32f,      2 },
+    { TextureFormat::Rg16Snorm,  2 },
     
     { TextureFormat::D16,        1 },
     { TextureFormat::D16S8,      2 },
@@ -267,6 +279,7 @@ int g_getTexturePixelSizeDx12(TextureFormat type) {
     { TextureFormat::Rg8,         2 },
     { TextureFormat::Rg16f,       2 },
     { TextureFormat::Rg32f,       4 },
+    { TextureFormat::Rg16Snorm,   4 },
 
     { TextureFormat::D16,         2 },
     { TextureFormat::D16S8,       3 },
@@ -614,6 +627,10 @@ ResourceLayout g_getResourceLayoutDx12(D3D12_RESOURCE_STATES resourceState) {
   return getEnumMapping(resourceLayoutReverseMapping, resourceState, ResourceLayout::Count);
 }
 
+D3D12_RESOURCE_STATES g_getBufferStateDx12(BufferState bufferState) {
+  return getEnumMapping(bufferStateMapping, bufferState, D3D12_RESOURCE_STATE_COMMON);
+}
+
 }  // namespace rhi
 }  // namespace gfx
 }  // namespace arise
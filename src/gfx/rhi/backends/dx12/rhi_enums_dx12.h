@@ -58,6 +58,8 @@ void g_getDepthFormatForSRV(DXGI_FORMAT& texFormat, DXGI_FORMAT& srvFormat, DXGI
 D3D12_RESOURCE_STATES g_getResourceLayoutDx12(ResourceLayout resourceLayout);
 ResourceLayout        g_getResourceLayoutDx12(D3D12_RESOURCE_STATES resourceState);
 
+D3D12_RESOURCE_STATES g_getBufferStateDx12(BufferState bufferState);
+
 }  // namespace rhi
 }  // namespace gfx
 }  // namespace arise
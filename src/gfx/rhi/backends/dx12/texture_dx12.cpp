@@ -595,8 +595,9 @@ void TextureDx12::update(const void* data, size_t dataSize, uint32_t mipLevel, u
   // 3.
   cmdBufferDx12->getCommandList()->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
 
+  // same as TextureVk::recordUpload - a texture without a layout yet ends up ready to be sampled
   barrier.oldLayout = ResourceLayout::TransferDst;
-  barrier.newLayout = initialLayout;
+  barrier.newLayout = (initialLayout == ResourceLayout::Undefined) ? ResourceLayout::ShaderReadOnly : initialLayout;
   cmdBufferDx12->resourceBarrier(barrier);
 
   cmdBufferDx12->end();
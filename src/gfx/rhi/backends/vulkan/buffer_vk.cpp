@@ -165,8 +165,14 @@ VkBufferUsageFlags BufferVk::getBufferUsageFlags_() const {
     usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
   }
 
+  if ((m_desc_.createFlags & BufferCreateFlag::CpuAccess) != BufferCreateFlag::None) {
+    // constant sources of GPU copies, e.g. the zeroed draw counters of the GPU culling
+    usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  }
+
   if ((m_desc_.createFlags & BufferCreateFlag::VertexBuffer) != BufferCreateFlag::None) {
-    usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    // transfer source - the geometry arena copies its ranges when it grows or compacts
+    usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
   }
 
   if ((m_desc_.createFlags & BufferCreateFlag::InstanceBuffer) != BufferCreateFlag::None) {
@@ -174,7 +180,7 @@ VkBufferUsageFlags BufferVk::getBufferUsageFlags_() const {
   }
 
   if ((m_desc_.createFlags & BufferCreateFlag::IndexBuffer) != BufferCreateFlag::None) {
-    usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
   }
 
   if ((m_desc_.createFlags & BufferCreateFlag::Uav) != BufferCreateFlag::None) {
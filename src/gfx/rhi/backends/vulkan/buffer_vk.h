@@ -25,7 +25,7 @@ class BufferVk : public Buffer {
 
   bool isMapped() const { return m_isMapped_; }
 
-  void* getMappedData() const { return m_mappedData_; }
+  void* getMappedData() const override { return m_mappedData_; }
 
   private:
   friend class DeviceVk;
@@ -53,7 +53,10 @@ void CommandBufferVk::end() {
     return;
   }
 
-  if (m_isRenderPassActive_) {
+  // a secondary continues the render pass of its primary, the primary ends it
+  if (m_isSecondary_) {
+    m_isRenderPassActive_ = false;
+  } else if (m_isRenderPassActive_) {
     endRenderPass();
   }
 
@@ -64,6 +67,7 @@ void CommandBufferVk::end() {
   }
 
   m_isRecording_ = false;
+  m_isSecondary_ = false;
 }
 
 void CommandBufferVk::reset() {
@@ -78,10 +82,48 @@ void CommandBufferVk::reset() {
     return;
   }
 
-  m_currentPipeline_    = nullptr;
-  m_currentRenderPass_  = nullptr;
-  m_currentFramebuffer_ = nullptr;
-  m_isRenderPassActive_ = false;
+  m_currentPipelineLayout_ = VK_NULL_HANDLE;
+  m_currentRenderPass_     = nullptr;
+  m_currentFramebuffer_    = nullptr;
+  m_isRenderPassActive_    = false;
+  m_isSecondary_           = false;
+}
+
+void CommandBufferVk::beginSecondary(RenderPass* renderPass, Framebuffer* framebuffer) {
+  if (m_isRecording_) {
+    GlobalLogger::Log(LogLevel::Warning, "Command buffer is already recording");
+    return;
+  }
+
+  RenderPassVk*  renderPassVk  = dynamic_cast<RenderPassVk*>(renderPass);
+  FramebufferVk* framebufferVk = dynamic_cast<FramebufferVk*>(framebuffer);
+
+  if (!renderPassVk || !framebufferVk) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid render pass or framebuffer type");
+    return;
+  }
+
+  VkCommandBufferInheritanceInfo inheritanceInfo = {};
+  inheritanceInfo.sType                          = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritanceInfo.renderPass                     = renderPassVk->getRenderPass();
+  inheritanceInfo.subpass                        = 0;
+  inheritanceInfo.framebuffer                    = framebufferVk->getFramebuffer();
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo         = &inheritanceInfo;
+
+  VkResult result = vkBeginCommandBuffer(m_commandBuffer_, &beginInfo);
+  if (result != VK_SUCCESS) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to begin secondary command buffer");
+    return;
+  }
+
+  // the render pass is active for the draw checks, but its begin and end (and the layouts) belong to the primary
+  m_isRecording_        = true;
+  m_isSecondary_        = true;
+  m_isRenderPassActive_ = true;
 }
 
 void CommandBufferVk::setPipeline(Pipeline* pipeline) {
@@ -90,29 +132,46 @@ void CommandBufferVk::setPipeline(Pipeline* pipeline) {
     return;
   }
 
-  auto pipelineVk = dynamic_cast<GraphicsPipelineVk*>(pipeline);
-  if (!pipelineVk) {
+  if (!pipeline) {
     GlobalLogger::Log(LogLevel::Error, "Invalid pipeline type");
     return;
   }
 
   VkPipelineBindPoint bindPoint;
-  switch (pipelineVk->getType()) {
-    case PipelineType::Graphics:
-      bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  VkPipeline          vkPipeline;
+  VkPipelineLayout    vkPipelineLayout;
+  switch (pipeline->getType()) {
+    case PipelineType::Graphics: {
+      auto graphicsPipelineVk = dynamic_cast<GraphicsPipelineVk*>(pipeline);
+      if (!graphicsPipelineVk) {
+        GlobalLogger::Log(LogLevel::Error, "Invalid pipeline type");
+        return;
+      }
+      bindPoint        = VK_PIPELINE_BIND_POINT_GRAPHICS;
+      vkPipeline       = graphicsPipelineVk->getPipeline();
+      vkPipelineLayout = graphicsPipelineVk->getPipelineLayout();
       break;
-    case PipelineType::Compute:
-      bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+    }
+    case PipelineType::Compute: {
+      auto computePipelineVk = dynamic_cast<ComputePipelineVk*>(pipeline);
+      if (!computePipelineVk) {
+        GlobalLogger::Log(LogLevel::Error, "Invalid pipeline type");
+        return;
+      }
+      bindPoint        = VK_PIPELINE_BIND_POINT_COMPUTE;
+      vkPipeline       = computePipelineVk->getPipeline();
+      vkPipelineLayout = computePipelineVk->getPipelineLayout();
       break;
+    }
     default:
       GlobalLogger::Log(LogLevel::Error, "Invalid pipeline type");
       return;
   }
 
-  vkCmdBindPipeline(m_commandBuffer_, bindPoint, pipelineVk->getPipeline());
+  vkCmdBindPipeline(m_commandBuffer_, bindPoint, vkPipeline);
 
-  m_currentPipeline_  = pipelineVk;
-  m_currentBindPoint_ = bindPoint;
+  m_currentPipelineLayout_ = vkPipelineLayout;
+  m_currentBindPoint_      = bindPoint;
 }
 
 void CommandBufferVk::setViewport(const Viewport& viewport) {
@@ -179,13 +238,15 @@ void CommandBufferVk::bindIndexBuffer(Buffer* buffer, uint64_t offset, bool use3
   vkCmdBindIndexBuffer(m_commandBuffer_, bufferVk->getBuffer(), offset, indexType);
 }
 
-void CommandBufferVk::bindDescriptorSet(uint32_t setIndex, DescriptorSet* set) {
+void CommandBufferVk::bindDescriptorSet(uint32_t                  setIndex,
+                                        DescriptorSet*            set,
+                                        std::span<const uint32_t> dynamicOffsets) {
   if (!m_isRecording_) {
     GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
     return;
   }
 
-  if (!m_currentPipeline_) {
+  if (m_currentPipelineLayout_ == VK_NULL_HANDLE) {
     GlobalLogger::Log(LogLevel::Error, "No active pipeline");
     return;
   }
@@ -203,12 +264,12 @@ void CommandBufferVk::bindDescriptorSet(uint32_t setIndex, DescriptorSet* set) {
   VkDescriptorSet vkDescriptorSet = descriptorSetVk->getDescriptorSet();
   vkCmdBindDescriptorSets(m_commandBuffer_,
                           m_currentBindPoint_,
-                          m_currentPipeline_->getPipelineLayout(),
+                          m_currentPipelineLayout_,
                           setIndex,
                           1,
                           &vkDescriptorSet,
-                          0,
-                          nullptr);
+                          static_cast<uint32_t>(dynamicOffsets.size()),
+                          dynamicOffsets.data());
 }
 
 void CommandBufferVk::draw(uint32_t vertexCount, uint32_t firstVertex) {
@@ -251,6 +312,68 @@ void CommandBufferVk::drawIndexedInstanced(
   vkCmdDrawIndexed(m_commandBuffer_, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
+void CommandBufferVk::drawIndexedIndirect(Buffer* argBuffer, uint64_t argOffset, uint32_t drawCount, uint32_t stride) {
+  if (!m_isRecording_ || !m_isRenderPassActive_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording or render pass is not active");
+    return;
+  }
+
+  BufferVk* argBufferVk = dynamic_cast<BufferVk*>(argBuffer);
+  if (!argBufferVk) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
+    return;
+  }
+
+  // drawCount > 1 needs the multiDrawIndirect feature (see DeviceVk::supportsMultiDrawIndirect)
+  vkCmdDrawIndexedIndirect(m_commandBuffer_, argBufferVk->getBuffer(), argOffset, drawCount, stride);
+}
+
+void CommandBufferVk::drawIndexedIndirectCount(Buffer*  argBuffer,
+                                               uint64_t argOffset,
+                                               Buffer*  countBuffer,
+                                               uint64_t countOffset,
+                                               uint32_t maxDrawCount,
+                                               uint32_t stride) {
+  if (!m_isRecording_ || !m_isRenderPassActive_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording or render pass is not active");
+    return;
+  }
+
+  BufferVk* argBufferVk   = dynamic_cast<BufferVk*>(argBuffer);
+  BufferVk* countBufferVk = dynamic_cast<BufferVk*>(countBuffer);
+  if (!argBufferVk || !countBufferVk) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
+    return;
+  }
+
+  if (!m_device_->supportsDrawIndirectCount()) {
+    GlobalLogger::Log(LogLevel::Error, "drawIndirectCount feature is not supported by the device");
+    return;
+  }
+
+  vkCmdDrawIndexedIndirectCount(m_commandBuffer_,
+                                argBufferVk->getBuffer(),
+                                argOffset,
+                                countBufferVk->getBuffer(),
+                                countOffset,
+                                maxDrawCount,
+                                stride);
+}
+
+void CommandBufferVk::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+  if (!m_isRecording_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
+    return;
+  }
+
+  if (m_isRenderPassActive_) {
+    GlobalLogger::Log(LogLevel::Error, "Cannot dispatch inside a render pass");
+    return;
+  }
+
+  vkCmdDispatch(m_commandBuffer_, groupCountX, groupCountY, groupCountZ);
+}
+
 void CommandBufferVk::resourceBarrier(const ResourceBarrierDesc& barrier) {
   if (!m_isRecording_) {
     GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
@@ -363,9 +486,38 @@ void CommandBufferVk::resourceBarrier(const ResourceBarrierDesc& barrier) {
   textureVk->updateCurrentLayout_(barrier.newLayout);
 }
 
+void CommandBufferVk::bufferBarrier(const BufferBarrierDesc& barrier) {
+  if (!m_isRecording_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
+    return;
+  }
+
+  BufferVk* bufferVk = dynamic_cast<BufferVk*>(barrier.buffer);
+  if (!bufferVk) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid buffer type");
+    return;
+  }
+
+  VkBufferMemoryBarrier bufferBarrier = {};
+  bufferBarrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  bufferBarrier.srcAccessMask         = g_getBufferAccessFlagsVk(barrier.oldState);
+  bufferBarrier.dstAccessMask         = g_getBufferAccessFlagsVk(barrier.newState);
+  bufferBarrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+  bufferBarrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+  bufferBarrier.buffer                = bufferVk->getBuffer();
+  bufferBarrier.offset                = 0;
+  bufferBarrier.size                  = VK_WHOLE_SIZE;
+
+  VkPipelineStageFlags srcStageMask = g_getBufferPipelineStageFlagsVk(barrier.oldState);
+  VkPipelineStageFlags dstStageMask = g_getBufferPipelineStageFlagsVk(barrier.newState);
+
+  vkCmdPipelineBarrier(m_commandBuffer_, srcStageMask, dstStageMask, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+}
+
 void CommandBufferVk::beginRenderPass(RenderPass*                    renderPass,
                                       Framebuffer*                   framebuffer,
-                                      const std::vector<ClearValue>& clearValues) {
+                                      const std::vector<ClearValue>& clearValues,
+                                      RenderPassContents             contents) {
   if (!m_isRecording_) {
     GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording");
     return;
@@ -407,7 +559,11 @@ void CommandBufferVk::beginRenderPass(RenderPass*                    renderPass,
   renderPassInfo.clearValueCount       = static_cast<uint32_t>(clearValuesVk.size());
   renderPassInfo.pClearValues          = clearValuesVk.data();
 
-  vkCmdBeginRenderPass(m_commandBuffer_, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  const VkSubpassContents subpassContents = contents == RenderPassContents::SecondaryCommandBuffers
+                                              ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                              : VK_SUBPASS_CONTENTS_INLINE;
+
+  vkCmdBeginRenderPass(m_commandBuffer_, &renderPassInfo, subpassContents);
 
   m_currentRenderPass_  = renderPassVk;
   m_currentFramebuffer_ = framebufferVk;
@@ -432,6 +588,31 @@ void CommandBufferVk::endRenderPass() {
   m_currentFramebuffer_ = nullptr;
 }
 
+void CommandBufferVk::executeCommands(std::span<CommandBuffer* const> commandBuffers) {
+  if (!m_isRecording_ || !m_isRenderPassActive_) {
+    GlobalLogger::Log(LogLevel::Error, "Command buffer is not recording or render pass is not active");
+    return;
+  }
+
+  std::vector<VkCommandBuffer> vkCommandBuffers;
+  vkCommandBuffers.reserve(commandBuffers.size());
+
+  for (auto commandBuffer : commandBuffers) {
+    CommandBufferVk* commandBufferVk = dynamic_cast<CommandBufferVk*>(commandBuffer);
+    if (!commandBufferVk) {
+      GlobalLogger::Log(LogLevel::Error, "Invalid command buffer type");
+      return;
+    }
+    vkCommandBuffers.push_back(commandBufferVk->getCommandBuffer());
+  }
+
+  if (vkCommandBuffers.empty()) {
+    return;
+  }
+
+  vkCmdExecuteCommands(m_commandBuffer_, static_cast<uint32_t>(vkCommandBuffers.size()), vkCommandBuffers.data());
+}
+
 void CommandBufferVk::copyBuffer(
     Buffer* srcBuffer, Buffer* dstBuffer, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) {
   if (!m_isRecording_) {
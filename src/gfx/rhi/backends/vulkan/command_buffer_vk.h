@@ -12,7 +12,6 @@ namespace gfx {
 namespace rhi {
 
 class DeviceVk;
-class GraphicsPipelineVk;
 class BufferVk;
 class TextureVk;
 class DescriptorSetVk;
@@ -35,6 +34,7 @@ class CommandBufferVk : public CommandBuffer {
   void begin() override;
   void end() override;
   void reset() override;
+  void beginSecondary(RenderPass* renderPass, Framebuffer* framebuffer) override;
 
   // Pipeline state
   void setPipeline(Pipeline* pipeline) override;
@@ -45,20 +45,27 @@ class CommandBufferVk : public CommandBuffer {
   void bindVertexBuffer(uint32_t binding, Buffer* buffer, uint64_t offset = 0) override;
   void bindIndexBuffer(Buffer* buffer, uint64_t offset = 0, bool use32BitIndices = false) override;
   // @param setIndex: Descriptor set slot as declared in the shader (e.g. "layout(set = N, ...)" in GLSL).
-  void bindDescriptorSet(uint32_t setIndex, DescriptorSet* set) override;
+  void bindDescriptorSet(uint32_t setIndex, DescriptorSet* set, std::span<const uint32_t> dynamicOffsets = {}) override;
 
   // Draw commands
   void draw(uint32_t vertexCount, uint32_t firstVertex = 0) override;
   void drawIndexed(uint32_t indexCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0) override;
   void drawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override;
   void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
+  void drawIndexedIndirect(Buffer* argBuffer, uint64_t argOffset, uint32_t drawCount, uint32_t stride = sizeof(DrawIndexedIndirectCommand)) override;
+  void drawIndexedIndirectCount(Buffer* argBuffer, uint64_t argOffset, Buffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride = sizeof(DrawIndexedIndirectCommand)) override;
+
+  // Compute dispatch
+  void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) override;
 
   // Resource barriers
   void resourceBarrier(const ResourceBarrierDesc& barrier) override;
+  void bufferBarrier(const BufferBarrierDesc& barrier) override;
 
   // Render pass operations
-  void beginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const std::vector<ClearValue>& clearValues) override;
+  void beginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const std::vector<ClearValue>& clearValues, RenderPassContents contents = RenderPassContents::Inline) override;
   void endRenderPass() override;
+  void executeCommands(std::span<CommandBuffer* const> commandBuffers) override;
 
   // Copy operations
   void copyBuffer(Buffer* srcBuffer, Buffer* dstBuffer, uint64_t srcOffset = 0, uint64_t dstOffset = 0, uint64_t size = 0) override;
@@ -84,12 +91,13 @@ class CommandBufferVk : public CommandBuffer {
   VkCommandPool   m_commandPool_;
 
   // Current state tracking
-  GraphicsPipelineVk* m_currentPipeline_    = nullptr;
-  RenderPassVk*       m_currentRenderPass_  = nullptr;
-  FramebufferVk*      m_currentFramebuffer_ = nullptr;
-  bool                m_isRenderPassActive_ = false;
-  bool                m_isRecording_        = false;
-  VkPipelineBindPoint m_currentBindPoint_   = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  VkPipelineLayout    m_currentPipelineLayout_ = VK_NULL_HANDLE;
+  RenderPassVk*       m_currentRenderPass_     = nullptr;
+  FramebufferVk*      m_currentFramebuffer_    = nullptr;
+  bool                m_isRenderPassActive_    = false;
+  bool                m_isRecording_           = false;
+  bool                m_isSecondary_           = false;  // recording inside of the render pass of a primary
+  VkPipelineBindPoint m_currentBindPoint_      = VK_PIPELINE_BIND_POINT_GRAPHICS;
 };
 
 // clang-format on
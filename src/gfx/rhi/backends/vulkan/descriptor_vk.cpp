@@ -11,6 +11,13 @@ namespace arise {
 namespace gfx {
 namespace rhi {
 
+namespace {
+
+// texture arrays (bindless material textures) take many sampled images from a single set
+constexpr uint32_t POOL_SAMPLED_IMAGES_PER_SET = 4;
+
+}  // namespace
+
 //-------------------------------------------------------------------------
 // DescriptorSetLayoutVk implementation
 //-------------------------------------------------------------------------
@@ -89,7 +96,7 @@ void DescriptorSetVk::setUniformBuffer(uint32_t binding, Buffer* buffer, uint64_
   descriptorWrite.dstSet               = m_descriptorSet_;
   descriptorWrite.dstBinding           = binding;
   descriptorWrite.dstArrayElement      = 0;
-  descriptorWrite.descriptorType       = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  descriptorWrite.descriptorType       = getDescriptorType_(binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
   descriptorWrite.descriptorCount      = 1;
   descriptorWrite.pBufferInfo          = &bufferInfo;
 
@@ -128,32 +135,7 @@ void DescriptorSetVk::setTextureSampler(uint32_t binding, Texture* texture, Samp
 }
 
 void DescriptorSetVk::setTexture(uint32_t binding, Texture* texture, ResourceLayout layout) {
-  if (!texture) {
-    GlobalLogger::Log(LogLevel::Error, "Null texture in setTexture");
-    return;
-  }
-
-  TextureVk* textureVk = dynamic_cast<TextureVk*>(texture);
-  if (!textureVk) {
-    GlobalLogger::Log(LogLevel::Error, "Invalid texture type in setTexture");
-    return;
-  }
-
-  VkDescriptorImageInfo imageInfo = {};
-  imageInfo.imageLayout           = g_getImageLayoutVk(layout);
-  imageInfo.imageView             = textureVk->getImageView();
-  imageInfo.sampler               = VK_NULL_HANDLE;
-
-  VkWriteDescriptorSet descriptorWrite = {};
-  descriptorWrite.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-  descriptorWrite.dstSet               = m_descriptorSet_;
-  descriptorWrite.dstBinding           = binding;
-  descriptorWrite.dstArrayElement      = 0;
-  descriptorWrite.descriptorType       = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-  descriptorWrite.descriptorCount      = 1;
-  descriptorWrite.pImageInfo           = &imageInfo;
-
-  vkUpdateDescriptorSets(m_device_->getDevice(), 1, &descriptorWrite, 0, nullptr);
+  setTextureArrayElement(binding, 0, texture, layout);
 }
 
 void DescriptorSetVk::setSampler(uint32_t binding, Sampler* sampler) {
@@ -207,13 +189,54 @@ void DescriptorSetVk::setStorageBuffer(uint32_t binding, Buffer* buffer, uint64_
   descriptorWrite.dstSet               = m_descriptorSet_;
   descriptorWrite.dstBinding           = binding;
   descriptorWrite.dstArrayElement      = 0;
-  descriptorWrite.descriptorType       = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  descriptorWrite.descriptorType       = getDescriptorType_(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
   descriptorWrite.descriptorCount      = 1;
   descriptorWrite.pBufferInfo          = &bufferInfo;
 
   vkUpdateDescriptorSets(m_device_->getDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
+void DescriptorSetVk::setTextureArrayElement(uint32_t       binding,
+                                             uint32_t       arrayElement,
+                                             Texture*       texture,
+                                             ResourceLayout layout) {
+  if (!texture) {
+    GlobalLogger::Log(LogLevel::Error, "Null texture in setTexture");
+    return;
+  }
+
+  TextureVk* textureVk = dynamic_cast<TextureVk*>(texture);
+  if (!textureVk) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid texture type in setTexture");
+    return;
+  }
+
+  VkDescriptorImageInfo imageInfo = {};
+  imageInfo.imageLayout           = g_getImageLayoutVk(layout);
+  imageInfo.imageView             = textureVk->getImageView();
+  imageInfo.sampler               = VK_NULL_HANDLE;
+
+  VkWriteDescriptorSet descriptorWrite = {};
+  descriptorWrite.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  descriptorWrite.dstSet               = m_descriptorSet_;
+  descriptorWrite.dstBinding           = binding;
+  descriptorWrite.dstArrayElement      = arrayElement;
+  descriptorWrite.descriptorType       = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+  descriptorWrite.descriptorCount      = 1;
+  descriptorWrite.pImageInfo           = &imageInfo;
+
+  vkUpdateDescriptorSets(m_device_->getDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+VkDescriptorType DescriptorSetVk::getDescriptorType_(uint32_t binding, VkDescriptorType defaultType) const {
+  for (const auto& bindingDesc : m_layout_->getDesc().bindings) {
+    if (bindingDesc.binding == binding) {
+      return g_getShaderBindingTypeVk(bindingDesc.type);
+    }
+  }
+  return defaultType;
+}
+
 //-------------------------------------------------------------------------
 // DescriptorPoolManager implementation
 //-------------------------------------------------------------------------
@@ -256,7 +279,7 @@ bool DescriptorPoolManager::createPool() {
   std::vector<VkDescriptorPoolSize> poolSizes = {
     {               VK_DESCRIPTOR_TYPE_SAMPLER, m_maxSets_},
     {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_maxSets_},
-    {         VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_maxSets_},
+    {         VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_maxSets_ * POOL_SAMPLED_IMAGES_PER_SET},
     {         VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_maxSets_},
     {  VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, m_maxSets_},
     {  VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, m_maxSets_},
@@ -53,6 +53,10 @@ class DescriptorSetVk : public DescriptorSet {
   void setTexture(uint32_t binding, Texture* texture, ResourceLayout layout = ResourceLayout::ShaderReadOnly) override;
   void setSampler(uint32_t binding, Sampler* sampler) override;
   void setStorageBuffer(uint32_t binding, Buffer* buffer, uint64_t offset = 0, uint64_t range = 0) override;
+  void setTextureArrayElement(uint32_t       binding,
+                              uint32_t       arrayElement,
+                              Texture*       texture,
+                              ResourceLayout layout = ResourceLayout::ShaderReadOnly) override;
 
   const DescriptorSetLayout* getLayout() const { return m_layout_; }
 
@@ -60,6 +64,9 @@ class DescriptorSetVk : public DescriptorSet {
   VkDescriptorSet getDescriptorSet() const { return m_descriptorSet_; }
 
   private:
+  // descriptor type of the binding as declared in the layout (dynamic buffers differ from the regular ones)
+  VkDescriptorType getDescriptorType_(uint32_t binding, VkDescriptorType defaultType) const;
+
   DeviceVk*                    m_device_;
   const DescriptorSetLayoutVk* m_layout_;
   VkDescriptorSet              m_descriptorSet_ = VK_NULL_HANDLE;
@@ -12,17 +12,21 @@
 #include "gfx/rhi/backends/vulkan/swap_chain_vk.h"
 #include "gfx/rhi/backends/vulkan/synchronization_vk.h"
 #include "gfx/rhi/backends/vulkan/texture_vk.h"
+#include "gfx/rhi/backends/vulkan/upload_context_vk.h"
 #include "platform/common/window.h"
 //#include "profiler/backends/gpu_profiler_vk.h"
 #include "profiler/backends/gpu_profiler.h"
 #include "utils/service/service_locator.h"
 #include "utils/logger/global_logger.h"
+#include "utils/path_manager/path_manager.h"
 
 #include <SDL_vulkan.h>
 
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
 
+#include <cstring>
+#include <fstream>
 #include <map>
 #include <set>
 
@@ -32,6 +36,10 @@ namespace rhi {
 
 constexpr uint32_t DESCRIPTOR_POOL_MAX_SETS = 1000;
 
+constexpr const char* PIPELINE_CACHE_FILE_NAME = "pipeline_cache_vk.bin";
+
+constexpr VkDeviceSize UPLOAD_RING_SIZE = 64 * 1024 * 1024;
+
 //-------------------------------------------------------------------------
 // DeviceVk implementation
 //-------------------------------------------------------------------------
@@ -44,7 +52,8 @@ DeviceVk::DeviceVk(const DeviceDesc& desc)
   m_deviceExtensions_ = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
   if (!createInstance_() || !setupDebugMessenger_() || !createSurface_() || !pickPhysicalDevice_()
-      || !createLogicalDevice_() || !createAllocator_() || !createCommandPools_() || !createDescriptorPools_()) {
+      || !createLogicalDevice_() || !createAllocator_() || !createCommandPools_() || !createDescriptorPools_()
+      || !createPipelineCache_() || !createUploadContext_()) {
     // Handle initialization failure:
     // - add logger
     // - make proper error handling and cleanup
@@ -54,6 +63,15 @@ DeviceVk::DeviceVk(const DeviceDesc& desc)
 DeviceVk::~DeviceVk() {
   waitIdle();
 
+  // staging memory and command pool of the uploads, must go before the allocator
+  m_uploadContext_.reset();
+
+  if (m_pipelineCache_) {
+    savePipelineCache_();
+    vkDestroyPipelineCache(m_device_, m_pipelineCache_, nullptr);
+    m_pipelineCache_ = VK_NULL_HANDLE;
+  }
+
   m_descriptorPoolManager_.release();
   m_commandPoolManager_.release();
 
@@ -243,8 +261,31 @@ bool DeviceVk::createLogicalDevice_() {
   deviceFeatures.fillModeNonSolid         = VK_TRUE;
   deviceFeatures.geometryShader           = VK_TRUE;
 
+  // the bindless material textures are indexed with a per-draw (dynamically uniform) material index
+  deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+  // indirect draws of the GPU-driven path, optional - the renderer falls back to CPU draws without them
+  m_supportsMultiDrawIndirect_ = m_deviceFeatures_.multiDrawIndirect && m_deviceFeatures_.drawIndirectFirstInstance;
+  deviceFeatures.multiDrawIndirect         = m_deviceFeatures_.multiDrawIndirect;
+  deviceFeatures.drawIndirectFirstInstance = m_deviceFeatures_.drawIndirectFirstInstance;
+
+  VkPhysicalDeviceVulkan12Features supportedFeatures12 = {};
+  supportedFeatures12.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+  VkPhysicalDeviceFeatures2 supportedFeatures = {};
+  supportedFeatures.sType                     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  supportedFeatures.pNext                     = &supportedFeatures12;
+  vkGetPhysicalDeviceFeatures2(m_physicalDevice_, &supportedFeatures);
+
+  m_supportsDrawIndirectCount_ = supportedFeatures12.drawIndirectCount == VK_TRUE;
+
+  VkPhysicalDeviceVulkan12Features features12 = {};
+  features12.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  features12.drawIndirectCount                = supportedFeatures12.drawIndirectCount;
+
   VkDeviceCreateInfo createInfo      = {};
   createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+  createInfo.pNext                   = &features12;
   createInfo.queueCreateInfoCount    = static_cast<uint32_t>(queueCreateInfos.size());
   createInfo.pQueueCreateInfos       = queueCreateInfos.data();
   createInfo.pEnabledFeatures        = &deviceFeatures;
@@ -293,6 +334,87 @@ bool DeviceVk::createAllocator_() {
   return true;
 }
 
+bool DeviceVk::createPipelineCache_() {
+  std::vector<char> initialData;
+
+  auto          cacheFilePath = PathManager::s_getCachePath() / PIPELINE_CACHE_FILE_NAME;
+  std::ifstream file(cacheFilePath, std::ios::in | std::ios::binary);
+  if (file) {
+    initialData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  // a blob from another driver / GPU is ignored by the spec, but some drivers are known to crash on it
+  if (!initialData.empty()) {
+    VkPipelineCacheHeaderVersionOne header       = {};
+    bool                            isCompatible = initialData.size() >= sizeof(header);
+    if (isCompatible) {
+      std::memcpy(&header, initialData.data(), sizeof(header));
+      isCompatible = header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                  && header.vendorID == m_deviceProperties_.vendorID
+                  && header.deviceID == m_deviceProperties_.deviceID
+                  && std::memcmp(header.pipelineCacheUUID, m_deviceProperties_.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    if (!isCompatible) {
+      GlobalLogger::Log(LogLevel::Info, "Pipeline cache is from another device or driver, starting with an empty one");
+      initialData.clear();
+    }
+  }
+
+  VkPipelineCacheCreateInfo createInfo = {};
+  createInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  createInfo.initialDataSize           = initialData.size();
+  createInfo.pInitialData              = initialData.empty() ? nullptr : initialData.data();
+
+  if (vkCreatePipelineCache(m_device_, &createInfo, nullptr, &m_pipelineCache_) != VK_SUCCESS) {
+    // not fatal - pipelines are created without a cache
+    GlobalLogger::Log(LogLevel::Warning, "Failed to create Vulkan pipeline cache");
+    m_pipelineCache_ = VK_NULL_HANDLE;
+    return true;
+  }
+
+  if (!initialData.empty()) {
+    GlobalLogger::Log(LogLevel::Info,
+                      "Loaded Vulkan pipeline cache (" + std::to_string(initialData.size()) + " bytes)");
+  }
+
+  return true;
+}
+
+bool DeviceVk::createUploadContext_() {
+  m_uploadContext_ = std::make_unique<UploadContextVk>(this);
+  if (!m_uploadContext_->initialize(UPLOAD_RING_SIZE)) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create upload context");
+    return false;
+  }
+  return true;
+}
+
+void DeviceVk::savePipelineCache_() {
+  size_t dataSize = 0;
+  if (vkGetPipelineCacheData(m_device_, m_pipelineCache_, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+    return;
+  }
+
+  std::vector<char> data(dataSize);
+  if (vkGetPipelineCacheData(m_device_, m_pipelineCache_, &dataSize, data.data()) != VK_SUCCESS) {
+    GlobalLogger::Log(LogLevel::Warning, "Failed to get Vulkan pipeline cache data");
+    return;
+  }
+
+  auto            cacheDirectory = PathManager::s_getCachePath();
+  std::error_code errorCode;
+  std::filesystem::create_directories(cacheDirectory, errorCode);
+
+  std::ofstream file(cacheDirectory / PIPELINE_CACHE_FILE_NAME, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file) {
+    GlobalLogger::Log(LogLevel::Warning, "Failed to save Vulkan pipeline cache to " + cacheDirectory.string());
+    return;
+  }
+
+  file.write(data.data(), static_cast<std::streamsize>(dataSize));
+}
+
 VkBuffer DeviceVk::createStagingBuffer(const void* data, size_t size, VmaAllocation& allocation) {
   VkBuffer stagingBuffer;
 
@@ -356,6 +478,10 @@ std::unique_ptr<GraphicsPipeline> DeviceVk::createGraphicsPipeline(const Graphic
   return std::make_unique<GraphicsPipelineVk>(desc, this);
 }
 
+std::unique_ptr<ComputePipeline> DeviceVk::createComputePipeline(const ComputePipelineDesc& desc) {
+  return std::make_unique<ComputePipelineVk>(desc, this);
+}
+
 std::unique_ptr<DescriptorSetLayout> DeviceVk::createDescriptorSetLayout(const DescriptorSetLayoutDesc& desc) {
   return std::make_unique<DescriptorSetLayoutVk>(desc, this);
 }
@@ -427,39 +553,8 @@ void DeviceVk::updateBuffer(Buffer* buffer, const void* data, size_t size, size_
     }
   }
 
-  VmaAllocation stagingAllocation = VK_NULL_HANDLE;
-  VkBuffer      stagingBuffer     = createStagingBuffer(data, size, stagingAllocation);
-
-  if (stagingBuffer == VK_NULL_HANDLE) {
-    GlobalLogger::Log(LogLevel::Error, "Failed to create staging buffer");
-    return;
-  }
-
-  CommandBufferDesc cmdBufferDesc;
-  cmdBufferDesc.primary = true;
-  auto cmdBuffer        = createCommandBuffer(cmdBufferDesc);
-
-  cmdBuffer->begin();
-
-  VkBufferCopy copyRegion = {};
-  copyRegion.srcOffset    = 0;
-  copyRegion.dstOffset    = offset;
-  copyRegion.size         = size;
-
-  vkCmdCopyBuffer(static_cast<CommandBufferVk*>(cmdBuffer.get())->getCommandBuffer(),
-                  stagingBuffer,
-                  bufferVk->getBuffer(),
-                  1,
-                  &copyRegion);
-
-  cmdBuffer->end();
-
-  FenceDesc fenceDesc;
-  auto      fence = createFence(fenceDesc);
-  submitCommandBuffer(cmdBuffer.get(), fence.get());
-  fence->wait();
-
-  vmaDestroyBuffer(m_allocator_, stagingBuffer, stagingAllocation);
+  // device local memory: the copy is queued and submitted before the next frame, no CPU wait
+  m_uploadContext_->uploadBuffer(bufferVk, data, size, offset);
 }
 
 void DeviceVk::updateTexture(
@@ -534,7 +629,18 @@ void DeviceVk::submitCommandBuffer(CommandBuffer*                 cmdBuffer,
   }
 }
 
+void DeviceVk::flushUploads() {
+  if (m_uploadContext_) {
+    m_uploadContext_->flush();
+  }
+}
+
 void DeviceVk::waitIdle() {
+  // recorded uploads are submitted too, otherwise they would be lost for whoever waits here
+  if (m_uploadContext_) {
+    m_uploadContext_->waitIdle();
+  }
+
   if (m_device_) {
     vkDeviceWaitIdle(m_device_);
   }
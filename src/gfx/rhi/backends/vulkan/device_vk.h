@@ -4,6 +4,7 @@
 #include "gfx/rhi/backends/vulkan/command_buffer_vk.h"
 #include "gfx/rhi/backends/vulkan/descriptor_vk.h"
 #include "gfx/rhi/backends/vulkan/device_utils_vk.h"
+#include "gfx/rhi/backends/vulkan/upload_context_vk.h"
 #include "gfx/rhi/interface/device.h"
 
 #include <vk_mem_alloc.h>
@@ -31,6 +32,7 @@ class DeviceVk : public Device {
   std::unique_ptr<Sampler>             createSampler(const SamplerDesc& desc) override;
   std::unique_ptr<Shader>              createShader(const ShaderDesc& desc) override;
   std::unique_ptr<GraphicsPipeline>    createGraphicsPipeline(const GraphicsPipelineDesc& desc) override;
+  std::unique_ptr<ComputePipeline>     createComputePipeline(const ComputePipelineDesc& desc) override;
   std::unique_ptr<DescriptorSetLayout> createDescriptorSetLayout(const DescriptorSetLayoutDesc& desc) override;
   std::unique_ptr<DescriptorSet>       createDescriptorSet(const DescriptorSetLayout* layout) override;
   std::unique_ptr<RenderPass>          createRenderPass(const RenderPassDesc& desc) override;
@@ -52,12 +54,20 @@ class DeviceVk : public Device {
                            const std::vector<Semaphore*>& waitSemaphores   = {},
                            const std::vector<Semaphore*>& signalSemaphores = {}) override;
 
+  void flushUploads() override;
+
   void waitIdle() override;
 
+  bool supportsMultiDrawIndirect() const override { return m_supportsMultiDrawIndirect_; }
+
+  bool supportsDrawIndirectCount() const override { return m_supportsDrawIndirectCount_; }
+
   VkInstance                        getInstance() const { return m_instance_; }
   VkPhysicalDevice                  getPhysicalDevice() const { return m_physicalDevice_; }
   VkDevice                          getDevice() const { return m_device_; }
   VmaAllocator                      getAllocator() const { return m_allocator_; }
+  VkPipelineCache                   getPipelineCache() const { return m_pipelineCache_; }
+  UploadContextVk*                  getUploadContext() const { return m_uploadContext_.get(); }
   VkSurfaceKHR                      getSurface() const { return m_surface_; }
   VkQueue                           getGraphicsQueue() const { return m_graphicsQueue_; }
   VkQueue                           getPresentQueue() const { return m_presentQueue_; }
@@ -82,6 +92,11 @@ class DeviceVk : public Device {
   bool createCommandPools_();
   bool createDescriptorPools_();
   bool createAllocator_();
+  bool createUploadContext_();
+
+  // pipeline cache persisted between runs, so a warm start skips most of the shader compilation in the driver
+  bool createPipelineCache_();
+  void savePipelineCache_();
 
   VkInstance               m_instance_       = VK_NULL_HANDLE;
   VkDebugUtilsMessengerEXT m_debugMessenger_ = VK_NULL_HANDLE;
@@ -92,6 +107,9 @@ class DeviceVk : public Device {
   VkPhysicalDeviceFeatures   m_deviceFeatures_{};
   QueueFamilyIndices         m_queueFamilyIndices_;
 
+  bool m_supportsMultiDrawIndirect_ = false;
+  bool m_supportsDrawIndirectCount_ = false;
+
   VkDevice   m_device_        = VK_NULL_HANDLE;
   VkQueue    m_graphicsQueue_ = VK_NULL_HANDLE;
   VkQueue    m_presentQueue_  = VK_NULL_HANDLE;
@@ -100,6 +118,10 @@ class DeviceVk : public Device {
 
   VmaAllocator m_allocator_ = VK_NULL_HANDLE;
 
+  VkPipelineCache m_pipelineCache_ = VK_NULL_HANDLE;
+
+  std::unique_ptr<UploadContextVk> m_uploadContext_;
+
   // Resource management
   CommandPoolManager    m_commandPoolManager_;
   DescriptorPoolManager m_descriptorPoolManager_;
@@ -11,6 +11,43 @@ namespace arise {
 namespace gfx {
 namespace rhi {
 
+namespace {
+
+// shared by graphics and compute pipelines
+bool createPipelineLayout(DeviceVk*                                      device,
+                          const std::vector<const DescriptorSetLayout*>& setLayouts,
+                          VkPipelineLayout&                              pipelineLayout) {
+  std::vector<VkDescriptorSetLayout> vkDescriptorSetLayouts;
+
+  for (const auto& setLayout : setLayouts) {
+    const DescriptorSetLayoutVk* setLayoutVk = dynamic_cast<const DescriptorSetLayoutVk*>(setLayout);
+    if (!setLayoutVk) {
+      GlobalLogger::Log(LogLevel::Error, "Invalid descriptor set layout type for Vulkan pipeline");
+      return false;
+    }
+
+    vkDescriptorSetLayouts.push_back(setLayoutVk->getLayout());
+  }
+
+  // TODO: add push constant ranges
+
+  VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+  pipelineLayoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  pipelineLayoutInfo.setLayoutCount             = static_cast<uint32_t>(vkDescriptorSetLayouts.size());
+  pipelineLayoutInfo.pSetLayouts                = vkDescriptorSetLayouts.data();
+  pipelineLayoutInfo.pushConstantRangeCount     = 0;
+  pipelineLayoutInfo.pPushConstantRanges        = nullptr;
+
+  if (vkCreatePipelineLayout(device->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create pipeline layout");
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace
+
 GraphicsPipelineVk::GraphicsPipelineVk(const GraphicsPipelineDesc& desc, DeviceVk* device)
     : GraphicsPipeline(desc)
     , m_device_(device)
@@ -141,7 +178,8 @@ bool GraphicsPipelineVk::createPipeline_() {
     m_pipeline_ = VK_NULL_HANDLE;
   }
 
-  if (vkCreateGraphicsPipelines(m_device_->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline_)
+  if (vkCreateGraphicsPipelines(
+          m_device_->getDevice(), m_device_->getPipelineCache(), 1, &pipelineInfo, nullptr, &m_pipeline_)
       != VK_SUCCESS) {
     GlobalLogger::Log(LogLevel::Error, "Failed to create graphics pipeline");
     return false;
@@ -333,29 +371,74 @@ bool GraphicsPipelineVk::createColorBlendState_(VkPipelineColorBlendStateCreateI
 }
 
 bool GraphicsPipelineVk::createPipelineLayout_() {
-  std::vector<VkDescriptorSetLayout> vkDescriptorSetLayouts;
+  return createPipelineLayout(m_device_, m_desc_.setLayouts, m_pipelineLayout_);
+}
 
-  for (const auto& setLayout : m_desc_.setLayouts) {
-    const DescriptorSetLayoutVk* setLayoutVk = dynamic_cast<const DescriptorSetLayoutVk*>(setLayout);
-    if (!setLayoutVk) {
-      GlobalLogger::Log(LogLevel::Error, "Invalid descriptor set layout type for Vulkan pipeline");
-      return false;
-    }
+//-------------------------------------------------------------------------
+// ComputePipelineVk implementation
+//-------------------------------------------------------------------------
 
-    vkDescriptorSetLayouts.push_back(setLayoutVk->getLayout());
+ComputePipelineVk::ComputePipelineVk(const ComputePipelineDesc& desc, DeviceVk* device)
+    : ComputePipeline(desc)
+    , m_device_(device)
+    , m_pipeline_(VK_NULL_HANDLE)
+    , m_pipelineLayout_(VK_NULL_HANDLE) {
+  if (!createPipelineLayout(m_device_, m_desc_.setLayouts, m_pipelineLayout_) || !createPipeline_()) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to initialize Vulkan compute pipeline");
   }
+}
 
-  // TODO: add push constant ranges
+ComputePipelineVk::~ComputePipelineVk() {
+  if (m_pipeline_ != VK_NULL_HANDLE) {
+    vkDestroyPipeline(m_device_->getDevice(), m_pipeline_, nullptr);
+    m_pipeline_ = VK_NULL_HANDLE;
+  }
 
-  VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-  pipelineLayoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-  pipelineLayoutInfo.setLayoutCount             = static_cast<uint32_t>(vkDescriptorSetLayouts.size());
-  pipelineLayoutInfo.pSetLayouts                = vkDescriptorSetLayouts.data();
-  pipelineLayoutInfo.pushConstantRangeCount     = 0;
-  pipelineLayoutInfo.pPushConstantRanges        = nullptr;
+  if (m_pipelineLayout_ != VK_NULL_HANDLE) {
+    vkDestroyPipelineLayout(m_device_->getDevice(), m_pipelineLayout_, nullptr);
+    m_pipelineLayout_ = VK_NULL_HANDLE;
+  }
+}
 
-  if (vkCreatePipelineLayout(m_device_->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout_) != VK_SUCCESS) {
-    GlobalLogger::Log(LogLevel::Error, "Failed to create pipeline layout");
+bool ComputePipelineVk::rebuild() {
+  if (createPipeline_()) {
+    GlobalLogger::Log(LogLevel::Info, "Successfully rebuilt Vulkan compute pipeline");
+    m_updateFrame = -1;
+    return true;
+  }
+
+  GlobalLogger::Log(LogLevel::Error, "Failed to rebuild Vulkan compute pipeline");
+  return false;
+}
+
+bool ComputePipelineVk::createPipeline_() {
+  ShaderVk* shaderVk = dynamic_cast<ShaderVk*>(m_desc_.shader);
+  if (!shaderVk) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid shader type for Vulkan compute pipeline");
+    return false;
+  }
+
+  VkComputePipelineCreateInfo pipelineInfo = {};
+  pipelineInfo.sType                       = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineInfo.stage.sType                 = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipelineInfo.stage.stage                 = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipelineInfo.stage.module                = shaderVk->getShaderModule();
+  pipelineInfo.stage.pName                 = shaderVk->getEntryPoint().c_str();
+  pipelineInfo.layout                      = m_pipelineLayout_;
+  pipelineInfo.basePipelineHandle          = VK_NULL_HANDLE;
+  pipelineInfo.basePipelineIndex           = -1;
+
+  if (m_pipeline_ != VK_NULL_HANDLE) {
+    // TODO: same as for the graphics pipeline, consider delayed destroy of the old pipeline
+    m_device_->waitIdle();
+    vkDestroyPipeline(m_device_->getDevice(), m_pipeline_, nullptr);
+    m_pipeline_ = VK_NULL_HANDLE;
+  }
+
+  if (vkCreateComputePipelines(
+          m_device_->getDevice(), m_device_->getPipelineCache(), 1, &pipelineInfo, nullptr, &m_pipeline_)
+      != VK_SUCCESS) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create compute pipeline");
     return false;
   }
 
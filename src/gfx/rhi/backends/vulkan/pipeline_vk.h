@@ -51,6 +51,30 @@ class GraphicsPipelineVk : public GraphicsPipeline {
   VkPipelineLayout m_pipelineLayout_;
 };
 
+class ComputePipelineVk : public ComputePipeline {
+  public:
+  ComputePipelineVk(const ComputePipelineDesc& desc, DeviceVk* device);
+  ~ComputePipelineVk() override;
+
+  ComputePipelineVk(const ComputePipelineVk&)            = delete;
+  ComputePipelineVk& operator=(const ComputePipelineVk&) = delete;
+
+  bool rebuild() override;
+
+  // Vulkan-specific methods
+  VkPipeline getPipeline() const { return m_pipeline_; }
+
+  VkPipelineLayout getPipelineLayout() const { return m_pipelineLayout_; }
+
+  private:
+  bool createPipeline_();
+
+  DeviceVk* m_device_;
+
+  VkPipeline       m_pipeline_;
+  VkPipelineLayout m_pipelineLayout_;
+};
+
 }  // namespace rhi
 }  // namespace gfx
 }  // namespace arise
@@ -53,6 +53,7 @@ static const std::unordered_map<TextureFormat, VkFormat> formatMapping = {
   { TextureFormat::Rg8,        VK_FORMAT_R8G8_UNORM              },
   { TextureFormat::Rg16f,      VK_FORMAT_R16G16_SFLOAT           },
   { TextureFormat::Rg32f,      VK_FORMAT_R32G32_SFLOAT           },
+  { TextureFormat::Rg16Snorm,  VK_FORMAT_R16G16_SNORM            },
   { TextureFormat::D16,        VK_FORMAT_D16_UNORM               },
   { TextureFormat::D16S8,      VK_FORMAT_D16_UNORM_S8_UINT       },
   { TextureFormat::D24,        VK_FORMAT_X8_D24_UNORM_PACK32     },
@@ -218,6 +219,7 @@ int g_getTextureComponentCountVk(TextureFormat type) {
     { TextureFormat::Rg8,        2 },
     { TextureFormat::Rg16f,      2 },
     { TextureFormat::Rg32f,      2 },
+    { TextureFormat::Rg16Snorm,  2 },
 
     { TextureFormat::D16,        1 },
     { TextureFormat::D16S8,      2 },
@@ -256,6 +258,7 @@ int g_getTexturePixelSizeVk(TextureFormat type) {
     { TextureFormat::Rg8,        2  },
     { TextureFormat::Rg16f,      2  },
     { TextureFormat::Rg32f,      4  },
+    { TextureFormat::Rg16Snorm,  4  },
 
     { TextureFormat::D16,        2  },
     { TextureFormat::D16S8,      3  },
@@ -450,6 +453,52 @@ VkDescriptorType g_getShaderBindingTypeVk(ShaderBindingType type) {
   return VK_DESCRIPTOR_TYPE_SAMPLER;
 }
 
+VkAccessFlags g_getBufferAccessFlagsVk(BufferState state) {
+  switch (state) {
+    case BufferState::Common:
+      return 0;
+    case BufferState::ShaderRead:
+      return VK_ACCESS_SHADER_READ_BIT;
+    case BufferState::VertexBuffer:
+      return VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    case BufferState::UnorderedAccess:
+      return VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    case BufferState::IndirectArgument:
+      return VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    case BufferState::CopySource:
+      return VK_ACCESS_TRANSFER_READ_BIT;
+    case BufferState::CopyDestination:
+      return VK_ACCESS_TRANSFER_WRITE_BIT;
+    default:
+      assert(0);
+      break;
+  }
+  return 0;
+}
+
+VkPipelineStageFlags g_getBufferPipelineStageFlagsVk(BufferState state) {
+  switch (state) {
+    case BufferState::Common:
+      return VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    case BufferState::ShaderRead:
+      return VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+           | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    case BufferState::VertexBuffer:
+      return VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    case BufferState::UnorderedAccess:
+      return VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    case BufferState::IndirectArgument:
+      return VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    case BufferState::CopySource:
+    case BufferState::CopyDestination:
+      return VK_PIPELINE_STAGE_TRANSFER_BIT;
+    default:
+      assert(0);
+      break;
+  }
+  return VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+}
+
 // TODO: rewrite to use std::unordered_map
 VkCullModeFlags g_getCullModeVk(CullMode cullMode) {
   switch (cullMode) {
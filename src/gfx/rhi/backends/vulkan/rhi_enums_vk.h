@@ -58,6 +58,9 @@ VkColorComponentFlags g_getColorMaskVk(ColorMask type);
 
 VkDescriptorType g_getShaderBindingTypeVk(ShaderBindingType type);
 
+VkAccessFlags        g_getBufferAccessFlagsVk(BufferState state);
+VkPipelineStageFlags g_getBufferPipelineStageFlagsVk(BufferState state);
+
 }  // namespace rhi
 }  // namespace gfx
 }  // namespace arise
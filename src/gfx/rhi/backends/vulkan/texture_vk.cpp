@@ -4,6 +4,7 @@
 #include "gfx/rhi/backends/vulkan/device_vk.h"
 #include "gfx/rhi/backends/vulkan/rhi_enums_vk.h"
 #include "gfx/rhi/backends/vulkan/synchronization_vk.h"
+#include "gfx/rhi/backends/vulkan/upload_context_vk.h"
 #include "utils/logger/global_logger.h"
 
 namespace arise {
@@ -237,37 +238,21 @@ void TextureVk::update(const void* data, size_t dataSize, uint32_t mipLevel, uin
     return;
   }
 
-  VmaAllocation stagingAllocation = VK_NULL_HANDLE;
-  VkBuffer      stagingBuffer     = m_device_->createStagingBuffer(data, dataSize, stagingAllocation);
-
-  if (stagingBuffer == VK_NULL_HANDLE) {
-    GlobalLogger::Log(LogLevel::Error, "Failed to create staging buffer for texture update");
-    return;
-  }
-
-  CommandBufferDesc cmdBufferDesc;
-  cmdBufferDesc.primary = true;
-
-  auto commandBuffer = m_device_->createCommandBuffer(cmdBufferDesc);
-  if (!commandBuffer) {
-    vmaDestroyBuffer(m_device_->getAllocator(), stagingBuffer, stagingAllocation);
-    GlobalLogger::Log(LogLevel::Error, "Failed to create command buffer for texture update");
-    return;
-  }
+  m_device_->getUploadContext()->uploadTexture(this, data, dataSize, mipLevel, arrayLayer);
+}
 
+void TextureVk::recordUpload(CommandBufferVk* cmdBuffer,
+                             VkBuffer         stagingBuffer,
+                             VkDeviceSize     stagingOffset,
+                             uint32_t         mipLevel,
+                             uint32_t         arrayLayer) {
   auto initialLayout = m_currentLayout_;
 
-  CommandBufferVk* cmdBufferVk = static_cast<CommandBufferVk*>(commandBuffer.get());
-
-  cmdBufferVk->reset();
-
-  cmdBufferVk->begin();
-
   ResourceBarrierDesc barrier = {};
   barrier.texture             = this;
   barrier.oldLayout           = initialLayout;
   barrier.newLayout           = ResourceLayout::TransferDst;
-  cmdBufferVk->resourceBarrier(barrier);
+  cmdBuffer->resourceBarrier(barrier);
 
   uint32_t mipWidth = m_desc_.width >> mipLevel;
   mipWidth          = mipWidth > 0 ? mipWidth : 1;
@@ -279,7 +264,7 @@ void TextureVk::update(const void* data, size_t dataSize, uint32_t mipLevel, uin
   mipDepth          = mipDepth > 0 ? mipDepth : 1;
 
   VkBufferImageCopy region = {};
-  region.bufferOffset      = 0;
+  region.bufferOffset      = stagingOffset;
   region.bufferRowLength   = 0;  // Tightly packed
   region.bufferImageHeight = 0;  // Tightly packed
 
@@ -293,24 +278,15 @@ void TextureVk::update(const void* data, size_t dataSize, uint32_t mipLevel, uin
   region.imageExtent = {mipWidth, mipHeight, mipDepth};
 
   vkCmdCopyBufferToImage(
-      cmdBufferVk->getCommandBuffer(), stagingBuffer, m_image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+      cmdBuffer->getCommandBuffer(), stagingBuffer, m_image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 
+  // a texture without a layout yet is uploaded to be sampled, leaving it in ShaderReadOnly spares the caller a
+  // separate transition
   barrier.oldLayout = ResourceLayout::TransferDst;
-  barrier.newLayout = (initialLayout == ResourceLayout::Undefined) ? ResourceLayout::General : initialLayout;
-  cmdBufferVk->resourceBarrier(barrier);
-
-  cmdBufferVk->end();
-
-  FenceDesc fenceDesc;
-  fenceDesc.signaled = false;
-  auto fence         = m_device_->createFence(fenceDesc);
-
-  m_device_->submitCommandBuffer(commandBuffer.get(), fence.get());
-
-  fence->wait();
-
-  vmaDestroyBuffer(m_device_->getAllocator(), stagingBuffer, stagingAllocation);
+  barrier.newLayout = (initialLayout == ResourceLayout::Undefined) ? ResourceLayout::ShaderReadOnly : initialLayout;
+  cmdBuffer->resourceBarrier(barrier);
 }
+
 }  // namespace rhi
 }  // namespace gfx
 }  // namespace arise
\ No newline at end of file
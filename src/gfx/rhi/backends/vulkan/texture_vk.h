@@ -11,6 +11,7 @@ namespace arise {
 namespace gfx {
 namespace rhi {
 
+class CommandBufferVk;
 class DeviceVk;
 
 class TextureVk : public Texture {
@@ -38,9 +39,16 @@ class TextureVk : public Texture {
 
   VkImageLayout getImageLayout() const { return g_getImageLayoutVk(m_currentLayout_); }
 
-  // Updates texture data (for staging uploads)
+  // Updates texture data (for staging uploads), the copy is queued on the device's upload context
   void update(const void* data, size_t dataSize, uint32_t mipLevel = 0, uint32_t arrayLayer = 0);
 
+  // Records the copy of one subresource from a staging buffer, including the layout transitions
+  void recordUpload(CommandBufferVk* cmdBuffer,
+                    VkBuffer         stagingBuffer,
+                    VkDeviceSize     stagingOffset,
+                    uint32_t         mipLevel,
+                    uint32_t         arrayLayer);
+
   private:
   friend class CommandBufferVk;
   friend class FramebufferVk;
@@ -0,0 +1,354 @@
+#include "gfx/rhi/backends/vulkan/upload_context_vk.h"
+
+#include "gfx/rhi/backends/vulkan/buffer_vk.h"
+#include "gfx/rhi/backends/vulkan/command_buffer_vk.h"
+#include "gfx/rhi/backends/vulkan/device_vk.h"
+#include "gfx/rhi/backends/vulkan/synchronization_vk.h"
+#include "gfx/rhi/backends/vulkan/texture_vk.h"
+#include "profiler/profiler.h"
+#include "utils/logger/global_logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace arise {
+namespace gfx {
+namespace rhi {
+
+namespace {
+
+// a multiple of every texel / block size (1 - 16 bytes, including 12-byte RGB32 formats), copy offsets must respect it
+constexpr VkDeviceSize STAGING_ALIGNMENT = 48;
+
+// bigger uploads get their own staging buffer instead of flushing the whole ring for them
+constexpr VkDeviceSize MAX_RING_UPLOAD_FRACTION = 4;
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+UploadContextVk::UploadContextVk(DeviceVk* device)
+    : m_device_(device) {
+}
+
+UploadContextVk::~UploadContextVk() {
+  release();
+}
+
+bool UploadContextVk::initialize(VkDeviceSize ringSize) {
+  VkCommandPoolCreateInfo poolInfo = {};
+  poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags                   = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex        = m_device_->getQueueFamilyIndices().graphicsFamily.value();
+
+  // own pool: command pools are externally synchronized and the uploads are recorded from any thread
+  if (vkCreateCommandPool(m_device_->getDevice(), &poolInfo, nullptr, &m_commandPool_) != VK_SUCCESS) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create upload command pool");
+    return false;
+  }
+
+  VkBufferCreateInfo bufferInfo = {};
+  bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size               = ringSize;
+  bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+  VmaAllocationCreateInfo allocInfo = {};
+  allocInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+  allocInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+  VmaAllocationInfo allocationInfo;
+  if (vmaCreateBuffer(
+          m_device_->getAllocator(), &bufferInfo, &allocInfo, &m_ringBuffer_, &m_ringAllocation_, &allocationInfo)
+      != VK_SUCCESS) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create upload staging ring");
+    return false;
+  }
+
+  m_ringData_  = static_cast<uint8_t*>(allocationInfo.pMappedData);
+  m_ringSize_  = ringSize;
+  m_ringHead_  = 0;
+  m_ringTail_  = 0;
+  m_alignment_ = std::lcm(
+      STAGING_ALIGNMENT,
+      std::max<VkDeviceSize>(m_device_->getPhysicalDeviceProperties().limits.optimalBufferCopyOffsetAlignment, 1));
+
+  return true;
+}
+
+void UploadContextVk::release() {
+  if (!m_device_ || m_commandPool_ == VK_NULL_HANDLE) {
+    return;
+  }
+
+  waitIdle();
+
+  m_submittedBatches_.clear();
+  m_freeBatches_.clear();
+  m_recordingBatch_.reset();
+
+  // command buffers are freed with the pool
+  vkDestroyCommandPool(m_device_->getDevice(), m_commandPool_, nullptr);
+  m_commandPool_ = VK_NULL_HANDLE;
+
+  if (m_ringBuffer_ != VK_NULL_HANDLE) {
+    vmaDestroyBuffer(m_device_->getAllocator(), m_ringBuffer_, m_ringAllocation_);
+    m_ringBuffer_     = VK_NULL_HANDLE;
+    m_ringAllocation_ = VK_NULL_HANDLE;
+    m_ringData_       = nullptr;
+  }
+}
+
+void UploadContextVk::uploadBuffer(BufferVk* buffer, const void* data, size_t size, size_t offset) {
+  std::lock_guard<std::mutex> lock(m_mutex_);
+
+  StagingAllocation staging;
+  if (!allocateStaging_(size, staging)) {
+    return;
+  }
+  std::memcpy(staging.data, data, size);
+  vmaFlushAllocation(m_device_->getAllocator(), staging.allocation, staging.allocationOffset, size);
+
+  VkBufferCopy copyRegion = {};
+  copyRegion.srcOffset    = staging.offset;
+  copyRegion.dstOffset    = offset;
+  copyRegion.size         = size;
+
+  vkCmdCopyBuffer(getRecordingCommandBuffer_()->getCommandBuffer(),
+                  staging.buffer,
+                  buffer->getBuffer(),
+                  1,
+                  &copyRegion);
+}
+
+void UploadContextVk::uploadTexture(
+    TextureVk* texture, const void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
+  std::lock_guard<std::mutex> lock(m_mutex_);
+
+  StagingAllocation staging;
+  if (!allocateStaging_(size, staging)) {
+    return;
+  }
+  std::memcpy(staging.data, data, size);
+  vmaFlushAllocation(m_device_->getAllocator(), staging.allocation, staging.allocationOffset, size);
+
+  texture->recordUpload(getRecordingCommandBuffer_(), staging.buffer, staging.offset, mipLevel, arrayLayer);
+}
+
+void UploadContextVk::flush() {
+  CPU_ZONE_NC("UploadContextVk::flush", color::YELLOW);
+  std::lock_guard<std::mutex> lock(m_mutex_);
+
+  retireCompletedBatches_(false);
+
+  if (m_recordingBatch_) {
+    submitBatch_();
+  }
+}
+
+void UploadContextVk::waitIdle() {
+  std::lock_guard<std::mutex> lock(m_mutex_);
+
+  if (m_recordingBatch_) {
+    submitBatch_();
+  }
+
+  while (!m_submittedBatches_.empty()) {
+    retireCompletedBatches_(true);
+  }
+}
+
+bool UploadContextVk::allocateStaging_(VkDeviceSize size, StagingAllocation& outAllocation) {
+  if (size <= m_ringSize_ / MAX_RING_UPLOAD_FRACTION) {
+    while (true) {
+      VkDeviceSize offset = 0;
+      if (tryAllocateFromRing_(size, offset)) {
+        outAllocation.buffer           = m_ringBuffer_;
+        outAllocation.offset           = offset;
+        outAllocation.allocation       = m_ringAllocation_;
+        outAllocation.allocationOffset = offset;
+        outAllocation.data             = m_ringData_ + offset;
+        return true;
+      }
+
+      // the ring is full: the recorded uploads are submitted, so their memory can be reclaimed, and the CPU waits
+      // for the oldest batch - the only case where an upload stalls
+      if (m_recordingBatch_) {
+        submitBatch_();
+      }
+      if (m_submittedBatches_.empty()) {
+        break;
+      }
+      retireCompletedBatches_(true);
+    }
+  }
+
+  VkBufferCreateInfo bufferInfo = {};
+  bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size               = size;
+  bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+
+  VmaAllocationCreateInfo allocInfo = {};
+  allocInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+  allocInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+  DedicatedStaging  staging;
+  VmaAllocationInfo allocationInfo;
+  if (vmaCreateBuffer(
+          m_device_->getAllocator(), &bufferInfo, &allocInfo, &staging.buffer, &staging.allocation, &allocationInfo)
+      != VK_SUCCESS) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create staging buffer for upload");
+    return false;
+  }
+
+  getRecordingCommandBuffer_();
+  m_recordingBatch_->dedicatedStaging.push_back(staging);
+
+  outAllocation.buffer           = staging.buffer;
+  outAllocation.offset           = 0;
+  outAllocation.allocation       = staging.allocation;
+  outAllocation.allocationOffset = 0;
+  outAllocation.data             = allocationInfo.pMappedData;
+  return true;
+}
+
+bool UploadContextVk::tryAllocateFromRing_(VkDeviceSize size, VkDeviceSize& outOffset) {
+  const VkDeviceSize alignedHead = alignUp(m_ringHead_, m_alignment_);
+
+  // the head never catches up with the tail from behind, so head == tail always means an empty ring
+  if (m_ringHead_ >= m_ringTail_) {
+    if (alignedHead + size <= m_ringSize_) {
+      outOffset   = alignedHead;
+      m_ringHead_ = alignedHead + size;
+      return true;
+    }
+
+    // wrap around, the skipped end of the ring is reclaimed together with the batch that is in front of it
+    if (size < m_ringTail_) {
+      outOffset   = 0;
+      m_ringHead_ = size;
+      return true;
+    }
+
+    return false;
+  }
+
+  if (alignedHead + size < m_ringTail_) {
+    outOffset   = alignedHead;
+    m_ringHead_ = alignedHead + size;
+    return true;
+  }
+
+  return false;
+}
+
+CommandBufferVk* UploadContextVk::getRecordingCommandBuffer_() {
+  if (m_recordingBatch_) {
+    return m_recordingBatch_->commandBuffer.get();
+  }
+
+  if (!m_freeBatches_.empty()) {
+    m_recordingBatch_ = std::move(m_freeBatches_.back());
+    m_freeBatches_.pop_back();
+  } else {
+    m_recordingBatch_ = std::make_unique<Batch>();
+
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool                 = m_commandPool_;
+    allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount          = 1;
+    vkAllocateCommandBuffers(m_device_->getDevice(), &allocInfo, &m_recordingBatch_->vkCommandBuffer);
+
+    m_recordingBatch_->commandBuffer
+        = std::make_unique<CommandBufferVk>(m_device_, m_recordingBatch_->vkCommandBuffer, m_commandPool_);
+    m_recordingBatch_->fence = std::make_unique<FenceVk>(FenceDesc(), m_device_);
+  }
+
+  auto commandBuffer = m_recordingBatch_->commandBuffer.get();
+  commandBuffer->reset();
+  commandBuffer->begin();
+
+  // static resources may still be read by the frames in flight, the copies wait for that (no CPU wait involved)
+  VkMemoryBarrier barrier = {};
+  barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask   = 0;
+  barrier.dstAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(),
+                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       0,
+                       1,
+                       &barrier,
+                       0,
+                       nullptr,
+                       0,
+                       nullptr);
+
+  return commandBuffer;
+}
+
+void UploadContextVk::submitBatch_() {
+  auto commandBuffer = m_recordingBatch_->commandBuffer.get();
+
+  // makes the copies visible to everything submitted to the queue after this batch
+  VkMemoryBarrier barrier = {};
+  barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+  vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(),
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                       0,
+                       1,
+                       &barrier,
+                       0,
+                       nullptr,
+                       0,
+                       nullptr);
+
+  commandBuffer->end();
+
+  m_recordingBatch_->fence->reset();
+  m_device_->submitCommandBuffer(commandBuffer, m_recordingBatch_->fence.get());
+
+  m_recordingBatch_->ringEnd = m_ringHead_;
+  m_submittedBatches_.push_back(std::move(m_recordingBatch_));
+}
+
+void UploadContextVk::retireCompletedBatches_(bool waitForOldest) {
+  if (waitForOldest && !m_submittedBatches_.empty()) {
+    CPU_ZONE_NC("Wait For Upload", color::RED);
+    m_submittedBatches_.front()->fence->wait();
+  }
+
+  // batches complete in submission order (single queue)
+  while (!m_submittedBatches_.empty() && m_submittedBatches_.front()->fence->isSignaled()) {
+    auto batch = std::move(m_submittedBatches_.front());
+    m_submittedBatches_.pop_front();
+
+    m_ringTail_ = batch->ringEnd;
+    retireBatch_(*batch);
+    m_freeBatches_.push_back(std::move(batch));
+  }
+
+  if (m_submittedBatches_.empty() && !m_recordingBatch_) {
+    m_ringHead_ = 0;
+    m_ringTail_ = 0;
+  }
+}
+
+void UploadContextVk::retireBatch_(Batch& batch) {
+  for (auto& staging : batch.dedicatedStaging) {
+    vmaDestroyBuffer(m_device_->getAllocator(), staging.buffer, staging.allocation);
+  }
+  batch.dedicatedStaging.clear();
+}
+
+}  // namespace rhi
+}  // namespace gfx
+}  // namespace arise
@@ -0,0 +1,110 @@
+#ifndef ARISE_UPLOAD_CONTEXT_VK_H
+#define ARISE_UPLOAD_CONTEXT_VK_H
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace arise {
+namespace gfx {
+namespace rhi {
+
+class BufferVk;
+class CommandBufferVk;
+class DeviceVk;
+class FenceVk;
+class TextureVk;
+
+/**
+ * Asynchronous uploads to device-local buffers and textures.
+ *
+ * Data is copied into a persistently mapped ring staging buffer right away (the caller's memory can be freed after
+ * the call), the copy commands are recorded into the current batch and submitted to the graphics queue by flush() -
+ * once per frame, before the frame's command buffer, so the frame sees the data without the CPU waiting for the GPU.
+ * Ring memory of a batch is reclaimed when the batch's fence signals. The CPU only waits when the ring is full.
+ *
+ * Thread safe: resources may be uploaded from asset loading jobs.
+ */
+class UploadContextVk {
+  public:
+  explicit UploadContextVk(DeviceVk* device);
+  ~UploadContextVk();
+
+  UploadContextVk(const UploadContextVk&)            = delete;
+  UploadContextVk& operator=(const UploadContextVk&) = delete;
+
+  bool initialize(VkDeviceSize ringSize);
+  void release();
+
+  void uploadBuffer(BufferVk* buffer, const void* data, size_t size, size_t offset);
+  void uploadTexture(TextureVk* texture, const void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer);
+
+  // Submits the recorded uploads, commands submitted to the graphics queue afterwards see the data
+  void flush();
+
+  // Submits the recorded uploads and waits for all of them (e.g. before resources are destroyed)
+  void waitIdle();
+
+  private:
+  struct StagingAllocation {
+    VkBuffer      buffer           = VK_NULL_HANDLE;
+    VkDeviceSize  offset           = 0;
+    VmaAllocation allocation       = VK_NULL_HANDLE;
+    VkDeviceSize  allocationOffset = 0;
+    void*         data             = nullptr;
+  };
+
+  // staging buffer for an upload that doesn't fit the ring, destroyed with its batch
+  struct DedicatedStaging {
+    VkBuffer      buffer     = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+  };
+
+  struct Batch {
+    VkCommandBuffer                  vkCommandBuffer = VK_NULL_HANDLE;
+    std::unique_ptr<CommandBufferVk> commandBuffer;
+    std::unique_ptr<FenceVk>         fence;
+    VkDeviceSize                     ringEnd = 0;  // ring head when submitted, the tail moves here on retirement
+    std::vector<DedicatedStaging>    dedicatedStaging;
+  };
+
+  // all private methods expect m_mutex_ to be locked
+
+  bool allocateStaging_(VkDeviceSize size, StagingAllocation& outAllocation);
+  bool tryAllocateFromRing_(VkDeviceSize size, VkDeviceSize& outOffset);
+
+  CommandBufferVk* getRecordingCommandBuffer_();
+
+  void submitBatch_();
+  void retireCompletedBatches_(bool waitForOldest);
+  void retireBatch_(Batch& batch);
+
+  DeviceVk* m_device_ = nullptr;
+
+  VkCommandPool m_commandPool_ = VK_NULL_HANDLE;
+
+  VkBuffer      m_ringBuffer_     = VK_NULL_HANDLE;
+  VmaAllocation m_ringAllocation_ = VK_NULL_HANDLE;
+  uint8_t*      m_ringData_       = nullptr;
+  VkDeviceSize  m_ringSize_       = 0;
+  VkDeviceSize  m_ringHead_       = 0;
+  VkDeviceSize  m_ringTail_       = 0;
+  VkDeviceSize  m_alignment_      = 16;
+
+  std::unique_ptr<Batch>              m_recordingBatch_;  // null when nothing is recorded
+  std::deque<std::unique_ptr<Batch>>  m_submittedBatches_;
+  std::vector<std::unique_ptr<Batch>> m_freeBatches_;
+
+  std::mutex m_mutex_;
+};
+
+}  // namespace rhi
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_UPLOAD_CONTEXT_VK_H
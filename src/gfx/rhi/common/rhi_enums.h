@@ -87,6 +87,7 @@ enum class TextureFormat : uint8_t {
   Rg8,
   Rg16f,
   Rg32f,
+  Rg16Snorm,
 
   // Depth formats
   D16,
@@ -279,6 +280,12 @@ enum class AttachmentLoadStoreOp : uint8_t {
   Count
 };
 
+// How the commands of a render pass are recorded
+enum class RenderPassContents : uint8_t {
+  Inline,                  // directly into the primary command buffer
+  SecondaryCommandBuffers  // only executeCommands() of secondary command buffers (bundles in DX12)
+};
+
 enum class ShaderStageFlag : uint32_t {
   None                   = 0x00'00'00'00,
   Vertex                 = 0x00'00'00'01,
@@ -361,6 +368,17 @@ enum class PipelineType {
   Compute
 };
 
+// Buffer states for buffer barriers (textures use ResourceLayout)
+enum class BufferState : uint8_t {
+  Common,
+  ShaderRead,
+  VertexBuffer,  // vertex / instance input
+  UnorderedAccess,
+  IndirectArgument,
+  CopySource,
+  CopyDestination
+};
+
 enum class BufferCreateFlag : uint32_t {
   None                            = 0,
   CpuAccess                       = 0x00'00'00'01,
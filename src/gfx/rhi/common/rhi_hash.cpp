@@ -0,0 +1,140 @@
+#include "gfx/rhi/common/rhi_hash.h"
+
+#include <xxhash.h>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace arise {
+namespace gfx {
+namespace rhi {
+
+namespace {
+
+/**
+ * Writes fields one by one into a byte stream: hashing whole structs would include their padding, which is not
+ * guaranteed to be initialized.
+ */
+class HashStream {
+  public:
+  template <typename T>
+  void write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T> && !std::is_class_v<T>, "write fields, not structs");
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    m_bytes.insert(m_bytes.end(), bytes, bytes + sizeof(T));
+  }
+
+  void write(const std::string& value) {
+    write(static_cast<uint32_t>(value.size()));
+    m_bytes.insert(m_bytes.end(), value.begin(), value.end());
+  }
+
+  uint64_t finish() const { return XXH64(m_bytes.data(), m_bytes.size(), 0); }
+
+  private:
+  std::vector<uint8_t> m_bytes;
+};
+
+void hashStencilOp(HashStream& stream, const StencilOpState& state) {
+  stream.write(state.failOp);
+  stream.write(state.passOp);
+  stream.write(state.depthFailOp);
+  stream.write(state.compareOp);
+  stream.write(state.compareMask);
+  stream.write(state.writeMask);
+  stream.write(state.reference);
+}
+
+}  // namespace
+
+uint64_t g_hashGraphicsPipelineDesc(const GraphicsPipelineDesc& desc) {
+  HashStream stream;
+
+  stream.write(static_cast<uint32_t>(desc.shaders.size()));
+  for (const auto* shader : desc.shaders) {
+    stream.write(shader);
+  }
+
+  stream.write(static_cast<uint32_t>(desc.vertexBindings.size()));
+  for (const auto& binding : desc.vertexBindings) {
+    stream.write(binding.binding);
+    stream.write(binding.stride);
+    stream.write(binding.inputRate);
+  }
+
+  stream.write(static_cast<uint32_t>(desc.vertexAttributes.size()));
+  for (const auto& attribute : desc.vertexAttributes) {
+    stream.write(attribute.location);
+    stream.write(attribute.binding);
+    stream.write(attribute.format);
+    stream.write(attribute.offset);
+    stream.write(attribute.semanticName);
+  }
+
+  stream.write(desc.inputAssembly.topology);
+  stream.write(desc.inputAssembly.primitiveRestartEnable);
+
+  const auto& rasterization = desc.rasterization;
+  stream.write(rasterization.depthClampEnable);
+  stream.write(rasterization.rasterizerDiscardEnable);
+  stream.write(rasterization.polygonMode);
+  stream.write(rasterization.cullMode);
+  stream.write(rasterization.frontFace);
+  stream.write(rasterization.depthBiasEnable);
+  stream.write(rasterization.depthBiasConstantFactor);
+  stream.write(rasterization.depthBiasClamp);
+  stream.write(rasterization.depthBiasSlopeFactor);
+  stream.write(rasterization.lineWidth);
+
+  const auto& depthStencil = desc.depthStencil;
+  stream.write(depthStencil.depthTestEnable);
+  stream.write(depthStencil.depthWriteEnable);
+  stream.write(depthStencil.depthCompareOp);
+  stream.write(depthStencil.depthBoundsTestEnable);
+  stream.write(depthStencil.stencilTestEnable);
+  hashStencilOp(stream, depthStencil.front);
+  hashStencilOp(stream, depthStencil.back);
+  stream.write(depthStencil.minDepthBounds);
+  stream.write(depthStencil.maxDepthBounds);
+
+  const auto& colorBlend = desc.colorBlend;
+  stream.write(colorBlend.logicOpEnable);
+  stream.write(colorBlend.logicOp);
+  stream.write(static_cast<uint32_t>(colorBlend.attachments.size()));
+  for (const auto& attachment : colorBlend.attachments) {
+    stream.write(attachment.blendEnable);
+    stream.write(attachment.srcColorBlendFactor);
+    stream.write(attachment.dstColorBlendFactor);
+    stream.write(attachment.colorBlendOp);
+    stream.write(attachment.srcAlphaBlendFactor);
+    stream.write(attachment.dstAlphaBlendFactor);
+    stream.write(attachment.alphaBlendOp);
+    stream.write(attachment.colorWriteMask);
+  }
+  for (float constant : colorBlend.blendConstants) {
+    stream.write(constant);
+  }
+
+  const auto& multisample = desc.multisample;
+  stream.write(multisample.rasterizationSamples);
+  stream.write(multisample.sampleShadingEnable);
+  stream.write(multisample.minSampleShading);
+  stream.write(multisample.sampleMask);
+  stream.write(multisample.alphaToCoverageEnable);
+  stream.write(multisample.alphaToOneEnable);
+
+  stream.write(static_cast<uint32_t>(desc.setLayouts.size()));
+  for (const auto* layout : desc.setLayouts) {
+    stream.write(layout);
+  }
+
+  stream.write(desc.renderPass);
+  stream.write(desc.subpass);
+
+  return stream.finish();
+}
+
+}  // namespace rhi
+}  // namespace gfx
+}  // namespace arise
@@ -0,0 +1,24 @@
+#ifndef ARISE_RHI_HASH_H
+#define ARISE_RHI_HASH_H
+
+#include "gfx/rhi/common/rhi_types.h"
+
+#include <cstdint>
+
+namespace arise {
+namespace gfx {
+namespace rhi {
+
+/**
+ * Hash of everything that defines the created pipeline, so passes with an identical state share one pipeline object.
+ *
+ * Shaders, set layouts and the render pass are hashed by address - the result is only valid within one run (it's an
+ * in-memory cache key; compiled pipelines are persisted by the backend, e.g. VkPipelineCache).
+ */
+uint64_t g_hashGraphicsPipelineDesc(const GraphicsPipelineDesc& desc);
+
+}  // namespace rhi
+}  // namespace gfx
+}  // namespace arise
+
+#endif  // ARISE_RHI_HASH_H
@@ -224,6 +224,11 @@ struct GraphicsPipelineDesc {
   uint32_t                                subpass    = 0;
 };
 
+struct ComputePipelineDesc {
+  Shader*                                 shader = nullptr;
+  std::vector<const DescriptorSetLayout*> setLayouts;
+};
+
 //------------------------------------------------------
 // Render pass and framebuffer
 //------------------------------------------------------
@@ -278,6 +283,21 @@ struct ResourceBarrierDesc {
   ResourceLayout newLayout = ResourceLayout::General;
 };
 
+struct BufferBarrierDesc {
+  Buffer*     buffer   = nullptr;
+  BufferState oldState = BufferState::Common;
+  BufferState newState = BufferState::Common;
+};
+
+// Layout matches VkDrawIndexedIndirectCommand and D3D12_DRAW_INDEXED_ARGUMENTS
+struct DrawIndexedIndirectCommand {
+  uint32_t indexCount    = 0;
+  uint32_t instanceCount = 0;
+  uint32_t firstIndex    = 0;
+  int32_t  vertexOffset  = 0;
+  uint32_t firstInstance = 0;
+};
+
 union ClearValue {
   float color[4];
 
@@ -32,6 +32,9 @@ class Buffer {
 
   const BufferDesc& getDesc() const { return m_desc_; }
 
+  // CPU address of a persistently mapped buffer (dynamic / CPU accessible ones), nullptr if the buffer isn't mapped
+  virtual void* getMappedData() const { return nullptr; }
+
   protected:
   BufferDesc m_desc_;
 };
@@ -4,6 +4,8 @@
 #include "gfx/rhi/common/rhi_enums.h"
 #include "gfx/rhi/common/rhi_types.h"
 
+#include <span>
+
 namespace arise {
 namespace gfx {
 namespace rhi {
@@ -31,6 +33,13 @@ class CommandBuffer {
   virtual void end()   = 0;
   virtual void reset() = 0;
 
+  /**
+   * Begins a secondary command buffer (created with CommandBufferDesc::primary = false) that continues renderPass - its
+   * commands run inside of the render pass of the primary that executes it. No state is inherited from the primary,
+   * except that DX12 bundles use its viewport and scissor (setViewport / setScissor are ignored in a bundle).
+   */
+  virtual void beginSecondary(RenderPass* renderPass, Framebuffer* framebuffer) = 0;
+
   // Pipeline state
   virtual void setPipeline(Pipeline* pipeline)        = 0;
   virtual void setViewport(const Viewport& viewport)  = 0;
@@ -39,7 +48,12 @@ class CommandBuffer {
   // Resource binding
   virtual void bindVertexBuffer(uint32_t binding, Buffer* buffer, uint64_t offset = 0)            = 0;
   virtual void bindIndexBuffer(Buffer* buffer, uint64_t offset = 0, bool use32BitIndices = false) = 0;
-  virtual void bindDescriptorSet(uint32_t setIndex, DescriptorSet* set)                           = 0;
+
+  /**
+   * dynamicOffsets - one byte offset per dynamic buffer binding (UniformbufferDynamic / BufferUavDynamic) of the set,
+   * in binding order
+   */
+  virtual void bindDescriptorSet(uint32_t setIndex, DescriptorSet* set, std::span<const uint32_t> dynamicOffsets = {}) = 0;
 
   // Draw commands
   virtual void draw(uint32_t vertexCount, uint32_t firstVertex = 0)                                                                                             = 0;
@@ -48,14 +62,24 @@ class CommandBuffer {
   virtual void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) = 0;
   // TODO: add more draw commands if needed
 
-  // TODO: in future add 'Compute dispatch' section
+  // Indirect draws - args holds DrawIndexedIndirectCommand records, stride is the distance between them in bytes
+  virtual void drawIndexedIndirect(Buffer* argBuffer, uint64_t argOffset, uint32_t drawCount, uint32_t stride = sizeof(DrawIndexedIndirectCommand))                                                                = 0;
+  // The number of draws is read from countBuffer (uint32_t at countOffset) and clamped to maxDrawCount
+  virtual void drawIndexedIndirectCount(Buffer* argBuffer, uint64_t argOffset, Buffer* countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride = sizeof(DrawIndexedIndirectCommand)) = 0;
+
+  // Compute dispatch
+  virtual void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) = 0;
 
   // Resource barriers
   virtual void resourceBarrier(const ResourceBarrierDesc& barrier) = 0;
+  virtual void bufferBarrier(const BufferBarrierDesc& barrier)     = 0;
 
   // Render pass operations
-  virtual void beginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const std::vector<ClearValue>& clearValues) = 0;
-  virtual void endRenderPass()                                                                                               = 0;
+  virtual void beginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const std::vector<ClearValue>& clearValues, RenderPassContents contents = RenderPassContents::Inline) = 0;
+  virtual void endRenderPass()                                                                                                                                                          = 0;
+
+  // Executes the secondary command buffers in order, the render pass must be begun with RenderPassContents::SecondaryCommandBuffers
+  virtual void executeCommands(std::span<CommandBuffer* const> commandBuffers) = 0;
 
   // Copy operations
   virtual void copyBuffer(Buffer* srcBuffer, Buffer* dstBuffer, uint64_t srcOffset = 0, uint64_t dstOffset = 0, uint64_t size = 0)														   = 0;
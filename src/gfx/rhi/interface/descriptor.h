@@ -51,6 +51,9 @@ class DescriptorSet {
   virtual void setSampler(uint32_t binding, Sampler* sampler) = 0;
   virtual void setStorageBuffer(uint32_t binding, Buffer* buffer, uint64_t offset = 0, uint64_t range = 0) = 0;
 
+  // element of a texture array binding (descriptorCount > 1), setTexture() writes element 0
+  virtual void setTextureArrayElement(uint32_t binding, uint32_t arrayElement, Texture* texture, ResourceLayout layout = ResourceLayout::ShaderReadOnly) = 0;
+
   // clang-format on
 
   virtual const DescriptorSetLayout* getLayout() const = 0;
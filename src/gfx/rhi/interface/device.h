@@ -19,6 +19,7 @@ class Texture;
 class Sampler;
 class Shader;
 class GraphicsPipeline;
+class ComputePipeline;
 class DescriptorSetLayout;
 class DescriptorSet;
 class RenderPass;
@@ -52,6 +53,7 @@ class Device {
   virtual std::unique_ptr<Sampler>             createSampler(const SamplerDesc& desc)                                   = 0;
   virtual std::unique_ptr<Shader>              createShader(const ShaderDesc& desc)                                     = 0;
   virtual std::unique_ptr<GraphicsPipeline>    createGraphicsPipeline(const GraphicsPipelineDesc& desc)                 = 0;
+  virtual std::unique_ptr<ComputePipeline>     createComputePipeline(const ComputePipelineDesc& desc)                   = 0;
   virtual std::unique_ptr<DescriptorSetLayout> createDescriptorSetLayout(const DescriptorSetLayoutDesc& desc)           = 0;
   virtual std::unique_ptr<DescriptorSet>       createDescriptorSet(const DescriptorSetLayout* layout)                   = 0;
   virtual std::unique_ptr<RenderPass>          createRenderPass(const RenderPassDesc& desc)                             = 0;
@@ -69,8 +71,20 @@ class Device {
    */
   virtual void submitCommandBuffer(CommandBuffer* cmdBuffer, Fence* signalFence = nullptr, const std::vector<Semaphore*>& waitSemaphores = {}, const std::vector<Semaphore*>& signalSemaphores = {}) = 0;
 
+  /**
+   * Submits the queued resource uploads (updateBuffer / updateTexture may be asynchronous). Called before the frame's
+   * command buffer is submitted, so the frame sees the uploaded data
+   */
+  virtual void flushUploads() {}
+
   virtual void waitIdle() = 0;
 
+  // Indirect draws with drawCount > 1 and firstInstance != 0
+  virtual bool supportsMultiDrawIndirect() const { return true; }
+
+  // CommandBuffer::drawIndexedIndirectCount
+  virtual bool supportsDrawIndirectCount() const { return true; }
+
   private:
   // TODO: change constness if needed
   const Window* const m_window_;
@@ -58,6 +58,24 @@ class GraphicsPipeline : public Pipeline {
   GraphicsPipelineDesc m_desc_;
 };
 
+/**
+ * Compute pipeline state object: a single compute shader and its pipeline layout.
+ */
+class ComputePipeline : public Pipeline {
+  public:
+  ComputePipeline(const ComputePipelineDesc& desc)
+      : m_desc_(desc) {}
+
+  virtual ~ComputePipeline() = default;
+
+  PipelineType getType() const { return PipelineType::Compute; }
+
+  const ComputePipelineDesc& getDesc() const { return m_desc_; }
+
+  protected:
+  ComputePipelineDesc m_desc_;
+};
+
 }  // namespace rhi
 }  // namespace gfx
 }  // namespace arise
@@ -33,24 +33,54 @@ std::vector<std::unique_ptr<Material>> AssimpMaterialLoader::loadMaterials(const
   return materials;
 }
 
+std::vector<std::filesystem::path> AssimpMaterialLoader::getImagePaths(const std::filesystem::path& filePath,
+                                                                       std::shared_ptr<const void>* outSourceHandle) {
+  auto scenePtr = AssimpSceneCache::getOrLoad(filePath);
+  if (!scenePtr) {
+    return {};
+  }
+
+  if (outSourceHandle) {
+    *outSourceHandle = scenePtr;
+  }
+
+  return collectImagePaths(scenePtr.get(), filePath);
+}
+
+std::vector<std::filesystem::path> AssimpMaterialLoader::collectImagePaths(const aiScene*               scene,
+                                                                           const std::filesystem::path& filePath) {
+  std::vector<std::filesystem::path> imagePaths;
+  for (unsigned int i = 0; i < scene->mNumMaterials; ++i) {
+    for (int type = aiTextureType_NONE + 1; type <= AI_TEXTURE_TYPE_MAX; ++type) {
+      auto textureType = static_cast<aiTextureType>(type);
+      if (!aiTextureTypeToMaterialTexture(textureType)) {
+        continue;
+      }
+      for (unsigned int j = 0; j < scene->mMaterials[i]->GetTextureCount(textureType); ++j) {
+        aiString path;
+        if (scene->mMaterials[i]->GetTexture(textureType, j, &path) == AI_SUCCESS) {
+          imagePaths.push_back(filePath.parent_path() / path.C_Str());
+        }
+      }
+    }
+  }
+  return imagePaths;
+}
+
 std::vector<std::unique_ptr<Material>> AssimpMaterialLoader::processMaterials(const aiScene*               scene,
                                                                               const std::filesystem::path& filePath) {
   struct Parameter {
-    const char*  name;   // Friendly name for mapping
+    float*       value;  // Field of the material data
     const char*  pKey;   // Property key
     unsigned int type;   // Property type
     unsigned int index;  // Property index
   };
 
-  std::vector<Parameter> scalarParametersToFetch = {
-    {"roughness", AI_MATKEY_ROUGHNESS_FACTOR},
-    { "metallic",  AI_MATKEY_METALLIC_FACTOR},
-    {  "opacity",          AI_MATKEY_OPACITY}
-  };
-
-  std::vector<Parameter> vectorParametersToFetch = {
-    {"base_color", AI_MATKEY_BASE_COLOR}
-  };
+  // decode all referenced images up front on the job system
+  auto imageManager = ServiceLocator::s_get<ImageManager>();
+  if (imageManager) {
+    imageManager->prefetchImages(collectImagePaths(scene, filePath));
+  }
 
   std::vector<std::unique_ptr<Material>> materials;
   for (unsigned int i = 0; i < scene->mNumMaterials; ++i) {
@@ -66,18 +96,22 @@ std::vector<std::unique_ptr<Material>> AssimpMaterialLoader::processMaterials(co
       material->materialName = "Material_" + std::to_string(i);
     }
 
+    std::vector<Parameter> scalarParametersToFetch = {
+      {&material->data.roughness, AI_MATKEY_ROUGHNESS_FACTOR},
+      { &material->data.metallic,  AI_MATKEY_METALLIC_FACTOR},
+      {  &material->data.opacity,          AI_MATKEY_OPACITY}
+    };
+
     for (const auto& param : scalarParametersToFetch) {
       float value;
       if (AI_SUCCESS == ai_material->Get(param.pKey, param.type, param.index, value)) {
-        material->scalarParameters[param.name] = value;
+        *param.value = value;
       }
     }
 
-    for (const auto& param : vectorParametersToFetch) {
-      aiColor3D color;
-      if (AI_SUCCESS == ai_material->Get(param.pKey, param.type, param.index, color)) {
-        material->vectorParameters[param.name] = math::Vector4f(color.r, color.g, color.b, 1.0f);
-      }
+    aiColor3D color;
+    if (AI_SUCCESS == ai_material->Get(AI_MATKEY_BASE_COLOR, color)) {
+      material->data.baseColor = math::Vector4f(color.r, color.g, color.b, 1.0f);
     }
 
     // Load textures
@@ -97,10 +131,18 @@ void AssimpMaterialLoader::loadTextures(aiMaterial*                  mat,
                                         aiTextureType                type,
                                         Material*                    material,
                                         const std::filesystem::path& basePath) {
+  // textures without a material slot (e.g. separate metalness / roughness maps) aren't used by the renderer, glTF
+  // metallic-roughness maps come from the cgltf loader
+  auto slot = aiTextureTypeToMaterialTexture(type);
+  if (!slot) {
+    return;
+  }
+
   for (unsigned int i = 0; i < mat->GetTextureCount(type); ++i) {
     aiString path;
     if (mat->GetTexture(type, i, &path) == AI_SUCCESS) {
       std::filesystem::path fullPath = basePath.parent_path() / path.C_Str();
+      material->setTexturePath(*slot, fullPath);
 
       auto imageManager = ServiceLocator::s_get<ImageManager>();
       if (!imageManager) {
@@ -122,28 +164,23 @@ void AssimpMaterialLoader::loadTextures(aiMaterial*                  mat,
         auto texture = textureManager->createTexture(image, textureName);
 
         if (texture) {
-          material->textures[aiTextureTypeToString(type)] = texture;
+          material->data.setTexture(*slot, texture);
         }
       }
     }
   }
 }
 
-std::string AssimpMaterialLoader::aiTextureTypeToString(aiTextureType type) {
+std::optional<MaterialTexture> AssimpMaterialLoader::aiTextureTypeToMaterialTexture(aiTextureType type) {
   switch (type) {
     case aiTextureType_BASE_COLOR:
     case aiTextureType_DIFFUSE:
-      return "albedo";
-    case aiTextureType_METALNESS:
-      return "metalness";
-    case aiTextureType_DIFFUSE_ROUGHNESS:
-    case aiTextureType_MAYA_SPECULAR_ROUGHNESS:  // Maya PBR
-      return "roughness";
+      return MaterialTexture::Albedo;
     case aiTextureType_NORMALS:
-    case aiTextureType_NORMAL_CAMERA:            // Maya PBR
-      return "normal_map";
+    case aiTextureType_NORMAL_CAMERA:  // Maya PBR
+      return MaterialTexture::NormalMap;
     default:
-      return "unknown";
+      return std::nullopt;
   }
 }
 }  // namespace arise
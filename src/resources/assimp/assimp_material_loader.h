@@ -5,10 +5,13 @@
 #ifdef ARISE_USE_ASSIMP
 
 
+#include "ecs/components/material.h"
 #include "gfx/rhi/interface/device.h"
 #include "resources/i_material_loader.h"
 #include "resources/image.h"
 
+#include <optional>
+
 struct aiMaterial;
 struct aiScene;
 enum aiTextureType;
@@ -22,12 +25,17 @@ class AssimpMaterialLoader : public IMaterialLoader {
 
   std::vector<std::unique_ptr<Material>> loadMaterials(const std::filesystem::path& filePath) override;
 
+  std::vector<std::filesystem::path> getImagePaths(const std::filesystem::path& filePath,
+                                                   std::shared_ptr<const void>* outSourceHandle = nullptr) override;
+
   private:
+  std::vector<std::filesystem::path> collectImagePaths(const aiScene* scene, const std::filesystem::path& filePath);
+
   std::vector<std::unique_ptr<Material>> processMaterials(const aiScene* scene, const std::filesystem::path& filePath);
 
   void loadTextures(aiMaterial* mat, aiTextureType type, Material* material, const std::filesystem::path& basePath);
 
-  std::string aiTextureTypeToString(aiTextureType type);
+  std::optional<MaterialTexture> aiTextureTypeToMaterialTexture(aiTextureType type);
 };
 
 }  // namespace arise
@@ -3,6 +3,7 @@
 #include "resources/assimp/assimp_model_loader.h"
 
 #include "resources/assimp/asssimp_common.h"
+#include "utils/job/job_system.h"
 #include "utils/logger/global_logger.h"
 #include "utils/model/mesh_manager.h"
 #include "utils/service/service_locator.h"
@@ -29,11 +30,9 @@ std::unique_ptr<Model> AssimpModelLoader::loadModel(const std::filesystem::path&
 
   model->meshes.reserve(scene->mNumMeshes);
 
-  for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-    aiMesh* ai_mesh = scene->mMeshes[i];
-
-    auto mesh = processMesh(ai_mesh);
+  auto meshes = processMeshes(scene);
 
+  for (auto& mesh : meshes) {
     Mesh* meshPtr = meshManager->addMesh(std::move(mesh), filePath);
 
     model->meshes.push_back(meshPtr);
@@ -42,26 +41,37 @@ std::unique_ptr<Model> AssimpModelLoader::loadModel(const std::filesystem::path&
   return model;
 }
 
+uint64_t AssimpModelLoader::getImporterVersion() const {
+  return 1 ^ m_meshOptimizer.getVersion();
+}
+
 std::vector<std::unique_ptr<Mesh>> AssimpModelLoader::processMeshes(const aiScene* scene) {
   std::vector<std::unique_ptr<Mesh>> meshes;
   // TODO: consider that there exists aiNode, so current implementation with
   // aiMesh may be incorrect + consider that there are mesh transforms exists
-  meshes.reserve(scene->mNumMeshes);
+  meshes.resize(scene->mNumMeshes);
 
-  for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-    aiMesh* ai_mesh = scene->mMeshes[i];
-    meshes.push_back(processMesh(ai_mesh));
-  }
+  // meshes are independent, so they are processed in parallel
+  auto processRange = [this, scene, &meshes](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      meshes[i] = processMesh(scene->mMeshes[i]);
+    }
+  };
+
+  g_parallelFor(scene->mNumMeshes, 1, processRange);
   return meshes;
 }
 
 std::unique_ptr<Mesh> AssimpModelLoader::processMesh(aiMesh* ai_mesh) {
-  auto mesh      = std::make_unique<Mesh>();
-  mesh->meshName = ai_mesh->mName.C_Str();
+  auto mesh           = std::make_unique<Mesh>();
+  mesh->meshName      = ai_mesh->mName.C_Str();
+  mesh->materialIndex = static_cast<int32_t>(ai_mesh->mMaterialIndex);
 
   processVertices(ai_mesh, mesh.get());
   processIndices(ai_mesh, mesh.get());
 
+  m_meshOptimizer.optimize(*mesh);
+
   return mesh;
 }
 
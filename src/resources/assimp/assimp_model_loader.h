@@ -5,6 +5,7 @@
 #ifdef ARISE_USE_ASSIMP
 
 #include "resources/i_model_loader.h"
+#include "utils/model/mesh_optimizer.h"
 
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -16,8 +17,13 @@ namespace arise {
 
 class AssimpModelLoader : public IModelLoader {
   public:
+  explicit AssimpModelLoader(const MeshOptimizerSettings& meshOptimizerSettings = {})
+      : m_meshOptimizer(meshOptimizerSettings) {}
+
   std::unique_ptr<Model> loadModel(const std::filesystem::path& filePath) override;
 
+  uint64_t getImporterVersion() const override;
+
   std::vector<std::unique_ptr<Mesh>> processMeshes(const aiScene* scene);
 
   private:
@@ -32,6 +38,8 @@ class AssimpModelLoader : public IModelLoader {
   math::Vector4f                             processColor(aiMesh* ai_mesh, unsigned int index);
   void                                        processIndices(aiMesh* ai_mesh, Mesh* mesh);
   void calculateTangentsAndBitangents(aiMesh* ai_mesh, std::vector<Vertex>& vertices);
+
+  MeshOptimizer m_meshOptimizer;
 };
 
 }  // namespace arise
@@ -6,6 +6,7 @@
 #include "resources/assimp/assimp_model_loader.h"
 #include "resources/assimp/asssimp_common.h"
 #include "utils/buffer/buffer_manager.h"
+#include "utils/buffer/geometry_arena.h"
 #include "utils/material/material_manager.h"
 #include "utils/model/mesh_manager.h"
 #include "utils/model/render_geometry_mesh_manager.h"
@@ -80,38 +81,19 @@ std::unique_ptr<RenderModel> AssimpRenderModelLoader::loadRenderModel(const std:
 std::unique_ptr<RenderGeometryMesh> AssimpRenderModelLoader::createRenderGeometryMesh(Mesh* mesh) {
   auto renderGeometryMesh = std::make_unique<RenderGeometryMesh>();
 
-  renderGeometryMesh->vertexBuffer = createVertexBuffer(mesh);
-  renderGeometryMesh->indexBuffer  = createIndexBuffer(mesh);
-
-  return renderGeometryMesh;
-}
-
-gfx::rhi::Buffer* AssimpRenderModelLoader::createVertexBuffer(const Mesh* mesh) {
-  auto bufferManager = ServiceLocator::s_get<BufferManager>();
-  if (!bufferManager) {
-    GlobalLogger::Log(LogLevel::Error, "Cannot create vertex buffer, BufferManager not found");
-    return nullptr;
+  auto geometryArena = ServiceLocator::s_get<GeometryArena>();
+  if (!geometryArena) {
+    GlobalLogger::Log(LogLevel::Error, "Cannot create render geometry mesh, GeometryArena not found");
+    return renderGeometryMesh;
   }
 
-  // TODO: consider rewrite unique ID key
-  std::string bufferName  = "VertexBuffer_";
-  bufferName             += mesh->meshName.empty() ? "Unnamed" : mesh->meshName;
-
-  return bufferManager->createVertexBuffer(mesh->vertices.data(), mesh->vertices.size(), sizeof(Vertex), bufferName);
-}
-
-gfx::rhi::Buffer* AssimpRenderModelLoader::createIndexBuffer(const Mesh* mesh) {
-  auto bufferManager = ServiceLocator::s_get<BufferManager>();
-  if (!bufferManager) {
-    GlobalLogger::Log(LogLevel::Error, "Cannot create index buffer, BufferManager not found");
-    return nullptr;
+  // the geometry may point into a mapped derived data entry
+  if (!geometryArena->allocate(renderGeometryMesh.get(), *mesh)) {
+    GlobalLogger::Log(LogLevel::Error,
+                      "Failed to allocate geometry for mesh " + (mesh->meshName.empty() ? "Unnamed" : mesh->meshName));
   }
 
-  // TODO: consider rewrite unique ID key
-  std::string bufferName  = "IndexBuffer_";
-  bufferName             += mesh->meshName.empty() ? "Unnamed" : mesh->meshName;
-
-  return bufferManager->createIndexBuffer(mesh->indices.data(), mesh->indices.size(), sizeof(uint32_t), bufferName);
+  return renderGeometryMesh;
 }
 
 }  // namespace arise
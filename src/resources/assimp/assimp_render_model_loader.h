@@ -19,10 +19,8 @@ class AssimpRenderModelLoader : public IRenderModelLoader {
 
   private:
   // GPU-side geometry mesh
+  // Allocates the geometry in the GeometryArena
   std::unique_ptr<RenderGeometryMesh> createRenderGeometryMesh(Mesh* mesh);
-
-  gfx::rhi::Buffer* createVertexBuffer(const Mesh* mesh);
-  gfx::rhi::Buffer* createIndexBuffer(const Mesh* mesh);
 };
 
 }  // namespace arise
@@ -11,6 +11,7 @@
 
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -23,10 +24,13 @@ class AssimpSceneCache {
   static std::shared_ptr<const aiScene> getOrLoad(const std::filesystem::path& path) {
     auto absPath = std::filesystem::absolute(path).string();
 
-    auto it = s_cache.find(absPath);
-    if (it != s_cache.end()) {
-      if (auto ptr = it->second.lock()) {
-        return ptr;
+    {
+      std::lock_guard<std::mutex> lock(s_mutex);
+      auto                        it = s_cache.find(absPath);
+      if (it != s_cache.end()) {
+        if (auto ptr = it->second.lock()) {
+          return ptr;
+        }
       }
     }
 
@@ -43,12 +47,19 @@ class AssimpSceneCache {
     }
 
     std::shared_ptr<const aiScene> scenePtr(sceneRaw, [importer](const aiScene*) { delete importer; });
-    s_cache.emplace(absPath, scenePtr);
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto&                       cached = s_cache[absPath];
+    if (auto ptr = cached.lock()) {
+      return ptr;
+    }
+    cached = scenePtr;
     return scenePtr;
   }
 
   private:
   static inline std::unordered_map<std::string, std::weak_ptr<const aiScene>> s_cache;
+  static inline std::mutex                                                    s_mutex;
 };
 
 }  // namespace arise
@@ -7,18 +7,26 @@
 
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 namespace arise {
 
+/**
+ * Shares parsed glTF data between model, render model and material loaders. Thread-safe, parsing happens outside of
+ * the lock so different files can be parsed concurrently.
+ */
 class CgltfSceneCache {
   public:
   static std::shared_ptr<cgltf_data> getOrLoad(const std::filesystem::path& path) {
     auto absolutePath = std::filesystem::absolute(path).string();
-    auto it = s_cache.find(absolutePath);
-    if (it != s_cache.end()) {
-      if (auto ptr = it->second.lock()) {
-        return ptr;
+    {
+      std::lock_guard<std::mutex> lock(s_mutex);
+      auto                        it = s_cache.find(absolutePath);
+      if (it != s_cache.end()) {
+        if (auto ptr = it->second.lock()) {
+          return ptr;
+        }
       }
     }
 
@@ -32,13 +40,21 @@ class CgltfSceneCache {
       return {};
     }
 
-    auto scene   = std::shared_ptr<cgltf_data>(raw, [](cgltf_data* d) { cgltf_free(d); });
-    s_cache[absolutePath] = scene;
+    auto scene = std::shared_ptr<cgltf_data>(raw, [](cgltf_data* d) { cgltf_free(d); });
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto&                       cached = s_cache[absolutePath];
+    // another thread may have parsed the same file in the meantime
+    if (auto ptr = cached.lock()) {
+      return ptr;
+    }
+    cached = scene;
     return scene;
   }
 
   private:
   static inline std::unordered_map<std::string, std::weak_ptr<cgltf_data>> s_cache;
+  static inline std::mutex                                                 s_mutex;
 };
 
 }  // namespace arise
@@ -13,6 +13,44 @@
 
 namespace arise {
 
+namespace {
+
+const cgltf_image* getTextureImage(const cgltf_texture* texture) {
+  if (!texture) {
+    return nullptr;
+  }
+  if (texture->image == nullptr && texture->has_basisu && texture->basisu_image) {
+    return texture->basisu_image;
+  }
+  return texture->image;
+}
+
+// Collects file paths of all external images referenced by the materials, so they can be decoded in parallel
+std::vector<std::filesystem::path> collectImagePaths(const cgltf_data* data, const std::filesystem::path& basePath) {
+  std::vector<std::filesystem::path> imagePaths;
+
+  for (size_t i = 0; i < data->materials_count; ++i) {
+    const auto& material = data->materials[i];
+
+    const cgltf_texture* textures[] = {
+      material.pbr_metallic_roughness.base_color_texture.texture,
+      material.pbr_metallic_roughness.metallic_roughness_texture.texture,
+      material.normal_texture.texture,
+    };
+
+    for (const auto* texture : textures) {
+      const auto* image = getTextureImage(texture);
+      if (image && image->uri) {
+        imagePaths.push_back(basePath / image->uri);
+      }
+    }
+  }
+
+  return imagePaths;
+}
+
+}  // namespace
+
 std::vector<std::unique_ptr<Material>> CgltfMaterialLoader::loadMaterials(const std::filesystem::path& filePath) {
   GlobalLogger::Log(LogLevel::Info, "Loading materials from " + filePath.string());
 
@@ -32,11 +70,32 @@ std::vector<std::unique_ptr<Material>> CgltfMaterialLoader::loadMaterials(const
   return materials;
 }
 
+std::vector<std::filesystem::path> CgltfMaterialLoader::getImagePaths(const std::filesystem::path& filePath,
+                                                                      std::shared_ptr<const void>* outSourceHandle) {
+  auto scene = CgltfSceneCache::getOrLoad(filePath);
+  if (!scene) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to load GLTF scene: " + filePath.string());
+    return {};
+  }
+
+  if (outSourceHandle) {
+    *outSourceHandle = scene;
+  }
+
+  return collectImagePaths(scene.get(), filePath.parent_path());
+}
+
 std::vector<std::unique_ptr<Material>> CgltfMaterialLoader::processMaterials(const cgltf_data*            data,
                                                                              const std::filesystem::path& filePath) {
   std::vector<std::unique_ptr<Material>> materials;
   materials.reserve(data->materials_count);
 
+  // decode all images up front on the job system, texture creation below only hits the image cache
+  auto imageManager = ServiceLocator::s_get<ImageManager>();
+  if (imageManager) {
+    imageManager->prefetchImages(collectImagePaths(data, filePath.parent_path()));
+  }
+
   for (size_t i = 0; i < data->materials_count; ++i) {
     auto material = processMaterial(&data->materials[i], filePath, i);
     if (material) {
@@ -59,18 +118,18 @@ std::unique_ptr<Material> CgltfMaterialLoader::processMaterial(const cgltf_mater
   if (material->has_pbr_metallic_roughness) {
     const auto& pbr = material->pbr_metallic_roughness;
 
-    outMaterial->vectorParameters["base_color"] = math::Vector4f(
+    outMaterial->data.baseColor = math::Vector4f(
         pbr.base_color_factor[0], pbr.base_color_factor[1], pbr.base_color_factor[2], pbr.base_color_factor[3]);
 
-    outMaterial->scalarParameters["metallic"] = pbr.metallic_factor;
+    outMaterial->data.metallic = pbr.metallic_factor;
 
-    outMaterial->scalarParameters["roughness"] = pbr.roughness_factor;
+    outMaterial->data.roughness = pbr.roughness_factor;
   }
 
   if (material->alpha_mode == cgltf_alpha_mode_opaque) {
-    outMaterial->scalarParameters["opacity"] = 1.0f;
+    outMaterial->data.opacity = 1.0f;
   } else if (material->alpha_mode == cgltf_alpha_mode_blend) {
-    outMaterial->scalarParameters["opacity"] = material->pbr_metallic_roughness.base_color_factor[3];
+    outMaterial->data.opacity = material->pbr_metallic_roughness.base_color_factor[3];
   }
 
   loadTextures(material, outMaterial.get(), filePath.parent_path());
@@ -93,9 +152,12 @@ void CgltfMaterialLoader::loadTextures(const cgltf_material*        material,
     }
 
     if (image) {
+      if (image->uri) {
+        outMaterial->setTexturePath(MaterialTexture::Albedo, basePath / image->uri);
+      }
       auto textureResource = loadTexture(image, basePath, "albedo");
       if (textureResource) {
-        outMaterial->textures["albedo"] = textureResource;
+        outMaterial->data.setTexture(MaterialTexture::Albedo, textureResource);
       }
     }
   }
@@ -112,9 +174,12 @@ void CgltfMaterialLoader::loadTextures(const cgltf_material*        material,
     }
 
     if (image) {
+      if (image->uri) {
+        outMaterial->setTexturePath(MaterialTexture::MetallicRoughness, basePath / image->uri);
+      }
       auto textureResource = loadTexture(image, basePath, "metallic_roughness");
       if (textureResource) {
-        outMaterial->textures["metallic_roughness"] = textureResource;
+        outMaterial->data.setTexture(MaterialTexture::MetallicRoughness, textureResource);
       }
     }
   }
@@ -131,9 +196,12 @@ void CgltfMaterialLoader::loadTextures(const cgltf_material*        material,
     }
 
     if (image) {
+      if (image->uri) {
+        outMaterial->setTexturePath(MaterialTexture::NormalMap, basePath / image->uri);
+      }
       auto textureResource = loadTexture(image, basePath, "normal_map");
       if (textureResource) {
-        outMaterial->textures["normal_map"] = textureResource;
+        outMaterial->data.setTexture(MaterialTexture::NormalMap, textureResource);
       }
     }
   }
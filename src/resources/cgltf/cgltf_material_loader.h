@@ -21,6 +21,9 @@ class CgltfMaterialLoader : public IMaterialLoader {
 
   std::vector<std::unique_ptr<Material>> loadMaterials(const std::filesystem::path& filePath) override;
 
+  std::vector<std::filesystem::path> getImagePaths(const std::filesystem::path& filePath,
+                                                   std::shared_ptr<const void>* outSourceHandle = nullptr) override;
+
   private:
   std::vector<std::unique_ptr<Material>> processMaterials(const cgltf_data*            data,
                                                           const std::filesystem::path& filePath);
@@ -5,6 +5,7 @@
 #include "ecs/components/bounding_volume.h"
 #include "ecs/components/model.h"
 #include "resources/cgltf/cgltf_common.h"
+#include "utils/job/job_system.h"
 #include "utils/logger/global_logger.h"
 #include "utils/model/mesh_manager.h"
 #include "utils/service/service_locator.h"
@@ -17,6 +18,8 @@
 #include <mikktspace.h>
 #endif
 
+#include <cstring>
+
 namespace arise {
 
 std::unique_ptr<Model> CgltfModelLoader::loadModel(const std::filesystem::path& filePath) {
@@ -40,20 +43,53 @@ std::unique_ptr<Model> CgltfModelLoader::loadModel(const std::filesystem::path&
     return nullptr;
   }
 
+  // vertex / index extraction and tangent generation are independent per primitive, so they are processed in
+  // parallel; everything that touches shared state (naming, MeshManager) stays sequential below
+  std::vector<const cgltf_primitive*> primitives;
   for (size_t i = 0; i < data->meshes_count; ++i) {
-    cgltf_mesh* gltf_mesh = &data->meshes[i];
+    for (size_t j = 0; j < data->meshes[i].primitives_count; ++j) {
+      primitives.push_back(&data->meshes[i].primitives[j]);
+    }
+  }
 
-    cgltf_node* meshNode = nullptr;
-    for (size_t j = 0; j < data->nodes_count; ++j) {
-      if (data->nodes[j].mesh == gltf_mesh) {
-        meshNode = &data->nodes[j];
-        break;
+  std::vector<std::unique_ptr<Mesh>> processedMeshes(primitives.size());
+
+  auto processRange = [this, &primitives, &processedMeshes](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      processedMeshes[i] = processPrimitive(primitives[i]);
+    }
+  };
+
+  g_parallelFor(static_cast<uint32_t>(primitives.size()), 1, processRange);
+
+  // the node hierarchy is kept on the model, mesh transforms are derived from it instead of walking up the parents
+  // of every mesh node separately
+  std::vector<int32_t> nodeRemap = buildNodeHierarchy(data, model.get());
+
+  // a mesh referenced by several nodes uses the first one
+  std::vector<int32_t> meshNodeIndices(data->meshes_count, -1);
+  for (size_t i = 0; i < data->nodes_count; ++i) {
+    const cgltf_node& node = data->nodes[i];
+    if (node.mesh) {
+      auto& meshNodeIndex = meshNodeIndices[node.mesh - data->meshes];
+      if (meshNodeIndex < 0) {
+        meshNodeIndex = nodeRemap[i];
       }
     }
+  }
+
+  size_t primitiveIndex = 0;
+  for (size_t i = 0; i < data->meshes_count; ++i) {
+    cgltf_mesh* gltf_mesh     = &data->meshes[i];
+    int32_t     meshNodeIndex = meshNodeIndices[i];
 
     for (size_t j = 0; j < gltf_mesh->primitives_count; ++j) {
-      auto mesh = processPrimitive(&gltf_mesh->primitives[j]);
+      auto mesh = std::move(processedMeshes[primitiveIndex++]);
       if (mesh) {
+        if (gltf_mesh->primitives[j].material) {
+          mesh->materialIndex = static_cast<int32_t>(gltf_mesh->primitives[j].material - data->materials);
+        }
+
         if (gltf_mesh->name) {
           mesh->meshName = gltf_mesh->name;
           if (gltf_mesh->primitives_count > 1) {
@@ -63,9 +99,10 @@ std::unique_ptr<Model> CgltfModelLoader::loadModel(const std::filesystem::path&
           mesh->meshName = "Mesh_" + std::to_string(i) + "_Primitive_" + std::to_string(j);
         }
 
-        if (meshNode) {
-          math::Matrix4f<> localMatrix = getNodeTransformMatrix(meshNode);
-          math::Matrix4f<> worldMatrix = calculateWorldMatrix(meshNode, localMatrix);
+        if (meshNodeIndex >= 0) {
+          mesh->nodeIndex = meshNodeIndex;
+
+          math::Matrix4f<> worldMatrix = model->nodes[meshNodeIndex].worldMatrix;
           auto             zFlipMatrix = math::g_scale(math::Vector3f(1.0f, 1.0f, -1.0f));
           worldMatrix                  = worldMatrix * zFlipMatrix;  // Flip Z axis to match OpenGL coordinate system
 
@@ -104,17 +141,77 @@ std::unique_ptr<Model> CgltfModelLoader::loadModel(const std::filesystem::path&
   return model;
 }
 
-math::Matrix4f<> CgltfModelLoader::calculateWorldMatrix(cgltf_node* node, const math::Matrix4f<>& localMatrix) {
-  math::Matrix4f<> worldMatrix = localMatrix;
+uint64_t CgltfModelLoader::getImporterVersion() const {
+  // MikkTSpace generates different tangents than calculateTangents()
+#ifdef ARISE_USE_MIKKTS
+  constexpr uint64_t tangentVersion = 2;
+#else
+  constexpr uint64_t tangentVersion = 1;
+#endif
+  return tangentVersion ^ m_meshOptimizer.getVersion();
+}
 
-  cgltf_node* parent = node->parent;
-  while (parent) {
-    math::Matrix4f<> parentMatrix = getNodeTransformMatrix(parent);
-    worldMatrix                   = worldMatrix * parentMatrix;
-    parent                        = parent->parent;
+std::vector<std::filesystem::path> CgltfModelLoader::getDependencies(const std::filesystem::path& filePath) const {
+  cgltf_options options{};
+  cgltf_data*   data = nullptr;
+  if (cgltf_parse_file(&options, filePath.string().c_str(), &data) != cgltf_result_success) {
+    // the import fails the same way, the source alone keys it
+    return {};
   }
 
-  return worldMatrix;
+  std::vector<std::filesystem::path> dependencies;
+  for (size_t i = 0; i < data->buffers_count; ++i) {
+    const char* uri = data->buffers[i].uri;
+    // glb chunks and data URIs are part of the source
+    if (!uri || std::strncmp(uri, "data:", 5) == 0) {
+      continue;
+    }
+
+    // resolved the way cgltf_load_buffers() does
+    std::string decodedUri = uri;
+    cgltf_decode_uri(decodedUri.data());
+    decodedUri.resize(std::strlen(decodedUri.c_str()));
+    dependencies.push_back(filePath.parent_path() / std::filesystem::path(decodedUri));
+  }
+
+  cgltf_free(data);
+  return dependencies;
+}
+
+std::vector<int32_t> CgltfModelLoader::buildNodeHierarchy(const cgltf_data* data, Model* model) {
+  std::vector<int32_t> nodeRemap(data->nodes_count, -1);
+  model->nodes.reserve(data->nodes_count);
+
+  // depth-first from the roots, so parents are always stored before their children
+  std::vector<std::pair<const cgltf_node*, int32_t>> stack;
+  for (size_t i = data->nodes_count; i > 0; --i) {
+    const cgltf_node* node = &data->nodes[i - 1];
+    if (!node->parent) {
+      stack.emplace_back(node, -1);
+    }
+  }
+
+  while (!stack.empty()) {
+    auto [node, parentIndex] = stack.back();
+    stack.pop_back();
+
+    auto nodeIndex                = static_cast<int32_t>(model->nodes.size());
+    nodeRemap[node - data->nodes] = nodeIndex;
+
+    ModelNode modelNode;
+    modelNode.name        = node->name ? node->name : "Node_" + std::to_string(node - data->nodes);
+    modelNode.parentIndex = parentIndex;
+    modelNode.localMatrix = getNodeTransformMatrix(node);
+    model->nodes.push_back(std::move(modelNode));
+
+    for (size_t i = node->children_count; i > 0; --i) {
+      stack.emplace_back(node->children[i - 1], nodeIndex);
+    }
+  }
+
+  updateNodeWorldMatrices(model->nodes);
+
+  return nodeRemap;
 }
 
 bool CgltfModelLoader::containsMesh(cgltf_node* node) {
@@ -209,6 +306,9 @@ std::unique_ptr<Mesh> CgltfModelLoader::processPrimitive(const cgltf_primitive*
 #endif
   }
 
+  // after the tangents, the vertex deduplication compares whole vertices
+  m_meshOptimizer.optimize(*mesh);
+
   return mesh;
 }
 
@@ -3,11 +3,13 @@
 #ifdef ARISE_USE_CGLTF
 
 #include "resources/i_model_loader.h"
+#include "utils/model/mesh_optimizer.h"
 
 #include <math_library/matrix.h>
 
 #include <filesystem>
 #include <memory>
+#include <vector>
 
 struct cgltf_data;
 struct cgltf_node;
@@ -21,13 +23,21 @@ struct BoundingBox;
 
 class CgltfModelLoader : public IModelLoader {
   public:
-  CgltfModelLoader()  = default;
+  explicit CgltfModelLoader(const MeshOptimizerSettings& meshOptimizerSettings = {})
+      : m_meshOptimizer(meshOptimizerSettings) {}
+
   ~CgltfModelLoader() = default;
 
   std::unique_ptr<Model> loadModel(const std::filesystem::path& filePath) override;
 
+  uint64_t getImporterVersion() const override;
+
+  // The buffers stored next to the file (buffers[].uri), only the JSON is parsed
+  std::vector<std::filesystem::path> getDependencies(const std::filesystem::path& filePath) const override;
+
   private:
-  math::Matrix4f<>      calculateWorldMatrix(cgltf_node* node, const math::Matrix4f<>& localMatrix);
+  // Fills Model::nodes (parents first) and returns the mapping from cgltf node index to model node index
+  std::vector<int32_t>  buildNodeHierarchy(const cgltf_data* data, Model* model);
   bool                  containsMesh(cgltf_node* node);
   math::Matrix4f<>      getNodeTransformMatrix(const cgltf_node* node);
   std::unique_ptr<Mesh> processPrimitive(const cgltf_primitive* primitive);
@@ -41,6 +51,8 @@ class CgltfModelLoader : public IModelLoader {
 #ifdef ARISE_USE_MIKKTS
   void generateMikkTSpaceTangents(Mesh* mesh);
 #endif
+
+  MeshOptimizer m_meshOptimizer;
 };
 }  // namespace arise
 
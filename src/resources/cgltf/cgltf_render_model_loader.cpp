@@ -2,10 +2,10 @@
 
 #include "resources/cgltf/cgltf_render_model_loader.h"
 
-#include "resources/cgltf/cgltf_common.h"
 #include "resources/cgltf/cgltf_material_loader.h"
 #include "resources/cgltf/cgltf_model_loader.h"
 #include "utils/buffer/buffer_manager.h"
+#include "utils/buffer/geometry_arena.h"
 #include "utils/logger/global_logger.h"
 #include "utils/material/material_manager.h"
 #include "utils/model/mesh_manager.h"
@@ -14,21 +14,12 @@
 #include "utils/model/render_mesh_manager.h"
 #include "utils/service/service_locator.h"
 
-#include <cgltf.h>
 #include <math_library/matrix.h>
 
 namespace arise {
 
 std::unique_ptr<RenderModel> CgltfRenderModelLoader::loadRenderModel(const std::filesystem::path& filePath,
                                                                      Model**                      outModelPtr) {
-  auto scene = CgltfSceneCache::getOrLoad(filePath);
-  if (!scene) {
-    GlobalLogger::Log(LogLevel::Error, "Failed to load GLTF scene for material mapping: " + filePath.string());
-    return nullptr;
-  }
-
-  const cgltf_data* data = scene.get();
-
   auto materialManager           = ServiceLocator::s_get<MaterialManager>();
   auto renderGeometryMeshManager = ServiceLocator::s_get<RenderGeometryMeshManager>();
   auto renderMeshManager         = ServiceLocator::s_get<RenderMeshManager>();
@@ -49,49 +40,37 @@ std::unique_ptr<RenderModel> CgltfRenderModelLoader::loadRenderModel(const std::
   auto& meshes = cpuModelPtr->meshes;
   renderModel->renderMeshes.reserve(meshes.size());
 
-  size_t meshIndex = 0;
-  for (size_t i = 0; i < data->meshes_count && meshIndex < meshes.size(); ++i) {
-    cgltf_mesh* gltf_mesh = &data->meshes[i];
-
-    for (size_t j = 0; j < gltf_mesh->primitives_count && meshIndex < meshes.size(); ++j) {
-      Mesh* meshPtr = meshes[meshIndex++];
-
-      auto renderGeometryMesh = createRenderGeometryMesh(meshPtr);
-      auto gpuMeshPtr = renderGeometryMeshManager->addRenderGeometryMesh(std::move(renderGeometryMesh), meshPtr);
-
-      Material*              materialPtr = nullptr;
-      const cgltf_primitive* primitive   = &gltf_mesh->primitives[j];
-      if (primitive->material) {
-        for (size_t materialIndex = 0; materialIndex < data->materials_count; ++materialIndex) {
-          if (&data->materials[materialIndex] == primitive->material) {
-            if (materialIndex < materialPointers.size()) {
-              materialPtr = materialPointers[materialIndex];
-            } else {
-              GlobalLogger::Log(
-                  LogLevel::Warning,
-                  "Material index " + std::to_string(materialIndex) + " out of range for mesh " + meshPtr->meshName);
-            }
-            break;
-          }
-        }
+  // meshes carry their material index, so the scene doesn't have to be parsed again (a model loaded from the
+  // derived data cache has no parsed scene at all)
+  for (Mesh* meshPtr : meshes) {
+    auto renderGeometryMesh = createRenderGeometryMesh(meshPtr);
+    auto gpuMeshPtr = renderGeometryMeshManager->addRenderGeometryMesh(std::move(renderGeometryMesh), meshPtr);
+
+    Material* materialPtr = nullptr;
+    if (meshPtr->materialIndex >= 0) {
+      if (static_cast<size_t>(meshPtr->materialIndex) < materialPointers.size()) {
+        materialPtr = materialPointers[meshPtr->materialIndex];
+      } else {
+        GlobalLogger::Log(LogLevel::Warning,
+                          "Material index " + std::to_string(meshPtr->materialIndex) + " out of range for mesh "
+                              + meshPtr->meshName);
       }
+    }
 
-      auto renderMeshPtr = renderMeshManager->addRenderMesh(gpuMeshPtr, materialPtr, meshPtr);
-
-      std::string bufferName = "transform_matrix_" + meshPtr->meshName;
-      if (bufferManager) {
-        renderMeshPtr->transformMatrixBuffer
-            = bufferManager->createUniformBuffer(sizeof(math::Matrix4f<>), &meshPtr->transformMatrix, bufferName);
-        if (renderMeshPtr->transformMatrixBuffer) {
-          GlobalLogger::Log(LogLevel::Debug, "Created transform matrix buffer for mesh " + meshPtr->meshName);
-        } else {
-          GlobalLogger::Log(LogLevel::Warning,
-                            "Failed to create transform matrix buffer for mesh " + meshPtr->meshName);
-        }
-      }
+    auto renderMeshPtr = renderMeshManager->addRenderMesh(gpuMeshPtr, materialPtr, meshPtr);
 
-      renderModel->renderMeshes.push_back(renderMeshPtr);
+    std::string bufferName = "transform_matrix_" + meshPtr->meshName;
+    if (bufferManager) {
+      renderMeshPtr->transformMatrixBuffer
+          = bufferManager->createUniformBuffer(sizeof(math::Matrix4f<>), &meshPtr->transformMatrix, bufferName);
+      if (renderMeshPtr->transformMatrixBuffer) {
+        GlobalLogger::Log(LogLevel::Debug, "Created transform matrix buffer for mesh " + meshPtr->meshName);
+      } else {
+        GlobalLogger::Log(LogLevel::Warning, "Failed to create transform matrix buffer for mesh " + meshPtr->meshName);
+      }
     }
+
+    renderModel->renderMeshes.push_back(renderMeshPtr);
   }
 
   if (outModelPtr) {
@@ -105,36 +84,19 @@ std::unique_ptr<RenderModel> CgltfRenderModelLoader::loadRenderModel(const std::
 std::unique_ptr<RenderGeometryMesh> CgltfRenderModelLoader::createRenderGeometryMesh(Mesh* mesh) {
   auto renderGeometryMesh = std::make_unique<RenderGeometryMesh>();
 
-  renderGeometryMesh->vertexBuffer = createVertexBuffer(mesh);
-  renderGeometryMesh->indexBuffer  = createIndexBuffer(mesh);
-
-  return renderGeometryMesh;
-}
-
-gfx::rhi::Buffer* CgltfRenderModelLoader::createVertexBuffer(const Mesh* mesh) {
-  auto bufferManager = ServiceLocator::s_get<BufferManager>();
-  if (!bufferManager) {
-    GlobalLogger::Log(LogLevel::Error, "Cannot create vertex buffer, BufferManager not found");
-    return nullptr;
+  auto geometryArena = ServiceLocator::s_get<GeometryArena>();
+  if (!geometryArena) {
+    GlobalLogger::Log(LogLevel::Error, "Cannot create render geometry mesh, GeometryArena not found");
+    return renderGeometryMesh;
   }
 
-  std::string bufferName  = "VertexBuffer_";
-  bufferName             += mesh->meshName.empty() ? "Unnamed" : mesh->meshName;
-
-  return bufferManager->createVertexBuffer(mesh->vertices.data(), mesh->vertices.size(), sizeof(Vertex), bufferName);
-}
-
-gfx::rhi::Buffer* CgltfRenderModelLoader::createIndexBuffer(const Mesh* mesh) {
-  auto bufferManager = ServiceLocator::s_get<BufferManager>();
-  if (!bufferManager) {
-    GlobalLogger::Log(LogLevel::Error, "Cannot create index buffer, BufferManager not found");
-    return nullptr;
+  // the geometry may point into a mapped derived data entry
+  if (!geometryArena->allocate(renderGeometryMesh.get(), *mesh)) {
+    GlobalLogger::Log(LogLevel::Error,
+                      "Failed to allocate geometry for mesh " + (mesh->meshName.empty() ? "Unnamed" : mesh->meshName));
   }
 
-  std::string bufferName  = "IndexBuffer_";
-  bufferName             += mesh->meshName.empty() ? "Unnamed" : mesh->meshName;
-
-  return bufferManager->createIndexBuffer(mesh->indices.data(), mesh->indices.size(), sizeof(uint32_t), bufferName);
+  return renderGeometryMesh;
 }
 
 }  // namespace arise
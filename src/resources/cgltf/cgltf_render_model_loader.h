@@ -18,10 +18,8 @@ class CgltfRenderModelLoader : public IRenderModelLoader {
 
   private:
   // GPU-side geometry mesh
+  // Allocates the geometry in the GeometryArena
   std::unique_ptr<RenderGeometryMesh> createRenderGeometryMesh(Mesh* mesh);
-
-  gfx::rhi::Buffer* createVertexBuffer(const Mesh* mesh);
-  gfx::rhi::Buffer* createIndexBuffer(const Mesh* mesh);
 };
 
 }  // namespace arise
@@ -0,0 +1,69 @@
+#include "resources/cooked/cooked_model_loader.h"
+
+#include "utils/logger/global_logger.h"
+#include "utils/model/cooked_mesh.h"
+#include "utils/model/mesh_manager.h"
+#include "utils/service/service_locator.h"
+
+namespace arise {
+
+std::unique_ptr<Model> CookedModelLoader::loadModel(const std::filesystem::path& filePath) {
+  auto file = CookedMeshFile::s_open(filePath);
+  if (!file) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to load cooked mesh file: " + filePath.string());
+    return nullptr;
+  }
+
+  return s_loadModel(*file, filePath);
+}
+
+std::unique_ptr<Model> CookedModelLoader::s_loadModel(const CookedMeshFile&        file,
+                                                      const std::filesystem::path& modelPath) {
+  auto meshManager = ServiceLocator::s_get<MeshManager>();
+  if (!meshManager) {
+    GlobalLogger::Log(LogLevel::Error, "MeshManager not available in ServiceLocator.");
+    return nullptr;
+  }
+
+  auto model         = std::make_unique<Model>();
+  model->filePath    = modelPath;
+  model->boundingBox = file.getHeader().boundingBox;
+
+  const auto nodes = file.getNodes();
+  model->nodes.reserve(nodes.size());
+  for (const auto& cookedNode : nodes) {
+    auto& node       = model->nodes.emplace_back();
+    node.name        = file.getString(cookedNode.name);
+    node.parentIndex = cookedNode.parentIndex;
+    node.localMatrix = cookedNode.localMatrix;
+  }
+  updateNodeWorldMatrices(model->nodes);
+
+  const auto meshes = file.getMeshes();
+  model->meshes.reserve(meshes.size());
+  for (const auto& record : meshes) {
+    auto mesh                 = std::make_unique<Mesh>();
+    mesh->meshName            = file.getString(record.name);
+    mesh->transformMatrix     = record.transformMatrix;
+    mesh->boundingBox         = record.boundingBox;
+    mesh->nodeIndex           = record.nodeIndex;
+    mesh->materialIndex       = record.materialIndex;
+    mesh->mappedFile          = file.getMapping();
+    mesh->mappedVertexStreams = file.getVertexStreams(record);
+    mesh->mappedIndices       = file.getIndices(record);
+
+    const auto lods        = file.getLods(record);
+    mesh->lods             = std::vector<MeshLod>(lods.begin(), lods.end());
+    mesh->mappedLodIndices = file.getLodIndices(record);
+
+    model->meshes.push_back(meshManager->addMesh(std::move(mesh), modelPath));
+  }
+
+  GlobalLogger::Log(LogLevel::Info,
+                    "Mapped cooked model '" + modelPath.filename().string() + "' with "
+                        + std::to_string(meshes.size()) + " meshes");
+
+  return model;
+}
+
+}  // namespace arise
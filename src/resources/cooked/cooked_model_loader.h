@@ -0,0 +1,35 @@
+#ifndef ARISE_COOKED_MODEL_LOADER_H
+#define ARISE_COOKED_MODEL_LOADER_H
+
+#include "resources/i_model_loader.h"
+
+#include <filesystem>
+#include <memory>
+
+namespace arise {
+
+class CookedMeshFile;
+
+/**
+ * Loads cooked mesh files (see CookedMeshFile). The meshes don't copy the geometry, they point into the mapped file
+ * (Mesh::mappedVertexStreams / mappedIndices) and keep the mapping alive.
+ */
+class CookedModelLoader : public IModelLoader {
+  public:
+  CookedModelLoader()  = default;
+  ~CookedModelLoader() = default;
+
+  std::unique_ptr<Model> loadModel(const std::filesystem::path& filePath) override;
+
+  /**
+   * Builds the model from an opened cooked mesh file.
+   *
+   * @param modelPath path the model (and its meshes) are registered under - the source path when the file is a derived
+   * data cache entry
+   */
+  static std::unique_ptr<Model> s_loadModel(const CookedMeshFile& file, const std::filesystem::path& modelPath);
+};
+
+}  // namespace arise
+
+#endif  // ARISE_COOKED_MODEL_LOADER_H
@@ -0,0 +1,98 @@
+#include "resources/cooked/cooked_render_model_loader.h"
+
+#include "utils/buffer/buffer_manager.h"
+#include "utils/buffer/geometry_arena.h"
+#include "utils/logger/global_logger.h"
+#include "utils/material/material_manager.h"
+#include "utils/model/cooked_mesh.h"
+#include "utils/model/model_manager.h"
+#include "utils/model/render_geometry_mesh_manager.h"
+#include "utils/model/render_mesh_manager.h"
+#include "utils/service/service_locator.h"
+
+#include <math_library/matrix.h>
+
+namespace arise {
+
+std::unique_ptr<RenderModel> CookedRenderModelLoader::loadRenderModel(const std::filesystem::path& filePath,
+                                                                      Model**                      outModelPtr) {
+  auto materialManager           = ServiceLocator::s_get<MaterialManager>();
+  auto renderGeometryMeshManager = ServiceLocator::s_get<RenderGeometryMeshManager>();
+  auto renderMeshManager         = ServiceLocator::s_get<RenderMeshManager>();
+  auto bufferManager             = ServiceLocator::s_get<BufferManager>();
+  auto modelManager              = ServiceLocator::s_get<ModelManager>();
+
+  if (!materialManager || !renderGeometryMeshManager || !renderMeshManager || !bufferManager || !modelManager) {
+    GlobalLogger::Log(LogLevel::Error, "Required managers not available in ServiceLocator.");
+    return nullptr;
+  }
+
+  auto cpuModelPtr = modelManager->getModel(filePath);
+  if (!cpuModelPtr) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to load CPU model from " + filePath.string());
+    return nullptr;
+  }
+
+  // mapping the file again only reads the header, the model keeps its own mapping
+  std::vector<Material*> materialPointers;
+  if (auto file = CookedMeshFile::s_open(filePath)) {
+    auto sourcePath = file->getSourcePath();
+    if (std::filesystem::exists(sourcePath)) {
+      materialPointers = materialManager->getMaterials(sourcePath);
+    } else {
+      GlobalLogger::Log(LogLevel::Warning,
+                        "Source of cooked model is missing, it is drawn without materials: " + sourcePath.string());
+    }
+  }
+
+  auto renderModel      = std::make_unique<RenderModel>();
+  renderModel->filePath = filePath;
+  renderModel->renderMeshes.reserve(cpuModelPtr->meshes.size());
+
+  for (Mesh* meshPtr : cpuModelPtr->meshes) {
+    auto renderGeometryMesh = createRenderGeometryMesh(meshPtr);
+    auto gpuMeshPtr = renderGeometryMeshManager->addRenderGeometryMesh(std::move(renderGeometryMesh), meshPtr);
+
+    Material* materialPtr = nullptr;
+    if (meshPtr->materialIndex >= 0 && static_cast<size_t>(meshPtr->materialIndex) < materialPointers.size()) {
+      materialPtr = materialPointers[meshPtr->materialIndex];
+    }
+
+    auto renderMeshPtr = renderMeshManager->addRenderMesh(gpuMeshPtr, materialPtr, meshPtr);
+
+    std::string bufferName = "transform_matrix_" + meshPtr->meshName;
+    renderMeshPtr->transformMatrixBuffer
+        = bufferManager->createUniformBuffer(sizeof(math::Matrix4f<>), &meshPtr->transformMatrix, bufferName);
+    if (!renderMeshPtr->transformMatrixBuffer) {
+      GlobalLogger::Log(LogLevel::Warning, "Failed to create transform matrix buffer for mesh " + meshPtr->meshName);
+    }
+
+    renderModel->renderMeshes.push_back(renderMeshPtr);
+  }
+
+  if (outModelPtr) {
+    *outModelPtr = cpuModelPtr;
+  }
+
+  return renderModel;
+}
+
+std::unique_ptr<RenderGeometryMesh> CookedRenderModelLoader::createRenderGeometryMesh(Mesh* mesh) {
+  auto renderGeometryMesh = std::make_unique<RenderGeometryMesh>();
+
+  auto geometryArena = ServiceLocator::s_get<GeometryArena>();
+  if (!geometryArena) {
+    GlobalLogger::Log(LogLevel::Error, "Cannot create render geometry mesh, GeometryArena not found");
+    return renderGeometryMesh;
+  }
+
+  // the streams point into the mapped file, the upload reads the pages directly without a heap copy or conversion
+  if (!geometryArena->allocate(renderGeometryMesh.get(), *mesh)) {
+    GlobalLogger::Log(LogLevel::Error,
+                      "Failed to allocate geometry for mesh " + (mesh->meshName.empty() ? "Unnamed" : mesh->meshName));
+  }
+
+  return renderGeometryMesh;
+}
+
+}  // namespace arise
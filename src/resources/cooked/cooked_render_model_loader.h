@@ -0,0 +1,30 @@
+#ifndef ARISE_COOKED_RENDER_MODEL_LOADER_H
+#define ARISE_COOKED_RENDER_MODEL_LOADER_H
+
+#include "resources/i_render_model_loader.h"
+
+#include <filesystem>
+#include <memory>
+
+namespace arise {
+
+/**
+ * Uploads cooked meshes straight from the mapped file. Materials aren't cooked, they are loaded from the source file
+ * the mesh was cooked from (if it is still there).
+ */
+class CookedRenderModelLoader : public IRenderModelLoader {
+  public:
+  CookedRenderModelLoader()  = default;
+  ~CookedRenderModelLoader() = default;
+
+  std::unique_ptr<RenderModel> loadRenderModel(const std::filesystem::path& filePath,
+                                               Model**                      outModel = nullptr) override;
+
+  private:
+  // Allocates the geometry in the GeometryArena
+  std::unique_ptr<RenderGeometryMesh> createRenderGeometryMesh(Mesh* mesh);
+};
+
+}  // namespace arise
+
+#endif  // ARISE_COOKED_RENDER_MODEL_LOADER_H
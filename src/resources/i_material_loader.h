@@ -3,12 +3,25 @@
 
 #include "ecs/components/material.h"
 
+#include <filesystem>
+#include <memory>
+#include <vector>
+
 namespace arise {
 
 class IMaterialLoader {
   public:
   virtual ~IMaterialLoader() = default;
   virtual std::vector<std::unique_ptr<Material>> loadMaterials(const std::filesystem::path& filepath) = 0;
+
+  /**
+   * Returns external image files referenced by the materials, so they can be decoded ahead of material loading.
+   * @param outSourceHandle optionally receives a handle that keeps the parsed source file cached while it's held.
+   */
+  virtual std::vector<std::filesystem::path> getImagePaths(const std::filesystem::path& filepath,
+                                                           std::shared_ptr<const void>* outSourceHandle = nullptr) {
+    return {};
+  }
 };
 
 }  // namespace arise
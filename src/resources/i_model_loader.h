@@ -3,8 +3,10 @@
 
 #include "ecs/components/model.h"
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <vector>
 
 namespace arise {
 
@@ -12,6 +14,12 @@ class IModelLoader {
   public:
   virtual ~IModelLoader()                                                         = default;
   virtual std::unique_ptr<Model> loadModel(const std::filesystem::path& filepath) = 0;
+
+  // Part of the derived data cache key - bump it whenever the loader produces different meshes for the same source
+  virtual uint64_t getImporterVersion() const { return 1; }
+
+  // Files besides the source the import reads (e.g. external glTF buffers), also part of the derived data cache key
+  virtual std::vector<std::filesystem::path> getDependencies(const std::filesystem::path& filepath) const { return {}; }
 };
 
 }  // namespace arise
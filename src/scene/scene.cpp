@@ -6,8 +6,13 @@
 
 namespace arise {
 
+Scene::Scene() {
+  connectRegistrySignals_();
+}
+
 Scene::Scene(Registry registry)
     : entityRegistry_(std::move(registry)) {
+  connectRegistrySignals_();
 }
 
 Registry& Scene::getEntityRegistry() {
@@ -20,6 +25,31 @@ const Registry& Scene::getEntityRegistry() const {
 
 void Scene::setEntityRegistry(Registry registry) {
   entityRegistry_ = std::move(registry);
+  spatialIndex_.clear();
+  changeTracker_.reset();
+  connectRegistrySignals_();
+}
+
+SpatialIndex& Scene::getSpatialIndex() {
+  return spatialIndex_;
+}
+
+const SpatialIndex& Scene::getSpatialIndex() const {
+  return spatialIndex_;
+}
+
+SceneChangeTracker& Scene::getChangeTracker() {
+  return changeTracker_;
+}
+
+void Scene::connectRegistrySignals_() {
+  // entities are removed from the index right away, so queries never return destroyed entities
+  entityRegistry_.on_destroy<WorldBounds>().connect<&Scene::onWorldBoundsDestroyed_>(*this);
+  changeTracker_.connect(entityRegistry_);
+}
+
+void Scene::onWorldBoundsDestroyed_(Registry& registry, entt::entity entity) {
+  spatialIndex_.remove(entity);
 }
 
 }  // namespace arise
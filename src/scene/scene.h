@@ -1,6 +1,9 @@
 #ifndef ARISE_SCENE_H
 #define ARISE_SCENE_H
 
+#include "scene/scene_change_tracker.h"
+#include "scene/spatial_index.h"
+
 #include <entt/entt.hpp>
 
 namespace arise {
@@ -13,16 +16,34 @@ using Registry = entt::registry;
  */
 class Scene {
   public:
-  Scene() = default;
+  Scene();
   Scene(Registry registry);
 
+  Scene(const Scene&)            = delete;
+  Scene& operator=(const Scene&) = delete;
+
   Registry& getEntityRegistry();
 
   const Registry& getEntityRegistry() const;
 
   void setEntityRegistry(Registry registry);
 
+  SpatialIndex& getSpatialIndex();
+
+  const SpatialIndex& getSpatialIndex() const;
+
+  SceneChangeTracker& getChangeTracker();
+
   private:
+  void connectRegistrySignals_();
+
+  void onWorldBoundsDestroyed_(Registry& registry, entt::entity entity);
+
+  /// Spatial index over WorldBounds (maintained by BoundingVolumeSystem) and the log of renderable changes. Declared
+  /// before the registry, so they're still alive while the registry is destroyed.
+  SpatialIndex       spatialIndex_;
+  SceneChangeTracker changeTracker_;
+
   /// Holds all entities (actors) and their components in the current scene.
   Registry entityRegistry_;
 };
@@ -0,0 +1,82 @@
+#include "scene/scene_change_tracker.h"
+
+#include "ecs/components/light.h"
+#include "ecs/components/render_model.h"
+#include "ecs/components/world_matrix.h"
+
+namespace arise {
+
+void SceneChangeTracker::connect(entt::registry& registry) {
+  registry.on_construct<RenderModel*>().connect<&SceneChangeTracker::onChanged_>(*this);
+  registry.on_update<RenderModel*>().connect<&SceneChangeTracker::onChanged_>(*this);
+  registry.on_destroy<RenderModel*>().connect<&SceneChangeTracker::onChanged_>(*this);
+
+  registry.on_construct<WorldMatrix>().connect<&SceneChangeTracker::onChanged_>(*this);
+  registry.on_destroy<WorldMatrix>().connect<&SceneChangeTracker::onChanged_>(*this);
+  registry.on_update<WorldMatrix>().connect<&SceneChangeTracker::onMoved_>(*this);
+
+  registry.on_construct<Light>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+  registry.on_update<Light>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+  registry.on_destroy<Light>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+
+  registry.on_construct<DirectionalLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+  registry.on_update<DirectionalLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+  registry.on_destroy<DirectionalLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+
+  registry.on_construct<PointLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+  registry.on_update<PointLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+  registry.on_destroy<PointLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+
+  registry.on_construct<SpotLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+  registry.on_update<SpotLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+  registry.on_destroy<SpotLight>().connect<&SceneChangeTracker::onLightChanged_>(*this);
+
+  // lights take their position and direction from the world matrix
+  registry.on_construct<WorldMatrix>().connect<&SceneChangeTracker::onLightMoved_>(*this);
+  registry.on_update<WorldMatrix>().connect<&SceneChangeTracker::onLightMoved_>(*this);
+  registry.on_destroy<WorldMatrix>().connect<&SceneChangeTracker::onLightMoved_>(*this);
+}
+
+void SceneChangeTracker::consume(std::vector<entt::entity>& outChanged, std::vector<entt::entity>& outMoved) {
+  outChanged.clear();
+  outMoved.clear();
+
+  // swap keeps the capacity of both sides, so no allocations in a steady state
+  m_changed_.swap(outChanged);
+  m_moved_.swap(outMoved);
+}
+
+void SceneChangeTracker::consumeLights(std::vector<entt::entity>& outChanged) {
+  outChanged.clear();
+
+  m_lights_.swap(outChanged);
+}
+
+void SceneChangeTracker::reset() {
+  m_changed_.clear();
+  m_moved_.clear();
+  m_lights_.clear();
+}
+
+void SceneChangeTracker::onChanged_(entt::registry& registry, entt::entity entity) {
+  m_changed_.push_back(entity);
+}
+
+void SceneChangeTracker::onMoved_(entt::registry& registry, entt::entity entity) {
+  m_moved_.push_back(entity);
+}
+
+void SceneChangeTracker::onLightChanged_(entt::registry& registry, entt::entity entity) {
+  m_lights_.push_back(entity);
+}
+
+void SceneChangeTracker::onLightMoved_(entt::registry& registry, entt::entity entity) {
+  // every moved entity passes here, only the (few) lights are recorded
+  if (!registry.all_of<Light>(entity)) {
+    return;
+  }
+
+  m_lights_.push_back(entity);
+}
+
+}  // namespace arise
@@ -0,0 +1,48 @@
+#ifndef ARISE_SCENE_CHANGE_TRACKER_H
+#define ARISE_SCENE_CHANGE_TRACKER_H
+
+#include <entt/entt.hpp>
+
+#include <vector>
+
+namespace arise {
+
+/**
+ * Records changes of renderable entities reported by registry signals, so the renderer can process only what changed
+ * since the previous frame instead of walking the whole scene.
+ *
+ * - changed: RenderModel* or WorldMatrix was added, replaced or removed (the entity may have become renderable or
+ *   stopped being one, the consumer checks the current registry state)
+ * - moved: WorldMatrix was recalculated (TransformSystem patches every matrix it updates)
+ * - lights: a light component (Light, DirectionalLight, PointLight, SpotLight) was added, replaced, patched or removed,
+ *   or the WorldMatrix of a light entity was added or recalculated (LightSystem consumes these)
+ *
+ * Not thread safe: the tracked components are only changed on the main thread (asset load callbacks are dispatched
+ * there, TransformSystem patches after its jobs are done).
+ */
+class SceneChangeTracker {
+  public:
+  void connect(entt::registry& registry);
+
+  // Moves the changes recorded since the previous call to the output vectors, entities may repeat
+  void consume(std::vector<entt::entity>& outChanged, std::vector<entt::entity>& outMoved);
+
+  // Moves the light changes recorded since the previous call to the output vector, entities may repeat
+  void consumeLights(std::vector<entt::entity>& outChanged);
+
+  void reset();
+
+  private:
+  void onChanged_(entt::registry& registry, entt::entity entity);
+  void onMoved_(entt::registry& registry, entt::entity entity);
+  void onLightChanged_(entt::registry& registry, entt::entity entity);
+  void onLightMoved_(entt::registry& registry, entt::entity entity);
+
+  std::vector<entt::entity> m_changed_;
+  std::vector<entt::entity> m_moved_;
+  std::vector<entt::entity> m_lights_;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_SCENE_CHANGE_TRACKER_H
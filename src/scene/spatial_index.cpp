@@ -0,0 +1,91 @@
+#include "scene/spatial_index.h"
+
+namespace arise {
+
+void SpatialIndex::update(entt::entity entity, const BoundingBox& worldBounds) {
+  auto it = m_proxies_.find(entity);
+  if (it == m_proxies_.end()) {
+    int32_t proxyId = m_tree_.createProxy(worldBounds, static_cast<uint32_t>(entt::to_integral(entity)));
+    m_proxies_.emplace(entity, proxyId);
+    return;
+  }
+
+  m_tree_.moveProxy(it->second, worldBounds);
+}
+
+void SpatialIndex::remove(entt::entity entity) {
+  auto it = m_proxies_.find(entity);
+  if (it == m_proxies_.end()) {
+    return;
+  }
+
+  m_tree_.destroyProxy(it->second);
+  m_proxies_.erase(it);
+}
+
+void SpatialIndex::clear() {
+  m_tree_.clear();
+  m_proxies_.clear();
+}
+
+void SpatialIndex::queryOverlap(const BoundingBox& box, std::vector<entt::entity>& outEntities) const {
+  outEntities.clear();
+  forEachOverlapping(box, [&outEntities](entt::entity entity) {
+    outEntities.push_back(entity);
+    return true;
+  });
+}
+
+void SpatialIndex::queryFrustum(const Frustum& frustum, std::vector<entt::entity>& outEntities) const {
+  outEntities.clear();
+  forEachInFrustum(frustum, [&outEntities](entt::entity entity) {
+    outEntities.push_back(entity);
+    return true;
+  });
+}
+
+void SpatialIndex::queryRay(const Ray& ray, float maxDistance, std::vector<entt::entity>& outEntities) const {
+  outEntities.clear();
+  m_tree_.raycast(ray, maxDistance, [&outEntities](const Ray&, float currentMaxDistance, uint32_t userData) {
+    outEntities.push_back(static_cast<entt::entity>(userData));
+    return currentMaxDistance;
+  });
+}
+
+bool SpatialIndex::raycast(const Ray&            ray,
+                           const entt::registry& registry,
+                           RaycastHit&           outHit,
+                           float                 maxDistance) const {
+  outHit = RaycastHit();
+
+  m_tree_.raycast(ray, maxDistance, [&](const Ray&, float currentMaxDistance, uint32_t userData) {
+    auto  entity      = static_cast<entt::entity>(userData);
+    auto* worldBounds = registry.try_get<WorldBounds>(entity);
+
+    float distance;
+    if (!worldBounds || !bounds::intersects(worldBounds->boundingBox, ray, currentMaxDistance, distance)) {
+      return currentMaxDistance;
+    }
+
+    outHit.entity   = entity;
+    outHit.distance = distance;
+    // everything further than this hit can be skipped, a hit at 0 (origin inside the box) ends the query
+    return distance;
+  });
+
+  return outHit.entity != entt::null;
+}
+
+void SpatialIndex::queryNearest(const math::Vector3f&      point,
+                                uint32_t                   count,
+                                std::vector<entt::entity>& outEntities) const {
+  outEntities.clear();
+  m_tree_.queryNearest(point, count, m_nearestResult_);
+
+  outEntities.reserve(m_nearestResult_.size());
+  for (const auto& [distance, userData] : m_nearestResult_) {
+    outEntities.push_back(static_cast<entt::entity>(userData));
+  }
+}
+
+}  // namespace arise
@@ -0,0 +1,77 @@
+#ifndef ARISE_SPATIAL_INDEX_H
+#define ARISE_SPATIAL_INDEX_H
+
+#include "ecs/components/bounding_volume.h"
+#include "utils/spatial/dynamic_aabb_tree.h"
+
+#include <entt/entt.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace arise {
+
+struct RaycastHit {
+  entt::entity entity   = entt::null;
+  float        distance = std::numeric_limits<float>::max();
+};
+
+/**
+ * Scene-level spatial index over WorldBounds, used for picking, editor selection and other scene queries.
+ *
+ * Kept up to date by BoundingVolumeSystem (only entities whose bounds changed are touched). Queries are conservative
+ * - they work with slightly enlarged boxes, so callers that need exact results should test WorldBounds themselves.
+ * Not thread safe: update and query from the main thread.
+ */
+class SpatialIndex {
+  public:
+  // Inserts the entity or updates its bounds
+  void update(entt::entity entity, const BoundingBox& worldBounds);
+
+  void remove(entt::entity entity);
+
+  void clear();
+
+  bool contains(entt::entity entity) const { return m_proxies_.find(entity) != m_proxies_.end(); }
+
+  uint32_t getEntityCount() const { return m_tree_.getProxyCount(); }
+
+  void queryOverlap(const BoundingBox& box, std::vector<entt::entity>& outEntities) const;
+
+  void queryFrustum(const Frustum& frustum, std::vector<entt::entity>& outEntities) const;
+
+  // Entities whose bounds are hit by the ray, not sorted
+  void queryRay(const Ray& ray, float maxDistance, std::vector<entt::entity>& outEntities) const;
+
+  // Closest hit of the ray against the exact world bounds of the entities
+  bool raycast(const Ray&            ray,
+               const entt::registry& registry,
+               RaycastHit&           outHit,
+               float                 maxDistance = std::numeric_limits<float>::max()) const;
+
+  // The count entities closest to the point, sorted from the nearest
+  void queryNearest(const math::Vector3f& point, uint32_t count, std::vector<entt::entity>& outEntities) const;
+
+  // callback(entt::entity) -> bool, returning false stops the query
+  template <typename Callback>
+  void forEachOverlapping(const BoundingBox& box, Callback&& callback) const {
+    m_tree_.queryOverlap(box, [&](uint32_t userData) { return callback(static_cast<entt::entity>(userData)); });
+  }
+
+  template <typename Callback>
+  void forEachInFrustum(const Frustum& frustum, Callback&& callback) const {
+    m_tree_.queryFrustum(frustum, [&](uint32_t userData) { return callback(static_cast<entt::entity>(userData)); });
+  }
+
+  private:
+  DynamicAabbTree                           m_tree_;
+  std::unordered_map<entt::entity, int32_t> m_proxies_;
+
+  mutable std::vector<std::pair<float, uint32_t>> m_nearestResult_;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_SPATIAL_INDEX_H
@@ -2,7 +2,10 @@
 #define ARISE_ASSET_LOADER_H
 
 #include "profiler/profiler.h"
+#include "utils/image/image_manager.h"
+#include "utils/job/job_system.h"
 #include "utils/logger/global_logger.h"
+#include "utils/material/material_loader_manager.h"
 #include "utils/model/render_model_manager.h"
 #include "utils/service/service_locator.h"
 #include "utils/texture/texture_manager.h"
@@ -10,13 +13,11 @@
 #include <atomic>
 #include <condition_variable>
 #include <functional>
-#include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
-#include <thread>
 #include <unordered_map>
-#include <variant>
+#include <vector>
 
 namespace arise {
 
@@ -29,15 +30,20 @@ enum class AssetType {
 };
 
 /**
- * Class handling asynchronous loading of assets
+ * Class handling asynchronous loading of assets on the job system.
+ *
+ * Models are loaded in two stages: the first stage finds the images referenced by the model materials and schedules
+ * one decode job per image, the second stage (creating the render model) depends on all of those jobs.
+ *
+ * Load callbacks never run on the workers. Finished loads are queued and their callbacks are invoked by
+ * dispatchCompletedLoads() on the main thread at the start of the frame, so they can modify the registry.
  */
 class AssetLoader {
   public:
   using LoadCallback = std::function<void(bool success)>;
 
   AssetLoader()
-      : m_running(false)
-      , m_workerThread(nullptr) {
+      : m_running(false) {
     GlobalLogger::Log(LogLevel::Info, "AssetLoader created");
   }
 
@@ -48,32 +54,33 @@ class AssetLoader {
       return;
     }
 
-    m_running      = true;
-    m_workerThread = std::make_unique<std::thread>(&AssetLoader::workerFunction, this);
+    m_running = true;
 
     GlobalLogger::Log(LogLevel::Info, "AssetLoader initialized");
   }
 
+  /**
+   * Waits until all in-flight load jobs are finished.
+   */
   void shutdown() {
     if (!m_running) {
       return;
     }
 
-    {
-      std::lock_guard<std::mutex> lock(m_queueMutex);
-      m_running = false;
-      m_condVar.notify_one();
-    }
+    m_running = false;
 
-    if (m_workerThread && m_workerThread->joinable()) {
-      m_workerThread->join();
-      m_workerThread.reset();
+    {
+      std::unique_lock<std::mutex> lock(m_queueMutex);
+      m_condVar.wait(lock, [this] { return m_activeJobCount == 0; });
+      m_completedLoads.clear();
     }
 
     GlobalLogger::Log(LogLevel::Info, "AssetLoader shutdown");
   }
 
-  void loadModel(const std::filesystem::path& filepath, LoadCallback callback = nullptr) {
+  void loadModel(const std::filesystem::path& filepath,
+                 LoadCallback                 callback = nullptr,
+                 JobPriority                  priority = JobPriority::Normal) {
     CPU_ZONE_NC("Load Model", color::BROWN);
     if (!m_running) {
       GlobalLogger::Log(LogLevel::Warning, "AssetLoader not running, initializing now");
@@ -104,24 +111,26 @@ class AssetLoader {
         }
       }
 
-      AssetRequest request;
-      request.type = AssetType::Model;
-      request.path = filepath;
-
       m_pendingAssets[assetKey] = true;
 
       if (callback) {
         m_pendingCallbacks[assetKey].push_back(callback);
       }
+    }
 
-      m_requestQueue.push(request);
-      m_condVar.notify_one();
+    AssetRequest request;
+    request.type     = AssetType::Model;
+    request.path     = filepath;
+    request.priority = priority;
 
-      GlobalLogger::Log(LogLevel::Info, "Queued asset for loading: " + filepath.string());
-    }
+    submitJob_([this, request]() { scheduleModelStages_(request); }, priority);
+
+    GlobalLogger::Log(LogLevel::Info, "Queued asset for loading: " + filepath.string());
   }
 
-  void loadTexture(const std::filesystem::path& filepath, LoadCallback callback = nullptr) {
+  void loadTexture(const std::filesystem::path& filepath,
+                   LoadCallback                 callback = nullptr,
+                   JobPriority                  priority = JobPriority::Normal) {
     if (!m_running) {
       GlobalLogger::Log(LogLevel::Warning, "AssetLoader not running, initializing now");
       initialize();
@@ -151,20 +160,43 @@ class AssetLoader {
         }
       }
 
-      AssetRequest request;
-      request.type = AssetType::Texture;
-      request.path = filepath;
-
       m_pendingAssets[assetKey] = true;
 
       if (callback) {
         m_pendingCallbacks[assetKey].push_back(callback);
       }
+    }
+
+    AssetRequest request;
+    request.type     = AssetType::Texture;
+    request.path     = filepath;
+    request.priority = priority;
+
+    submitJob_([this, request]() { processRequest(request); }, priority);
+
+    GlobalLogger::Log(LogLevel::Info, "Queued asset for loading: " + filepath.string());
+  }
 
-      m_requestQueue.push(request);
-      m_condVar.notify_one();
+  /**
+   * Invokes the callbacks of the loads finished since the last call. Must be called on the main thread.
+   */
+  void dispatchCompletedLoads() {
+    std::vector<CompletedLoad> completedLoads;
 
-      GlobalLogger::Log(LogLevel::Info, "Queued asset for loading: " + filepath.string());
+    {
+      std::lock_guard<std::mutex> lock(m_queueMutex);
+      completedLoads.swap(m_completedLoads);
+    }
+
+    if (completedLoads.empty()) {
+      return;
+    }
+
+    CPU_ZONE_NC("Dispatch Completed Loads", color::BROWN);
+    for (const auto& completedLoad : completedLoads) {
+      for (const auto& callback : completedLoad.callbacks) {
+        callback(completedLoad.success);
+      }
     }
   }
 
@@ -194,49 +226,87 @@ class AssetLoader {
 
   size_t getPendingAssetCount() const {
     std::lock_guard<std::mutex> lock(m_queueMutex);
-    return m_requestQueue.size();
+    return m_pendingAssets.size();
   }
 
   private:
   struct AssetRequest {
     AssetType             type;
     std::filesystem::path path;
+    JobPriority           priority = JobPriority::Normal;
   };
 
-  void workerFunction() {
-    while (m_running) {
-      AssetRequest request;
-      bool         hasRequest = false;
+  struct CompletedLoad {
+    std::vector<LoadCallback> callbacks;
+    bool                      success = false;
+  };
 
-      {
-        std::unique_lock<std::mutex> lock(m_queueMutex);
-        m_condVar.wait(lock, [this] { return !m_running || !m_requestQueue.empty(); });
+  // Submits a job that is tracked by shutdown(). Falls back to the calling thread without a job system.
+  void submitJob_(std::function<void()> function, JobPriority priority, const std::vector<JobHandle>& dependencies = {}) {
+    {
+      std::lock_guard<std::mutex> lock(m_queueMutex);
+      ++m_activeJobCount;
+    }
 
-        if (!m_running) {
-          break;
-        }
+    auto trackedFunction = [this, function = std::move(function)]() {
+      function();
 
-        if (!m_requestQueue.empty()) {
-          request = m_requestQueue.front();
-          m_requestQueue.pop();
-          hasRequest = true;
-        }
+      std::lock_guard<std::mutex> lock(m_queueMutex);
+      if (--m_activeJobCount == 0) {
+        m_condVar.notify_all();
       }
+    };
+
+    auto jobSystem = ServiceLocator::s_get<JobSystem>();
+    if (!jobSystem) {
+      GlobalLogger::Log(LogLevel::Warning, "JobSystem not available, loading asset on the calling thread");
+      trackedFunction();
+      return;
+    }
+
+    jobSystem->submit(std::move(trackedFunction), priority, dependencies);
+  }
 
-      if (hasRequest) {
-        processRequest(request);
+  bool isRequestPending_(const AssetRequest& request) const {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return m_pendingAssets.find(createAssetKey(request.type, request.path.string())) != m_pendingAssets.end();
+  }
+
+  // First model stage: decode referenced images in parallel, then create the render model once all of them are done
+  void scheduleModelStages_(const AssetRequest& request) {
+    std::vector<JobHandle>      imageJobs;
+    std::shared_ptr<const void> sourceHandle;
+
+    auto jobSystem             = ServiceLocator::s_get<JobSystem>();
+    auto materialLoaderManager = ServiceLocator::s_get<MaterialLoaderManager>();
+    auto imageManager          = ServiceLocator::s_get<ImageManager>();
+
+    if (jobSystem && materialLoaderManager && imageManager && isRequestPending_(request)) {
+      auto imagePaths = materialLoaderManager->getImagePaths(request.path, &sourceHandle);
+      for (const auto& imagePath : imagePaths) {
+        if (imageManager->hasImage(imagePath)) {
+          continue;
+        }
+        imageJobs.push_back(
+            jobSystem->submit([imageManager, imagePath]() { imageManager->getImage(imagePath); }, request.priority));
       }
     }
+
+    // sourceHandle keeps the parsed file cached until the model is created, so it's not parsed twice
+    submitJob_(
+        [this, request, sourceHandle = std::move(sourceHandle)]() mutable {
+          processRequest(request);
+          sourceHandle.reset();
+        },
+        request.priority,
+        imageJobs);
   }
 
   void processRequest(const AssetRequest& request) {
     std::string assetKey = createAssetKey(request.type, request.path.string());
 
-    {
-      std::lock_guard<std::mutex> lock(m_queueMutex);
-      if (m_pendingAssets.find(assetKey) == m_pendingAssets.end()) {
-        return;
-      }
+    if (!isRequestPending_(request)) {
+      return;
     }
 
     bool success = false;
@@ -253,23 +323,16 @@ class AssetLoader {
         break;
     }
 
-    std::vector<LoadCallback> callbacks;
-
-    {
-      std::lock_guard<std::mutex> lock(m_queueMutex);
-
-      auto callbackIt = m_pendingCallbacks.find(assetKey);
-      if (callbackIt != m_pendingCallbacks.end()) {
-        callbacks = std::move(callbackIt->second);
-        m_pendingCallbacks.erase(callbackIt);
-      }
+    // callbacks are invoked on the main thread (dispatchCompletedLoads)
+    std::lock_guard<std::mutex> lock(m_queueMutex);
 
-      m_pendingAssets.erase(assetKey);
+    auto callbackIt = m_pendingCallbacks.find(assetKey);
+    if (callbackIt != m_pendingCallbacks.end()) {
+      m_completedLoads.push_back({std::move(callbackIt->second), success});
+      m_pendingCallbacks.erase(callbackIt);
     }
 
-    for (const auto& callback : callbacks) {
-      callback(success);
-    }
+    m_pendingAssets.erase(assetKey);
   }
 
   bool loadModelInternal_(const std::filesystem::path& filepath) {
@@ -320,15 +383,15 @@ class AssetLoader {
     return std::to_string(static_cast<int>(type)) + ":" + path;
   }
 
-  std::atomic<bool>            m_running;
-  std::unique_ptr<std::thread> m_workerThread;
+  std::atomic<bool> m_running;
 
-  mutable std::mutex       m_queueMutex;
-  std::condition_variable  m_condVar;
-  std::queue<AssetRequest> m_requestQueue;
+  mutable std::mutex      m_queueMutex;
+  std::condition_variable m_condVar;
+  uint32_t                m_activeJobCount = 0;
 
   std::unordered_map<std::string, bool>                      m_pendingAssets;
   std::unordered_map<std::string, std::vector<LoadCallback>> m_pendingCallbacks;
+  std::vector<CompletedLoad>                                 m_completedLoads;
 };
 
 }  // namespace arise
@@ -0,0 +1,236 @@
+#include "utils/asset/derived_data_cache.h"
+
+#include "utils/logger/global_logger.h"
+#include "utils/memory/mapped_file.h"
+
+#include <xxhash.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace arise {
+
+namespace {
+
+constexpr size_t HASH_CHUNK_SIZE = 4 * 1024 * 1024;
+
+constexpr const char* SOURCE_HASHES_FILE_NAME = "source_hashes.bin";
+constexpr const char* ENTRY_EXTENSION         = ".ddc";
+
+constexpr uint32_t SOURCE_HASHES_MAGIC   = 0x48534441;  // "ADSH"
+constexpr uint32_t SOURCE_HASHES_VERSION = 1;
+
+}  // namespace
+
+DerivedDataCache::DerivedDataCache(std::filesystem::path rootPath)
+    : m_rootPath(std::move(rootPath)) {
+  std::error_code error;
+  std::filesystem::create_directories(m_rootPath, error);
+  if (error) {
+    GlobalLogger::Log(LogLevel::Warning,
+                      "Failed to create derived data cache directory " + m_rootPath.string() + ": " + error.message());
+  }
+
+  loadSourceHashes_();
+}
+
+DerivedDataCache::~DerivedDataCache() {
+  saveSourceHashes();
+}
+
+std::optional<uint64_t> DerivedDataCache::makeKey(const std::filesystem::path&           sourcePath,
+                                                  std::string_view                       kind,
+                                                  uint64_t                               importerVersion,
+                                                  std::span<const std::filesystem::path> dependencies) {
+  auto sourceHash = getSourceHash(sourcePath);
+  if (!sourceHash) {
+    return std::nullopt;
+  }
+
+  DerivedDataWriter keyData;
+  keyData.write(*sourceHash);
+  keyData.write(importerVersion);
+  keyData.writeString(kind);
+
+  // the import of a missing dependency fails or differs, so it gets a key of its own that a restored file replaces
+  for (const auto& dependency : dependencies) {
+    auto dependencyHash = getSourceHash(dependency);
+    keyData.write(static_cast<uint8_t>(dependencyHash.has_value()));
+    keyData.write(dependencyHash.value_or(0));
+  }
+
+  return ::XXH64(keyData.getData().data(), keyData.getData().size(), 0);
+}
+
+std::optional<uint64_t> DerivedDataCache::getSourceHash(const std::filesystem::path& sourcePath) {
+  std::error_code error;
+  auto            size = std::filesystem::file_size(sourcePath, error);
+  if (error) {
+    return std::nullopt;
+  }
+  auto writeTime = std::filesystem::last_write_time(sourcePath, error);
+  if (error) {
+    return std::nullopt;
+  }
+
+  const auto key              = std::filesystem::absolute(sourcePath, error).lexically_normal().generic_string();
+  const auto modificationTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto                        it = m_sourceHashes.find(key);
+    if (it != m_sourceHashes.end() && it->second.size == size && it->second.modificationTime == modificationTime) {
+      return it->second.hash;
+    }
+  }
+
+  // hashed outside of the lock, sources can be big
+  auto hash = s_hashFile(sourcePath);
+  if (!hash) {
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_sourceHashes[key] = SourceHash{size, modificationTime, *hash};
+  m_sourceHashesDirty = true;
+  return hash;
+}
+
+std::filesystem::path DerivedDataCache::getEntryPath(uint64_t key) const {
+  char name[17];
+  std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+
+  // fanned out by the first byte, so a directory doesn't end up with every entry
+  return m_rootPath / std::string(name, 2) / (std::string(name) + ENTRY_EXTENSION);
+}
+
+bool DerivedDataCache::hasEntry(uint64_t key) const {
+  std::error_code error;
+  return std::filesystem::is_regular_file(getEntryPath(key), error);
+}
+
+std::shared_ptr<const MappedFile> DerivedDataCache::load(uint64_t key) const {
+  // checked first, MappedFile reports a missing file as an error and a miss is expected
+  if (!hasEntry(key)) {
+    return nullptr;
+  }
+  return MappedFile::s_open(getEntryPath(key));
+}
+
+bool DerivedDataCache::store(uint64_t key, const std::vector<std::byte>& data) {
+  const auto entryPath = getEntryPath(key);
+
+  std::error_code error;
+  std::filesystem::create_directories(entryPath.parent_path(), error);
+  if (error) {
+    GlobalLogger::Log(LogLevel::Warning,
+                      "Failed to create derived data directory " + entryPath.parent_path().string() + ": "
+                          + error.message());
+    return false;
+  }
+
+  // written next to the entry and renamed, so a reader never maps a partial entry
+  auto temporaryPath = entryPath;
+  temporaryPath += ".tmp" + std::to_string(m_temporaryFileCounter.fetch_add(1, std::memory_order_relaxed));
+  {
+    std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+      GlobalLogger::Log(LogLevel::Warning, "Failed to write derived data: " + temporaryPath.string());
+      file.close();
+      std::filesystem::remove(temporaryPath, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temporaryPath, entryPath, error);
+  if (error) {
+    std::filesystem::remove(temporaryPath, error);
+    // another thread or process may have stored the same entry meanwhile, the content is the same
+    return hasEntry(key);
+  }
+
+  return true;
+}
+
+void DerivedDataCache::saveSourceHashes() {
+  DerivedDataWriter writer;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_sourceHashesDirty) {
+      return;
+    }
+
+    writer.write(SOURCE_HASHES_MAGIC);
+    writer.write(SOURCE_HASHES_VERSION);
+    writer.write(static_cast<uint32_t>(m_sourceHashes.size()));
+    for (const auto& [path, sourceHash] : m_sourceHashes) {
+      writer.writeString(path);
+      writer.write(sourceHash);
+    }
+    m_sourceHashesDirty = false;
+  }
+
+  const auto    path = m_rootPath / SOURCE_HASHES_FILE_NAME;
+  std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  const auto&   data = writer.getData();
+  if (!file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+    GlobalLogger::Log(LogLevel::Warning, "Failed to save source hashes: " + path.string());
+  }
+}
+
+std::optional<uint64_t> DerivedDataCache::s_hashFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+
+  // streamed, so big binaries aren't read into memory at once
+  XXH64_state_t* state = XXH64_createState();
+  XXH64_reset(state, 0);
+
+  std::vector<char> chunk(HASH_CHUNK_SIZE);
+  while (file) {
+    file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    XXH64_update(state, chunk.data(), static_cast<size_t>(file.gcount()));
+  }
+
+  const uint64_t hash = XXH64_digest(state);
+  XXH64_freeState(state);
+  return hash;
+}
+
+void DerivedDataCache::loadSourceHashes_() {
+  std::ifstream file(m_rootPath / SOURCE_HASHES_FILE_NAME, std::ios::in | std::ios::binary);
+  if (!file) {
+    return;
+  }
+
+  std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  DerivedDataReader reader(reinterpret_cast<const std::byte*>(data.data()), data.size());
+  uint32_t          magic   = 0;
+  uint32_t          version = 0;
+  uint32_t          count   = 0;
+  if (!reader.read(magic) || !reader.read(version) || !reader.read(count) || magic != SOURCE_HASHES_MAGIC
+      || version != SOURCE_HASHES_VERSION) {
+    return;
+  }
+
+  std::unordered_map<std::string, SourceHash> sourceHashes;
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string path;
+    SourceHash  sourceHash{};
+    if (!reader.readString(path) || !reader.read(sourceHash)) {
+      // a damaged index only costs hashing the sources again
+      GlobalLogger::Log(LogLevel::Warning, "Ignoring damaged derived data source hashes");
+      return;
+    }
+    sourceHashes.emplace(std::move(path), sourceHash);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_sourceHashes = std::move(sourceHashes);
+}
+
+}  // namespace arise
@@ -0,0 +1,179 @@
+#ifndef ARISE_DERIVED_DATA_CACHE_H
+#define ARISE_DERIVED_DATA_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace arise {
+
+class MappedFile;
+
+/**
+ * Persistent cache of imported assets (cooked meshes, materials, decoded images), so an unchanged source is imported
+ * once and every later launch loads the import result.
+ *
+ * Entries are content addressed: the key is a hash of the source bytes, the other files the importer reads, the kind
+ * of the derived data and the version / settings of the importer. A changed source or importer produces a new key, so
+ * an entry is never invalidated - stale entries are just not used anymore (delete the directory to reclaim the space).
+ *
+ * Hashing the sources would read all of them on every launch, so the hashes are remembered together with the size and
+ * the modification time of the source and only recomputed when either changes.
+ *
+ * Thread-safe, importers run on the job system.
+ */
+class DerivedDataCache {
+  public:
+  explicit DerivedDataCache(std::filesystem::path rootPath);
+
+  // Saves the source hashes
+  ~DerivedDataCache();
+
+  /**
+   * @param kind kind of the derived data, e.g. "model" - different kinds of the same source get different keys
+   * @param importerVersion version and settings of the importer, change it whenever the import result changes
+   * @param dependencies other files the import reads, hashed like the source (a missing one is hashed as missing)
+   * @return nullopt if the source can't be read
+   */
+  std::optional<uint64_t> makeKey(const std::filesystem::path&           sourcePath,
+                                  std::string_view                       kind,
+                                  uint64_t                               importerVersion,
+                                  std::span<const std::filesystem::path> dependencies = {});
+
+  // XXH64 of the source bytes, cached by path, size and modification time
+  std::optional<uint64_t> getSourceHash(const std::filesystem::path& sourcePath);
+
+  // Where the entry is (or would be) stored - cooked mesh files are written there directly
+  std::filesystem::path getEntryPath(uint64_t key) const;
+
+  bool hasEntry(uint64_t key) const;
+
+  // Maps the entry, nullptr on a miss
+  std::shared_ptr<const MappedFile> load(uint64_t key) const;
+
+  // Writes the entry atomically (a reader never sees a partial entry)
+  bool store(uint64_t key, const std::vector<std::byte>& data);
+
+  // Writes the source hashes, so the next launch doesn't hash the sources again
+  void saveSourceHashes();
+
+  // XXH64 of the file bytes, streamed
+  static std::optional<uint64_t> s_hashFile(const std::filesystem::path& path);
+
+  private:
+  struct SourceHash {
+    uint64_t size;
+    int64_t  modificationTime;
+    uint64_t hash;
+  };
+
+  void loadSourceHashes_();
+
+  std::filesystem::path m_rootPath;
+
+  std::unordered_map<std::string, SourceHash> m_sourceHashes;
+  bool                                        m_sourceHashesDirty = false;
+  std::mutex                                  m_mutex;
+
+  // distinguishes the temporary files of concurrent stores
+  std::atomic<uint32_t> m_temporaryFileCounter{0};
+};
+
+/**
+ * Serializes derived data into a flat byte buffer. Values are trivially copyable types written as they are in memory -
+ * the cache is local to the machine, so there are no endianness concerns.
+ */
+class DerivedDataWriter {
+  public:
+  template <typename T>
+  void write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written");
+    writeBytes(&value, sizeof(T));
+  }
+
+  void writeString(std::string_view string) {
+    write(static_cast<uint32_t>(string.size()));
+    writeBytes(string.data(), string.size());
+  }
+
+  void writeBytes(const void* data, size_t size) {
+    auto offset = m_data.size();
+    m_data.resize(offset + size);
+    if (size > 0) {
+      std::memcpy(m_data.data() + offset, data, size);
+    }
+  }
+
+  const std::vector<std::byte>& getData() const { return m_data; }
+
+  private:
+  std::vector<std::byte> m_data;
+};
+
+/**
+ * Reads what DerivedDataWriter wrote. Every read is bounds checked, a failed read marks the reader as failed (a
+ * truncated or corrupted entry is treated as a cache miss).
+ */
+class DerivedDataReader {
+  public:
+  DerivedDataReader(const std::byte* data, size_t size)
+      : m_data(data)
+      , m_size(size) {}
+
+  template <typename T>
+  bool read(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read");
+    return readBytes(&value, sizeof(T));
+  }
+
+  bool readString(std::string& string) {
+    uint32_t size = 0;
+    if (!read(size) || !canRead_(size)) {
+      m_failed = true;
+      return false;
+    }
+    string.assign(reinterpret_cast<const char*>(m_data + m_offset), size);
+    m_offset += size;
+    return true;
+  }
+
+  bool readBytes(void* data, size_t size) {
+    if (!canRead_(size)) {
+      m_failed = true;
+      return false;
+    }
+    if (size > 0) {
+      std::memcpy(data, m_data + m_offset, size);
+    }
+    m_offset += size;
+    return true;
+  }
+
+  // True when all reads succeeded and the whole entry was consumed
+  bool isComplete() const { return !m_failed && m_offset == m_size; }
+
+  bool hasFailed() const { return m_failed; }
+
+  private:
+  bool canRead_(size_t size) const { return !m_failed && size <= m_size - m_offset; }
+
+  const std::byte* m_data;
+  size_t           m_size;
+  size_t           m_offset = 0;
+  bool             m_failed = false;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_DERIVED_DATA_CACHE_H
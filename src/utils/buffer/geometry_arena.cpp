@@ -0,0 +1,519 @@
+#include "utils/buffer/geometry_arena.h"
+
+#include "gfx/rhi/interface/command_buffer.h"
+#include "gfx/rhi/interface/device.h"
+#include "gfx/rhi/interface/synchronization.h"
+#include "profiler/profiler.h"
+#include "utils/logger/global_logger.h"
+#include "utils/resource/resource_deletion_manager.h"
+#include "utils/service/service_locator.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace arise {
+
+namespace {
+
+constexpr uint32_t INITIAL_VERTEX_CAPACITY = 1u << 20;
+constexpr uint32_t INITIAL_INDEX_CAPACITY  = 1u << 22;
+
+constexpr uint32_t DEFAULT_VERTEX_COLOR = 0xFFFFFFFF;  // opaque white, rgba8
+
+constexpr const char* VERTEX_STREAM_DEBUG_NAMES[VERTEX_STREAM_COUNT] = {
+  "geometry_arena_position_buffer",
+  "geometry_arena_attribute_buffer",
+  "geometry_arena_color_buffer",
+};
+
+// packing only pays off once the holes add up to a noticeable part of the buffer
+constexpr uint32_t DEFRAGMENT_MIN_FREE_RANGES    = 2;
+constexpr float    DEFRAGMENT_FRAGMENTED_PERCENT = 0.25f;
+
+bool isFragmented(const OffsetAllocator& allocator) {
+  if (allocator.getFreeRangeCount() < DEFRAGMENT_MIN_FREE_RANGES) {
+    return false;
+  }
+
+  const uint32_t freeSize = allocator.getFreeSize();
+  return freeSize > 0
+      && static_cast<float>(freeSize - allocator.getLargestFreeRange())
+             > static_cast<float>(freeSize) * DEFRAGMENT_FRAGMENTED_PERCENT;
+}
+
+}  // namespace
+
+GeometryArena::GeometryArena(gfx::rhi::Device* device, bool storeVertexColors)
+    : m_device(device)
+    , m_storeVertexColors(storeVertexColors) {
+}
+
+GeometryArena::~GeometryArena() {
+  release();
+}
+
+bool GeometryArena::allocate(RenderGeometryMesh* mesh, const Mesh& sourceMesh) {
+  // the mapped streams of a cooked mesh are uploaded straight from the file
+  if (sourceMesh.mappedFile) {
+    return allocate_(
+        mesh, sourceMesh.mappedVertexStreams, sourceMesh.getIndices(), sourceMesh.lods, sourceMesh.getLodIndices());
+  }
+
+  const auto packedVertices = g_packVertices(sourceMesh.getVertices(), m_storeVertexColors);
+  return allocate_(
+      mesh, packedVertices.getStreams(), sourceMesh.getIndices(), sourceMesh.lods, sourceMesh.getLodIndices());
+}
+
+bool GeometryArena::allocate_(RenderGeometryMesh*       mesh,
+                              PackedVertexStreams       vertices,
+                              std::span<const uint32_t> indices,
+                              std::span<const MeshLod>  lods,
+                              std::span<const uint32_t> lodIndices) {
+  if (!m_device) {
+    GlobalLogger::Log(LogLevel::Error, "Cannot allocate mesh geometry, device is null");
+    return false;
+  }
+
+  const auto vertexCount = static_cast<uint32_t>(vertices.positions.size());
+  const auto indexCount  = static_cast<uint32_t>(indices.size());
+
+  const bool hasAllStreams = vertices.attributes.size() == vertexCount
+                          && (!m_storeVertexColors || vertices.colors.size() == vertexCount);
+  if (!mesh || vertexCount == 0 || indexCount == 0 || !hasAllStreams) {
+    GlobalLogger::Log(LogLevel::Error, "Invalid mesh geometry parameters");
+    return false;
+  }
+
+  // the levels are drawn with the vertices of the full mesh, so only their index ranges have to be checked
+  const bool hasValidLods = std::all_of(lods.begin(), lods.end(), [&lodIndices](const MeshLod& lod) {
+    return lod.indexCount > 0 && static_cast<size_t>(lod.firstIndex) + lod.indexCount <= lodIndices.size();
+  });
+  if (!hasValidLods) {
+    GlobalLogger::Log(LogLevel::Warning, "Mesh LODs point outside of their indices, only the full mesh is stored");
+    lods = {};
+  }
+
+  // the part of the LOD indices the levels use (RenderGeometryMesh::getTotalIndexCount())
+  uint32_t lodIndexCount = 0;
+  for (const auto& lod : lods) {
+    lodIndexCount = std::max(lodIndexCount, lod.firstIndex + lod.indexCount);
+  }
+  lodIndices = lodIndices.first(lodIndexCount);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  const bool isPending = std::any_of(m_pendingMeshes.begin(),
+                                     m_pendingMeshes.end(),
+                                     [mesh](const PendingMesh& pendingMesh) { return pendingMesh.mesh == mesh; });
+  if (m_meshes.contains(mesh) || isPending) {
+    GlobalLogger::Log(LogLevel::Warning, "Mesh geometry is already allocated in the arena");
+    return false;
+  }
+
+  if (!m_indexBuffer && !createBuffers_(vertexCount, indexCount + lodIndexCount)) {
+    return false;
+  }
+
+  if (fits_(vertexCount, indexCount + lodIndexCount)) {
+    place_(mesh, vertices, indices, lodIndices, lods);
+    return true;
+  }
+
+  // growing replaces the buffers other threads record draws from, it is left to update() on the main thread
+  mesh->vertexBuffers = {};
+  mesh->indexBuffer   = nullptr;
+
+  PendingMesh pendingMesh;
+  pendingMesh.mesh = mesh;
+  pendingMesh.vertices.positions.assign(vertices.positions.begin(), vertices.positions.end());
+  pendingMesh.vertices.attributes.assign(vertices.attributes.begin(), vertices.attributes.end());
+  if (m_storeVertexColors) {
+    pendingMesh.vertices.colors.assign(vertices.colors.begin(), vertices.colors.end());
+  }
+  pendingMesh.indices.assign(indices.begin(), indices.end());
+  pendingMesh.lodIndices.assign(lodIndices.begin(), lodIndices.end());
+  pendingMesh.lods.assign(lods.begin(), lods.end());
+  m_pendingMeshes.push_back(std::move(pendingMesh));
+  return true;
+}
+
+void GeometryArena::free(RenderGeometryMesh* mesh) {
+  if (!mesh) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto pendingIt = std::find_if(m_pendingMeshes.begin(), m_pendingMeshes.end(), [mesh](const PendingMesh& pendingMesh) {
+    return pendingMesh.mesh == mesh;
+  });
+  if (pendingIt != m_pendingMeshes.end()) {
+    m_pendingMeshes.erase(pendingIt);
+    return;
+  }
+
+  if (m_meshes.erase(mesh) == 0) {
+    GlobalLogger::Log(LogLevel::Warning, "Mesh geometry is not allocated in the arena");
+    return;
+  }
+
+  m_vertexAllocator.free(mesh->vertexOffset);
+  m_indexAllocator.free(mesh->firstIndex);
+
+  mesh->vertexBuffers = {};
+  mesh->indexBuffer   = nullptr;
+  mesh->vertexCount   = 0;
+  mesh->indexCount    = 0;
+  mesh->lods.clear();
+}
+
+void GeometryArena::update() {
+  CPU_ZONE_NC("GeometryArena::update", color::ORANGE);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (!m_pendingMeshes.empty()) {
+    placePendingMeshes_();
+    return;
+  }
+
+  if (!m_indexBuffer || (!isFragmented(m_vertexAllocator) && !isFragmented(m_indexAllocator))) {
+    return;
+  }
+
+  GlobalLogger::Log(LogLevel::Info,
+                    "Defragmenting geometry arena: " + std::to_string(m_vertexAllocator.getFreeRangeCount())
+                        + " vertex and " + std::to_string(m_indexAllocator.getFreeRangeCount()) + " index free ranges");
+
+  reallocate_(m_vertexAllocator.getCapacity(), m_indexAllocator.getCapacity(), true);
+}
+
+gfx::rhi::Buffer* GeometryArena::getVertexBuffer(VertexStream stream) const {
+  if (stream == VertexStream::Color && !m_storeVertexColors) {
+    return m_defaultColorBuffer.get();
+  }
+  return m_vertexBuffers[static_cast<size_t>(stream)].get();
+}
+
+void GeometryArena::release() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  for (auto* mesh : m_meshes) {
+    mesh->vertexBuffers = {};
+    mesh->indexBuffer   = nullptr;
+  }
+  m_meshes.clear();
+  m_pendingMeshes.clear();
+
+  for (auto& vertexBuffer : m_vertexBuffers) {
+    vertexBuffer.reset();
+  }
+  m_indexBuffer.reset();
+  m_defaultColorBuffer.reset();
+  m_vertexAllocator.reset(0);
+  m_indexAllocator.reset(0);
+}
+
+bool GeometryArena::createBuffers_(uint32_t vertexCount, uint32_t indexCount) {
+  const uint32_t vertexCapacity = std::max(INITIAL_VERTEX_CAPACITY, vertexCount);
+  const uint32_t indexCapacity  = std::max(INITIAL_INDEX_CAPACITY, indexCount);
+
+  std::array<std::unique_ptr<gfx::rhi::Buffer>, VERTEX_STREAM_COUNT> vertexBuffers;
+
+  auto indexBuffer = createBuffer_(indexCapacity, sizeof(uint32_t), true, "geometry_arena_index_buffer");
+  if (!createVertexBuffers_(vertexCapacity, vertexBuffers) || !indexBuffer) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create geometry arena buffers");
+    return false;
+  }
+
+  if (!m_storeVertexColors) {
+    // stride 0, so dx12 reads the same element for every vertex (vulkan takes the stride from the pipeline)
+    gfx::rhi::BufferDesc bufferDesc;
+    bufferDesc.size        = sizeof(DEFAULT_VERTEX_COLOR);
+    bufferDesc.type        = gfx::rhi::BufferType::Static;
+    bufferDesc.createFlags = gfx::rhi::BufferCreateFlag::VertexBuffer;
+    bufferDesc.stride      = 0;
+    bufferDesc.debugName   = "geometry_arena_default_color_buffer";
+
+    m_defaultColorBuffer = m_device->createBuffer(bufferDesc);
+    if (!m_defaultColorBuffer) {
+      GlobalLogger::Log(LogLevel::Error, "Failed to create geometry arena default color buffer");
+      return false;
+    }
+    m_device->updateBuffer(m_defaultColorBuffer.get(), &DEFAULT_VERTEX_COLOR, sizeof(DEFAULT_VERTEX_COLOR));
+  }
+
+  m_vertexBuffers = std::move(vertexBuffers);
+  m_indexBuffer   = std::move(indexBuffer);
+
+  m_vertexAllocator.reset(vertexCapacity);
+  m_indexAllocator.reset(indexCapacity);
+  return true;
+}
+
+bool GeometryArena::fits_(uint32_t vertexCount, uint32_t indexCount) const {
+  return m_vertexAllocator.getLargestFreeRange() >= vertexCount && m_indexAllocator.getLargestFreeRange() >= indexCount;
+}
+
+void GeometryArena::place_(RenderGeometryMesh*       mesh,
+                           PackedVertexStreams       vertices,
+                           std::span<const uint32_t> indices,
+                           std::span<const uint32_t> lodIndices,
+                           std::span<const MeshLod>  lods) {
+  const auto vertexCount = static_cast<uint32_t>(vertices.positions.size());
+  const auto indexCount  = static_cast<uint32_t>(indices.size());
+
+  const uint32_t vertexOffset = m_vertexAllocator.allocate(vertexCount);
+  const uint32_t firstIndex   = m_indexAllocator.allocate(indexCount + static_cast<uint32_t>(lodIndices.size()));
+
+  const void* streamData[VERTEX_STREAM_COUNT]
+      = {vertices.positions.data(), vertices.attributes.data(), vertices.colors.data()};
+  for (size_t stream = 0; stream < VERTEX_STREAM_COUNT; ++stream) {
+    if (!m_vertexBuffers[stream]) {
+      continue;
+    }
+    const size_t stride = g_getVertexStreamStride(static_cast<VertexStream>(stream));
+    m_device->updateBuffer(m_vertexBuffers[stream].get(),
+                           streamData[stream],
+                           static_cast<size_t>(vertexCount) * stride,
+                           static_cast<size_t>(vertexOffset) * stride);
+  }
+  m_device->updateBuffer(m_indexBuffer.get(),
+                         indices.data(),
+                         static_cast<size_t>(indexCount) * sizeof(uint32_t),
+                         static_cast<size_t>(firstIndex) * sizeof(uint32_t));
+  if (!lodIndices.empty()) {
+    m_device->updateBuffer(m_indexBuffer.get(),
+                           lodIndices.data(),
+                           lodIndices.size() * sizeof(uint32_t),
+                           static_cast<size_t>(firstIndex + indexCount) * sizeof(uint32_t));
+  }
+
+  setMeshBuffers_(mesh);
+  mesh->vertexOffset = vertexOffset;
+  mesh->vertexCount  = vertexCount;
+  mesh->firstIndex   = firstIndex;
+  mesh->indexCount   = indexCount;
+
+  mesh->lods.clear();
+  for (const auto& lod : lods) {
+    mesh->lods.push_back({indexCount + lod.firstIndex, lod.indexCount});
+  }
+
+  m_meshes.insert(mesh);
+}
+
+void GeometryArena::placePendingMeshes_() {
+  // holes left by unloading may fit some of them already, the rest goes into the grown part
+  std::vector<PendingMesh> remainingMeshes;
+  uint64_t                 remainingVertexCount = 0;
+  uint64_t                 remainingIndexCount  = 0;
+  for (auto& pendingMesh : m_pendingMeshes) {
+    const auto vertexCount = static_cast<uint32_t>(pendingMesh.vertices.positions.size());
+    const auto indexCount  = static_cast<uint32_t>(pendingMesh.indices.size() + pendingMesh.lodIndices.size());
+    if (fits_(vertexCount, indexCount)) {
+      place_(pendingMesh.mesh,
+             pendingMesh.vertices.getStreams(),
+             pendingMesh.indices,
+             pendingMesh.lodIndices,
+             pendingMesh.lods);
+      continue;
+    }
+    remainingVertexCount += vertexCount;
+    remainingIndexCount  += indexCount;
+    remainingMeshes.push_back(std::move(pendingMesh));
+  }
+  m_pendingMeshes.clear();
+
+  if (remainingMeshes.empty()) {
+    return;
+  }
+
+  // grow geometrically, so loading many meshes doesn't copy the arena for each of them; the appended space alone
+  // has to fit the meshes
+  uint64_t vertexCapacity = m_vertexAllocator.getCapacity();
+  uint64_t indexCapacity  = m_indexAllocator.getCapacity();
+  while (vertexCapacity - m_vertexAllocator.getCapacity() < remainingVertexCount) {
+    vertexCapacity *= 2;
+  }
+  while (indexCapacity - m_indexAllocator.getCapacity() < remainingIndexCount) {
+    indexCapacity *= 2;
+  }
+
+  if (vertexCapacity > UINT32_MAX || indexCapacity > UINT32_MAX) {
+    GlobalLogger::Log(LogLevel::Error, "Geometry arena cannot grow past 32-bit offsets, meshes are not placed");
+    return;
+  }
+
+  GlobalLogger::Log(LogLevel::Info,
+                    "Growing geometry arena to " + std::to_string(vertexCapacity) + " vertices and "
+                        + std::to_string(indexCapacity) + " indices");
+
+  if (!reallocate_(static_cast<uint32_t>(vertexCapacity), static_cast<uint32_t>(indexCapacity), false)) {
+    return;
+  }
+
+  for (const auto& pendingMesh : remainingMeshes) {
+    place_(pendingMesh.mesh,
+           pendingMesh.vertices.getStreams(),
+           pendingMesh.indices,
+           pendingMesh.lodIndices,
+           pendingMesh.lods);
+  }
+}
+
+bool GeometryArena::reallocate_(uint32_t vertexCapacity, uint32_t indexCapacity, bool packed) {
+  std::array<std::unique_ptr<gfx::rhi::Buffer>, VERTEX_STREAM_COUNT> vertexBuffers;
+
+  auto indexBuffer = createBuffer_(indexCapacity, sizeof(uint32_t), true, "geometry_arena_index_buffer");
+  if (!createVertexBuffers_(vertexCapacity, vertexBuffers) || !indexBuffer) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to reallocate geometry arena buffers");
+    return false;
+  }
+
+  // uploads recorded into the old buffers are submitted before the copy reads them
+  m_device->flushUploads();
+
+  // by offset, so packing keeps the relative order of the ranges
+  std::vector<RenderGeometryMesh*> meshes(m_meshes.begin(), m_meshes.end());
+  std::sort(meshes.begin(), meshes.end(), [](const RenderGeometryMesh* lhs, const RenderGeometryMesh* rhs) {
+    return lhs->vertexOffset < rhs->vertexOffset;
+  });
+
+  if (packed) {
+    m_vertexAllocator.reset(vertexCapacity);
+    m_indexAllocator.reset(indexCapacity);
+  } else {
+    m_vertexAllocator.grow(vertexCapacity);
+    m_indexAllocator.grow(indexCapacity);
+  }
+
+  auto cmdBuffer = m_device->createCommandBuffer();
+  cmdBuffer->reset();
+  cmdBuffer->begin();
+
+  if (!packed) {
+    // offsets are kept, the old content is copied as a whole
+    for (size_t stream = 0; stream < VERTEX_STREAM_COUNT; ++stream) {
+      if (m_vertexBuffers[stream]) {
+        cmdBuffer->copyBuffer(m_vertexBuffers[stream].get(),
+                              vertexBuffers[stream].get(),
+                              0,
+                              0,
+                              m_vertexBuffers[stream]->getDesc().size);
+      }
+    }
+    cmdBuffer->copyBuffer(m_indexBuffer.get(), indexBuffer.get(), 0, 0, m_indexBuffer->getDesc().size);
+  }
+
+  for (auto* mesh : meshes) {
+    if (packed) {
+      const uint32_t vertexOffset = m_vertexAllocator.allocate(mesh->vertexCount);
+      const uint32_t firstIndex   = m_indexAllocator.allocate(mesh->getTotalIndexCount());
+
+      for (size_t stream = 0; stream < VERTEX_STREAM_COUNT; ++stream) {
+        if (!m_vertexBuffers[stream]) {
+          continue;
+        }
+        const uint64_t stride = g_getVertexStreamStride(static_cast<VertexStream>(stream));
+        cmdBuffer->copyBuffer(m_vertexBuffers[stream].get(),
+                              vertexBuffers[stream].get(),
+                              static_cast<uint64_t>(mesh->vertexOffset) * stride,
+                              static_cast<uint64_t>(vertexOffset) * stride,
+                              static_cast<uint64_t>(mesh->vertexCount) * stride);
+      }
+      cmdBuffer->copyBuffer(m_indexBuffer.get(),
+                            indexBuffer.get(),
+                            static_cast<uint64_t>(mesh->firstIndex) * sizeof(uint32_t),
+                            static_cast<uint64_t>(firstIndex) * sizeof(uint32_t),
+                            static_cast<uint64_t>(mesh->getTotalIndexCount()) * sizeof(uint32_t));
+
+      mesh->vertexOffset = vertexOffset;
+      mesh->firstIndex   = firstIndex;
+    }
+  }
+
+  cmdBuffer->end();
+
+  // only the copy is waited for, the uploads into the new buffers that follow must not race with it
+  auto fence = m_device->createFence();
+  m_device->submitCommandBuffer(cmdBuffer.get(), fence.get());
+  fence->wait();
+
+  // frames in flight were recorded with the old buffers and offsets
+  for (size_t stream = 0; stream < VERTEX_STREAM_COUNT; ++stream) {
+    retireBuffer_(std::move(m_vertexBuffers[stream]));
+  }
+  retireBuffer_(std::move(m_indexBuffer));
+
+  m_vertexBuffers = std::move(vertexBuffers);
+  m_indexBuffer   = std::move(indexBuffer);
+
+  for (auto* mesh : meshes) {
+    setMeshBuffers_(mesh);
+  }
+  return true;
+}
+
+void GeometryArena::retireBuffer_(std::unique_ptr<gfx::rhi::Buffer> buffer) const {
+  if (!buffer) {
+    return;
+  }
+
+  auto deletionManager = ServiceLocator::s_get<ResourceDeletionManager>();
+  if (!deletionManager) {
+    m_device->waitIdle();
+    return;
+  }
+
+  // the callback owns the buffer, it is destroyed with the callback
+  std::shared_ptr<gfx::rhi::Buffer> retiredBuffer = std::move(buffer);
+  const std::string                 bufferName    = retiredBuffer->getDesc().debugName;
+  deletionManager->enqueueForDeletion<gfx::rhi::Buffer>(
+      retiredBuffer.get(), [retiredBuffer](gfx::rhi::Buffer*) {}, bufferName, "Buffer");
+}
+
+bool GeometryArena::createVertexBuffers_(
+    uint32_t capacity, std::array<std::unique_ptr<gfx::rhi::Buffer>, VERTEX_STREAM_COUNT>& outBuffers) const {
+  for (size_t stream = 0; stream < VERTEX_STREAM_COUNT; ++stream) {
+    const auto vertexStream = static_cast<VertexStream>(stream);
+    if (!isStreamStored_(vertexStream)) {
+      continue;
+    }
+    outBuffers[stream]
+        = createBuffer_(capacity, g_getVertexStreamStride(vertexStream), false, VERTEX_STREAM_DEBUG_NAMES[stream]);
+    if (!outBuffers[stream]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool GeometryArena::isStreamStored_(VertexStream stream) const {
+  return stream != VertexStream::Color || m_storeVertexColors;
+}
+
+void GeometryArena::setMeshBuffers_(RenderGeometryMesh* mesh) const {
+  for (size_t stream = 0; stream < VERTEX_STREAM_COUNT; ++stream) {
+    mesh->vertexBuffers[stream] = getVertexBuffer(static_cast<VertexStream>(stream));
+  }
+  mesh->indexBuffer = m_indexBuffer.get();
+}
+
+std::unique_ptr<gfx::rhi::Buffer> GeometryArena::createBuffer_(uint32_t    elementCount,
+                                                               uint32_t    stride,
+                                                               bool        isIndexBuffer,
+                                                               const char* debugName) const {
+  gfx::rhi::BufferDesc bufferDesc;
+  bufferDesc.size        = static_cast<uint64_t>(elementCount) * stride;
+  bufferDesc.type        = gfx::rhi::BufferType::Static;
+  bufferDesc.createFlags = isIndexBuffer ? gfx::rhi::BufferCreateFlag::IndexBuffer
+                                         : gfx::rhi::BufferCreateFlag::VertexBuffer;
+  bufferDesc.stride      = stride;
+  bufferDesc.debugName   = debugName;
+
+  return m_device->createBuffer(bufferDesc);
+}
+
+}  // namespace arise
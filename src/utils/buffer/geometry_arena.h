@@ -0,0 +1,149 @@
+#ifndef ARISE_GEOMETRY_ARENA_H
+#define ARISE_GEOMETRY_ARENA_H
+
+#include "ecs/components/mesh.h"
+#include "ecs/components/render_geometry_mesh.h"
+#include "ecs/components/vertex.h"
+#include "gfx/rhi/interface/buffer.h"
+#include "utils/buffer/vertex_layout.h"
+#include "utils/memory/offset_allocator.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+namespace arise::gfx::rhi {
+class Device;
+}  // namespace arise::gfx::rhi
+
+namespace arise {
+
+/**
+ * One big vertex buffer per stream and one big 32-bit index buffer shared by all meshes. Each RenderGeometryMesh gets a
+ * range of them (vertexOffset / firstIndex), so draws bind the buffers once and select the mesh with the draw arguments.
+ *
+ * Vertices are stored quantized (see VertexLayout): positions in their own stream, the other attributes packed into
+ * 12 bytes, colors only when enabled - most meshes don't have any and no pass but the wireframe reads them.
+ *
+ * Meshes are allocated from asset loading jobs, but the buffers are only replaced by update() on the main thread
+ * between frames: a mesh that doesn't fit is kept pending (without buffers) until update() grows the buffers, copies
+ * the content on the GPU and places it. update() also packs the live ranges once unloading left enough holes. The
+ * replaced buffers are destroyed through ResourceDeletionManager, frames in flight keep drawing from them.
+ */
+class GeometryArena {
+  public:
+  GeometryArena(gfx::rhi::Device* device, bool storeVertexColors = false);
+
+  ~GeometryArena();
+
+  /**
+   * Allocates ranges for the geometry of sourceMesh (its levels included) and uploads it. Cooked meshes are uploaded
+   * from their packed streams as they are, the vertices of imported ones are packed first. Sets the buffers and offsets
+   * of the mesh on success, when the ranges don't fit the mesh is placed by the next update().
+   */
+  bool allocate(RenderGeometryMesh* mesh, const Mesh& sourceMesh);
+
+  void free(RenderGeometryMesh* mesh);
+
+  /**
+   * Grows the buffers for the pending meshes and places them, or packs the live ranges when the free space is split.
+   * Patches the buffers and offsets of the meshes - call on the main thread between frames.
+   */
+  void update();
+
+  // Without stored vertex colors, the color stream is a single white color (bound with a stride of 0)
+  gfx::rhi::Buffer* getVertexBuffer(VertexStream stream) const;
+
+  bool hasVertexColors() const { return m_storeVertexColors; }
+
+  gfx::rhi::Buffer* getIndexBuffer() const { return m_indexBuffer.get(); }
+
+  void release();
+
+  private:
+  // mesh that didn't fit the buffers, its data is kept until update() places it
+  struct PendingMesh {
+    RenderGeometryMesh*   mesh = nullptr;
+    PackedVertices        vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> lodIndices;  // the part the levels use
+    std::vector<MeshLod>  lods;
+  };
+
+  /**
+   * @param lods simplified levels of the mesh (Mesh::lods), their indices are stored after the indices of the full mesh
+   * @param lodIndices indices the levels point into (Mesh::getLodIndices())
+   */
+  bool allocate_(RenderGeometryMesh*       mesh,
+                 PackedVertexStreams       vertices,
+                 std::span<const uint32_t> indices,
+                 std::span<const MeshLod>  lods,
+                 std::span<const uint32_t> lodIndices);
+
+  // expect m_mutex to be locked
+
+  bool createBuffers_(uint32_t vertexCount, uint32_t indexCount);
+
+  bool fits_(uint32_t vertexCount, uint32_t indexCount) const;
+
+  // Allocates the ranges (they have to fit) and uploads the mesh
+  void place_(RenderGeometryMesh*       mesh,
+              PackedVertexStreams       vertices,
+              std::span<const uint32_t> indices,
+              std::span<const uint32_t> lodIndices,
+              std::span<const MeshLod>  lods);
+
+  void placePendingMeshes_();
+
+  /**
+   * Creates buffers of the given capacity and copies the ranges of the tracked meshes into them. When packed, the
+   * ranges are placed one after another and the allocators are rebuilt, otherwise the offsets are kept.
+   */
+  bool reallocate_(uint32_t vertexCapacity, uint32_t indexCapacity, bool packed);
+
+  // Destroys the buffer once the frames in flight are done with it
+  void retireBuffer_(std::unique_ptr<gfx::rhi::Buffer> buffer) const;
+
+  // Creates the buffers of the stored streams, false if any of them fails
+  bool createVertexBuffers_(uint32_t                                                        capacity,
+                            std::array<std::unique_ptr<gfx::rhi::Buffer>, VERTEX_STREAM_COUNT>& outBuffers) const;
+
+  bool isStreamStored_(VertexStream stream) const;
+
+  void setMeshBuffers_(RenderGeometryMesh* mesh) const;
+
+  std::unique_ptr<gfx::rhi::Buffer> createBuffer_(uint32_t    elementCount,
+                                                  uint32_t    stride,
+                                                  bool        isIndexBuffer,
+                                                  const char* debugName) const;
+
+  gfx::rhi::Device* m_device;
+  bool              m_storeVertexColors;
+
+  std::array<std::unique_ptr<gfx::rhi::Buffer>, VERTEX_STREAM_COUNT> m_vertexBuffers;
+  std::unique_ptr<gfx::rhi::Buffer>                                  m_indexBuffer;
+  std::unique_ptr<gfx::rhi::Buffer>                                  m_defaultColorBuffer;
+
+  OffsetAllocator m_vertexAllocator;
+  OffsetAllocator m_indexAllocator;
+
+  std::unordered_set<RenderGeometryMesh*> m_meshes;
+  std::vector<PendingMesh>                m_pendingMeshes;
+
+  mutable std::mutex m_mutex;
+};
+
+template <typename Recorder>
+void VertexLayout::bindVertexBuffers(Recorder& recorder, const GeometryArena& arena) const {
+  for (uint32_t binding = 0; binding < m_streams.size(); ++binding) {
+    recorder.bindVertexBuffer(binding, arena.getVertexBuffer(m_streams[binding]));
+  }
+}
+
+}  // namespace arise
+
+#endif  // ARISE_GEOMETRY_ARENA_H
@@ -0,0 +1,256 @@
+#include "utils/buffer/vertex_layout.h"
+
+#include <math_library/matrix.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace arise {
+
+namespace {
+
+constexpr float SNORM16_MAX = 32767.0f;
+
+// magnitude range of the second tangent component, 0 is left out so the bitangent sign can't be lost
+constexpr float TANGENT_SIGN_RANGE = 32766.0f;
+
+// the instance matrix is passed as 4 float4 columns
+constexpr uint32_t INSTANCE_MATRIX_COLUMNS = 4;
+
+struct AttributeFormat {
+  VertexAttribute         attribute;
+  VertexStream            stream;
+  gfx::rhi::TextureFormat format;
+  uint32_t                offset;
+  const char*             semanticName;
+};
+
+// in location order
+// clang-format off
+constexpr AttributeFormat ATTRIBUTE_FORMATS[] = {
+  {VertexAttribute::Position,  VertexStream::Position,   gfx::rhi::TextureFormat::Rgb32f,    0,                                           "POSITION"},
+  {VertexAttribute::TexCoords, VertexStream::Attributes, gfx::rhi::TextureFormat::Rg16f,     offsetof(PackedVertexAttributes, texCoords), "TEXCOORD"},
+  {VertexAttribute::Normal,    VertexStream::Attributes, gfx::rhi::TextureFormat::Rg16Snorm, offsetof(PackedVertexAttributes, normal),    "NORMAL"  },
+  {VertexAttribute::Tangent,   VertexStream::Attributes, gfx::rhi::TextureFormat::Rg16Snorm, offsetof(PackedVertexAttributes, tangent),   "TANGENT" },
+  {VertexAttribute::Color,     VertexStream::Color,      gfx::rhi::TextureFormat::Rgba8,     0,                                           "COLOR"   },
+};
+// clang-format on
+
+bool hasAttribute(VertexAttribute attributes, VertexAttribute attribute) {
+  return (attributes & attribute) != VertexAttribute::None;
+}
+
+// round to nearest even, out of range values become infinity
+uint16_t floatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t sign     = (bits >> 16) & 0x8000;
+  const uint32_t exponent = (bits >> 23) & 0xFF;
+  uint32_t       mantissa = bits & 0x7FFFFF;
+
+  if (exponent == 0xFF) {
+    return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+  }
+
+  const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+  if (halfExponent >= 0x1F) {
+    return static_cast<uint16_t>(sign | 0x7C00);
+  }
+
+  if (halfExponent <= 0) {
+    // subnormal half
+    if (halfExponent < -10) {
+      return static_cast<uint16_t>(sign);
+    }
+    mantissa |= 0x800000;
+    const uint32_t shift     = static_cast<uint32_t>(14 - halfExponent);
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway   = 1u << (shift - 1);
+    uint32_t       half      = mantissa >> shift;
+    if (remainder > halfway || (remainder == halfway && (half & 1))) {
+      ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+  }
+
+  // a carry out of the mantissa correctly rounds up into the exponent
+  uint32_t       half      = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+  const uint32_t remainder = mantissa & 0x1FFF;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+    ++half;
+  }
+  return static_cast<uint16_t>(sign | half);
+}
+
+float signNotZero(float value) {
+  return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+// unit vector to [-1, 1]^2, the lower hemisphere is folded over the diagonals
+math::Vector2f encodeOctahedral(const math::Vector3f& vector) {
+  const float length = std::abs(vector.x()) + std::abs(vector.y()) + std::abs(vector.z());
+  if (length <= 0.0f) {
+    return math::Vector2f(0.0f, 0.0f);
+  }
+
+  float x = vector.x() / length;
+  float y = vector.y() / length;
+  if (vector.z() < 0.0f) {
+    const float foldedX = (1.0f - std::abs(y)) * signNotZero(x);
+    const float foldedY = (1.0f - std::abs(x)) * signNotZero(y);
+    x                   = foldedX;
+    y                   = foldedY;
+  }
+  return math::Vector2f(x, y);
+}
+
+int16_t toSnorm16(float value) {
+  return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * SNORM16_MAX));
+}
+
+uint8_t toUnorm8(float value) {
+  return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+}  // namespace
+
+uint32_t g_getVertexStreamStride(VertexStream stream) {
+  switch (stream) {
+    case VertexStream::Position:
+      return sizeof(math::Vector3f);
+    case VertexStream::Attributes:
+      return sizeof(PackedVertexAttributes);
+    case VertexStream::Color:
+      return sizeof(uint32_t);
+    default:
+      return 0;
+  }
+}
+
+PackedVertexAttributes g_packVertexAttributes(const Vertex& vertex) {
+  PackedVertexAttributes packed;
+
+  packed.texCoords[0] = floatToHalf(vertex.texCoords.x());
+  packed.texCoords[1] = floatToHalf(vertex.texCoords.y());
+
+  const auto normal = encodeOctahedral(vertex.normal);
+  packed.normal[0]  = toSnorm16(normal.x());
+  packed.normal[1]  = toSnorm16(normal.y());
+
+  // the loaders build the bitangent as cross(normal, tangent) * sign, only the sign has to be kept
+  const float bitangentSign = vertex.normal.cross(vertex.tangent).dot(vertex.bitangent) < 0.0f ? -1.0f : 1.0f;
+
+  const auto  tangent   = encodeOctahedral(vertex.tangent);
+  const float magnitude = 1.0f + std::round((std::clamp(tangent.y(), -1.0f, 1.0f) * 0.5f + 0.5f) * TANGENT_SIGN_RANGE);
+  packed.tangent[0]     = toSnorm16(tangent.x());
+  packed.tangent[1]     = static_cast<int16_t>(bitangentSign * magnitude);
+
+  return packed;
+}
+
+uint32_t g_packVertexColor(const math::Vector4f& color) {
+  return static_cast<uint32_t>(toUnorm8(color.x())) | (static_cast<uint32_t>(toUnorm8(color.y())) << 8)
+       | (static_cast<uint32_t>(toUnorm8(color.z())) << 16) | (static_cast<uint32_t>(toUnorm8(color.w())) << 24);
+}
+
+PackedVertices g_packVertices(std::span<const Vertex> vertices, bool packColors) {
+  PackedVertices packed;
+  packed.positions.resize(vertices.size());
+  packed.attributes.resize(vertices.size());
+  packed.colors.resize(packColors ? vertices.size() : 0);
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    packed.positions[i]  = vertices[i].position;
+    packed.attributes[i] = g_packVertexAttributes(vertices[i]);
+    if (packColors) {
+      packed.colors[i] = g_packVertexColor(vertices[i].color);
+    }
+  }
+  return packed;
+}
+
+VertexLayout::VertexLayout(VertexAttribute attributes, bool hasColorStream)
+    : m_attributes(attributes)
+    , m_hasColorStream(hasColorStream) {
+  for (const auto& attributeFormat : ATTRIBUTE_FORMATS) {
+    if (hasAttribute(attributes, attributeFormat.attribute)
+        && std::find(m_streams.begin(), m_streams.end(), attributeFormat.stream) == m_streams.end()) {
+      m_streams.push_back(attributeFormat.stream);
+    }
+  }
+}
+
+void VertexLayout::fillPipelineDesc(gfx::rhi::GraphicsPipelineDesc& pipelineDesc, DrawInfoInput drawInfoInput) const {
+  for (uint32_t binding = 0; binding < m_streams.size(); ++binding) {
+    const VertexStream stream = m_streams[binding];
+
+    gfx::rhi::VertexInputBindingDesc vertexBinding;
+    vertexBinding.binding   = binding;
+    vertexBinding.stride    = g_getVertexStreamStride(stream);
+    vertexBinding.inputRate = gfx::rhi::VertexInputRate::Vertex;
+
+    // every vertex reads the one default color
+    if (stream == VertexStream::Color && !m_hasColorStream) {
+      vertexBinding.stride = 0;
+    }
+
+    pipelineDesc.vertexBindings.push_back(vertexBinding);
+  }
+
+  gfx::rhi::VertexInputBindingDesc instanceBinding;
+  instanceBinding.binding   = getInstanceBinding();
+  instanceBinding.stride    = sizeof(math::Matrix4f<>);
+  instanceBinding.inputRate = gfx::rhi::VertexInputRate::Instance;
+  pipelineDesc.vertexBindings.push_back(instanceBinding);
+
+  // locations (semantic indices in dx12) are dense, in the order of ATTRIBUTE_FORMATS
+  uint32_t location = 0;
+  for (const auto& attributeFormat : ATTRIBUTE_FORMATS) {
+    if (!hasAttribute(m_attributes, attributeFormat.attribute)) {
+      continue;
+    }
+
+    const auto stream = std::find(m_streams.begin(), m_streams.end(), attributeFormat.stream);
+
+    gfx::rhi::VertexInputAttributeDesc attribute;
+    attribute.location     = location++;
+    attribute.binding      = static_cast<uint32_t>(stream - m_streams.begin());
+    attribute.format       = attributeFormat.format;
+    attribute.offset       = attributeFormat.offset;
+    attribute.semanticName = attributeFormat.semanticName;
+    pipelineDesc.vertexAttributes.push_back(attribute);
+  }
+
+  for (uint32_t i = 0; i < INSTANCE_MATRIX_COLUMNS; ++i) {
+    gfx::rhi::VertexInputAttributeDesc matrixColumn;
+    matrixColumn.location     = location + i;
+    matrixColumn.binding      = instanceBinding.binding;
+    matrixColumn.format       = gfx::rhi::TextureFormat::Rgba32f;
+    matrixColumn.offset       = i * sizeof(math::Vector4f);
+    matrixColumn.semanticName = "INSTANCE";
+    pipelineDesc.vertexAttributes.push_back(matrixColumn);
+  }
+
+  if (drawInfoInput == DrawInfoInput::None) {
+    return;
+  }
+
+  // per draw values read by every instance of the draw, so the stride is 0 (dx12 takes it from the bound buffer)
+  gfx::rhi::VertexInputBindingDesc drawInfoBinding;
+  drawInfoBinding.binding   = getDrawInfoBinding();
+  drawInfoBinding.stride    = drawInfoInput == DrawInfoInput::PerInstance ? sizeof(uint32_t) : 0;
+  drawInfoBinding.inputRate = gfx::rhi::VertexInputRate::Instance;
+  pipelineDesc.vertexBindings.push_back(drawInfoBinding);
+
+  gfx::rhi::VertexInputAttributeDesc drawInfo;
+  drawInfo.location     = location + INSTANCE_MATRIX_COLUMNS;
+  drawInfo.binding      = drawInfoBinding.binding;
+  drawInfo.format       = gfx::rhi::TextureFormat::R32ui;
+  drawInfo.offset       = 0;
+  drawInfo.semanticName = "DRAWINFO";
+  pipelineDesc.vertexAttributes.push_back(drawInfo);
+}
+
+}  // namespace arise
@@ -0,0 +1,98 @@
+#ifndef ARISE_VERTEX_LAYOUT_H
+#define ARISE_VERTEX_LAYOUT_H
+
+#include "ecs/components/render_geometry_mesh.h"
+#include "ecs/components/vertex.h"
+#include "gfx/rhi/common/rhi_types.h"
+#include "utils/enum/enum_util.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace arise {
+
+class GeometryArena;
+
+/**
+ * Per vertex data the vertex shaders read. Locations are assigned in this order to the attributes a pipeline uses,
+ * followed by the instance matrix and the draw info (see VertexLayout).
+ */
+enum class VertexAttribute : uint8_t {
+  None      = 0,
+  Position  = 1 << 0,  // float3
+  TexCoords = 1 << 1,  // float2, stored as half
+  Normal    = 1 << 2,  // float2, octahedral - decoded in the shader
+  Tangent   = 1 << 3,  // float2, octahedral with the bitangent sign - decoded in the shader
+  Color     = 1 << 4,  // float4, stored as rgba8
+};
+
+DECLARE_ENUM_BIT_OPERATORS(VertexAttribute)
+
+uint32_t g_getVertexStreamStride(VertexStream stream);
+
+PackedVertexAttributes g_packVertexAttributes(const Vertex& vertex);
+
+uint32_t g_packVertexColor(const math::Vector4f& color);
+
+// Owns the streams g_packVertices() packed
+struct PackedVertices {
+  std::vector<math::Vector3f>         positions;
+  std::vector<PackedVertexAttributes> attributes;
+  std::vector<uint32_t>               colors;  // empty when the colors weren't packed
+
+  PackedVertexStreams getStreams() const { return {positions, attributes, colors}; }
+};
+
+PackedVertices g_packVertices(std::span<const Vertex> vertices, bool packColors);
+
+// How the draw info (one uint after the instance matrix, its meaning is up to the shader) is fetched
+enum class DrawInfoInput : uint8_t {
+  None,         // the vertex shader doesn't read it
+  PerDraw,      // one value for all instances of a draw, bound at its offset in a buffer with a stride of 0
+  PerInstance,  // one value per instance, next to the instance matrices (e.g. written by the GPU culling)
+};
+
+/**
+ * Vertex input of a pipeline, generated from the attributes its vertex shader reads. Each used stream gets a binding
+ * (in VertexStream order), the instance matrix binding comes after them.
+ *
+ * When the arena keeps no vertex colors, the color binding has a stride of 0 and reads the single white color the
+ * arena binds instead (GeometryArena::getVertexBuffer).
+ */
+class VertexLayout {
+  public:
+  explicit VertexLayout(VertexAttribute attributes, bool hasColorStream = true);
+
+  // Adds the vertex bindings and attributes, the per instance matrix (4 float4 columns) and the draw info after them
+  void fillPipelineDesc(gfx::rhi::GraphicsPipelineDesc& pipelineDesc,
+                        DrawInfoInput                   drawInfoInput = DrawInfoInput::None) const;
+
+  // Binds the streams of the mesh, works with rhi::CommandBuffer and renderer::CommandRecorder
+  template <typename Recorder>
+  void bindVertexBuffers(Recorder& recorder, const RenderGeometryMesh& mesh) const {
+    for (uint32_t binding = 0; binding < m_streams.size(); ++binding) {
+      recorder.bindVertexBuffer(binding, mesh.vertexBuffers[static_cast<size_t>(m_streams[binding])]);
+    }
+  }
+
+  // Binds the shared streams of the arena, for draws that select the mesh with their arguments only (defined in
+  // geometry_arena.h)
+  template <typename Recorder>
+  void bindVertexBuffers(Recorder& recorder, const GeometryArena& arena) const;
+
+  uint32_t getInstanceBinding() const { return static_cast<uint32_t>(m_streams.size()); }
+
+  uint32_t getDrawInfoBinding() const { return getInstanceBinding() + 1; }
+
+  VertexAttribute getAttributes() const { return m_attributes; }
+
+  private:
+  VertexAttribute           m_attributes;
+  bool                      m_hasColorStream;
+  std::vector<VertexStream> m_streams;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_VERTEX_LAYOUT_H
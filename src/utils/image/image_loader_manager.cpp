@@ -1,9 +1,19 @@
 #include "utils/image/image_loader_manager.h"
 
+#include "utils/asset/derived_data_cache.h"
 #include "utils/logger/global_logger.h"
+#include "utils/memory/mapped_file.h"
+#include "utils/service/service_locator.h"
 
 namespace arise {
 
+namespace {
+
+constexpr uint32_t IMAGE_DATA_MAGIC   = 0x474D4941;  // "AIMG"
+constexpr uint32_t IMAGE_DATA_VERSION = 1;
+
+}  // namespace
+
 void ImageLoaderManager::registerLoader(ImageType imageType, std::shared_ptr<IImageLoader> loader) {
   std::lock_guard<std::mutex> lock(mutex_);
   loaderMap_[imageType] = std::move(loader);
@@ -29,11 +39,98 @@ std::unique_ptr<Image> ImageLoaderManager::loadImage(const std::filesystem::path
   }
 
   if (loader && loader->supportsFormat(extension)) {
-    return loader->loadImage(filepath);
+    // DDS and KTX already store the pixels the way the GPU consumes them, loading them is no cheaper from the cache
+    auto derivedDataCache = ServiceLocator::s_get<DerivedDataCache>();
+    if (!derivedDataCache || imageType == ImageType::DDS || imageType == ImageType::KTX) {
+      return loader->loadImage(filepath);
+    }
+
+    auto key = derivedDataCache->makeKey(filepath, "image", IMAGE_DATA_VERSION);
+    if (key) {
+      if (auto image = readImage_(*key, filepath)) {
+        return image;
+      }
+    }
+
+    auto image = loader->loadImage(filepath);
+    if (image && key) {
+      storeImage_(*key, *image);
+    }
+    return image;
   }
 
   GlobalLogger::Log(LogLevel::Error, "No suitable loader found for image type: " + extension);
   return nullptr;
 }
 
+std::unique_ptr<Image> ImageLoaderManager::readImage_(uint64_t key, const std::filesystem::path& filepath) {
+  auto entry = ServiceLocator::s_get<DerivedDataCache>()->load(key);
+  if (!entry) {
+    return nullptr;
+  }
+
+  DerivedDataReader reader(entry->getData(), entry->getSize());
+  uint32_t          magic   = 0;
+  uint32_t          version = 0;
+  if (!reader.read(magic) || !reader.read(version) || magic != IMAGE_DATA_MAGIC || version != IMAGE_DATA_VERSION) {
+    GlobalLogger::Log(LogLevel::Warning, "Ignoring invalid derived data for image: " + filepath.string());
+    return nullptr;
+  }
+
+  auto image = std::make_unique<Image>();
+  reader.read(image->width);
+  reader.read(image->height);
+  reader.read(image->depth);
+  reader.read(image->mipLevels);
+  reader.read(image->arraySize);
+  reader.read(image->format);
+  reader.read(image->dimension);
+
+  // the counts are checked against the entry size before anything is allocated for them
+  uint64_t subImageCount = 0;
+  bool     isValid       = reader.read(subImageCount) && subImageCount <= entry->getSize() / sizeof(SubImage);
+  if (isValid) {
+    image->subImages.resize(static_cast<size_t>(subImageCount));
+    reader.readBytes(image->subImages.data(), image->subImages.size() * sizeof(SubImage));
+  }
+
+  uint64_t pixelsSize = 0;
+  isValid             = isValid && reader.read(pixelsSize) && pixelsSize <= entry->getSize();
+  if (isValid) {
+    image->pixels.resize(static_cast<size_t>(pixelsSize));
+    reader.readBytes(image->pixels.data(), image->pixels.size());
+  }
+
+  if (!isValid || !reader.isComplete()) {
+    GlobalLogger::Log(LogLevel::Warning, "Ignoring damaged derived data for image: " + filepath.string());
+    return nullptr;
+  }
+
+  return image;
+}
+
+void ImageLoaderManager::storeImage_(uint64_t key, const Image& image) {
+  DerivedDataWriter writer;
+  writer.write(IMAGE_DATA_MAGIC);
+  writer.write(IMAGE_DATA_VERSION);
+
+  writer.write(image.width);
+  writer.write(image.height);
+  writer.write(image.depth);
+  writer.write(image.mipLevels);
+  writer.write(image.arraySize);
+  writer.write(image.format);
+  writer.write(image.dimension);
+
+  writer.write(static_cast<uint64_t>(image.subImages.size()));
+  writer.writeBytes(image.subImages.data(), image.subImages.size() * sizeof(SubImage));
+
+  writer.write(static_cast<uint64_t>(image.pixels.size()));
+  writer.writeBytes(image.pixels.data(), image.pixels.size());
+
+  if (!ServiceLocator::s_get<DerivedDataCache>()->store(key, writer.getData())) {
+    GlobalLogger::Log(LogLevel::Warning, "Failed to store derived data for image");
+  }
+}
+
 }  // namespace arise
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "file_loader/image_file_loader.h"
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <mutex>
@@ -16,9 +17,13 @@ class ImageLoaderManager {
 
   void registerLoader(ImageType imageType, std::shared_ptr<IImageLoader> loader);
 
+  // Decoded images are kept in the DerivedDataCache (if provided), so a source is decoded only once
   std::unique_ptr<Image> loadImage(const std::filesystem::path& filepath);
 
   private:
+  std::unique_ptr<Image> readImage_(uint64_t key, const std::filesystem::path& filepath);
+  void                   storeImage_(uint64_t key, const Image& image);
+
   std::unordered_map<ImageType, std::shared_ptr<IImageLoader>> loaderMap_;
   std::mutex                                                    mutex_;
 };
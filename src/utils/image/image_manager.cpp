@@ -1,15 +1,23 @@
 #include "utils/image/image_manager.h"
 
+#include "profiler/profiler.h"
 #include "utils/image/image_loader_manager.h"
+#include "utils/job/job_system.h"
 #include "utils/logger/global_logger.h"
 #include "utils/service/service_locator.h"
 
+#include <algorithm>
+#include <mutex>
+
 namespace arise {
 
 Image* ImageManager::getImage(const std::filesystem::path& filepath) {
-  auto it = m_imageCache_.find(filepath);
-  if (it != m_imageCache_.end()) {
-    return it->second.get();
+  {
+    std::shared_lock<std::shared_mutex> readLock(m_mutex_);
+    auto                                it = m_imageCache_.find(filepath);
+    if (it != m_imageCache_.end()) {
+      return it->second.get();
+    }
   }
 
   auto imageLoaderManager = ServiceLocator::s_get<ImageLoaderManager>();
@@ -18,15 +26,44 @@ Image* ImageManager::getImage(const std::filesystem::path& filepath) {
     return nullptr;
   }
 
+  // decoding happens outside of the lock, so different images can be decoded concurrently
   auto image = imageLoaderManager->loadImage(filepath);
   if (image) {
-    Image* imagePtr         = image.get();
-    m_imageCache_[filepath] = std::move(image);
-    return imagePtr;
+    std::unique_lock<std::shared_mutex> writeLock(m_mutex_);
+    // another thread may have decoded the same image in the meantime - keep the first one
+    auto [it, inserted] = m_imageCache_.try_emplace(filepath, std::move(image));
+    return it->second.get();
   }
 
   GlobalLogger::Log(LogLevel::Warning, "Failed to load image: " + filepath.string());
   return nullptr;
 }
 
-}  // namespace arise
\ No newline at end of file
+void ImageManager::prefetchImages(const std::vector<std::filesystem::path>& filepaths) {
+  CPU_ZONE_NC("ImageManager::prefetchImages", color::BROWN);
+
+  std::vector<std::filesystem::path> missing;
+  missing.reserve(filepaths.size());
+  for (const auto& filepath : filepaths) {
+    if (!hasImage(filepath) && std::find(missing.begin(), missing.end(), filepath) == missing.end()) {
+      missing.push_back(filepath);
+    }
+  }
+
+  if (missing.empty()) {
+    return;
+  }
+
+  g_parallelFor(static_cast<uint32_t>(missing.size()), 1, [this, &missing](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      getImage(missing[i]);
+    }
+  });
+}
+
+bool ImageManager::hasImage(const std::filesystem::path& filepath) const {
+  std::shared_lock<std::shared_mutex> readLock(m_mutex_);
+  return m_imageCache_.find(filepath) != m_imageCache_.end();
+}
+
+}  // namespace arise
@@ -5,20 +5,33 @@
 
 #include <filesystem>
 #include <memory>
+#include <shared_mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace arise {
 
+/**
+ * Thread-safe cache of decoded images. Images may be decoded concurrently from job system workers.
+ */
 class ImageManager {
   public:
   ImageManager() = default;
 
   Image* getImage(const std::filesystem::path& filepath);
 
+  /**
+   * Decodes all images that are not cached yet in parallel on the job system (blocking).
+   */
+  void prefetchImages(const std::vector<std::filesystem::path>& filepaths);
+
+  bool hasImage(const std::filesystem::path& filepath) const;
+
   private:
   std::unordered_map<std::filesystem::path, std::unique_ptr<Image>> m_imageCache_;
+  mutable std::shared_mutex                                         m_mutex_;
 };
 
 }  // namespace arise
 
-#endif  // ARISE_IMAGE_MANAGER_H
\ No newline at end of file
+#endif  // ARISE_IMAGE_MANAGER_H
@@ -0,0 +1,304 @@
+#include "utils/job/job_system.h"
+
+#include "profiler/profiler.h"
+#include "utils/logger/global_logger.h"
+#include "utils/service/service_locator.h"
+
+#include <algorithm>
+#include <string>
+
+namespace arise {
+
+struct Job {
+  JobSystem::JobFunction function;
+  JobPriority            priority = JobPriority::Normal;
+
+  // +1 while the job is being submitted, so it can't be scheduled before all dependencies are registered
+  std::atomic<uint32_t> pendingDependencies{0};
+  std::atomic<bool>     finished{false};
+
+  std::mutex                        continuationMutex;
+  std::vector<std::shared_ptr<Job>> continuations;
+};
+
+namespace {
+
+thread_local const JobSystem* s_currentJobSystem   = nullptr;
+thread_local uint32_t         s_currentWorkerIndex = 0;
+
+}  // namespace
+
+bool JobHandle::isDone() const {
+  return !m_job_ || m_job_->finished.load(std::memory_order_acquire);
+}
+
+JobSystem::~JobSystem() {
+  shutdown();
+}
+
+void JobSystem::initialize(uint32_t workerCount) {
+  if (m_running_) {
+    return;
+  }
+
+  if (workerCount == 0) {
+    workerCount = s_getDefaultWorkerCount();
+  }
+
+  m_queues_.clear();
+  for (uint32_t i = 0; i < workerCount; ++i) {
+    m_queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+
+  m_running_ = true;
+
+  m_workers_.reserve(workerCount);
+  for (uint32_t i = 0; i < workerCount; ++i) {
+    m_workers_.emplace_back(&JobSystem::workerFunction_, this, i);
+  }
+
+  GlobalLogger::Log(LogLevel::Info, "JobSystem initialized with " + std::to_string(workerCount) + " worker(s)");
+}
+
+void JobSystem::shutdown() {
+  if (!m_running_) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex_);
+    m_running_ = false;
+  }
+  m_wakeCondition_.notify_all();
+
+  for (auto& worker : m_workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  m_workers_.clear();
+
+  if (m_queuedJobCount_ > 0) {
+    GlobalLogger::Log(LogLevel::Warning,
+                      "JobSystem shutdown with " + std::to_string(m_queuedJobCount_.load()) + " unfinished job(s)");
+  }
+
+  m_queues_.clear();
+  m_queuedJobCount_ = 0;
+
+  GlobalLogger::Log(LogLevel::Info, "JobSystem shutdown");
+}
+
+JobHandle JobSystem::submit(JobFunction function, JobPriority priority, const std::vector<JobHandle>& dependencies) {
+  auto job      = std::make_shared<Job>();
+  job->function = std::move(function);
+  job->priority = priority;
+
+  if (!m_running_) {
+    GlobalLogger::Log(LogLevel::Warning, "JobSystem is not running, executing job on the calling thread");
+    for (const auto& dependency : dependencies) {
+      wait(dependency);
+    }
+    execute_(job);
+    return JobHandle(job);
+  }
+
+  job->pendingDependencies.store(1, std::memory_order_relaxed);
+
+  for (const auto& dependency : dependencies) {
+    if (!dependency.m_job_) {
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(dependency.m_job_->continuationMutex);
+    if (!dependency.m_job_->finished.load(std::memory_order_acquire)) {
+      job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+      dependency.m_job_->continuations.push_back(job);
+    }
+  }
+
+  if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    schedule_(job);
+  }
+
+  return JobHandle(job);
+}
+
+void JobSystem::wait(const JobHandle& handle) {
+  if (!handle.m_job_) {
+    return;
+  }
+
+  while (!handle.m_job_->finished.load(std::memory_order_acquire)) {
+    if (!tryExecuteJob_()) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::waitAll(const std::vector<JobHandle>& handles) {
+  for (const auto& handle : handles) {
+    wait(handle);
+  }
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t chunkSize, const RangeFunction& function, JobPriority priority) {
+  if (count == 0) {
+    return;
+  }
+
+  chunkSize           = std::max(chunkSize, 1u);
+  uint32_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+  if (chunkCount == 1 || !m_running_) {
+    function(0, count);
+    return;
+  }
+
+  std::vector<JobHandle> handles;
+  handles.reserve(chunkCount - 1);
+
+  // the first chunk is processed by the calling thread
+  for (uint32_t chunk = 1; chunk < chunkCount; ++chunk) {
+    uint32_t begin = chunk * chunkSize;
+    uint32_t end   = std::min(begin + chunkSize, count);
+    handles.push_back(submit([&function, begin, end]() { function(begin, end); }, priority));
+  }
+
+  function(0, std::min(chunkSize, count));
+
+  waitAll(handles);
+}
+
+uint32_t JobSystem::s_getDefaultWorkerCount() {
+  uint32_t hardwareThreads = std::thread::hardware_concurrency();
+  // leave one core for the main thread
+  return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+void JobSystem::workerFunction_(uint32_t workerIndex) {
+  s_currentJobSystem   = this;
+  s_currentWorkerIndex = workerIndex;
+
+#ifdef TRACY_ENABLE
+  static thread_local std::string threadName = "Job Worker " + std::to_string(workerIndex);
+  tracy::SetThreadName(threadName.c_str());
+#endif
+
+  while (m_running_) {
+    if (tryExecuteJob_()) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex_);
+    m_wakeCondition_.wait(lock, [this] { return !m_running_ || m_queuedJobCount_.load() > 0; });
+  }
+
+  s_currentJobSystem = nullptr;
+}
+
+void JobSystem::schedule_(std::shared_ptr<Job> job) {
+  if (m_queues_.empty()) {
+    execute_(job);
+    return;
+  }
+
+  // jobs spawned by a worker stay on its own queue, others are distributed round-robin
+  uint32_t queueIndex = (s_currentJobSystem == this)
+                          ? s_currentWorkerIndex
+                          : m_nextQueue_.fetch_add(1, std::memory_order_relaxed) % m_queues_.size();
+
+  auto& queue = *m_queues_[queueIndex];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs[static_cast<size_t>(job->priority)].push_back(std::move(job));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex_);
+    m_queuedJobCount_.fetch_add(1, std::memory_order_release);
+  }
+  m_wakeCondition_.notify_one();
+}
+
+std::shared_ptr<Job> JobSystem::popJob_(uint32_t workerIndex) {
+  const auto queueCount = static_cast<uint32_t>(m_queues_.size());
+
+  for (size_t priority = 0; priority < static_cast<size_t>(JobPriority::Count); ++priority) {
+    // own queue - newest first
+    {
+      auto&                       queue = *m_queues_[workerIndex];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      auto&                       jobs = queue.jobs[priority];
+      if (!jobs.empty()) {
+        auto job = std::move(jobs.back());
+        jobs.pop_back();
+        return job;
+      }
+    }
+
+    // steal - oldest first
+    for (uint32_t offset = 1; offset < queueCount; ++offset) {
+      auto&                       queue = *m_queues_[(workerIndex + offset) % queueCount];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      auto&                       jobs = queue.jobs[priority];
+      if (!jobs.empty()) {
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        return job;
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+bool JobSystem::tryExecuteJob_() {
+  if (m_queues_.empty() || m_queuedJobCount_.load(std::memory_order_acquire) == 0) {
+    return false;
+  }
+
+  uint32_t workerIndex = (s_currentJobSystem == this)
+                           ? s_currentWorkerIndex
+                           : m_nextQueue_.load(std::memory_order_relaxed) % m_queues_.size();
+
+  auto job = popJob_(workerIndex);
+  if (!job) {
+    return false;
+  }
+
+  m_queuedJobCount_.fetch_sub(1, std::memory_order_acq_rel);
+  execute_(job);
+  return true;
+}
+
+void JobSystem::execute_(const std::shared_ptr<Job>& job) {
+  if (job->function) {
+    job->function();
+    // release captured resources as soon as possible
+    job->function = nullptr;
+  }
+
+  std::vector<std::shared_ptr<Job>> continuations;
+  {
+    std::lock_guard<std::mutex> lock(job->continuationMutex);
+    job->finished.store(true, std::memory_order_release);
+    continuations.swap(job->continuations);
+  }
+
+  for (auto& continuation : continuations) {
+    if (continuation->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      schedule_(std::move(continuation));
+    }
+  }
+}
+
+void g_parallelFor(uint32_t count, uint32_t chunkSize, const JobSystem::RangeFunction& function, JobPriority priority) {
+  if (auto jobSystem = ServiceLocator::s_get<JobSystem>()) {
+    jobSystem->parallelFor(count, chunkSize, function, priority);
+  } else if (count > 0) {
+    function(0, count);
+  }
+}
+
+}  // namespace arise
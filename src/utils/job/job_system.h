@@ -0,0 +1,136 @@
+#ifndef ARISE_JOB_SYSTEM_H
+#define ARISE_JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace arise {
+
+/**
+ * Scheduling priority of a job. Workers always drain higher priority queues first.
+ */
+enum class JobPriority : uint8_t {
+  High,
+  Normal,
+  Low,
+  Count,
+};
+
+struct Job;
+
+/**
+ * Lightweight reference to a submitted job. Can be used to wait for completion or as a dependency of other jobs.
+ */
+class JobHandle {
+  public:
+  JobHandle() = default;
+
+  bool isValid() const { return m_job_ != nullptr; }
+
+  bool isDone() const;
+
+  private:
+  friend class JobSystem;
+
+  explicit JobHandle(std::shared_ptr<Job> job)
+      : m_job_(std::move(job)) {}
+
+  std::shared_ptr<Job> m_job_;
+};
+
+/**
+ * Work-stealing thread pool.
+ *
+ * Every worker owns one deque per priority. A worker pops its own jobs from the back (LIFO, cache friendly) and steals
+ * from the front of other workers' deques (FIFO) when it runs out of work. Jobs may depend on other jobs - a job is
+ * queued only after all of its dependencies finished.
+ *
+ * Threads that wait for a job (see wait()) execute pending jobs in the meantime, so waiting from inside a job is safe.
+ */
+class JobSystem {
+  public:
+  using JobFunction   = std::function<void()>;
+  // Processes the half-open range [begin, end)
+  using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+  JobSystem() = default;
+  ~JobSystem();
+
+  JobSystem(const JobSystem&)            = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  /**
+   * @param workerCount number of worker threads, 0 means hardware concurrency - 1 (the main thread also helps while
+   *                    waiting).
+   */
+  void initialize(uint32_t workerCount = 0);
+  void shutdown();
+
+  JobHandle submit(JobFunction                   function,
+                   JobPriority                   priority     = JobPriority::Normal,
+                   const std::vector<JobHandle>& dependencies = {});
+
+  void wait(const JobHandle& handle);
+  void waitAll(const std::vector<JobHandle>& handles);
+
+  /**
+   * Splits [0, count) into chunks of chunkSize elements and processes them in parallel. Blocks until all chunks are
+   * processed, the calling thread takes part in the work.
+   */
+  void parallelFor(uint32_t             count,
+                   uint32_t             chunkSize,
+                   const RangeFunction& function,
+                   JobPriority          priority = JobPriority::High);
+
+  uint32_t getWorkerCount() const { return static_cast<uint32_t>(m_workers_.size()); }
+
+  bool isRunning() const { return m_running_; }
+
+  static uint32_t s_getDefaultWorkerCount();
+
+  private:
+  struct WorkerQueue {
+    std::mutex                       mutex;
+    std::deque<std::shared_ptr<Job>> jobs[static_cast<size_t>(JobPriority::Count)];
+  };
+
+  void workerFunction_(uint32_t workerIndex);
+
+  void schedule_(std::shared_ptr<Job> job);
+
+  std::shared_ptr<Job> popJob_(uint32_t workerIndex);
+
+  bool tryExecuteJob_();
+
+  void execute_(const std::shared_ptr<Job>& job);
+
+  std::atomic<bool>     m_running_{false};
+  std::atomic<uint32_t> m_queuedJobCount_{0};
+  std::atomic<uint32_t> m_nextQueue_{0};
+
+  std::vector<std::thread>                  m_workers_;
+  std::vector<std::unique_ptr<WorkerQueue>> m_queues_;
+
+  std::mutex              m_sleepMutex_;
+  std::condition_variable m_wakeCondition_;
+};
+
+/**
+ * JobSystem::parallelFor on the registered job system, processes the whole range on the calling thread when there is
+ * none.
+ */
+void g_parallelFor(uint32_t                        count,
+                   uint32_t                        chunkSize,
+                   const JobSystem::RangeFunction& function,
+                   JobPriority                     priority = JobPriority::High);
+
+}  // namespace arise
+
+#endif  // ARISE_JOB_SYSTEM_H
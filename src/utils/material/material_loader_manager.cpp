@@ -0,0 +1,197 @@
+#include "utils/material/material_loader_manager.h"
+
+#include "utils/asset/derived_data_cache.h"
+#include "utils/image/image_manager.h"
+#include "utils/memory/mapped_file.h"
+#include "utils/service/service_locator.h"
+#include "utils/texture/texture_manager.h"
+
+#include <unordered_set>
+
+namespace arise {
+
+namespace {
+
+constexpr uint32_t MATERIALS_DATA_MAGIC   = 0x4C544D41;  // "AMTL"
+constexpr uint32_t MATERIALS_DATA_VERSION = 1;
+
+}  // namespace
+
+std::vector<std::unique_ptr<Material>> MaterialLoaderManager::loadMaterials(const std::filesystem::path& filePath) {
+  IMaterialLoader* loader = findLoader_(filePath);
+  if (!loader) {
+    return {};
+  }
+
+  auto key = makeDerivedDataKey_(filePath);
+  if (key) {
+    std::vector<std::unique_ptr<Material>> materials;
+    if (readMaterials_(*key, filePath, materials)) {
+      GlobalLogger::Log(LogLevel::Debug, "Derived data cache hit for materials: " + filePath.string());
+      createTextures_(materials);
+      return materials;
+    }
+  }
+
+  auto materials = loader->loadMaterials(filePath);
+  if (key) {
+    storeMaterials_(*key, materials);
+  }
+  return materials;
+}
+
+std::vector<std::filesystem::path> MaterialLoaderManager::getImagePaths(const std::filesystem::path& filePath,
+                                                                        std::shared_ptr<const void>* outSourceHandle) {
+  IMaterialLoader* loader = findLoader_(filePath);
+  if (!loader) {
+    return {};
+  }
+
+  if (auto key = makeDerivedDataKey_(filePath)) {
+    std::vector<std::unique_ptr<Material>> materials;
+    if (readMaterials_(*key, filePath, materials)) {
+      std::vector<std::filesystem::path> imagePaths;
+      for (const auto& material : materials) {
+        for (const auto& texturePath : material->texturePaths) {
+          if (!texturePath.empty()) {
+            imagePaths.push_back(texturePath);
+          }
+        }
+      }
+      return imagePaths;
+    }
+  }
+
+  return loader->getImagePaths(filePath, outSourceHandle);
+}
+
+std::optional<uint64_t> MaterialLoaderManager::makeDerivedDataKey_(const std::filesystem::path& filePath) {
+  auto derivedDataCache = ServiceLocator::s_get<DerivedDataCache>();
+  if (!derivedDataCache) {
+    return std::nullopt;
+  }
+  return derivedDataCache->makeKey(filePath, "materials", MATERIALS_DATA_VERSION);
+}
+
+bool MaterialLoaderManager::readMaterials_(uint64_t                                key,
+                                           const std::filesystem::path&            filePath,
+                                           std::vector<std::unique_ptr<Material>>& outMaterials) {
+  auto entry = ServiceLocator::s_get<DerivedDataCache>()->load(key);
+  if (!entry) {
+    return false;
+  }
+
+  DerivedDataReader reader(entry->getData(), entry->getSize());
+  uint32_t          magic   = 0;
+  uint32_t          version = 0;
+  uint32_t          count   = 0;
+  if (!reader.read(magic) || !reader.read(version) || !reader.read(count) || magic != MATERIALS_DATA_MAGIC
+      || version != MATERIALS_DATA_VERSION) {
+    GlobalLogger::Log(LogLevel::Warning, "Ignoring invalid derived data for materials: " + filePath.string());
+    return false;
+  }
+
+  std::vector<std::unique_ptr<Material>> materials;
+  for (uint32_t i = 0; i < count && !reader.hasFailed(); ++i) {
+    auto material      = std::make_unique<Material>();
+    material->filePath = filePath;
+
+    reader.readString(material->materialName);
+    reader.read(material->data.baseColor);
+    reader.read(material->data.metallic);
+    reader.read(material->data.roughness);
+    reader.read(material->data.opacity);
+
+    for (auto& texturePath : material->texturePaths) {
+      std::string path;
+      reader.readString(path);
+      texturePath = path;
+    }
+
+    materials.push_back(std::move(material));
+  }
+
+  if (!reader.isComplete()) {
+    GlobalLogger::Log(LogLevel::Warning, "Ignoring damaged derived data for materials: " + filePath.string());
+    return false;
+  }
+
+  outMaterials = std::move(materials);
+  return true;
+}
+
+void MaterialLoaderManager::storeMaterials_(uint64_t key, const std::vector<std::unique_ptr<Material>>& materials) {
+  DerivedDataWriter writer;
+  writer.write(MATERIALS_DATA_MAGIC);
+  writer.write(MATERIALS_DATA_VERSION);
+  writer.write(static_cast<uint32_t>(materials.size()));
+
+  for (const auto& material : materials) {
+    // textures that can't be recreated from a path (e.g. embedded images) would be lost, such sources aren't cached
+    for (size_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; ++slot) {
+      if (material->data.textures[slot] && material->texturePaths[slot].empty()) {
+        return;
+      }
+    }
+
+    writer.writeString(material->materialName);
+    writer.write(material->data.baseColor);
+    writer.write(material->data.metallic);
+    writer.write(material->data.roughness);
+    writer.write(material->data.opacity);
+
+    for (const auto& texturePath : material->texturePaths) {
+      writer.writeString(texturePath.generic_string());
+    }
+  }
+
+  if (!ServiceLocator::s_get<DerivedDataCache>()->store(key, writer.getData())) {
+    GlobalLogger::Log(LogLevel::Warning, "Failed to store derived data for materials");
+  }
+}
+
+void MaterialLoaderManager::createTextures_(const std::vector<std::unique_ptr<Material>>& materials) {
+  auto imageManager   = ServiceLocator::s_get<ImageManager>();
+  auto textureManager = ServiceLocator::s_get<TextureManager>();
+  if (!imageManager || !textureManager) {
+    GlobalLogger::Log(LogLevel::Error, "ImageManager or TextureManager not available, materials have no textures");
+    return;
+  }
+
+  // decode (or read from the cache) all images up front on the job system
+  std::vector<std::filesystem::path> imagePaths;
+  std::unordered_set<std::string>    uniquePaths;
+  for (const auto& material : materials) {
+    for (const auto& texturePath : material->texturePaths) {
+      if (!texturePath.empty() && uniquePaths.insert(texturePath.string()).second) {
+        imagePaths.push_back(texturePath);
+      }
+    }
+  }
+  imageManager->prefetchImages(imagePaths);
+
+  for (const auto& material : materials) {
+    for (size_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; ++slot) {
+      const auto& texturePath = material->texturePaths[slot];
+      if (texturePath.empty()) {
+        continue;
+      }
+
+      auto image = imageManager->getImage(texturePath);
+      if (!image) {
+        GlobalLogger::Log(LogLevel::Error, "Failed to load image: " + texturePath.string());
+        continue;
+      }
+
+      std::string textureName = texturePath.filename().string();
+
+      auto texture = textureManager->getTexture(textureName);
+      if (!texture) {
+        texture = textureManager->createTexture(image, textureName);
+      }
+      material->data.setTexture(static_cast<MaterialTexture>(slot), texture);
+    }
+  }
+}
+
+}  // namespace arise
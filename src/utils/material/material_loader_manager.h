@@ -4,9 +4,12 @@
 #include "resources/i_material_loader.h"
 #include "utils/logger/global_logger.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
 
 namespace arise {
@@ -46,34 +49,48 @@ class MaterialLoaderManager {
     loaderMap_[materialType] = std::move(loader);
   }
 
-  std::vector<std::unique_ptr<Material>> loadMaterials(const std::filesystem::path& filePath) {
+  // Restores the materials from the DerivedDataCache (if provided), loads and caches them on a miss
+  std::vector<std::unique_ptr<Material>> loadMaterials(const std::filesystem::path& filePath);
+
+  // Served from the DerivedDataCache as well, so a cached source isn't parsed just to prefetch its images
+  std::vector<std::filesystem::path> getImagePaths(const std::filesystem::path& filePath,
+                                                   std::shared_ptr<const void>* outSourceHandle = nullptr);
+
+  private:
+  std::optional<uint64_t> makeDerivedDataKey_(const std::filesystem::path& filePath);
+
+  // Materials of a derived data entry, without textures (only the texture paths are stored)
+  bool readMaterials_(uint64_t                                key,
+                      const std::filesystem::path&            filePath,
+                      std::vector<std::unique_ptr<Material>>& outMaterials);
+
+  void storeMaterials_(uint64_t key, const std::vector<std::unique_ptr<Material>>& materials);
+
+  // Recreates the textures from the texture paths, like the loaders do
+  void createTextures_(const std::vector<std::unique_ptr<Material>>& materials);
+
+  IMaterialLoader* findLoader_(const std::filesystem::path& filePath) {
     std::string extension = filePath.extension().string();
     std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
     MaterialType materialType = getMaterialTypeFromExtension(extension);
 
     if (materialType == MaterialType::UNKNOWN) {
       GlobalLogger::Log(LogLevel::Error, "Unknown material type for extension: " + extension);
-      return {};
+      return nullptr;
     }
 
-    IMaterialLoader* loader = nullptr;
     {
       std::lock_guard<std::mutex> lock(mutex_);
       auto                        it = loaderMap_.find(materialType);
       if (it != loaderMap_.end()) {
-        loader = it->second.get();
+        return it->second.get();
       }
     }
 
-    if (loader) {
-      return loader->loadMaterials(filePath);
-    }
-
     GlobalLogger::Log(LogLevel::Error, "No suitable loader found for material type: " + extension);
-    return {};
+    return nullptr;
   }
 
-  private:
   std::unordered_map<MaterialType, std::shared_ptr<IMaterialLoader>> loaderMap_;
   std::mutex                                                         mutex_;
 };
@@ -73,8 +73,10 @@ class MaterialManager {
 
         auto textureManager = ServiceLocator::s_get<TextureManager>();
         if (textureManager) {
-          for (const auto& [textureName, texturePtr] : material->textures) {
+          for (size_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; ++slot) {
+            auto texturePtr = material->data.textures[slot];
             if (texturePtr) {
+              std::string textureName = g_getMaterialTextureName(static_cast<MaterialTexture>(slot));
               GlobalLogger::Log(
                   LogLevel::Debug,
                   "Releasing texture '" + textureName + "' from material '" + material->materialName + "'");
@@ -0,0 +1,107 @@
+#include "utils/memory/mapped_file.h"
+
+#include "utils/logger/global_logger.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace arise {
+
+std::shared_ptr<const MappedFile> MappedFile::s_open(const std::filesystem::path& path) {
+  // the constructor is private, so make_shared can't be used
+  std::shared_ptr<MappedFile> file(new MappedFile());
+
+#if defined(_WIN32)
+  HANDLE fileHandle = CreateFileW(path.c_str(),
+                                  GENERIC_READ,
+                                  FILE_SHARE_READ,
+                                  nullptr,
+                                  OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                  nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to open file for mapping: " + path.string());
+    return nullptr;
+  }
+  file->m_fileHandle_ = fileHandle;
+
+  LARGE_INTEGER fileSize{};
+  if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+    GlobalLogger::Log(LogLevel::Error, "Cannot map empty file: " + path.string());
+    return nullptr;
+  }
+
+  HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mappingHandle) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to create file mapping: " + path.string());
+    return nullptr;
+  }
+  file->m_mappingHandle_ = mappingHandle;
+
+  void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+  if (!data) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to map view of file: " + path.string());
+    return nullptr;
+  }
+
+  file->m_data_ = static_cast<const std::byte*>(data);
+  file->m_size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+  int descriptor = ::open(path.c_str(), O_RDONLY);
+  if (descriptor < 0) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to open file for mapping: " + path.string());
+    return nullptr;
+  }
+
+  struct stat status {};
+  if (::fstat(descriptor, &status) != 0 || status.st_size == 0) {
+    ::close(descriptor);
+    GlobalLogger::Log(LogLevel::Error, "Cannot map empty file: " + path.string());
+    return nullptr;
+  }
+
+  void* data = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+  // the mapping keeps its own reference to the file
+  ::close(descriptor);
+
+  if (data == MAP_FAILED) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to map file: " + path.string());
+    return nullptr;
+  }
+
+  file->m_data_ = static_cast<const std::byte*>(data);
+  file->m_size_ = static_cast<size_t>(status.st_size);
+#endif
+
+  return file;
+}
+
+MappedFile::~MappedFile() {
+#if defined(_WIN32)
+  if (m_data_) {
+    UnmapViewOfFile(m_data_);
+  }
+  if (m_mappingHandle_) {
+    CloseHandle(m_mappingHandle_);
+  }
+  if (m_fileHandle_) {
+    CloseHandle(m_fileHandle_);
+  }
+#else
+  if (m_data_) {
+    ::munmap(const_cast<std::byte*>(m_data_), m_size_);
+  }
+#endif
+}
+
+}  // namespace arise
@@ -0,0 +1,45 @@
+#ifndef ARISE_MAPPED_FILE_H
+#define ARISE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace arise {
+
+/**
+ * Read-only memory mapping of a whole file. The OS pages the content in on the first access and can drop the pages
+ * again under memory pressure (they are backed by the file), so data consumed from the mapping never lands in a heap
+ * copy first.
+ *
+ * Shared, since everything that points into the mapping (e.g. cooked meshes) has to keep it alive.
+ */
+class MappedFile {
+  public:
+  // nullptr if the file can't be opened or is empty
+  static std::shared_ptr<const MappedFile> s_open(const std::filesystem::path& path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&)            = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const std::byte* getData() const { return m_data_; }
+
+  size_t getSize() const { return m_size_; }
+
+  private:
+  MappedFile() = default;
+
+  const std::byte* m_data_ = nullptr;
+  size_t           m_size_ = 0;
+
+#if defined(_WIN32)
+  void* m_fileHandle_    = nullptr;
+  void* m_mappingHandle_ = nullptr;
+#endif
+};
+
+}  // namespace arise
+
+#endif  // ARISE_MAPPED_FILE_H
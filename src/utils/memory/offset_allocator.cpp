@@ -0,0 +1,121 @@
+#include "utils/memory/offset_allocator.h"
+
+#include "utils/logger/global_logger.h"
+
+namespace arise {
+
+OffsetAllocator::OffsetAllocator(uint32_t capacity) {
+  reset(capacity);
+}
+
+uint32_t OffsetAllocator::allocate(uint32_t size) {
+  if (size == 0) {
+    return s_invalidOffset;
+  }
+
+  // smallest free range that fits
+  auto bestFit = m_freeRangesBySize_.lower_bound({size, 0});
+  if (bestFit == m_freeRangesBySize_.end()) {
+    return s_invalidOffset;
+  }
+
+  const uint32_t offset    = bestFit->second;
+  const uint32_t rangeSize = bestFit->first;
+
+  eraseFreeRange_(m_freeRangesByOffset_.find(offset));
+  if (rangeSize > size) {
+    insertFreeRange_(offset + size, rangeSize - size);
+  }
+
+  m_allocations_[offset]  = size;
+  m_usedSize_            += size;
+  return offset;
+}
+
+void OffsetAllocator::free(uint32_t offset) {
+  auto allocation = m_allocations_.find(offset);
+  if (allocation == m_allocations_.end()) {
+    GlobalLogger::Log(LogLevel::Error, "OffsetAllocator: freeing an offset that is not allocated");
+    return;
+  }
+
+  uint32_t rangeOffset = offset;
+  uint32_t rangeSize   = allocation->second;
+
+  m_usedSize_ -= rangeSize;
+  m_allocations_.erase(allocation);
+
+  // merge with the free neighbours
+  auto next = m_freeRangesByOffset_.lower_bound(rangeOffset);
+  if (next != m_freeRangesByOffset_.end() && next->first == rangeOffset + rangeSize) {
+    rangeSize   += next->second;
+    auto merged  = next++;
+    eraseFreeRange_(merged);
+  }
+
+  if (next != m_freeRangesByOffset_.begin()) {
+    auto previous = std::prev(next);
+    if (previous->first + previous->second == rangeOffset) {
+      rangeOffset  = previous->first;
+      rangeSize   += previous->second;
+      eraseFreeRange_(previous);
+    }
+  }
+
+  insertFreeRange_(rangeOffset, rangeSize);
+}
+
+void OffsetAllocator::grow(uint32_t newCapacity) {
+  if (newCapacity <= m_capacity_) {
+    return;
+  }
+
+  uint32_t rangeOffset = m_capacity_;
+  uint32_t rangeSize   = newCapacity - m_capacity_;
+
+  // extend the free range at the end, if there is one
+  if (!m_freeRangesByOffset_.empty()) {
+    auto last = std::prev(m_freeRangesByOffset_.end());
+    if (last->first + last->second == m_capacity_) {
+      rangeOffset  = last->first;
+      rangeSize   += last->second;
+      eraseFreeRange_(last);
+    }
+  }
+
+  insertFreeRange_(rangeOffset, rangeSize);
+  m_capacity_ = newCapacity;
+}
+
+void OffsetAllocator::reset(uint32_t capacity) {
+  m_capacity_ = capacity;
+  m_usedSize_ = 0;
+  m_freeRangesByOffset_.clear();
+  m_freeRangesBySize_.clear();
+  m_allocations_.clear();
+
+  if (capacity > 0) {
+    insertFreeRange_(0, capacity);
+  }
+}
+
+uint32_t OffsetAllocator::getAllocationSize(uint32_t offset) const {
+  auto it = m_allocations_.find(offset);
+  return it != m_allocations_.end() ? it->second : 0;
+}
+
+uint32_t OffsetAllocator::getLargestFreeRange() const {
+  return m_freeRangesBySize_.empty() ? 0 : m_freeRangesBySize_.rbegin()->first;
+}
+
+void OffsetAllocator::insertFreeRange_(uint32_t offset, uint32_t size) {
+  m_freeRangesByOffset_.emplace(offset, size);
+  m_freeRangesBySize_.emplace(size, offset);
+}
+
+void OffsetAllocator::eraseFreeRange_(std::map<uint32_t, uint32_t>::iterator it) {
+  m_freeRangesBySize_.erase({it->second, it->first});
+  m_freeRangesByOffset_.erase(it);
+}
+
+}  // namespace arise
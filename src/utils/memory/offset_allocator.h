@@ -0,0 +1,65 @@
+#ifndef ARISE_OFFSET_ALLOCATOR_H
+#define ARISE_OFFSET_ALLOCATOR_H
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+namespace arise {
+
+/**
+ * Sub-allocates ranges of an abstract address space (e.g. elements of a big GPU buffer). It only does the bookkeeping,
+ * the memory itself is owned by the caller.
+ *
+ * Best fit from a size-ordered free list, freed ranges are merged with their free neighbours, so allocation and free
+ * are O(log n) in the number of free ranges.
+ */
+class OffsetAllocator {
+  public:
+  static constexpr uint32_t s_invalidOffset = UINT32_MAX;
+
+  explicit OffsetAllocator(uint32_t capacity = 0);
+
+  /**
+   * @return Offset of the allocated range or s_invalidOffset if no free range is large enough
+   */
+  uint32_t allocate(uint32_t size);
+
+  void free(uint32_t offset);
+
+  // Extends the address space, the new space is appended to the end
+  void grow(uint32_t newCapacity);
+
+  // Drops all allocations
+  void reset(uint32_t capacity);
+
+  uint32_t getAllocationSize(uint32_t offset) const;
+
+  uint32_t getCapacity() const { return m_capacity_; }
+
+  uint32_t getUsedSize() const { return m_usedSize_; }
+
+  uint32_t getFreeSize() const { return m_capacity_ - m_usedSize_; }
+
+  uint32_t getLargestFreeRange() const;
+
+  // Number of free ranges, 1 (or 0 when full) means the space is not fragmented
+  uint32_t getFreeRangeCount() const { return static_cast<uint32_t>(m_freeRangesByOffset_.size()); }
+
+  private:
+  void insertFreeRange_(uint32_t offset, uint32_t size);
+  void eraseFreeRange_(std::map<uint32_t, uint32_t>::iterator it);
+
+  uint32_t m_capacity_ = 0;
+  uint32_t m_usedSize_ = 0;
+
+  std::map<uint32_t, uint32_t>            m_freeRangesByOffset_;  // offset -> size
+  std::set<std::pair<uint32_t, uint32_t>> m_freeRangesBySize_;    // (size, offset)
+  std::unordered_map<uint32_t, uint32_t>  m_allocations_;         // offset -> size
+};
+
+}  // namespace arise
+
+#endif  // ARISE_OFFSET_ALLOCATOR_H
@@ -0,0 +1,511 @@
+#include "utils/model/cooked_mesh.h"
+
+#include "ecs/components/model.h"
+#include "utils/buffer/vertex_layout.h"
+#include "utils/logger/global_logger.h"
+#include "utils/memory/mapped_file.h"
+
+#ifdef ARISE_USE_MESHOPTIMIZER
+#include <meshoptimizer.h>
+#endif
+#include <xxhash.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace arise {
+
+namespace {
+
+constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+constexpr uint8_t NO_LOCAL_INDEX = 0xFF;
+
+static_assert(std::is_trivially_copyable_v<CookedMeshHeader>, "Cooked mesh header is copied as bytes");
+static_assert(std::is_trivially_copyable_v<CookedMeshRecord>, "Cooked mesh records are copied as bytes");
+static_assert(std::is_trivially_copyable_v<CookedModelNode>, "Cooked model nodes are copied as bytes");
+static_assert(std::is_trivially_copyable_v<CookedMeshlet>, "Cooked meshlets are copied as bytes");
+static_assert(std::is_trivially_copyable_v<MeshLod>, "Mesh LODs are copied as bytes");
+static_assert(std::is_trivially_copyable_v<math::Vector3f>, "Positions are uploaded from the mapping");
+static_assert(std::is_trivially_copyable_v<PackedVertexAttributes>, "Attributes are uploaded from the mapping");
+static_assert(CookedMeshFile::s_maxMeshletVertices < NO_LOCAL_INDEX, "Meshlet local indices are stored in bytes");
+
+uint64_t alignSection(uint64_t offset) {
+  return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// Meshlets of all meshes, the offsets of a meshlet are into the shared vertex / triangle arrays
+struct MeshletData {
+  std::vector<CookedMeshlet> meshlets;
+  std::vector<uint32_t>      vertices;
+  std::vector<uint8_t>       triangles;
+};
+
+void computeMeshletBounds(CookedMeshlet& meshlet, std::span<const math::Vector3f> positions, const MeshletData& data) {
+  math::Vector3f min(std::numeric_limits<float>::max());
+  math::Vector3f max(std::numeric_limits<float>::lowest());
+  for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+    const auto& position = positions[data.vertices[meshlet.vertexOffset + i]];
+    for (int axis = 0; axis < 3; ++axis) {
+      min[axis] = std::min(min[axis], position[axis]);
+      max[axis] = std::max(max[axis], position[axis]);
+    }
+  }
+
+  meshlet.center = (min + max) * 0.5f;
+
+  float radiusSquared = 0.0f;
+  for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+    const auto offset = positions[data.vertices[meshlet.vertexOffset + i]] - meshlet.center;
+    radiusSquared     = std::max(radiusSquared, offset.dot(offset));
+  }
+  meshlet.radius = std::sqrt(radiusSquared);
+}
+
+#ifdef ARISE_USE_MESHOPTIMIZER
+
+void buildMeshlets(std::span<const math::Vector3f> positions, std::span<const uint32_t> indices, MeshletData& data) {
+  constexpr size_t MAX_VERTICES  = CookedMeshFile::s_maxMeshletVertices;
+  constexpr size_t MAX_TRIANGLES = CookedMeshFile::s_maxMeshletTriangles;
+
+  const size_t maxMeshlets = meshopt_buildMeshletsBound(indices.size(), MAX_VERTICES, MAX_TRIANGLES);
+
+  std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+  std::vector<unsigned int>    meshletVertices(maxMeshlets * MAX_VERTICES);
+  std::vector<unsigned char>   meshletTriangles(maxMeshlets * MAX_TRIANGLES * 3);
+
+  // cone weight 0 - the clusters are grouped for locality only, there is no cone culling
+  const size_t meshletCount = meshopt_buildMeshlets(meshlets.data(),
+                                                    meshletVertices.data(),
+                                                    meshletTriangles.data(),
+                                                    indices.data(),
+                                                    indices.size(),
+                                                    &positions[0].x(),
+                                                    positions.size(),
+                                                    sizeof(math::Vector3f),
+                                                    MAX_VERTICES,
+                                                    MAX_TRIANGLES,
+                                                    0.0f);
+
+  for (size_t i = 0; i < meshletCount; ++i) {
+    const auto& source = meshlets[i];
+
+    CookedMeshlet meshlet;
+    meshlet.vertexOffset   = static_cast<uint32_t>(data.vertices.size());
+    meshlet.triangleOffset = static_cast<uint32_t>(data.triangles.size());
+    meshlet.vertexCount    = source.vertex_count;
+    meshlet.triangleCount  = source.triangle_count;
+
+    auto vertexBegin   = meshletVertices.begin() + source.vertex_offset;
+    auto triangleBegin = meshletTriangles.begin() + source.triangle_offset;
+    data.vertices.insert(data.vertices.end(), vertexBegin, vertexBegin + source.vertex_count);
+    data.triangles.insert(data.triangles.end(), triangleBegin, triangleBegin + source.triangle_count * 3);
+
+    computeMeshletBounds(meshlet, positions, data);
+    data.meshlets.push_back(meshlet);
+  }
+}
+
+#else
+
+// Greedy clustering in index order - the triangles of a well ordered mesh are already local
+void buildMeshlets(std::span<const math::Vector3f> positions, std::span<const uint32_t> indices, MeshletData& data) {
+  std::vector<uint8_t> localIndices(positions.size(), NO_LOCAL_INDEX);
+
+  CookedMeshlet meshlet{};
+
+  auto beginMeshlet = [&]() {
+    meshlet                = {};
+    meshlet.vertexOffset   = static_cast<uint32_t>(data.vertices.size());
+    meshlet.triangleOffset = static_cast<uint32_t>(data.triangles.size());
+  };
+
+  auto endMeshlet = [&]() {
+    if (meshlet.triangleCount == 0) {
+      return;
+    }
+    for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+      localIndices[data.vertices[meshlet.vertexOffset + i]] = NO_LOCAL_INDEX;
+    }
+    computeMeshletBounds(meshlet, positions, data);
+    data.meshlets.push_back(meshlet);
+  };
+
+  beginMeshlet();
+
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    const uint32_t a = indices[i];
+    const uint32_t b = indices[i + 1];
+    const uint32_t c = indices[i + 2];
+
+    const uint32_t newVertexCount = (localIndices[a] == NO_LOCAL_INDEX)
+                                  + (localIndices[b] == NO_LOCAL_INDEX && b != a)
+                                  + (localIndices[c] == NO_LOCAL_INDEX && c != a && c != b);
+
+    if (meshlet.vertexCount + newVertexCount > CookedMeshFile::s_maxMeshletVertices
+        || meshlet.triangleCount == CookedMeshFile::s_maxMeshletTriangles) {
+      endMeshlet();
+      beginMeshlet();
+    }
+
+    for (uint32_t vertex : {a, b, c}) {
+      if (localIndices[vertex] == NO_LOCAL_INDEX) {
+        localIndices[vertex] = static_cast<uint8_t>(meshlet.vertexCount++);
+        data.vertices.push_back(vertex);
+      }
+      data.triangles.push_back(localIndices[vertex]);
+    }
+    ++meshlet.triangleCount;
+  }
+
+  endMeshlet();
+}
+
+#endif  // ARISE_USE_MESHOPTIMIZER
+
+bool isSectionValid(const CookedSection& section, size_t elementSize, size_t fileSize) {
+  return section.offset % SECTION_ALIGNMENT == 0 && section.offset <= fileSize
+      && section.size <= fileSize - section.offset && section.size % elementSize == 0;
+}
+
+}  // namespace
+
+std::unique_ptr<CookedMeshFile> CookedMeshFile::s_open(const std::filesystem::path& path) {
+  auto mapping = MappedFile::s_open(path);
+  if (!mapping) {
+    return nullptr;
+  }
+
+  if (mapping->getSize() < sizeof(CookedMeshHeader)) {
+    GlobalLogger::Log(LogLevel::Error, "Cooked mesh file is truncated: " + path.string());
+    return nullptr;
+  }
+
+  auto header = reinterpret_cast<const CookedMeshHeader*>(mapping->getData());
+  if (header->magic != s_magic) {
+    GlobalLogger::Log(LogLevel::Error, "Not a cooked mesh file: " + path.string());
+    return nullptr;
+  }
+
+  if (header->version != s_version || header->attributeStride != sizeof(PackedVertexAttributes)) {
+    GlobalLogger::Log(LogLevel::Warning,
+                      "Cooked mesh file is outdated (version " + std::to_string(header->version)
+                          + "), cook it again: " + path.string());
+    return nullptr;
+  }
+
+  const size_t fileSize = mapping->getSize();
+
+  bool isValid = isSectionValid(header->meshes, sizeof(CookedMeshRecord), fileSize)
+              && isSectionValid(header->nodes, sizeof(CookedModelNode), fileSize)
+              && isSectionValid(header->strings, sizeof(char), fileSize)
+              && isSectionValid(header->positions, sizeof(math::Vector3f), fileSize)
+              && isSectionValid(header->attributes, sizeof(PackedVertexAttributes), fileSize)
+              && isSectionValid(header->colors, sizeof(uint32_t), fileSize)
+              && isSectionValid(header->indices, sizeof(uint32_t), fileSize)
+              && isSectionValid(header->meshlets, sizeof(CookedMeshlet), fileSize)
+              && isSectionValid(header->meshletVertices, sizeof(uint32_t), fileSize)
+              && isSectionValid(header->meshletTriangles, sizeof(uint8_t), fileSize)
+              && isSectionValid(header->lods, sizeof(MeshLod), fileSize)
+              && isSectionValid(header->lodIndices, sizeof(uint32_t), fileSize);
+
+  auto file       = std::unique_ptr<CookedMeshFile>(new CookedMeshFile());
+  file->m_path    = path;
+  file->m_mapping = std::move(mapping);
+  file->m_header  = header;
+
+  if (!isValid || !file->validateRecords_()) {
+    GlobalLogger::Log(LogLevel::Error, "Cooked mesh file is corrupted: " + path.string());
+    return nullptr;
+  }
+
+  return file;
+}
+
+bool CookedMeshFile::s_write(const Model&                 model,
+                             const std::filesystem::path& sourcePath,
+                             uint64_t                     sourceHash,
+                             const std::filesystem::path& outputPath) {
+  std::string                   strings;
+  std::vector<CookedMeshRecord> records;
+  std::vector<CookedModelNode>  nodes;
+  MeshletData                   meshlets;
+  std::vector<MeshLod>          lods;
+  uint32_t                      vertexCount   = 0;
+  uint32_t                      indexCount    = 0;
+  uint32_t                      lodIndexCount = 0;
+
+  auto addString = [&strings](std::string_view string) {
+    CookedString cookedString{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(string.size())};
+    strings.append(string);
+    return cookedString;
+  };
+
+  auto relativeSourcePath = std::filesystem::proximate(sourcePath, outputPath.parent_path()).generic_string();
+
+  // imported meshes are packed here, meshes of a cooked model already are
+  std::vector<PackedVertices>      packedVertices;
+  std::vector<PackedVertexStreams> vertexStreams;
+  packedVertices.reserve(model.meshes.size());
+  vertexStreams.reserve(model.meshes.size());
+  for (const Mesh* mesh : model.meshes) {
+    if (mesh->mappedFile) {
+      vertexStreams.push_back(mesh->mappedVertexStreams);
+    } else {
+      vertexStreams.push_back(packedVertices.emplace_back(g_packVertices(mesh->getVertices(), true)).getStreams());
+    }
+  }
+
+  records.reserve(model.meshes.size());
+  for (size_t i = 0; i < model.meshes.size(); ++i) {
+    const Mesh* mesh           = model.meshes[i];
+    const auto  positions      = vertexStreams[i].positions;
+    auto        meshIndices    = mesh->getIndices();
+    auto        meshLodIndices = mesh->getLodIndices();
+
+    auto isIndexOutOfRange = [&positions](uint32_t index) { return index >= positions.size(); };
+
+    // the meshlet builders index into the vertices without checking
+    if (std::any_of(meshIndices.begin(), meshIndices.end(), isIndexOutOfRange)
+        || std::any_of(meshLodIndices.begin(), meshLodIndices.end(), isIndexOutOfRange)) {
+      GlobalLogger::Log(LogLevel::Error, "Mesh '" + mesh->meshName + "' has out of range indices, cannot cook it");
+      return false;
+    }
+
+    auto& record           = records.emplace_back();
+    record.name            = addString(mesh->meshName);
+    record.nodeIndex       = mesh->nodeIndex;
+    record.materialIndex   = mesh->materialIndex;
+    record.transformMatrix = mesh->transformMatrix;
+    record.boundingBox     = mesh->boundingBox;
+    record.vertexOffset    = vertexCount;
+    record.vertexCount     = static_cast<uint32_t>(positions.size());
+    record.firstIndex      = indexCount;
+    record.indexCount      = static_cast<uint32_t>(meshIndices.size());
+    record.firstMeshlet    = static_cast<uint32_t>(meshlets.meshlets.size());
+
+    if (!positions.empty() && !meshIndices.empty()) {
+      buildMeshlets(positions, meshIndices, meshlets);
+    }
+    record.meshletCount = static_cast<uint32_t>(meshlets.meshlets.size()) - record.firstMeshlet;
+
+    // meshlets are built for the full mesh only
+    record.firstLod      = static_cast<uint32_t>(lods.size());
+    record.lodCount      = static_cast<uint32_t>(mesh->lods.size());
+    record.firstLodIndex = lodIndexCount;
+    record.lodIndexCount = static_cast<uint32_t>(meshLodIndices.size());
+    lods.insert(lods.end(), mesh->lods.begin(), mesh->lods.end());
+
+    vertexCount   += record.vertexCount;
+    indexCount    += record.indexCount;
+    lodIndexCount += record.lodIndexCount;
+  }
+
+  nodes.reserve(model.nodes.size());
+  for (const auto& modelNode : model.nodes) {
+    auto& node       = nodes.emplace_back();
+    node.name        = addString(modelNode.name);
+    node.parentIndex = modelNode.parentIndex;
+    node.localMatrix = modelNode.localMatrix;
+  }
+
+  CookedMeshHeader header{};
+  header.magic           = s_magic;
+  header.version         = s_version;
+  header.attributeStride = sizeof(PackedVertexAttributes);
+  header.sourceHash      = sourceHash;
+  header.sourcePath      = addString(relativeSourcePath);
+  header.boundingBox     = model.boundingBox;
+
+  uint64_t fileSize = sizeof(CookedMeshHeader);
+
+  auto placeSection = [&fileSize](CookedSection& section, uint64_t size) {
+    section.offset = alignSection(fileSize);
+    section.size   = size;
+    fileSize       = section.offset + size;
+  };
+
+  placeSection(header.meshes, records.size() * sizeof(CookedMeshRecord));
+  placeSection(header.nodes, nodes.size() * sizeof(CookedModelNode));
+  placeSection(header.strings, strings.size());
+  placeSection(header.positions, static_cast<uint64_t>(vertexCount) * sizeof(math::Vector3f));
+  placeSection(header.attributes, static_cast<uint64_t>(vertexCount) * sizeof(PackedVertexAttributes));
+  placeSection(header.colors, static_cast<uint64_t>(vertexCount) * sizeof(uint32_t));
+  placeSection(header.indices, static_cast<uint64_t>(indexCount) * sizeof(uint32_t));
+  placeSection(header.meshlets, meshlets.meshlets.size() * sizeof(CookedMeshlet));
+  placeSection(header.meshletVertices, meshlets.vertices.size() * sizeof(uint32_t));
+  placeSection(header.meshletTriangles, meshlets.triangles.size());
+  placeSection(header.lods, lods.size() * sizeof(MeshLod));
+  placeSection(header.lodIndices, static_cast<uint64_t>(lodIndexCount) * sizeof(uint32_t));
+
+  // zero initialized, so the padding between the sections is deterministic and the content hash stable
+  std::vector<std::byte> data(fileSize);
+
+  auto writeSection = [&data](const CookedSection& section, const void* source) {
+    if (section.size > 0) {
+      std::memcpy(data.data() + section.offset, source, section.size);
+    }
+  };
+
+  writeSection(header.meshes, records.data());
+  writeSection(header.nodes, nodes.data());
+  writeSection(header.strings, strings.data());
+  writeSection(header.meshletVertices, meshlets.vertices.data());
+  writeSection(header.meshletTriangles, meshlets.triangles.data());
+  writeSection(header.meshlets, meshlets.meshlets.data());
+  writeSection(header.lods, lods.data());
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    const auto& streams        = vertexStreams[i];
+    auto        meshIndices    = model.meshes[i]->getIndices();
+    auto        meshLodIndices = model.meshes[i]->getLodIndices();
+    std::memcpy(data.data() + header.positions.offset + records[i].vertexOffset * sizeof(math::Vector3f),
+                streams.positions.data(),
+                streams.positions.size_bytes());
+    std::memcpy(data.data() + header.attributes.offset + records[i].vertexOffset * sizeof(PackedVertexAttributes),
+                streams.attributes.data(),
+                streams.attributes.size_bytes());
+    std::memcpy(data.data() + header.colors.offset + records[i].vertexOffset * sizeof(uint32_t),
+                streams.colors.data(),
+                streams.colors.size_bytes());
+    std::memcpy(data.data() + header.indices.offset + records[i].firstIndex * sizeof(uint32_t),
+                meshIndices.data(),
+                meshIndices.size_bytes());
+    std::memcpy(data.data() + header.lodIndices.offset + records[i].firstLodIndex * sizeof(uint32_t),
+                meshLodIndices.data(),
+                meshLodIndices.size_bytes());
+  }
+
+  header.contentHash = ::XXH64(data.data() + sizeof(CookedMeshHeader), data.size() - sizeof(CookedMeshHeader), 0);
+  std::memcpy(data.data(), &header, sizeof(CookedMeshHeader));
+
+  std::error_code error;
+  if (outputPath.has_parent_path()) {
+    std::filesystem::create_directories(outputPath.parent_path(), error);
+  }
+
+  // written next to the target and renamed, so a running engine never maps a half written file
+  auto temporaryPath = outputPath;
+  temporaryPath += ".tmp";
+  {
+    std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+      GlobalLogger::Log(LogLevel::Error, "Failed to write cooked mesh file: " + temporaryPath.string());
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temporaryPath, outputPath, error);
+  if (error) {
+    GlobalLogger::Log(LogLevel::Error,
+                      "Failed to replace cooked mesh file " + outputPath.string() + ": " + error.message());
+    std::filesystem::remove(temporaryPath, error);
+    return false;
+  }
+
+  GlobalLogger::Log(LogLevel::Info,
+                    "Cooked " + std::to_string(records.size()) + " meshes (" + std::to_string(vertexCount)
+                        + " vertices, " + std::to_string(meshlets.meshlets.size()) + " meshlets, "
+                        + std::to_string(lods.size()) + " LODs) into "
+                        + outputPath.string());
+  return true;
+}
+
+std::string_view CookedMeshFile::getString(const CookedString& string) const {
+  auto strings = getSection_<char>(m_header->strings);
+  return {strings.data() + string.offset, string.size};
+}
+
+std::filesystem::path CookedMeshFile::getSourcePath() const {
+  return (m_path.parent_path() / std::filesystem::path(getString(m_header->sourcePath))).lexically_normal();
+}
+
+PackedVertexStreams CookedMeshFile::getVertexStreams(const CookedMeshRecord& mesh) const {
+  auto meshRange = [&mesh](auto stream) { return stream.subspan(mesh.vertexOffset, mesh.vertexCount); };
+  return {meshRange(getSection_<math::Vector3f>(m_header->positions)),
+          meshRange(getSection_<PackedVertexAttributes>(m_header->attributes)),
+          meshRange(getSection_<uint32_t>(m_header->colors))};
+}
+
+std::span<const uint32_t> CookedMeshFile::getIndices(const CookedMeshRecord& mesh) const {
+  return getSection_<uint32_t>(m_header->indices).subspan(mesh.firstIndex, mesh.indexCount);
+}
+
+std::span<const CookedMeshlet> CookedMeshFile::getMeshlets(const CookedMeshRecord& mesh) const {
+  return getSection_<CookedMeshlet>(m_header->meshlets).subspan(mesh.firstMeshlet, mesh.meshletCount);
+}
+
+std::span<const MeshLod> CookedMeshFile::getLods(const CookedMeshRecord& mesh) const {
+  return getSection_<MeshLod>(m_header->lods).subspan(mesh.firstLod, mesh.lodCount);
+}
+
+std::span<const uint32_t> CookedMeshFile::getLodIndices(const CookedMeshRecord& mesh) const {
+  return getSection_<uint32_t>(m_header->lodIndices).subspan(mesh.firstLodIndex, mesh.lodIndexCount);
+}
+
+bool CookedMeshFile::validateRecords_() const {
+  const uint64_t stringsSize      = m_header->strings.size;
+  const uint64_t vertexCount      = m_header->positions.size / sizeof(math::Vector3f);
+  const uint64_t indexCount       = m_header->indices.size / sizeof(uint32_t);
+  const uint64_t meshletCount     = m_header->meshlets.size / sizeof(CookedMeshlet);
+  const uint64_t meshletVertices  = m_header->meshletVertices.size / sizeof(uint32_t);
+  const uint64_t meshletTriangles = m_header->meshletTriangles.size;
+  const uint64_t lodCount         = m_header->lods.size / sizeof(MeshLod);
+  const uint64_t lodIndexCount    = m_header->lodIndices.size / sizeof(uint32_t);
+
+  // the streams are indexed alike
+  if (m_header->attributes.size / sizeof(PackedVertexAttributes) != vertexCount
+      || m_header->colors.size / sizeof(uint32_t) != vertexCount) {
+    return false;
+  }
+
+  auto isStringValid = [stringsSize](const CookedString& string) {
+    return static_cast<uint64_t>(string.offset) + string.size <= stringsSize;
+  };
+
+  if (!isStringValid(m_header->sourcePath)) {
+    return false;
+  }
+
+  const auto nodes = getNodes();
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    // parents first, so a parent index is always smaller
+    if (!isStringValid(nodes[i].name) || nodes[i].parentIndex >= static_cast<int32_t>(i)) {
+      return false;
+    }
+  }
+
+  for (const auto& mesh : getMeshes()) {
+    if (!isStringValid(mesh.name) || mesh.nodeIndex >= static_cast<int32_t>(nodes.size())
+        || static_cast<uint64_t>(mesh.vertexOffset) + mesh.vertexCount > vertexCount
+        || static_cast<uint64_t>(mesh.firstIndex) + mesh.indexCount > indexCount
+        || static_cast<uint64_t>(mesh.firstMeshlet) + mesh.meshletCount > meshletCount
+        || static_cast<uint64_t>(mesh.firstLod) + mesh.lodCount > lodCount
+        || static_cast<uint64_t>(mesh.firstLodIndex) + mesh.lodIndexCount > lodIndexCount) {
+      return false;
+    }
+
+    for (const auto& lod : getLods(mesh)) {
+      if (static_cast<uint64_t>(lod.firstIndex) + lod.indexCount > mesh.lodIndexCount) {
+        return false;
+      }
+    }
+  }
+
+  for (const auto& meshlet : getSection_<CookedMeshlet>(m_header->meshlets)) {
+    if (static_cast<uint64_t>(meshlet.vertexOffset) + meshlet.vertexCount > meshletVertices
+        || static_cast<uint64_t>(meshlet.triangleOffset) + meshlet.triangleCount * 3ull > meshletTriangles) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace arise
@@ -0,0 +1,202 @@
+#ifndef ARISE_COOKED_MESH_H
+#define ARISE_COOKED_MESH_H
+
+#include "ecs/components/bounding_volume.h"
+#include "ecs/components/mesh.h"
+#include "ecs/components/vertex.h"
+
+#include <math_library/matrix.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace arise {
+
+class MappedFile;
+struct Model;
+
+// Byte range of the file
+struct CookedSection {
+  uint64_t offset = 0;
+  uint64_t size   = 0;
+};
+
+// Range of the string section (not null terminated)
+struct CookedString {
+  uint32_t offset = 0;
+  uint32_t size   = 0;
+};
+
+struct CookedMeshHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t attributeStride;  // sizeof(PackedVertexAttributes) of the cooker
+  uint32_t reserved;
+  uint64_t sourceHash;   // XXH64 of the source file bytes
+  uint64_t contentHash;  // XXH64 of everything after the header, identifies the cooked data
+
+  CookedString sourcePath;   // relative to the cooked file, the materials are still loaded from the source
+  BoundingBox  boundingBox;  // in model space
+
+  CookedSection meshes;
+  CookedSection nodes;
+  CookedSection strings;
+  CookedSection positions;
+  CookedSection attributes;
+  CookedSection colors;
+  CookedSection indices;
+  CookedSection meshlets;
+  CookedSection meshletVertices;
+  CookedSection meshletTriangles;
+  CookedSection lods;
+  CookedSection lodIndices;
+};
+
+struct CookedMeshRecord {
+  CookedString     name;
+  int32_t          nodeIndex     = -1;
+  int32_t          materialIndex = -1;
+  math::Matrix4f<> transformMatrix;
+  BoundingBox      boundingBox;
+
+  // in elements of the vertex stream / index / meshlet / lod sections
+  uint32_t vertexOffset  = 0;
+  uint32_t vertexCount   = 0;
+  uint32_t firstIndex    = 0;
+  uint32_t indexCount    = 0;
+  uint32_t firstMeshlet  = 0;
+  uint32_t meshletCount  = 0;
+  uint32_t firstLod      = 0;
+  uint32_t lodCount      = 0;
+  uint32_t firstLodIndex = 0;
+  uint32_t lodIndexCount = 0;
+};
+
+struct CookedModelNode {
+  CookedString     name;
+  int32_t          parentIndex = -1;
+  math::Matrix4f<> localMatrix;
+};
+
+/**
+ * Cluster of at most s_maxMeshletVertices vertices and s_maxMeshletTriangles triangles of a mesh, for cluster culling
+ * and mesh shaders.
+ */
+struct CookedMeshlet {
+  uint32_t vertexOffset;    // into the meshlet vertex section, which holds mesh relative vertex indices
+  uint32_t triangleOffset;  // into the meshlet triangle section, 3 meshlet local vertex indices (bytes) per triangle
+  uint32_t vertexCount;
+  uint32_t triangleCount;
+
+  // bounding sphere in mesh local space
+  math::Vector3f center;
+  float          radius;
+};
+
+/**
+ * Cooked mesh file (.amesh) - the geometry of a model in the layout the GPU consumes, so loading it is a memory mapping
+ * and an upload straight from the mapped pages: no parsing, no per vertex conversion, no tangent generation. The
+ * vertices are stored as the streams GeometryArena uploads (see g_packVertices), the colors always, the arena skips
+ * them when it keeps none.
+ *
+ * The header is followed by the sections it lists, each starts 16 byte aligned:
+ *   meshes            CookedMeshRecord[], in the order the source loader produced the meshes
+ *   nodes             CookedModelNode[], parents first (like Model::nodes)
+ *   strings           names and the source path
+ *   positions         math::Vector3f[] of all meshes, a mesh uses [vertexOffset, vertexOffset + vertexCount)
+ *   attributes        PackedVertexAttributes[], indexed like the positions
+ *   colors            uint32_t[] (rgba8), indexed like the positions
+ *   indices           uint32_t[], relative to the first vertex of the mesh
+ *   meshlets          CookedMeshlet[]
+ *   meshletVertices   uint32_t[]
+ *   meshletTriangles  uint8_t[]
+ *   lods              MeshLod[], MeshLod::firstIndex is relative to the first LOD index of the mesh
+ *   lodIndices        uint32_t[], relative to the first vertex of the mesh like the indices
+ *
+ * The file is written by MeshCooker. Files of another version or with a different PackedVertexAttributes layout are
+ * rejected and have to be cooked again, so bump s_version when the packing (g_packVertexAttributes) changes.
+ */
+class CookedMeshFile {
+  public:
+  static constexpr uint32_t    s_magic     = 0x48534D41;  // "AMSH"
+  static constexpr uint32_t    s_version   = 3;
+  static constexpr const char* s_extension = ".amesh";
+
+  static constexpr uint32_t s_maxMeshletVertices  = 64;
+  static constexpr uint32_t s_maxMeshletTriangles = 124;
+
+  /**
+   * Maps the file and validates the header and the section ranges. The content itself isn't touched (hashing it would
+   * page in the whole file), the content hash is for the cooker and for caches keyed by the cooked data.
+   *
+   * @return nullptr if the file is missing or isn't a valid cooked mesh of this version
+   */
+  static std::unique_ptr<CookedMeshFile> s_open(const std::filesystem::path& path);
+
+  /**
+   * Writes the meshes and nodes of the model, meshlets are built from the mesh geometry.
+   *
+   * @param sourcePath file the model was loaded from, stored relative to the cooked file
+   * @param sourceHash XXH64 of the source file bytes
+   */
+  static bool s_write(const Model&                 model,
+                      const std::filesystem::path& sourcePath,
+                      uint64_t                     sourceHash,
+                      const std::filesystem::path& outputPath);
+
+  const CookedMeshHeader& getHeader() const { return *m_header; }
+
+  std::span<const CookedMeshRecord> getMeshes() const { return getSection_<CookedMeshRecord>(m_header->meshes); }
+
+  std::span<const CookedModelNode> getNodes() const { return getSection_<CookedModelNode>(m_header->nodes); }
+
+  std::string_view getString(const CookedString& string) const;
+
+  // Source file resolved against the directory of the cooked file
+  std::filesystem::path getSourcePath() const;
+
+  PackedVertexStreams getVertexStreams(const CookedMeshRecord& mesh) const;
+
+  std::span<const uint32_t> getIndices(const CookedMeshRecord& mesh) const;
+
+  std::span<const CookedMeshlet> getMeshlets(const CookedMeshRecord& mesh) const;
+
+  std::span<const uint32_t> getMeshletVertices() const { return getSection_<uint32_t>(m_header->meshletVertices); }
+
+  std::span<const uint8_t> getMeshletTriangles() const { return getSection_<uint8_t>(m_header->meshletTriangles); }
+
+  std::span<const MeshLod> getLods(const CookedMeshRecord& mesh) const;
+
+  std::span<const uint32_t> getLodIndices(const CookedMeshRecord& mesh) const;
+
+  // The views above stay valid as long as the mapping is alive
+  const std::shared_ptr<const MappedFile>& getMapping() const { return m_mapping; }
+
+  private:
+  CookedMeshFile() = default;
+
+  // validates the ranges of the records against the sections, the header is checked already
+  bool validateRecords_() const;
+
+  template <typename T>
+  std::span<const T> getSection_(const CookedSection& section) const;
+
+  std::filesystem::path             m_path;
+  std::shared_ptr<const MappedFile> m_mapping;
+  const CookedMeshHeader*           m_header = nullptr;
+};
+
+template <typename T>
+std::span<const T> CookedMeshFile::getSection_(const CookedSection& section) const {
+  // offsets and sizes are validated in s_open()
+  auto data = reinterpret_cast<const std::byte*>(m_header) + section.offset;
+  return {reinterpret_cast<const T*>(data), static_cast<size_t>(section.size / sizeof(T))};
+}
+
+}  // namespace arise
+
+#endif  // ARISE_COOKED_MESH_H
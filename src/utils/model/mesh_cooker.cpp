@@ -0,0 +1,135 @@
+#include "utils/model/mesh_cooker.h"
+
+#include "resources/assimp/assimp_model_loader.h"
+#include "resources/cgltf/cgltf_model_loader.h"
+#include "utils/asset/derived_data_cache.h"
+#include "utils/job/job_system.h"
+#include "utils/logger/console_logger.h"
+#include "utils/logger/global_logger.h"
+#include "utils/model/cooked_mesh.h"
+#include "utils/model/mesh_manager.h"
+#include "utils/model/model_loader_manager.h"
+#include "utils/service/service_locator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace arise {
+
+namespace {
+
+bool isCookable(const std::filesystem::path& path) {
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+  const auto modelType = getModelTypeFromExtension(extension);
+  return modelType != ModelType::UNKNOWN && modelType != ModelType::AMESH;
+}
+
+}  // namespace
+
+MeshCooker::MeshCooker() {
+  if (!ServiceLocator::s_get<MeshManager>()) {
+    ServiceLocator::s_provide<MeshManager>();
+  }
+
+  if (!ServiceLocator::s_get<JobSystem>()) {
+    auto jobSystem = std::make_unique<JobSystem>();
+    jobSystem->initialize();
+    ServiceLocator::s_provide<JobSystem>(std::move(jobSystem));
+  }
+
+  if (!ServiceLocator::s_get<ModelLoaderManager>()) {
+    auto modelLoaderManager = std::make_unique<ModelLoaderManager>();
+#ifdef ARISE_USE_ASSIMP
+    auto assimpModelLoader = std::make_shared<AssimpModelLoader>();
+    modelLoaderManager->registerLoader(ModelType::OBJ, assimpModelLoader);
+    modelLoaderManager->registerLoader(ModelType::FBX, assimpModelLoader);
+#endif  // ARISE_USE_ASSIMP
+    auto cgltfModelLoader = std::make_shared<CgltfModelLoader>();
+    modelLoaderManager->registerLoader(ModelType::GLTF, cgltfModelLoader);
+    modelLoaderManager->registerLoader(ModelType::GLB, cgltfModelLoader);
+    ServiceLocator::s_provide<ModelLoaderManager>(std::move(modelLoaderManager));
+  }
+}
+
+bool MeshCooker::cook(const std::filesystem::path& sourcePath, const std::filesystem::path& outputPath) {
+  auto sourceHash = DerivedDataCache::s_hashFile(sourcePath);
+  if (!sourceHash) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to read model source: " + sourcePath.string());
+    return false;
+  }
+
+  if (std::filesystem::exists(outputPath)) {
+    auto cookedFile = CookedMeshFile::s_open(outputPath);
+    if (cookedFile && cookedFile->getHeader().sourceHash == *sourceHash) {
+      GlobalLogger::Log(LogLevel::Info, "Cooked mesh is up to date: " + outputPath.string());
+      return true;
+    }
+  }
+
+  auto model = ServiceLocator::s_get<ModelLoaderManager>()->loadModel(sourcePath);
+  if (!model) {
+    GlobalLogger::Log(LogLevel::Error, "Failed to load model for cooking: " + sourcePath.string());
+    return false;
+  }
+
+  return CookedMeshFile::s_write(*model, sourcePath, *sourceHash, outputPath);
+}
+
+int MeshCooker::s_runCommandLine(int argc, char* argv[]) {
+  GlobalLogger::AddLogger(std::make_unique<ConsoleLogger>("console_logger"));
+
+  std::vector<std::filesystem::path> sources;
+  for (int i = 0; i < argc; ++i) {
+    std::filesystem::path path(argv[i]);
+
+    if (std::filesystem::is_directory(path)) {
+      for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+        if (entry.is_regular_file() && isCookable(entry.path())) {
+          sources.push_back(entry.path());
+        }
+      }
+    } else if (isCookable(path)) {
+      sources.push_back(path);
+    } else {
+      GlobalLogger::Log(LogLevel::Warning, "Not a model source, skipping: " + path.string());
+    }
+  }
+
+  if (sources.empty()) {
+    GlobalLogger::Log(LogLevel::Error, "Usage: arise --cook-meshes <model file or directory>...");
+    GlobalLogger::Shutdown();
+    return EXIT_FAILURE;
+  }
+
+  uint32_t failedCount = 0;
+  {
+    MeshCooker cooker;
+    for (const auto& source : sources) {
+      if (!cooker.cook(source, s_getCookedPath(source))) {
+        ++failedCount;
+      }
+    }
+  }
+
+  GlobalLogger::Log(LogLevel::Info,
+                    "Cooked " + std::to_string(sources.size() - failedCount) + " of " + std::to_string(sources.size())
+                        + " models");
+
+  ServiceLocator::s_remove<ModelLoaderManager>();
+  ServiceLocator::s_remove<MeshManager>();
+  ServiceLocator::s_remove<JobSystem>();
+  GlobalLogger::Shutdown();
+
+  return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+std::filesystem::path MeshCooker::s_getCookedPath(const std::filesystem::path& sourcePath) {
+  auto cookedPath = sourcePath;
+  cookedPath.replace_extension(CookedMeshFile::s_extension);
+  return cookedPath;
+}
+
+}  // namespace arise
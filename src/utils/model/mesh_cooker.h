@@ -0,0 +1,34 @@
+#ifndef ARISE_MESH_COOKER_H
+#define ARISE_MESH_COOKER_H
+
+#include <filesystem>
+
+namespace arise {
+
+/**
+ * Offline step that turns source models (glTF, OBJ, FBX) into cooked mesh files (see CookedMeshFile). The source is
+ * loaded with the regular model loaders, so the cooked geometry is exactly what loading the source would produce
+ * (including the generated tangents).
+ *
+ * Runs from the command line (see the cook_meshes target in tools/asset_tools):
+ *   arise --cook-meshes <file or directory>...
+ * Directories are searched recursively. The cooked file is written next to the source with the .amesh extension and
+ * is skipped when it was cooked from the same source bytes by the current version of the format.
+ */
+class MeshCooker {
+  public:
+  // Provides the services the model loaders depend on (MeshManager, JobSystem, ModelLoaderManager) if they are missing
+  MeshCooker();
+
+  // @return false if the source can't be loaded or the cooked file can't be written
+  bool cook(const std::filesystem::path& sourcePath, const std::filesystem::path& outputPath);
+
+  // Cooks the sources given on the command line (argv after --cook-meshes), returns the exit code of the process
+  static int s_runCommandLine(int argc, char* argv[]);
+
+  static std::filesystem::path s_getCookedPath(const std::filesystem::path& sourcePath);
+};
+
+}  // namespace arise
+
+#endif  // ARISE_MESH_COOKER_H
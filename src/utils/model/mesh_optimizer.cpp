@@ -0,0 +1,163 @@
+#include "utils/model/mesh_optimizer.h"
+
+#include "ecs/components/mesh.h"
+#include "utils/asset/derived_data_cache.h"
+#include "utils/logger/global_logger.h"
+
+#ifdef ARISE_USE_MESHOPTIMIZER
+#include <meshoptimizer.h>
+#endif
+#include <xxhash.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace arise {
+
+namespace {
+
+// bump when the processing changes in a way the settings don't capture
+constexpr uint32_t MESH_OPTIMIZER_VERSION = 1;
+
+#ifdef ARISE_USE_MESHOPTIMIZER
+
+// a level that removes less than this part of the previous one isn't worth another LOD
+constexpr float LOD_MIN_REDUCTION = 0.05f;
+
+void optimizeGeometry(Mesh& mesh, const MeshOptimizerSettings& settings) {
+  const size_t indexCount = mesh.indices.size();
+
+  // identical vertices (e.g. from unindexed or split sources) are merged first, so the cache can reuse them
+  std::vector<unsigned int> remap(mesh.vertices.size());
+  const size_t              vertexCount = meshopt_generateVertexRemap(remap.data(),
+                                                                      mesh.indices.data(),
+                                                                      indexCount,
+                                                                      mesh.vertices.data(),
+                                                                      mesh.vertices.size(),
+                                                                      sizeof(Vertex));
+
+  std::vector<Vertex> vertices(vertexCount);
+  meshopt_remapVertexBuffer(vertices.data(), mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), remap.data());
+  meshopt_remapIndexBuffer(mesh.indices.data(), mesh.indices.data(), indexCount, remap.data());
+
+  meshopt_optimizeVertexCache(mesh.indices.data(), mesh.indices.data(), indexCount, vertexCount);
+  meshopt_optimizeOverdraw(mesh.indices.data(),
+                           mesh.indices.data(),
+                           indexCount,
+                           &vertices[0].position.x(),
+                           vertexCount,
+                           sizeof(Vertex),
+                           settings.overdrawThreshold);
+
+  // last, it follows the final triangle order
+  const size_t fetchedVertexCount = meshopt_optimizeVertexFetch(
+      vertices.data(), mesh.indices.data(), indexCount, vertices.data(), vertexCount, sizeof(Vertex));
+  vertices.resize(fetchedVertexCount);
+
+  mesh.vertices = std::move(vertices);
+}
+
+void generateLods(Mesh& mesh, const MeshOptimizerSettings& settings) {
+  mesh.lods.clear();
+  mesh.lodIndices.clear();
+
+  const float* positions   = &mesh.vertices[0].position.x();
+  const size_t vertexCount = mesh.vertices.size();
+
+  // converts the relative error of meshopt_simplify to mesh local units
+  const float errorScale = meshopt_simplifyScale(positions, vertexCount, sizeof(Vertex));
+
+  std::vector<uint32_t> sourceIndices = mesh.indices;
+  std::vector<uint32_t> lodIndices(sourceIndices.size());
+  float                 error = 0.0f;
+
+  for (uint32_t level = 0; level < settings.lodCount; ++level) {
+    const size_t targetIndexCount
+        = static_cast<size_t>(static_cast<float>(sourceIndices.size()) * settings.lodReduction) / 3 * 3;
+    if (targetIndexCount < 3) {
+      break;
+    }
+
+    // the borders are locked, so the primitives of a mesh (separate meshes here) don't crack apart at their seams
+    float        levelError    = 0.0f;
+    const size_t lodIndexCount = meshopt_simplify(lodIndices.data(),
+                                                  sourceIndices.data(),
+                                                  sourceIndices.size(),
+                                                  positions,
+                                                  vertexCount,
+                                                  sizeof(Vertex),
+                                                  targetIndexCount,
+                                                  settings.lodMaxError,
+                                                  meshopt_SimplifyLockBorder,
+                                                  &levelError);
+
+    // stopped by the error limit or the locked borders
+    if (lodIndexCount == 0
+        || static_cast<float>(lodIndexCount) > static_cast<float>(sourceIndices.size()) * (1.0f - LOD_MIN_REDUCTION)) {
+      break;
+    }
+
+    meshopt_optimizeVertexCache(lodIndices.data(), lodIndices.data(), lodIndexCount, vertexCount);
+
+    // each level is simplified from the previous one, so the errors add up
+    error += levelError * errorScale;
+
+    MeshLod lod;
+    lod.firstIndex = static_cast<uint32_t>(mesh.lodIndices.size());
+    lod.indexCount = static_cast<uint32_t>(lodIndexCount);
+    lod.error      = error;
+    mesh.lods.push_back(lod);
+
+    mesh.lodIndices.insert(mesh.lodIndices.end(), lodIndices.begin(), lodIndices.begin() + lodIndexCount);
+    sourceIndices.assign(lodIndices.begin(), lodIndices.begin() + lodIndexCount);
+  }
+}
+
+#endif  // ARISE_USE_MESHOPTIMIZER
+
+}  // namespace
+
+void MeshOptimizer::optimize(Mesh& mesh) const {
+#ifdef ARISE_USE_MESHOPTIMIZER
+  // cooked meshes were optimized when they were imported, their geometry is read only
+  if (mesh.mappedFile || mesh.vertices.empty() || mesh.indices.size() < 3) {
+    return;
+  }
+
+  // meshoptimizer doesn't check the indices
+  const auto vertexCount = mesh.vertices.size();
+  if (std::any_of(
+          mesh.indices.begin(), mesh.indices.end(), [vertexCount](uint32_t index) { return index >= vertexCount; })) {
+    GlobalLogger::Log(LogLevel::Warning, "Mesh '" + mesh.meshName + "' has out of range indices, not optimizing it");
+    return;
+  }
+
+  if (m_settings.optimize) {
+    optimizeGeometry(mesh, m_settings);
+  }
+  if (m_settings.lodCount > 0) {
+    generateLods(mesh, m_settings);
+  }
+#else
+  (void)mesh;
+#endif
+}
+
+uint64_t MeshOptimizer::getVersion() const {
+#ifdef ARISE_USE_MESHOPTIMIZER
+  // field by field, the padding of the settings isn't initialized
+  DerivedDataWriter writer;
+  writer.write(MESH_OPTIMIZER_VERSION);
+  writer.write(m_settings.optimize);
+  writer.write(m_settings.lodCount);
+  writer.write(m_settings.lodReduction);
+  writer.write(m_settings.lodMaxError);
+  writer.write(m_settings.overdrawThreshold);
+  return ::XXH64(writer.getData().data(), writer.getData().size(), 0);
+#else
+  // nothing is changed without meshoptimizer
+  return 0;
+#endif
+}
+
+}  // namespace arise
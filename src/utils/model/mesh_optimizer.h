@@ -0,0 +1,56 @@
+#ifndef ARISE_MESH_OPTIMIZER_H
+#define ARISE_MESH_OPTIMIZER_H
+
+#include <cstdint>
+
+namespace arise {
+
+struct Mesh;
+
+struct MeshOptimizerSettings {
+  // reorders the triangles for the post-transform cache and overdraw, and the vertices for fetch locality
+  bool optimize = true;
+
+  // number of simplified levels generated after the full mesh, 0 disables LOD generation
+  uint32_t lodCount = 4;
+
+  // target index count of a level relative to the previous one
+  float lodReduction = 0.5f;
+
+  // largest deviation a level may have from the previous one, relative to the mesh extent
+  float lodMaxError = 0.02f;
+
+  // how much the overdraw optimization may worsen the vertex cache efficiency (1.05 - 5% worse)
+  float overdrawThreshold = 1.05f;
+};
+
+/**
+ * Import step run by the model loaders on every mesh they produce, before the mesh is cached or uploaded.
+ *
+ * The vertices are deduplicated, the triangles reordered for the post-transform cache and then for overdraw, and the
+ * vertices reordered in the order the triangles reference them. Simplified LODs are generated as a chain (each level
+ * is simplified from the previous one) and stored on the mesh (Mesh::lods), they reuse the vertices of the full mesh.
+ *
+ * Requires meshoptimizer (ARISE_USE_MESHOPTIMIZER), without it the meshes are left as they are.
+ *
+ * Thread-safe, the loaders process meshes on the job system.
+ */
+class MeshOptimizer {
+  public:
+  explicit MeshOptimizer(const MeshOptimizerSettings& settings = {})
+      : m_settings(settings) {}
+
+  void optimize(Mesh& mesh) const;
+
+  // Changes whenever the result of optimize() changes, the loaders add it to their importer version
+  uint64_t getVersion() const;
+
+  const MeshOptimizerSettings& getSettings() const { return m_settings; }
+
+  private:
+  MeshOptimizerSettings m_settings;
+};
+
+}  // namespace arise
+
+#endif  // ARISE_MESH_OPTIMIZER_H
@@ -1,5 +1,10 @@
 #include "utils/model/model_loader_manager.h"
 
+#include "resources/cooked/cooked_model_loader.h"
+#include "utils/asset/derived_data_cache.h"
+#include "utils/model/cooked_mesh.h"
+#include "utils/service/service_locator.h"
+
 namespace arise {
 
 void ModelLoaderManager::registerLoader(ModelType modelType, std::shared_ptr<IModelLoader> loader) {
@@ -27,11 +32,53 @@ std::unique_ptr<Model> ModelLoaderManager::loadModel(const std::filesystem::path
   }
 
   if (loader) {
-    return loader->loadModel(filePath);
+    // cooked files are loaded as they are, caching them would only copy them
+    if (modelType == ModelType::AMESH) {
+      return loader->loadModel(filePath);
+    }
+    return loadModelCached_(*loader, filePath);
   }
 
   GlobalLogger::Log(LogLevel::Error, "No loader found for model type with extension: " + extension);
   return nullptr;
 }
 
+std::unique_ptr<Model> ModelLoaderManager::loadModelCached_(IModelLoader&                loader,
+                                                            const std::filesystem::path& filePath) {
+  auto derivedDataCache = ServiceLocator::s_get<DerivedDataCache>();
+  if (!derivedDataCache) {
+    return loader.loadModel(filePath);
+  }
+
+  const auto dependencies = loader.getDependencies(filePath);
+
+  auto key = derivedDataCache->makeKey(filePath, "model", loader.getImporterVersion(), dependencies);
+  if (!key) {
+    return loader.loadModel(filePath);
+  }
+
+  // the entry is a cooked mesh file, a hit maps it instead of importing the source
+  const auto entryPath = derivedDataCache->getEntryPath(*key);
+  if (derivedDataCache->hasEntry(*key)) {
+    if (auto file = CookedMeshFile::s_open(entryPath)) {
+      GlobalLogger::Log(LogLevel::Debug, "Derived data cache hit for model: " + filePath.string());
+      return CookedModelLoader::s_loadModel(*file, filePath);
+    }
+    // e.g. cooked by another version of the format, imported and replaced below
+    GlobalLogger::Log(LogLevel::Warning, "Ignoring invalid derived data for model: " + filePath.string());
+  }
+
+  auto model = loader.loadModel(filePath);
+  if (model) {
+    std::error_code error;
+    std::filesystem::create_directories(entryPath.parent_path(), error);
+
+    auto sourceHash = derivedDataCache->getSourceHash(filePath);
+    if (!sourceHash || !CookedMeshFile::s_write(*model, filePath, *sourceHash, entryPath)) {
+      GlobalLogger::Log(LogLevel::Warning, "Failed to store derived data for model: " + filePath.string());
+    }
+  }
+  return model;
+}
+
 }  // namespace arise
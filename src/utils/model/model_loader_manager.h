@@ -18,9 +18,12 @@ class ModelLoaderManager {
 
   void registerLoader(ModelType modelType, std::shared_ptr<IModelLoader> loader);
 
+  // Loads the import result from the DerivedDataCache (if provided) and imports and caches it on a miss
   std::unique_ptr<Model> loadModel(const std::filesystem::path& filePath);
 
   private:
+  std::unique_ptr<Model> loadModelCached_(IModelLoader& loader, const std::filesystem::path& filePath);
+
   std::unordered_map<ModelType, std::shared_ptr<IModelLoader>> loaderMap_;
   std::mutex                                                   mutex_;
 };
@@ -3,10 +3,11 @@
 namespace arise {
 ModelType getModelTypeFromExtension(const std::string& extension) {
   static const std::unordered_map<std::string, ModelType> extensionToType = {
-    { ".obj",  ModelType::OBJ},
-    { ".fbx",  ModelType::FBX},
-    {".gltf", ModelType::GLTF},
-    { ".glb",  ModelType::GLB},
+    {  ".obj",   ModelType::OBJ},
+    {  ".fbx",   ModelType::FBX},
+    { ".gltf",  ModelType::GLTF},
+    {  ".glb",   ModelType::GLB},
+    {".amesh", ModelType::AMESH},
   };
 
   std::string ext = extension;
@@ -12,6 +12,7 @@ enum class ModelType {
   FBX,
   GLTF,
   GLB, 
+  AMESH,  // cooked mesh, see CookedMeshFile
   UNKNOWN,
 };
 
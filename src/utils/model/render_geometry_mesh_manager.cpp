@@ -1,6 +1,6 @@
 #include "utils/model/render_geometry_mesh_manager.h"
 
-#include "utils/buffer/buffer_manager.h"
+#include "utils/buffer/geometry_arena.h"
 #include "utils/logger/global_logger.h"
 #include "utils/service/service_locator.h"
 
@@ -47,15 +47,11 @@ bool RenderGeometryMeshManager::removeRenderGeometryMesh(RenderGeometryMesh* gpu
 
   GlobalLogger::Log(LogLevel::Info, "Removing render geometry mesh");
 
-  auto bufferManager = ServiceLocator::s_get<BufferManager>();
+  auto geometryArena = ServiceLocator::s_get<GeometryArena>();
 
-  if (bufferManager) {
-    if (gpuMesh->vertexBuffer) {
-      bufferManager->removeBuffer(gpuMesh->vertexBuffer);
-    }
-    if (gpuMesh->indexBuffer) {
-      bufferManager->removeBuffer(gpuMesh->indexBuffer);
-    }
+  // meshes waiting for the arena to grow have no buffers yet, but are still tracked by it
+  if (geometryArena) {
+    geometryArena->free(gpuMesh);
   }
 
   std::lock_guard<std::mutex> lock(m_mutex);
@@ -22,8 +22,10 @@ RenderMesh* RenderMeshManager::addRenderMesh(RenderGeometryMesh* gpuMesh, Materi
   }
 
   auto renderMesh      = std::make_unique<RenderMesh>();
-  renderMesh->gpuMesh  = gpuMesh;
-  renderMesh->material = material;
+  renderMesh->gpuMesh         = gpuMesh;
+  renderMesh->material        = material;
+  renderMesh->transformMatrix = sourceMesh->transformMatrix;
+  renderMesh->boundingBox     = bounds::transformAABB(sourceMesh->boundingBox, sourceMesh->transformMatrix);
 
   RenderMesh* meshPtr = renderMesh.get();
 
@@ -15,6 +15,8 @@ class PathManager {
   static std::filesystem::path s_getDebugPath();
   static std::filesystem::path s_getScenesPath();
   static std::filesystem::path s_getEngineSettingsPath();
+  // generated data that can be deleted at any time (pipeline cache, derived data)
+  static std::filesystem::path s_getCachePath();
 
   private:
   static constexpr std::string_view s_assetPath          = "assetPath";
@@ -23,6 +25,7 @@ class PathManager {
   static constexpr std::string_view s_debugPath          = "debugPath";
   static constexpr std::string_view s_scenesPath         = "scenesPath";
   static constexpr std::string_view s_engineSettingsPath = "engineSettingsPath";
+  static constexpr std::string_view s_cachePath          = "cachePath";
 
   static constexpr std::string_view s_configFile = "config/resources/paths.json";
 
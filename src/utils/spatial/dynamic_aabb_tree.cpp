@@ -0,0 +1,288 @@
+#include "utils/spatial/dynamic_aabb_tree.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <queue>
+
+namespace arise {
+
+DynamicAabbTree::DynamicAabbTree(float margin)
+    : m_margin_(margin) {
+}
+
+int32_t DynamicAabbTree::createProxy(const BoundingBox& box, uint32_t userData) {
+  int32_t proxyId = allocateNode_();
+
+  Node& node    = m_nodes_[proxyId];
+  node.box      = bounds::expand(box, m_margin_);
+  node.userData = userData;
+  node.height   = 0;
+
+  insertLeaf_(proxyId);
+  ++m_proxyCount_;
+
+  return proxyId;
+}
+
+void DynamicAabbTree::destroyProxy(int32_t proxyId) {
+  assert(proxyId >= 0 && proxyId < static_cast<int32_t>(m_nodes_.size()) && m_nodes_[proxyId].isLeaf());
+
+  removeLeaf_(proxyId);
+  freeNode_(proxyId);
+  --m_proxyCount_;
+}
+
+bool DynamicAabbTree::moveProxy(int32_t proxyId, const BoundingBox& box) {
+  assert(proxyId >= 0 && proxyId < static_cast<int32_t>(m_nodes_.size()) && m_nodes_[proxyId].isLeaf());
+
+  const BoundingBox& fatBox = m_nodes_[proxyId].box;
+  if (bounds::contains(fatBox, box)) {
+    // still inside, but a box that shrank a lot would make the queries less precise
+    BoundingBox largeFatBox = bounds::expand(box, m_margin_ * 4.0f);
+    if (bounds::contains(largeFatBox, fatBox)) {
+      return false;
+    }
+  }
+
+  removeLeaf_(proxyId);
+  m_nodes_[proxyId].box = bounds::expand(box, m_margin_);
+  insertLeaf_(proxyId);
+
+  return true;
+}
+
+void DynamicAabbTree::clear() {
+  m_nodes_.clear();
+  m_root_       = s_nullNode;
+  m_freeList_   = s_nullNode;
+  m_proxyCount_ = 0;
+}
+
+void DynamicAabbTree::queryNearest(const math::Vector3f&                      point,
+                                   uint32_t                                   count,
+                                   std::vector<std::pair<float, uint32_t>>& outResult) const {
+  outResult.clear();
+  if (m_root_ == s_nullNode || count == 0) {
+    return;
+  }
+
+  using Entry = std::pair<float, int32_t>;
+  // nodes ordered by the distance to their box - no node further than the current k-th result can contain a closer
+  // proxy
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> nodeQueue;
+  nodeQueue.push({bounds::distanceSquared(m_nodes_[m_root_].box, point), m_root_});
+
+  while (!nodeQueue.empty() && outResult.size() < count) {
+    auto [distance, nodeId] = nodeQueue.top();
+    nodeQueue.pop();
+
+    const Node& node = m_nodes_[nodeId];
+    if (node.isLeaf()) {
+      // leaves come out of the queue in distance order, so the result is already sorted
+      outResult.emplace_back(distance, node.userData);
+      continue;
+    }
+
+    nodeQueue.push({bounds::distanceSquared(m_nodes_[node.child1].box, point), node.child1});
+    nodeQueue.push({bounds::distanceSquared(m_nodes_[node.child2].box, point), node.child2});
+  }
+}
+
+int32_t DynamicAabbTree::allocateNode_() {
+  if (m_freeList_ == s_nullNode) {
+    m_nodes_.emplace_back();
+    return static_cast<int32_t>(m_nodes_.size() - 1);
+  }
+
+  int32_t nodeId   = m_freeList_;
+  m_freeList_      = m_nodes_[nodeId].parentOrNext;
+  m_nodes_[nodeId] = Node();
+  return nodeId;
+}
+
+void DynamicAabbTree::freeNode_(int32_t node) {
+  m_nodes_[node].parentOrNext = m_freeList_;
+  m_nodes_[node].height       = -1;
+  m_freeList_                 = node;
+}
+
+void DynamicAabbTree::insertLeaf_(int32_t leaf) {
+  if (m_root_ == s_nullNode) {
+    m_root_                     = leaf;
+    m_nodes_[leaf].parentOrNext = s_nullNode;
+    return;
+  }
+
+  int32_t sibling   = findBestSibling_(m_nodes_[leaf].box);
+  int32_t oldParent = m_nodes_[sibling].parentOrNext;
+
+  int32_t newParent = allocateNode_();
+  {
+    Node& parentNode        = m_nodes_[newParent];
+    parentNode.parentOrNext = oldParent;
+    parentNode.box          = bounds::combine(m_nodes_[leaf].box, m_nodes_[sibling].box);
+    parentNode.height       = m_nodes_[sibling].height + 1;
+    parentNode.child1       = sibling;
+    parentNode.child2       = leaf;
+  }
+
+  if (oldParent != s_nullNode) {
+    if (m_nodes_[oldParent].child1 == sibling) {
+      m_nodes_[oldParent].child1 = newParent;
+    } else {
+      m_nodes_[oldParent].child2 = newParent;
+    }
+  } else {
+    m_root_ = newParent;
+  }
+
+  m_nodes_[sibling].parentOrNext = newParent;
+  m_nodes_[leaf].parentOrNext    = newParent;
+
+  refitAncestors_(oldParent);
+}
+
+void DynamicAabbTree::removeLeaf_(int32_t leaf) {
+  if (leaf == m_root_) {
+    m_root_ = s_nullNode;
+    return;
+  }
+
+  int32_t parent      = m_nodes_[leaf].parentOrNext;
+  int32_t grandParent = m_nodes_[parent].parentOrNext;
+  int32_t sibling     = m_nodes_[parent].child1 == leaf ? m_nodes_[parent].child2 : m_nodes_[parent].child1;
+
+  // the sibling takes the place of the parent
+  if (grandParent != s_nullNode) {
+    if (m_nodes_[grandParent].child1 == parent) {
+      m_nodes_[grandParent].child1 = sibling;
+    } else {
+      m_nodes_[grandParent].child2 = sibling;
+    }
+    m_nodes_[sibling].parentOrNext = grandParent;
+    freeNode_(parent);
+
+    refitAncestors_(grandParent);
+  } else {
+    m_root_                        = sibling;
+    m_nodes_[sibling].parentOrNext = s_nullNode;
+    freeNode_(parent);
+  }
+}
+
+int32_t DynamicAabbTree::findBestSibling_(const BoundingBox& box) const {
+  // descend while the cost of pushing the leaf further down is lower than pairing it with the current node (SAH with
+  // the inherited cost of enlarging the ancestors)
+  int32_t index = m_root_;
+  while (!m_nodes_[index].isLeaf()) {
+    const Node& node = m_nodes_[index];
+
+    float area         = bounds::getSurfaceArea(node.box);
+    float combinedArea = bounds::getSurfaceArea(bounds::combine(node.box, box));
+
+    // cost of creating a new parent for this node and the leaf
+    float cost            = 2.0f * combinedArea;
+    // minimum cost of pushing the leaf further down the tree
+    float inheritanceCost = 2.0f * (combinedArea - area);
+
+    auto childCost = [&](int32_t child) {
+      const Node& childNode = m_nodes_[child];
+      float       newArea   = bounds::getSurfaceArea(bounds::combine(childNode.box, box));
+      if (childNode.isLeaf()) {
+        return newArea + inheritanceCost;
+      }
+      return (newArea - bounds::getSurfaceArea(childNode.box)) + inheritanceCost;
+    };
+
+    float cost1 = childCost(node.child1);
+    float cost2 = childCost(node.child2);
+
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+  return index;
+}
+
+void DynamicAabbTree::refitAncestors_(int32_t node) {
+  while (node != s_nullNode) {
+    Node&       current = m_nodes_[node];
+    const Node& child1  = m_nodes_[current.child1];
+    const Node& child2  = m_nodes_[current.child2];
+
+    current.height = 1 + std::max(child1.height, child2.height);
+    current.box    = bounds::combine(child1.box, child2.box);
+
+    node = balance_(node);
+    node = m_nodes_[node].parentOrNext;
+  }
+}
+
+int32_t DynamicAabbTree::balance_(int32_t a) {
+  // rotates the higher child up when the subtree heights differ by more than one (f is the higher grandchild):
+  //       a                c
+  //     /   \            /   \
+  //    b     c    ->    a     f
+  //         / \        / \
+  //        f   g      b   g
+  Node& nodeA = m_nodes_[a];
+  if (nodeA.isLeaf() || nodeA.height < 2) {
+    return a;
+  }
+
+  int32_t b = nodeA.child1;
+  int32_t c = nodeA.child2;
+
+  int32_t heightDifference = m_nodes_[c].height - m_nodes_[b].height;
+  if (std::abs(heightDifference) <= 1) {
+    return a;
+  }
+
+  // the higher child is rotated up, the same code handles both sides
+  int32_t higher = heightDifference > 0 ? c : b;
+
+  Node&   nodeHigher = m_nodes_[higher];
+  int32_t f          = nodeHigher.child1;
+  int32_t g          = nodeHigher.child2;
+
+  // higher takes the place of a
+  nodeHigher.child1       = a;
+  nodeHigher.parentOrNext = nodeA.parentOrNext;
+  nodeA.parentOrNext      = higher;
+
+  if (nodeHigher.parentOrNext != s_nullNode) {
+    Node& parent = m_nodes_[nodeHigher.parentOrNext];
+    if (parent.child1 == a) {
+      parent.child1 = higher;
+    } else {
+      parent.child2 = higher;
+    }
+  } else {
+    m_root_ = higher;
+  }
+
+  // the higher grandchild stays under the rotated node, the lower one moves to a
+  int32_t keep = m_nodes_[f].height > m_nodes_[g].height ? f : g;
+  int32_t move = keep == f ? g : f;
+
+  nodeHigher.child2           = keep;
+  m_nodes_[move].parentOrNext = a;
+
+  if (heightDifference > 0) {
+    nodeA.child2 = move;
+  } else {
+    nodeA.child1 = move;
+  }
+
+  nodeA.box    = bounds::combine(m_nodes_[nodeA.child1].box, m_nodes_[nodeA.child2].box);
+  nodeA.height = 1 + std::max(m_nodes_[nodeA.child1].height, m_nodes_[nodeA.child2].height);
+
+  nodeHigher.box    = bounds::combine(nodeA.box, m_nodes_[keep].box);
+  nodeHigher.height = 1 + std::max(nodeA.height, m_nodes_[keep].height);
+
+  return higher;
+}
+
+}  // namespace arise
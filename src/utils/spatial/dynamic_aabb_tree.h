@@ -0,0 +1,211 @@
+#ifndef ARISE_DYNAMIC_AABB_TREE_H
+#define ARISE_DYNAMIC_AABB_TREE_H
+
+#include "ecs/components/bounding_volume.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace arise {
+
+/**
+ * Incrementally updated bounding volume hierarchy.
+ *
+ * Every leaf stores a "fat" box - the real box grown by a margin - so small movements don't touch the tree at all.
+ * Leaves are inserted using the surface area heuristic and the tree is kept balanced with AVL-like rotations, so the
+ * height stays O(log n) without full rebuilds. Nodes live in one array and are referenced by index (proxy id).
+ */
+class DynamicAabbTree {
+  public:
+  static constexpr int32_t s_nullNode = -1;
+
+  // initial traversal stack size, enough for balanced trees of millions of proxies
+  static constexpr std::size_t s_stackCapacity = 64;
+
+  explicit DynamicAabbTree(float margin = 0.1f);
+
+  // Returns the proxy id, stays valid until destroyProxy
+  int32_t createProxy(const BoundingBox& box, uint32_t userData);
+
+  void destroyProxy(int32_t proxyId);
+
+  /**
+   * Updates the box of the proxy. The leaf is reinserted only when the new box leaves the fat box.
+   * @return true if the tree structure was changed.
+   */
+  bool moveProxy(int32_t proxyId, const BoundingBox& box);
+
+  void clear();
+
+  uint32_t getUserData(int32_t proxyId) const { return m_nodes_[proxyId].userData; }
+
+  const BoundingBox& getFatBox(int32_t proxyId) const { return m_nodes_[proxyId].box; }
+
+  uint32_t getProxyCount() const { return m_proxyCount_; }
+
+  int32_t getHeight() const { return m_root_ == s_nullNode ? 0 : m_nodes_[m_root_].height; }
+
+  // callback(uint32_t userData) -> bool, returning false stops the query
+  template <typename Callback>
+  void queryOverlap(const BoundingBox& box, Callback&& callback) const;
+
+  // Subtrees that are completely inside the frustum are reported without testing their nodes
+  template <typename Callback>
+  void queryFrustum(const Frustum& frustum, Callback&& callback) const;
+
+  /**
+   * callback(const Ray&, float maxDistance, uint32_t userData) -> float. The callback does the exact test and returns
+   * the new max distance: 0 stops the query, a smaller value clips the ray (closest hit search), maxDistance
+   * continues unchanged.
+   */
+  template <typename Callback>
+  void raycast(const Ray& ray, float maxDistance, Callback&& callback) const;
+
+  /**
+   * Best-first search of the k proxies closest to the point (distance to the fat box).
+   * outResult is filled with (squared distance, userData) pairs sorted from the nearest.
+   */
+  void queryNearest(const math::Vector3f&                      point,
+                    uint32_t                                   count,
+                    std::vector<std::pair<float, uint32_t>>& outResult) const;
+
+  private:
+  struct Node {
+    BoundingBox box;
+    // parent for nodes in the tree, next free node for nodes in the free list
+    int32_t     parentOrNext = s_nullNode;
+    int32_t     child1       = s_nullNode;
+    int32_t     child2       = s_nullNode;
+    // leaf = 0, free node = -1
+    int32_t     height       = -1;
+    uint32_t    userData     = 0;
+
+    bool isLeaf() const { return child1 == s_nullNode; }
+  };
+
+  int32_t allocateNode_();
+  void    freeNode_(int32_t node);
+
+  void insertLeaf_(int32_t leaf);
+  void removeLeaf_(int32_t leaf);
+
+  int32_t findBestSibling_(const BoundingBox& box) const;
+
+  // Refits boxes and heights from the node up to the root, balancing on the way
+  void refitAncestors_(int32_t node);
+
+  int32_t balance_(int32_t node);
+
+  std::vector<Node> m_nodes_;
+  int32_t           m_root_       = s_nullNode;
+  int32_t           m_freeList_   = s_nullNode;
+  uint32_t          m_proxyCount_ = 0;
+  float             m_margin_;
+};
+
+template <typename Callback>
+void DynamicAabbTree::queryOverlap(const BoundingBox& box, Callback&& callback) const {
+  std::vector<int32_t> stack;
+  stack.reserve(s_stackCapacity);
+  stack.push_back(m_root_);
+
+  while (!stack.empty()) {
+    int32_t nodeId = stack.back();
+    stack.pop_back();
+    if (nodeId == s_nullNode) {
+      continue;
+    }
+
+    const Node& node = m_nodes_[nodeId];
+    if (!bounds::intersects(node.box, box)) {
+      continue;
+    }
+
+    if (node.isLeaf()) {
+      if (!callback(node.userData)) {
+        return;
+      }
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
+
+template <typename Callback>
+void DynamicAabbTree::queryFrustum(const Frustum& frustum, Callback&& callback) const {
+  if (m_root_ == s_nullNode) {
+    return;
+  }
+
+  std::vector<int32_t> stack;
+  stack.reserve(s_stackCapacity);
+
+  // the sign of the node id on the stack tells whether the subtree is already known to be inside (-(id + 1))
+  stack.push_back(m_root_);
+
+  while (!stack.empty()) {
+    int32_t entry = stack.back();
+    stack.pop_back();
+
+    bool    inside = entry < 0;
+    int32_t nodeId = inside ? -entry - 1 : entry;
+
+    const Node& node = m_nodes_[nodeId];
+    if (!inside) {
+      FrustumTestResult result = bounds::classify(frustum, node.box);
+      if (result == FrustumTestResult::Outside) {
+        continue;
+      }
+      inside = result == FrustumTestResult::Inside;
+    }
+
+    if (node.isLeaf()) {
+      if (!callback(node.userData)) {
+        return;
+      }
+    } else {
+      stack.push_back(inside ? -node.child1 - 1 : node.child1);
+      stack.push_back(inside ? -node.child2 - 1 : node.child2);
+    }
+  }
+}
+
+template <typename Callback>
+void DynamicAabbTree::raycast(const Ray& ray, float maxDistance, Callback&& callback) const {
+  std::vector<int32_t> stack;
+  stack.reserve(s_stackCapacity);
+  stack.push_back(m_root_);
+
+  while (!stack.empty()) {
+    int32_t nodeId = stack.back();
+    stack.pop_back();
+    if (nodeId == s_nullNode) {
+      continue;
+    }
+
+    const Node& node = m_nodes_[nodeId];
+    float       distance;
+    if (!bounds::intersects(node.box, ray, maxDistance, distance)) {
+      continue;
+    }
+
+    if (node.isLeaf()) {
+      float newMaxDistance = callback(ray, maxDistance, node.userData);
+      if (newMaxDistance <= 0.0f) {
+        return;
+      }
+      maxDistance = std::min(maxDistance, newMaxDistance);
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
+
+}  // namespace arise
+
+#endif  // ARISE_DYNAMIC_AABB_TREE_H
@@ -1,7 +1,5 @@
 #include "utils/texture/texture_manager.h"
 
-#include "gfx/rhi/interface/command_buffer.h"
-#include "gfx/rhi/interface/synchronization.h"
 #include "utils/image/image_manager.h"
 #include "utils/resource/resource_deletion_manager.h"
 #include "utils/service/service_locator.h"
@@ -42,6 +40,13 @@ gfx::rhi::Texture* TextureManager::createTexture(Image* image, const std::string
   desc.createFlags = gfx::rhi::TextureCreateFlag::TransferDst;
   desc.debugName   = name.empty() ? "unnamed_loaded_texture" : name.c_str();
 
+  const bool hasPixels = !image->pixels.empty() && !image->subImages.empty();
+
+  // the uploads leave the texture in ShaderReadOnly, only a texture without pixels has to be created in it
+  if (!hasPixels) {
+    desc.initialLayout = gfx::rhi::ResourceLayout::ShaderReadOnly;
+  }
+
   std::string textureName = name.empty() ? generateUniqueName_("Texture") : name;
 
   std::lock_guard<std::mutex> lock(m_mutex);
@@ -57,7 +62,7 @@ gfx::rhi::Texture* TextureManager::createTexture(Image* image, const std::string
     return nullptr;
   }
 
-  if (!image->pixels.empty() && !image->subImages.empty()) {
+  if (hasPixels) {
     if (desc.mipLevels > 1 || desc.arraySize > 1) {
       for (uint32_t arraySlice = 0; arraySlice < desc.arraySize; ++arraySlice) {
         for (uint32_t mipLevel = 0; mipLevel < desc.mipLevels; ++mipLevel) {
@@ -79,23 +84,6 @@ gfx::rhi::Texture* TextureManager::createTexture(Image* image, const std::string
     }
   }
 
-  if (texture) {
-    gfx::rhi::ResourceBarrierDesc barrier;
-    barrier.texture   = texture.get();
-    barrier.oldLayout = texture->getCurrentLayoutType();
-    barrier.newLayout = gfx::rhi::ResourceLayout::ShaderReadOnly;
-
-    auto cmdBuffer = m_device->createCommandBuffer();
-    cmdBuffer->reset();
-    cmdBuffer->begin();
-    cmdBuffer->resourceBarrier(barrier);
-    cmdBuffer->end();
-
-    auto fence = m_device->createFence();
-    m_device->submitCommandBuffer(cmdBuffer.get(), fence.get());
-    fence->wait();
-  }
-
   gfx::rhi::Texture* texturePtr = texture.get();
   m_textures[textureName]       = std::move(texture);
 